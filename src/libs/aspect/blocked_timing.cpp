@@ -22,6 +22,7 @@
  */
 
 #include <aspect/blocked_timing.h>
+#include <aspect/blocked_timing/profiler.h>
 #include <core/exception.h>
 #include <core/threading/thread.h>
 
@@ -38,6 +39,9 @@ namespace fawkes {
  * Your thread must run in Thread::OPMODE_WAITFORWAKEUP mode, otherwise it
  * is not started. This is a requirement for having the BlockedTimingAspect.
  *
+ * The time from the wakeup of the hook until the thread's loop has finished
+ * is recorded with the BlockedTimingProfiler.
+ *
  * @see Thread::OpMode
  * @ingroup Aspects
  * @author Tim Niemueller
@@ -56,8 +60,10 @@ BlockedTimingAspect::BlockedTimingAspect(WakeupHook wakeup_hook)
                   blocked_timing_hook_to_end_syncpoint(wakeup_hook))
 {
 	add_aspect("BlockedTimingAspect");
-	wakeup_hook_   = wakeup_hook;
-	loop_listener_ = new BlockedTimingLoopListener();
+	wakeup_hook_      = wakeup_hook;
+	loop_listener_    = new BlockedTimingLoopListener(this);
+	loop_latency_     = NULL;
+	loop_wakeup_time_ = 0;
 }
 
 /** Virtual empty destructor. */
@@ -73,6 +79,7 @@ BlockedTimingAspect::~BlockedTimingAspect()
 void
 BlockedTimingAspect::init_BlockedTimingAspect(Thread *thread)
 {
+	loop_latency_ = BlockedTimingProfiler::instance()->register_thread(thread->name(), wakeup_hook_);
 	thread->add_loop_listener(loop_listener_);
 	thread->wakeup();
 }
@@ -85,6 +92,10 @@ void
 BlockedTimingAspect::finalize_BlockedTimingAspect(Thread *thread)
 {
 	thread->remove_loop_listener(loop_listener_);
+	if (loop_latency_) {
+		BlockedTimingProfiler::instance()->unregister_thread(loop_latency_);
+		loop_latency_ = NULL;
+	}
 }
 
 /** Get the wakeup hook.
@@ -98,6 +109,30 @@ BlockedTimingAspect::blockedTimingAspectHook() const
 	return wakeup_hook_;
 }
 
+/** Begin loop profiling.
+ * Remembers the time the thread's hook has been woken up. Called before the
+ * thread's loop is run, after the wakeup of the hook.
+ */
+void
+BlockedTimingAspect::blocked_timing_loop_begin()
+{
+	loop_wakeup_time_ = BlockedTimingProfiler::instance()->hook_wakeup_time(wakeup_hook_);
+}
+
+/** End loop profiling.
+ * Records the time since the wakeup of the hook remembered by
+ * blocked_timing_loop_begin() and notifies the profiler that the thread
+ * has finished. Called after the thread's loop has finished.
+ */
+void
+BlockedTimingAspect::blocked_timing_loop_end()
+{
+	if (loop_latency_ && loop_wakeup_time_ > 0) {
+		loop_latency_->record((BlockedTimingProfiler::now() - loop_wakeup_time_) / 1000);
+	}
+	BlockedTimingProfiler::instance()->thread_finished(wakeup_hook_);
+}
+
 /** Get string for wakeup hook.
  * @param hook wakeup hook to get string for
  * @return string representation of hook
@@ -162,6 +197,25 @@ BlockedTimingAspect::blocked_timing_hook_to_start_syncpoint(WakeupHook hook)
 	}
 }
 
+/** Constructor.
+ * @param aspect aspect this listener belongs to
+ */
+BlockedTimingLoopListener::BlockedTimingLoopListener(BlockedTimingAspect *aspect)
+: aspect_(aspect)
+{
+}
+
+/** The pre loop function of the BlockedTimingAspect
+ * This function is called right before the loop of the thread with the aspect
+ * and after the thread has been woken up.
+ * @param thread thread this loop listener belongs to
+ */
+void
+BlockedTimingLoopListener::pre_loop(Thread *thread)
+{
+	aspect_->blocked_timing_loop_begin();
+}
+
 /** The post loop function of the BlockedTimingAspect
  * This function is called right after the loop of the thread with the aspect.
  * @param thread thread this loop listener belongs to
@@ -169,6 +223,7 @@ BlockedTimingAspect::blocked_timing_hook_to_start_syncpoint(WakeupHook hook)
 void
 BlockedTimingLoopListener::post_loop(Thread *thread)
 {
+	aspect_->blocked_timing_loop_end();
 	thread->wakeup();
 }
 
@@ -28,15 +28,20 @@
 #include <aspect/syncpoint.h>
 #include <core/threading/thread_loop_listener.h>
 
+#include <cstdint>
 #include <map>
 #include <string>
 
 namespace fawkes {
 
+class BlockedTimingAspect;
+class LatencyHistogram;
+
 /** @class BlockedTimingLoopListener
  * Loop Listener of the BlockedTimingAspect.
  * This loop listener immediately wakes up the thread after loop returned.
  * The thread will then wait for the syncpoint of the next iteration.
+ * It also records the loop latency of the thread for profiling.
  * The BlockedTimingAspect cannot be derived from ThreadLoopListener because
  * the SyncPointAspect is already derived from ThreadLoopListener and we need
  * another listener. Therefore, use composition instead.
@@ -44,7 +49,13 @@ namespace fawkes {
 class BlockedTimingLoopListener : public ThreadLoopListener
 {
 public:
+	BlockedTimingLoopListener(BlockedTimingAspect *aspect);
+
+	void pre_loop(Thread *thread);
 	void post_loop(Thread *thread);
+
+private:
+	BlockedTimingAspect *aspect_;
 };
 
 class BlockedTimingAspect : public SyncPointAspect
@@ -83,6 +94,9 @@ public:
 
 	WakeupHook blockedTimingAspectHook() const;
 
+	void blocked_timing_loop_begin();
+	void blocked_timing_loop_end();
+
 	/** Translation from WakeupHooks to SyncPoints. Each WakeupHook corresponds to
    *  exactly one SyncPoint, e.g., WAKEUP_HOOK_PRE_LOOP becomes /preloop.
    */
@@ -91,6 +105,8 @@ public:
 private:
 	WakeupHook                 wakeup_hook_;
 	BlockedTimingLoopListener *loop_listener_;
+	LatencyHistogram *         loop_latency_;
+	int64_t                    loop_wakeup_time_;
 };
 
 } // end namespace fawkes
@@ -0,0 +1,216 @@
+
+/***************************************************************************
+ *  profiler.cpp - Latency profiler for BlockedTimingAspect threads
+ *
+ *  Created: Sat Oct 17 21:52:30 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <aspect/blocked_timing/profiler.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+
+#include <ctime>
+
+namespace fawkes {
+
+/** @class BlockedTimingProfiler <aspect/blocked_timing/profiler.h>
+ * Latency profiler for BlockedTimingAspect threads.
+ * Records the time from waking up a hook until all of its threads have
+ * finished, and for each thread the time from waking up its hook until the
+ * thread's loop has finished. The latter includes the time it takes to
+ * actually schedule the thread after the wakeup. Latencies are recorded in
+ * microseconds into a LatencyHistogram per hook and per thread.
+ *
+ * Recording is lock-free and cheap enough to be always enabled. The
+ * executor of the main loop reports hook wakeups and completion, threads
+ * record their latencies in the BlockedTimingAspect's loop listener.
+ * There is a single instance per process.
+ * @author Tim Niemueller
+ */
+
+/** Constructor. */
+BlockedTimingProfiler::BlockedTimingProfiler()
+{
+	mutex_ = new Mutex();
+	for (unsigned int i = 0; i < NUM_HOOKS; ++i) {
+		hook_wakeup_[i].store(0, std::memory_order_relaxed);
+		hook_pending_[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+/** Destructor. */
+BlockedTimingProfiler::~BlockedTimingProfiler()
+{
+	for (std::list<Entry *>::iterator i = threads_.begin(); i != threads_.end(); ++i) {
+		delete *i;
+	}
+	delete mutex_;
+}
+
+/** Get profiler instance.
+ * @return profiler instance
+ */
+BlockedTimingProfiler *
+BlockedTimingProfiler::instance()
+{
+	static BlockedTimingProfiler profiler;
+	return &profiler;
+}
+
+/** Get current time.
+ * @return monotonic time in nanoseconds
+ */
+int64_t
+BlockedTimingProfiler::now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** Notify of hook wakeup.
+ * To be called by the executor right before the threads of the hook are
+ * woken up. An executor which does not wait for the threads itself passes
+ * the number of threads, the hook is then considered finished once all of
+ * them have called thread_finished().
+ * @param hook hook which is about to be woken up
+ * @param num_pending number of threads to wait for, 0 if the executor calls
+ * hook_finished() itself
+ */
+void
+BlockedTimingProfiler::hook_woken(BlockedTimingAspect::WakeupHook hook, unsigned int num_pending)
+{
+	hook_pending_[hook].store(num_pending, std::memory_order_relaxed);
+	hook_wakeup_[hook].store(now(), std::memory_order_release);
+}
+
+/** Notify of thread completion.
+ * To be called by each thread of a hook once its loop has finished. Calls
+ * hook_finished() for the last pending thread if the hook was woken up
+ * with a number of threads to wait for.
+ * @param hook hook of the thread
+ */
+void
+BlockedTimingProfiler::thread_finished(BlockedTimingAspect::WakeupHook hook)
+{
+	unsigned int pending = hook_pending_[hook].load(std::memory_order_relaxed);
+	while (pending > 0) {
+		if (hook_pending_[hook].compare_exchange_weak(pending, pending - 1)) {
+			if (pending == 1) {
+				hook_finished(hook);
+			}
+			return;
+		}
+	}
+}
+
+/** Notify of hook completion.
+ * To be called by the executor once all threads of the hook have finished
+ * or the hook timed out.
+ * @param hook hook which has finished
+ */
+void
+BlockedTimingProfiler::hook_finished(BlockedTimingAspect::WakeupHook hook)
+{
+	int64_t woken = hook_wakeup_[hook].load(std::memory_order_relaxed);
+	if (woken > 0) {
+		hook_latency_[hook].record((now() - woken) / 1000);
+	}
+}
+
+/** Get time of last wakeup of a hook.
+ * @param hook hook to query
+ * @return monotonic time of last wakeup in nanoseconds, 0 if the hook has
+ * never been woken up
+ */
+int64_t
+BlockedTimingProfiler::hook_wakeup_time(BlockedTimingAspect::WakeupHook hook) const
+{
+	return hook_wakeup_[hook].load(std::memory_order_relaxed);
+}
+
+/** Register thread.
+ * @param name name of thread
+ * @param hook hook of thread
+ * @return histogram to record the thread's latencies in, must be passed
+ * to unregister_thread() when the thread is finalized
+ */
+LatencyHistogram *
+BlockedTimingProfiler::register_thread(const char *name, BlockedTimingAspect::WakeupHook hook)
+{
+	Entry *e = new Entry();
+	e->name  = name;
+	e->hook  = hook;
+
+	MutexLocker lock(mutex_);
+	threads_.push_back(e);
+	return &e->histogram;
+}
+
+/** Unregister thread.
+ * @param histogram histogram returned by register_thread()
+ */
+void
+BlockedTimingProfiler::unregister_thread(LatencyHistogram *histogram)
+{
+	MutexLocker lock(mutex_);
+	for (std::list<Entry *>::iterator i = threads_.begin(); i != threads_.end(); ++i) {
+		if (&(*i)->histogram == histogram) {
+			delete *i;
+			threads_.erase(i);
+			break;
+		}
+	}
+}
+
+/** Get hook latencies.
+ * @return snapshot of latency histograms of hooks which have been woken up
+ */
+std::list<BlockedTimingProfiler::Entry>
+BlockedTimingProfiler::hook_latencies() const
+{
+	std::list<Entry> rv;
+	for (unsigned int i = 0; i < NUM_HOOKS; ++i) {
+		if (hook_wakeup_[i].load(std::memory_order_relaxed) == 0)
+			continue;
+
+		BlockedTimingAspect::WakeupHook hook = (BlockedTimingAspect::WakeupHook)i;
+		rv.push_back(Entry());
+		rv.back().name      = BlockedTimingAspect::blocked_timing_hook_to_string(hook);
+		rv.back().hook      = hook;
+		rv.back().histogram = hook_latency_[i];
+	}
+	return rv;
+}
+
+/** Get thread latencies.
+ * @return snapshot of latency histograms of all registered threads
+ */
+std::list<BlockedTimingProfiler::Entry>
+BlockedTimingProfiler::thread_latencies() const
+{
+	MutexLocker      lock(mutex_);
+	std::list<Entry> rv;
+	for (std::list<Entry *>::const_iterator i = threads_.begin(); i != threads_.end(); ++i) {
+		rv.push_back(**i);
+	}
+	return rv;
+}
+
+} // end namespace fawkes
@@ -0,0 +1,83 @@
+
+/***************************************************************************
+ *  profiler.h - Latency profiler for BlockedTimingAspect threads
+ *
+ *  Created: Sat Oct 17 21:52:30 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _ASPECT_BLOCKED_TIMING_PROFILER_H_
+#define _ASPECT_BLOCKED_TIMING_PROFILER_H_
+
+#include <aspect/blocked_timing.h>
+#include <utils/time/latency_histogram.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <string>
+
+namespace fawkes {
+
+class Mutex;
+
+class BlockedTimingProfiler
+{
+public:
+	/** Latency histogram of a hook or thread. */
+	class Entry
+	{
+	public:
+		std::string                     name;      ///< hook or thread name
+		BlockedTimingAspect::WakeupHook hook;      ///< hook
+		LatencyHistogram                histogram; ///< latencies in microseconds
+	};
+
+	static BlockedTimingProfiler *instance();
+
+	void    hook_woken(BlockedTimingAspect::WakeupHook hook, unsigned int num_pending = 0);
+	void    hook_finished(BlockedTimingAspect::WakeupHook hook);
+	void    thread_finished(BlockedTimingAspect::WakeupHook hook);
+	int64_t hook_wakeup_time(BlockedTimingAspect::WakeupHook hook) const;
+
+	LatencyHistogram *register_thread(const char *name, BlockedTimingAspect::WakeupHook hook);
+	void              unregister_thread(LatencyHistogram *histogram);
+
+	std::list<Entry> hook_latencies() const;
+	std::list<Entry> thread_latencies() const;
+
+	static int64_t now();
+
+private:
+	BlockedTimingProfiler();
+	~BlockedTimingProfiler();
+
+	/** Number of wakeup hooks. */
+	static const unsigned int NUM_HOOKS = BlockedTimingAspect::WAKEUP_HOOK_POST_LOOP + 1;
+
+	std::atomic<int64_t>      hook_wakeup_[NUM_HOOKS];
+	std::atomic<unsigned int> hook_pending_[NUM_HOOKS];
+	LatencyHistogram          hook_latency_[NUM_HOOKS];
+
+	Mutex *            mutex_;
+	std::list<Entry *> threads_;
+};
+
+} // end namespace fawkes
+
+#endif
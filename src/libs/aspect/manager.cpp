@@ -21,6 +21,7 @@
  *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
  */
 
+#include <aspect/aspect_provider.h>
 #include <aspect/inifins/aspect_provider.h>
 #include <aspect/inifins/blackboard.h>
 #include <aspect/inifins/blocked_timing.h>
@@ -48,6 +49,9 @@
 #ifdef HAVE_PCL
 #	include <aspect/inifins/pointcloud.h>
 #endif
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <utils/time/time.h>
 
 namespace fawkes {
 
@@ -57,10 +61,22 @@ namespace fawkes {
  * It manages the initializers/finalizers and thus the aspects which are
  * currently available in the system. It assures that these are not removed
  * before the last thread with an aspect is gone.
+ *
+ * Threads may be initialized and finalized concurrently, the aspects of
+ * the threads are initialized one thread at a time. The time it took to
+ * initialize each aspect of a thread is recorded until the thread is
+ * finalized.
  * @author Tim Niemueller
  */
 
 /** Constructor. */
+AspectManager::AspectManager()
+{
+	// recursive, aspect providers register initializers during initialization
+	mutex_ = new Mutex(Mutex::RECURSIVE);
+}
+
+/** Destructor. */
 AspectManager::~AspectManager()
 {
 	std::map<std::string, AspectIniFin *>::iterator i;
@@ -68,6 +84,7 @@ AspectManager::~AspectManager()
 		delete i->second;
 	}
 	default_inifins_.clear();
+	delete mutex_;
 }
 
 /** Register initializer/finalizer.
@@ -76,6 +93,7 @@ AspectManager::~AspectManager()
 void
 AspectManager::register_inifin(AspectIniFin *inifin)
 {
+	MutexLocker lock(mutex_);
 	if (inifins_.find(inifin->get_aspect_name()) != inifins_.end()) {
 		throw Exception("An initializer for %s has already been registered", inifin->get_aspect_name());
 	}
@@ -88,6 +106,7 @@ AspectManager::register_inifin(AspectIniFin *inifin)
 void
 AspectManager::unregister_inifin(AspectIniFin *inifin)
 {
+	MutexLocker lock(mutex_);
 	if (inifins_.find(inifin->get_aspect_name()) == inifins_.end()) {
 		throw Exception("An initializer for %s has not been registered", inifin->get_aspect_name());
 	}
@@ -108,6 +127,7 @@ AspectManager::unregister_inifin(AspectIniFin *inifin)
 bool
 AspectManager::has_threads_for_aspect(const char *aspect_name)
 {
+	MutexLocker lock(mutex_);
 	return (threads_.find(aspect_name) != threads_.end()) && (!threads_[aspect_name].empty());
 }
 
@@ -118,7 +138,9 @@ AspectManager::init(Thread *thread)
 	if (aspected_thread != NULL) { // thread has aspects to initialize
 		const std::list<const char *> &aspects = aspected_thread->get_aspects();
 
-		std::list<const char *> initialized;
+		MutexLocker                     lock(mutex_);
+		std::list<const char *>         initialized;
+		std::map<std::string, long int> init_usec;
 
 		try {
 			std::list<const char *>::const_iterator i;
@@ -129,13 +151,17 @@ AspectManager::init(Thread *thread)
 					                                      thread->name(),
 					                                      *i);
 				}
+				Time start;
+				start.stamp_systime();
 				inifins_[*i]->init(thread);
+				init_usec[*i] = (Time().stamp_systime() - start).in_usec();
 				initialized.push_back(*i);
 			}
 
 			for (i = aspects.begin(); i != aspects.end(); ++i) {
 				threads_[*i].push_back(thread);
 			}
+			init_usec_[thread] = init_usec;
 		} catch (CannotInitializeThreadException &e) {
 			std::list<const char *>::const_reverse_iterator i;
 			for (i = initialized.rbegin(); i != initialized.rend(); ++i) {
@@ -161,6 +187,7 @@ AspectManager::finalize(Thread *thread)
 	if (aspected_thread != NULL) { // thread has aspects to finalize
 		const std::list<const char *> &aspects = aspected_thread->get_aspects();
 
+		MutexLocker                             lock(mutex_);
 		std::list<const char *>::const_iterator i;
 		for (i = aspects.begin(); i != aspects.end(); ++i) {
 			if (inifins_.find(*i) == inifins_.end()) {
@@ -177,6 +204,7 @@ AspectManager::finalize(Thread *thread)
 		for (i = aspects.begin(); i != aspects.end(); ++i) {
 			threads_[*i].remove(thread);
 		}
+		init_usec_.erase(thread);
 	}
 }
 
@@ -187,6 +215,7 @@ AspectManager::prepare_finalize(Thread *thread)
 	if (aspected_thread != NULL) { // thread has aspects to finalize
 		const std::list<const char *> &aspects = aspected_thread->get_aspects();
 
+		MutexLocker                             lock(mutex_);
 		std::list<const char *>::const_iterator i;
 		for (i = aspects.begin(); i != aspects.end(); ++i) {
 			if (inifins_.find(*i) == inifins_.end()) {
@@ -204,6 +233,44 @@ AspectManager::prepare_finalize(Thread *thread)
 	return true;
 }
 
+std::list<std::string>
+AspectManager::required_aspects(Thread *thread)
+{
+	std::list<std::string> rv;
+	Aspect *               aspected_thread = dynamic_cast<Aspect *>(thread);
+	if (aspected_thread != NULL) {
+		const std::list<const char *> &aspects = aspected_thread->get_aspects();
+		rv.insert(rv.end(), aspects.begin(), aspects.end());
+	}
+	return rv;
+}
+
+std::list<std::string>
+AspectManager::provided_aspects(Thread *thread)
+{
+	std::list<std::string> rv;
+	AspectProviderAspect * provider = dynamic_cast<AspectProviderAspect *>(thread);
+	if (provider != NULL) {
+		const std::list<AspectIniFin *> &inifins = provider->aspect_provider_aspects();
+		for (AspectIniFin *inifin : inifins) {
+			rv.push_back(inifin->get_aspect_name());
+		}
+	}
+	return rv;
+}
+
+std::map<std::string, long int>
+AspectManager::aspect_init_usec(Thread *thread)
+{
+	MutexLocker lock(mutex_);
+	std::map<Thread *, std::map<std::string, long int>>::iterator t = init_usec_.find(thread);
+	if (t != init_usec_.end()) {
+		return t->second;
+	} else {
+		return std::map<std::string, long int>();
+	}
+}
+
 /** Register default aspect initializer/finalizer.
  * This loads initializer/finalizer of all aspects which are in the
  * Fawkes aspect library.
@@ -26,6 +26,7 @@
 
 #include <core/threading/thread_finalizer.h>
 #include <core/threading/thread_initializer.h>
+#include <plugin/thread_aspect_info.h>
 
 #include <list>
 #include <map>
@@ -49,14 +50,16 @@ class BlockedTimingExecutor;
 class MainLoopEmployer;
 class AspectIniFin;
 class SyncPointManager;
+class Mutex;
 
 namespace tf {
 class Transformer;
 }
 
-class AspectManager : public ThreadInitializer, public ThreadFinalizer
+class AspectManager : public ThreadInitializer, public ThreadFinalizer, public ThreadAspectInfo
 {
 public:
+	AspectManager();
 	virtual ~AspectManager();
 
 	virtual void init(Thread *thread);
@@ -68,6 +71,11 @@ public:
 
 	bool has_threads_for_aspect(const char *aspect_name);
 
+	// for ThreadAspectInfo
+	virtual std::list<std::string>          required_aspects(Thread *thread);
+	virtual std::list<std::string>          provided_aspects(Thread *thread);
+	virtual std::map<std::string, long int> aspect_init_usec(Thread *thread);
+
 	void register_default_inifins(BlackBoard *           blackboard,
 	                              ThreadCollector *      collector,
 	                              Configuration *        config,
@@ -85,9 +93,12 @@ public:
 	                              SyncPointManager *     syncpoint_manager);
 
 private:
-	std::map<std::string, AspectIniFin *>      inifins_;
-	std::map<std::string, AspectIniFin *>      default_inifins_;
-	std::map<std::string, std::list<Thread *>> threads_;
+	Mutex *mutex_;
+
+	std::map<std::string, AspectIniFin *>               inifins_;
+	std::map<std::string, AspectIniFin *>               default_inifins_;
+	std::map<std::string, std::list<Thread *>>          threads_;
+	std::map<Thread *, std::map<std::string, long int>> init_usec_;
 };
 
 } // end namespace fawkes
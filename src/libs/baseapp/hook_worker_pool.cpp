@@ -0,0 +1,387 @@
+
+/***************************************************************************
+ *  hook_worker_pool.cpp - Worker pool to execute main loop hooks
+ *
+ *  Created: Sat Oct 17 20:12:45 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <aspect/blocked_timing.h>
+#include <baseapp/hook_worker_pool.h>
+#include <core/exception.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/thread.h>
+#include <core/threading/thread_list.h>
+#include <core/threading/wait_condition.h>
+#include <logging/logger.h>
+
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+class HookWorkerPool::WorkerThread : public Thread
+{
+public:
+	WorkerThread(HookWorkerPool *pool, unsigned int index, bool cpu_affinity)
+	: Thread("HookWorkerPool", Thread::OPMODE_CONTINUOUS),
+	  pool_(pool),
+	  index_(index),
+	  cpu_affinity_(cpu_affinity)
+	{
+		set_name("HookWorker-%u", index);
+	}
+
+	virtual void
+	once()
+	{
+		if (!cpu_affinity_)
+			return;
+#ifdef __linux__
+		long int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if (num_cpus < 1)
+			num_cpus = 1;
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(index_ % num_cpus, &cpuset);
+		int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+		if (err != 0) {
+			pool_->logger_->log_warn(name(), "Failed to set CPU affinity: %s", strerror(err));
+		}
+#else
+		pool_->logger_->log_warn(name(), "CPU affinity not supported on this platform");
+#endif
+	}
+
+	virtual void
+	loop()
+	{
+		Task task;
+		if (!pool_->next_task(index_, task)) {
+			exit();
+			return;
+		}
+
+		BlockedTimingAspect *timed_thread = dynamic_cast<BlockedTimingAspect *>(task.thread);
+		if (timed_thread)
+			timed_thread->blocked_timing_loop_begin();
+
+		bool executed = false;
+		try {
+			executed = task.thread->execute_loop();
+		} catch (Exception &e) {
+			executed = true;
+			pool_->logger_->log_error(name(),
+			                          "Loop of %s failed, exception follows",
+			                          task.thread->name());
+			pool_->logger_->log_error(name(), e);
+		} catch (std::exception &e) {
+			executed = true;
+			pool_->logger_->log_error(name(),
+			                          "Loop of %s failed with STL exception: %s",
+			                          task.thread->name(),
+			                          e.what());
+		}
+
+		if (executed && timed_thread) {
+			timed_thread->blocked_timing_loop_end();
+			// signal the end of the hook for this thread to other syncpoint waiters
+			timed_thread->post_loop(task.thread);
+		}
+
+		pool_->task_done(task);
+	}
+
+private:
+	HookWorkerPool *pool_;
+	unsigned int    index_;
+	bool            cpu_affinity_;
+};
+/// @endcond
+
+/** @class HookWorkerPool <baseapp/hook_worker_pool.h>
+ * Worker pool to execute main loop hooks.
+ * Instead of waking up each thread of a hook, the threads' loops are run as
+ * tasks on a fixed number of worker threads. This avoids a wakeup and context
+ * switch per thread and main loop iteration. The threads themselves are never
+ * woken up and remain blocked until they are finalized.
+ *
+ * Each worker has its own task queue. A thread is always queued with the same
+ * worker to keep its data in that worker's cache, idle workers steal tasks
+ * from the back of other workers' queues. The queues are protected by a
+ * single mutex, the number of threads per hook is small compared to the
+ * run time of their loops.
+ *
+ * A thread whose loop did not finish within the given time is flagged as bad
+ * and skipped until its loop returns, just like ThreadList::wakeup_and_wait()
+ * does for threads woken up directly.
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * @param logger logger for errors thrown by loops
+ * @param num_workers number of worker threads, 0 to use one per CPU core
+ * @param cpu_affinity true to pin each worker to one CPU core
+ */
+HookWorkerPool::HookWorkerPool(Logger *logger, unsigned int num_workers, bool cpu_affinity)
+{
+	logger_        = logger;
+	mutex_         = new Mutex();
+	work_waitcond_ = new WaitCondition(mutex_);
+	done_waitcond_ = new WaitCondition(mutex_);
+	num_queued_    = 0;
+	batch_         = 0;
+	batch_pending_ = 0;
+	quit_          = false;
+
+	if (num_workers == 0) {
+		long int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_workers       = (num_cpus > 0) ? num_cpus : 1;
+	}
+
+	queues_.resize(num_workers);
+	for (unsigned int i = 0; i < num_workers; ++i) {
+		WorkerThread *t = new WorkerThread(this, i, cpu_affinity);
+		workers_.push_back(t);
+		t->start();
+	}
+}
+
+/** Destructor.
+ * Stops all worker threads after their current task. Queued tasks are discarded.
+ */
+HookWorkerPool::~HookWorkerPool()
+{
+	mutex_->lock();
+	quit_ = true;
+	work_waitcond_->wake_all();
+	mutex_->unlock();
+
+	for (size_t i = 0; i < workers_.size(); ++i) {
+		workers_[i]->join();
+		delete workers_[i];
+	}
+
+	delete work_waitcond_;
+	delete done_waitcond_;
+	delete mutex_;
+}
+
+/** Get number of worker threads.
+ * @return number of worker threads
+ */
+unsigned int
+HookWorkerPool::num_workers() const
+{
+	return workers_.size();
+}
+
+/** Execute one loop iteration of the given threads.
+ * Queues a task for each thread and waits until all of them have finished.
+ * Threads still busy from an earlier call are skipped.
+ * @param threads threads to execute, must be in wait-for-wakeup mode and
+ * must not be woken up otherwise
+ * @param timeout_usec maximum time to wait in microseconds, 0 to wait
+ * until all threads have finished
+ * @exception Exception thrown if the timeout expired before all threads
+ * have finished, the unfinished threads are flagged as bad
+ */
+void
+HookWorkerPool::execute(ThreadList &threads, unsigned int timeout_usec)
+{
+	MutexLocker lock(mutex_);
+
+	batch_ += 1;
+	batch_pending_ = 0;
+
+	threads.lock();
+	for (ThreadList::iterator i = threads.begin(); i != threads.end(); ++i) {
+		if (scheduled_.find(*i) != scheduled_.end())
+			continue;
+
+		std::map<Thread *, size_t>::iterator a = affinity_.find(*i);
+		if (a == affinity_.end()) {
+			a = affinity_.insert(std::make_pair(*i, affinity_.size() % queues_.size())).first;
+		}
+		Task task = {*i, batch_};
+		queues_[a->second].push_back(task);
+		scheduled_[*i] = false;
+		num_queued_ += 1;
+		batch_pending_ += 1;
+	}
+	threads.unlock();
+
+	if (batch_pending_ == 0)
+		return;
+	work_waitcond_->wake_all();
+
+	if (timeout_usec == 0) {
+		while (batch_pending_ > 0)
+			done_waitcond_->wait();
+		return;
+	}
+
+	struct timespec until;
+	clock_gettime(CLOCK_REALTIME, &until);
+	until.tv_sec += timeout_usec / 1000000;
+	until.tv_nsec += (timeout_usec % 1000000) * 1000;
+	if (until.tv_nsec >= 1000000000) {
+		until.tv_sec += 1;
+		until.tv_nsec -= 1000000000;
+	}
+
+	while (batch_pending_ > 0) {
+		if (!done_waitcond_->abstimed_wait(until.tv_sec, until.tv_nsec))
+			break;
+	}
+
+	if (batch_pending_ > 0) {
+		// threads of earlier batches have been flagged already
+		std::list<Thread *> bad_threads;
+		for (std::map<Thread *, bool>::iterator s = scheduled_.begin(); s != scheduled_.end(); ++s) {
+			if (!s->first->flagged_bad()) {
+				s->first->set_flag(Thread::FLAG_BAD);
+				bad_threads.push_back(s->first);
+			}
+		}
+
+		if (bad_threads.size() == 1) {
+			throw Exception("Thread %s did not finish in time (max %f), flagging as bad",
+			                bad_threads.front()->name(),
+			                (float)timeout_usec / 1000000.);
+		}
+		std::string s = "Multiple threads did not finish in time, flagging as bad: ";
+		for (std::list<Thread *>::iterator i = bad_threads.begin(); i != bad_threads.end(); ++i) {
+			s += std::string((*i)->name()) + " ";
+		}
+		throw Exception("%s", s.c_str());
+	}
+}
+
+/** Release a thread.
+ * Must be called before the thread is finalized. A queued task for the
+ * thread is discarded, if the thread's loop is currently being executed this
+ * waits until it has finished.
+ * @param thread thread to release
+ */
+void
+HookWorkerPool::release(Thread *thread)
+{
+	MutexLocker lock(mutex_);
+
+	affinity_.erase(thread);
+
+	std::map<Thread *, bool>::iterator s = scheduled_.find(thread);
+	if (s == scheduled_.end())
+		return;
+
+	if (!s->second) {
+		for (size_t q = 0; q < queues_.size(); ++q) {
+			for (std::deque<Task>::iterator t = queues_[q].begin(); t != queues_[q].end(); ++t) {
+				if (t->thread == thread) {
+					if (t->batch == batch_)
+						batch_pending_ -= 1;
+					queues_[q].erase(t);
+					num_queued_ -= 1;
+					scheduled_.erase(s);
+					done_waitcond_->wake_all();
+					return;
+				}
+			}
+		}
+	}
+
+	while (scheduled_.find(thread) != scheduled_.end()) {
+		done_waitcond_->wait();
+	}
+}
+
+/** Get threads that have recovered.
+ * Threads which had been flagged as bad and whose loop has finished
+ * since the last call are appended and have their bad flag cleared.
+ * @param recovered_threads upon return contains the names of recovered threads
+ */
+void
+HookWorkerPool::try_recover(std::list<std::string> &recovered_threads)
+{
+	MutexLocker lock(mutex_);
+	recovered_threads.splice(recovered_threads.end(), recovered_threads_);
+}
+
+/** Get next task for a worker.
+ * Blocks until a task is available or the pool is being destroyed.
+ * @param worker index of the requesting worker
+ * @param task upon return contains the task to execute
+ * @return true if a task has been retrieved, false if the pool is
+ * being destroyed
+ */
+bool
+HookWorkerPool::next_task(unsigned int worker, Task &task)
+{
+	MutexLocker lock(mutex_);
+
+	while (!quit_) {
+		if (num_queued_ > 0) {
+			if (!queues_[worker].empty()) {
+				task = queues_[worker].front();
+				queues_[worker].pop_front();
+			} else {
+				for (size_t i = 1; i < queues_.size(); ++i) {
+					std::deque<Task> &victim = queues_[(worker + i) % queues_.size()];
+					if (!victim.empty()) {
+						task = victim.back();
+						victim.pop_back();
+						break;
+					}
+				}
+			}
+			num_queued_ -= 1;
+			scheduled_[task.thread] = true;
+			return true;
+		}
+		work_waitcond_->wait();
+	}
+
+	return false;
+}
+
+/** Mark task as finished.
+ * @param task task that has been executed
+ */
+void
+HookWorkerPool::task_done(const Task &task)
+{
+	MutexLocker lock(mutex_);
+
+	scheduled_.erase(task.thread);
+	if (task.batch == batch_) {
+		batch_pending_ -= 1;
+	}
+	if (task.thread->flagged_bad()) {
+		task.thread->unset_flag(Thread::FLAG_BAD);
+		recovered_threads_.push_back(task.thread->name());
+	}
+	done_waitcond_->wake_all();
+}
+
+} // end namespace fawkes
@@ -0,0 +1,86 @@
+
+/***************************************************************************
+ *  hook_worker_pool.h - Worker pool to execute main loop hooks
+ *
+ *  Created: Sat Oct 17 20:12:45 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _LIBS_BASEAPP_HOOK_WORKER_POOL_H_
+#define _LIBS_BASEAPP_HOOK_WORKER_POOL_H_
+
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+class Logger;
+class Mutex;
+class Thread;
+class ThreadList;
+class WaitCondition;
+
+class HookWorkerPool
+{
+public:
+	HookWorkerPool(Logger *logger, unsigned int num_workers = 0, bool cpu_affinity = false);
+	~HookWorkerPool();
+
+	unsigned int num_workers() const;
+
+	void execute(ThreadList &threads, unsigned int timeout_usec = 0);
+	void release(Thread *thread);
+	void try_recover(std::list<std::string> &recovered_threads);
+
+private:
+	/// @cond INTERNALS
+	class WorkerThread;
+
+	typedef struct
+	{
+		Thread *     thread;
+		unsigned int batch;
+	} Task;
+	/// @endcond
+
+	bool next_task(unsigned int worker, Task &task);
+	void task_done(const Task &task);
+
+private:
+	Logger *       logger_;
+	Mutex *        mutex_;
+	WaitCondition *work_waitcond_;
+	WaitCondition *done_waitcond_;
+
+	std::vector<WorkerThread *>   workers_;
+	std::vector<std::deque<Task>> queues_;
+	std::map<Thread *, bool>      scheduled_;
+	std::map<Thread *, size_t>    affinity_;
+	std::list<std::string>        recovered_threads_;
+
+	unsigned int num_queued_;
+	unsigned int batch_;
+	unsigned int batch_pending_;
+	bool         quit_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -21,7 +21,9 @@
  *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
  */
 
+#include <aspect/blocked_timing/profiler.h>
 #include <aspect/manager.h>
+#include <baseapp/hook_worker_pool.h>
 #include <baseapp/main_thread.h>
 #include <config/config.h>
 #include <core/exceptions/system.h>
@@ -77,6 +79,7 @@ FawkesMainThread::FawkesMainThread(Configuration *   config,
 	config_            = config;
 
 	mainloop_thread_  = NULL;
+	worker_pool_      = NULL;
 	mainloop_mutex_   = new Mutex();
 	mainloop_barrier_ = new InterruptibleBarrier(mainloop_mutex_, 2);
 
@@ -178,6 +181,11 @@ FawkesMainThread::destruct()
 	if (default_plugin_)
 		free(default_plugin_);
 
+	if (worker_pool_) {
+		thread_manager_->set_worker_pool(NULL, std::set<BlockedTimingAspect::WakeupHook>());
+		delete worker_pool_;
+	}
+
 	delete time_wait_;
 	delete loop_start_;
 	delete loop_end_;
@@ -206,21 +214,20 @@ void
 FawkesMainThread::once()
 {
 	// register to all syncpoints of the main loop
-	std::vector<BlockedTimingAspect::WakeupHook> hooks;
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_PRE_LOOP);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_ACQUIRE);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_PREPARE);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_PROCESS);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_WORLDSTATE);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_THINK);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_SKILL);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_ACT);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_ACT_EXEC);
-	hooks.push_back(BlockedTimingAspect::WAKEUP_HOOK_POST_LOOP);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_PRE_LOOP);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_ACQUIRE);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_PREPARE);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_PROCESS);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_WORLDSTATE);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_THINK);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_SKILL);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_ACT);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_ACT_EXEC);
+	hooks_.push_back(BlockedTimingAspect::WAKEUP_HOOK_POST_LOOP);
 
 	try {
-		for (std::vector<BlockedTimingAspect::WakeupHook>::const_iterator it = hooks.begin();
-		     it != hooks.end();
+		for (std::vector<BlockedTimingAspect::WakeupHook>::const_iterator it = hooks_.begin();
+		     it != hooks_.end();
 		     it++) {
 			syncpoints_start_hook_.push_back(syncpoint_manager_->get_syncpoint(
 			  "FawkesMainThread", BlockedTimingAspect::blocked_timing_hook_to_start_syncpoint(*it)));
@@ -233,6 +240,8 @@ FawkesMainThread::once()
 		throw;
 	}
 
+	init_worker_pool();
+
 	// if plugins passed on command line or in init options, load!
 	if (load_plugins_) {
 		try {
@@ -287,6 +296,63 @@ FawkesMainThread::once()
 		init_barrier_->wait();
 }
 
+/** Initialize worker pool.
+ * Threads of hooks listed in /fawkes/mainapp/worker_pool/hooks are not
+ * woken up through their start syncpoint, but their loops are executed as
+ * tasks on a pool of worker threads, see HookWorkerPool. This should only
+ * be used for hooks with independent threads. Threads waiting for the start
+ * syncpoint of a pooled hook are no longer woken up, the end syncpoint is
+ * still emitted for each thread.
+ */
+void
+FawkesMainThread::init_worker_pool()
+{
+	hooks_pooled_.assign(hooks_.size(), false);
+
+	std::vector<std::string> pool_hooks;
+	try {
+		pool_hooks = config_->get_strings("/fawkes/mainapp/worker_pool/hooks");
+	} catch (Exception &e) {
+	} // ignore, no hooks are pooled
+	if (pool_hooks.empty())
+		return;
+
+	std::set<BlockedTimingAspect::WakeupHook> pooled_hooks;
+	for (const std::string &h : pool_hooks) {
+		bool found = false;
+		for (size_t i = 0; i < hooks_.size(); ++i) {
+			if (h == BlockedTimingAspect::blocked_timing_hook_to_string(hooks_[i])) {
+				hooks_pooled_[i] = true;
+				pooled_hooks.insert(hooks_[i]);
+				found = true;
+			}
+		}
+		if (!found) {
+			multi_logger_->log_warn("FawkesMainThread", "Unknown hook %s for worker pool", h.c_str());
+		}
+	}
+	if (pooled_hooks.empty())
+		return;
+
+	unsigned int num_workers =
+	  config_->get_uint_or_default("/fawkes/mainapp/worker_pool/num_workers", 0);
+	bool cpu_affinity =
+	  config_->get_bool_or_default("/fawkes/mainapp/worker_pool/cpu_affinity", false);
+
+	worker_pool_ = new HookWorkerPool(multi_logger_, num_workers, cpu_affinity);
+	thread_manager_->set_worker_pool(worker_pool_, pooled_hooks);
+
+	std::string s;
+	for (const BlockedTimingAspect::WakeupHook &h : pooled_hooks) {
+		s += std::string(BlockedTimingAspect::blocked_timing_hook_to_string(h)) + " ";
+	}
+	multi_logger_->log_info("FawkesMainThread",
+	                        "Executing hooks on %u worker threads%s: %s",
+	                        worker_pool_->num_workers(),
+	                        cpu_affinity ? " (pinned to cores)" : "",
+	                        s.c_str());
+}
+
 void
 FawkesMainThread::set_mainloop_thread(Thread *mainloop_thread)
 {
@@ -338,16 +404,23 @@ FawkesMainThread::loop()
 			}
 		} else {
 			uint num_hooks = syncpoints_start_hook_.size();
-			if (syncpoints_end_hook_.size() != num_hooks) {
+			if (syncpoints_end_hook_.size() != num_hooks || hooks_pooled_.size() != num_hooks) {
 				multi_logger_->log_error(
 				  "FawkesMainThread",
 				  "Hook syncpoints are not initialized properly, not waking up any threads!");
 			} else {
+				BlockedTimingProfiler *profiler = BlockedTimingProfiler::instance();
 				for (uint i = 0; i < num_hooks; i++) {
-					syncpoints_start_hook_[i]->emit("FawkesMainThread");
-					syncpoints_end_hook_[i]->reltime_wait_for_all("FawkesMainThread",
-					                                              0,
-					                                              max_thread_time_nanosec_);
+					if (hooks_pooled_[i]) {
+						safe_wake(hooks_[i], max_thread_time_usec_);
+					} else {
+						profiler->hook_woken(hooks_[i]);
+						syncpoints_start_hook_[i]->emit("FawkesMainThread");
+						syncpoints_end_hook_[i]->reltime_wait_for_all("FawkesMainThread",
+						                                              0,
+						                                              max_thread_time_nanosec_);
+						profiler->hook_finished(hooks_[i]);
+					}
 				}
 			}
 		}
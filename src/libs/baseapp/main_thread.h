@@ -34,6 +34,7 @@
 
 #include <getopt.h>
 #include <list>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -54,6 +55,7 @@ class Mutex;
 class ThreadManager;
 class SyncPointManager;
 class FawkesNetworkManager;
+class HookWorkerPool;
 
 class FawkesMainThread : public Thread, public MainLoopEmployer
 {
@@ -103,6 +105,7 @@ protected:
 
 private:
 	void destruct();
+	void init_worker_pool();
 
 	inline void
 	safe_wake(BlockedTimingAspect::WakeupHook hook, unsigned int timeout_usec)
@@ -145,8 +148,11 @@ private:
 	Time *                 loop_end_;
 	bool                   enable_looptime_warnings_;
 
-	std::vector<RefPtr<SyncPoint>> syncpoints_start_hook_;
-	std::vector<RefPtr<SyncPoint>> syncpoints_end_hook_;
+	std::vector<RefPtr<SyncPoint>>               syncpoints_start_hook_;
+	std::vector<RefPtr<SyncPoint>>               syncpoints_end_hook_;
+	std::vector<BlockedTimingAspect::WakeupHook> hooks_;
+	std::vector<bool>                            hooks_pooled_;
+	HookWorkerPool *                             worker_pool_;
 };
 
 } // end namespace fawkes
@@ -334,6 +334,12 @@ init(const InitOptions &options, int &retval)
 		} // ignore, we stick with the default
 	}
 
+	bool net_use_epoll = false;
+	try {
+		net_use_epoll = config->get_bool("/network/fawkes/epoll");
+	} catch (Exception &e) {
+	} // ignore, we stick with the default
+
 	if (net_tcp_port > 65535) {
 		logger->log_warn("FawkesMainThread", "Invalid port '%u', using 1910", net_tcp_port);
 		net_tcp_port = 1910;
@@ -423,6 +429,7 @@ init(const InitOptions &options, int &retval)
 	                                   "/fawkes/meta_plugins/",
 	                                   options.plugin_module_flags(),
 	                                   options.init_plugin_cache());
+	plugin_manager->set_thread_aspect_info(aspect_manager);
 #ifdef HAVE_NETWORK_MANAGER
 	network_manager = new FawkesNetworkManager(thread_manager,
 	                                           enable_ipv4,
@@ -430,7 +437,8 @@ init(const InitOptions &options, int &retval)
 	                                           listen_ipv4,
 	                                           listen_ipv6,
 	                                           net_tcp_port,
-	                                           net_service_name.c_str());
+	                                           net_service_name.c_str(),
+	                                           net_use_epoll);
 #	ifdef HAVE_CONFIG_NETWORK_HANDLER
 	nethandler_config = new ConfigNetworkHandler(config, network_manager->hub());
 #	endif
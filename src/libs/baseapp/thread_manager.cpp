@@ -22,6 +22,8 @@
  */
 
 #include <aspect/blocked_timing.h>
+#include <aspect/blocked_timing/profiler.h>
+#include <baseapp/hook_worker_pool.h>
 #include <baseapp/thread_manager.h>
 #include <core/exceptions/software.h>
 #include <core/exceptions/system.h>
@@ -139,6 +141,7 @@ ThreadManager::ThreadManager()
 	waitcond_timedthreads_       = new WaitCondition();
 	interrupt_timed_thread_wait_ = false;
 	aspect_collector_            = new ThreadManagerAspectCollector(this);
+	worker_pool_                 = NULL;
 }
 
 /** Constructor.
@@ -155,6 +158,7 @@ ThreadManager::ThreadManager(ThreadInitializer *initializer, ThreadFinalizer *fi
 	waitcond_timedthreads_       = new WaitCondition();
 	interrupt_timed_thread_wait_ = false;
 	aspect_collector_            = new ThreadManagerAspectCollector(this);
+	worker_pool_                 = NULL;
 	set_inifin(initializer, finalizer);
 }
 
@@ -383,6 +387,10 @@ ThreadManager::remove_maybelocked(ThreadList &tl, bool lock)
 	tl.lock();
 	MutexLocker locker(threads_.mutex(), lock);
 
+	for (ThreadList::iterator i = tl.begin(); i != tl.end(); ++i) {
+		release_pooled_thread(*i);
+	}
+
 	try {
 		if (!tl.prepare_finalize(finalizer_)) {
 			tl.cancel_finalize();
@@ -438,6 +446,7 @@ ThreadManager::remove_maybelocked(Thread *thread, bool lock)
 	}
 
 	MutexLocker locker(threads_.mutex(), lock);
+	release_pooled_thread(thread);
 	try {
 		if (!thread->prepare_finalize()) {
 			thread->cancel_finalize();
@@ -482,6 +491,9 @@ ThreadManager::force_remove(ThreadList &tl)
 
 	tl.lock();
 	threads_.mutex()->stopby();
+	for (ThreadList::iterator i = tl.begin(); i != tl.end(); ++i) {
+		release_pooled_thread(*i);
+	}
 	bool      caught_exception = false;
 	Exception exc("Forced removal of thread list %s failed", tl.name());
 	try {
@@ -522,6 +534,7 @@ void
 ThreadManager::force_remove(fawkes::Thread *thread)
 {
 	MutexLocker lock(threads_.mutex());
+	release_pooled_thread(thread);
 	try {
 		thread->prepare_finalize();
 	} catch (Exception &e) {
@@ -548,10 +561,23 @@ ThreadManager::wakeup_and_wait(BlockedTimingAspect::WakeupHook hook, unsigned in
 		timeout_usec -= timeout_sec * 1000000;
 	}
 
+	BlockedTimingProfiler *profiler = BlockedTimingProfiler::instance();
+	profiler->hook_woken(hook);
+
 	// Note that the following lines might throw an exception, we just pass it on
 	if (threads_.find(hook) != threads_.end()) {
-		threads_[hook].wakeup_and_wait(timeout_sec, timeout_usec * 1000);
+		try {
+			if (worker_pool_ && pooled_hooks_.find(hook) != pooled_hooks_.end()) {
+				worker_pool_->execute(threads_[hook], timeout_sec * 1000000 + timeout_usec);
+			} else {
+				threads_[hook].wakeup_and_wait(timeout_sec, timeout_usec * 1000);
+			}
+		} catch (Exception &e) {
+			profiler->hook_finished(hook);
+			throw;
+		}
 	}
+	profiler->hook_finished(hook);
 }
 
 void
@@ -559,7 +585,11 @@ ThreadManager::wakeup(BlockedTimingAspect::WakeupHook hook, Barrier *barrier)
 {
 	MutexLocker lock(threads_.mutex());
 
+	BlockedTimingProfiler *profiler = BlockedTimingProfiler::instance();
 	if (threads_.find(hook) != threads_.end()) {
+		// the caller waits for the threads, the profiler considers the hook
+		// finished when the last of its threads has finished
+		profiler->hook_woken(hook, threads_[hook].size());
 		if (barrier) {
 			threads_[hook].wakeup(barrier);
 		} else {
@@ -568,6 +598,9 @@ ThreadManager::wakeup(BlockedTimingAspect::WakeupHook hook, Barrier *barrier)
 		if (threads_[hook].size() == 0) {
 			threads_.erase(hook);
 		}
+	} else {
+		profiler->hook_woken(hook);
+		profiler->hook_finished(hook);
 	}
 }
 
@@ -578,6 +611,9 @@ ThreadManager::try_recover(std::list<std::string> &recovered_threads)
 	for (tit_ = threads_.begin(); tit_ != threads_.end(); ++tit_) {
 		tit_->second.try_recover(recovered_threads);
 	}
+	if (worker_pool_) {
+		worker_pool_->try_recover(recovered_threads);
+	}
 	threads_.unlock();
 }
 
@@ -605,6 +641,37 @@ ThreadManager::interrupt_timed_thread_wait()
 	waitcond_timedthreads_->wake_all();
 }
 
+/** Set worker pool to execute hooks.
+ * The threads of the given hooks are no longer woken up by
+ * wakeup_and_wait(), instead their loops are executed on the worker pool.
+ * The hook's threads must then not be woken up by any other means, in
+ * particular the start syncpoint of these hooks must not be emitted.
+ * @param pool worker pool, NULL to disable pooled execution
+ * @param hooks hooks whose threads to execute on the pool
+ */
+void
+ThreadManager::set_worker_pool(HookWorkerPool *                                 pool,
+                               const std::set<BlockedTimingAspect::WakeupHook> &hooks)
+{
+	MutexLocker lock(threads_.mutex());
+	worker_pool_  = pool;
+	pooled_hooks_ = hooks;
+}
+
+/** Release thread from worker pool.
+ * Discards a queued loop execution of the thread or waits until the
+ * currently running one has finished. Must be called before the thread
+ * is finalized.
+ * @param t thread to release
+ */
+void
+ThreadManager::release_pooled_thread(Thread *t)
+{
+	if (worker_pool_ && dynamic_cast<BlockedTimingAspect *>(t)) {
+		worker_pool_->release(t);
+	}
+}
+
 /** Get a thread collector to be used for an aspect initializer.
  * @return thread collector instance to use for ThreadProducerAspect.
  */
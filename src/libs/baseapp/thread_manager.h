@@ -32,8 +32,10 @@
 #include <core/utils/lock_map.h>
 
 #include <list>
+#include <set>
 
 namespace fawkes {
+class HookWorkerPool;
 class Mutex;
 class WaitCondition;
 class ThreadInitializer;
@@ -85,9 +87,13 @@ public:
 
 	ThreadCollector *aspect_collector() const;
 
+	void set_worker_pool(HookWorkerPool *                                 pool,
+	                     const std::set<BlockedTimingAspect::WakeupHook> &hooks);
+
 private:
 	void internal_add_thread(Thread *t);
 	void internal_remove_thread(Thread *t);
+	void release_pooled_thread(Thread *t);
 	void add_maybelocked(ThreadList &tl, bool lock);
 	void add_maybelocked(Thread *t, bool lock);
 	void remove_maybelocked(ThreadList &tl, bool lock);
@@ -123,6 +129,9 @@ private:
 
 	ThreadManagerAspectCollector *aspect_collector_;
 	bool                          interrupt_timed_thread_wait_;
+
+	HookWorkerPool *                          worker_pool_;
+	std::set<BlockedTimingAspect::WakeupHook> pooled_hooks_;
 };
 
 } // end namespace fawkes
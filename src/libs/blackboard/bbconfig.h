@@ -24,10 +24,13 @@
 #ifndef _BLACKBOARD_BBCONFIG_H_
 #define _BLACKBOARD_BBCONFIG_H_
 
-#define BLACKBOARD_VERSION 1
+#define BLACKBOARD_VERSION 3
 
 // Can be used as useful defaults
 #define BLACKBOARD_MEMSIZE 2 * 1024 * 1024
 #define BLACKBOARD_MAGIC_TOKEN "FawkesBlackBoard"
 
+// Number of threads delivering asynchronous listener events
+#define BLACKBOARD_EVENT_DISPATCH_THREADS 2
+
 #endif
@@ -74,6 +74,15 @@ namespace fawkes {
  * the instance is deleted and afterwards an event for that very interface
  * happens. A warning is reported via the LibLogger whenever you forget this.
  *
+ * By default, data events are delivered synchronously in the thread that
+ * calls Interface::write(). Listeners that need more time to process data
+ * events, for example to log them, can request asynchronous delivery with
+ * bbil_set_async_data_events() before registering. Data events are then put
+ * into a bounded queue for this listener and delivered by a dispatcher thread
+ * of the BlackBoard. Repeated refreshes of the same interface which have not
+ * been delivered yet are coalesced into a single event. Since the event is
+ * delivered later, the shared memory may already contain newer data.
+ *
  * @author Tim Niemueller
  * @see BlackBoardInterfaceManager::register_listener()
  * @see BlackBoardInterfaceManager::unregister_listener()
@@ -94,6 +103,12 @@ BlackBoardInterfaceListener::BlackBoardInterfaceListener(const char *name_format
 
 	bbil_queue_mutex_ = new Mutex();
 	bbil_maps_mutex_  = new Mutex();
+
+	bbil_async_data_          = false;
+	bbil_async_coalesce_      = true;
+	bbil_async_queue_length_  = 32;
+	bbil_async_num_coalesced_ = 0;
+	bbil_async_num_dropped_   = 0;
 }
 
 /** Destructor. */
@@ -114,6 +129,38 @@ BlackBoardInterfaceListener::bbil_name() const
 	return name_;
 }
 
+/** Check if data events are delivered asynchronously.
+ * @return true if asynchronous data event delivery has been requested
+ * @see bbil_set_async_data_events()
+ */
+bool
+BlackBoardInterfaceListener::bbil_async_data_events() const
+{
+	return bbil_async_data_;
+}
+
+/** Get number of coalesced data events.
+ * Only applies to asynchronous data event delivery.
+ * @return number of data events that have been merged into an already queued
+ * event for the same interface
+ */
+unsigned int
+BlackBoardInterfaceListener::bbil_num_coalesced_data_events() const
+{
+	return bbil_async_num_coalesced_;
+}
+
+/** Get number of dropped data events.
+ * Only applies to asynchronous data event delivery.
+ * @return number of data events that have been dropped because the event
+ * queue of this listener was full
+ */
+unsigned int
+BlackBoardInterfaceListener::bbil_num_dropped_data_events() const
+{
+	return bbil_async_num_dropped_;
+}
+
 /** BlackBoard data refreshed notification.
  * This is called whenever the data in an interface that you registered for is
  * refreshed. This happens when a writer calls the Interface::write(), regardless
@@ -332,6 +379,27 @@ BlackBoardInterfaceListener::bbil_remove_writer_interface(Interface *interface)
 	bbil_queue_add(WRITER, false, bbil_maps_.writer, interface, "writer");
 }
 
+/** Set asynchronous data event delivery.
+ * When enabled, data refreshed and changed events are not delivered in the
+ * thread of the writer, but queued and delivered by a dispatcher thread.
+ * This must be called before the listener is registered with the BlackBoard.
+ * @param enabled true to enable asynchronous delivery, false to get the
+ * events synchronously (default)
+ * @param queue_length maximum number of pending events, further events are
+ * dropped while the queue is full
+ * @param coalesce true to merge a refresh of an interface for which an event
+ * is still pending into the pending event, false to queue every event
+ */
+void
+BlackBoardInterfaceListener::bbil_set_async_data_events(bool         enabled,
+                                                        unsigned int queue_length,
+                                                        bool         coalesce)
+{
+	bbil_async_data_         = enabled;
+	bbil_async_queue_length_ = queue_length;
+	bbil_async_coalesce_     = coalesce;
+}
+
 const BlackBoardInterfaceListener::InterfaceQueue &
 BlackBoardInterfaceListener::bbil_acquire_queue() throw()
 {
@@ -488,6 +556,24 @@ BlackBoardInterfaceListener::bbil_data_interface(const char *iuid) throw()
 	return bbil_find_interface(iuid, bbil_maps_.data);
 }
 
+/** Check if an interface instance is in the data map.
+ * Used to validate interface instances of queued data events before they
+ * are delivered asynchronously.
+ * @param interface interface instance to look for
+ * @return true if the interface has been added for data events, false otherwise
+ */
+bool
+BlackBoardInterfaceListener::bbil_has_data_interface(const Interface *interface) throw()
+{
+	MutexLocker            lock(bbil_maps_mutex_);
+	InterfaceMap::iterator i;
+	for (i = bbil_maps_.data.begin(); i != bbil_maps_.data.end(); ++i) {
+		if (i->second == interface)
+			return true;
+	}
+	return false;
+}
+
 /** Get interface instance for given UID.
  * A message received notification is about to be triggered. For this the
  * interface instance that has been added to the event listener is determined.
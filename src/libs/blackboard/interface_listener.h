@@ -28,6 +28,7 @@
 #include <core/utils/lock_queue.h>
 #include <utils/misc/string_compare.h>
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <string>
@@ -37,10 +38,12 @@ namespace fawkes {
 class Interface;
 class Message;
 class BlackBoardNotifier;
+class BlackBoardEventDispatcher;
 
 class BlackBoardInterfaceListener
 {
 	friend BlackBoardNotifier;
+	friend BlackBoardEventDispatcher;
 
 public:
 	/** Queue entry type. */
@@ -79,6 +82,10 @@ public:
 
 	const char *bbil_name() const;
 
+	bool         bbil_async_data_events() const;
+	unsigned int bbil_num_coalesced_data_events() const;
+	unsigned int bbil_num_dropped_data_events() const;
+
 	virtual void bb_interface_data_refreshed(Interface *interface) throw();
 	virtual void bb_interface_data_changed(Interface *interface) throw();
 	virtual bool bb_interface_message_received(Interface *interface, Message *message) throw();
@@ -98,6 +105,10 @@ protected:
 	void bbil_remove_reader_interface(Interface *interface);
 	void bbil_remove_writer_interface(Interface *interface);
 
+	void bbil_set_async_data_events(bool         enabled,
+	                                unsigned int queue_length = 32,
+	                                bool         coalesce     = true);
+
 	Interface *bbil_data_interface(const char *iuid) throw();
 	Interface *bbil_message_interface(const char *iuid) throw();
 	Interface *bbil_reader_interface(const char *iuid) throw();
@@ -110,6 +121,7 @@ private:
 	                          Interface *    interface,
 	                          const char *   hint);
 	Interface *bbil_find_interface(const char *iuid, InterfaceMap &map);
+	bool       bbil_has_data_interface(const Interface *interface) throw();
 
 	const InterfaceQueue &bbil_acquire_queue() throw();
 	void                  bbil_release_queue(BlackBoard::ListenerRegisterFlag flag) throw();
@@ -124,6 +136,12 @@ private:
 	InterfaceMaps  bbil_maps_;
 	InterfaceQueue bbil_queue_;
 
+	bool                      bbil_async_data_;
+	bool                      bbil_async_coalesce_;
+	unsigned int              bbil_async_queue_length_;
+	std::atomic<unsigned int> bbil_async_num_coalesced_;
+	std::atomic<unsigned int> bbil_async_num_dropped_;
+
 	char *name_;
 };
 
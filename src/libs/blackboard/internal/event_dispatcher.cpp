@@ -0,0 +1,365 @@
+
+/***************************************************************************
+ *  event_dispatcher.cpp - BlackBoard asynchronous event dispatcher
+ *
+ *  Created: Sat Oct 17 15:21:40 2026
+ *  Copyright  2006-2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <blackboard/interface_listener.h>
+#include <blackboard/internal/event_dispatcher.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/thread.h>
+#include <core/threading/wait_condition.h>
+#include <interface/interface.h>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+class BlackBoardEventDispatcher::WorkerThread : public Thread
+{
+public:
+	WorkerThread(BlackBoardEventDispatcher *dispatcher, unsigned int num)
+	: Thread("BlackBoardEventDispatcher", Thread::OPMODE_CONTINUOUS), dispatcher_(dispatcher)
+	{
+		set_name("BlackBoardEventDispatcher-%u", num);
+	}
+
+	virtual void
+	loop()
+	{
+		if (!dispatcher_->dispatch_next()) {
+			exit();
+		}
+	}
+
+private:
+	BlackBoardEventDispatcher *dispatcher_;
+};
+/// @endcond
+
+/** @class BlackBoardEventDispatcher <blackboard/internal/event_dispatcher.h>
+ * BlackBoard asynchronous event dispatcher.
+ * Delivers data events to listeners which requested asynchronous delivery
+ * with BlackBoardInterfaceListener::bbil_set_async_data_events(). Each such
+ * listener has its own bounded event queue with its own lock, so writers
+ * notifying different listeners do not contend. A queued event refers to
+ * the listener's interface instance, which is validated before delivery.
+ * Listeners with pending events are put on a ready list and processed by
+ * a fixed pool of worker threads. A listener is only served by one worker
+ * at a time, hence events are delivered in order and a listener is never
+ * called concurrently. Events for the same listener are delivered in
+ * batches, i.e. a worker delivers all events pending at the time it picks
+ * up the listener.
+ *
+ * A removed listener is kept as a tombstone, such that a notification
+ * which raced with the removal recognizes the listener as removed instead
+ * of accessing a possibly deleted listener. Tombstones are purged with
+ * purge_removed() once no notification is in progress.
+ *
+ * Locks are always taken in the order queue map, ready list, listener queue.
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * @param num_threads number of worker threads to deliver events
+ */
+BlackBoardEventDispatcher::BlackBoardEventDispatcher(unsigned int num_threads)
+{
+	mutex_          = new Mutex();
+	ready_waitcond_ = new WaitCondition(mutex_);
+	quit_           = false;
+	num_removed_    = 0;
+
+	for (unsigned int i = 0; i < num_threads; ++i) {
+		WorkerThread *t = new WorkerThread(this, i);
+		threads_.push_back(t);
+		t->start();
+	}
+}
+
+/** Destructor.
+ * Stops all worker threads. Pending events are discarded.
+ */
+BlackBoardEventDispatcher::~BlackBoardEventDispatcher()
+{
+	mutex_->lock();
+	quit_ = true;
+	ready_waitcond_->wake_all();
+	mutex_->unlock();
+
+	for (std::list<WorkerThread *>::iterator t = threads_.begin(); t != threads_.end(); ++t) {
+		(*t)->join();
+		delete *t;
+	}
+
+	for (ListenerQueueMap::iterator q = queues_.begin(); q != queues_.end(); ++q) {
+		delete q->second;
+	}
+
+	delete ready_waitcond_;
+	delete mutex_;
+}
+
+/** Add listener.
+ * Creates the event queue of the listener, or revives the tombstone of a
+ * removed listener at the same address. Events still being delivered to
+ * the removed listener are discarded. Adding a listener which has already
+ * been added is a no-op.
+ * @param listener listener to add
+ */
+void
+BlackBoardEventDispatcher::add_listener(BlackBoardInterfaceListener *listener)
+{
+	queues_.lock_for_write();
+	ListenerQueueMap::iterator q = queues_.find(listener);
+	if (q == queues_.end()) {
+		queues_[listener] = new ListenerQueue(listener);
+	} else {
+		MutexLocker lock(q->second->mutex);
+		if (q->second->removed) {
+			q->second->reset();
+			num_removed_ -= 1;
+		}
+	}
+	queues_.unlock();
+}
+
+/** Enqueue data event.
+ * If the listener requested coalescing and there is still an event pending
+ * for the given interface, the event is merged into the pending one.
+ * Otherwise it is appended to the queue of the listener, or dropped if that
+ * queue is full. Events for removed or unknown listeners are dropped
+ * silently. The listener is only accessed while it is known to be valid.
+ * @param listener listener to deliver the event to
+ * @param uid UID of the interface which has been refreshed
+ * @param has_changed true if the data has changed
+ */
+void
+BlackBoardEventDispatcher::enqueue_data_event(BlackBoardInterfaceListener *listener,
+                                              const char *                 uid,
+                                              bool                         has_changed)
+{
+	queues_.lock_for_read();
+	ListenerQueueMap::iterator q = queues_.find(listener);
+	if (q == queues_.end()) {
+		queues_.unlock();
+		return;
+	}
+	ListenerQueue *lq       = q->second;
+	bool           schedule = false;
+
+	lq->mutex->lock();
+	Interface *iface = lq->removed ? NULL : listener->bbil_data_interface(uid);
+	if (iface != NULL) {
+		std::vector<DataEvent>::iterator e = lq->events.end();
+		if (lq->coalesce) {
+			for (e = lq->events.begin(); e != lq->events.end(); ++e) {
+				if (e->interface == iface)
+					break;
+			}
+		}
+
+		if (e != lq->events.end()) {
+			e->changed |= has_changed;
+			listener->bbil_async_num_coalesced_ += 1;
+		} else if (lq->events.size() >= lq->queue_length) {
+			listener->bbil_async_num_dropped_ += 1;
+		} else {
+			DataEvent de = {iface, has_changed};
+			lq->events.push_back(de);
+			if (!lq->scheduled) {
+				lq->scheduled = true;
+				schedule      = true;
+			}
+		}
+	}
+	lq->mutex->unlock();
+
+	if (schedule) {
+		MutexLocker lock(mutex_);
+		ready_.push_back(lq);
+		ready_waitcond_->wake_one();
+	}
+	queues_.unlock();
+}
+
+/** Remove listener.
+ * Discards all pending events of the listener and keeps a tombstone until
+ * the next call to purge_removed(). If the listener is currently being
+ * served by a worker thread, waits until the worker is done. It is
+ * therefore safe to delete the listener after this method returns. If
+ * called from within an event handler of the listener itself, it returns
+ * immediately and the listener's events are discarded once the handler
+ * returns.
+ * @param listener listener to remove
+ */
+void
+BlackBoardEventDispatcher::remove_listener(BlackBoardInterfaceListener *listener)
+{
+	queues_.lock_for_read();
+	ListenerQueueMap::iterator q = queues_.find(listener);
+	if (q == queues_.end()) {
+		queues_.unlock();
+		return;
+	}
+	ListenerQueue *lq = q->second;
+
+	MutexLocker lock(lq->mutex);
+	if (!lq->removed) {
+		lq->events.clear();
+		lq->removed = true;
+		lq->generation += 1;
+		num_removed_ += 1;
+	}
+
+	// the queue is not purged while we are waiting, release the map such
+	// that the listener being served may add and remove listeners
+	Thread *current = Thread::current_thread_noexc();
+	lq->waiting += 1;
+	queues_.unlock();
+	while (lq->dispatching != NULL && lq->dispatching != current) {
+		lq->idle_waitcond->wait();
+	}
+	lq->waiting -= 1;
+}
+
+/** Purge tombstones of removed listeners.
+ * Must only be called while no data notification is in progress, i.e.
+ * while no notification can have seen the removed listeners as registered.
+ */
+void
+BlackBoardEventDispatcher::purge_removed()
+{
+	if (num_removed_ == 0)
+		return;
+
+	queues_.lock_for_write();
+	MutexLocker                lock(mutex_);
+	ListenerQueueMap::iterator q = queues_.begin();
+	while (q != queues_.end()) {
+		ListenerQueue *lq = q->second;
+		lq->mutex->lock();
+		bool purge = lq->removed && lq->dispatching == NULL && lq->waiting == 0;
+		lq->mutex->unlock();
+		if (purge) {
+			ready_.remove(lq);
+			delete lq;
+			queues_.erase(q++);
+			num_removed_ -= 1;
+		} else {
+			++q;
+		}
+	}
+	queues_.unlock();
+}
+
+/** Deliver events of the next ready listener.
+ * Blocks until a listener has pending events or the dispatcher is shut down.
+ * @return true if events have been processed, false if the dispatcher is
+ * being shut down
+ */
+bool
+BlackBoardEventDispatcher::dispatch_next()
+{
+	MutexLocker lock(mutex_);
+
+	while (!quit_ && ready_.empty()) {
+		ready_waitcond_->wait();
+	}
+	if (quit_)
+		return false;
+
+	ListenerQueue *lq = ready_.front();
+	ready_.pop_front();
+
+	lq->mutex->lock();
+	lq->delivering.swap(lq->events);
+	lq->dispatching         = Thread::current_thread_noexc();
+	unsigned int generation = lq->generation;
+	lq->mutex->unlock();
+	lock.unlock();
+
+	// the listener may be removed by one of its own handlers
+	BlackBoardInterfaceListener *listener = lq->listener;
+	for (std::vector<DataEvent>::iterator e = lq->delivering.begin(); e != lq->delivering.end();
+	     ++e) {
+		if (!lq->valid(generation))
+			break;
+		if (listener->bbil_has_data_interface(e->interface)) {
+			listener->bb_interface_data_refreshed(e->interface);
+			if (e->changed && lq->valid(generation))
+				listener->bb_interface_data_changed(e->interface);
+		}
+	}
+	lq->delivering.clear();
+
+	lock.relock();
+	lq->mutex->lock();
+	lq->dispatching = NULL;
+	if (!lq->removed && !lq->events.empty()) {
+		ready_.push_back(lq);
+	} else {
+		lq->scheduled = false;
+	}
+	lq->idle_waitcond->wake_all();
+	lq->mutex->unlock();
+
+	return true;
+}
+
+/// @cond INTERNALS
+BlackBoardEventDispatcher::ListenerQueue::ListenerQueue(BlackBoardInterfaceListener *listener)
+: listener(listener)
+{
+	mutex         = new Mutex();
+	idle_waitcond = new WaitCondition(mutex);
+	scheduled     = false;
+	generation    = 0;
+	waiting       = 0;
+	dispatching   = NULL;
+	reset();
+	delivering.reserve(queue_length);
+}
+
+BlackBoardEventDispatcher::ListenerQueue::~ListenerQueue()
+{
+	delete idle_waitcond;
+	delete mutex;
+}
+
+void
+BlackBoardEventDispatcher::ListenerQueue::reset()
+{
+	queue_length = listener->bbil_async_queue_length_;
+	coalesce     = listener->bbil_async_coalesce_;
+	removed      = false;
+	events.clear();
+	events.reserve(queue_length);
+}
+
+bool
+BlackBoardEventDispatcher::ListenerQueue::valid(unsigned int generation)
+{
+	MutexLocker lock(mutex);
+	return !removed && this->generation == generation;
+}
+/// @endcond
+
+} // end namespace fawkes
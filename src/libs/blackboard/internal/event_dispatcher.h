@@ -0,0 +1,105 @@
+
+/***************************************************************************
+ *  event_dispatcher.h - BlackBoard asynchronous event dispatcher
+ *
+ *  Created: Sat Oct 17 15:21:40 2026
+ *  Copyright  2006-2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _BLACKBOARD_EVENT_DISPATCHER_H_
+#define _BLACKBOARD_EVENT_DISPATCHER_H_
+
+#include <core/utils/rwlock_map.h>
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace fawkes {
+
+class BlackBoardInterfaceListener;
+class Interface;
+class Mutex;
+class WaitCondition;
+class Thread;
+
+class BlackBoardEventDispatcher
+{
+public:
+	BlackBoardEventDispatcher(unsigned int num_threads);
+	~BlackBoardEventDispatcher();
+
+	void add_listener(BlackBoardInterfaceListener *listener);
+	void enqueue_data_event(BlackBoardInterfaceListener *listener,
+	                        const char *                 uid,
+	                        bool                         has_changed);
+	void remove_listener(BlackBoardInterfaceListener *listener);
+	void purge_removed();
+
+private:
+	class WorkerThread;
+	friend WorkerThread;
+
+	bool dispatch_next();
+
+	/// @cond INTERNALS
+	typedef struct
+	{
+		Interface *interface;
+		bool       changed;
+	} DataEvent;
+
+	class ListenerQueue
+	{
+	public:
+		ListenerQueue(BlackBoardInterfaceListener *listener);
+		~ListenerQueue();
+
+		void reset();
+		bool valid(unsigned int generation);
+
+		BlackBoardInterfaceListener *listener;
+		Mutex *                      mutex;
+		WaitCondition *              idle_waitcond;
+		std::vector<DataEvent>       events;
+		std::vector<DataEvent>       delivering;
+		unsigned int                 queue_length;
+		bool                         coalesce;
+		bool                         scheduled;
+		bool                         removed;
+		unsigned int                 generation;
+		unsigned int                 waiting;
+		Thread *                     dispatching;
+	};
+	/// @endcond
+
+	typedef RWLockMap<BlackBoardInterfaceListener *, ListenerQueue *> ListenerQueueMap;
+
+	Mutex *                   mutex_;
+	WaitCondition *           ready_waitcond_;
+	bool                      quit_;
+	std::atomic<unsigned int> num_removed_;
+
+	std::list<ListenerQueue *> ready_;
+	ListenerQueueMap           queues_;
+	std::list<WorkerThread *>  threads_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -42,14 +42,55 @@
 #include <cstdlib>
 #include <cstring>
 #include <fnmatch.h>
+#include <stdint.h>
 
 namespace fawkes {
 
+/// @cond INTERNALS
+// maximum number of cached pattern matches, cache is cleared when exceeded
+#define GLOB_CACHE_MAX_ENTRIES 64
+
+// FNV-1a hash of the UID of an interface
+static unsigned int
+uid_hash(const char *type, const char *identifier)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; (i < INTERFACE_TYPE_SIZE_) && type[i]; ++i) {
+		h = (h ^ (unsigned char)type[i]) * 16777619u;
+	}
+	h = (h ^ ':') * 16777619u;
+	h = (h ^ ':') * 16777619u;
+	for (size_t i = 0; (i < INTERFACE_ID_SIZE_) && identifier[i]; ++i) {
+		h = (h ^ (unsigned char)identifier[i]) * 16777619u;
+	}
+	return h;
+}
+
+// check if the pattern contains any characters special to fnmatch()
+static bool
+is_glob_pattern(const char *pattern, int flags)
+{
+	for (const char *c = pattern; *c; ++c) {
+		if ((*c == '*') || (*c == '?') || (*c == '[')
+		    || ((*c == '\\') && !(flags & FNM_NOESCAPE))) {
+			return true;
+		}
+	}
+	return false;
+}
+/// @endcond
+
 /** @class BlackBoardInterfaceManager <blackboard/internal/interface_manager.h>
  * BlackBoard interface manager.
  * This class is used by the BlackBoard to manage interfaces stored in the
  * shared memory.
  *
+ * Interfaces are added to the chunk index of the memory manager by a hash
+ * of their UID. Opening an interface therefore does not require to iterate
+ * over all interfaces in the shared memory. The interfaces matching a
+ * particular pair of type and ID patterns are cached until interfaces are
+ * created or destroyed.
+ *
  * @author Tim Niemueller
  */
 
@@ -69,6 +110,7 @@ BlackBoardInterfaceManager::BlackBoardInterfaceManager(BlackBoardMemoryManager *
 	notifier = bb_notifier;
 
 	instance_serial  = 1;
+	mem_serial_      = 0;
 	instance_factory = new BlackBoardInstanceFactory();
 	mutex            = new Mutex();
 
@@ -130,45 +172,111 @@ BlackBoardInterfaceManager::delete_interface_instance(Interface *interface)
 	instance_factory->delete_interface_instance(interface);
 }
 
-/** search memory chunks if the desired interface has been allocated already.
+/** Search memory chunks if the desired interface has been allocated already.
+ * The memory must be locked while calling this.
  * @param type type of the interface to look for
  * @param identifier identifier of the interface to look for
  * @return a pointer to the memory of the interface or NULL if not found
  */
 void *
-BlackBoardInterfaceManager::find_interface_in_memory(const char *type, const char *identifier)
+BlackBoardInterfaceManager::find_interface_in_memory(const char *type,
+                                                     const char *identifier) const
 {
-	interface_header_t *                   ih;
-	BlackBoardMemoryManager::ChunkIterator cit;
-	for (cit = memmgr->begin(); cit != memmgr->end(); ++cit) {
-		ih = (interface_header_t *)*cit;
+	void *ptr = memmgr->index_find(uid_hash(type, identifier));
+	while (ptr) {
+		interface_header_t *ih = (interface_header_t *)ptr;
 		if ((strncmp(ih->type, type, INTERFACE_TYPE_SIZE_) == 0)
 		    && (strncmp(ih->id, identifier, INTERFACE_ID_SIZE_) == 0)) {
 			// found it!
-			return *cit;
+			return ptr;
 		}
+		ptr = memmgr->index_find_next(ptr);
 	}
 
 	return NULL;
 }
 
-/** Get next mem serial.
- * @return next unique memory serial
+/** Search memory chunks for interfaces matching the given patterns.
+ * Patterns without wildcards are looked up in the chunk index. Otherwise
+ * the result is cached until an interface is created or destroyed. The memory
+ * must be locked while calling this.
+ * @param type_pattern pattern of interface types, cf. man fnmatch()
+ * @param id_pattern pattern of interface IDs, cf. man fnmatch()
+ * @param flags flags passed to fnmatch()
+ * @return pointers to the memory of matching interfaces
  */
-unsigned int
-BlackBoardInterfaceManager::next_mem_serial()
+std::vector<void *>
+BlackBoardInterfaceManager::find_interfaces_in_memory(const char *type_pattern,
+                                                      const char *id_pattern,
+                                                      int         flags) const
 {
-	unsigned int                           serial = 1;
+	if (!is_glob_pattern(type_pattern, flags) && !is_glob_pattern(id_pattern, flags)) {
+		std::vector<void *> rv;
+		if ((strlen(type_pattern) < INTERFACE_TYPE_SIZE_)
+		    && (strlen(id_pattern) < INTERFACE_ID_SIZE_)) {
+			void *ptr = find_interface_in_memory(type_pattern, id_pattern);
+			if (ptr)
+				rv.push_back(ptr);
+		}
+		return rv;
+	}
+
+	std::string key = std::string(type_pattern) + '\0' + id_pattern + '\0' + std::to_string(flags);
+	std::map<std::string, GlobCacheEntry>::iterator c = glob_cache_.find(key);
+	if (c != glob_cache_.end()) {
+		if (c->second.generation == memmgr->generation()) {
+			return c->second.chunks;
+		}
+	} else if (glob_cache_.size() >= GLOB_CACHE_MAX_ENTRIES) {
+		glob_cache_.clear();
+	}
+
+	GlobCacheEntry &entry = glob_cache_[key];
+	entry.generation      = memmgr->generation();
+	entry.chunks.clear();
+
 	interface_header_t *                   ih;
 	BlackBoardMemoryManager::ChunkIterator cit;
 	for (cit = memmgr->begin(); cit != memmgr->end(); ++cit) {
 		ih = (interface_header_t *)*cit;
-		if (ih->serial >= serial) {
-			serial = ih->serial + 1;
+
+		// ensure 0-termination
+		char type[INTERFACE_TYPE_SIZE_ + 1];
+		char id[INTERFACE_ID_SIZE_ + 1];
+		type[INTERFACE_TYPE_SIZE_] = 0;
+		id[INTERFACE_ID_SIZE_]     = 0;
+		strncpy(type, ih->type, INTERFACE_TYPE_SIZE_);
+		strncpy(id, ih->id, INTERFACE_ID_SIZE_);
+
+		if ((fnmatch(type_pattern, type, flags) == 0) && (fnmatch(id_pattern, id, flags) == 0)) {
+			entry.chunks.push_back(*cit);
 		}
 	}
 
-	return serial;
+	return entry.chunks;
+}
+
+/** Get next mem serial.
+ * Serials are handed out in increasing order. The first call continues after
+ * the highest serial of the interfaces already in the memory.
+ * @return next unique memory serial
+ */
+unsigned int
+BlackBoardInterfaceManager::next_mem_serial()
+{
+	if (mem_serial_ == 0) {
+		mem_serial_ = 1;
+		interface_header_t *                   ih;
+		BlackBoardMemoryManager::ChunkIterator cit;
+		for (cit = memmgr->begin(); cit != memmgr->end(); ++cit) {
+			ih = (interface_header_t *)*cit;
+			if (ih->serial >= mem_serial_) {
+				mem_serial_ = ih->serial + 1;
+			}
+		}
+	}
+
+	return mem_serial_++;
 }
 
 /** Create an interface instance.
@@ -208,6 +316,7 @@ BlackBoardInterfaceManager::create_interface(const char *type,
 	strncpy(ih->type, type, INTERFACE_TYPE_SIZE_ - 1);
 	strncpy(ih->id, identifier, INTERFACE_ID_SIZE_ - 1);
 	memcpy(ih->hash, interface->hash(), INTERFACE_HASH_SIZE_);
+	memmgr->index_add(ptr, uid_hash(ih->type, ih->id));
 
 	ih->refcount           = 0;
 	ih->serial             = next_mem_serial();
@@ -215,7 +324,7 @@ BlackBoardInterfaceManager::create_interface(const char *type,
 	ih->num_readers        = 0;
 	rwlocks[ih->serial]    = new RefCountRWLock();
 
-	interface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t));
+	interface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t), &ih->data_seq);
 }
 
 /** Open interface for reading.
@@ -262,7 +371,7 @@ BlackBoardInterfaceManager::open_for_reading(const char *type,
 			    || (memcmp(iface->hash(), ih->hash, INTERFACE_HASH_SIZE_) != 0)) {
 				throw BlackBoardInterfaceVersionMismatchException();
 			}
-			iface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t));
+			iface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t), &ih->data_seq);
 			rwlocks[ih->serial]->ref();
 		} else {
 			created = true;
@@ -317,32 +426,17 @@ BlackBoardInterfaceManager::open_multiple_for_reading(const char *type_pattern,
 
 	std::list<Interface *> rv;
 
-	Interface *                            iface = NULL;
-	interface_header_t *                   ih;
-	BlackBoardMemoryManager::ChunkIterator cit;
+	Interface *         iface = NULL;
+	interface_header_t *ih;
 
 	try {
-		for (cit = memmgr->begin(); cit != memmgr->end(); ++cit) {
-			iface = NULL;
-			ih    = (interface_header_t *)*cit;
-
-			// ensure 0-termination
-			char type[INTERFACE_TYPE_SIZE_ + 1];
-			char id[INTERFACE_ID_SIZE_ + 1];
-			type[INTERFACE_TYPE_SIZE_] = 0;
-			id[INTERFACE_TYPE_SIZE_]   = 0;
-			strncpy(type, ih->type, INTERFACE_TYPE_SIZE_);
-			strncpy(id, ih->id, INTERFACE_ID_SIZE_);
-
-			if ((fnmatch(type_pattern, type, 0) == FNM_NOMATCH)
-			    || (fnmatch(id_pattern, id, 0) == FNM_NOMATCH)) {
-				// type or ID prefix does not match, go on
-				continue;
-			}
-
-			void *ptr = *cit;
+		std::vector<void *> chunks = find_interfaces_in_memory(type_pattern, id_pattern, 0);
+		for (std::vector<void *>::iterator c = chunks.begin(); c != chunks.end(); ++c) {
+			iface     = NULL;
+			void *ptr = *c;
+			ih        = (interface_header_t *)ptr;
 			iface     = new_interface_instance(ih->type, ih->id, owner);
-			iface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t));
+			iface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t), &ih->data_seq);
 
 			if ((iface->hash_size() != INTERFACE_HASH_SIZE_)
 			    || (memcmp(iface->hash(), ih->hash, INTERFACE_HASH_SIZE_) != 0)) {
@@ -431,7 +525,7 @@ BlackBoardInterfaceManager::open_for_writing(const char *type,
 			    || (memcmp(iface->hash(), ih->hash, INTERFACE_HASH_SIZE_) != 0)) {
 				throw BlackBoardInterfaceVersionMismatchException();
 			}
-			iface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t));
+			iface->set_memory(ih->serial, ptr, (char *)ptr + sizeof(interface_header_t), &ih->data_seq);
 			rwlocks[ih->serial]->ref();
 		} else {
 			created = true;
@@ -563,12 +657,11 @@ BlackBoardInterfaceManager::list(const char *type_pattern, const char *id_patter
 	InterfaceInfoList *infl = new InterfaceInfoList();
 
 	memmgr->lock();
-	interface_header_t *                   ih;
-	BlackBoardMemoryManager::ChunkIterator cit;
-	for (cit = memmgr->begin(); cit != memmgr->end(); ++cit) {
-		ih = (interface_header_t *)*cit;
+	std::vector<void *> chunks = find_interfaces_in_memory(type_pattern, id_pattern, FNM_NOESCAPE);
+	for (std::vector<void *>::iterator c = chunks.begin(); c != chunks.end(); ++c) {
+		interface_header_t *            ih = (interface_header_t *)*c;
 		Interface::interface_data_ts_t *data_ts =
-		  (Interface::interface_data_ts_t *)((char *)*cit + sizeof(interface_header_t));
+		  (Interface::interface_data_ts_t *)((char *)*c + sizeof(interface_header_t));
 		char type[INTERFACE_TYPE_SIZE_ + 1];
 		char id[INTERFACE_ID_SIZE_ + 1];
 		// ensure NULL-termination
@@ -576,19 +669,16 @@ BlackBoardInterfaceManager::list(const char *type_pattern, const char *id_patter
 		id[INTERFACE_ID_SIZE_]     = 0;
 		strncpy(type, ih->type, INTERFACE_TYPE_SIZE_);
 		strncpy(id, ih->id, INTERFACE_ID_SIZE_);
-		if ((fnmatch(type_pattern, type, FNM_NOESCAPE) == 0)
-		    && (fnmatch(id_pattern, id, FNM_NOESCAPE) == 0)) {
-			std::string uid = std::string(type) + "::" + id;
-			infl->append(ih->type,
-			             ih->id,
-			             ih->hash,
-			             ih->serial,
-			             ih->flag_writer_active,
-			             ih->num_readers,
-			             readers(uid),
-			             writer(uid),
-			             fawkes::Time(data_ts->timestamp_sec, data_ts->timestamp_usec));
-		}
+		std::string uid = std::string(type) + "::" + id;
+		infl->append(ih->type,
+		             ih->id,
+		             ih->hash,
+		             ih->serial,
+		             ih->flag_writer_active,
+		             ih->num_readers,
+		             readers(uid),
+		             writer(uid),
+		             fawkes::Time(data_ts->timestamp_sec, data_ts->timestamp_usec));
 	}
 
 	memmgr->unlock();
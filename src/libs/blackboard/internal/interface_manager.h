@@ -28,7 +28,9 @@
 #include <utils/misc/string_compare.h>
 
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace fawkes {
 
@@ -82,13 +84,16 @@ private:
 	Interface *new_interface_instance(const char *type, const char *identifier, const char *owner);
 	void       delete_interface_instance(Interface *interface);
 
-	void *       find_interface_in_memory(const char *type, const char *identifier);
-	unsigned int next_mem_serial();
-	void         create_interface(const char *type,
-	                              const char *identifier,
-	                              const char *owner,
-	                              Interface *&interface,
-	                              void *&     ptr);
+	void *              find_interface_in_memory(const char *type, const char *identifier) const;
+	std::vector<void *> find_interfaces_in_memory(const char *type_pattern,
+	                                              const char *id_pattern,
+	                                              int         flags) const;
+	unsigned int        next_mem_serial();
+	void                create_interface(const char *type,
+	                                     const char *identifier,
+	                                     const char *owner,
+	                                     Interface *&interface,
+	                                     void *&     ptr);
 
 	Interface *writer_for_mem_serial(unsigned int mem_serial);
 
@@ -113,6 +118,15 @@ private:
 		std::list<Interface *> readers;
 	} OwnerInfo;
 	LockMap<std::string, OwnerInfo> owner_info_;
+
+	typedef struct
+	{
+		unsigned int        generation;
+		std::vector<void *> chunks;
+	} GlobCacheEntry;
+	// protected by the memory manager lock
+	mutable std::map<std::string, GlobCacheEntry> glob_cache_;
+	unsigned int                                  mem_serial_;
 };
 
 } // end namespace fawkes
@@ -43,6 +43,7 @@ typedef struct
 	uint16_t      num_readers;                /**< number of active readers */
 	uint32_t      refcount;                   /**< reference count */
 	uint32_t      serial;                     /**< memory serial */
+	uint32_t      data_seq;                   /**< data sequence counter, odd during write */
 } interface_header_t;
 
 } // end namespace fawkes
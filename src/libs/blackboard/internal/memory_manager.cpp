@@ -44,41 +44,90 @@
  */
 #define BBMM_MIN_FREE_CHUNK_SIZE sizeof(chunk_list_t)
 
+/** Alignment of chunks, requested sizes are rounded up to a multiple. */
+#define BBMM_ALIGNMENT 8
+
+/// @cond INTERNALS
+// chunk states, distinct magic values to detect invalid pointers on free
+#define BBMM_CHUNK_FREE 0xBBF4EE00
+#define BBMM_CHUNK_ALLOC 0xBBA770C0
+/// @endcond
+
 // shortcuts
 #define chunk_ptr(a) (shmem_ ? (chunk_list_t *)shmem_->ptr(a) : a)
 #define chunk_addr(a) (shmem_ ? (chunk_list_t *)shmem_->addr(a) : a)
 
 namespace fawkes {
 
+/** Get size class for a chunk size.
+ * Size classes are determined by the most significant bit of the size and
+ * the two bits following it, four classes per power of two.
+ * @param size chunk size
+ * @return size class index
+ */
+static inline unsigned int
+bbmm_bin_index(unsigned int size)
+{
+	if (size < 4)
+		return 0;
+	unsigned int msb = 31 - __builtin_clz(size);
+	return (msb << 2) | ((size >> (msb - 2)) & 3);
+}
+
+/** Get smallest chunk size for a size class.
+ * @param bin size class index
+ * @return smallest chunk size in the given class
+ */
+static inline unsigned int
+bbmm_bin_min_size(unsigned int bin)
+{
+	unsigned int msb = bin >> 2;
+	if (msb < 2)
+		return 0;
+	return (1u << msb) | ((bin & 3) << (msb - 2));
+}
+
 /** @class BlackBoardMemoryManager <blackboard/internal/memory_manager.h>
  * BlackBoard memory manager.
  * This class is used by the BlackBoard to manage the memory in the shared memory
- * segment. A simple strategy is used for memory management as the expected use case
- * is rather simple as well.
+ * segment. A segregated fit strategy is used to keep allocation and freeing
+ * of chunks at constant time even with many interfaces.
  *
  * The memory is allocated as one big chunk of contiguous memory. Inside this
  * chunk the memory manager handles the smaller chunks that are allocated in this
  * region. The chunk is allocated as shared memory segment to allow for multi-process
  * usage of the memory.
  *
- * The memory is organized in two separate lists. The one is the free chunks list
- * and the other one the allocated chunks list. After startup the allocated
- * chunks list is empty while the free chunks list contains one and only one
- * big chunk of free memory that contains the whole data segment.
+ * Allocated chunks are kept in the allocated chunks list. Free chunks are
+ * kept in one of several free lists, one for each size class. There are four
+ * size classes per power of two. After startup the allocated chunks list is
+ * empty while the free lists contain one and only one big chunk of free memory
+ * that contains the whole data segment. A bitmap records which free lists are
+ * non-empty.
  *
- * When memory is allocated the smallest chunk that is big enough for the requested
- * chunk is used. It is then removed from the free list. If the chunk is big enough
+ * When memory is allocated the free list of the size class of the requested
+ * size is searched for a fitting chunk. If there is none, the first chunk of
+ * the next larger non-empty size class is used, which is guaranteed to fit.
+ * It is then removed from its free list. If the chunk is big enough
  * to hold another chunk of memory (the remaining size can accomodate the header
  * and at least as many bytes as the header is in size) the chunk is split into an
  * exactly fitting allocated chunk and a remaining free chunk. The chunks are then
  * added to the appropriate lists. If there is more memory then requested but
  * not enough memory to make it a new free chunk the allocated chunk is enlarged
  * to fill the whole chunk. The additional bytes are recorded as overhanging bytes.
+ * Requested sizes are rounded up to a multiple of 8 bytes, the additional bytes
+ * are recorded as overhanging bytes as well.
  *
- * When memory is freed the chunk is removed from the allocated chunks list and
- * added to the free chunks list. Then the list is cleaned up and adjacent regions
- * of free memory are merged to one. Afterwards the free chunks list will contain
- * non-ajdacent free memory regions of maximum size between allocated chunks.
+ * When memory is freed the chunk is removed from the allocated chunks list.
+ * Each chunk knows its physically preceding chunk, the following chunk
+ * directly succeeds its data. If any of these neighbours is free, they are
+ * merged with the freed chunk. The resulting chunk is added to the free list
+ * of its size class. There are hence never two adjacent free chunks.
+ *
+ * Allocated chunks can be added to a hash index which is stored in the
+ * shared memory segment with the lists. This allows users, like the interface
+ * manager, to find chunks by a key without iterating over all chunks.
+ * Chunks are removed from the index automatically when they are freed.
  *
  * The memory manager is thread-safe as all appropriate operations are protected
  * by a mutex.
@@ -110,14 +159,18 @@ BlackBoardMemoryManager::BlackBoardMemoryManager(size_t memsize)
 	// Lock memory to RAM to avoid swapping
 	mlock(memory_, memsize_);
 
+	memset(&free_bins_, 0, sizeof(chunk_bins_t));
+	memset(&index_, 0, sizeof(chunk_index_t));
+	alloc_list_head_ = NULL;
+
 	chunk_list_t *f = (chunk_list_t *)memory_;
 	f->ptr          = (char *)f + sizeof(chunk_list_t);
 	f->size         = memsize_ - sizeof(chunk_list_t);
 	f->overhang     = 0;
-	f->next         = NULL;
-
-	free_list_head_  = f;
-	alloc_list_head_ = NULL;
+	f->phys_prev    = NULL;
+	f->index_hash   = 0;
+	f->index_next   = NULL;
+	bin_insert(f);
 }
 
 /** Shared Memory Constructor
@@ -186,10 +239,12 @@ BlackBoardMemoryManager::BlackBoardMemoryManager(size_t       memsize,
 		f->ptr          = shmem_->addr((char *)f + sizeof(chunk_list_t));
 		f->size         = memsize_ - sizeof(chunk_list_t);
 		f->overhang     = 0;
-		f->next         = NULL;
+		f->phys_prev    = NULL;
+		f->index_hash   = 0;
+		f->index_next   = NULL;
 
-		shmem_header_->set_free_list_head(f);
 		shmem_header_->set_alloc_list_head(NULL);
+		bin_insert(f);
 	}
 
 	mutex_ = new Mutex();
@@ -219,40 +274,40 @@ BlackBoardMemoryManager::~BlackBoardMemoryManager()
 void *
 BlackBoardMemoryManager::alloc_nolock(unsigned int num_bytes)
 {
-	// search for smallest chunk just big enough for desired size
-	chunk_list_t *l = shmem_ ? shmem_header_->free_list_head() : free_list_head_;
+	unsigned int req_bytes = num_bytes;
+	num_bytes              = (num_bytes + BBMM_ALIGNMENT - 1) & ~(BBMM_ALIGNMENT - 1);
 
-	// Note: free chunks list sorted ascending by ptr
-	chunk_list_t *f = NULL;
-	while (l) {
-		if ((l->size >= num_bytes) &&               // chunk is big enough
-		    ((f == NULL) || (l->size < f->size))) { // no chunk found or current chunk smaller
+	chunk_bins_t *bins = free_bins();
+	unsigned int  bin  = bbmm_bin_index(num_bytes);
+	chunk_list_t *f    = NULL;
+
+	// search the size class of the request, chunks may be smaller than requested
+	for (chunk_list_t *l = chunk_ptr(bins->head[bin]); l; l = chunk_ptr(l->next)) {
+		if (l->size >= num_bytes) {
 			f = l;
+			break;
 		}
-		l = chunk_ptr(l->next);
 	}
 
+	// take first chunk of the next larger non-empty class, it is big enough
 	if (f == NULL) {
-		// Doh, did not find chunk
-		throw OutOfMemoryException("BlackBoard ran out of memory");
+		for (unsigned int w = (bin + 1) / 32; w < BBMM_NUM_BINS / 32; ++w) {
+			unsigned int m = bins->map[w];
+			if (w == (bin + 1) / 32)
+				m &= ~((1u << ((bin + 1) % 32)) - 1);
+			if (m) {
+				f = chunk_ptr(bins->head[w * 32 + __builtin_ctz(m)]);
+				break;
+			}
+		}
 	}
 
-	// remove chunk from free_list
-	if (shmem_) {
-		shmem_header_->set_free_list_head(list_remove(shmem_header_->free_list_head(), f));
-	} else {
-		free_list_head_ = list_remove(free_list_head_, f);
+	if (f == NULL) {
+		// Doh, did not find chunk
+		throw OutOfMemoryException("BlackBoard ran out of memory");
 	}
 
-	/*
-  // only chunk's semaphore
-  if ( ptr_sems.find( f->ptr ) != ptr_sems.end() ) {
-    SemaphoreSet *s = ptr_sems[f->ptr];
-    delete s;
-    ptr_sems.erase( f->ptr );
-    f->semset_key = 0;
-  }
-  */
+	bin_remove(f);
 
 	// our old free list chunk is now our new alloc list chunk
 	// check if there is free space beyond the requested size that makes it worth
@@ -264,29 +319,27 @@ BlackBoardMemoryManager::alloc_nolock(unsigned int num_bytes)
 		                           : (char *)nfc + sizeof(chunk_list_t);
 		nfc->size         = f->size - num_bytes - sizeof(chunk_list_t);
 		nfc->overhang     = 0;
+		nfc->phys_prev    = chunk_addr(f);
+		nfc->index_hash   = 0;
+		nfc->index_next   = NULL;
 
-		if (shmem_) {
-			shmem_header_->set_free_list_head(list_add(shmem_header_->free_list_head(), nfc));
-		} else {
-			free_list_head_ = list_add(free_list_head_, nfc);
-		}
+		chunk_list_t *n = phys_next(nfc);
+		if (n)
+			n->phys_prev = chunk_addr(nfc);
 
-		f->size = num_bytes;
-	} else {
-		// chunk is too small for another free chunk, now we have allocated but unusued
-		// space, this is ok but not desireable
-		// this is only informational!
-		f->overhang = f->size - num_bytes;
-	}
+		bin_insert(nfc);
 
-	// alloc new chunk
-	if (shmem_) {
-		shmem_header_->set_alloc_list_head(list_add(shmem_header_->alloc_list_head(), f));
-		return shmem_->ptr(f->ptr);
-	} else {
-		alloc_list_head_ = list_add(alloc_list_head_, f);
-		return f->ptr;
+		f->size = num_bytes;
 	}
+	// chunk may be too small for another free chunk, now we have allocated
+	// but unusued space, this is ok but not desireable, this is only informational!
+	f->overhang   = f->size - req_bytes;
+	f->index_hash = 0;
+	f->index_next = NULL;
+
+	alloc_list_insert(f);
+	chunk_index()->generation += 1;
+	return shmem_ ? shmem_->ptr(f->ptr) : f->ptr;
 }
 
 /** Allocate memory.
@@ -332,44 +385,52 @@ void
 BlackBoardMemoryManager::free(void *ptr)
 {
 	mutex_->lock();
-	if (shmem_) {
+	if (shmem_)
 		shmem_->lock_for_write();
 
-		// find chunk in alloc_chunks
-		chunk_list_t *ac = list_find_ptr(shmem_header_->alloc_list_head(), chunk_addr(ptr));
-		if (ac == NULL) {
-			throw BlackBoardMemMgrInvalidPointerException();
-		}
-
-		// remove from alloc_chunks
-		shmem_header_->set_alloc_list_head(list_remove(shmem_header_->alloc_list_head(), ac));
-
-		// reclaim as free memory
-		ac->overhang = 0;
-		shmem_header_->set_free_list_head(list_add(shmem_header_->free_list_head(), ac));
-
-		// merge adjacent regions
-		cleanup_free_chunks();
+	// the chunk header directly precedes the data, verify that it really
+	// is the header of an allocated chunk
+	char *        mem_start = (char *)first_chunk();
+	chunk_list_t *ac        = (chunk_list_t *)((char *)ptr - sizeof(chunk_list_t));
+	if (((char *)ac < mem_start) || ((char *)ptr >= mem_start + memsize_)
+	    || (ac->state != BBMM_CHUNK_ALLOC)
+	    || (ac->ptr != (shmem_ ? shmem_->addr(ptr) : ptr))) {
+		if (shmem_)
+			shmem_->unlock();
+		mutex_->unlock();
+		throw BlackBoardMemMgrInvalidPointerException();
+	}
 
-		shmem_->unlock();
-	} else {
-		// find chunk in alloc_chunks
-		chunk_list_t *ac = list_find_ptr(alloc_list_head_, ptr);
-		if (ac == NULL) {
-			throw BlackBoardMemMgrInvalidPointerException();
-		}
+	index_unlink(ac);
+	alloc_list_remove(ac);
+	chunk_index()->generation += 1;
+	ac->overhang = 0;
+
+	// merge with following chunk if it is free
+	chunk_list_t *n = phys_next(ac);
+	if (n && (n->state == BBMM_CHUNK_FREE)) {
+		bin_remove(n);
+		ac->size += n->size + sizeof(chunk_list_t);
+		n->state = 0;
+	}
 
-		// remove from alloc_chunks
-		alloc_list_head_ = list_remove(alloc_list_head_, ac);
+	// merge into preceding chunk if it is free
+	chunk_list_t *p = chunk_ptr(ac->phys_prev);
+	if (p && (p->state == BBMM_CHUNK_FREE)) {
+		bin_remove(p);
+		p->size += ac->size + sizeof(chunk_list_t);
+		ac->state = 0;
+		ac        = p;
+	}
 
-		// reclaim as free memory
-		ac->overhang    = 0;
-		free_list_head_ = list_add(free_list_head_, ac);
+	n = phys_next(ac);
+	if (n)
+		n->phys_prev = chunk_addr(ac);
 
-		// merge adjacent regions
-		cleanup_free_chunks();
-	}
+	bin_insert(ac);
 
+	if (shmem_)
+		shmem_->unlock();
 	mutex_->unlock();
 }
 
@@ -383,55 +444,35 @@ BlackBoardMemoryManager::free(void *ptr)
 void
 BlackBoardMemoryManager::check()
 {
-	chunk_list_t *f = shmem_ ? shmem_header_->free_list_head() : free_list_head_;
-	chunk_list_t *a = shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_;
-	chunk_list_t *t = NULL;
-
-	unsigned int mem = 0;
-
-	// we crawl through the memory and analyse if the chunks are continuous,
-	// assumption: chunk list sorted ascending by ptr
-	while (f || a) {
-		if (f == NULL) {
-			mem += a->size + sizeof(chunk_list_t);
-			t = chunk_ptr(a->next);
-			if (t) {
-				// check if a is continuous
-				void *next = (char *)a->ptr + a->size + sizeof(chunk_list_t);
-				if (next != t->ptr) {
-					throw BBInconsistentMemoryException("non-contiguos allocated memory");
-				}
-			}
-			a = t;
-		} else if (a == NULL) {
-			mem += f->size + sizeof(chunk_list_t);
-			t = chunk_ptr(f->next);
-			if (t) {
-				// check if f is continuous
-				void *next = (char *)f->ptr + f->size + sizeof(chunk_list_t);
-				if (next != t->ptr) {
-					throw BBInconsistentMemoryException("non-contiguos allocated memory");
-				}
-			}
-			f = t;
-		} else if (f->ptr == a->ptr) {
-			throw BBInconsistentMemoryException("ptr cannot be free and allocated at the same time");
-		} else if (f->ptr < a->ptr) {
-			mem += f->size + sizeof(chunk_list_t);
-			void *next = (char *)f->ptr + f->size;
-			t          = chunk_ptr(f->next);
-			if ((next != t) && (next != a)) {
-				throw BBInconsistentMemoryException("there are unallocated bytes between chunks (f)");
+	unsigned int mem          = 0;
+	unsigned int num_free     = 0;
+	unsigned int num_alloc    = 0;
+	bool         prev_is_free = false;
+
+	// we crawl through the memory and analyse if the chunks are continuous
+	chunk_list_t *p = NULL;
+	for (chunk_list_t *c = first_chunk(); c != NULL; p = c, c = phys_next(c)) {
+		if (chunk_ptr(c->phys_prev) != p) {
+			throw BBInconsistentMemoryException("chunk has invalid predecessor");
+		}
+		if ((char *)chunk_ptr((chunk_list_t *)c->ptr) != (char *)c + sizeof(chunk_list_t)) {
+			throw BBInconsistentMemoryException("chunk data does not follow header");
+		}
+		if (c->state == BBMM_CHUNK_FREE) {
+			if (prev_is_free) {
+				throw BBInconsistentMemoryException("adjacent free chunks have not been merged");
 			}
-			f = t;
+			prev_is_free = true;
+			++num_free;
+		} else if (c->state == BBMM_CHUNK_ALLOC) {
+			prev_is_free = false;
+			++num_alloc;
 		} else {
-			mem += a->size + sizeof(chunk_list_t);
-			void *next = (char *)a->ptr + a->size;
-			t          = chunk_ptr(a->next);
-			if ((next != t) && (next != f)) {
-				throw BBInconsistentMemoryException("there are unallocated bytes between chunks (a)");
-			}
-			a = t;
+			throw BBInconsistentMemoryException("chunk neither free nor allocated");
+		}
+		mem += c->size + sizeof(chunk_list_t);
+		if (mem > memsize_) {
+			throw BBInconsistentMemoryException("chunk exceeds memory segment");
 		}
 	}
 
@@ -439,6 +480,35 @@ BlackBoardMemoryManager::check()
 		throw BBInconsistentMemoryException(
 		  "unmanaged memory found, managed memory size != total memory size");
 	}
+
+	// every free chunk must be in the list of its size class
+	chunk_bins_t *bins          = free_bins();
+	unsigned int  num_free_list = 0;
+	for (unsigned int b = 0; b < BBMM_NUM_BINS; ++b) {
+		bool bit_set = (bins->map[b / 32] & (1u << (b % 32))) != 0;
+		if (bit_set != (bins->head[b] != NULL)) {
+			throw BBInconsistentMemoryException("free list map does not match free lists");
+		}
+		for (chunk_list_t *l = chunk_ptr(bins->head[b]); l; l = chunk_ptr(l->next)) {
+			if ((l->state != BBMM_CHUNK_FREE) || (bbmm_bin_index(l->size) != b)) {
+				throw BBInconsistentMemoryException("chunk in wrong free list");
+			}
+			++num_free_list;
+		}
+	}
+	if ((num_free_list != num_free) || (num_allocated_chunks() != num_alloc)) {
+		throw BBInconsistentMemoryException("chunk lists do not cover all chunks");
+	}
+
+	// only allocated chunks may be indexed
+	chunk_index_t *index = chunk_index();
+	for (unsigned int b = 0; b < BBMM_INDEX_SIZE; ++b) {
+		for (chunk_list_t *l = chunk_ptr(index->head[b]); l; l = chunk_ptr(l->index_next)) {
+			if ((l->state != BBMM_CHUNK_ALLOC) || (l->index_hash % BBMM_INDEX_SIZE != b)) {
+				throw BBInconsistentMemoryException("invalid chunk in chunk index");
+			}
+		}
+	}
 }
 
 /** Check if this BB memory manager is the master.
@@ -457,7 +527,13 @@ BlackBoardMemoryManager::is_master() const
 void
 BlackBoardMemoryManager::print_free_chunks_info() const
 {
-	list_print_info(shmem_ ? shmem_header_->free_list_head() : free_list_head_);
+	chunk_bins_t *bins = free_bins();
+	for (unsigned int b = 0; b < BBMM_NUM_BINS; ++b) {
+		if (bins->head[b]) {
+			printf("Size class %3u (>= %10u bytes):\n", b, bbmm_bin_min_size(b));
+			list_print_info(chunk_ptr(bins->head[b]));
+		}
+	}
 }
 
 /** Print out info about allocated chunks.
@@ -466,23 +542,38 @@ BlackBoardMemoryManager::print_free_chunks_info() const
 void
 BlackBoardMemoryManager::print_allocated_chunks_info() const
 {
-	list_print_info(shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_);
+	list_print_info(alloc_list_head());
 }
 
 /** Prints out performance info.
  * This will print out information about the number of free and allocated chunks,
  * the maximum free and allocated chunk size and the number of overhanging bytes
- * (see class description about overhanging bytes).
+ * (see class description about overhanging bytes). Additionally the
+ * fragmentation of free memory and the number of free chunks per size class
+ * are printed.
  */
 void
 BlackBoardMemoryManager::print_performance_info() const
 {
 	printf("free chunks: %6u, alloc chunks: %6u, max free: %10u, max alloc: %10u, overhang: %10u\n",
-	       list_length(shmem_ ? shmem_header_->free_list_head() : free_list_head_),
-	       list_length(shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_),
+	       num_free_chunks(),
+	       num_allocated_chunks(),
 	       max_free_size(),
 	       max_allocated_size(),
 	       overhang_size());
+	printf("free: %10u bytes, fragmentation: %5.1f%%, free chunks per size class:",
+	       free_size(),
+	       fragmentation() * 100.);
+	chunk_bins_t *bins = free_bins();
+	for (unsigned int b = 0; b < BBMM_NUM_BINS; ++b) {
+		if (bins->head[b]) {
+			unsigned int n = 0;
+			for (chunk_list_t *l = chunk_ptr(bins->head[b]); l; l = chunk_ptr(l->next))
+				++n;
+			printf(" %u:%u", bbmm_bin_min_size(b), n);
+		}
+	}
+	printf("\n");
 }
 
 /** Get maximum allocatable memory size.
@@ -493,12 +584,20 @@ BlackBoardMemoryManager::print_performance_info() const
 unsigned int
 BlackBoardMemoryManager::max_free_size() const
 {
-	chunk_list_t *m = list_get_biggest(shmem_ ? shmem_header_->free_list_head() : free_list_head_);
-	if (m == NULL) {
-		return 0;
-	} else {
-		return m->size;
+	chunk_bins_t *bins = free_bins();
+	for (int w = BBMM_NUM_BINS / 32 - 1; w >= 0; --w) {
+		if (bins->map[w]) {
+			// the biggest chunk is in the largest non-empty size class
+			unsigned int b = w * 32 + 31 - __builtin_clz(bins->map[w]);
+			unsigned int m = 0;
+			for (chunk_list_t *l = chunk_ptr(bins->head[b]); l; l = chunk_ptr(l->next)) {
+				if (l->size > m)
+					m = l->size;
+			}
+			return m;
+		}
 	}
+	return 0;
 }
 
 /** Get total free memory.
@@ -512,10 +611,11 @@ unsigned int
 BlackBoardMemoryManager::free_size() const
 {
 	unsigned int  free_size = 0;
-	chunk_list_t *l         = shmem_ ? shmem_header_->free_list_head() : free_list_head_;
-	while (l) {
-		free_size += l->size;
-		l = chunk_ptr(l->next);
+	chunk_bins_t *bins      = free_bins();
+	for (unsigned int b = 0; b < BBMM_NUM_BINS; ++b) {
+		for (chunk_list_t *l = chunk_ptr(bins->head[b]); l; l = chunk_ptr(l->next)) {
+			free_size += l->size;
+		}
 	}
 	return free_size;
 }
@@ -528,7 +628,7 @@ unsigned int
 BlackBoardMemoryManager::allocated_size() const
 {
 	unsigned int  alloc_size = 0;
-	chunk_list_t *l          = shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_;
+	chunk_list_t *l          = alloc_list_head();
 	while (l) {
 		alloc_size += l->size;
 		l = chunk_ptr(l->next);
@@ -542,7 +642,10 @@ BlackBoardMemoryManager::allocated_size() const
 unsigned int
 BlackBoardMemoryManager::num_allocated_chunks() const
 {
-	return list_length(shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_);
+	unsigned int n = 0;
+	for (chunk_list_t *l = alloc_list_head(); l; l = chunk_ptr(l->next))
+		++n;
+	return n;
 }
 
 /** Get number of free chunks.
@@ -551,7 +654,28 @@ BlackBoardMemoryManager::num_allocated_chunks() const
 unsigned int
 BlackBoardMemoryManager::num_free_chunks() const
 {
-	return list_length(shmem_ ? shmem_header_->free_list_head() : free_list_head_);
+	unsigned int  n    = 0;
+	chunk_bins_t *bins = free_bins();
+	for (unsigned int b = 0; b < BBMM_NUM_BINS; ++b) {
+		for (chunk_list_t *l = chunk_ptr(bins->head[b]); l; l = chunk_ptr(l->next))
+			++n;
+	}
+	return n;
+}
+
+/** Get fragmentation of free memory.
+ * The fragmentation is the share of free memory that cannot be allocated in
+ * a single chunk, i.e. one minus the ratio of the biggest free chunk size and
+ * the total free memory.
+ * @return fragmentation in the range [0,1], 0 if all free memory is in one chunk
+ */
+float
+BlackBoardMemoryManager::fragmentation() const
+{
+	unsigned int free = free_size();
+	if (free == 0)
+		return 0.;
+	return 1. - (float)max_free_size() / (float)free;
 }
 
 /** Get size of memory.
@@ -573,6 +697,18 @@ BlackBoardMemoryManager::version() const
 	return shmem_ ? shmem_header_->version() : 0;
 }
 
+/** Get allocation generation.
+ * The generation is incremented whenever a chunk is allocated or freed. It
+ * can be used to determine whether information derived from the set of
+ * allocated chunks is still valid. Memory must be locked while calling this.
+ * @return allocation generation
+ */
+unsigned int
+BlackBoardMemoryManager::generation() const
+{
+	return chunk_index()->generation;
+}
+
 /** Lock memory.
  * Locks the whole memory segment used and managed by the memory manager. Will
  * aquire local mutex lock and global semaphore lock in shared memory segment.
@@ -628,12 +764,12 @@ BlackBoardMemoryManager::unlock()
 unsigned int
 BlackBoardMemoryManager::max_allocated_size() const
 {
-	chunk_list_t *m = list_get_biggest(shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_);
-	if (m == NULL) {
-		return 0;
-	} else {
-		return m->size;
+	unsigned int m = 0;
+	for (chunk_list_t *l = alloc_list_head(); l; l = chunk_ptr(l->next)) {
+		if (l->size > m)
+			m = l->size;
 	}
+	return m;
 }
 
 /** Get number of overhanging bytes.
@@ -645,7 +781,7 @@ unsigned int
 BlackBoardMemoryManager::overhang_size() const
 {
 	unsigned int  overhang = 0;
-	chunk_list_t *a        = shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_;
+	chunk_list_t *a        = alloc_list_head();
 	while (a) {
 		overhang += a->overhang;
 		a = chunk_ptr(a->next);
@@ -653,139 +789,213 @@ BlackBoardMemoryManager::overhang_size() const
 	return overhang;
 }
 
-/** Cleanup and merge free chunks.
- * This will merge adjacent free chunks into one big chunk. After this method ran it
- * is guaranteed that the maximum available memory resides in one chunk.
+/** Get free lists.
+ * @return free lists per size class, list heads are shared memory
+ * addresses if shared memory is used
+ */
+chunk_bins_t *
+BlackBoardMemoryManager::free_bins() const
+{
+	return shmem_ ? shmem_header_->free_bins() : (chunk_bins_t *)&free_bins_;
+}
+
+/** Get head of allocated chunks list.
+ * @return local pointer to first allocated chunk
+ */
+chunk_list_t *
+BlackBoardMemoryManager::alloc_list_head() const
+{
+	return shmem_ ? shmem_header_->alloc_list_head() : alloc_list_head_;
+}
+
+/** Set head of allocated chunks list.
+ * @param alh local pointer to new first allocated chunk
  */
 void
-BlackBoardMemoryManager::cleanup_free_chunks()
+BlackBoardMemoryManager::set_alloc_list_head(chunk_list_t *alh)
 {
-	bool          modified = true;
-	chunk_list_t *l;
-	chunk_list_t *n; // next
-
-	while (modified) {
-		modified = false;
-		l        = shmem_ ? shmem_header_->free_list_head() : free_list_head_;
-		n        = chunk_ptr(l->next);
-		while (l && n) {
-			if (((char *)l->ptr + l->size + sizeof(chunk_list_t)) == n->ptr) {
-				// re-unite
-				l->size += n->size + sizeof(chunk_list_t);
-				l->next  = n->next;
-				modified = true;
-			}
-			l = n;
-			n = chunk_ptr(l->next);
-		}
+	if (shmem_) {
+		shmem_header_->set_alloc_list_head(alh);
+	} else {
+		alloc_list_head_ = alh;
 	}
 }
 
-/** Remove an element from a list.
- * @param list list to remove the element from
- * @param rmel element to remove
- * @return the head of the new resulting list
- * @exception NullPointerException thrown if list or rmel equals NULL
+/** Get physically first chunk.
+ * @return local pointer to the chunk at the start of the memory segment
  */
 chunk_list_t *
-BlackBoardMemoryManager::list_remove(chunk_list_t *list, chunk_list_t *rmel)
+BlackBoardMemoryManager::first_chunk() const
 {
-	if (list == NULL)
-		throw NullPointerException("BlackBoardMemoryManager::list_remove: list == NULL");
-	if (rmel == NULL)
-		throw NullPointerException("BlackBoardMemoryManager::list_remove: rmel == NULL");
+	return (chunk_list_t *)(shmem_ ? shmem_->memptr() : memory_);
+}
 
-	chunk_list_t *new_head = list;
-	chunk_list_t *l        = list;
-	chunk_list_t *p        = NULL;
+/** Get physically following chunk.
+ * @param chunk chunk to get the successor of
+ * @return local pointer to the chunk directly following the data of the
+ * given chunk, NULL if chunk is the last chunk in the memory segment
+ */
+chunk_list_t *
+BlackBoardMemoryManager::phys_next(const chunk_list_t *chunk) const
+{
+	char *n = (char *)chunk + sizeof(chunk_list_t) + chunk->size;
+	if (n >= (char *)first_chunk() + memsize_)
+		return NULL;
+	return (chunk_list_t *)n;
+}
 
-	while (l) {
-		if (l == rmel) {
-			// found element, now remove
-			if (p) {
-				// we have a predecessor
-				p->next = l->next;
-			} else {
-				// new head
-				new_head = chunk_ptr(l->next);
-			}
-			break;
-		}
-		p = l;
-		l = chunk_ptr(l->next);
+/** Add chunk to free list of its size class.
+ * @param chunk local pointer to chunk to add
+ */
+void
+BlackBoardMemoryManager::bin_insert(chunk_list_t *chunk)
+{
+	chunk_bins_t *bins = free_bins();
+	unsigned int  b    = bbmm_bin_index(chunk->size);
+
+	chunk->state = BBMM_CHUNK_FREE;
+	chunk->prev  = NULL;
+	chunk->next  = bins->head[b];
+	if (bins->head[b])
+		chunk_ptr(bins->head[b])->prev = chunk_addr(chunk);
+	bins->head[b] = chunk_addr(chunk);
+	bins->map[b / 32] |= (1u << (b % 32));
+}
+
+/** Remove chunk from free list of its size class.
+ * @param chunk local pointer to chunk to remove
+ */
+void
+BlackBoardMemoryManager::bin_remove(chunk_list_t *chunk)
+{
+	chunk_bins_t *bins = free_bins();
+	unsigned int  b    = bbmm_bin_index(chunk->size);
+
+	if (chunk->prev) {
+		chunk_ptr(chunk->prev)->next = chunk->next;
+	} else {
+		bins->head[b] = chunk->next;
+		if (!bins->head[b])
+			bins->map[b / 32] &= ~(1u << (b % 32));
 	}
+	if (chunk->next)
+		chunk_ptr(chunk->next)->prev = chunk->prev;
+	chunk->next = chunk->prev = NULL;
+}
 
-	return new_head;
+/** Add chunk to allocated chunks list.
+ * @param chunk local pointer to chunk to add
+ */
+void
+BlackBoardMemoryManager::alloc_list_insert(chunk_list_t *chunk)
+{
+	chunk_list_t *head = alloc_list_head();
+
+	chunk->state = BBMM_CHUNK_ALLOC;
+	chunk->prev  = NULL;
+	chunk->next  = chunk_addr(head);
+	if (head)
+		head->prev = chunk_addr(chunk);
+	set_alloc_list_head(chunk);
 }
 
-/** Add an element to a list.
- * @param list list to add the element to
- * @param rmel element to add
- * @return the head of the new resulting list
- * @exception NullPointerException thrown if addel equals NULL
+/** Remove chunk from allocated chunks list.
+ * @param chunk local pointer to chunk to remove
  */
-chunk_list_t *
-BlackBoardMemoryManager::list_add(chunk_list_t *list, chunk_list_t *addel)
+void
+BlackBoardMemoryManager::alloc_list_remove(chunk_list_t *chunk)
 {
-	if (addel == NULL)
-		throw NullPointerException("BlackBoardMemoryManager::list_add: addel == NULL");
+	if (chunk->prev) {
+		chunk_ptr(chunk->prev)->next = chunk->next;
+	} else {
+		set_alloc_list_head(chunk_ptr(chunk->next));
+	}
+	if (chunk->next)
+		chunk_ptr(chunk->next)->prev = chunk->prev;
+	chunk->next = chunk->prev = NULL;
+}
 
-	chunk_list_t *new_head = list;
-	chunk_list_t *l        = list;
-	chunk_list_t *p        = NULL;
+/** Get chunk index.
+ * @return chunk hash index, bucket heads are shared memory addresses if
+ * shared memory is used
+ */
+chunk_index_t *
+BlackBoardMemoryManager::chunk_index() const
+{
+	return shmem_ ? shmem_header_->index() : (chunk_index_t *)&index_;
+}
 
-	while (l) {
-		if (addel->ptr < l->ptr) {
-			// add it here
-			addel->next = chunk_addr(l);
-			if (p != NULL) {
-				// predecessor needs new successor
-				// before: p->next == l
-				p->next = chunk_addr(addel);
-			} else {
-				new_head = addel;
-			}
-			// used as condition below
-			l = addel;
-			break;
-		} else {
-			p = l;
-			l = chunk_ptr(l->next);
-		}
-	}
+/** Add chunk to index.
+ * Adds an allocated chunk to the chunk hash index. The chunk is removed
+ * from the index automatically when it is freed. Note: this method does NOT
+ * lock the shared memory system, the memory must be locked while calling it.
+ * @param ptr pointer to the chunk as returned by alloc_nolock()
+ * @param hash hash of the key the chunk is indexed by
+ */
+void
+BlackBoardMemoryManager::index_add(void *ptr, unsigned int hash)
+{
+	chunk_index_t *index = chunk_index();
+	chunk_list_t * chunk = (chunk_list_t *)((char *)ptr - sizeof(chunk_list_t));
+	unsigned int   b     = hash % BBMM_INDEX_SIZE;
 
-	// if l is not addel it has not yet been added
-	if (l != addel) {
-		// p is last element of list and != NULL
-		addel->next = NULL;
-		if (p) {
-			p->next = chunk_addr(addel);
-		} else {
-			new_head = addel;
+	chunk->index_hash = hash;
+	chunk->index_next = index->head[b];
+	index->head[b]    = chunk_addr(chunk);
+}
+
+/** Remove chunk from index.
+ * Does nothing if the chunk has not been indexed.
+ * @param chunk local pointer to chunk to remove
+ */
+void
+BlackBoardMemoryManager::index_unlink(chunk_list_t *chunk)
+{
+	chunk_index_t *index = chunk_index();
+	chunk_list_t * caddr = chunk_addr(chunk);
+	chunk_list_t **l     = &index->head[chunk->index_hash % BBMM_INDEX_SIZE];
+
+	while (*l) {
+		if (*l == caddr) {
+			*l                = chunk->index_next;
+			chunk->index_next = NULL;
+			return;
 		}
+		l = &chunk_ptr(*l)->index_next;
 	}
+}
 
-	return new_head;
+/** Find first chunk with given hash in index.
+ * Different keys may have the same hash, the caller has to verify that
+ * the returned chunk is the desired one and continue with
+ * index_find_next() otherwise. Memory must be locked while calling this.
+ * @param hash hash of the key to look for
+ * @return pointer to first chunk with the given hash, NULL if none found
+ */
+void *
+BlackBoardMemoryManager::index_find(unsigned int hash) const
+{
+	chunk_list_t *l = chunk_ptr(chunk_index()->head[hash % BBMM_INDEX_SIZE]);
+	while (l && (l->index_hash != hash)) {
+		l = chunk_ptr(l->index_next);
+	}
+	return l ? (char *)l + sizeof(chunk_list_t) : NULL;
 }
 
-/** Find a chunk by ptr.
- * @param list list to search
- * @param ptr Pointer to search for
- * @return the chunk that points to ptr or NULL if not found
+/** Find next chunk with the same hash in index.
+ * @param ptr pointer to chunk as returned by index_find() or
+ * index_find_next()
+ * @return pointer to next chunk with the same hash, NULL if none found
  */
-chunk_list_t *
-BlackBoardMemoryManager::list_find_ptr(chunk_list_t *list, void *ptr)
+void *
+BlackBoardMemoryManager::index_find_next(void *ptr) const
 {
-	chunk_list_t *l = list;
-	while (l) {
-		if (l->ptr == ptr) {
-			// found it
-			return l;
-		} else {
-			l = chunk_ptr(l->next);
-		}
+	chunk_list_t *c = (chunk_list_t *)((char *)ptr - sizeof(chunk_list_t));
+	chunk_list_t *l = chunk_ptr(c->index_next);
+	while (l && (l->index_hash != c->index_hash)) {
+		l = chunk_ptr(l->index_next);
 	}
-	return NULL;
+	return l ? (char *)l + sizeof(chunk_list_t) : NULL;
 }
 
 /** Print info about chunks in list.
@@ -809,40 +1019,6 @@ BlackBoardMemoryManager::list_print_info(const chunk_list_t *list) const
 	}
 }
 
-/** Get length of list.
- * @param list list to count
- * @return length of list
- */
-unsigned int
-BlackBoardMemoryManager::list_length(const chunk_list_t *list) const
-{
-	unsigned int l = 0;
-	while (list) {
-		++l;
-		list = chunk_ptr(list->next);
-	}
-	return l;
-}
-
-/** Get biggest chunk from list.
- * @param list list to search
- * @return biggest chunk in list
- */
-chunk_list_t *
-BlackBoardMemoryManager::list_get_biggest(const chunk_list_t *list) const
-{
-	chunk_list_t *b = (chunk_list_t *)list;
-	chunk_list_t *l = (chunk_list_t *)list;
-	while (l) {
-		if (l->size > b->size) {
-			b = l;
-		}
-		l = chunk_ptr(l->next);
-	}
-
-	return b;
-}
-
 /** Get first element for chunk iteration.
  * @return Iterator pointing to first memory chunk
  */
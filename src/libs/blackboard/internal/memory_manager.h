@@ -40,20 +40,47 @@ class SemaphoreSet;
  * The data segment of a chunk follows directly after the header. So if c is a chunk_list_t
  * pointer to a chunk then the data segment of that chunk can be accessed via
  * (char *)c + sizeof(chunk_list_t).
+ * Allocated chunks are in the allocated chunks list, free chunks are in the
+ * free list of their size class. Both lists are doubly linked. Additionally
+ * each chunk knows its physically preceding chunk to merge adjacent free
+ * chunks in constant time. Allocated chunks may additionally be linked into
+ * a hash index to find them by a key in constant time.
  */
 struct chunk_list_t
 {
-	chunk_list_t *next;     /**< offset to next element in list */
-	void *        ptr;      /**< pointer to data memory */
-	unsigned int  size;     /**< total size of chunk, including overhanging bytes,
+	chunk_list_t *next;       /**< offset to next element in list */
+	void *        ptr;        /**< pointer to data memory */
+	unsigned int  size;       /**< total size of chunk, including overhanging bytes,
 				 * excluding header */
-	unsigned int  overhang; /**< number of overhanging bytes in this chunk */
+	unsigned int  overhang;   /**< number of overhanging bytes in this chunk */
+	chunk_list_t *prev;       /**< offset to previous element in list */
+	chunk_list_t *phys_prev;  /**< offset to physically preceding chunk, NULL for first */
+	unsigned int  state;      /**< chunk state, free or allocated */
+	unsigned int  index_hash; /**< hash of the chunk's key in the chunk index */
+	chunk_list_t *index_next; /**< offset to next chunk in the same index bucket */
 };
 
-// May be added later if we want/need per chunk semaphores
-//  int            semset_key;	/* key of semaphore for this chunk */
-//  unsigned int   reserved   :16;/* reserved bytes */
-//  unsigned int   semset_sem : 8;/* semaphore number in semaphore set */
+/** Number of size classes for free chunks.
+ * Sizes are classified by their most significant bit and the two bits
+ * following it, i.e. four classes per power of two. */
+#define BBMM_NUM_BINS 128
+
+/** Segregated free lists as stored in the BlackBoard shared memory segment. */
+struct chunk_bins_t
+{
+	chunk_list_t *head[BBMM_NUM_BINS];    /**< offsets of the free list heads per size class */
+	unsigned int  map[BBMM_NUM_BINS / 32]; /**< bit is set if the list of a class is non-empty */
+};
+
+/** Number of hash buckets of the chunk index. */
+#define BBMM_INDEX_SIZE 1024
+
+/** Chunk hash index as stored in the BlackBoard shared memory segment. */
+struct chunk_index_t
+{
+	chunk_list_t *head[BBMM_INDEX_SIZE]; /**< offsets of the first chunk per bucket */
+	unsigned int  generation;            /**< incremented on every allocation and free */
+};
 
 class BlackBoardMemoryManager
 {
@@ -84,8 +111,11 @@ public:
 	unsigned int num_free_chunks() const;
 	unsigned int num_allocated_chunks() const;
 
+	float fragmentation() const;
+
 	unsigned int memory_size() const;
 	unsigned int version() const;
+	unsigned int generation() const;
 
 	void print_free_chunks_info() const;
 	void print_allocated_chunks_info() const;
@@ -133,17 +163,25 @@ public:
 	ChunkIterator end();
 
 private:
-	chunk_list_t *list_add(chunk_list_t *list, chunk_list_t *addel);
-	chunk_list_t *list_remove(chunk_list_t *list, chunk_list_t *rmel);
-	chunk_list_t *list_find_ptr(chunk_list_t *list, void *ptr);
-	unsigned int  list_length(const chunk_list_t *list) const;
-	chunk_list_t *list_get_biggest(const chunk_list_t *list) const;
-	chunk_list_t *list_next(const chunk_list_t *list) const;
+	chunk_bins_t *free_bins() const;
+	chunk_list_t *alloc_list_head() const;
+	void          set_alloc_list_head(chunk_list_t *alh);
+	chunk_list_t *first_chunk() const;
+	chunk_list_t *phys_next(const chunk_list_t *chunk) const;
 
-	void cleanup_free_chunks();
+	void bin_insert(chunk_list_t *chunk);
+	void bin_remove(chunk_list_t *chunk);
+	void alloc_list_insert(chunk_list_t *chunk);
+	void alloc_list_remove(chunk_list_t *chunk);
 
 	void list_print_info(const chunk_list_t *list) const;
 
+	chunk_index_t *chunk_index() const;
+	void           index_add(void *ptr, unsigned int hash);
+	void           index_unlink(chunk_list_t *chunk);
+	void *         index_find(unsigned int hash) const;
+	void *         index_find_next(void *ptr) const;
+
 	void *alloc_nolock(unsigned int num_bytes);
 
 private:
@@ -160,8 +198,9 @@ private:
 
 	// Used for heap memory
 	void *        memory_;
-	chunk_list_t *free_list_head_;  /**< offset of the free chunks list head */
+	chunk_bins_t  free_bins_;       /**< free chunk lists per size class */
 	chunk_list_t *alloc_list_head_; /**< offset of the allocated chunks list head */
+	chunk_index_t index_;           /**< chunk hash index */
 };
 
 } // end namespace fawkes
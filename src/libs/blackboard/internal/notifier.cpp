@@ -21,9 +21,11 @@
  *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
  */
 
+#include <blackboard/bbconfig.h>
 #include <blackboard/blackboard.h>
 #include <blackboard/interface_listener.h>
 #include <blackboard/interface_observer.h>
+#include <blackboard/internal/event_dispatcher.h>
 #include <blackboard/internal/notifier.h>
 #include <core/threading/mutex.h>
 #include <core/threading/mutex_locker.h>
@@ -45,6 +47,11 @@ namespace fawkes {
  * This class is used by the BlackBoard to notify listeners and observers
  * of changes. 
  *
+ * Data events for listeners which requested asynchronous delivery are
+ * handed to a BlackBoardEventDispatcher, which is created when the first
+ * such listener is registered. These listeners are kept apart from the
+ * synchronous ones, which therefore never involve the dispatcher.
+ *
  * @author Tim Niemueller
  */
 
@@ -59,6 +66,7 @@ BlackBoardNotifier::BlackBoardNotifier()
 
 	bbil_data_events_ = 0;
 	bbil_data_mutex_  = new Mutex();
+	bbil_dispatcher_  = NULL;
 
 	bbil_messages_events_ = 0;
 	bbil_messages_mutex_  = new Mutex();
@@ -70,6 +78,8 @@ BlackBoardNotifier::BlackBoardNotifier()
 /** Destructor */
 BlackBoardNotifier::~BlackBoardNotifier()
 {
+	delete bbil_dispatcher_.load();
+
 	delete bbil_writer_mutex_;
 	delete bbil_reader_mutex_;
 	delete bbil_data_mutex_;
@@ -99,6 +109,15 @@ void
 BlackBoardNotifier::update_listener(BlackBoardInterfaceListener *    listener,
                                     BlackBoard::ListenerRegisterFlag flag)
 {
+	if (listener->bbil_async_data_events() && (flag & BlackBoard::BBIL_FLAG_DATA)) {
+		MutexLocker lock(bbil_data_mutex_);
+		if (!bbil_dispatcher_) {
+			bbil_dispatcher_ = new BlackBoardEventDispatcher(BLACKBOARD_EVENT_DISPATCH_THREADS);
+		}
+		bbil_dispatcher_.load()->add_listener(listener);
+	}
+	bool async_data = listener->bbil_async_data_events();
+
 	const BlackBoardInterfaceListener::InterfaceQueue &queue = listener->bbil_acquire_queue();
 
 	BlackBoardInterfaceListener::InterfaceQueue::const_iterator i = queue.begin();
@@ -112,8 +131,8 @@ BlackBoardNotifier::update_listener(BlackBoardInterfaceListener *    listener,
 				                          listener,
 				                          bbil_data_mutex_,
 				                          bbil_data_events_,
-				                          bbil_data_,
-				                          bbil_data_queue_,
+				                          async_data ? bbil_data_async_ : bbil_data_,
+				                          async_data ? bbil_data_async_queue_ : bbil_data_queue_,
 				                          "data");
 			}
 			break;
@@ -199,6 +218,8 @@ BlackBoardNotifier::unregister_listener(BlackBoardInterfaceListener *listener)
 {
 	const BlackBoardInterfaceListener::InterfaceMaps maps = listener->bbil_acquire_maps();
 
+	bool async_data = listener->bbil_async_data_events();
+
 	BlackBoardInterfaceListener::InterfaceMap::const_iterator i;
 	for (i = maps.data.begin(); i != maps.data.end(); ++i) {
 		proc_listener_maybe_queue(false,
@@ -206,8 +227,8 @@ BlackBoardNotifier::unregister_listener(BlackBoardInterfaceListener *listener)
 		                          listener,
 		                          bbil_data_mutex_,
 		                          bbil_data_events_,
-		                          bbil_data_,
-		                          bbil_data_queue_,
+		                          async_data ? bbil_data_async_ : bbil_data_,
+		                          async_data ? bbil_data_async_queue_ : bbil_data_queue_,
 		                          "data");
 	}
 
@@ -245,6 +266,14 @@ BlackBoardNotifier::unregister_listener(BlackBoardInterfaceListener *listener)
 	}
 
 	listener->bbil_release_maps();
+
+	BlackBoardEventDispatcher *dispatcher = bbil_dispatcher_;
+	if (dispatcher && async_data) {
+		dispatcher->remove_listener(listener);
+		MutexLocker lock(bbil_data_mutex_);
+		if (bbil_data_events_ == 0)
+			dispatcher->purge_removed();
+	}
 }
 
 /** Add listener for specified map.
@@ -283,10 +312,13 @@ BlackBoardNotifier::remove_listener(Interface *                  interface,
 
 bool
 BlackBoardNotifier::is_in_queue(bool                         op,
+                                Mutex *                      mutex,
                                 BBilQueue &                  queue,
                                 const char *                 uid,
                                 BlackBoardInterfaceListener *bbil)
 {
+	// the queue is appended to concurrently by (un)registering listeners
+	MutexLocker         lock(mutex);
 	BBilQueue::iterator q;
 	for (q = queue.begin(); q != queue.end(); ++q) {
 		if ((q->op == op) && (q->uid == uid) && (q->listener == bbil)) {
@@ -503,7 +535,7 @@ BlackBoardNotifier::notify_of_writer_added(const Interface *interface,
 	std::pair<BBilMap::iterator, BBilMap::iterator> ret = bbil_writer_.equal_range(uid);
 	for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
 		BlackBoardInterfaceListener *bbil = j->second;
-		if (!is_in_queue(/* remove op*/ false, bbil_writer_queue_, uid, bbil)) {
+		if (!is_in_queue(/* remove op*/ false, bbil_writer_mutex_, bbil_writer_queue_, uid, bbil)) {
 			Interface *bbil_iface = bbil->bbil_writer_interface(uid);
 			if (bbil_iface != NULL) {
 				bbil->bb_interface_writer_added(bbil_iface, event_instance_serial);
@@ -540,7 +572,7 @@ BlackBoardNotifier::notify_of_writer_removed(const Interface *interface,
 	std::pair<BBilMap::iterator, BBilMap::iterator> ret = bbil_writer_.equal_range(uid);
 	for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
 		BlackBoardInterfaceListener *bbil = j->second;
-		if (!is_in_queue(/* remove op*/ false, bbil_data_queue_, uid, bbil)) {
+		if (!is_in_queue(/* remove op*/ false, bbil_data_mutex_, bbil_data_queue_, uid, bbil)) {
 			Interface *bbil_iface = bbil->bbil_writer_interface(uid);
 			if (bbil_iface != NULL) {
 				bbil->bb_interface_writer_removed(bbil_iface, event_instance_serial);
@@ -597,7 +629,7 @@ BlackBoardNotifier::notify_of_reader_added(const Interface *interface,
 	std::pair<BBilMap::iterator, BBilMap::iterator> ret = bbil_reader_.equal_range(uid);
 	for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
 		BlackBoardInterfaceListener *bbil = j->second;
-		if (!is_in_queue(/* remove op*/ false, bbil_reader_queue_, uid, bbil)) {
+		if (!is_in_queue(/* remove op*/ false, bbil_reader_mutex_, bbil_reader_queue_, uid, bbil)) {
 			Interface *bbil_iface = bbil->bbil_reader_interface(uid);
 			if (bbil_iface != NULL) {
 				bbil->bb_interface_reader_added(bbil_iface, event_instance_serial);
@@ -634,7 +666,7 @@ BlackBoardNotifier::notify_of_reader_removed(const Interface *interface,
 	std::pair<BBilMap::iterator, BBilMap::iterator> ret = bbil_reader_.equal_range(uid);
 	for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
 		BlackBoardInterfaceListener *bbil = j->second;
-		if (!is_in_queue(/* remove op*/ false, bbil_data_queue_, uid, bbil)) {
+		if (!is_in_queue(/* remove op*/ false, bbil_data_mutex_, bbil_data_queue_, uid, bbil)) {
 			Interface *bbil_iface = bbil->bbil_reader_interface(uid);
 			if (bbil_iface != NULL) {
 				bbil->bb_interface_reader_removed(bbil_iface, event_instance_serial);
@@ -696,7 +728,7 @@ BlackBoardNotifier::notify_of_data_refresh(const Interface *interface, bool has_
 	std::pair<BBilMap::iterator, BBilMap::iterator> ret = bbil_data_.equal_range(uid);
 	for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
 		BlackBoardInterfaceListener *bbil = j->second;
-		if (!is_in_queue(/* remove op*/ false, bbil_data_queue_, uid, bbil)) {
+		if (!is_in_queue(/* remove op*/ false, bbil_data_mutex_, bbil_data_queue_, uid, bbil)) {
 			Interface *bbil_iface = bbil->bbil_data_interface(uid);
 			if (bbil_iface != NULL) {
 				bbil->bb_interface_data_refreshed(bbil_iface);
@@ -712,24 +744,43 @@ BlackBoardNotifier::notify_of_data_refresh(const Interface *interface, bool has_
 		}
 	}
 
-	bbil_data_mutex_->lock();
-	bbil_data_events_ -= 1;
-	if (!bbil_data_queue_.empty()) {
-		if (bbil_data_events_ == 0) {
-			while (!bbil_data_queue_.empty()) {
-				BBilQueueEntry &e = bbil_data_queue_.front();
-				if (e.op) { // register
-					add_listener(e.interface, e.listener, bbil_data_);
-				} else { // unregister
-					remove_listener(e.interface, e.listener, bbil_data_);
-				}
-				bbil_data_queue_.pop_front();
+	// Asynchronous listeners are only accessed by the dispatcher, it knows
+	// if the listener has been unregistered concurrently (and maybe deleted)
+	BlackBoardEventDispatcher *dispatcher = bbil_dispatcher_;
+	if (dispatcher) {
+		ret = bbil_data_async_.equal_range(uid);
+		for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
+			if (!is_in_queue(false, bbil_data_mutex_, bbil_data_async_queue_, uid, j->second)) {
+				dispatcher->enqueue_data_event(j->second, uid, has_changed);
 			}
 		}
 	}
+
+	bbil_data_mutex_->lock();
+	bbil_data_events_ -= 1;
+	if (bbil_data_events_ == 0) {
+		process_data_queue(bbil_data_, bbil_data_queue_);
+		process_data_queue(bbil_data_async_, bbil_data_async_queue_);
+		if (dispatcher)
+			dispatcher->purge_removed();
+	}
 	bbil_data_mutex_->unlock();
 }
 
+void
+BlackBoardNotifier::process_data_queue(BBilMap &map, BBilQueue &queue)
+{
+	while (!queue.empty()) {
+		BBilQueueEntry &e = queue.front();
+		if (e.op) { // register
+			add_listener(e.interface, e.listener, map);
+		} else { // unregister
+			remove_listener(e.interface, e.listener, map);
+		}
+		queue.pop_front();
+	}
+}
+
 /** Notify of message received
  * Notify all subscribers of the given interface of an incoming message
  * This also influences logging and sending data over the network so it is
@@ -753,7 +804,7 @@ BlackBoardNotifier::notify_of_message_received(const Interface *interface, Messa
 	std::pair<BBilMap::iterator, BBilMap::iterator> ret = bbil_messages_.equal_range(uid);
 	for (BBilMap::iterator j = ret.first; j != ret.second; ++j) {
 		BlackBoardInterfaceListener *bbil = j->second;
-		if (!is_in_queue(/* remove op*/ false, bbil_messages_queue_, uid, bbil)) {
+		if (!is_in_queue(/* remove op*/ false, bbil_messages_mutex_, bbil_messages_queue_, uid, bbil)) {
 			Interface *bbil_iface = bbil->bbil_message_interface(uid);
 			if (bbil_iface != NULL) {
 				bool abort = !bbil->bb_interface_message_received(bbil_iface, message);
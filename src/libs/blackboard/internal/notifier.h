@@ -30,6 +30,7 @@
 #include <core/utils/rwlock_map.h>
 #include <utils/uuid.h>
 
+#include <atomic>
 #include <list>
 #include <string>
 #include <utility>
@@ -39,6 +40,7 @@ namespace fawkes {
 class Interface;
 class Message;
 class Mutex;
+class BlackBoardEventDispatcher;
 
 class BlackBoardNotifier
 {
@@ -114,12 +116,17 @@ private:
 
 	void process_writer_queue();
 	void process_reader_queue();
-	void process_data_queue();
+	void process_data_queue(BBilMap &map, BBilQueue &queue);
 	void process_bbio_queue();
 
-	bool is_in_queue(bool op, BBilQueue &queue, const char *uid, BlackBoardInterfaceListener *bbil);
+	bool is_in_queue(bool                         op,
+	                 Mutex *                      mutex,
+	                 BBilQueue &                  queue,
+	                 const char *                 uid,
+	                 BlackBoardInterfaceListener *bbil);
 
 	BBilMap bbil_data_;
+	BBilMap bbil_data_async_;
 	BBilMap bbil_reader_;
 	BBilMap bbil_writer_;
 	BBilMap bbil_messages_;
@@ -138,11 +145,14 @@ private:
 	Mutex *      bbil_data_mutex_;
 	unsigned int bbil_data_events_;
 	BBilQueue    bbil_data_queue_;
+	BBilQueue    bbil_data_async_queue_;
 
 	Mutex *      bbil_messages_mutex_;
 	unsigned int bbil_messages_events_;
 	BBilQueue    bbil_messages_queue_;
 
+	std::atomic<BlackBoardEventDispatcher *> bbil_dispatcher_;
+
 	BBioMap bbio_created_;
 	BBioMap bbio_destroyed_;
 
@@ -0,0 +1,179 @@
+
+/***************************************************************************
+ *  delta.cpp - BlackBoard network data delta encoding
+ *
+ *  Created: Sun Oct 18 00:58:26 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <blackboard/net/delta.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace fawkes {
+
+/** Minimum number of unchanged bytes to end a run of changed bytes.
+ * Shorter gaps are cheaper to transmit as part of the changed run than
+ * to start a new run.
+ */
+#define MIN_GAP 3
+
+/// @cond INTERNALS
+static inline bool
+put_varint(uint8_t *&out, const uint8_t *end, size_t value)
+{
+	do {
+		if (out == end)
+			return false;
+		uint8_t b = value & 0x7F;
+		value >>= 7;
+		*out++ = b | (value ? 0x80 : 0);
+	} while (value);
+	return true;
+}
+
+static inline bool
+get_varint(const uint8_t *&in, const uint8_t *end, size_t &value)
+{
+	value              = 0;
+	unsigned int shift = 0;
+	while (in != end && shift < 8 * sizeof(size_t)) {
+		uint8_t b = *in++;
+		value |= (size_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return true;
+		shift += 7;
+	}
+	return false;
+}
+/// @endcond
+
+/** @class BlackBoardDeltaCodec <blackboard/net/delta.h>
+ * Delta encoding of interface data.
+ * Interface data often changes only in a few places between two updates,
+ * e.g. only the timestamp of a laser interface of some kilobytes. The
+ * delta is the XOR of the old and the new data, which is zero wherever the
+ * data did not change, run-length encoded. It consists of a sequence of
+ * runs, each encoded as the number of unchanged bytes to skip and the number
+ * of changed bytes, both as unsigned LEB128 varints, followed by the
+ * changed bytes XORed with the old data. Unchanged bytes at the end are not
+ * encoded. An empty delta means that the data did not change.
+ * @author Tim Niemueller
+ */
+
+/** Encode delta.
+ * @param old_data data the receiver currently has
+ * @param new_data data the receiver shall have after applying the delta
+ * @param data_size size in bytes of old_data and new_data
+ * @param delta buffer to write the delta to
+ * @param max_delta_size size of delta buffer in bytes
+ * @param delta_size upon return contains the size of the encoded delta
+ * @return true if the delta was encoded, false if it does not fit into
+ * max_delta_size bytes, send the full data in that case
+ */
+bool
+BlackBoardDeltaCodec::encode(const void *old_data,
+                             const void *new_data,
+                             size_t      data_size,
+                             void *      delta,
+                             size_t      max_delta_size,
+                             size_t &    delta_size)
+{
+	const uint8_t *o   = (const uint8_t *)old_data;
+	const uint8_t *n   = (const uint8_t *)new_data;
+	uint8_t *      out = (uint8_t *)delta;
+	const uint8_t *end = out + max_delta_size;
+
+	size_t i = 0;
+	while (i < data_size) {
+		// skip unchanged bytes, word-wise where possible
+		size_t skip_start = i;
+		while (i + sizeof(uint64_t) <= data_size) {
+			uint64_t ow, nw;
+			memcpy(&ow, o + i, sizeof(ow));
+			memcpy(&nw, n + i, sizeof(nw));
+			if (ow != nw)
+				break;
+			i += sizeof(uint64_t);
+		}
+		while (i < data_size && o[i] == n[i])
+			++i;
+		if (i == data_size)
+			break;
+
+		// changed run ends at the first gap of MIN_GAP unchanged bytes
+		size_t run_start = i;
+		size_t gap       = 0;
+		while (i < data_size && gap < MIN_GAP) {
+			gap = (o[i] == n[i]) ? gap + 1 : 0;
+			++i;
+		}
+		size_t run_end = i - gap;
+		i              = run_end;
+
+		size_t run_length = run_end - run_start;
+		if (!put_varint(out, end, run_start - skip_start) || !put_varint(out, end, run_length)
+		    || (size_t)(end - out) < run_length) {
+			return false;
+		}
+		for (size_t k = run_start; k < run_end; ++k) {
+			*out++ = o[k] ^ n[k];
+		}
+	}
+
+	delta_size = out - (uint8_t *)delta;
+	return true;
+}
+
+/** Apply delta.
+ * @param data data to apply the delta to in place, must be the same data the
+ * delta was encoded against
+ * @param data_size size in bytes of data
+ * @param delta delta to apply
+ * @param delta_size size in bytes of delta
+ * @return true if the delta has been applied, false if it is malformed
+ * or exceeds the data, data may have been modified partially in that case
+ */
+bool
+BlackBoardDeltaCodec::apply(void *data, size_t data_size, const void *delta, size_t delta_size)
+{
+	uint8_t *      d   = (uint8_t *)data;
+	const uint8_t *in  = (const uint8_t *)delta;
+	const uint8_t *end = in + delta_size;
+
+	size_t pos = 0;
+	while (in != end) {
+		size_t skip, run_length;
+		if (!get_varint(in, end, skip) || !get_varint(in, end, run_length))
+			return false;
+		if ((skip > data_size - pos) || (run_length > data_size - pos - skip)
+		    || (run_length > (size_t)(end - in))) {
+			return false;
+		}
+		pos += skip;
+		for (size_t k = 0; k < run_length; ++k) {
+			d[pos + k] ^= in[k];
+		}
+		pos += run_length;
+		in += run_length;
+	}
+	return true;
+}
+
+} // end namespace fawkes
@@ -29,6 +29,8 @@
 #include <blackboard/net/interface_listener.h>
 #include <blackboard/net/interface_observer.h>
 #include <blackboard/net/messages.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
 #include <interface/interface.h>
 #include <interface/interface_info.h>
 #include <logging/liblogger.h>
@@ -45,6 +47,11 @@ namespace fawkes {
  * This class provides a network handler that can be registered with the
  * FawkesServerThread to handle client requests to a BlackBoard instance.
  *
+ * Clients may subscribe to receive data updates of a reading instance as
+ * delta to the previous update and to limit the update rate. Updates held
+ * back due to the rate limit are sent by this thread once the interval
+ * has passed.
+ *
  * @author Tim Niemueller
  */
 
@@ -53,13 +60,16 @@ namespace fawkes {
  * @param hub Fawkes network hub
  */
 BlackBoardNetworkHandler::BlackBoardNetworkHandler(BlackBoard *blackboard, FawkesNetworkHub *hub)
-: Thread("BlackBoardNetworkHandler", Thread::OPMODE_WAITFORWAKEUP),
+: Thread("BlackBoardNetworkHandler", Thread::OPMODE_CONTINUOUS),
   FawkesNetworkHandler(FAWKES_CID_BLACKBOARD)
 {
 	bb_   = blackboard;
 	nhub_ = hub;
 	nhub_->add_handler(this);
 
+	inbound_waitcond_    = new WaitCondition(*inbound_queue_.mutex());
+	flush_interval_msec_ = 0;
+
 	observer_ = new BlackBoardNetHandlerInterfaceObserver(blackboard, hub);
 }
 
@@ -76,12 +86,51 @@ BlackBoardNetworkHandler::~BlackBoardNetworkHandler()
 	for (iit_ = interfaces_.begin(); iit_ != interfaces_.end(); ++iit_) {
 		bb_->close(iit_->second);
 	}
+	delete inbound_waitcond_;
+}
+
+/** Send updates held back due to rate limiting. */
+void
+BlackBoardNetworkHandler::flush_pending_updates()
+{
+	unsigned int flush_interval_msec = 0;
+
+	// client_disconnected() deletes listeners with this lock held
+	MutexLocker lock(client_interfaces_.mutex());
+	for (lit_ = listeners_.begin(); lit_ != listeners_.end(); ++lit_) {
+		unsigned int interval = lit_->second->min_interval_msec();
+		if (interval > 0) {
+			lit_->second->flush_pending();
+			if ((flush_interval_msec == 0) || (interval < flush_interval_msec)) {
+				flush_interval_msec = interval;
+			}
+		}
+	}
+	flush_interval_msec_ = flush_interval_msec;
 }
 
-/** Process all network messages that have been received. */
+/** Process all network messages that have been received.
+ * Waits for messages, but at most for the smallest update interval of
+ * all rate limited subscriptions to send updates which have been held back.
+ */
 void
 BlackBoardNetworkHandler::loop()
 {
+	inbound_queue_.lock();
+	if (inbound_queue_.empty()) {
+		if (flush_interval_msec_ > 0) {
+			inbound_waitcond_->reltimed_wait(flush_interval_msec_ / 1000,
+			                                 (flush_interval_msec_ % 1000) * 1000000);
+		} else {
+			inbound_waitcond_->wait();
+		}
+	}
+	inbound_queue_.unlock();
+
+	if (flush_interval_msec_ > 0) {
+		flush_pending_updates();
+	}
+
 	while (!inbound_queue_.empty()) {
 		FawkesNetworkMessage *msg = inbound_queue_.front();
 
@@ -202,6 +251,29 @@ BlackBoardNetworkHandler::loop()
 
 		} break;
 
+		case MSG_BB_SUBSCRIBE: {
+			bb_isubscribe_msg_t *sm        = msg->msg<bb_isubscribe_msg_t>();
+			Uuid                 sm_serial = sm->serial;
+			serial_to_clid_.lock();
+			bool owned = (serial_to_clid_.find(sm_serial) != serial_to_clid_.end())
+			             && (serial_to_clid_[sm_serial] == clid);
+			serial_to_clid_.unlock();
+			if (owned) {
+				bool         delta    = ntohl(sm->flags) & BB_SUBSCRIBE_DELTA;
+				unsigned int interval = ntohl(sm->min_interval_msec);
+				listeners_[sm_serial]->set_update_mode(delta, interval);
+				if ((interval > 0) && ((flush_interval_msec_ == 0) || (interval < flush_interval_msec_))) {
+					flush_interval_msec_ = interval;
+				}
+			} else {
+				LibLogger::log_warn("BlackBoardNetworkHandler",
+				                    "Client %u tried to subscribe to "
+				                    "interface with serial %s which it has not opened",
+				                    clid,
+				                    sm_serial.get_string().c_str());
+			}
+		} break;
+
 		case MSG_BB_CLOSE: {
 			bb_iserial_msg_t *sm        = msg->msg<bb_iserial_msg_t>();
 			Uuid              sm_serial = sm->serial;
@@ -363,13 +435,9 @@ BlackBoardNetworkHandler::send_opensuccess(unsigned int clid, Interface *interfa
 	}
 	osm->data_size = htonl(interface->datasize());
 
-	if (!interface->is_writer()) {
-		interface->read();
-	}
-
-	memcpy((char *)payload + sizeof(bb_iopensucc_msg_t),
-	       interface->datachunk(),
-	       interface->datasize());
+	// the listener reads the data, it is the base for delta updates
+	listeners_[interface->serial()]->read_initial_data((char *)payload
+	                                                   + sizeof(bb_iopensucc_msg_t));
 
 	FawkesNetworkMessage *omsg =
 	  new FawkesNetworkMessage(clid,
@@ -408,15 +476,17 @@ BlackBoardNetworkHandler::send_openfailure(unsigned int clid, unsigned int error
 }
 
 /** Handle network message.
- * The message is put into the inbound queue and processed in processAfterLoop().
+ * The message is put into the inbound queue and processed in loop().
  * @param msg message
  */
 void
 BlackBoardNetworkHandler::handle_network_message(FawkesNetworkMessage *msg)
 {
 	msg->ref();
-	inbound_queue_.push_locked(msg);
-	wakeup();
+	inbound_queue_.lock();
+	inbound_queue_.push(msg);
+	inbound_waitcond_->wake_all();
+	inbound_queue_.unlock();
 }
 
 /** Client connected. Ignored.
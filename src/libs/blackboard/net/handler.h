@@ -39,6 +39,7 @@ class BlackBoard;
 class FawkesNetworkHub;
 class BlackBoardNetHandlerInterfaceListener;
 class BlackBoardNetHandlerInterfaceObserver;
+class WaitCondition;
 
 class BlackBoardNetworkHandler : public Thread, public FawkesNetworkHandler
 {
@@ -63,9 +64,14 @@ protected:
 private:
 	void send_opensuccess(unsigned int clid, Interface *interface);
 	void send_openfailure(unsigned int clid, unsigned int error_code);
+	void flush_pending_updates();
 
 	BlackBoard *                      bb_;
 	LockQueue<FawkesNetworkMessage *> inbound_queue_;
+	WaitCondition *                   inbound_waitcond_;
+
+	// smallest minimum update interval of all rate limited subscriptions, 0 if none
+	unsigned int flush_interval_msec_;
 
 	// All interfaces, key is the instance serial, value the interface
 	LockMap<Uuid, Interface *>           interfaces_;
@@ -23,8 +23,11 @@
 
 #include <arpa/inet.h>
 #include <blackboard/blackboard.h>
+#include <blackboard/net/delta.h>
 #include <blackboard/net/interface_listener.h>
 #include <blackboard/net/messages.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
 #include <interface/interface.h>
 #include <logging/liblogger.h>
 #include <netcomm/fawkes/component_ids.h>
@@ -41,6 +44,13 @@ namespace fawkes {
  * Interface listener for network handler.
  * This class is used by the BlackBoardNetworkHandler to track interface changes and
  * send out notifications timely.
+ *
+ * The listener keeps a copy of the data last sent to the client. If the
+ * client subscribed for delta updates, changes are sent as delta to that
+ * copy, unless the delta would be larger than the data itself or sending
+ * the previous update failed. If the
+ * client requested a minimum update interval, updates within that interval
+ * are held back and sent coalesced with the next update or flush_pending().
  * @author Tim Niemueller
  */
 
@@ -68,6 +78,14 @@ BlackBoardNetHandlerInterfaceListener::BlackBoardNetHandlerInterfaceListener(Bla
 	fnh_        = hub;
 	clid_       = clid;
 
+	data_mutex_        = new Mutex();
+	sent_data_         = calloc(1, interface->datasize());
+	send_full_         = false;
+	delta_             = false;
+	min_interval_msec_ = 0;
+	pending_           = false;
+	pending_changed_   = false;
+
 	blackboard_->register_listener(this);
 }
 
@@ -75,50 +93,147 @@ BlackBoardNetHandlerInterfaceListener::BlackBoardNetHandlerInterfaceListener(Bla
 BlackBoardNetHandlerInterfaceListener::~BlackBoardNetHandlerInterfaceListener()
 {
 	blackboard_->unregister_listener(this);
+	free(sent_data_);
+	delete data_mutex_;
 }
 
+/** Read data for open success message.
+ * Reads the current data of a reading instance and copies it to the given
+ * buffer. The data is the base for following delta updates.
+ * @param buffer buffer to copy data to, must be of the size of the interface data
+ */
 void
-BlackBoardNetHandlerInterfaceListener::bb_interface_data_refreshed(Interface *interface) throw()
+BlackBoardNetHandlerInterfaceListener::read_initial_data(void *buffer)
 {
-	// send out data refreshed notification
-	interface->read();
+	MutexLocker lock(data_mutex_);
+	if (!interface_->is_writer()) {
+		interface_->read();
+	}
+	memcpy(sent_data_, interface_->datachunk(), interface_->datasize());
+	memcpy(buffer, sent_data_, interface_->datasize());
+	send_full_ = false;
+	last_sent_.stamp();
+}
 
-	size_t          payload_size = sizeof(bb_idata_msg_t) + interface->datasize();
-	void *          payload      = malloc(payload_size);
-	bb_idata_msg_t *dm           = (bb_idata_msg_t *)payload;
-	dm->serial                   = interface->serial();
-	dm->data_size                = htonl(interface->datasize());
-	memcpy((char *)payload + sizeof(bb_idata_msg_t), interface->datachunk(), interface->datasize());
+/** Set how updates are sent to the client.
+ * @param delta true to send updates as delta to the last update
+ * @param min_interval_msec minimum time between two updates, 0 to send any
+ * update immediately
+ */
+void
+BlackBoardNetHandlerInterfaceListener::set_update_mode(bool delta, unsigned int min_interval_msec)
+{
+	MutexLocker lock(data_mutex_);
+	delta_             = delta;
+	min_interval_msec_ = min_interval_msec;
+}
 
-	try {
-		fnh_->send(clid_, FAWKES_CID_BLACKBOARD, MSG_BB_DATA_REFRESHED, payload, payload_size);
-	} catch (Exception &e) {
-		LibLogger::log_warn(bbil_name(), "Failed to send BlackBoard data, exception follows");
-		LibLogger::log_warn(bbil_name(), e);
+/** Get minimum update interval.
+ * @return minimum time between two updates, 0 if updates are not rate limited
+ */
+unsigned int
+BlackBoardNetHandlerInterfaceListener::min_interval_msec() const
+{
+	return min_interval_msec_;
+}
+
+/** Send update which has been held back.
+ * Sends the current data if an update has been held back because of the
+ * minimum update interval, and the interval has passed.
+ */
+void
+BlackBoardNetHandlerInterfaceListener::flush_pending()
+{
+	MutexLocker lock(data_mutex_);
+	if (pending_) {
+		Time now;
+		if ((now - &last_sent_) * 1000. >= min_interval_msec_) {
+			send_data(pending_changed_);
+		}
 	}
 }
 
+/** Send current data to the client.
+ * Must be called with the data mutex locked.
+ * @param data_changed true if the data changed, false if only refreshed
+ */
 void
-BlackBoardNetHandlerInterfaceListener::bb_interface_data_changed(Interface *interface) throw()
+BlackBoardNetHandlerInterfaceListener::send_data(bool data_changed)
 {
-	// send out data changed notification
-	interface->read();
+	interface_->read();
+
+	const size_t data_size = interface_->datasize();
+	const void * data      = interface_->datachunk();
 
-	size_t          payload_size = sizeof(bb_idata_msg_t) + interface->datasize();
-	void *          payload      = malloc(payload_size);
-	bb_idata_msg_t *dm           = (bb_idata_msg_t *)payload;
-	dm->serial                   = interface->serial();
-	dm->data_size                = htonl(interface->datasize());
-	memcpy((char *)payload + sizeof(bb_idata_msg_t), interface->datachunk(), interface->datasize());
+	unsigned int msg_id       = data_changed ? MSG_BB_DATA_CHANGED : MSG_BB_DATA_REFRESHED;
+	size_t       payload_size = sizeof(bb_idata_msg_t) + data_size;
+	void *       payload      = malloc(sizeof(bb_idelta_msg_t) + data_size);
+
+	size_t delta_size = 0;
+	char * delta      = (char *)payload + sizeof(bb_idelta_msg_t);
+	if (delta_ && !send_full_
+	    && BlackBoardDeltaCodec::encode(sent_data_, data, data_size, delta, data_size, delta_size)
+	    && (sizeof(bb_idelta_msg_t) + delta_size < payload_size)) {
+		bb_idelta_msg_t *dm = (bb_idelta_msg_t *)payload;
+		dm->serial          = interface_->serial();
+		dm->data_size       = htonl(data_size);
+		dm->delta_size      = htonl(delta_size);
+		dm->flags           = htonl(data_changed ? BB_DELTA_DATA_CHANGED : 0);
+		msg_id              = MSG_BB_DATA_DELTA;
+		payload_size        = sizeof(bb_idelta_msg_t) + delta_size;
+	} else {
+		bb_idata_msg_t *dm = (bb_idata_msg_t *)payload;
+		dm->serial         = interface_->serial();
+		dm->data_size      = htonl(data_size);
+		memcpy((char *)payload + sizeof(bb_idata_msg_t), data, data_size);
+	}
+	last_sent_.stamp();
+	pending_         = false;
+	pending_changed_ = false;
 
 	try {
-		fnh_->send(clid_, FAWKES_CID_BLACKBOARD, MSG_BB_DATA_CHANGED, payload, payload_size);
+		fnh_->send(clid_, FAWKES_CID_BLACKBOARD, msg_id, payload, payload_size);
+		memcpy(sent_data_, data, data_size);
+		send_full_ = false;
 	} catch (Exception &e) {
+		// the client's copy is unknown now, do not send a delta to it next
+		send_full_ = true;
 		LibLogger::log_warn(bbil_name(), "Failed to send BlackBoard data, exception follows");
 		LibLogger::log_warn(bbil_name(), e);
 	}
 }
 
+void
+BlackBoardNetHandlerInterfaceListener::bb_interface_data_refreshed(Interface *interface) throw()
+{
+	// send out data refreshed notification
+	MutexLocker lock(data_mutex_);
+	if (min_interval_msec_ > 0) {
+		Time now;
+		if ((now - &last_sent_) * 1000. < min_interval_msec_) {
+			pending_ = true;
+			return;
+		}
+	}
+	send_data(pending_changed_);
+}
+
+void
+BlackBoardNetHandlerInterfaceListener::bb_interface_data_changed(Interface *interface) throw()
+{
+	// send out data changed notification
+	MutexLocker lock(data_mutex_);
+	if (min_interval_msec_ > 0) {
+		Time now;
+		if ((now - &last_sent_) * 1000. < min_interval_msec_) {
+			pending_         = true;
+			pending_changed_ = true;
+			return;
+		}
+	}
+	send_data(true);
+}
+
 bool
 BlackBoardNetHandlerInterfaceListener::bb_interface_message_received(Interface *interface,
                                                                      Message *  message) throw()
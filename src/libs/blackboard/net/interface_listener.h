@@ -25,11 +25,13 @@
 #define _BLACKBOARD_NET_INTERFACE_LISTENER_H_
 
 #include <blackboard/interface_listener.h>
+#include <utils/time/time.h>
 
 namespace fawkes {
 
 class FawkesNetworkHub;
 class BlackBoard;
+class Mutex;
 
 class BlackBoardNetHandlerInterfaceListener : public BlackBoardInterfaceListener
 {
@@ -48,14 +50,29 @@ public:
 	virtual void bb_interface_reader_added(Interface *interface, Uuid instance_serial) throw();
 	virtual void bb_interface_reader_removed(Interface *interface, Uuid instance_serial) throw();
 
+	void         read_initial_data(void *buffer);
+	void         set_update_mode(bool delta, unsigned int min_interval_msec);
+	unsigned int min_interval_msec() const;
+	void         flush_pending();
+
 private:
 	void send_event_serial(Interface *interface, unsigned int msg_id, Uuid event_serial);
+	void send_data(bool data_changed);
 
 	BlackBoard *      blackboard_;
 	Interface *       interface_;
 	FawkesNetworkHub *fnh_;
 
 	unsigned int clid_;
+
+	Mutex *      data_mutex_;
+	void *       sent_data_;
+	bool         send_full_;
+	bool         delta_;
+	unsigned int min_interval_msec_;
+	Time         last_sent_;
+	bool         pending_;
+	bool         pending_changed_;
 };
 
 } // end namespace fawkes
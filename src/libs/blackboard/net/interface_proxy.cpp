@@ -25,6 +25,7 @@
 #include <blackboard/internal/instance_factory.h>
 #include <blackboard/internal/interface_mem_header.h>
 #include <blackboard/internal/notifier.h>
+#include <blackboard/net/delta.h>
 #include <blackboard/net/interface_proxy.h>
 #include <blackboard/net/messages.h>
 #include <core/threading/refc_rwlock.h>
@@ -100,7 +101,7 @@ BlackBoardInterfaceProxy::BlackBoardInterfaceProxy(FawkesNetworkClient * client,
 	                     interface->serial().get_string().c_str(),
 	                     instance_serial_.get_string().c_str());
 	interface->set_instance_serial(instance_serial_);
-	interface->set_memory(0, mem_chunk_, data_chunk_);
+	interface->set_memory(0, mem_chunk_, data_chunk_, &ih->data_seq);
 	interface->set_mediators(this, this);
 	interface->set_readwrite(writer, rwlock_);
 }
@@ -145,11 +146,90 @@ BlackBoardInterfaceProxy::process_data_refreshed(FawkesNetworkMessage *msg)
 		return;
 	}
 
+	// bump sequence counter around the copy for optimistically reading instances
+	interface_header_t *ih = (interface_header_t *)mem_chunk_;
+	rwlock_->lock_for_write();
+	__atomic_store_n(&ih->data_seq, ih->data_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
 	memcpy(data_chunk_, (char *)payload + sizeof(bb_idata_msg_t), data_size_);
+	__atomic_store_n(&ih->data_seq, ih->data_seq + 1, __ATOMIC_RELEASE);
+	rwlock_->unlock();
 
 	notifier_->notify_of_data_refresh(interface_, msg->msgid() == MSG_BB_DATA_CHANGED);
 }
 
+/** Process MSG_BB_DATA_DELTA message.
+ * @param msg message to process.
+ */
+void
+BlackBoardInterfaceProxy::process_data_delta(FawkesNetworkMessage *msg)
+{
+	if (msg->payload_size() < sizeof(bb_idelta_msg_t)) {
+		LibLogger::log_error("BlackBoardInterfaceProxy", "Delta message too short, ignoring.");
+		return;
+	}
+
+	void *           payload = msg->payload();
+	bb_idelta_msg_t *dm      = (bb_idelta_msg_t *)payload;
+	if (dm->serial != instance_serial_) {
+		LibLogger::log_error("BlackBoardInterfaceProxy",
+		                     "Serial mismatch (delta), expected %s, "
+		                     "but got %s, ignoring.",
+		                     instance_serial_.get_string().c_str(),
+		                     dm->serial.get_string().c_str());
+		return;
+	}
+
+	size_t delta_size = ntohl(dm->delta_size);
+	if ((ntohl(dm->data_size) != data_size_)
+	    || (sizeof(bb_idelta_msg_t) + delta_size > msg->payload_size())) {
+		LibLogger::log_error("BlackBoardInterfaceProxy",
+		                     "Delta size mismatch for %s, ignoring.",
+		                     interface_->uid());
+		return;
+	}
+
+	interface_header_t *ih = (interface_header_t *)mem_chunk_;
+	rwlock_->lock_for_write();
+	__atomic_store_n(&ih->data_seq, ih->data_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	bool applied = BlackBoardDeltaCodec::apply(data_chunk_,
+	                                           data_size_,
+	                                           (char *)payload + sizeof(bb_idelta_msg_t),
+	                                           delta_size);
+	__atomic_store_n(&ih->data_seq, ih->data_seq + 1, __ATOMIC_RELEASE);
+	rwlock_->unlock();
+
+	if (!applied) {
+		LibLogger::log_error("BlackBoardInterfaceProxy",
+		                     "Malformed delta for %s, data may be inconsistent",
+		                     interface_->uid());
+		return;
+	}
+
+	notifier_->notify_of_data_refresh(interface_, ntohl(dm->flags) & BB_DELTA_DATA_CHANGED);
+}
+
+/** Configure data updates for this instance.
+ * Sends a subscription to the remote BlackBoard. A remote BlackBoard which
+ * does not support subscriptions ignores it and keeps sending full updates.
+ * @param delta true to receive updates as delta to the previous update
+ * @param min_interval_msec minimum time between two updates, 0 to receive
+ * every update
+ */
+void
+BlackBoardInterfaceProxy::subscribe(bool delta, unsigned int min_interval_msec)
+{
+	bb_isubscribe_msg_t *sm = (bb_isubscribe_msg_t *)malloc(sizeof(bb_isubscribe_msg_t));
+	sm->serial              = instance_serial_;
+	sm->flags               = htonl(delta ? BB_SUBSCRIBE_DELTA : 0);
+	sm->min_interval_msec   = htonl(min_interval_msec);
+
+	FawkesNetworkMessage *omsg = new FawkesNetworkMessage(
+	  clid_, FAWKES_CID_BLACKBOARD, MSG_BB_SUBSCRIBE, sm, sizeof(bb_isubscribe_msg_t));
+	fnc_->enqueue(omsg);
+}
+
 /** Process MSG_BB_INTERFACE message.
  * @param msg message to process.
  */
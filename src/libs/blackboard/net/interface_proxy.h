@@ -49,6 +49,8 @@ public:
 	~BlackBoardInterfaceProxy();
 
 	void process_data_refreshed(FawkesNetworkMessage *msg);
+	void process_data_delta(FawkesNetworkMessage *msg);
+	void subscribe(bool delta, unsigned int min_interval_msec);
 	void process_interface_message(FawkesNetworkMessage *msg);
 	void reader_added(Uuid event_serial);
 	void reader_removed(Uuid event_serial);
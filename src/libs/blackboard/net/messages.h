@@ -52,9 +52,21 @@ typedef enum {
 	MSG_BB_WRITER_REMOVED,
 	MSG_BB_INTERFACE_CREATED,
 	MSG_BB_INTERFACE_DESTROYED,
-	MSG_BB_LIST
+	MSG_BB_LIST,
+	MSG_BB_SUBSCRIBE,
+	MSG_BB_DATA_DELTA
 } blackboard_msgid_t;
 
+/** Flags for MSG_BB_SUBSCRIBE. */
+typedef enum {
+	BB_SUBSCRIBE_DELTA = 1 /**< Send data updates as delta to the previous update. */
+} blackboard_subscribe_flags_t;
+
+/** Flags for MSG_BB_DATA_DELTA. */
+typedef enum {
+	BB_DELTA_DATA_CHANGED = 1 /**< Data has changed, otherwise only refreshed. */
+} blackboard_delta_flags_t;
+
 /** Error codes */
 typedef enum {
 	BB_ERR_UNKNOWN_ERR,   /**< Unknown error occured. Check log. */
@@ -167,6 +179,38 @@ typedef struct
 	uint32_t data_size; /**< size in bytes of the following data. */
 } bb_idata_msg_t;
 
+/** Interface update subscription message.
+ * Sent by a client for an interface instance it opened for reading to
+ * configure how data updates are transmitted. Servers which do not know
+ * this message ignore it and keep sending full updates.
+ * This message is sent for MSG_BB_SUBSCRIBE.
+ */
+typedef struct
+{
+	Uuid     serial;            /**< instance serial to unique identify this instance */
+	uint32_t flags;             /**< flags, bitwise OR of blackboard_subscribe_flags_t
+	                             * values (big endian) */
+	uint32_t min_interval_msec; /**< minimum time between two updates, updates within
+	                             * this time are coalesced, 0 to send any
+	                             * update (big endian) */
+} bb_isubscribe_msg_t;
+
+/** Interface data delta message.
+ * This message struct is always followed by a delta of the size delta_size
+ * that must be applied to the data last received for this instance, be it
+ * with MSG_BB_OPEN_SUCCESS, MSG_BB_DATA_CHANGED, MSG_BB_DATA_REFRESHED, or
+ * MSG_BB_DATA_DELTA. @see BlackBoardDeltaCodec
+ * This message is sent for MSG_BB_DATA_DELTA.
+ */
+typedef struct
+{
+	Uuid     serial;     /**< instance serial to unique identify this instance */
+	uint32_t data_size;  /**< size in bytes of the interface data. */
+	uint32_t delta_size; /**< size in bytes of the following delta. */
+	uint32_t flags;      /**< flags, bitwise OR of blackboard_delta_flags_t values
+	                      * (big endian) */
+} bb_idelta_msg_t;
+
 /** Interface message.
  * This type is used to transport interface messages. This struct is always followed
  * by a data chunk of the size data_size that transports the message data.
@@ -0,0 +1,107 @@
+
+/***************************************************************************
+ *  qa_bb_delta.cpp - BlackBoard network data delta encoding QA
+ *
+ *  Created: Sun Oct 18 01:34:50 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <blackboard/net/delta.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace fawkes;
+
+// size of a Laser1080Interface data chunk
+#define DATA_SIZE (16 + 1080 * sizeof(float) + 32 + 4)
+#define NUM_RUNS 10000
+
+static bool
+run_test(const char *name, unsigned int num_changed, bool scattered)
+{
+	std::vector<unsigned char> old_data(DATA_SIZE), new_data(DATA_SIZE), delta(DATA_SIZE);
+	for (size_t i = 0; i < DATA_SIZE; ++i) {
+		old_data[i] = random() & 0xFF;
+	}
+	new_data = old_data;
+	for (unsigned int i = 0; i < num_changed; ++i) {
+		size_t idx = scattered ? (random() % DATA_SIZE) : i;
+		new_data[idx] ^= 1 + (random() % 0xFF);
+	}
+
+	size_t delta_size = 0;
+	Time   start;
+	bool   encoded = true;
+	for (unsigned int r = 0; r < NUM_RUNS && encoded; ++r) {
+		encoded = BlackBoardDeltaCodec::encode(
+		  &old_data[0], &new_data[0], DATA_SIZE, &delta[0], DATA_SIZE, delta_size);
+	}
+	Time end;
+
+	if (!encoded) {
+		printf("%-24s delta larger than data, full update\n", name);
+		return true;
+	}
+
+	std::vector<unsigned char> applied = old_data;
+	if (!BlackBoardDeltaCodec::apply(&applied[0], DATA_SIZE, &delta[0], delta_size)
+	    || (applied != new_data)) {
+		printf("%-24s FAILED, data differs after applying delta\n", name);
+		return false;
+	}
+
+	printf("%-24s %5zu of %zu bytes (%5.1f%%), encode %.2f usec\n",
+	       name,
+	       delta_size,
+	       (size_t)DATA_SIZE,
+	       100. * delta_size / DATA_SIZE,
+	       (end - &start) * 1000000. / NUM_RUNS);
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	bool ok = true;
+	ok &= run_test("unchanged", 0, false);
+	ok &= run_test("timestamp only", 16, false);
+	ok &= run_test("1% scattered", DATA_SIZE / 100, true);
+	ok &= run_test("10% scattered", DATA_SIZE / 10, true);
+	ok &= run_test("50% block", DATA_SIZE / 2, false);
+	ok &= run_test("all changed", DATA_SIZE, false);
+
+	// malformed deltas must be rejected
+	std::vector<unsigned char> data(16);
+	unsigned char              overrun[]   = {0x0A, 0x10, 0x00};
+	unsigned char              truncated[] = {0x80};
+	if (BlackBoardDeltaCodec::apply(&data[0], data.size(), overrun, sizeof(overrun))
+	    || BlackBoardDeltaCodec::apply(&data[0], data.size(), truncated, sizeof(truncated))) {
+		printf("FAILED, malformed delta accepted\n");
+		ok = false;
+	}
+
+	return ok ? 0 : 1;
+}
+
+/// @endcond
@@ -27,6 +27,7 @@
 #include <blackboard/exceptions.h>
 #include <blackboard/internal/memory_manager.h>
 #include <core/exceptions/system.h>
+#include <utils/time/time.h>
 
 #include <cstdio>
 #include <cstdlib>
@@ -47,6 +48,71 @@ signal_handler(int signum)
 
 #define NUM_CHUNKS 5
 #define BLACKBOARD_MEMORY_SIZE 2 * 1024 * 1024
+#define NUM_STRESS_OPS 1000000
+#define MAX_STRESS_CHUNKS 1000
+
+/* Stress benchmark, randomly allocates and frees interface-sized chunks
+ * (32 bytes to 4 KB) with up to MAX_STRESS_CHUNKS allocated at a time.
+ */
+static bool
+stress_benchmark(BlackBoardMemoryManager *mm)
+{
+	std::vector<void *> ptrs;
+	unsigned int        num_alloc = 0, num_free = 0, num_oom = 0;
+
+	srand(42);
+	fawkes::Time start;
+	for (unsigned int i = 0; i < NUM_STRESS_OPS; ++i) {
+		if ((ptrs.size() < MAX_STRESS_CHUNKS) && (ptrs.empty() || (rand() < RAND_MAX / 2))) {
+			unsigned int s = 32 << (rand() % 8);
+			s += rand() % s;
+			try {
+				ptrs.push_back(mm->alloc(s));
+				++num_alloc;
+			} catch (OutOfMemoryException &e) {
+				++num_oom;
+			}
+		} else {
+			unsigned int erase = rand() % ptrs.size();
+			mm->free(ptrs[erase]);
+			ptrs[erase] = ptrs.back();
+			ptrs.pop_back();
+			++num_free;
+		}
+	}
+	fawkes::Time end;
+	double       sec = end - &start;
+
+	printf("%u ops (%u alloc, %u free, %u out of memory) in %.3f sec, %.0f ops/sec\n",
+	       NUM_STRESS_OPS,
+	       num_alloc,
+	       num_free,
+	       num_oom,
+	       sec,
+	       NUM_STRESS_OPS / sec);
+	printf("%zu chunks allocated, fragmentation %.1f%%\n",
+	       ptrs.size(),
+	       mm->fragmentation() * 100.);
+	mm->print_performance_info();
+
+	bool ok = true;
+	try {
+		mm->check();
+	} catch (BBInconsistentMemoryException &e) {
+		cout << "Inconsistent memory found, printing exception trace" << endl;
+		e.print_trace();
+		ok = false;
+	}
+
+	for (unsigned int i = 0; i < ptrs.size(); ++i) {
+		mm->free(ptrs[i]);
+	}
+	if (mm->num_free_chunks() != 1) {
+		cout << "Free chunks have not been merged after freeing all chunks" << endl;
+		ok = false;
+	}
+	return ok;
+}
 
 int
 main(int argc, char **argv)
@@ -112,6 +178,17 @@ main(int argc, char **argv)
 	cout << "Basic tests finished" << endl;
 	cout << "=========================================================================" << endl;
 
+	cout << endl << "Running stress benchmark" << endl;
+	cout << "=========================================================================" << endl;
+
+	if (!stress_benchmark(mm)) {
+		delete mm;
+		exit(4);
+	}
+
+	cout << "Stress benchmark finished" << endl;
+	cout << "=========================================================================" << endl;
+
 	cout << endl << "Running gremlin tests, press Ctrl-C to stop" << endl;
 	cout << "=========================================================================" << endl;
 
@@ -0,0 +1,170 @@
+/***************************************************************************
+ *  qa_bb_msgq.cpp - BlackBoard message queue throughput benchmark QA
+ *
+ *  Created: Sat Oct 17 18:12:37 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <core/threading/thread.h>
+#include <interface/message.h>
+#include <interface/message_queue.h>
+#include <utils/qa/qa_check.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sched.h>
+#include <vector>
+
+using namespace std;
+using namespace fawkes;
+
+/* Measures the throughput of MessageQueue with N threads appending
+ * messages and one thread processing them like an interface writer does,
+ * i.e. polling empty() and using first() and pop(), yielding the CPU after
+ * each batch. Messages are created and deleted for each send to include the
+ * message allocation. The consumer verifies that the messages of each
+ * producer arrive in order.
+ */
+
+class BenchMessage : public Message
+{
+public:
+	BenchMessage(unsigned int producer, unsigned int seq) : Message("BenchMessage")
+	{
+		data_size = sizeof(bench_data_t);
+		data_ptr  = malloc(data_size);
+		memset(data_ptr, 0, data_size);
+		data      = (bench_data_t *)data_ptr;
+		data_ts   = (message_data_ts_t *)data_ptr;
+
+		data->producer = producer;
+		data->seq      = seq;
+	}
+
+	virtual ~BenchMessage()
+	{
+		free(data_ptr);
+	}
+
+	typedef struct
+	{
+		int64_t  timestamp_sec;
+		int64_t  timestamp_usec;
+		uint32_t producer;
+		uint32_t seq;
+	} bench_data_t;
+
+	bench_data_t *data;
+};
+
+class BenchProducerThread : public Thread
+{
+public:
+	BenchProducerThread(MessageQueue *msgq, unsigned int num, unsigned int num_messages)
+	: Thread("BenchProducerThread", Thread::OPMODE_CONTINUOUS),
+	  msgq_(msgq),
+	  num_(num),
+	  num_messages_(num_messages)
+	{
+	}
+
+	virtual void
+	loop()
+	{
+		for (unsigned int seq = 0; seq < num_messages_; ++seq) {
+			msgq_->append(new BenchMessage(num_, seq));
+		}
+		exit();
+	}
+
+private:
+	MessageQueue *msgq_;
+	unsigned int  num_;
+	unsigned int  num_messages_;
+};
+
+static bool
+run(unsigned int num_producers, unsigned int num_messages)
+{
+	MessageQueue                  msgq;
+	vector<BenchProducerThread *> producers;
+	vector<unsigned int>          next_seq(num_producers, 0);
+	unsigned long int             total       = (unsigned long int)num_producers * num_messages;
+	unsigned long int             num_recv    = 0;
+	unsigned long int             num_reorder = 0;
+	unsigned long int             num_polls   = 0;
+
+	for (unsigned int i = 0; i < num_producers; ++i) {
+		producers.push_back(new BenchProducerThread(&msgq, i, num_messages));
+	}
+
+	Time start;
+	for (auto p : producers)
+		p->start();
+
+	while (num_recv < total) {
+		++num_polls;
+		while (!msgq.empty()) {
+			BenchMessage *m = dynamic_cast<BenchMessage *>(msgq.first());
+			if (m->data->seq != next_seq[m->data->producer])
+				++num_reorder;
+			next_seq[m->data->producer] = m->data->seq + 1;
+			msgq.pop();
+			++num_recv;
+		}
+		sched_yield();
+	}
+	Time   end;
+	double sec = end - &start;
+
+	for (auto p : producers) {
+		p->join();
+		delete p;
+	}
+
+	printf("producers: %3u  messages: %9lu  time: %7.3f sec  throughput: %10.0f msg/sec  "
+	       "polls: %9lu  out of order: %lu\n",
+	       num_producers,
+	       num_recv,
+	       sec,
+	       num_recv / sec,
+	       num_polls,
+	       num_reorder);
+
+	return (num_reorder == 0) && msgq.empty();
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int max_producers = (argc > 1) ? atoi(argv[1]) : 8;
+	unsigned int num_messages  = (argc > 2) ? atoi(argv[2]) : 200000;
+
+	bool ok = true;
+	for (unsigned int n = 1; n <= max_producers; n *= 2) {
+		ok &= run(n, num_messages);
+	}
+
+	return qa::result(qa::check(ok, "messages lost or out of order"));
+}
+
+/// @endcond
@@ -30,15 +30,22 @@
 #include <blackboard/local.h>
 #include <blackboard/remote.h>
 #include <core/exceptions/system.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
 #include <core/threading/thread.h>
 #include <interfaces/TestInterface.h>
 #include <logging/liblogger.h>
+#include <utils/qa/qa_check.h>
+#include <utils/time/time.h>
 
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <set>
 #include <signal.h>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -150,6 +157,60 @@ private:
 	BlackBoard *bb_;
 };
 
+class QaBBAsyncListener : public BlackBoardInterfaceListener
+{
+public:
+	QaBBAsyncListener(Interface *interface) : BlackBoardInterfaceListener("QaBBAsyncListener")
+	{
+		num_events = 0;
+		bbil_set_async_data_events(true, /* queue length */ 4);
+		bbil_add_data_interface(interface);
+	}
+
+	virtual void
+	bb_interface_data_refreshed(Interface *interface) throw()
+	{
+		// simulate a slow listener, the writer must not be delayed by this
+		usleep(1000);
+		++num_events;
+	}
+
+	unsigned int num_events;
+};
+
+// Listeners which have been unregistered and deleted must not receive
+// events, even if a write happened concurrently to unregistering.
+static Mutex                                   live_listeners_mutex;
+static std::set<BlackBoardInterfaceListener *> live_listeners;
+static std::atomic<unsigned int>               num_dead_listener_events(0);
+
+class QaBBChurnListener : public BlackBoardInterfaceListener
+{
+public:
+	QaBBChurnListener(Interface *interface) : BlackBoardInterfaceListener("QaBBChurnListener")
+	{
+		bbil_set_async_data_events(true, /* queue length */ 4);
+		bbil_add_data_interface(interface);
+		MutexLocker lock(&live_listeners_mutex);
+		live_listeners.insert(this);
+	}
+
+	virtual ~QaBBChurnListener()
+	{
+		MutexLocker lock(&live_listeners_mutex);
+		live_listeners.erase(this);
+	}
+
+	virtual void
+	bb_interface_data_refreshed(Interface *interface) throw()
+	{
+		MutexLocker lock(&live_listeners_mutex);
+		if (live_listeners.find(this) == live_listeners.end()) {
+			num_dead_listener_events += 1;
+		}
+	}
+};
+
 int
 main(int argc, char **argv)
 {
@@ -239,6 +300,50 @@ main(int argc, char **argv)
 	bb->unregister_listener(&qabbel);
 	usleep(100000);
 
+	printf("Testing asynchronous data events, writing 100 times\n");
+	QaBBAsyncListener qabbal(ti_reader_2);
+	bb->register_listener(&qabbal, BlackBoard::BBIL_FLAG_DATA);
+	TestInterface *ti_writer_async = bb->open_for_writing<TestInterface>("SomeID reader 1");
+	Time           write_start;
+	for (unsigned int i = 0; i < 100; ++i) {
+		ti_writer_async->set_test_int(i);
+		ti_writer_async->write();
+	}
+	Time write_end;
+	usleep(100000);
+	bb->unregister_listener(&qabbal);
+	printf("Writes took %f sec, %u events delivered, %u coalesced, %u dropped\n",
+	       write_end - &write_start,
+	       qabbal.num_events,
+	       qabbal.bbil_num_coalesced_data_events(),
+	       qabbal.bbil_num_dropped_data_events());
+
+	printf("Testing unregistering asynchronous listeners while writing\n");
+	std::atomic<bool> churn_running(true);
+	std::thread       churn_writer([ti_writer_async, &churn_running]() {
+		unsigned int i = 0;
+		while (churn_running) {
+			ti_writer_async->set_test_int(++i);
+			ti_writer_async->write();
+		}
+	});
+	for (unsigned int i = 0; i < 1000; ++i) {
+		QaBBChurnListener *l = new QaBBChurnListener(ti_reader_2);
+		bb->register_listener(l, BlackBoard::BBIL_FLAG_DATA);
+		usleep(i % 10);
+		bb->unregister_listener(l);
+		delete l;
+	}
+	churn_running = false;
+	churn_writer.join();
+	usleep(100000);
+	if (qa::check(num_dead_listener_events == 0,
+	              "%u events delivered to unregistered listeners",
+	              num_dead_listener_events.load())) {
+		printf("No events delivered to unregistered listeners\n");
+	}
+	bb->close(ti_writer_async);
+
 	printf("Removing other writers. No warning should appear.\n");
 	bb->close(ti_writer_2);
 	bb->close(ti_writer_3);
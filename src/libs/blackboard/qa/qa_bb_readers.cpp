@@ -0,0 +1,197 @@
+/***************************************************************************
+ *  qa_bb_readers.cpp - BlackBoard concurrent reader benchmark QA
+ *
+ *  Created: Sat Oct 17 14:02:11 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <blackboard/bbconfig.h>
+#include <blackboard/local.h>
+#include <core/threading/thread.h>
+#include <interfaces/TestInterface.h>
+#include <utils/qa/qa_check.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace fawkes;
+
+/* Measures the latency of Interface::read() and Interface::write() with
+ * one writer and N concurrent readers, once using the read/write lock and
+ * once using optimistic (sequence counter based) reading.
+ * The writer always sets test_int and test_uint to the same value, a reader
+ * seeing different values has observed a torn read.
+ */
+
+class BenchReaderThread : public Thread
+{
+public:
+	BenchReaderThread(TestInterface *iface)
+	: Thread("BenchReaderThread", Thread::OPMODE_CONTINUOUS), iface_(iface)
+	{
+		num_reads = 0;
+		num_torn  = 0;
+		total_sec = 0.;
+		max_sec   = 0.;
+	}
+
+	virtual void
+	loop()
+	{
+		Time start;
+		iface_->read();
+		Time   end;
+		double d = end - &start;
+		total_sec += d;
+		if (d > max_sec)
+			max_sec = d;
+		if ((unsigned int)iface_->test_int() != iface_->test_uint())
+			++num_torn;
+		++num_reads;
+	}
+
+	unsigned long int num_reads;
+	unsigned long int num_torn;
+	double            total_sec;
+	double            max_sec;
+
+private:
+	TestInterface *iface_;
+};
+
+class BenchWriterThread : public Thread
+{
+public:
+	BenchWriterThread(TestInterface *iface)
+	: Thread("BenchWriterThread", Thread::OPMODE_CONTINUOUS), iface_(iface)
+	{
+		num_writes = 0;
+		total_sec  = 0.;
+		max_sec    = 0.;
+	}
+
+	virtual void
+	loop()
+	{
+		iface_->set_test_int(num_writes);
+		iface_->set_test_uint(num_writes);
+		Time start;
+		iface_->write();
+		Time   end;
+		double d = end - &start;
+		total_sec += d;
+		if (d > max_sec)
+			max_sec = d;
+		++num_writes;
+		usleep(100);
+	}
+
+	unsigned long int num_writes;
+	double            total_sec;
+	double            max_sec;
+
+private:
+	TestInterface *iface_;
+};
+
+static bool
+run(BlackBoard *bb, unsigned int num_readers, unsigned int duration_sec, bool optimistic)
+{
+	TestInterface *writer = bb->open_for_writing<TestInterface>("Bench");
+
+	vector<TestInterface *>     readers;
+	vector<BenchReaderThread *> rthreads;
+	for (unsigned int i = 0; i < num_readers; ++i) {
+		TestInterface *r = bb->open_for_reading<TestInterface>("Bench");
+		r->set_optimistic_reading(optimistic);
+		readers.push_back(r);
+		rthreads.push_back(new BenchReaderThread(r));
+	}
+	BenchWriterThread *wthread = new BenchWriterThread(writer);
+
+	wthread->start();
+	for (auto t : rthreads)
+		t->start();
+
+	sleep(duration_sec);
+
+	wthread->cancel();
+	wthread->join();
+	for (auto t : rthreads) {
+		t->cancel();
+		t->join();
+	}
+
+	unsigned long int num_reads = 0, num_torn = 0;
+	double            read_total = 0., read_max = 0.;
+	for (auto t : rthreads) {
+		num_reads += t->num_reads;
+		num_torn += t->num_torn;
+		read_total += t->total_sec;
+		if (t->max_sec > read_max)
+			read_max = t->max_sec;
+	}
+
+	printf("%-10s  readers: %3u  reads: %10lu  read avg: %8.3f us  max: %9.3f us  "
+	       "writes: %8lu  write avg: %8.3f us  max: %9.3f us  torn: %lu\n",
+	       optimistic ? "optimistic" : "locked",
+	       num_readers,
+	       num_reads,
+	       num_reads > 0 ? read_total / num_reads * 1e6 : 0.,
+	       read_max * 1e6,
+	       wthread->num_writes,
+	       wthread->num_writes > 0 ? wthread->total_sec / wthread->num_writes * 1e6 : 0.,
+	       wthread->max_sec * 1e6,
+	       num_torn);
+
+	for (auto t : rthreads)
+		delete t;
+	delete wthread;
+	for (auto r : readers)
+		bb->close(r);
+	bb->close(writer);
+
+	return (num_torn == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int max_readers  = (argc > 1) ? atoi(argv[1]) : 32;
+	unsigned int duration_sec = (argc > 2) ? atoi(argv[2]) : 2;
+
+	BlackBoard *bb = new LocalBlackBoard(BLACKBOARD_MEMSIZE);
+
+	bool ok = true;
+	for (unsigned int n = 1; n <= max_readers; n *= 2) {
+		ok &= run(bb, n, duration_sec, false);
+		ok &= run(bb, n, duration_sec, true);
+	}
+
+	delete bb;
+
+	return qa::result(qa::check(ok, "torn reads detected"));
+}
+
+/// @endcond
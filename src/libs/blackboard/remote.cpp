@@ -47,6 +47,12 @@ namespace fawkes {
  * This class implements the access to a remote BlackBoard using the Fawkes
  * network protocol.
  *
+ * By default data updates of reading instances are requested as delta to
+ * the previous update, which significantly reduces the bandwidth for large
+ * interfaces of which only a small part changes per update. The update
+ * rate can be limited, e.g. for remote tools on slow links. Use
+ * set_update_mode() to change this.
+ *
  * @author Tim Niemueller
  */
 
@@ -72,6 +78,9 @@ RemoteBlackBoard::RemoteBlackBoard(FawkesNetworkClient *client)
 
 	inbound_thread_ = NULL;
 	m_              = NULL;
+
+	delta_updates_        = true;
+	update_interval_msec_ = 0;
 }
 
 /** Constructor.
@@ -106,6 +115,9 @@ RemoteBlackBoard::RemoteBlackBoard(const char *hostname, unsigned short int port
 
 	inbound_thread_ = NULL;
 	m_              = NULL;
+
+	delta_updates_        = true;
+	update_interval_msec_ = 0;
 }
 
 /** Destructor. */
@@ -220,6 +232,9 @@ RemoteBlackBoard::open_interface(const char *type,
 		BlackBoardInterfaceProxy *proxy =
 		  new BlackBoardInterfaceProxy(fnc_, m_, notifier_, iface, writer);
 		proxies_[proxy->serial()] = proxy;
+		if (!writer && (delta_updates_ || (update_interval_msec_ > 0))) {
+			proxy->subscribe(delta_updates_, update_interval_msec_);
+		}
 	} else if (m_->msgid() == MSG_BB_OPEN_FAILURE) {
 		bb_iopenfail_msg_t *fm    = m_->msg<bb_iopenfail_msg_t>();
 		unsigned int        error = ntohl(fm->error_code);
@@ -439,6 +454,42 @@ RemoteBlackBoard::list(const char *type_pattern, const char *id_pattern)
 	return infl;
 }
 
+/** Set how data updates are transmitted for new reading instances.
+ * Applies to interfaces opened for reading afterwards.
+ * @param delta true to receive updates as delta to the previous update,
+ * false to receive the full data with each update
+ * @param min_interval_msec minimum time between two updates, updates within
+ * this time are coalesced by the remote BlackBoard, 0 to receive every update
+ */
+void
+RemoteBlackBoard::set_update_mode(bool delta, unsigned int min_interval_msec)
+{
+	delta_updates_        = delta;
+	update_interval_msec_ = min_interval_msec;
+}
+
+/** Set how data updates are transmitted for an interface.
+ * @param interface interface opened for reading via this BlackBoard
+ * @param delta true to receive updates as delta to the previous update,
+ * false to receive the full data with each update
+ * @param min_interval_msec minimum time between two updates, updates within
+ * this time are coalesced by the remote BlackBoard, 0 to receive every update
+ * @exception Exception thrown if the interface has not been opened for
+ * reading via this BlackBoard
+ */
+void
+RemoteBlackBoard::set_update_mode(Interface *interface, bool delta, unsigned int min_interval_msec)
+{
+	if (interface->is_writer()) {
+		throw Exception("Update mode can only be set for reading instances");
+	}
+	MutexLocker lock(proxies_.mutex());
+	if (proxies_.find(interface->serial()) == proxies_.end()) {
+		throw Exception("Interface %s has not been opened via this BlackBoard", interface->uid());
+	}
+	proxies_[interface->serial()]->subscribe(delta, min_interval_msec);
+}
+
 /** We are no longer registered in Fawkes network client.
  * Ignored.
  * @param id the id of the calling client
@@ -463,6 +514,11 @@ RemoteBlackBoard::inbound_received(FawkesNetworkMessage *m, unsigned int id) thr
 				if (proxies_.find(serial) != proxies_.end()) {
 					proxies_[serial]->process_data_refreshed(m);
 				}
+			} else if (msgid == MSG_BB_DATA_DELTA) {
+				Uuid serial = ((Uuid *)m->payload())[0];
+				if (proxies_.find(serial) != proxies_.end()) {
+					proxies_[serial]->process_data_delta(m);
+				}
 			} else if (msgid == MSG_BB_INTERFACE_MESSAGE) {
 				Uuid serial = ((Uuid *)m->payload())[0];
 				if (proxies_.find(serial) != proxies_.end()) {
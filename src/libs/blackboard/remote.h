@@ -75,6 +75,8 @@ public:
 	virtual void connection_established(unsigned int id) throw();
 
 	/* extensions for RemoteBlackBoard */
+	void set_update_mode(bool delta, unsigned int min_interval_msec = 0);
+	void set_update_mode(Interface *interface, bool delta, unsigned int min_interval_msec = 0);
 
 private: /* methods */
 	void open_interface(const char *type,
@@ -101,6 +103,9 @@ private: /* members */
 	WaitCondition *wait_cond_;
 
 	const char *inbound_thread_;
+
+	bool         delta_updates_;
+	unsigned int update_interval_msec_;
 };
 
 } // end namespace fawkes
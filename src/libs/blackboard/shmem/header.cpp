@@ -25,6 +25,7 @@
 #include <utils/ipc/shm.h>
 
 #include <cstddef>
+#include <cstring>
 
 namespace fawkes {
 
@@ -32,9 +33,9 @@ namespace fawkes {
  * BlackBoard Shared Memory Header.
  * This class is used identify BlackBoard shared memory headers and
  * to interact with the management data in the shared memory segment.
- * The basic options stored in the header is a version identifier
- * and pointers to the list heads of the free and allocated chunk
- * lists.
+ * The basic options stored in the header is a version identifier,
+ * the free chunk lists per size class, a pointer to the list head
+ * of the allocated chunk list and the chunk hash index.
  *
  * @author Tim Niemueller
  * @see SharedMemoryHeader
@@ -147,8 +148,9 @@ BlackBoardSharedMemoryHeader::initialize(void *memptr)
 	data                  = (BlackBoardSharedMemoryHeaderData *)memptr;
 	data->version         = _version;
 	data->shm_addr        = memptr;
-	data->free_list_head  = NULL;
 	data->alloc_list_head = NULL;
+	memset(&data->free_bins, 0, sizeof(chunk_bins_t));
+	memset(&data->index, 0, sizeof(chunk_index_t));
 }
 
 /** Set data of this header
@@ -177,14 +179,15 @@ BlackBoardSharedMemoryHeader::data_size()
 	return _data_size;
 }
 
-/** Get the head of the free chunks list.
- * @return pointer to the free list head, local pointer, already transformed,
- * you can use this without further conversion.
+/** Get the free chunk lists.
+ * @return pointer to the free chunk lists in the shared memory segment. Note
+ * that the list heads are shared memory addresses which must be transformed
+ * with SharedMemory::ptr() before use.
  */
-chunk_list_t *
-BlackBoardSharedMemoryHeader::free_list_head()
+chunk_bins_t *
+BlackBoardSharedMemoryHeader::free_bins()
 {
-	return (chunk_list_t *)shmem->ptr(data->free_list_head);
+	return &data->free_bins;
 }
 
 /** Get the head of the allocated chunks list.
@@ -197,14 +200,15 @@ BlackBoardSharedMemoryHeader::alloc_list_head()
 	return (chunk_list_t *)shmem->ptr(data->alloc_list_head);
 }
 
-/** Set the head of the free chunks list.
- * @param flh pointer to the new free list head, must be a pointer to the local
- * shared memory segment. Will be transformed to a shared memory address.
+/** Get the chunk hash index.
+ * @return pointer to the chunk index in the shared memory segment. Note
+ * that the bucket heads are shared memory addresses which must be transformed
+ * with SharedMemory::ptr() before use.
  */
-void
-BlackBoardSharedMemoryHeader::set_free_list_head(chunk_list_t *flh)
+chunk_index_t *
+BlackBoardSharedMemoryHeader::index()
 {
-	data->free_list_head = (chunk_list_t *)shmem->addr(flh);
+	return &data->index;
 }
 
 /** Set the head of the allocated chunks list.
@@ -40,8 +40,9 @@ private:
 	{
 		unsigned int  version;         /**< version of the BB */
 		void *        shm_addr;        /**< base addr of shared memory */
-		chunk_list_t *free_list_head;  /**< offset of the free chunks list head */
+		chunk_bins_t  free_bins;       /**< free chunk lists per size class */
 		chunk_list_t *alloc_list_head; /**< offset of the allocated chunks list head */
+		chunk_index_t index;           /**< chunk hash index */
 	} BlackBoardSharedMemoryHeaderData;
 
 public:
@@ -58,9 +59,9 @@ public:
 	virtual size_t              data_size();
 	virtual SharedMemoryHeader *clone() const;
 	virtual bool                operator==(const fawkes::SharedMemoryHeader &s) const;
-	chunk_list_t *              free_list_head();
+	chunk_bins_t *              free_bins();
 	chunk_list_t *              alloc_list_head();
-	void                        set_free_list_head(chunk_list_t *flh);
+	chunk_index_t *             index();
 	void                        set_alloc_list_head(chunk_list_t *alh);
 
 	unsigned int version() const;
@@ -35,6 +35,10 @@ namespace fawkes {
  * configuration options no matter of how the database is implemented.
  * This is mainly done to allow for testing different solutions for ticket #10.
  *
+ * Values which are read often, e.g. in a thread's loop, should be read
+ * through a ConfigHandle, which only queries the configuration again
+ * after a value has changed.
+ *
  * @fn Configuration::~Configuration()
  * Virtual empty destructor.
  *
@@ -643,6 +647,24 @@ Configuration::rem_change_handler(ConfigurationChangeHandler *h)
 	}
 }
 
+/** Constructor. */
+Configuration::Configuration() : generation_(0)
+{
+}
+
+/** Get change generation.
+ * The generation is incremented whenever a value is changed or erased
+ * and before the change handlers are notified. It can be used to detect
+ * changes cheaply without querying values, e.g. to invalidate cached
+ * values. It is read without locking.
+ * @return change generation
+ */
+unsigned int
+Configuration::generation() const
+{
+	return generation_.load(std::memory_order_acquire);
+}
+
 /** Find handlers for given path.
  * @param path path to get handlers for
  * @return list with config change handlers.
@@ -673,6 +695,10 @@ Configuration::find_handlers(const char *path)
 void
 Configuration::notify_handlers(const char *path, bool comment_changed)
 {
+	if (!comment_changed) {
+		generation_.fetch_add(1, std::memory_order_release);
+	}
+
 	ChangeHandlerList *           h     = find_handlers(path);
 	Configuration::ValueIterator *value = get_value(path);
 	if (value->next()) {
@@ -27,6 +27,7 @@
 #include <core/exception.h>
 #include <utils/misc/string_compare.h>
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <string>
@@ -67,6 +68,7 @@ public:
 class Configuration
 {
 public:
+	Configuration();
 	virtual ~Configuration()
 	{
 	}
@@ -113,6 +115,8 @@ public:
 	virtual void add_change_handler(ConfigurationChangeHandler *h);
 	virtual void rem_change_handler(ConfigurationChangeHandler *h);
 
+	unsigned int generation() const;
+
 	virtual void load(const char *file_path) = 0;
 
 	virtual bool exists(const char *path)    = 0;
@@ -462,6 +466,9 @@ protected:
 
 	ChangeHandlerList *find_handlers(const char *path);
 	void               notify_handlers(const char *path, bool comment_changed = false);
+
+private:
+	std::atomic<unsigned int> generation_;
 };
 
 } // end namespace fawkes
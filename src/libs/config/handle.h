@@ -0,0 +1,199 @@
+/***************************************************************************
+ *  handle.h - Fawkes configuration value handle
+ *
+ *  Created: Sun Oct 18 14:22:07 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _CONFIG_HANDLE_H_
+#define _CONFIG_HANDLE_H_
+
+#include <config/config.h>
+
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+namespace config_handle {
+inline void
+read(Configuration *c, const char *p, float &v)
+{
+	v = c->get_float(p);
+}
+inline void
+read(Configuration *c, const char *p, unsigned int &v)
+{
+	v = c->get_uint(p);
+}
+inline void
+read(Configuration *c, const char *p, int &v)
+{
+	v = c->get_int(p);
+}
+inline void
+read(Configuration *c, const char *p, bool &v)
+{
+	v = c->get_bool(p);
+}
+inline void
+read(Configuration *c, const char *p, std::string &v)
+{
+	v = c->get_string(p);
+}
+inline void
+read(Configuration *c, const char *p, std::vector<float> &v)
+{
+	v = c->get_floats(p);
+}
+inline void
+read(Configuration *c, const char *p, std::vector<unsigned int> &v)
+{
+	v = c->get_uints(p);
+}
+inline void
+read(Configuration *c, const char *p, std::vector<int> &v)
+{
+	v = c->get_ints(p);
+}
+inline void
+read(Configuration *c, const char *p, std::vector<bool> &v)
+{
+	v = c->get_bools(p);
+}
+inline void
+read(Configuration *c, const char *p, std::vector<std::string> &v)
+{
+	v = c->get_strings(p);
+}
+} // end namespace config_handle
+/// @endcond
+
+/** Handle to a configuration value.
+ * A handle is bound to a path once and caches the value of that path.
+ * The configuration is only queried again after any value has been
+ * changed, which is detected by comparing Configuration::generation().
+ * Reading a value which has not changed is therefore a single atomic
+ * load, which makes handles suitable to read parameters in a loop
+ * instead of reading them only once during initialization.
+ *
+ * The value type T must be one of the types supported by the
+ * Configuration getters, i.e. float, unsigned int, int, bool,
+ * std::string, or a std::vector of those.
+ *
+ * Changes are only detected for configurations which notify change
+ * handlers on modification. A handle must not be used concurrently
+ * from multiple threads, give each thread its own handle instead.
+ * @author Tim Niemueller
+ */
+template <typename T>
+class ConfigHandle
+{
+public:
+	/** Constructor.
+	 * @param config configuration to read from
+	 * @param path path of the value
+	 */
+	ConfigHandle(Configuration *config, const char *path)
+	: config_(config), path_(path), has_default_(false), default_(), value_(), valid_(false)
+	{
+	}
+
+	/** Constructor.
+	 * @param config configuration to read from
+	 * @param path path of the value
+	 * @param default_value value to return if the path does not exist
+	 */
+	ConfigHandle(Configuration *config, const char *path, const T &default_value)
+	: config_(config),
+	  path_(path),
+	  has_default_(true),
+	  default_(default_value),
+	  value_(),
+	  valid_(false)
+	{
+	}
+
+	/** Get path of the value.
+	 * @return path of the value
+	 */
+	const std::string &
+	path() const
+	{
+		return path_;
+	}
+
+	/** Get value.
+	 * @return current value, the reference is valid until the next call
+	 * @exception ConfigEntryNotFoundException thrown if the path does
+	 * not exist and no default value has been given
+	 * @exception Exception thrown if the value cannot be converted to T
+	 */
+	const T &
+	get()
+	{
+		// read generation first, a change while reading causes another read
+		unsigned int generation = config_->generation();
+		if (!valid_ || generation != generation_) {
+			try {
+				config_handle::read(config_, path_.c_str(), value_);
+			} catch (ConfigEntryNotFoundException &e) {
+				if (!has_default_)
+					throw;
+				value_ = default_;
+			}
+			generation_ = generation;
+			valid_      = true;
+		}
+		return value_;
+	}
+
+	/** Get value.
+	 * @return current value
+	 * @see get()
+	 */
+	const T &
+	operator*()
+	{
+		return get();
+	}
+
+	/** Access members of value.
+	 * @return pointer to current value
+	 * @see get()
+	 */
+	const T *
+	operator->()
+	{
+		return &get();
+	}
+
+private:
+	Configuration *config_;
+	std::string    path_;
+	bool           has_default_;
+	T              default_;
+	T              value_;
+	bool           valid_;
+	unsigned int   generation_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -0,0 +1,179 @@
+
+/***************************************************************************
+ *  qa_config_handle.cpp - QA for configuration value handles
+ *
+ *  Created: Sun Oct 18 14:51:16 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <config/handle.h>
+#include <config/yaml.h>
+#include <utils/qa/qa_check.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/* Loads a configuration from a temporary directory, compares reading
+ * a value with get_float() to reading it through a ConfigHandle, and
+ * checks that handles pick up changed and erased values. While values
+ * are changed, reader threads continuously read values to verify that
+ * reading concurrently to modifications is safe.
+ */
+
+// relative includes are resolved against CONFDIR, the host file
+// include is therefore written with the absolute temporary path
+static const char *CONFIG_META = "%YAML 1.2\n"
+                                 "%TAG ! tag:fawkesrobotics.org,cfg/\n"
+                                 "---\n"
+                                 "include:\n"
+                                 "  - !host-specific ";
+
+static const char *CONFIG = "\n"
+                            "---\n"
+                            "plugins:\n"
+                            "  qa:\n"
+                            "    gain: 1.5\n"
+                            "    enabled: true\n"
+                            "    frames: [base_link, odom, map]\n"
+                            "    deep:\n"
+                            "      nested:\n"
+                            "        tree:\n"
+                            "          value: 42\n";
+
+int
+main(int argc, char **argv)
+{
+	char tmpdir[] = "/tmp/qa_config_handle_XXXXXX";
+	if (mkdtemp(tmpdir) == NULL) {
+		perror("Failed to create temporary directory");
+		return 1;
+	}
+	std::string config_file = std::string(tmpdir) + "/config.yaml";
+	std::string host_file   = std::string(tmpdir) + "/host.yaml";
+	FILE *      f           = fopen(config_file.c_str(), "w");
+	fputs(CONFIG_META, f);
+	fputs(host_file.c_str(), f);
+	fputs(CONFIG, f);
+	fclose(f);
+	f = fopen(host_file.c_str(), "w");
+	fputs("---\n", f);
+	fclose(f);
+
+	bool ok = true;
+	try {
+		YamlConfiguration config(tmpdir, tmpdir);
+		config.load("config.yaml");
+
+		ConfigHandle<float>                    gain(&config, "/plugins/qa/gain");
+		ConfigHandle<bool>                     enabled(&config, "/plugins/qa/enabled");
+		ConfigHandle<std::vector<std::string>> frames(&config, "/plugins/qa/frames");
+		ConfigHandle<unsigned int>             deep(&config, "/plugins/qa/deep/nested/tree/value");
+		ConfigHandle<int>                      missing(&config, "/plugins/qa/missing", -1);
+
+		ok &= qa::check(*gain == 1.5f, "gain differs from file");
+		ok &= qa::check(*enabled, "enabled differs from file");
+		ok &= qa::check(frames->size() == 3 && (*frames)[2] == "map", "frames differ from file");
+		ok &= qa::check(*deep == 42, "deep value differs from file");
+		ok &= qa::check(*missing == -1, "missing value is not default");
+		ok &= qa::check(config.get_uint("plugins//qa/deep/nested/tree/value/") == 42,
+		                "path is not normalized");
+		ok &= qa::check(config.exists("/plugins/qa/gain") && !config.exists("/plugins/qa"),
+		                "exists() is wrong");
+
+		const unsigned int num_reads = 2000000;
+		float              sum       = 0.f;
+		long int           start     = qa::now_nsec();
+		for (unsigned int i = 0; i < num_reads; ++i)
+			sum += config.get_float("/plugins/qa/deep/nested/tree/value");
+		long int get_nsec = qa::now_nsec() - start;
+		start             = qa::now_nsec();
+		for (unsigned int i = 0; i < num_reads; ++i)
+			sum += *deep;
+		long int handle_nsec = qa::now_nsec() - start;
+		printf("get_float() %6.1f nsec, handle %6.1f nsec per read (%g)\n",
+		       (double)get_nsec / num_reads,
+		       (double)handle_nsec / num_reads,
+		       sum);
+
+		std::atomic<bool>         running(true);
+		std::atomic<unsigned int> reader_errors(0);
+		std::vector<std::thread>  readers;
+		for (unsigned int t = 0; t < 4; ++t) {
+			readers.push_back(std::thread([&config, &running, &reader_errors]() {
+				ConfigHandle<float> gain(&config, "/plugins/qa/gain");
+				while (running) {
+					try {
+						if (!std::isfinite(*gain) || config.get_float("/plugins/qa/gain") < 1.5f)
+							++reader_errors;
+						config.get_strings("/plugins/qa/frames");
+					} catch (Exception &e) {
+						++reader_errors;
+					}
+				}
+			}));
+		}
+
+		for (unsigned int i = 0; i < 200; ++i) {
+			config.set_float("/plugins/qa/gain", 2.0f + i);
+			config.set_string("/plugins/qa/new/value", "x");
+			config.erase("/plugins/qa/new/value");
+		}
+		running = false;
+		for (std::thread &t : readers)
+			t.join();
+		ok &= qa::check(reader_errors == 0, "concurrent reads failed");
+
+		ok &= qa::check(*gain == 201.f, "changed gain not seen");
+		config.set_int("/plugins/qa/missing", 7);
+		ok &= qa::check(*missing == 7, "new value not seen");
+		config.erase("/plugins/qa/missing");
+		ok &= qa::check(*missing == -1, "erased value still seen");
+		ok &= qa::check(*frames == config.get_strings("/plugins/qa/frames"), "frames changed");
+
+		// batch of changes within an explicit lock, written once on unlock
+		config.lock();
+		config.set_float("/plugins/qa/gain", 3.0f);
+		config.set_bool("/plugins/qa/enabled", false);
+		config.unlock();
+		ok &= qa::check(*gain == 3.0f && !*enabled, "locked changes not seen");
+		YamlConfiguration reread(tmpdir, tmpdir);
+		reread.load("config.yaml");
+		ok &= qa::check(reread.get_float("/plugins/qa/gain") == 3.0f
+		                  && !reread.get_bool("/plugins/qa/enabled"),
+		                "locked changes not written to host file");
+	} catch (Exception &e) {
+		e.print_trace();
+		ok = false;
+	}
+
+	unlink(host_file.c_str());
+	unlink(config_file.c_str());
+	rmdir(tmpdir);
+
+	return qa::result(ok);
+}
+
+/// @endcond
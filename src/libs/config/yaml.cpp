@@ -303,9 +303,12 @@ YamlConfiguration::YamlValueIterator::is_default() const
 YamlConfiguration::YamlConfiguration()
 {
 	fam_thread_          = NULL;
-	mutex                = new Mutex();
+	mutex                = new Mutex(Mutex::RECURSIVE);
+	lock_count_          = 0;
 	write_pending_       = false;
 	write_pending_mutex_ = new Mutex();
+	snapshot_            = std::make_shared<const Snapshot>();
+	snapshot_mutex_      = new Mutex();
 
 	sysconfdir_  = NULL;
 	userconfdir_ = NULL;
@@ -323,9 +326,12 @@ YamlConfiguration::YamlConfiguration()
 YamlConfiguration::YamlConfiguration(const char *sysconfdir, const char *userconfdir)
 {
 	fam_thread_          = NULL;
-	mutex                = new Mutex();
+	mutex                = new Mutex(Mutex::RECURSIVE);
+	lock_count_          = 0;
 	write_pending_       = false;
 	write_pending_mutex_ = new Mutex();
+	snapshot_            = std::make_shared<const Snapshot>();
+	snapshot_mutex_      = new Mutex();
 
 	sysconfdir_ = strdup(sysconfdir);
 
@@ -362,6 +368,7 @@ YamlConfiguration::~YamlConfiguration()
 		free(userconfdir_);
 	delete mutex;
 	delete write_pending_mutex_;
+	delete snapshot_mutex_;
 }
 
 void
@@ -403,6 +410,7 @@ YamlConfiguration::load(const char *file_path)
 	host_file_ = "";
 	std::list<std::string> files, dirs;
 	read_yaml_config(filename, host_file_, root_, host_root_, files, dirs);
+	update_snapshot();
 
 #ifdef HAVE_INOTIFY
 	fam_thread_                       = new FamThread();
@@ -541,6 +549,7 @@ YamlConfiguration::fam_event(const char *filename, unsigned int mask)
 			root_      = root;
 			host_root_ = host_root;
 			host_file_ = host_file;
+			update_snapshot();
 
 			std::list<std::string>::iterator c;
 			for (c = changes.begin(); c != changes.end(); ++c) {
@@ -692,19 +701,14 @@ YamlConfiguration::write_host_file()
 	if (host_file_ == "") {
 		throw Exception("YamlConfig: no host config file specified");
 	}
-	if (mutex->try_lock()) {
-		try {
-			host_root_->emit(host_file_);
-			mutex->unlock();
-		} catch (...) {
-			write_pending_mutex_->unlock();
-			mutex->unlock();
-			throw;
-		}
-	} else {
+	MutexLocker lock(mutex);
+	if (lock_count_ > 0) {
+		// explicitly locked, write once on unlock()
 		write_pending_mutex_->lock();
 		write_pending_ = true;
 		write_pending_mutex_->unlock();
+	} else {
+		host_root_->emit(host_file_);
 	}
 }
 
@@ -718,8 +722,8 @@ bool
 YamlConfiguration::exists(const char *path)
 {
 	try {
-		std::shared_ptr<YamlConfigurationNode> n = root_->find(path);
-		return !n->has_children();
+		lookup(path);
+		return true;
 	} catch (Exception &e) {
 		return false;
 	}
@@ -742,100 +746,177 @@ YamlConfiguration::get_comment(const char *path)
 	return "";
 }
 
-/** Retrieve value casted to given type T.
- * @param root root node of the tree to search
+/** Update the snapshot of all values.
+ * The snapshot maps the full path of each value to an immutable copy of
+ * its node. It is replaced atomically, a reader which already retrieved
+ * the previous snapshot keeps using it without locking. Must be called
+ * with the config mutex held after any modification of root_.
+ * @param path if not NULL, only the value at the given path has been
+ * modified and only this entry is copied, otherwise the snapshot is
+ * rebuilt from the whole tree
+ */
+void
+YamlConfiguration::update_snapshot(const char *path)
+{
+	MutexLocker lock(snapshot_mutex_);
+
+	std::shared_ptr<Snapshot> snapshot;
+	std::string               key;
+	if (path) {
+		std::queue<std::string> pel_q = str_split_to_queue(path);
+		while (!pel_q.empty()) {
+			key += "/" + pel_q.front();
+			pel_q.pop();
+		}
+		// a new value might have replaced a leaf on its path, rebuild in that case
+		if (snapshot_->find(key) != snapshot_->end()) {
+			snapshot = std::make_shared<Snapshot>(*snapshot_);
+		} else {
+			path = NULL;
+		}
+	}
+
+	std::map<std::string, std::shared_ptr<YamlConfigurationNode>> leafs;
+	if (path) {
+		try {
+			leafs[key] = root_->find(path);
+		} catch (Exception &e) {
+			// value is gone, e.g., tree has been reloaded, rebuild
+			path = NULL;
+		}
+	}
+	if (!path) {
+		root_->enum_leafs(leafs);
+		snapshot = std::make_shared<Snapshot>(leafs.size());
+	}
+
+	for (const auto &l : leafs) {
+		std::shared_ptr<YamlConfigurationNode> n =
+		  std::make_shared<YamlConfigurationNode>(l.second->name());
+		if (l.second->is_list()) {
+			n->set_scalar_list(l.second->get_list<std::string>());
+		} else if (l.second->is_scalar()) {
+			n->set_scalar(l.second->get_scalar());
+		}
+		(*snapshot)[l.first] = n;
+	}
+
+	std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(snapshot));
+}
+
+/** Find value node in current snapshot.
  * @param path path to query
- * @return value casted as desired
- * @throw YAML::ScalarInvalid thrown if value does not exist or is of
- * a different type.
+ * @return immutable copy of the value node
+ * @exception ConfigEntryNotFoundException thrown if there is no value
+ * at the given path
  */
-template <typename T>
-static inline T
-get_value_as(std::shared_ptr<YamlConfigurationNode> root, const char *path)
+std::shared_ptr<const YamlConfigurationNode>
+YamlConfiguration::lookup(const char *path) const
 {
-	std::shared_ptr<YamlConfigurationNode> n = root->find(path);
-	if (n->has_children()) {
+	std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&snapshot_);
+
+	Snapshot::const_iterator n;
+	size_t                   len = strlen(path);
+	if (len > 1 && path[0] == '/' && path[len - 1] != '/' && strstr(path, "//") == NULL) {
+		n = snapshot->find(path);
+	} else {
+		// same normalization as YamlConfigurationNode::find()
+		std::queue<std::string> pel_q = str_split_to_queue(path);
+		std::string             key;
+		while (!pel_q.empty()) {
+			key += "/" + pel_q.front();
+			pel_q.pop();
+		}
+		n = snapshot->find(key);
+	}
+	if (n == snapshot->end()) {
 		throw ConfigEntryNotFoundException(path);
 	}
-	return n->get_value<T>();
+	return n->second;
 }
 
 /** Retrieve value casted to given type T.
- * @param root root node of the tree to search
- * @param path path to query
+ * @param n node of the value
  * @return value casted as desired
- * @throw YAML::ScalarInvalid thrown if value does not exist or is of
- * a different type.
+ * @throw YAML::ScalarInvalid thrown if value is of a different type.
+ */
+template <typename T>
+static inline T
+get_value_as(const std::shared_ptr<const YamlConfigurationNode> &n)
+{
+	return n->get_value<T>();
+}
+
+/** Retrieve list of values casted to given type T.
+ * @param n node of the value
+ * @return values casted as desired
+ * @throw YAML::ScalarInvalid thrown if value is of a different type.
  */
 template <typename T>
 static inline std::vector<T>
-get_list(std::shared_ptr<YamlConfigurationNode> root, const char *path)
+get_list(const std::shared_ptr<const YamlConfigurationNode> &n)
 {
-	std::shared_ptr<YamlConfigurationNode> n = root->find(path);
-	if (n->has_children()) {
-		throw ConfigEntryNotFoundException(path);
-	}
 	return n->get_list<T>();
 }
 
 float
 YamlConfiguration::get_float(const char *path)
 {
-	return get_value_as<float>(root_, path);
+	return get_value_as<float>(lookup(path));
 }
 
 unsigned int
 YamlConfiguration::get_uint(const char *path)
 {
-	return get_value_as<unsigned int>(root_, path);
+	return get_value_as<unsigned int>(lookup(path));
 }
 
 int
 YamlConfiguration::get_int(const char *path)
 {
-	return get_value_as<int>(root_, path);
+	return get_value_as<int>(lookup(path));
 }
 
 bool
 YamlConfiguration::get_bool(const char *path)
 {
-	return get_value_as<bool>(root_, path);
+	return get_value_as<bool>(lookup(path));
 }
 
 std::string
 YamlConfiguration::get_string(const char *path)
 {
-	return get_value_as<std::string>(root_, path);
+	return get_value_as<std::string>(lookup(path));
 }
 
 std::vector<float>
 YamlConfiguration::get_floats(const char *path)
 {
-	return get_list<float>(root_, path);
+	return get_list<float>(lookup(path));
 }
 
 std::vector<unsigned int>
 YamlConfiguration::get_uints(const char *path)
 {
-	return get_list<unsigned int>(root_, path);
+	return get_list<unsigned int>(lookup(path));
 }
 
 std::vector<int>
 YamlConfiguration::get_ints(const char *path)
 {
-	return get_list<int>(root_, path);
+	return get_list<int>(lookup(path));
 }
 
 std::vector<bool>
 YamlConfiguration::get_bools(const char *path)
 {
-	return get_list<bool>(root_, path);
+	return get_list<bool>(lookup(path));
 }
 
 std::vector<std::string>
 YamlConfiguration::get_strings(const char *path)
 {
-	return get_list<std::string>(root_, path);
+	return get_list<std::string>(lookup(path));
 }
 
 /** Check if value is of given type T.
@@ -934,45 +1015,65 @@ YamlConfiguration::get_value(const char *path)
 void
 YamlConfiguration::set_float(const char *path, float f)
 {
-	root_->set_value(path, f);
-	host_root_->set_value(path, f);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_value(path, f);
+		host_root_->set_value(path, f);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_uint(const char *path, unsigned int uint)
 {
-	root_->set_value(path, uint);
-	host_root_->set_value(path, uint);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_value(path, uint);
+		host_root_->set_value(path, uint);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_int(const char *path, int i)
 {
-	root_->set_value(path, i);
-	host_root_->set_value(path, i);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_value(path, i);
+		host_root_->set_value(path, i);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_bool(const char *path, bool b)
 {
-	root_->set_value(path, b);
-	host_root_->set_value(path, b);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_value(path, b);
+		host_root_->set_value(path, b);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_string(const char *path, const char *s)
 {
-	root_->set_value(path, std::string(s));
-	host_root_->set_value(path, std::string(s));
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_value(path, std::string(s));
+		host_root_->set_value(path, std::string(s));
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
@@ -985,54 +1086,78 @@ YamlConfiguration::set_string(const char *path, std::string &s)
 void
 YamlConfiguration::set_floats(const char *path, std::vector<float> &f)
 {
-	root_->set_list(path, f);
-	host_root_->set_list(path, f);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_list(path, f);
+		host_root_->set_list(path, f);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_uints(const char *path, std::vector<unsigned int> &u)
 {
-	root_->set_list(path, u);
-	host_root_->set_list(path, u);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_list(path, u);
+		host_root_->set_list(path, u);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_ints(const char *path, std::vector<int> &i)
 {
-	root_->set_list(path, i);
-	host_root_->set_list(path, i);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_list(path, i);
+		host_root_->set_list(path, i);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_bools(const char *path, std::vector<bool> &b)
 {
-	root_->set_list(path, b);
-	host_root_->set_list(path, b);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_list(path, b);
+		host_root_->set_list(path, b);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_strings(const char *path, std::vector<std::string> &s)
 {
-	root_->set_list(path, s);
-	host_root_->set_list(path, s);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_list(path, s);
+		host_root_->set_list(path, s);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
 void
 YamlConfiguration::set_strings(const char *path, std::vector<const char *> &s)
 {
-	root_->set_list(path, s);
-	host_root_->set_list(path, s);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		root_->set_list(path, s);
+		host_root_->set_list(path, s);
+		update_snapshot(path);
+		write_host_file();
+	}
 	notify_handlers(path, false);
 }
 
@@ -1049,9 +1174,14 @@ YamlConfiguration::set_comment(const char *path, std::string &comment)
 void
 YamlConfiguration::erase(const char *path)
 {
-	host_root_->erase(path);
-	root_->erase(path);
-	write_host_file();
+	{
+		MutexLocker lock(mutex);
+		host_root_->erase(path);
+		root_->erase(path);
+		update_snapshot();
+		write_host_file();
+	}
+	notify_handlers(path);
 }
 
 void
@@ -1116,6 +1246,7 @@ void
 YamlConfiguration::lock()
 {
 	mutex->lock();
+	++lock_count_;
 }
 
 /** Try to lock the config.
@@ -1125,7 +1256,11 @@ YamlConfiguration::lock()
 bool
 YamlConfiguration::try_lock()
 {
-	return mutex->try_lock();
+	if (mutex->try_lock()) {
+		++lock_count_;
+		return true;
+	}
+	return false;
 }
 
 /** Unlock the config.
@@ -1135,11 +1270,12 @@ void
 YamlConfiguration::unlock()
 {
 	write_pending_mutex_->lock();
-	if (write_pending_) {
+	if (lock_count_ == 1 && write_pending_) {
 		host_root_->emit(host_file_);
 		write_pending_ = false;
 	}
 	write_pending_mutex_->unlock();
+	--lock_count_;
 	mutex->unlock();
 }
 
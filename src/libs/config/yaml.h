@@ -31,6 +31,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace fawkes {
@@ -192,6 +193,13 @@ private:
 	                                                        std::list<std::string> &                dirs);
 	void                                   write_host_file();
 
+	/// @cond INTERNALS
+	typedef std::unordered_map<std::string, std::shared_ptr<const YamlConfigurationNode>> Snapshot;
+	/// @endcond
+
+	void                                         update_snapshot(const char *path = NULL);
+	std::shared_ptr<const YamlConfigurationNode> lookup(const char *path) const;
+
 	std::string config_file_;
 	std::string host_file_;
 
@@ -202,7 +210,11 @@ private:
 	Mutex *write_pending_mutex_;
 
 private:
-	Mutex *mutex;
+	Mutex *      mutex;
+	unsigned int lock_count_;
+
+	std::shared_ptr<const Snapshot> snapshot_;
+	Mutex *                         snapshot_mutex_;
 
 	typedef std::map<std::string, YAML::Node *> DocMap;
 	mutable DocMap                              documents_;
@@ -1058,6 +1058,41 @@ Thread::wait_loop_done()
 	loop_done_mutex_->unlock();
 }
 
+/** Execute a single loop iteration in the calling thread.
+ * This is meant for executors which run the loop of threads in wait-for-wakeup
+ * mode as tasks on a pool of worker threads instead of waking up the threads.
+ * The caller must make sure that the thread itself does not execute its loop
+ * at the same time, e.g. by never waking it up. Loop listeners are not
+ * notified, this is up to the executor. As in run(), loop() is executed while
+ * holding the loop mutex and it is skipped once finalization has been prepared.
+ * While the loop is executed, current_thread() returns this thread.
+ * Exceptions thrown by loop() are passed on to the caller.
+ * @return true if loop() has been executed, false if it was skipped because
+ * the thread is about to be finalized
+ */
+bool
+Thread::execute_loop()
+{
+	loopinterrupt_antistarve_mutex->stopby();
+
+	MutexLocker lock(loop_mutex);
+	if (finalize_prepared) {
+		return false;
+	}
+
+	Thread *executor = current_thread_noexc();
+	set_tsd_thread_instance(this);
+	try {
+		loop();
+	} catch (...) {
+		set_tsd_thread_instance(executor);
+		throw;
+	}
+	set_tsd_thread_instance(executor);
+
+	return true;
+}
+
 /** Code to execute in the thread.
  * Implement this method to hold the code you want to be executed continously.
  * If you do not implement this method, the default is that the thread will exit.
@@ -88,6 +88,7 @@ public:
 	void wakeup(Barrier *barrier);
 
 	void wait_loop_done();
+	bool execute_loop();
 
 	OpMode    opmode() const;
 	pthread_t thread_id() const;
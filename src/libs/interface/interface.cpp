@@ -36,10 +36,16 @@
 #include <cstdlib>
 #include <cstring>
 #include <regex.h>
+#include <sched.h>
 #include <typeinfo>
 
 namespace fawkes {
 
+/// @cond INTERNALS
+// Number of attempts for an optimistic read before falling back to the lock
+#define OPTIMISTIC_READ_MAX_RETRIES 64
+/// @endcond
+
 /** @class InterfaceWriteDeniedException <interface/interface.h>
  * This exception is thrown if a write has been attempted on a read-only interface.
  * @see Interface::write()
@@ -169,6 +175,16 @@ InterfaceInvalidException::InterfaceInvalidException(const Interface *interface,
  * hysteresis processing, or to observe the development of the values
  * in an interface.
  *
+ * Readers may optionally use optimistic reading, see
+ * set_optimistic_reading(). In that mode read() does not acquire the
+ * shared read/write lock. Instead, the writer increments a sequence
+ * counter stored in the shared memory header before and after copying
+ * the data. A reader copies the data and retries if the counter was
+ * odd (write in progress) or has changed during the copy. Readers hence
+ * never block the writer. If the data cannot be read consistently after
+ * a number of attempts, for example due to a very high write frequency,
+ * the reader falls back to acquiring the lock.
+ *
  * Interfaces are not created directly, but rather by using the
  * interface generator.
  *
@@ -239,6 +255,8 @@ InterfaceInvalidException::InterfaceInvalidException(const Interface *interface,
 Interface::Interface()
 {
 	write_access_         = false;
+	optimistic_reading_   = false;
+	mem_data_seq_         = NULL;
 	rwlock_               = NULL;
 	valid_                = true;
 	next_message_id_      = 0;
@@ -478,6 +496,10 @@ Interface::is_valid() const
 void
 Interface::read()
 {
+	if (optimistic_reading_ && mem_data_seq_ && read_optimistic()) {
+		return;
+	}
+
 	rwlock_->lock_for_read();
 	data_mutex_->lock();
 	if (valid_) {
@@ -521,7 +543,15 @@ Interface::write()
 			has_changed  = true;
 			data_changed = false;
 		}
-		memcpy(mem_data_ptr_, data_ptr, data_size);
+		if (mem_data_seq_) {
+			// odd sequence number signals optimistic readers a write in progress
+			__atomic_store_n(mem_data_seq_, *mem_data_seq_ + 1, __ATOMIC_RELAXED);
+			__atomic_thread_fence(__ATOMIC_RELEASE);
+			memcpy(mem_data_ptr_, data_ptr, data_size);
+			__atomic_store_n(mem_data_seq_, *mem_data_seq_ + 1, __ATOMIC_RELEASE);
+		} else {
+			memcpy(mem_data_ptr_, data_ptr, data_size);
+		}
 	} else {
 		data_mutex_->unlock();
 		rwlock_->unlock();
@@ -533,6 +563,66 @@ Interface::write()
 	interface_mediator_->notify_of_data_refresh(this, has_changed);
 }
 
+/** Try to read data without acquiring the read/write lock.
+ * Copies the shared data and verifies using the sequence counter that no
+ * write happened concurrently, retrying a bounded number of times.
+ * @return true if the data was read consistently, false if the caller
+ * must fall back to a locked read
+ * @exception InterfaceInvalidException thrown if the interface has
+ * been marked invalid
+ */
+bool
+Interface::read_optimistic()
+{
+	MutexLocker lock(data_mutex_);
+	if (!valid_) {
+		throw InterfaceInvalidException(this, "read()");
+	}
+
+	for (unsigned int i = 0; i < OPTIMISTIC_READ_MAX_RETRIES; ++i) {
+		uint32_t seq_begin = __atomic_load_n(mem_data_seq_, __ATOMIC_ACQUIRE);
+		if (seq_begin & 1) {
+			// writer is currently copying, give it a chance to finish
+			sched_yield();
+			continue;
+		}
+		memcpy(data_ptr, mem_data_ptr_, data_size);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(mem_data_seq_, __ATOMIC_RELAXED) == seq_begin) {
+			*local_read_timestamp_ = *timestamp_;
+			timestamp_->set_time(data_ts->timestamp_sec, data_ts->timestamp_usec);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Enable or disable optimistic reading.
+ * With optimistic reading enabled, read() does not acquire the shared
+ * read/write lock but uses the sequence counter in the interface memory
+ * header to detect concurrent writes and retries in that case. This
+ * avoids that many readers contend with the writer. It only has an effect
+ * on reading instances and if the underlying BlackBoard provides a
+ * sequence counter, otherwise read() silently uses the lock.
+ * @param enabled true to enable optimistic reading, false to disable
+ */
+void
+Interface::set_optimistic_reading(bool enabled)
+{
+	optimistic_reading_ = enabled;
+}
+
+/** Check if optimistic reading is enabled.
+ * @return true if optimistic reading has been enabled, false otherwise
+ * @see set_optimistic_reading()
+ */
+bool
+Interface::optimistic_reading() const
+{
+	return optimistic_reading_;
+}
+
 /** Get data size.
  * @return size in bytes of data segment
  */
@@ -584,13 +674,16 @@ Interface::set_mediators(InterfaceMediator *iface_mediator, MessageMediator *msg
  * @param serial mem serial
  * @param real_ptr pointer to whole chunk
  * @param data_ptr pointer to data chunk
+ * @param data_seq pointer to data sequence counter in shared memory, may
+ * be NULL in which case optimistic reading is not available
  */
 void
-Interface::set_memory(unsigned int serial, void *real_ptr, void *data_ptr)
+Interface::set_memory(unsigned int serial, void *real_ptr, void *data_ptr, uint32_t *data_seq)
 {
 	mem_serial_   = serial;
 	mem_real_ptr_ = real_ptr;
 	mem_data_ptr_ = data_ptr;
+	mem_data_seq_ = data_seq;
 }
 
 /** Set read/write info.
@@ -121,6 +121,9 @@ public:
 	void read();
 	void write();
 
+	void set_optimistic_reading(bool enabled);
+	bool optimistic_reading() const;
+
 	bool                   has_writer() const;
 	unsigned int           num_readers() const;
 	std::string            writer() const;
@@ -252,9 +255,10 @@ private:
 	void set_type_id(const char *type, const char *id);
 	void set_instance_serial(const Uuid &serial);
 	void set_mediators(InterfaceMediator *iface_mediator, MessageMediator *msg_mediator);
-	void set_memory(unsigned int serial, void *real_ptr, void *data_ptr);
+	void set_memory(unsigned int serial, void *real_ptr, void *data_ptr, uint32_t *data_seq = NULL);
 	void set_readwrite(bool write_access, RefCountRWLock *rwlock);
 	void set_owner(const char *owner);
+	bool read_optimistic();
 
 	inline unsigned int
 	next_msg_id()
@@ -274,8 +278,10 @@ private:
 
 	void *       mem_data_ptr_;
 	void *       mem_real_ptr_;
+	uint32_t *   mem_data_seq_;
 	unsigned int mem_serial_;
 	bool         write_access_;
+	bool         optimistic_reading_;
 
 	void *       buffers_;
 	unsigned int num_buffers_;
@@ -28,12 +28,78 @@
 #include <interface/message.h>
 #include <utils/time/time.h>
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include <unistd.h>
 
 namespace fawkes {
 
+/// @cond INTERNALS
+// Messages are pooled in size classes of this granularity
+#define MESSAGE_POOL_GRANULARITY 64
+// Messages bigger than granularity times number of classes are not pooled
+#define MESSAGE_POOL_NUM_CLASSES 16
+
+typedef struct message_pool_item_t
+{
+	message_pool_item_t *next;
+} message_pool_item_t;
+
+// Memory of deleted messages, per size class, pushed to by any thread
+static std::atomic<message_pool_item_t *> message_pool_[MESSAGE_POOL_NUM_CLASSES];
+
+static void
+message_pool_push(unsigned int c, message_pool_item_t *first, message_pool_item_t *last)
+{
+	last->next = message_pool_[c].load(std::memory_order_relaxed);
+	while (!message_pool_[c].compare_exchange_weak(last->next,
+	                                               first,
+	                                               std::memory_order_release,
+	                                               std::memory_order_relaxed)) {
+	}
+}
+
+// Per thread list of pooled memory. It is refilled by taking the whole
+// shared pool of a size class at once, hence there is no ABA problem.
+class MessagePoolCache
+{
+public:
+	MessagePoolCache()
+	{
+		for (unsigned int c = 0; c < MESSAGE_POOL_NUM_CLASSES; ++c) {
+			items[c] = NULL;
+		}
+	}
+
+	~MessagePoolCache()
+	{
+		for (unsigned int c = 0; c < MESSAGE_POOL_NUM_CLASSES; ++c) {
+			if (items[c]) {
+				message_pool_item_t *last = items[c];
+				while (last->next)
+					last = last->next;
+				message_pool_push(c, items[c], last);
+			}
+		}
+	}
+
+	message_pool_item_t *items[MESSAGE_POOL_NUM_CLASSES];
+};
+
+static thread_local MessagePoolCache message_pool_cache_;
+
+// Sender and source are set when the message is enqueued, initialize them
+// with a constant ID instead of generating a new UUID for each message.
+static const Uuid &
+message_unset_uuid()
+{
+	static const Uuid unset;
+	return unset;
+}
+/// @endcond
+
 /** @class Message <interface/message.h>
  * Base class for all messages passed through interfaces in Fawkes BlackBoard.
  * Do not use directly, but instead use the interface generator to generate
@@ -60,6 +126,7 @@ namespace fawkes {
  * @param type string representation of the message type
  */
 Message::Message(const char *type)
+: _sender_id(message_unset_uuid()), _source_id(message_unset_uuid())
 {
 	fieldinfo_list_ = NULL;
 
@@ -87,7 +154,7 @@ Message::Message(const char *type)
 /** Copy constructor.
  * @param mesg Message to copy.
  */
-Message::Message(const Message &mesg)
+Message::Message(const Message &mesg) : _sender_id(mesg.sender_id()), _source_id(mesg.source_id())
 {
 	message_id_         = 0;
 	hops_               = mesg.hops_;
@@ -96,8 +163,6 @@ Message::Message(const Message &mesg)
 	data_size           = mesg.data_size;
 	data_ptr            = malloc(data_size);
 	data_ts             = (message_data_ts_t *)data_ptr;
-	_sender_id          = mesg.sender_id();
-	_source_id          = mesg.source_id();
 	_sender_thread_name = strdup(mesg.sender_thread_name());
 	_type               = strdup(mesg._type);
 	time_enqueued_      = new Time(mesg.time_enqueued_);
@@ -125,7 +190,7 @@ Message::Message(const Message &mesg)
 /** Copy constructor.
  * @param mesg Message to copy.
  */
-Message::Message(const Message *mesg)
+Message::Message(const Message *mesg) : _sender_id(mesg->sender_id()), _source_id(mesg->source_id())
 {
 	message_id_                      = 0;
 	hops_                            = mesg->hops_;
@@ -134,8 +199,6 @@ Message::Message(const Message *mesg)
 	data_size                        = mesg->data_size;
 	data_ptr                         = malloc(data_size);
 	data_ts                          = (message_data_ts_t *)data_ptr;
-	_sender_id                       = mesg->sender_id();
-	_source_id                       = mesg->source_id();
 	_sender_thread_name              = strdup(mesg->sender_thread_name());
 	_type                            = strdup(mesg->_type);
 	_transmit_via_iface              = NULL;
@@ -174,6 +237,53 @@ Message::~Message()
 	}
 }
 
+/** Allocate memory for a message.
+ * Messages are usually created and deleted at a high rate, for example for
+ * each command sent to a motor or navigator. Therefore the memory of
+ * deleted messages is kept in a pool and reused for new messages of the
+ * same size class. The pool is lock-free, memory may be freed in a
+ * different thread than it has been allocated in. Pooled memory is not
+ * returned to the system.
+ * @param size size of the message object
+ * @return memory for the message object
+ */
+void *
+Message::operator new(size_t size)
+{
+	unsigned int c = (size - 1) / MESSAGE_POOL_GRANULARITY;
+	if (c >= MESSAGE_POOL_NUM_CLASSES) {
+		return ::operator new(size);
+	}
+
+	message_pool_item_t *&cache = message_pool_cache_.items[c];
+	if (cache == NULL) {
+		cache = message_pool_[c].exchange(NULL, std::memory_order_acquire);
+	}
+	if (cache != NULL) {
+		message_pool_item_t *i = cache;
+		cache                  = i->next;
+		return i;
+	}
+	return ::operator new((c + 1) * MESSAGE_POOL_GRANULARITY);
+}
+
+/** Free memory of a message.
+ * The memory is put into the message pool for reuse.
+ * @param ptr memory of the message object
+ * @param size size of the message object
+ */
+void
+Message::operator delete(void *ptr, size_t size)
+{
+	unsigned int c = (size - 1) / MESSAGE_POOL_GRANULARITY;
+	if (c >= MESSAGE_POOL_NUM_CLASSES) {
+		::operator delete(ptr);
+	} else {
+		message_pool_item_t *i = (message_pool_item_t *)ptr;
+		message_pool_push(c, i, i);
+	}
+}
+
 /** Get message ID.
  * @return message ID.
  */
@@ -83,6 +83,9 @@ public:
 
 	virtual Message *clone() const;
 
+	static void *operator new(size_t size);
+	static void  operator delete(void *ptr, size_t size);
+
 	/** Check if message has desired type.
    * @return true, if message has desired type, false otherwise
    */
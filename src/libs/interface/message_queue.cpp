@@ -49,6 +49,15 @@ MessageAlreadyQueuedException::MessageAlreadyQueuedException()
  * This message queue handles the basic messaging operations. The methods the
  * Interface provides for handling message queues are forwarded to a
  * MessageQueue instance.
+ *
+ * Appending messages is lock-free. Appended messages are pushed onto an
+ * inbox stack with an atomic compare-and-swap. The inbox is moved to the
+ * actual queue by the receiving side, i.e. when the queue is locked, when
+ * messages are removed, or when the first message is requested. The number
+ * of messages is kept in an atomic counter, therefore size() and empty()
+ * do not need to lock the queue either. Only the receiving side operations
+ * are serialized with the queue's mutex. Note that messages appended while
+ * the queue is locked are not visible to iterators until it is locked again.
  * @see Interface
  */
 
@@ -57,6 +66,8 @@ MessageQueue::MessageQueue()
 {
 	list_   = NULL;
 	end_el_ = NULL;
+	inbox_  = NULL;
+	size_   = 0;
 	mutex_  = new Mutex();
 }
 
@@ -74,16 +85,21 @@ void
 MessageQueue::flush()
 {
 	mutex_->lock();
+	drain();
 	// free list elements
 	msg_list_t *l = list_;
 	msg_list_t *next;
+	int         num = 0;
 	while (l) {
 		next = l->next;
 		l->msg->unref();
 		free(l);
 		l = next;
+		++num;
 	}
-	list_ = NULL;
+	list_   = NULL;
+	end_el_ = NULL;
+	size_.fetch_sub(num);
 	mutex_->unlock();
 }
 
@@ -98,24 +114,46 @@ MessageQueue::append(Message *msg)
 	if (msg->enqueued() != 0) {
 		throw MessageAlreadyQueuedException();
 	}
-	mutex_->lock();
 	msg->mark_enqueued();
+	msg_list_t *l = (msg_list_t *)malloc(sizeof(msg_list_t));
+	l->msg        = msg;
+	l->msg_id     = msg->id();
+	l->next       = inbox_.load(std::memory_order_relaxed);
+	while (!inbox_.compare_exchange_weak(l->next,
+	                                     l,
+	                                     std::memory_order_release,
+	                                     std::memory_order_relaxed)) {
+	}
+	// count after pushing, a positive size guarantees an available message
+	size_.fetch_add(1, std::memory_order_release);
+}
+
+/** Move messages from inbox to queue.
+ * The inbox is a stack, messages are therefore reversed to be appended to
+ * the queue in the order they have been appended. The queue must be locked.
+ */
+void
+MessageQueue::drain()
+{
+	msg_list_t *in = inbox_.exchange(NULL, std::memory_order_acquire);
+	if (in == NULL)
+		return;
+
+	msg_list_t *last = in;
+	msg_list_t *rev  = NULL;
+	while (in) {
+		msg_list_t *next = in->next;
+		in->next         = rev;
+		rev              = in;
+		in               = next;
+	}
+
 	if (list_ == NULL) {
-		list_         = (msg_list_t *)malloc(sizeof(msg_list_t));
-		list_->next   = NULL;
-		list_->msg    = msg;
-		list_->msg_id = msg->id();
-		end_el_       = list_;
+		list_ = rev;
 	} else {
-		msg_list_t *l = (msg_list_t *)malloc(sizeof(msg_list_t));
-		l->next       = NULL;
-		l->msg        = msg;
-		l->msg_id     = msg->id();
-		end_el_->next = l;
-		end_el_       = l;
+		end_el_->next = rev;
 	}
-
-	mutex_->unlock();
+	end_el_ = last;
 }
 
 /** Enqueue message after given iterator.
@@ -148,6 +186,7 @@ MessageQueue::insert_after(const MessageIterator &it, Message *msg)
 	if (l->next == NULL) {
 		end_el_ = l;
 	}
+	size_.fetch_add(1, std::memory_order_release);
 }
 
 /** Remove message from queue.
@@ -157,6 +196,7 @@ void
 MessageQueue::remove(const Message *msg)
 {
 	mutex_->lock();
+	drain();
 	msg_list_t *l = list_;
 	msg_list_t *p = NULL;
 	while (l) {
@@ -178,6 +218,7 @@ void
 MessageQueue::remove(const unsigned int msg_id)
 {
 	mutex_->lock();
+	drain();
 	msg_list_t *l = list_;
 	msg_list_t *p = NULL;
 	while (l) {
@@ -209,8 +250,12 @@ MessageQueue::remove(msg_list_t *l, msg_list_t *p)
 		// was first element
 		list_ = l->next;
 	}
+	if (l == end_el_) {
+		end_el_ = p;
+	}
 	l->msg->unref();
 	free(l);
+	size_.fetch_sub(1, std::memory_order_release);
 }
 
 /** Get number of messages in queue.
@@ -219,16 +264,10 @@ MessageQueue::remove(msg_list_t *l, msg_list_t *p)
 unsigned int
 MessageQueue::size() const
 {
-	mutex_->lock();
-	unsigned int rv = 0;
-	msg_list_t * l  = list_;
-	while (l) {
-		++rv;
-		l = l->next;
-	}
-
-	mutex_->unlock();
-	return rv;
+	// may be negative for a short time if a message is removed before the
+	// appending thread has counted it
+	int rv = size_.load(std::memory_order_acquire);
+	return (rv > 0) ? rv : 0;
 }
 
 /** Check if message queue is empty.
@@ -237,10 +276,7 @@ MessageQueue::size() const
 bool
 MessageQueue::empty() const
 {
-	mutex_->lock();
-	bool rv = (list_ == NULL);
-	mutex_->unlock();
-	return rv;
+	return (size_.load(std::memory_order_acquire) <= 0);
 }
 
 /** Lock message queue.
@@ -253,6 +289,7 @@ void
 MessageQueue::lock()
 {
 	mutex_->lock();
+	drain();
 }
 
 /** Try to lock message queue.
@@ -265,7 +302,11 @@ MessageQueue::lock()
 bool
 MessageQueue::try_lock()
 {
-	return mutex_->try_lock();
+	if (mutex_->try_lock()) {
+		drain();
+		return true;
+	}
+	return false;
 }
 
 /** Unlock message queue.
@@ -282,6 +323,11 @@ MessageQueue::unlock()
 Message *
 MessageQueue::first()
 {
+	// if the queue is locked the inbox has been moved when locking
+	if ((list_ == NULL) && mutex_->try_lock()) {
+		drain();
+		mutex_->unlock();
+	}
 	if (list_) {
 		return list_->msg;
 	} else {
@@ -295,6 +341,7 @@ void
 MessageQueue::pop()
 {
 	mutex_->lock();
+	drain();
 	if (list_) {
 		remove(list_, NULL);
 	}
@@ -27,6 +27,8 @@
 #include <core/exception.h>
 #include <core/exceptions/software.h>
 
+#include <atomic>
+
 namespace fawkes {
 
 class Message;
@@ -109,10 +111,13 @@ public:
 
 private:
 	void remove(msg_list_t *l, msg_list_t *p);
+	void drain();
 
-	msg_list_t *list_;
-	msg_list_t *end_el_;
-	Mutex *     mutex_;
+	msg_list_t *              list_;
+	msg_list_t *              end_el_;
+	std::atomic<msg_list_t *> inbox_;
+	std::atomic<int>          size_;
+	Mutex *                   mutex_;
 };
 
 /** Check if message is of given type.
@@ -0,0 +1,698 @@
+/***************************************************************************
+ *  async_file.cpp - Fawkes asynchronous file logger
+ *
+ *  Created: Sat Oct 17 23:05:41 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/thread.h>
+#include <core/threading/wait_condition.h>
+#include <logging/async_file.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+/** Header of a record in a thread buffer, followed by component and message. */
+typedef struct
+{
+	struct timeval time;
+	uint32_t       component_length;
+	uint32_t       message_length;
+	uint8_t        level;
+	uint8_t        exception;
+} RecordHeader;
+
+/** Record read from a thread buffer. */
+typedef struct
+{
+	struct timeval time;
+	uint8_t        level;
+	bool           exception;
+	std::string    component;
+	std::string    message;
+} Record;
+
+static bool
+record_before(const Record &a, const Record &b)
+{
+	return timercmp(&a.time, &b.time, <);
+}
+
+class AsyncFileLogger::ThreadBuffer
+{
+public:
+	ThreadBuffer(unsigned int min_size)
+	{
+		size = 1024;
+		while (size < min_size)
+			size <<= 1;
+		data = new char[size];
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+		orphaned.store(false, std::memory_order_relaxed);
+	}
+
+	~ThreadBuffer()
+	{
+		delete[] data;
+	}
+
+	size_t
+	used() const
+	{
+		return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+	}
+
+	bool
+	push(const RecordHeader &header, const char *component, const char *message)
+	{
+		size_t h    = head.load(std::memory_order_relaxed);
+		size_t t    = tail.load(std::memory_order_acquire);
+		size_t need = sizeof(RecordHeader) + header.component_length + header.message_length;
+		if (size - (h - t) < need)
+			return false;
+
+		copy_in(h, &header, sizeof(RecordHeader));
+		copy_in(h + sizeof(RecordHeader), component, header.component_length);
+		copy_in(h + sizeof(RecordHeader) + header.component_length,
+		        message,
+		        header.message_length);
+		head.store(h + need, std::memory_order_release);
+		return true;
+	}
+
+	void
+	drain(std::vector<Record> &records)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t h = head.load(std::memory_order_acquire);
+
+		while (t != h) {
+			RecordHeader header;
+			copy_out(t, &header, sizeof(RecordHeader));
+			t += sizeof(RecordHeader);
+
+			records.push_back(Record());
+			Record &r   = records.back();
+			r.time      = header.time;
+			r.level     = header.level;
+			r.exception = header.exception;
+			r.component.resize(header.component_length);
+			copy_out(t, &r.component[0], header.component_length);
+			t += header.component_length;
+			r.message.resize(header.message_length);
+			copy_out(t, &r.message[0], header.message_length);
+			t += header.message_length;
+		}
+
+		tail.store(t, std::memory_order_release);
+	}
+
+private:
+	void
+	copy_in(size_t pos, const void *src, size_t n)
+	{
+		size_t offset = pos & (size - 1);
+		size_t first  = std::min(n, size - offset);
+		memcpy(data + offset, src, first);
+		memcpy(data, (const char *)src + first, n - first);
+	}
+
+	void
+	copy_out(size_t pos, void *dst, size_t n)
+	{
+		size_t offset = pos & (size - 1);
+		size_t first  = std::min(n, size - offset);
+		memcpy(dst, data + offset, first);
+		memcpy((char *)dst + first, data, n - first);
+	}
+
+public:
+	char *              data;
+	size_t              size;
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+	std::atomic<bool>   orphaned;
+};
+
+class AsyncFileLogger::WriterThread : public Thread
+{
+public:
+	WriterThread(AsyncFileLogger *logger)
+	: Thread("AsyncFileLogger", Thread::OPMODE_CONTINUOUS), logger_(logger)
+	{
+	}
+
+	virtual void
+	loop()
+	{
+		bool cont = logger_->writer_wait();
+		logger_->write_pending();
+		if (!cont)
+			exit();
+	}
+
+private:
+	AsyncFileLogger *logger_;
+};
+/// @endcond
+
+/** @class AsyncFileLogger <logging/async_file.h>
+ * Asynchronous logger writing to a file.
+ * Produces the same output as the FileLogger, but the file is written by a
+ * background thread. A logging thread only formats the message and appends
+ * it as a binary record to a ring buffer of its own, which requires no lock.
+ * Time stamps are converted to local time only by the writer.
+ *
+ * The writer wakes up at least every flush interval and writes the records
+ * of all buffers, ordered by time, as one batch followed by a flush. It is
+ * woken up immediately by messages of the flush level or above, or if a
+ * buffer is more than half full.
+ *
+ * If a buffer is full, the message is either dropped or the logging thread
+ * waits until the writer has made room, depending on the overflow policy.
+ * The number of dropped messages is written to the log file and can be
+ * retrieved along with the number of written messages and the number of
+ * times a logging thread had to wait.
+ *
+ * Messages which do not fit into a buffer are truncated.
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * @param filename file name pattern, see FileLogger::FileLogger()
+ * @param min_level minimum log level
+ * @param buffer_size minimum size in bytes of the buffer of each logging
+ * thread, rounded up to a power of two
+ * @param flush_interval_msec maximum time in milliseconds until a message
+ * is written to the file
+ * @param flush_level messages of this log level or above are written to
+ * the file immediately
+ * @param overflow_policy behavior if the buffer of a thread is full
+ */
+AsyncFileLogger::AsyncFileLogger(const char *   filename,
+                                 LogLevel       min_level,
+                                 unsigned int   buffer_size,
+                                 unsigned int   flush_interval_msec,
+                                 LogLevel       flush_level,
+                                 OverflowPolicy overflow_policy)
+: FileLogger(filename, min_level)
+{
+	buffer_size_         = buffer_size;
+	flush_interval_msec_ = (flush_interval_msec > 0) ? flush_interval_msec : 1;
+	flush_level_         = flush_level;
+	overflow_policy_     = overflow_policy;
+
+	// written in batches by the writer, no need for line buffering
+	setvbuf(log_file, NULL, _IOFBF, 65536);
+
+	int err = pthread_key_create(&buffer_key_, AsyncFileLogger::thread_exited);
+	if (err != 0) {
+		throw Exception(err, "Failed to create thread buffer key");
+	}
+
+	buffers_mutex_  = new Mutex();
+	writer_mutex_   = new Mutex();
+	work_waitcond_  = new WaitCondition(writer_mutex_);
+	space_waitcond_ = new WaitCondition(writer_mutex_);
+
+	wakeup_pending_.store(false);
+	quit_.store(false);
+	written_.store(0);
+	dropped_.store(0);
+	blocked_.store(0);
+	dropped_reported_ = 0;
+
+	writer_ = new WriterThread(this);
+	writer_->start();
+}
+
+/** Destructor.
+ * Writes all pending messages.
+ */
+AsyncFileLogger::~AsyncFileLogger()
+{
+	writer_mutex_->lock();
+	quit_.store(true);
+	work_waitcond_->wake_all();
+	space_waitcond_->wake_all();
+	writer_mutex_->unlock();
+
+	writer_->join();
+	delete writer_;
+
+	write_pending();
+
+	pthread_key_delete(buffer_key_);
+	for (std::list<ThreadBuffer *>::iterator i = buffers_.begin(); i != buffers_.end(); ++i) {
+		delete *i;
+	}
+
+	delete work_waitcond_;
+	delete space_waitcond_;
+	delete writer_mutex_;
+	delete buffers_mutex_;
+}
+
+/** Write all pending messages.
+ * Writes the messages of all threads to the file and flushes it.
+ */
+void
+AsyncFileLogger::flush()
+{
+	write_pending();
+}
+
+/** Get number of written messages.
+ * @return number of messages written to the file
+ */
+uint64_t
+AsyncFileLogger::num_written() const
+{
+	return written_.load(std::memory_order_relaxed);
+}
+
+/** Get number of dropped messages.
+ * @return number of messages dropped because the buffer of the logging
+ * thread was full
+ */
+uint64_t
+AsyncFileLogger::num_dropped() const
+{
+	return dropped_.load(std::memory_order_relaxed);
+}
+
+/** Get number of blocked messages.
+ * @return number of messages for which the logging thread had to wait for
+ * the writer because its buffer was full
+ */
+uint64_t
+AsyncFileLogger::num_blocked() const
+{
+	return blocked_.load(std::memory_order_relaxed);
+}
+
+void
+AsyncFileLogger::vlog_debug(const char *component, const char *format, va_list va)
+{
+	if (log_level <= LL_DEBUG) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		vappend(LL_DEBUG, &now, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::vlog_info(const char *component, const char *format, va_list va)
+{
+	if (log_level <= LL_INFO) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		vappend(LL_INFO, &now, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::vlog_warn(const char *component, const char *format, va_list va)
+{
+	if (log_level <= LL_WARN) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		vappend(LL_WARN, &now, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::vlog_error(const char *component, const char *format, va_list va)
+{
+	if (log_level <= LL_ERROR) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		vappend(LL_ERROR, &now, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::log_debug(const char *component, Exception &e)
+{
+	if (log_level <= LL_DEBUG) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		append_exception(LL_DEBUG, &now, component, e);
+	}
+}
+
+void
+AsyncFileLogger::log_info(const char *component, Exception &e)
+{
+	if (log_level <= LL_INFO) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		append_exception(LL_INFO, &now, component, e);
+	}
+}
+
+void
+AsyncFileLogger::log_warn(const char *component, Exception &e)
+{
+	if (log_level <= LL_WARN) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		append_exception(LL_WARN, &now, component, e);
+	}
+}
+
+void
+AsyncFileLogger::log_error(const char *component, Exception &e)
+{
+	if (log_level <= LL_ERROR) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		append_exception(LL_ERROR, &now, component, e);
+	}
+}
+
+void
+AsyncFileLogger::tlog_debug(struct timeval *t, const char *component, Exception &e)
+{
+	if (log_level <= LL_DEBUG) {
+		append_exception(LL_DEBUG, t, component, e);
+	}
+}
+
+void
+AsyncFileLogger::tlog_info(struct timeval *t, const char *component, Exception &e)
+{
+	if (log_level <= LL_INFO) {
+		append_exception(LL_INFO, t, component, e);
+	}
+}
+
+void
+AsyncFileLogger::tlog_warn(struct timeval *t, const char *component, Exception &e)
+{
+	if (log_level <= LL_WARN) {
+		append_exception(LL_WARN, t, component, e);
+	}
+}
+
+void
+AsyncFileLogger::tlog_error(struct timeval *t, const char *component, Exception &e)
+{
+	if (log_level <= LL_ERROR) {
+		append_exception(LL_ERROR, t, component, e);
+	}
+}
+
+void
+AsyncFileLogger::vtlog_debug(struct timeval *t,
+                             const char *    component,
+                             const char *    format,
+                             va_list         va)
+{
+	if (log_level <= LL_DEBUG) {
+		vappend(LL_DEBUG, t, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::vtlog_info(struct timeval *t,
+                            const char *    component,
+                            const char *    format,
+                            va_list         va)
+{
+	if (log_level <= LL_INFO) {
+		vappend(LL_INFO, t, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::vtlog_warn(struct timeval *t,
+                            const char *    component,
+                            const char *    format,
+                            va_list         va)
+{
+	if (log_level <= LL_WARN) {
+		vappend(LL_WARN, t, component, format, va);
+	}
+}
+
+void
+AsyncFileLogger::vtlog_error(struct timeval *t,
+                             const char *    component,
+                             const char *    format,
+                             va_list         va)
+{
+	if (log_level <= LL_ERROR) {
+		vappend(LL_ERROR, t, component, format, va);
+	}
+}
+
+/** Get buffer of calling thread.
+ * Creates and registers the buffer on first use.
+ * @return buffer of calling thread
+ */
+AsyncFileLogger::ThreadBuffer *
+AsyncFileLogger::thread_buffer()
+{
+	ThreadBuffer *b = (ThreadBuffer *)pthread_getspecific(buffer_key_);
+	if (!b) {
+		b = new ThreadBuffer(buffer_size_);
+		pthread_setspecific(buffer_key_, b);
+		MutexLocker lock(buffers_mutex_);
+		buffers_.push_back(b);
+	}
+	return b;
+}
+
+/** Called on exit of a thread which has a buffer.
+ * The buffer is deleted by the writer once it has been written.
+ * @param buffer buffer of the exiting thread
+ */
+void
+AsyncFileLogger::thread_exited(void *buffer)
+{
+	((ThreadBuffer *)buffer)->orphaned.store(true, std::memory_order_release);
+}
+
+/** Format and append a message.
+ * @param level log level
+ * @param t time of message
+ * @param component component
+ * @param format format string
+ * @param va format arguments
+ */
+void
+AsyncFileLogger::vappend(LogLevel              level,
+                         const struct timeval *t,
+                         const char *          component,
+                         const char *          format,
+                         va_list               va)
+{
+	char    buf[1024];
+	va_list vc;
+	va_copy(vc, va);
+	int n = vsnprintf(buf, sizeof(buf), format, vc);
+	va_end(vc);
+	if (n < 0)
+		return;
+
+	if ((size_t)n < sizeof(buf)) {
+		append(level, t, component, false, buf, n);
+	} else {
+		char *msg = (char *)malloc(n + 1);
+		vsnprintf(msg, n + 1, format, va);
+		append(level, t, component, false, msg, n);
+		free(msg);
+	}
+}
+
+/** Append one record per message of an exception.
+ * @param level log level
+ * @param t time of message
+ * @param component component
+ * @param e exception to log
+ */
+void
+AsyncFileLogger::append_exception(LogLevel              level,
+                                  const struct timeval *t,
+                                  const char *          component,
+                                  Exception &           e)
+{
+	for (Exception::iterator i = e.begin(); i != e.end(); ++i) {
+		append(level, t, component, true, *i, strlen(*i));
+	}
+}
+
+/** Append a record to the buffer of the calling thread.
+ * @param level log level
+ * @param t time of message
+ * @param component component
+ * @param exception true if the message is part of an exception
+ * @param message message, need not be null-terminated
+ * @param message_length length of message
+ */
+void
+AsyncFileLogger::append(LogLevel              level,
+                        const struct timeval *t,
+                        const char *          component,
+                        bool                  exception,
+                        const char *          message,
+                        size_t                message_length)
+{
+	ThreadBuffer *b = thread_buffer();
+
+	if (!component)
+		component = "";
+	size_t component_length = std::min(strlen(component), (size_t)255);
+	size_t max_length       = b->size - sizeof(RecordHeader) - component_length;
+
+	RecordHeader header;
+	header.time             = *t;
+	header.component_length = component_length;
+	header.message_length   = std::min(message_length, max_length);
+	header.level            = level;
+	header.exception        = exception ? 1 : 0;
+
+	bool counted_blocked = false;
+	while (!b->push(header, component, message)) {
+		if (overflow_policy_ == OVERFLOW_DROP || quit_.load(std::memory_order_relaxed)) {
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			wake_writer();
+			return;
+		}
+		if (!counted_blocked) {
+			blocked_.fetch_add(1, std::memory_order_relaxed);
+			counted_blocked = true;
+		}
+		wake_writer();
+		MutexLocker lock(writer_mutex_);
+		space_waitcond_->reltimed_wait(0, 10000000);
+	}
+
+	if (level >= flush_level_ || b->used() > b->size / 2) {
+		wake_writer();
+	}
+}
+
+/** Wake up the writer.
+ * Only takes the writer's mutex if it has not been woken up already.
+ */
+void
+AsyncFileLogger::wake_writer()
+{
+	if (!wakeup_pending_.exchange(true)) {
+		MutexLocker lock(writer_mutex_);
+		work_waitcond_->wake_all();
+	}
+}
+
+/** Wait for work.
+ * Returns once the writer has been woken up or the flush interval expired.
+ * @return true to continue, false if the logger is being destroyed
+ */
+bool
+AsyncFileLogger::writer_wait()
+{
+	MutexLocker lock(writer_mutex_);
+	if (!quit_.load() && !wakeup_pending_.load()) {
+		work_waitcond_->reltimed_wait(flush_interval_msec_ / 1000,
+		                              (flush_interval_msec_ % 1000) * 1000000);
+	}
+	wakeup_pending_.store(false);
+	return !quit_.load();
+}
+
+/** Write records of all buffers to the file. */
+void
+AsyncFileLogger::write_pending()
+{
+	std::vector<Record> records;
+
+	MutexLocker lock(buffers_mutex_);
+	for (std::list<ThreadBuffer *>::iterator i = buffers_.begin(); i != buffers_.end();) {
+		// check before draining, all records of an exited thread are visible then
+		bool orphaned = (*i)->orphaned.load(std::memory_order_acquire);
+		(*i)->drain(records);
+		if (orphaned) {
+			delete *i;
+			i = buffers_.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	std::stable_sort(records.begin(), records.end(), record_before);
+
+	for (std::vector<Record>::iterator r = records.begin(); r != records.end(); ++r) {
+		const char *level_char;
+		switch (r->level) {
+		case LL_DEBUG: level_char = "D"; break;
+		case LL_INFO: level_char = "I"; break;
+		case LL_WARN: level_char = "W"; break;
+		default: level_char = "E"; break;
+		}
+		localtime_r(&r->time.tv_sec, now_s);
+		fprintf(log_file,
+		        "%s %02d:%02d:%02d.%06ld %s%s: ",
+		        level_char,
+		        now_s->tm_hour,
+		        now_s->tm_min,
+		        now_s->tm_sec,
+		        (long)r->time.tv_usec,
+		        r->component.c_str(),
+		        r->exception ? " [EXCEPTION]" : "");
+		fwrite(r->message.data(), 1, r->message.size(), log_file);
+		fputc('\n', log_file);
+	}
+
+	uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+	if (dropped != dropped_reported_) {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		localtime_r(&now.tv_sec, now_s);
+		fprintf(log_file,
+		        "W %02d:%02d:%02d.%06ld AsyncFileLogger: dropped %llu messages, buffer full\n",
+		        now_s->tm_hour,
+		        now_s->tm_min,
+		        now_s->tm_sec,
+		        (long)now.tv_usec,
+		        (unsigned long long)(dropped - dropped_reported_));
+		dropped_reported_ = dropped;
+	}
+
+	fflush(log_file);
+	written_.fetch_add(records.size(), std::memory_order_relaxed);
+
+	if (overflow_policy_ == OVERFLOW_BLOCK && !records.empty()) {
+		MutexLocker wlock(writer_mutex_);
+		space_waitcond_->wake_all();
+	}
+}
+
+} // end namespace fawkes
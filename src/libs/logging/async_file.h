@@ -0,0 +1,146 @@
+/***************************************************************************
+ *  async_file.h - Fawkes asynchronous file logger
+ *
+ *  Created: Sat Oct 17 23:05:41 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _UTILS_LOGGING_ASYNC_FILE_H_
+#define _UTILS_LOGGING_ASYNC_FILE_H_
+
+#include <logging/file.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <pthread.h>
+#include <sys/time.h>
+
+namespace fawkes {
+
+class WaitCondition;
+
+class AsyncFileLogger : public FileLogger
+{
+public:
+	/** Behavior if the buffer of a thread is full. */
+	typedef enum {
+		OVERFLOW_DROP, ///< drop the message and count it
+		OVERFLOW_BLOCK ///< wait for the writer to make room
+	} OverflowPolicy;
+
+	AsyncFileLogger(const char *   filename,
+	                LogLevel       min_level           = LL_DEBUG,
+	                unsigned int   buffer_size         = 65536,
+	                unsigned int   flush_interval_msec = 100,
+	                LogLevel       flush_level         = LL_ERROR,
+	                OverflowPolicy overflow_policy     = OVERFLOW_DROP);
+	virtual ~AsyncFileLogger();
+
+	using FileLogger::log_debug;
+	using FileLogger::log_error;
+	using FileLogger::log_info;
+	using FileLogger::log_warn;
+	using FileLogger::tlog_debug;
+	using FileLogger::tlog_error;
+	using FileLogger::tlog_info;
+	using FileLogger::tlog_warn;
+
+	virtual void vlog_debug(const char *component, const char *format, va_list va);
+	virtual void vlog_info(const char *component, const char *format, va_list va);
+	virtual void vlog_warn(const char *component, const char *format, va_list va);
+	virtual void vlog_error(const char *component, const char *format, va_list va);
+
+	virtual void log_debug(const char *component, Exception &e);
+	virtual void log_info(const char *component, Exception &e);
+	virtual void log_warn(const char *component, Exception &e);
+	virtual void log_error(const char *component, Exception &e);
+
+	virtual void tlog_debug(struct timeval *t, const char *component, Exception &e);
+	virtual void tlog_info(struct timeval *t, const char *component, Exception &e);
+	virtual void tlog_warn(struct timeval *t, const char *component, Exception &e);
+	virtual void tlog_error(struct timeval *t, const char *component, Exception &e);
+
+	virtual void
+	vtlog_debug(struct timeval *t, const char *component, const char *format, va_list va);
+	virtual void vtlog_info(struct timeval *t, const char *component, const char *format, va_list va);
+	virtual void vtlog_warn(struct timeval *t, const char *component, const char *format, va_list va);
+	virtual void
+	vtlog_error(struct timeval *t, const char *component, const char *format, va_list va);
+
+	void flush();
+
+	uint64_t num_written() const;
+	uint64_t num_dropped() const;
+	uint64_t num_blocked() const;
+
+private:
+	/// @cond INTERNALS
+	class WriterThread;
+	class ThreadBuffer;
+	/// @endcond
+
+	ThreadBuffer *thread_buffer();
+	static void   thread_exited(void *buffer);
+
+	void vappend(LogLevel              level,
+	             const struct timeval *t,
+	             const char *          component,
+	             const char *          format,
+	             va_list               va);
+	void append(LogLevel              level,
+	            const struct timeval *t,
+	            const char *          component,
+	            bool                  exception,
+	            const char *          message,
+	            size_t                message_length);
+	void append_exception(LogLevel              level,
+	                      const struct timeval *t,
+	                      const char *          component,
+	                      Exception &           e);
+
+	void wake_writer();
+	void write_pending();
+	bool writer_wait();
+
+private:
+	unsigned int   buffer_size_;
+	unsigned int   flush_interval_msec_;
+	LogLevel       flush_level_;
+	OverflowPolicy overflow_policy_;
+
+	pthread_key_t            buffer_key_;
+	std::list<ThreadBuffer *> buffers_;
+
+	Mutex *        buffers_mutex_;
+	Mutex *        writer_mutex_;
+	WaitCondition *work_waitcond_;
+	WaitCondition *space_waitcond_;
+	WriterThread * writer_;
+
+	std::atomic<bool>     wakeup_pending_;
+	std::atomic<bool>     quit_;
+	std::atomic<uint64_t> written_;
+	std::atomic<uint64_t> dropped_;
+	std::atomic<uint64_t> blocked_;
+	uint64_t              dropped_reported_;
+};
+
+} // end namespace fawkes
+
+#endif
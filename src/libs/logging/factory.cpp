@@ -21,6 +21,7 @@
  *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
  */
 
+#include <logging/async_file.h>
 #include <logging/console.h>
 #include <logging/factory.h>
 #include <logging/file.h>
@@ -79,12 +80,84 @@ LoggerFactory::string_to_loglevel(const char *log_level)
 	}
 }
 
+/** Create asynchronous file logger.
+ * @param as logger argument string, the file name optionally followed by
+ * options, see instance()
+ * @return asynchronous file logger
+ * @exception Exception thrown if an option is invalid
+ */
+Logger *
+LoggerFactory::asyncfile_instance(const char *as)
+{
+	std::string            args     = as;
+	std::string::size_type opts_pos = args.find('?');
+	std::string            filename = args.substr(0, opts_pos);
+
+	unsigned int                    buffer_size         = 65536;
+	unsigned int                    flush_interval_msec = 100;
+	Logger::LogLevel                flush_level         = Logger::LL_ERROR;
+	AsyncFileLogger::OverflowPolicy overflow_policy     = AsyncFileLogger::OVERFLOW_DROP;
+
+	while (opts_pos != std::string::npos) {
+		std::string::size_type next   = args.find('&', opts_pos + 1);
+		std::string            option = args.substr(opts_pos + 1, next - opts_pos - 1);
+		opts_pos                      = next;
+
+		std::string::size_type eq_pos = option.find('=');
+		if (eq_pos == std::string::npos) {
+			throw Exception("Invalid asyncfile option '%s', expected name=value", option.c_str());
+		}
+		std::string name  = option.substr(0, eq_pos);
+		std::string value = option.substr(eq_pos + 1);
+
+		if (name == "buffer_size" || name == "flush_interval") {
+			char *        endptr;
+			unsigned long v = strtoul(value.c_str(), &endptr, 10);
+			if (value.empty() || *endptr != 0 || value[0] == '-') {
+				throw Exception("Invalid value '%s' for asyncfile option %s",
+				                value.c_str(),
+				                name.c_str());
+			}
+			if (name == "buffer_size") {
+				buffer_size = v;
+			} else {
+				flush_interval_msec = v;
+			}
+		} else if (name == "flush_level") {
+			flush_level = string_to_loglevel(value.c_str());
+		} else if (name == "overflow") {
+			if (value == "drop") {
+				overflow_policy = AsyncFileLogger::OVERFLOW_DROP;
+			} else if (value == "block") {
+				overflow_policy = AsyncFileLogger::OVERFLOW_BLOCK;
+			} else {
+				throw Exception("Invalid value '%s' for asyncfile option overflow", value.c_str());
+			}
+		} else {
+			throw Exception("Unknown asyncfile option '%s'", name.c_str());
+		}
+	}
+
+	return new AsyncFileLogger(filename.empty() ? "unnamed.log" : filename.c_str(),
+	                           Logger::LL_DEBUG,
+	                           buffer_size,
+	                           flush_interval_msec,
+	                           flush_level,
+	                           overflow_policy);
+}
+
 /** Get logger instance.
  * Get an instance of a logger of the given type. The argument string is used for
  * logger arguments.
  * Supported logger types:
  * - console, ConsoleLogger
  * - file, FileLogger
+ * - asyncfile, AsyncFileLogger, the file name may be followed by options
+ *   of the form ?name=value&name2=value2. Supported options are
+ *   buffer_size (bytes per logging thread), flush_interval (msec),
+ *   flush_level (debug, info, warn, or error) and overflow (drop or block),
+ *   e.g. asyncfile:debug.log?flush_interval=500&overflow=block.
+ *   Omitted options have the default values of AsyncFileLogger.
  * - syslog, SyslogLogger
  * NOT supported:
  * - NetworkLogger, needs a FawkesNetworkHub which cannot be passed by parameter
@@ -115,6 +188,8 @@ LoggerFactory::instance(const char *type, const char *as)
 		}
 		l = new FileLogger(file_name);
 		free(tmp);
+	} else if (strcmp(type, "asyncfile") == 0) {
+		l = asyncfile_instance(as);
 	} else if (strcmp(type, "syslog") == 0) {
 		l = new SyslogLogger(as);
 	}
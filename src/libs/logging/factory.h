@@ -61,6 +61,7 @@ public:
 
 private:
 	static Logger::LogLevel string_to_loglevel(const char *log_level);
+	static Logger *         asyncfile_instance(const char *as);
 };
 
 template <class L>
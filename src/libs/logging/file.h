@@ -72,7 +72,7 @@ public:
 	virtual void
 	vtlog_error(struct timeval *t, const char *component, const char *format, va_list va);
 
-private:
+protected:
 	struct ::tm *now_s;
 
 	FILE * log_file;
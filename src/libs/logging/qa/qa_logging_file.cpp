@@ -0,0 +1,217 @@
+/***************************************************************************
+ *  qa_logging_file.cpp - FileLogger and AsyncFileLogger latency QA
+ *
+ *  Created: Sat Oct 17 23:40:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <core/threading/thread.h>
+#include <logging/async_file.h>
+#include <logging/factory.h>
+#include <logging/file.h>
+#include <logging/multi.h>
+#include <utils/qa/qa_check.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace fawkes;
+
+/* Measures the time a log call takes in the calling thread for the
+ * FileLogger and the AsyncFileLogger with N threads logging concurrently.
+ * With the blocking overflow policy all messages must end up in the file,
+ * which is verified by counting the lines written. This is also verified
+ * for an AsyncFileLogger created by the LoggerFactory with options.
+ */
+
+class LogThread : public Thread
+{
+public:
+	LogThread(Logger *logger, unsigned int num, unsigned int num_messages)
+	: Thread("LogThread", Thread::OPMODE_CONTINUOUS),
+	  logger_(logger),
+	  num_(num),
+	  num_messages_(num_messages)
+	{
+		set_name("LogThread-%u", num);
+		total_nsec = max_nsec = 0;
+	}
+
+	virtual void
+	loop()
+	{
+		for (unsigned int i = 0; i < num_messages_; ++i) {
+			long int start = qa::now_nsec();
+			logger_->log_debug(name(), "Message %u of thread %u, value %f", i, num_, i * 0.5);
+			long int d = qa::now_nsec() - start;
+			total_nsec += d;
+			if (d > max_nsec)
+				max_nsec = d;
+		}
+		exit();
+	}
+
+	long int total_nsec;
+	long int max_nsec;
+
+private:
+	Logger *     logger_;
+	unsigned int num_;
+	unsigned int num_messages_;
+};
+
+static unsigned long int
+count_lines(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if (!f)
+		return 0;
+	unsigned long int lines = 0;
+	int               c;
+	while ((c = fgetc(f)) != EOF) {
+		if (c == '\n')
+			++lines;
+	}
+	fclose(f);
+	return lines;
+}
+
+static void
+run(const char *       what,
+    Logger *           logger,
+    unsigned int       num_threads,
+    unsigned int       num_messages,
+    unsigned long int &num_logged)
+{
+	vector<LogThread *> threads;
+	for (unsigned int i = 0; i < num_threads; ++i) {
+		threads.push_back(new LogThread(logger, i, num_messages));
+	}
+	for (auto t : threads)
+		t->start();
+
+	long int total_nsec = 0, max_nsec = 0;
+	for (auto t : threads) {
+		t->join();
+		total_nsec += t->total_nsec;
+		if (t->max_nsec > max_nsec)
+			max_nsec = t->max_nsec;
+		delete t;
+	}
+	num_logged += (unsigned long int)num_threads * num_messages;
+
+	printf("%-12s threads: %2u  messages: %8u  avg: %8.3f usec  max: %9.3f usec\n",
+	       what,
+	       num_threads,
+	       num_threads * num_messages,
+	       total_nsec / 1000. / ((double)num_threads * num_messages),
+	       max_nsec / 1000.);
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int max_threads  = (argc > 1) ? atoi(argv[1]) : 8;
+	unsigned int num_messages = (argc > 2) ? atoi(argv[2]) : 50000;
+
+	char sync_file[]  = "/tmp/qa_logging_file_sync_XXXXXX";
+	char async_file[] = "/tmp/qa_logging_file_async_XXXXXX";
+	char drop_file[]  = "/tmp/qa_logging_file_drop_XXXXXX";
+	close(mkstemp(sync_file));
+	close(mkstemp(async_file));
+	close(mkstemp(drop_file));
+
+	bool ok = true;
+	for (unsigned int n = 1; n <= max_threads; n *= 2) {
+		unsigned long int num_logged = 0;
+		{
+			FileLogger logger(sync_file);
+			run("sync", &logger, n, num_messages, num_logged);
+		}
+		num_logged = 0;
+		{
+			AsyncFileLogger logger(async_file,
+			                       Logger::LL_DEBUG,
+			                       65536,
+			                       100,
+			                       Logger::LL_ERROR,
+			                       AsyncFileLogger::OVERFLOW_BLOCK);
+			run("async/block", &logger, n, num_messages, num_logged);
+			logger.flush();
+			printf("             written: %8lu  blocked: %8lu\n",
+			       (unsigned long int)logger.num_written(),
+			       (unsigned long int)logger.num_blocked());
+		}
+		unsigned long int lines = count_lines(async_file);
+		ok &= qa::check(lines == num_logged,
+		                "%lu messages logged, but %lu lines written",
+		                num_logged,
+		                lines);
+		truncate(async_file, 0);
+
+		num_logged = 0;
+		{
+			AsyncFileLogger logger(drop_file);
+			run("async/drop", &logger, n, num_messages, num_logged);
+			logger.flush();
+			printf("             written: %8lu  dropped: %8lu\n",
+			       (unsigned long int)logger.num_written(),
+			       (unsigned long int)logger.num_dropped());
+		}
+		truncate(sync_file, 0);
+		truncate(drop_file, 0);
+	}
+
+	// options given in the logger argument string
+	std::string spec = std::string("asyncfile/info:") + async_file
+	                   + "?buffer_size=1024&flush_interval=20&flush_level=warn";
+	MultiLogger *multi = LoggerFactory::multilogger_instance(spec.c_str());
+	multi->log_info("qa", "Info message");
+	multi->log_debug("qa", "Debug message not written");
+	delete multi;
+	unsigned long int lines = count_lines(async_file);
+	ok &= qa::check(lines == 1, "level not applied, %lu lines written", lines);
+	unsigned long int num_logged = 1;
+	std::string       args       = std::string(async_file) + "?buffer_size=1024&overflow=block";
+	Logger *          logger     = LoggerFactory::instance("asyncfile", args.c_str());
+	run("factory", logger, max_threads, num_messages, num_logged);
+	delete logger;
+	lines = count_lines(async_file);
+	ok &= qa::check(lines == num_logged,
+	                "%lu messages logged, but %lu lines written",
+	                num_logged,
+	                lines);
+	try {
+		delete LoggerFactory::instance("asyncfile", (std::string(async_file) + "?overflow=x").c_str());
+		ok = qa::check(false, "invalid option accepted");
+	} catch (Exception &e) {
+	}
+
+	unlink(sync_file);
+	unlink(async_file);
+	unlink(drop_file);
+
+	return qa::result(ok);
+}
+
+/// @endcond
@@ -218,7 +218,7 @@ public:
 		std::list<unsigned int> wakeup_list;
 
 		try {
-			FawkesNetworkTransceiver::recv(s_, inbound_msgq_);
+			transceiver_.receive(s_, inbound_msgq_);
 
 			MutexLocker lock(recv_mutex_);
 
@@ -291,6 +291,7 @@ private:
 	FawkesNetworkClient *      parent_;
 	FawkesNetworkMessageQueue *inbound_msgq_;
 	Mutex *                    recv_mutex_;
+	FawkesNetworkTransceiver   transceiver_;
 };
 
 /** @class FawkesNetworkClient netcomm/fawkes/client.h
@@ -0,0 +1,65 @@
+
+/***************************************************************************
+ *  server_client.cpp - Fawkes network server client
+ *
+ *  Created: Sat Oct 17 23:48:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <netcomm/fawkes/server_client.h>
+
+namespace fawkes {
+
+/** @class FawkesNetworkServerClient <netcomm/fawkes/server_client.h>
+ * Fawkes network server client.
+ * Interface of a client connection as seen by the FawkesNetworkServerThread.
+ * The connection is either served by a thread of its own or by the
+ * epoll-based event loop shared by all connections.
+ *
+ * @ingroup NetComm
+ * @author Tim Niemueller
+ *
+ * @fn unsigned int FawkesNetworkServerClient::clid() const = 0
+ * Get client ID.
+ * @return client ID
+ *
+ * @fn void FawkesNetworkServerClient::set_clid(unsigned int client_id) = 0
+ * Set client ID.
+ * @param client_id new client ID
+ *
+ * @fn bool FawkesNetworkServerClient::alive() const = 0
+ * Check aliveness of connection.
+ * @return true if connection is still alive, false otherwise.
+ *
+ * @fn void FawkesNetworkServerClient::enqueue(FawkesNetworkMessage *msg) = 0
+ * Enqueue message to outbound queue.
+ * The client takes over the reference of the message.
+ * @param msg message to enqueue
+ *
+ * @fn void FawkesNetworkServerClient::force_send() = 0
+ * Force sending of all pending outbound messages.
+ * This is a blocking operation. The current queue will be sent out
+ * immediately.
+ */
+
+/** Virtual empty destructor. */
+FawkesNetworkServerClient::~FawkesNetworkServerClient()
+{
+}
+
+} // end namespace fawkes
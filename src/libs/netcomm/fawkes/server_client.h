@@ -0,0 +1,45 @@
+
+/***************************************************************************
+ *  server_client.h - Fawkes network server client
+ *
+ *  Created: Sat Oct 17 23:48:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _NETCOMM_FAWKES_SERVER_CLIENT_H_
+#define _NETCOMM_FAWKES_SERVER_CLIENT_H_
+
+namespace fawkes {
+
+class FawkesNetworkMessage;
+
+class FawkesNetworkServerClient
+{
+public:
+	virtual ~FawkesNetworkServerClient();
+
+	virtual unsigned int clid() const                       = 0;
+	virtual void         set_clid(unsigned int client_id)   = 0;
+	virtual bool         alive() const                      = 0;
+	virtual void         enqueue(FawkesNetworkMessage *msg) = 0;
+	virtual void         force_send()                       = 0;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -171,6 +171,7 @@ FawkesNetworkServerClientThread::FawkesNetworkServerClientThread(StreamSocket *
 	_alive         = true;
 	_clid          = 0;
 	_inbound_queue = new FawkesNetworkMessageQueue();
+	_transceiver   = new FawkesNetworkTransceiver();
 
 	_send_slave = new FawkesNetworkServerClientSendThread(_s, this);
 
@@ -185,6 +186,7 @@ FawkesNetworkServerClientThread::~FawkesNetworkServerClientThread()
 	delete _send_slave;
 	delete _s;
 	delete _inbound_queue;
+	delete _transceiver;
 }
 
 /** Get client ID.
@@ -209,25 +211,32 @@ FawkesNetworkServerClientThread::set_clid(unsigned int client_id)
 /** Receive data.
  * Receives data from the network if there is any and then dispatches all
  * inbound messages via the parent FawkesNetworkThread::dispatch()
+ * @param drain true to receive until the connection has been closed, use
+ * if the remote end has hung up to get all data it sent before
  */
 void
-FawkesNetworkServerClientThread::recv()
+FawkesNetworkServerClientThread::recv(bool drain)
 {
+	bool died = false;
 	try {
-		FawkesNetworkTransceiver::recv(_s, _inbound_queue);
-
-		_inbound_queue->lock();
-		while (!_inbound_queue->empty()) {
-			FawkesNetworkMessage *m = _inbound_queue->front();
-			m->set_client_id(_clid);
-			_parent->dispatch(m);
-			m->unref();
-			_inbound_queue->pop();
+		while (_transceiver->receive(_s, _inbound_queue) && drain) {
 		}
-		_parent->wakeup();
-		_inbound_queue->unlock();
-
 	} catch (ConnectionDiedException &e) {
+		died = true;
+	}
+
+	_inbound_queue->lock();
+	while (!_inbound_queue->empty()) {
+		FawkesNetworkMessage *m = _inbound_queue->front();
+		m->set_client_id(_clid);
+		_parent->dispatch(m);
+		m->unref();
+		_inbound_queue->pop();
+	}
+	_parent->wakeup();
+	_inbound_queue->unlock();
+
+	if (died) {
 		_alive = false;
 		_s->close();
 		_parent->wakeup();
@@ -269,11 +278,15 @@ FawkesNetworkServerClientThread::loop()
 	}
 
 	if ((p & Socket::POLL_ERR) || (p & Socket::POLL_HUP) || (p & Socket::POLL_RDHUP)) {
+		if (p & Socket::POLL_IN) {
+			// get data sent before hanging up
+			recv(true);
+		}
 		_alive = false;
 		_parent->wakeup();
 	} else if (p & Socket::POLL_IN) {
 		// Data can be read
-		recv();
+		recv(false);
 	}
 }
 
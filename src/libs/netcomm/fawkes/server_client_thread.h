@@ -25,6 +25,7 @@
 #define _NETCOMM_FAWKES_CLIENT_THREAD_H_
 
 #include <core/threading/thread.h>
+#include <netcomm/fawkes/server_client.h>
 
 #include <list>
 
@@ -37,8 +38,9 @@ class FawkesNetworkMessageQueue;
 class WaitCondition;
 class Mutex;
 class FawkesNetworkServerClientSendThread;
+class FawkesNetworkTransceiver;
 
-class FawkesNetworkServerClientThread : public Thread
+class FawkesNetworkServerClientThread : public Thread, public FawkesNetworkServerClient
 {
 public:
 	FawkesNetworkServerClientThread(StreamSocket *s, FawkesNetworkServerThread *parent);
@@ -47,14 +49,14 @@ public:
 	virtual void once();
 	virtual void loop();
 
-	unsigned int clid() const;
-	void         set_clid(unsigned int client_id);
+	virtual unsigned int clid() const;
+	virtual void         set_clid(unsigned int client_id);
 
-	bool alive() const;
-	void enqueue(FawkesNetworkMessage *msg);
+	virtual bool alive() const;
+	virtual void enqueue(FawkesNetworkMessage *msg);
 
-	void force_send();
-	void connection_died();
+	virtual void force_send();
+	void         connection_died();
 
 	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
 protected:
@@ -65,13 +67,14 @@ protected:
 	}
 
 private:
-	void recv();
+	void recv(bool drain);
 
 	unsigned int               _clid;
 	bool                       _alive;
 	StreamSocket *             _s;
 	FawkesNetworkServerThread *_parent;
 	FawkesNetworkMessageQueue *_inbound_queue;
+	FawkesNetworkTransceiver * _transceiver;
 
 	FawkesNetworkServerClientSendThread *_send_slave;
 };
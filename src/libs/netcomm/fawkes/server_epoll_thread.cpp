@@ -0,0 +1,388 @@
+
+/***************************************************************************
+ *  server_epoll_thread.cpp - Event loop serving Fawkes network clients
+ *
+ *  Created: Sat Oct 17 23:52:37 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <core/exception.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+#include <netcomm/fawkes/message.h>
+#include <netcomm/fawkes/message_queue.h>
+#include <netcomm/fawkes/server_client.h>
+#include <netcomm/fawkes/server_epoll_thread.h>
+#include <netcomm/fawkes/server_thread.h>
+#include <netcomm/fawkes/transceiver.h>
+#include <netcomm/socket/stream.h>
+#include <netcomm/utils/exceptions.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <unistd.h>
+
+namespace fawkes {
+
+/** Maximum number of events processed per epoll_wait() call. */
+#define MAX_EVENTS 64
+
+/// @cond INTERNALS
+class FawkesNetworkServerEpollThread::Client : public FawkesNetworkServerClient
+{
+public:
+	Client(StreamSocket *s, FawkesNetworkServerEpollThread *epoll_thread)
+	: s_(s), epoll_thread_(epoll_thread), clid_(0), alive_(true), send_requested_(false)
+	{
+		want_out_      = false;
+		sending_       = false;
+		inbound_       = new FawkesNetworkMessageQueue();
+		outbound_      = new FawkesNetworkMessageQueue();
+		sent_mutex_    = new Mutex();
+		sent_waitcond_ = new WaitCondition(sent_mutex_);
+	}
+
+	virtual ~Client()
+	{
+		FawkesNetworkMessageQueue *queues[2] = {inbound_, outbound_};
+		for (FawkesNetworkMessageQueue *q : queues) {
+			while (!q->empty()) {
+				q->front()->unref();
+				q->pop();
+			}
+			delete q;
+		}
+		delete sent_waitcond_;
+		delete sent_mutex_;
+		delete s_;
+	}
+
+	virtual unsigned int
+	clid() const
+	{
+		return clid_;
+	}
+
+	virtual void
+	set_clid(unsigned int client_id)
+	{
+		clid_ = client_id;
+	}
+
+	virtual bool
+	alive() const
+	{
+		return alive_;
+	}
+
+	virtual void
+	enqueue(FawkesNetworkMessage *msg)
+	{
+		outbound_->push_locked(msg);
+		if (!send_requested_.exchange(true)) {
+			epoll_thread_->request_send();
+		}
+	}
+
+	virtual void
+	force_send()
+	{
+		MutexLocker lock(sent_mutex_);
+		while (alive_ && (sending_ || send_requested_ || !outbound_->empty())) {
+			sent_waitcond_->reltimed_wait(0, 10000000);
+		}
+	}
+
+	int
+	fd() const
+	{
+		return s_->fd();
+	}
+
+	bool
+	send_requested() const
+	{
+		return send_requested_;
+	}
+
+	void
+	receive(bool drain)
+	{
+		// if the peer hung up, read all data it sent before closing
+		bool died = false;
+		try {
+			while (transceiver_.receive(s_, inbound_) && drain) {
+			}
+		} catch (ConnectionDiedException &e) {
+			died = true;
+		}
+
+		FawkesNetworkServerThread *parent = epoll_thread_->parent_;
+		inbound_->lock();
+		while (!inbound_->empty()) {
+			FawkesNetworkMessage *m = inbound_->front();
+			m->set_client_id(clid_);
+			parent->dispatch(m);
+			m->unref();
+			inbound_->pop();
+		}
+		inbound_->unlock();
+		parent->wakeup();
+
+		if (died) {
+			connection_died();
+		}
+	}
+
+	void
+	flush()
+	{
+		sent_mutex_->lock();
+		sending_        = true;
+		send_requested_ = false;
+		sent_mutex_->unlock();
+
+		bool done = false;
+		try {
+			done = transceiver_.send_some(s_, outbound_);
+		} catch (ConnectionDiedException &e) {
+			connection_died();
+			return;
+		}
+
+		// only wait for the socket to become writable while data is pending
+		if (done == want_out_) {
+			want_out_ = !done;
+			struct epoll_event ev;
+			ev.events  = EPOLLIN | EPOLLRDHUP | (want_out_ ? EPOLLOUT : 0);
+			ev.data.fd = fd();
+			epoll_ctl(epoll_thread_->epoll_fd_, EPOLL_CTL_MOD, fd(), &ev);
+		}
+
+		if (done) {
+			MutexLocker lock(sent_mutex_);
+			sending_ = false;
+			sent_waitcond_->wake_all();
+		}
+	}
+
+	void
+	connection_died()
+	{
+		// the socket is kept open until the client is removed, the
+		// descriptor must not be reused before that
+		epoll_ctl(epoll_thread_->epoll_fd_, EPOLL_CTL_DEL, fd(), NULL);
+		sent_mutex_->lock();
+		alive_ = false;
+		sent_waitcond_->wake_all();
+		sent_mutex_->unlock();
+		epoll_thread_->parent_->wakeup();
+	}
+
+private:
+	StreamSocket *                  s_;
+	FawkesNetworkServerEpollThread *epoll_thread_;
+	FawkesNetworkTransceiver        transceiver_;
+	FawkesNetworkMessageQueue *     inbound_;
+	FawkesNetworkMessageQueue *     outbound_;
+
+	unsigned int      clid_;
+	std::atomic<bool> alive_;
+	std::atomic<bool> send_requested_;
+	bool              want_out_;
+	bool              sending_;
+
+	Mutex *        sent_mutex_;
+	WaitCondition *sent_waitcond_;
+};
+/// @endcond
+
+/** @class FawkesNetworkServerEpollThread <netcomm/fawkes/server_epoll_thread.h>
+ * Event loop serving Fawkes network clients.
+ * Instead of running two threads per connected client, all client
+ * connections are served by this single thread. The sockets are switched
+ * to non-blocking mode and monitored with epoll. Incoming data is read
+ * into a per-connection receive buffer and dispatched via the server
+ * thread. Outgoing messages are queued per client and written in batches
+ * with writev() once the thread is notified through an eventfd. If a
+ * socket cannot take all data the remainder is sent once epoll signals
+ * that it is writable again, other clients are not blocked meanwhile.
+ *
+ * @ingroup NetComm
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * @param parent parent server thread, inbound messages are dispatched
+ * via this thread
+ */
+FawkesNetworkServerEpollThread::FawkesNetworkServerEpollThread(FawkesNetworkServerThread *parent)
+: Thread("FawkesNetworkServerEpollThread", Thread::OPMODE_CONTINUOUS)
+{
+	parent_ = parent;
+
+	epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd_ == -1) {
+		throw Exception(errno, "Failed to create epoll instance");
+	}
+	event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (event_fd_ == -1) {
+		::close(epoll_fd_);
+		throw Exception(errno, "Failed to create eventfd");
+	}
+
+	struct epoll_event ev;
+	ev.events  = EPOLLIN;
+	ev.data.fd = event_fd_;
+	if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev) == -1) {
+		::close(event_fd_);
+		::close(epoll_fd_);
+		throw Exception(errno, "Failed to add eventfd to epoll instance");
+	}
+
+	clients_mutex_ = new Mutex();
+}
+
+/** Destructor.
+ * All clients must have been removed before.
+ */
+FawkesNetworkServerEpollThread::~FawkesNetworkServerEpollThread()
+{
+	::close(event_fd_);
+	::close(epoll_fd_);
+	delete clients_mutex_;
+}
+
+/** Add a client connection.
+ * The socket is switched to non-blocking mode and monitored from now on.
+ * @param s socket of the client, ownership is transferred to the returned
+ * client instance
+ * @return client instance, pass it to remove_client() and delete it if the
+ * client is no longer alive
+ * @exception Exception thrown if the socket cannot be monitored
+ */
+FawkesNetworkServerClient *
+FawkesNetworkServerEpollThread::add_client(StreamSocket *s)
+{
+	s->set_nonblocking(true);
+	Client *client = new Client(s, this);
+
+	MutexLocker lock(clients_mutex_);
+	struct epoll_event ev;
+	ev.events  = EPOLLIN | EPOLLRDHUP;
+	ev.data.fd = client->fd();
+	if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client->fd(), &ev) == -1) {
+		int err = errno;
+		delete client;
+		throw Exception(err, "Failed to add client to epoll instance");
+	}
+	clients_[client->fd()] = client;
+	return client;
+}
+
+/** Remove a client connection.
+ * After this method returns the client is no longer accessed by this
+ * thread and may be deleted.
+ * @param client client to remove as returned by add_client()
+ */
+void
+FawkesNetworkServerEpollThread::remove_client(FawkesNetworkServerClient *client)
+{
+	Client *c = static_cast<Client *>(client);
+
+	MutexLocker lock(clients_mutex_);
+	std::map<int, Client *>::iterator i = clients_.find(c->fd());
+	if ((i != clients_.end()) && (i->second == c)) {
+		clients_.erase(i);
+	}
+	epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, c->fd(), NULL);
+}
+
+/** Notify the event loop that messages have been enqueued. */
+void
+FawkesNetworkServerEpollThread::request_send()
+{
+	uint64_t one = 1;
+	if (::write(event_fd_, &one, sizeof(one)) == -1) {
+		// EAGAIN if the counter is about to overflow, a wakeup is pending anyway
+	}
+}
+
+/** Event loop.
+ * Waits for events on any client socket or for a send request and
+ * processes them. The thread cannot be cancelled while processing events.
+ */
+void
+FawkesNetworkServerEpollThread::loop()
+{
+	struct epoll_event events[MAX_EVENTS];
+	int                num_events = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+	if (num_events == -1) {
+		if (errno == EINTR)
+			return;
+		throw Exception(errno, "FawkesNetworkServerEpollThread: epoll_wait() failed");
+	}
+
+	CancelState old_state;
+	set_cancel_state(CANCEL_DISABLED, &old_state);
+	clients_mutex_->lock();
+
+	bool send_requested = false;
+	for (int i = 0; i < num_events; ++i) {
+		if (events[i].data.fd == event_fd_) {
+			uint64_t count;
+			if (::read(event_fd_, &count, sizeof(count)) == sizeof(count)) {
+				send_requested = true;
+			}
+			continue;
+		}
+
+		std::map<int, Client *>::iterator c = clients_.find(events[i].data.fd);
+		if ((c == clients_.end()) || !c->second->alive())
+			continue;
+
+		Client *client = c->second;
+		if (events[i].events & EPOLLIN) {
+			client->receive(events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP));
+		}
+		if (client->alive() && (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))) {
+			client->connection_died();
+		}
+		if (client->alive() && (events[i].events & EPOLLOUT)) {
+			client->flush();
+		}
+	}
+
+	if (send_requested) {
+		for (auto &c : clients_) {
+			if (c.second->alive() && c.second->send_requested()) {
+				c.second->flush();
+			}
+		}
+	}
+
+	clients_mutex_->unlock();
+	set_cancel_state(old_state);
+}
+
+} // end namespace fawkes
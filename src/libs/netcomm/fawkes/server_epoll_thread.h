@@ -0,0 +1,77 @@
+
+/***************************************************************************
+ *  server_epoll_thread.h - Event loop serving Fawkes network clients
+ *
+ *  Created: Sat Oct 17 23:52:37 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _NETCOMM_FAWKES_SERVER_EPOLL_THREAD_H_
+#define _NETCOMM_FAWKES_SERVER_EPOLL_THREAD_H_
+
+#include <core/threading/thread.h>
+
+#include <map>
+
+namespace fawkes {
+
+class StreamSocket;
+class Mutex;
+class FawkesNetworkServerThread;
+class FawkesNetworkServerClient;
+
+class FawkesNetworkServerEpollThread : public Thread
+{
+public:
+	FawkesNetworkServerEpollThread(FawkesNetworkServerThread *parent);
+	virtual ~FawkesNetworkServerEpollThread();
+
+	virtual void loop();
+
+	FawkesNetworkServerClient *add_client(StreamSocket *s);
+	void                       remove_client(FawkesNetworkServerClient *client);
+
+	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
+protected:
+	virtual void
+	run()
+	{
+		Thread::run();
+	}
+
+private:
+	/// @cond INTERNALS
+	class Client;
+	/// @endcond
+
+	void request_send();
+
+private:
+	FawkesNetworkServerThread *parent_;
+
+	int epoll_fd_;
+	int event_fd_;
+
+	Mutex *                 clients_mutex_;
+	std::map<int, Client *> clients_;
+};
+
+} // end namespace fawkes
+
+#endif
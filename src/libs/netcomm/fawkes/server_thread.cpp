@@ -30,7 +30,9 @@
 #include <netcomm/fawkes/message_content.h>
 #include <netcomm/fawkes/message_queue.h>
 #include <netcomm/fawkes/server_client_thread.h>
+#include <netcomm/fawkes/server_epoll_thread.h>
 #include <netcomm/fawkes/server_thread.h>
+#include <netcomm/socket/stream.h>
 #include <netcomm/utils/acceptor_thread.h>
 
 #include <unistd.h>
@@ -42,6 +44,10 @@ namespace fawkes {
  * Maintains a list of clients and reacts on events triggered by the clients.
  * Also runs the acceptor thread.
  *
+ * By default each client is served by a thread of its own (plus a thread
+ * for sending). With many clients the epoll mode scales better, a single
+ * FawkesNetworkServerEpollThread then serves all client connections.
+ *
  * @ingroup NetComm
  * @author Tim Niemueller
  */
@@ -55,13 +61,16 @@ namespace fawkes {
  * :: to listen on any local address
  * @param fawkes_port port for Fawkes network protocol
  * @param thread_collector thread collector to register new threads with
+ * @param use_epoll true to serve all clients with a single epoll-based
+ * event loop thread instead of one thread per client
  */
 FawkesNetworkServerThread::FawkesNetworkServerThread(bool               enable_ipv4,
                                                      bool               enable_ipv6,
                                                      const std::string &listen_ipv4,
                                                      const std::string &listen_ipv6,
                                                      unsigned int       fawkes_port,
-                                                     ThreadCollector *  thread_collector)
+                                                     ThreadCollector *  thread_collector,
+                                                     bool               use_epoll)
 : Thread("FawkesNetworkServerThread", Thread::OPMODE_WAITFORWAKEUP)
 {
 	this->thread_collector = thread_collector;
@@ -69,6 +78,16 @@ FawkesNetworkServerThread::FawkesNetworkServerThread(bool               enable_i
 	next_client_id   = 1;
 	inbound_messages = new FawkesNetworkMessageQueue();
 
+	epoll_thread = NULL;
+	if (use_epoll) {
+		epoll_thread = new FawkesNetworkServerEpollThread(this);
+		if (thread_collector) {
+			thread_collector->add(epoll_thread);
+		} else {
+			epoll_thread->start();
+		}
+	}
+
 	if (enable_ipv4) {
 		acceptor_threads.push_back(new NetworkAcceptorThread(
 		  this, Socket::IPv4, listen_ipv4, fawkes_port, "FawkesNetworkAcceptorThread"));
@@ -93,13 +112,16 @@ FawkesNetworkServerThread::FawkesNetworkServerThread(bool               enable_i
 FawkesNetworkServerThread::~FawkesNetworkServerThread()
 {
 	for (cit = clients.begin(); cit != clients.end(); ++cit) {
+		remove_client((*cit).second);
+	}
+	if (epoll_thread) {
 		if (thread_collector) {
-			thread_collector->remove((*cit).second);
+			thread_collector->remove(epoll_thread);
 		} else {
-			(*cit).second->cancel();
-			(*cit).second->join();
+			epoll_thread->cancel();
+			epoll_thread->join();
 		}
-		delete (*cit).second;
+		delete epoll_thread;
 	}
 	for (size_t i = 0; i < acceptor_threads.size(); ++i) {
 		if (thread_collector) {
@@ -122,14 +144,27 @@ FawkesNetworkServerThread::~FawkesNetworkServerThread()
 void
 FawkesNetworkServerThread::add_connection(StreamSocket *s) throw()
 {
-	FawkesNetworkServerClientThread *client = new FawkesNetworkServerClientThread(s, this);
+	FawkesNetworkServerClient *      client        = NULL;
+	FawkesNetworkServerClientThread *client_thread = NULL;
+	if (epoll_thread) {
+		try {
+			client = epoll_thread->add_client(s);
+		} catch (Exception &e) {
+			delete s;
+			return;
+		}
+	} else {
+		client = client_thread = new FawkesNetworkServerClientThread(s, this);
+	}
 
 	clients.lock();
 	client->set_clid(next_client_id);
-	if (thread_collector) {
-		thread_collector->add(client);
-	} else {
-		client->start();
+	if (client_thread) {
+		if (thread_collector) {
+			thread_collector->add(client_thread);
+		} else {
+			client_thread->start();
+		}
 	}
 	unsigned int cid = next_client_id++;
 	clients[cid]     = client;
@@ -144,6 +179,28 @@ FawkesNetworkServerThread::add_connection(StreamSocket *s) throw()
 	wakeup();
 }
 
+/** Stop serving a client and delete it.
+ * @param client client to remove
+ */
+void
+FawkesNetworkServerThread::remove_client(FawkesNetworkServerClient *client)
+{
+	if (epoll_thread) {
+		epoll_thread->remove_client(client);
+	} else {
+		FawkesNetworkServerClientThread *client_thread =
+		  static_cast<FawkesNetworkServerClientThread *>(client);
+		if (thread_collector) {
+			thread_collector->remove(client_thread);
+		} else {
+			client_thread->cancel();
+			client_thread->join();
+		}
+		usleep(5000);
+	}
+	delete client;
+}
+
 /** Add a handler.
  * @param handler to add.
  */
@@ -201,14 +258,7 @@ FawkesNetworkServerThread::loop()
 
 		{
 			MutexLocker clients_lock(clients.mutex());
-			if (thread_collector) {
-				thread_collector->remove(clients[clid]);
-			} else {
-				clients[clid]->cancel();
-				clients[clid]->join();
-			}
-			usleep(5000);
-			delete clients[clid];
+			remove_client(clients[clid]);
 			clients.erase(clid);
 		}
 	}
@@ -36,7 +36,8 @@ namespace fawkes {
 
 class ThreadCollector;
 class Mutex;
-class FawkesNetworkServerClientThread;
+class FawkesNetworkServerClient;
+class FawkesNetworkServerEpollThread;
 class NetworkAcceptorThread;
 class FawkesNetworkHandler;
 class FawkesNetworkMessage;
@@ -53,7 +54,8 @@ public:
 	                          const std::string &listen_ipv4,
 	                          const std::string &listen_ipv6,
 	                          unsigned int       fawkes_port,
-	                          ThreadCollector *  thread_collector = 0);
+	                          ThreadCollector *  thread_collector = 0,
+	                          bool               use_epoll        = false);
 	virtual ~FawkesNetworkServerThread();
 
 	virtual void loop();
@@ -94,18 +96,22 @@ protected:
 		Thread::run();
 	}
 
+private:
+	void remove_client(FawkesNetworkServerClient *client);
+
 private:
 	ThreadCollector *                    thread_collector;
 	unsigned int                         next_client_id;
 	std::vector<NetworkAcceptorThread *> acceptor_threads;
+	FawkesNetworkServerEpollThread *     epoll_thread;
 
 	// key: component id,  value: handler
 	LockMap<unsigned int, FawkesNetworkHandler *>           handlers;
 	LockMap<unsigned int, FawkesNetworkHandler *>::iterator hit;
 
-	// key: client id,     value: client thread
-	LockMap<unsigned int, FawkesNetworkServerClientThread *>           clients;
-	LockMap<unsigned int, FawkesNetworkServerClientThread *>::iterator cit;
+	// key: client id,     value: client connection
+	LockMap<unsigned int, FawkesNetworkServerClient *>           clients;
+	LockMap<unsigned int, FawkesNetworkServerClient *>::iterator cit;
 
 	FawkesNetworkMessageQueue *inbound_messages;
 };
@@ -28,19 +28,58 @@
 #include <netcomm/utils/exceptions.h>
 #include <netinet/in.h>
 
+#include <climits>
 #include <cstdlib>
+#include <cstring>
 
 namespace fawkes {
 
+/** Maximum number of messages sent with a single writev() call. */
+#define MAX_MSGS_PER_WRITE (IOV_MAX / 2)
+
 /** @class FawkesNetworkTransceiver transceiver.h <netcomm/fawkes/transceiver.h>
  * Fawkes Network Transceiver.
  * Utility class that provides methods to send and receive messages via
  * the network. Operates on message queues and a given socket.
  *
+ * The static methods are stateless and may be used for any socket. An
+ * instance holds per-connection state: a receive buffer which is re-used
+ * for all messages of a connection, such that many small messages can be
+ * received with a single system call, and the state of a partially
+ * transmitted batch of messages for non-blocking sockets.
+ *
  * @ingroup NetComm
  * @author Tim Niemueller
  */
 
+/** Constructor.
+ * @param recv_buffer_size size of the receive buffer in bytes. Messages
+ * which do not fit into the buffer are received directly into their
+ * payload buffer.
+ */
+FawkesNetworkTransceiver::FawkesNetworkTransceiver(size_t recv_buffer_size)
+{
+	if (recv_buffer_size < sizeof(fawkes_message_header_t)) {
+		recv_buffer_size = sizeof(fawkes_message_header_t);
+	}
+	recv_buf_size_      = recv_buffer_size;
+	recv_buf_           = (char *)malloc(recv_buf_size_);
+	recv_fill_          = 0;
+	recv_large_.payload = NULL;
+	recv_large_size_    = 0;
+	recv_large_have_    = 0;
+	send_iov_idx_       = 0;
+}
+
+/** Destructor. */
+FawkesNetworkTransceiver::~FawkesNetworkTransceiver()
+{
+	release_send_batch();
+	if (recv_large_.payload)
+		free(recv_large_.payload);
+	free(recv_buf_);
+}
+
 /** Send messages.
  * @param s socket over which the data shall be transmitted.
  * @param msgq message queue that contains the messages that have to be sent
@@ -50,19 +89,38 @@ namespace fawkes {
 void
 FawkesNetworkTransceiver::send(StreamSocket *s, FawkesNetworkMessageQueue *msgq)
 {
+	std::vector<FawkesNetworkMessage *> msgs;
+	std::vector<struct iovec>          iov;
+	msgs.reserve(MAX_MSGS_PER_WRITE);
+	iov.reserve(2 * MAX_MSGS_PER_WRITE);
+
 	msgq->lock();
 	try {
 		while (!msgq->empty()) {
-			FawkesNetworkMessage *m = msgq->front();
-			m->pack();
-			const fawkes_message_t &f            = m->fmsg();
-			unsigned int            payload_size = m->payload_size();
-			s->write(&(f.header), sizeof(f.header));
-			s->write(f.payload, payload_size);
-			m->unref();
-			msgq->pop();
+			// gather a batch of messages, header and payload become one
+			// buffer each, and write them with a single system call
+			while (!msgq->empty() && (msgs.size() < MAX_MSGS_PER_WRITE)) {
+				FawkesNetworkMessage *m = msgq->front();
+				msgq->pop();
+				msgs.push_back(m);
+				m->pack();
+				const fawkes_message_t &f = m->fmsg();
+				iov.push_back({(void *)&(f.header), sizeof(f.header)});
+				if (m->payload_size() > 0) {
+					iov.push_back({f.payload, m->payload_size()});
+				}
+			}
+			s->writev(&iov[0], iov.size());
+			for (FawkesNetworkMessage *m : msgs) {
+				m->unref();
+			}
+			msgs.clear();
+			iov.clear();
 		}
 	} catch (SocketException &e) {
+		for (FawkesNetworkMessage *m : msgs) {
+			m->unref();
+		}
 		msgq->unlock();
 		throw ConnectionDiedException("Write failed");
 	}
@@ -70,6 +128,9 @@ FawkesNetworkTransceiver::send(StreamSocket *s, FawkesNetworkMessageQueue *msgq)
 }
 
 /** Receive data.
+ * This method is stateless and therefore reads each message with one system
+ * call for the header and one for the payload. For a long-lived connection
+ * prefer an instance and receive().
  * This method receives all messages currently available from the network, or
  * a limited number depending on max_num_msgs. If max_num_msgs is 0 then all
  * messages are read. Note that on a busy connection this may cause recv() to
@@ -113,4 +174,194 @@ FawkesNetworkTransceiver::recv(StreamSocket *             s,
 	msgq->unlock();
 }
 
+/** Receive data using the receive buffer.
+ * Reads as much data as currently available, up to the free space of the
+ * receive buffer, with a single system call. All complete messages in the
+ * buffer are then appended to the message queue, an incomplete message at
+ * the end of the buffer is kept for the next call. A message which is
+ * larger than the receive buffer is read directly into its payload buffer,
+ * the data following it is read into the receive buffer in the same call.
+ *
+ * Call this only if data is available, e.g. after poll() signaled that the
+ * socket is readable, otherwise the call blocks on a blocking socket. On a
+ * non-blocking socket the method returns immediately if there is no data.
+ * @param s socket to gather messages from
+ * @param msgq message queue to store received messages in
+ * @return true if data has been read, false if no data was available
+ * @exception ConnectionDiedException Thrown if any error occurs during the
+ * operation or if the connection has been closed by the remote end.
+ */
+bool
+FawkesNetworkTransceiver::receive(StreamSocket *s, FawkesNetworkMessageQueue *msgq)
+{
+	struct iovec iov[2];
+	int          iovcnt = 1;
+	if (recv_large_.payload) {
+		// the receive buffer is always empty while a large message is pending
+		iov[0].iov_base = (char *)recv_large_.payload + recv_large_have_;
+		iov[0].iov_len  = recv_large_size_ - recv_large_have_;
+		iov[1].iov_base = recv_buf_;
+		iov[1].iov_len  = recv_buf_size_;
+		iovcnt          = 2;
+	} else {
+		iov[0].iov_base = recv_buf_ + recv_fill_;
+		iov[0].iov_len  = recv_buf_size_ - recv_fill_;
+	}
+
+	size_t bytes_read = 0;
+	try {
+		bytes_read = s->readv(iov, iovcnt);
+	} catch (SocketException &e) {
+		throw ConnectionDiedException("Read failed");
+	}
+	if (bytes_read == 0)
+		return false;
+
+	msgq->lock();
+	if (recv_large_.payload) {
+		size_t missing = recv_large_size_ - recv_large_have_;
+		if (bytes_read < missing) {
+			recv_large_have_ += bytes_read;
+			msgq->unlock();
+			return true;
+		}
+		msgq->push(new FawkesNetworkMessage(recv_large_));
+		recv_large_.payload = NULL;
+		recv_fill_          = bytes_read - missing;
+	} else {
+		recv_fill_ += bytes_read;
+	}
+
+	parse_recv_buffer(msgq);
+	msgq->unlock();
+	return true;
+}
+
+/** Extract all complete messages from the receive buffer.
+ * @param msgq locked message queue to append messages to
+ */
+void
+FawkesNetworkTransceiver::parse_recv_buffer(FawkesNetworkMessageQueue *msgq)
+{
+	const size_t header_size = sizeof(fawkes_message_header_t);
+
+	size_t pos = 0;
+	while (recv_fill_ - pos >= header_size) {
+		fawkes_message_t msg;
+		memcpy(&msg.header, recv_buf_ + pos, header_size);
+		size_t payload_size = ntohl(msg.header.payload_size);
+		size_t available    = recv_fill_ - pos - header_size;
+
+		if (payload_size <= available) {
+			// the message owns its payload, hence a copy of the right size
+			if (payload_size > 0) {
+				msg.payload = malloc(payload_size);
+				memcpy(msg.payload, recv_buf_ + pos + header_size, payload_size);
+			} else {
+				msg.payload = NULL;
+			}
+			msgq->push(new FawkesNetworkMessage(msg));
+			pos += header_size + payload_size;
+
+		} else if (header_size + payload_size > recv_buf_size_) {
+			// will never fit, receive remainder directly into the payload
+			recv_large_         = msg;
+			recv_large_.payload = malloc(payload_size);
+			recv_large_size_    = payload_size;
+			recv_large_have_    = available;
+			memcpy(recv_large_.payload, recv_buf_ + pos + header_size, available);
+			pos = recv_fill_;
+
+		} else {
+			// incomplete, wait for more data
+			break;
+		}
+	}
+
+	if (pos > 0) {
+		memmove(recv_buf_, recv_buf_ + pos, recv_fill_ - pos);
+		recv_fill_ -= pos;
+	}
+}
+
+/** Send messages without blocking.
+ * Sends the queued messages in batches with a single writev() call each,
+ * until all messages have been sent or the socket cannot take more data.
+ * A partially written batch is remembered and continued on the next call.
+ * The socket must be in non-blocking mode.
+ * @param s non-blocking socket over which the data shall be transmitted
+ * @param msgq message queue that contains the messages that have to be sent
+ * @return true if all messages have been sent, false if data is pending and
+ * the method must be called again once the socket is writable
+ * @exception ConnectionDiedException Thrown if any error occurs during the
+ * operation since for any error the conncetion is considered dead.
+ */
+bool
+FawkesNetworkTransceiver::send_some(StreamSocket *s, FawkesNetworkMessageQueue *msgq)
+{
+	while (true) {
+		if (send_iov_idx_ >= send_iov_.size()) {
+			release_send_batch();
+
+			msgq->lock();
+			while (!msgq->empty() && (send_msgs_.size() < MAX_MSGS_PER_WRITE)) {
+				FawkesNetworkMessage *m = msgq->front();
+				msgq->pop();
+				send_msgs_.push_back(m);
+				m->pack();
+				const fawkes_message_t &f = m->fmsg();
+				send_iov_.push_back({(void *)&(f.header), sizeof(f.header)});
+				if (m->payload_size() > 0) {
+					send_iov_.push_back({f.payload, m->payload_size()});
+				}
+			}
+			msgq->unlock();
+
+			if (send_iov_.empty())
+				return true;
+		}
+
+		size_t written = 0;
+		try {
+			written =
+			  s->writev(&send_iov_[send_iov_idx_], send_iov_.size() - send_iov_idx_, /* all */ false);
+		} catch (SocketException &e) {
+			throw ConnectionDiedException("Write failed");
+		}
+		if (written == 0)
+			return false;
+
+		while ((send_iov_idx_ < send_iov_.size()) && (written >= send_iov_[send_iov_idx_].iov_len)) {
+			written -= send_iov_[send_iov_idx_].iov_len;
+			++send_iov_idx_;
+		}
+		if (send_iov_idx_ < send_iov_.size()) {
+			struct iovec &v = send_iov_[send_iov_idx_];
+			v.iov_base      = (char *)v.iov_base + written;
+			v.iov_len -= written;
+		}
+	}
+}
+
+/** Check if a partially sent batch of messages is pending.
+ * @return true if send_some() has not finished sending a batch of messages
+ */
+bool
+FawkesNetworkTransceiver::send_pending() const
+{
+	return send_iov_idx_ < send_iov_.size();
+}
+
+/** Release messages of the current send batch. */
+void
+FawkesNetworkTransceiver::release_send_batch()
+{
+	for (FawkesNetworkMessage *m : send_msgs_) {
+		m->unref();
+	}
+	send_msgs_.clear();
+	send_iov_.clear();
+	send_iov_idx_ = 0;
+}
+
 } // end namespace fawkes
@@ -25,6 +25,10 @@
 #define _NETCOMM_FAWKES_TRANSCEIVER_H_
 
 #include <core/exception.h>
+#include <netcomm/fawkes/message.h>
+
+#include <sys/uio.h>
+#include <vector>
 
 namespace fawkes {
 
@@ -34,8 +38,31 @@ class FawkesNetworkMessageQueue;
 class FawkesNetworkTransceiver
 {
 public:
+	FawkesNetworkTransceiver(size_t recv_buffer_size = 65536);
+	~FawkesNetworkTransceiver();
+
 	static void send(StreamSocket *s, FawkesNetworkMessageQueue *msgq);
 	static void recv(StreamSocket *s, FawkesNetworkMessageQueue *msgq, unsigned int max_num_msgs = 8);
+
+	bool receive(StreamSocket *s, FawkesNetworkMessageQueue *msgq);
+	bool send_some(StreamSocket *s, FawkesNetworkMessageQueue *msgq);
+	bool send_pending() const;
+
+private:
+	void parse_recv_buffer(FawkesNetworkMessageQueue *msgq);
+	void release_send_batch();
+
+private:
+	char *           recv_buf_;
+	size_t           recv_buf_size_;
+	size_t           recv_fill_;
+	fawkes_message_t recv_large_;
+	size_t           recv_large_size_;
+	size_t           recv_large_have_;
+
+	std::vector<struct iovec>          send_iov_;
+	size_t                             send_iov_idx_;
+	std::vector<FawkesNetworkMessage *> send_msgs_;
 };
 
 } // end namespace fawkes
@@ -0,0 +1,254 @@
+
+/***************************************************************************
+ *  qa_fawkes_server.cpp - Fawkes network server throughput benchmark
+ *
+ *  Created: Sun Oct 18 00:21:09 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+#include <netcomm/fawkes/client.h>
+#include <netcomm/fawkes/client_handler.h>
+#include <netcomm/fawkes/handler.h>
+#include <netcomm/fawkes/message.h>
+#include <netcomm/fawkes/server_thread.h>
+#include <netcomm/socket/stream.h>
+#include <utils/system/argparser.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstring>
+#include <sys/socket.h>
+#include <utils/qa/qa_check.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace fawkes;
+
+#define QA_COMPONENT_ID 1234
+
+class EchoHandler : public FawkesNetworkHandler
+{
+public:
+	EchoHandler(FawkesNetworkServerThread *server) : FawkesNetworkHandler(QA_COMPONENT_ID)
+	{
+		server_      = server;
+		num_received = 0;
+	}
+
+	virtual void
+	handle_network_message(FawkesNetworkMessage *msg)
+	{
+		++num_received;
+		void *payload = NULL;
+		if (msg->payload_size() > 0) {
+			payload = malloc(msg->payload_size());
+			memcpy(payload, msg->payload(), msg->payload_size());
+		}
+		server_->send(msg->clid(), msg->cid(), msg->msgid(), payload, msg->payload_size());
+	}
+
+	virtual void
+	client_connected(unsigned int clid)
+	{
+	}
+
+	virtual void
+	client_disconnected(unsigned int clid)
+	{
+	}
+
+	std::atomic<unsigned int> num_received;
+
+private:
+	FawkesNetworkServerThread *server_;
+};
+
+class CountingClientHandler : public FawkesNetworkClientHandler
+{
+public:
+	CountingClientHandler(Mutex *mutex, WaitCondition *waitcond, unsigned int *received)
+	{
+		mutex_    = mutex;
+		waitcond_ = waitcond;
+		received_ = received;
+	}
+
+	virtual void
+	deregistered(unsigned int id) throw()
+	{
+	}
+
+	virtual void
+	inbound_received(FawkesNetworkMessage *m, unsigned int id) throw()
+	{
+		MutexLocker lock(mutex_);
+		*received_ += 1;
+		waitcond_->wake_all();
+	}
+
+	virtual void
+	connection_died(unsigned int id) throw()
+	{
+	}
+
+	virtual void
+	connection_established(unsigned int id) throw()
+	{
+	}
+
+private:
+	Mutex *        mutex_;
+	WaitCondition *waitcond_;
+	unsigned int * received_;
+};
+
+/* Sends a burst of messages and closes the sending side of the connection
+ * right away. All messages sent before must still be received.
+ */
+static bool
+check_half_close(unsigned short int port, EchoHandler *echo)
+{
+	const unsigned int num_msgs     = 4000;
+	const unsigned int payload_size = 64;
+	const size_t       msg_size     = sizeof(fawkes_message_header_t) + payload_size;
+
+	std::vector<char> buffer(num_msgs * msg_size, 0);
+	for (unsigned int m = 0; m < num_msgs; ++m) {
+		fawkes_message_header_t *h = (fawkes_message_header_t *)&buffer[m * msg_size];
+		h->cid                     = htons(QA_COMPONENT_ID);
+		h->msg_id                  = htons(1);
+		h->payload_size            = htonl(payload_size);
+	}
+
+	unsigned int received_before = echo->num_received;
+	StreamSocket s;
+	s.connect("127.0.0.1", port);
+	s.write(&buffer[0], buffer.size());
+	::shutdown(s.fd(), SHUT_WR);
+
+	Time start;
+	while (echo->num_received - received_before < num_msgs) {
+		Time now;
+		if (now - &start > 5.0)
+			break;
+		usleep(1000);
+	}
+	unsigned int received = echo->num_received - received_before;
+	s.close();
+	if (!qa::check(received == num_msgs,
+	               "received %u of %u messages sent before closing",
+	               received,
+	               num_msgs)) {
+		return false;
+	}
+	printf("Received all %u messages sent before closing\n", num_msgs);
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	ArgumentParser argp(argc, argv, "ehc:n:s:p:");
+	if (argp.has_arg("h")) {
+		printf("Usage: %s [-e] [-c clients] [-n messages] [-s payload size] [-p port]\n"
+		       " -e  serve clients from the epoll event loop instead of threads\n",
+		       argv[0]);
+		return 0;
+	}
+
+	bool         use_epoll    = argp.has_arg("e");
+	unsigned int num_clients  = argp.has_arg("c") ? argp.parse_int("c") : 16;
+	unsigned int num_msgs     = argp.has_arg("n") ? argp.parse_int("n") : 10000;
+	unsigned int payload_size = argp.has_arg("s") ? argp.parse_int("s") : 64;
+	unsigned int port         = argp.has_arg("p") ? argp.parse_int("p") : 19100;
+
+	FawkesNetworkServerThread *server =
+	  new FawkesNetworkServerThread(true, false, "127.0.0.1", "", port, NULL, use_epoll);
+	EchoHandler echo(server);
+	server->add_handler(&echo);
+	server->start();
+
+	Mutex                              mutex;
+	WaitCondition                      waitcond(&mutex);
+	unsigned int                       received = 0;
+	CountingClientHandler              handler(&mutex, &waitcond, &received);
+	std::vector<FawkesNetworkClient *> clients;
+	for (unsigned int i = 0; i < num_clients; ++i) {
+		FawkesNetworkClient *c = new FawkesNetworkClient("127.0.0.1", port);
+		c->register_handler(&handler, QA_COMPONENT_ID);
+		c->connect();
+		clients.push_back(c);
+	}
+
+	printf("%s mode, %u clients, %u messages of %u bytes each\n",
+	       use_epoll ? "epoll" : "thread",
+	       num_clients,
+	       num_msgs,
+	       payload_size);
+
+	Time start;
+	for (unsigned int m = 0; m < num_msgs; ++m) {
+		for (FawkesNetworkClient *c : clients) {
+			void *payload = calloc(1, payload_size);
+			c->enqueue(new FawkesNetworkMessage(QA_COMPONENT_ID, 1, payload, payload_size));
+		}
+	}
+
+	unsigned int expected = num_clients * num_msgs;
+	mutex.lock();
+	while (received < expected) {
+		if (!waitcond.reltimed_wait(10, 0)) {
+			printf("Timeout, received only %u of %u messages\n", received, expected);
+			break;
+		}
+	}
+	mutex.unlock();
+	Time end;
+
+	double duration = end - &start;
+	printf("Received %u messages in %.3f sec, %.0f msgs/sec round trip\n",
+	       received,
+	       duration,
+	       received / duration);
+
+	for (FawkesNetworkClient *c : clients) {
+		c->disconnect();
+		c->deregister_handler(QA_COMPONENT_ID);
+		delete c;
+	}
+
+	bool half_close_ok = check_half_close(port, &echo);
+
+	server->remove_handler(&echo);
+	server->cancel();
+	server->join();
+	delete server;
+
+	return qa::result(received == expected && half_close_ok);
+}
+
+/// @endcond
@@ -33,6 +33,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <errno.h>
@@ -833,6 +834,113 @@ Socket::read(void *buf, size_t count, bool read_all)
 	return bytes_read;
 }
 
+/** Read from socket into multiple buffers.
+ * Reads with a single readv() call into the given buffers, filling them in
+ * order. Unlike read() this does not loop, it returns the number of bytes
+ * that were available up to the total size of the buffers. This method can
+ * only be used on streams.
+ * @param iov buffers to read into
+ * @param iovcnt number of elements in iov
+ * @return number of bytes read, 0 if the socket is non-blocking and no
+ * data is currently available
+ * @exception SocketException thrown for any error during reading or if the
+ * connection has been closed by the remote end
+ */
+size_t
+Socket::readv(const struct iovec *iov, int iovcnt)
+{
+	if (sock_fd == -1) {
+		throw SocketException("Socket not initialized, call bind() or connect()");
+	}
+
+	ssize_t retval;
+	do {
+		retval = ::readv(sock_fd, iov, iovcnt);
+	} while ((retval == -1) && (errno == EINTR));
+
+	if (retval == -1) {
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			return 0;
+		}
+		throw SocketException(errno, "Could not read data");
+	} else if (retval == 0) {
+		throw SocketException("Connection closed");
+	}
+
+	return retval;
+}
+
+/** Write multiple buffers to the socket.
+ * Writes the given buffers in order as if they were one contiguous
+ * buffer, but with as few writev() calls as possible. This method can only
+ * be used on streams.
+ * @param iov buffers to write
+ * @param iovcnt number of elements in iov
+ * @param write_all setting this to true causes a call to writev() loop until
+ * all data has been written, just like write(). If false it will return after
+ * the first attempt with the number of bytes written then, which may be zero
+ * on a non-blocking socket.
+ * @return number of bytes written
+ * @exception SocketException if the data could not be written or if a timeout occured.
+ */
+size_t
+Socket::writev(const struct iovec *iov, int iovcnt, bool write_all)
+{
+	if (sock_fd == -1) {
+		throw SocketException("Socket not initialized, call bind() or connect()");
+	}
+
+	size_t count = 0;
+	for (int i = 0; i < iovcnt; ++i) {
+		count += iov[i].iov_len;
+	}
+
+	// copy of the vector which is advanced on partial writes
+	struct iovec vec[IOV_MAX];
+	if (iovcnt > IOV_MAX) {
+		throw SocketException("Too many buffers for writev (%i > %i)", iovcnt, IOV_MAX);
+	}
+	memcpy(vec, iov, iovcnt * sizeof(struct iovec));
+
+	struct iovec * v             = vec;
+	size_t         bytes_written = 0;
+	struct timeval start, now;
+
+	gettimeofday(&start, NULL);
+
+	do {
+		ssize_t retval = ::writev(sock_fd, v, iovcnt);
+		if (retval == -1) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+				throw SocketException(errno, "Could not write data");
+			}
+		} else {
+			bytes_written += retval;
+			while ((iovcnt > 0) && ((size_t)retval >= v->iov_len)) {
+				retval -= v->iov_len;
+				++v;
+				--iovcnt;
+			}
+			if (iovcnt > 0) {
+				v->iov_base = (char *)v->iov_base + retval;
+				v->iov_len -= retval;
+			}
+			// reset timeout
+			gettimeofday(&start, NULL);
+		}
+		if (!write_all)
+			return bytes_written;
+		gettimeofday(&now, NULL);
+		usleep(0);
+	} while ((bytes_written < count) && (time_diff_sec(now, start) < timeout));
+
+	if (bytes_written < count) {
+		throw SocketException("Write timeout");
+	}
+
+	return bytes_written;
+}
+
 /** Write to the socket.
  * Write to the socket. This method can be used on streams or on datagram
  * sockets which have been tuned to a specific receiver by using connect().
@@ -966,6 +1074,42 @@ Socket::listening()
 	return (i == 1);
 }
 
+/** Set non-blocking mode.
+ * In non-blocking mode readv() and writev() return immediately if no data
+ * can be transferred. This is meant for sockets which are driven by an
+ * external event loop, e.g. based on epoll. Note that read() and write()
+ * busy-wait on a non-blocking socket.
+ * @param nonblocking true to enable non-blocking mode, false to disable it
+ * @exception SocketException thrown if the mode cannot be changed
+ */
+void
+Socket::set_nonblocking(bool nonblocking)
+{
+	if (sock_fd == -1) {
+		throw SocketException("Socket not initialized, call bind() or connect()");
+	}
+
+	int flags = fcntl(sock_fd, F_GETFL);
+	if (flags == -1) {
+		throw SocketException(errno, "Socket::set_nonblocking(): fcntl(F_GETFL) failed");
+	}
+	flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+	if (fcntl(sock_fd, F_SETFL, flags) == -1) {
+		throw SocketException(errno, "Socket::set_nonblocking(): fcntl(F_SETFL) failed");
+	}
+}
+
+/** Get file descriptor.
+ * The descriptor is meant to register the socket with an event loop. Do not
+ * close it, the socket remains the owner.
+ * @return file descriptor of the socket, -1 if not initialized
+ */
+int
+Socket::fd() const
+{
+	return sock_fd;
+}
+
 /** Maximum Transfer Unit (MTU) of socket.
  * Note that this can only be retrieved of connected sockets!
  * @return MTU in bytes
@@ -28,6 +28,10 @@ namespace fawkes {
  * Point Cloud manager.
  * This class manages a number of points clouds and acts as a hub to
  * distribute them.
+ *
+ * Point clouds can additionally be exported to shared memory to make
+ * them available to other processes without serializing them, see
+ * export_pointcloud().
  * @author Tim Niemueller
  *
  * @fn void PointCloudManager::add_pointcloud(const char *id, RefPtr<pcl::PointCloud<PointT> > cloud)
@@ -51,6 +55,12 @@ PointCloudManager::PointCloudManager()
 /** Destructor. */
 PointCloudManager::~PointCloudManager()
 {
+	LockMap<std::string, SharedMemoryPointCloudBuffer *>::iterator e;
+	for (e = exports_.begin(); e != exports_.end(); ++e) {
+		delete e->second;
+	}
+	exports_.clear();
+
 	LockMap<std::string, pcl_utils::StorageAdapter *>::iterator c;
 	for (c = clouds_.begin(); c != clouds_.end(); ++c) {
 		delete c->second;
@@ -71,6 +81,8 @@ PointCloudManager::remove_pointcloud(const char *id)
 		delete clouds_[id];
 		clouds_.erase(id);
 	}
+
+	unexport_pointcloud(id);
 }
 
 /** Check if point cloud exists
@@ -133,4 +145,106 @@ PointCloudManager::get_storage_adapter(const char *id)
 	return clouds_[id];
 }
 
+/** Export point cloud to shared memory.
+ * Creates a shared memory point cloud buffer for the point cloud. The
+ * buffer has the ID of the point cloud and the type name of its storage
+ * adapter as point type. Each call to publish_pointcloud() copies the
+ * current points into the next slot of the buffer, from where other
+ * processes can read them in place.
+ * @param id ID of point cloud to export
+ * @param num_slots number of slots of the shared memory buffer
+ * @exception Exception thrown if ID is unknown or the buffer cannot be created
+ */
+void
+PointCloudManager::export_pointcloud(const char *id, unsigned int num_slots)
+{
+	MutexLocker lock(clouds_.mutex());
+
+	if (clouds_.find(id) == clouds_.end()) {
+		throw Exception("PointCloud '%s' unknown", id);
+	}
+
+	MutexLocker elock(exports_.mutex());
+	if (exports_.find(id) != exports_.end()) {
+		throw Exception("PointCloud '%s' already exported", id);
+	}
+
+	pcl_utils::StorageAdapter *sa = clouds_[id];
+	exports_[id]                  = new SharedMemoryPointCloudBuffer(id,
+	                                                                 sa->get_typename(),
+	                                                                 sa->point_size(),
+	                                                                 sa->num_points(),
+	                                                                 num_slots);
+}
+
+/** Stop exporting point cloud to shared memory.
+ * Destroys the shared memory buffer, does nothing if the point cloud
+ * has not been exported.
+ * @param id ID of point cloud to no longer export
+ */
+void
+PointCloudManager::unexport_pointcloud(const char *id)
+{
+	MutexLocker lock(exports_.mutex());
+
+	if (exports_.find(id) != exports_.end()) {
+		delete exports_[id];
+		exports_.erase(id);
+	}
+}
+
+/** Check if point cloud is exported to shared memory.
+ * @param id ID of point cloud to check
+ * @return true if the point cloud is exported, false otherwise
+ */
+bool
+PointCloudManager::is_exported(const char *id)
+{
+	MutexLocker lock(exports_.mutex());
+
+	return (exports_.find(id) != exports_.end());
+}
+
+/** Publish point cloud to shared memory.
+ * Copies the current points of the point cloud into the next slot of
+ * its shared memory buffer. Call this after updating an exported point
+ * cloud. If the point cloud has grown beyond the capacity of the buffer,
+ * the buffer is re-created with a larger capacity and readers must attach
+ * again. Does nothing if the point cloud has not been exported.
+ * @param id ID of point cloud to publish
+ */
+void
+PointCloudManager::publish_pointcloud(const char *id)
+{
+	MutexLocker lock(clouds_.mutex());
+
+	if (clouds_.find(id) == clouds_.end()) {
+		throw Exception("PointCloud '%s' unknown", id);
+	}
+
+	MutexLocker elock(exports_.mutex());
+	if (exports_.find(id) == exports_.end())
+		return;
+
+	pcl_utils::StorageAdapter *   sa  = clouds_[id];
+	SharedMemoryPointCloudBuffer *buf = exports_[id];
+	if (sa->num_points() > buf->capacity()) {
+		unsigned int num_slots = buf->num_slots();
+		delete buf;
+		exports_.erase(id);
+		buf = new SharedMemoryPointCloudBuffer(
+		  id, sa->get_typename(), sa->point_size(), sa->num_points(), num_slots);
+		exports_[id] = buf;
+	}
+
+	Time time((long)0, (long)0);
+	sa->get_time(time);
+	buf->write(sa->data_ptr(),
+	           sa->width(),
+	           sa->height(),
+	           sa->num_points(),
+	           sa->frame_id().c_str(),
+	           time);
+}
+
 } // end namespace fawkes
@@ -27,6 +27,7 @@
 #include <core/threading/mutex_locker.h>
 #include <core/utils/lock_map.h>
 #include <core/utils/refptr.h>
+#include <pcl_utils/shm_pointcloud.h>
 #include <pcl_utils/storage_adapter.h>
 #include <utils/time/time.h>
 
@@ -69,8 +70,14 @@ public:
 	const fawkes::LockMap<std::string, pcl_utils::StorageAdapter *> &get_pointclouds() const;
 	const pcl_utils::StorageAdapter *get_storage_adapter(const char *id);
 
+	void export_pointcloud(const char *id, unsigned int num_slots = 3);
+	void unexport_pointcloud(const char *id);
+	bool is_exported(const char *id);
+	void publish_pointcloud(const char *id);
+
 private:
-	fawkes::LockMap<std::string, pcl_utils::StorageAdapter *> clouds_;
+	fawkes::LockMap<std::string, pcl_utils::StorageAdapter *>    clouds_;
+	fawkes::LockMap<std::string, SharedMemoryPointCloudBuffer *> exports_;
 };
 
 template <typename PointT>
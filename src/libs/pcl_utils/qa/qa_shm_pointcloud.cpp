@@ -0,0 +1,145 @@
+
+/***************************************************************************
+ *  qa_shm_pointcloud.cpp - Shared memory point cloud buffer QA
+ *
+ *  Created: Sun Oct 18 11:52:08 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <core/exception.h>
+#include <pcl_utils/shm_pointcloud.h>
+#include <utils/qa/qa_check.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/* Writes point clouds to a shared memory buffer while a forked reader
+ * process reads the latest point cloud in place. Every point of a cloud
+ * carries the sequence number of the cloud, the reader verifies that all
+ * points of a cloud it considers valid have the same sequence number,
+ * i.e. that it never accepts a torn cloud. Reports the write rate and how
+ * many clouds the reader has seen and rejected.
+ */
+
+// layout of pcl::PointXYZ, 16 bytes with padding
+struct Point
+{
+	float x, y, z, seq;
+};
+
+static const char * CLOUD_ID   = "qa-shm-pointcloud";
+static const size_t NUM_POINTS = 640 * 480;
+
+static int
+reader(unsigned int num_clouds)
+{
+	SharedMemoryPointCloudBuffer       buf(CLOUD_ID);
+	SharedMemoryPointCloudBuffer::Slot slot;
+	uint64_t                           last_seq = 0;
+	unsigned int                       num_read = 0, num_torn = 0, num_rejected = 0;
+	while (last_seq < num_clouds) {
+		if (!buf.latest(slot) || slot.sequence == last_seq)
+			continue;
+		const Point *points = buf.points<Point>(slot);
+		bool         torn   = false;
+		for (size_t i = 0; i < slot.num_points; ++i) {
+			if (points[i].seq != (float)slot.sequence) {
+				torn = true;
+				break;
+			}
+		}
+		if (!buf.is_valid(slot)) {
+			++num_rejected;
+			continue;
+		}
+		if (torn || slot.num_points != NUM_POINTS || slot.frame_id != "/base_link") {
+			++num_torn;
+		}
+		last_seq = slot.sequence;
+		++num_read;
+	}
+	printf("reader: %u clouds read, %u rejected as overwritten\n", num_read, num_rejected);
+	return qa::check(num_torn == 0, "reader accepted %u inconsistent clouds", num_torn) ? 0 : 1;
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int num_clouds = argc > 1 ? atoi(argv[1]) : 2000;
+	bool         ok         = true;
+
+	try {
+		SharedMemoryPointCloudBuffer buf(CLOUD_ID, "Point", sizeof(Point), NUM_POINTS, 3);
+		ok &= qa::check(SharedMemoryPointCloudBuffer::exists(CLOUD_ID),
+		                "buffer does not exist after creation");
+
+		fflush(stdout);
+		pid_t pid = fork();
+		if (pid == 0) {
+			int rv = 1;
+			try {
+				rv = reader(num_clouds);
+			} catch (Exception &e) {
+				e.print_trace();
+			}
+			fflush(stdout);
+			_exit(rv);
+		}
+
+		Time     time;
+		long int start = qa::now_nsec();
+		for (unsigned int s = 1; s <= num_clouds; ++s) {
+			Point *points = static_cast<Point *>(buf.begin_write());
+			for (size_t i = 0; i < NUM_POINTS; ++i) {
+				points[i].x   = i % 640;
+				points[i].y   = i / 640;
+				points[i].z   = 1.;
+				points[i].seq = s;
+			}
+			time.stamp();
+			buf.commit(640, 480, NUM_POINTS, "/base_link", time);
+		}
+		double sec = (qa::now_nsec() - start) / 1000000000.;
+		printf("writer: %u clouds of %zu points in %.3f sec, %.1f clouds/sec\n",
+		       num_clouds,
+		       NUM_POINTS,
+		       sec,
+		       num_clouds / sec);
+
+		int status;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			ok = false;
+	} catch (Exception &e) {
+		e.print_trace();
+		ok = false;
+	}
+
+	ok &= qa::check(!SharedMemoryPointCloudBuffer::exists(CLOUD_ID),
+	                "buffer still exists after deletion");
+
+	return qa::result(ok);
+}
+
+/// @endcond
@@ -0,0 +1,581 @@
+
+/***************************************************************************
+ *  shm_pointcloud.cpp - Shared memory point cloud buffer
+ *
+ *  Created: Sun Oct 18 11:04:26 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <pcl_utils/shm_pointcloud.h>
+#include <utils/ipc/shm_exceptions.h>
+
+#include <cstring>
+#include <memory>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+// slot data is aligned to cache lines, the segment itself is page aligned
+// in every process, hence the alignment is the same for all processes
+#define SHM_POINTCLOUD_ALIGN 64
+
+static inline size_t
+align_up(size_t v)
+{
+	return (v + SHM_POINTCLOUD_ALIGN - 1) & ~((size_t)SHM_POINTCLOUD_ALIGN - 1);
+}
+/// @endcond
+
+/** @class SharedMemoryPointCloudBuffer <pcl_utils/shm_pointcloud.h>
+ * Shared memory point cloud buffer.
+ * This buffer makes point clouds available to other processes. The
+ * buffer is a ring of slots, each of which holds a point cloud of up to
+ * a fixed number of points. The writer fills the slot following the
+ * latest complete one and then publishes it with a new sequence number.
+ * Readers access the points of the latest slot in place, without locking
+ * and without copying. Since the writer does not wait for readers, a
+ * slot is overwritten after as many new point clouds as there are slots
+ * minus one have been written. Readers must check with is_valid() after
+ * processing that the points have not been overwritten meanwhile, more
+ * slots give readers more time.
+ *
+ * The buffer only knows the size of a point, the point type is given as
+ * a string to be checked by readers. The PointCloudManager uses the type
+ * name of the PointCloudStorageAdapter for the point type.
+ *
+ * Only a single writer may exist per buffer.
+ * @author Tim Niemueller
+ */
+
+/** @class SharedMemoryPointCloudBuffer::Slot <pcl_utils/shm_pointcloud.h>
+ * Point cloud in a slot of a shared memory point cloud buffer.
+ * @author Tim Niemueller
+ */
+
+/** Constructor. */
+SharedMemoryPointCloudBuffer::Slot::Slot()
+: sequence(0), data(NULL), width(0), height(0), num_points(0)
+{
+}
+
+/** Write constructor.
+ * Creates a new shared memory segment for the point cloud.
+ * @param cloud_id point cloud ID
+ * @param point_type name of the point type
+ * @param point_size size of a single point in bytes
+ * @param capacity maximum number of points per point cloud
+ * @param num_slots number of slots in the ring, at least two
+ */
+SharedMemoryPointCloudBuffer::SharedMemoryPointCloudBuffer(const char * cloud_id,
+                                                           const char * point_type,
+                                                           size_t       point_size,
+                                                           size_t       capacity,
+                                                           unsigned int num_slots)
+: SharedMemory(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN,
+               /* read-only */ false,
+               /* create */ true,
+               /* destroy on delete */ true),
+  cloud_id_(cloud_id)
+{
+	if (num_slots < 2) {
+		throw Exception("Point cloud %s needs at least two slots", cloud_id);
+	}
+	if (strlen(cloud_id) >= POINTCLOUD_ID_MAX_LENGTH) {
+		throw Exception("Point cloud ID %s too long", cloud_id);
+	}
+
+	priv_header_ = new SharedMemoryPointCloudBufferHeader(
+	  cloud_id, point_type, point_size, capacity, num_slots);
+	_header = priv_header_;
+	try {
+		attach();
+	} catch (Exception &e) {
+		e.append("SharedMemoryPointCloudBuffer: could not attach to '%s'", cloud_id);
+		delete priv_header_;
+		throw;
+	}
+	if (_memptr == NULL) {
+		delete priv_header_;
+		throw Exception("SharedMemoryPointCloudBuffer: could not create '%s'", cloud_id);
+	}
+	raw_header_  = priv_header_->raw_header();
+	slot_stride_ = align_up(raw_header_->capacity * raw_header_->point_size);
+}
+
+/** Read constructor.
+ * Attaches read-only to an existing point cloud buffer.
+ * @param cloud_id point cloud ID
+ */
+SharedMemoryPointCloudBuffer::SharedMemoryPointCloudBuffer(const char *cloud_id)
+: SharedMemory(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN,
+               /* read-only */ true,
+               /* create */ false,
+               /* destroy on delete */ false),
+  cloud_id_(cloud_id)
+{
+	priv_header_ = new SharedMemoryPointCloudBufferHeader(cloud_id, "", 0, 0, 0);
+	_header      = priv_header_;
+	try {
+		attach();
+	} catch (Exception &e) {
+		e.append("SharedMemoryPointCloudBuffer: could not attach to '%s'", cloud_id);
+		delete priv_header_;
+		throw;
+	}
+	if (_memptr == NULL) {
+		delete priv_header_;
+		throw Exception("SharedMemoryPointCloudBuffer: point cloud '%s' does not exist", cloud_id);
+	}
+	raw_header_  = priv_header_->raw_header();
+	slot_stride_ = align_up(raw_header_->capacity * raw_header_->point_size);
+}
+
+/** Destructor. */
+SharedMemoryPointCloudBuffer::~SharedMemoryPointCloudBuffer()
+{
+	delete priv_header_;
+}
+
+/** Get point cloud ID.
+ * @return point cloud ID
+ */
+const char *
+SharedMemoryPointCloudBuffer::cloud_id() const
+{
+	return cloud_id_.c_str();
+}
+
+/** Get point type name.
+ * @return name of the point type as given by the writer
+ */
+const char *
+SharedMemoryPointCloudBuffer::point_type() const
+{
+	return raw_header_->point_type;
+}
+
+/** Get size of a point.
+ * @return size of a point in bytes
+ */
+size_t
+SharedMemoryPointCloudBuffer::point_size() const
+{
+	return raw_header_->point_size;
+}
+
+/** Get capacity.
+ * @return maximum number of points per point cloud
+ */
+size_t
+SharedMemoryPointCloudBuffer::capacity() const
+{
+	return raw_header_->capacity;
+}
+
+/** Get number of slots.
+ * @return number of slots in the ring
+ */
+unsigned int
+SharedMemoryPointCloudBuffer::num_slots() const
+{
+	return raw_header_->num_slots;
+}
+
+SharedMemoryPointCloudBuffer_slot_t *
+SharedMemoryPointCloudBuffer::slot_header(unsigned int slot) const
+{
+	return (SharedMemoryPointCloudBuffer_slot_t *)_memptr + slot;
+}
+
+char *
+SharedMemoryPointCloudBuffer::slot_data(unsigned int slot) const
+{
+	size_t headers =
+	  (size_t)_memptr + raw_header_->num_slots * sizeof(SharedMemoryPointCloudBuffer_slot_t);
+	return (char *)align_up(headers) + slot * slot_stride_;
+}
+
+/** Begin writing a point cloud.
+ * Get the memory of the next slot to write the points to in place. The
+ * slot is invalidated for readers until commit() is called. Do not call
+ * begin_write() again before commit().
+ * @return memory for up to capacity() points
+ */
+void *
+SharedMemoryPointCloudBuffer::begin_write()
+{
+	if (_is_read_only) {
+		throw Exception("Point cloud buffer %s is read-only", cloud_id_.c_str());
+	}
+	uint64_t                             seq  = raw_header_->sequence + 1;
+	SharedMemoryPointCloudBuffer_slot_t *slot = slot_header(seq % raw_header_->num_slots);
+
+	// invalidate before the points are modified
+	__atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	return slot_data(seq % raw_header_->num_slots);
+}
+
+/** Publish the point cloud written after begin_write().
+ * @param width width of the point cloud
+ * @param height height of the point cloud
+ * @param num_points number of points written
+ * @param frame_id coordinate frame ID of the point cloud
+ * @param time capture time of the point cloud
+ */
+void
+SharedMemoryPointCloudBuffer::commit(unsigned int width,
+                                     unsigned int height,
+                                     size_t       num_points,
+                                     const char * frame_id,
+                                     const Time & time)
+{
+	if (_is_read_only) {
+		throw Exception("Point cloud buffer %s is read-only", cloud_id_.c_str());
+	}
+	if (num_points > raw_header_->capacity) {
+		throw Exception("Point cloud %s has %zu points, capacity is %llu",
+		                cloud_id_.c_str(),
+		                num_points,
+		                (unsigned long long)raw_header_->capacity);
+	}
+
+	uint64_t                             seq  = raw_header_->sequence + 1;
+	SharedMemoryPointCloudBuffer_slot_t *slot = slot_header(seq % raw_header_->num_slots);
+
+	slot->time_sec   = time.get_sec();
+	slot->time_usec  = time.get_usec();
+	slot->width      = width;
+	slot->height     = height;
+	slot->num_points = num_points;
+	strncpy(slot->frame_id, frame_id, POINTCLOUD_FRAME_ID_MAX_LENGTH - 1);
+	slot->frame_id[POINTCLOUD_FRAME_ID_MAX_LENGTH - 1] = 0;
+
+	__atomic_store_n(&slot->sequence, seq, __ATOMIC_RELEASE);
+	__atomic_store_n(&raw_header_->sequence, seq, __ATOMIC_RELEASE);
+}
+
+/** Write a point cloud.
+ * Copies the points to the next slot and publishes them.
+ * @param points points to copy
+ * @param width width of the point cloud
+ * @param height height of the point cloud
+ * @param num_points number of points
+ * @param frame_id coordinate frame ID of the point cloud
+ * @param time capture time of the point cloud
+ */
+void
+SharedMemoryPointCloudBuffer::write(const void * points,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    size_t       num_points,
+                                    const char * frame_id,
+                                    const Time & time)
+{
+	if (num_points > raw_header_->capacity) {
+		throw Exception("Point cloud %s has %zu points, capacity is %llu",
+		                cloud_id_.c_str(),
+		                num_points,
+		                (unsigned long long)raw_header_->capacity);
+	}
+	void *data = begin_write();
+	if (num_points > 0)
+		memcpy(data, points, num_points * raw_header_->point_size);
+	commit(width, height, num_points, frame_id, time);
+}
+
+/** Get sequence number of latest point cloud.
+ * @return sequence number of the latest complete point cloud, 0 if none
+ * has been written, yet
+ */
+uint64_t
+SharedMemoryPointCloudBuffer::sequence() const
+{
+	return __atomic_load_n(&raw_header_->sequence, __ATOMIC_ACQUIRE);
+}
+
+/** Get latest point cloud.
+ * @param slot upon return contains the latest point cloud, its points
+ * are not copied
+ * @return true if a point cloud was available, false if none has been
+ * written, yet
+ */
+bool
+SharedMemoryPointCloudBuffer::latest(Slot &slot) const
+{
+	for (unsigned int tries = 0; tries < raw_header_->num_slots; ++tries) {
+		uint64_t seq = sequence();
+		if (seq == 0)
+			return false;
+
+		const SharedMemoryPointCloudBuffer_slot_t *s = slot_header(seq % raw_header_->num_slots);
+		if (__atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE) != seq) {
+			// overwritten while we were looking, retry with the newer one
+			continue;
+		}
+		slot.sequence   = seq;
+		slot.data       = slot_data(seq % raw_header_->num_slots);
+		slot.width      = s->width;
+		slot.height     = s->height;
+		slot.num_points = s->num_points;
+		slot.frame_id =
+		  std::string(s->frame_id, strnlen(s->frame_id, POINTCLOUD_FRAME_ID_MAX_LENGTH));
+		slot.time.set_time(s->time_sec, s->time_usec);
+
+		if (is_valid(slot))
+			return true;
+	}
+	return false;
+}
+
+/** Check if a point cloud is still valid.
+ * Call this after processing the points of the slot, if it returns
+ * false the writer has overwritten the slot meanwhile and the results
+ * must be discarded.
+ * @param slot slot retrieved with latest()
+ * @return true if the slot has not been overwritten
+ */
+bool
+SharedMemoryPointCloudBuffer::is_valid(const Slot &slot) const
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	const SharedMemoryPointCloudBuffer_slot_t *s =
+	  slot_header(slot.sequence % raw_header_->num_slots);
+	return (slot.sequence != 0)
+	       && (__atomic_load_n(&s->sequence, __ATOMIC_RELAXED) == slot.sequence);
+}
+
+/** Get IDs of all available point cloud buffers.
+ * @return list of point cloud IDs
+ */
+std::list<std::string>
+SharedMemoryPointCloudBuffer::list()
+{
+	std::list<std::string>                             rv;
+	std::unique_ptr<SharedMemoryPointCloudBufferHeader> h(new SharedMemoryPointCloudBufferHeader());
+
+	SharedMemory::SharedMemoryIterator i =
+	  SharedMemory::find(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, h.get());
+	SharedMemory::SharedMemoryIterator endi = SharedMemory::end();
+	for (; i != endi; ++i) {
+		const SharedMemoryPointCloudBufferHeader *ph =
+		  dynamic_cast<const SharedMemoryPointCloudBufferHeader *>(*i);
+		if (ph && !SharedMemory::is_destroyed(i.shmid())) {
+			rv.push_back(ph->cloud_id());
+		}
+	}
+	return rv;
+}
+
+/** Check point cloud availability.
+ * @param cloud_id point cloud ID to check
+ * @return true if shared memory segment with requested point cloud exists
+ */
+bool
+SharedMemoryPointCloudBuffer::exists(const char *cloud_id)
+{
+	SharedMemoryPointCloudBufferHeader h(cloud_id, "", 0, 0, 0);
+	return SharedMemory::exists(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h);
+}
+
+/** Erase a specific shared memory segment that contains a point cloud.
+ * @param cloud_id ID of point cloud to wipe
+ */
+void
+SharedMemoryPointCloudBuffer::wipe(const char *cloud_id)
+{
+	SharedMemoryPointCloudBufferHeader h(cloud_id, "", 0, 0, 0);
+	SharedMemory::erase(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h, NULL);
+}
+
+/** @class SharedMemoryPointCloudBufferHeader <pcl_utils/shm_pointcloud.h>
+ * Shared memory point cloud buffer header.
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * Matches any point cloud buffer.
+ */
+SharedMemoryPointCloudBufferHeader::SharedMemoryPointCloudBufferHeader()
+: point_size_(0), capacity_(0), num_slots_(0), header_(NULL)
+{
+}
+
+/** Constructor.
+ * @param cloud_id point cloud ID
+ * @param point_type name of the point type
+ * @param point_size size of a single point in bytes, 0 to match any
+ * @param capacity maximum number of points per point cloud
+ * @param num_slots number of slots in the ring
+ */
+SharedMemoryPointCloudBufferHeader::SharedMemoryPointCloudBufferHeader(const char * cloud_id,
+                                                                       const char * point_type,
+                                                                       size_t       point_size,
+                                                                       size_t       capacity,
+                                                                       unsigned int num_slots)
+: cloud_id_(cloud_id),
+  point_type_(point_type),
+  point_size_(point_size),
+  capacity_(capacity),
+  num_slots_(num_slots),
+  header_(NULL)
+{
+}
+
+/** Copy constructor.
+ * @param h shared memory point cloud header to copy
+ */
+SharedMemoryPointCloudBufferHeader::SharedMemoryPointCloudBufferHeader(
+  const SharedMemoryPointCloudBufferHeader *h)
+: cloud_id_(h->cloud_id_),
+  point_type_(h->point_type_),
+  point_size_(h->point_size_),
+  capacity_(h->capacity_),
+  num_slots_(h->num_slots_),
+  header_(h->header_)
+{
+}
+
+/** Destructor. */
+SharedMemoryPointCloudBufferHeader::~SharedMemoryPointCloudBufferHeader()
+{
+}
+
+SharedMemoryHeader *
+SharedMemoryPointCloudBufferHeader::clone() const
+{
+	return new SharedMemoryPointCloudBufferHeader(this);
+}
+
+size_t
+SharedMemoryPointCloudBufferHeader::size()
+{
+	return sizeof(SharedMemoryPointCloudBuffer_header_t);
+}
+
+size_t
+SharedMemoryPointCloudBufferHeader::data_size()
+{
+	size_t point_size = header_ ? header_->point_size : point_size_;
+	size_t capacity   = header_ ? header_->capacity : capacity_;
+	size_t num_slots  = header_ ? header_->num_slots : num_slots_;
+
+	// slot headers, padding for alignment, and the aligned slots
+	return num_slots * sizeof(SharedMemoryPointCloudBuffer_slot_t) + SHM_POINTCLOUD_ALIGN
+	       + num_slots * align_up(capacity * point_size);
+}
+
+bool
+SharedMemoryPointCloudBufferHeader::matches(void *memptr)
+{
+	SharedMemoryPointCloudBuffer_header_t *h = (SharedMemoryPointCloudBuffer_header_t *)memptr;
+
+	if (cloud_id_.empty()) {
+		return true;
+	} else if (strncmp(h->cloud_id, cloud_id_.c_str(), POINTCLOUD_ID_MAX_LENGTH) == 0) {
+		if ((point_size_ == 0)
+		    || ((h->point_size == point_size_) && (h->capacity == capacity_)
+		        && (h->num_slots == num_slots_)
+		        && (strncmp(h->point_type, point_type_.c_str(), POINTCLOUD_TYPE_MAX_LENGTH) == 0))) {
+			return true;
+		} else {
+			throw Exception("Inconsistent point cloud %s found in memory", cloud_id_.c_str());
+		}
+	} else {
+		return false;
+	}
+}
+
+/** Check for equality of headers.
+ * @param s shared memory header to compare to
+ * @return true if the two instances identify the very same shared memory segments,
+ * false otherwise
+ */
+bool
+SharedMemoryPointCloudBufferHeader::operator==(const SharedMemoryHeader &s) const
+{
+	const SharedMemoryPointCloudBufferHeader *h =
+	  dynamic_cast<const SharedMemoryPointCloudBufferHeader *>(&s);
+	return h && (cloud_id_ == h->cloud_id_) && (point_type_ == h->point_type_)
+	       && (point_size_ == h->point_size_) && (capacity_ == h->capacity_)
+	       && (num_slots_ == h->num_slots_);
+}
+
+/** Check if a segment may be created.
+ * @return true if point size, capacity and number of slots have been set
+ */
+bool
+SharedMemoryPointCloudBufferHeader::create()
+{
+	return (point_size_ > 0) && (capacity_ > 0) && (num_slots_ > 0);
+}
+
+void
+SharedMemoryPointCloudBufferHeader::initialize(void *memptr)
+{
+	SharedMemoryPointCloudBuffer_header_t *header = (SharedMemoryPointCloudBuffer_header_t *)memptr;
+	memset(memptr, 0, sizeof(SharedMemoryPointCloudBuffer_header_t));
+
+	strncpy(header->cloud_id, cloud_id_.c_str(), POINTCLOUD_ID_MAX_LENGTH - 1);
+	strncpy(header->point_type, point_type_.c_str(), POINTCLOUD_TYPE_MAX_LENGTH - 1);
+	header->point_size = point_size_;
+	header->capacity   = capacity_;
+	header->num_slots  = num_slots_;
+	header->sequence   = 0;
+
+	header_ = header;
+}
+
+void
+SharedMemoryPointCloudBufferHeader::set(void *memptr)
+{
+	header_ = (SharedMemoryPointCloudBuffer_header_t *)memptr;
+	cloud_id_ =
+	  std::string(header_->cloud_id, strnlen(header_->cloud_id, POINTCLOUD_ID_MAX_LENGTH));
+	point_type_ =
+	  std::string(header_->point_type, strnlen(header_->point_type, POINTCLOUD_TYPE_MAX_LENGTH));
+	point_size_ = header_->point_size;
+	capacity_   = header_->capacity;
+	num_slots_  = header_->num_slots;
+}
+
+void
+SharedMemoryPointCloudBufferHeader::reset()
+{
+	header_ = NULL;
+}
+
+/** Get point cloud ID.
+ * @return point cloud ID
+ */
+const char *
+SharedMemoryPointCloudBufferHeader::cloud_id() const
+{
+	return cloud_id_.c_str();
+}
+
+/** Get raw header.
+ * @return raw header in shared memory
+ */
+SharedMemoryPointCloudBuffer_header_t *
+SharedMemoryPointCloudBufferHeader::raw_header()
+{
+	return header_;
+}
+
+} // end namespace fawkes
@@ -0,0 +1,195 @@
+
+/***************************************************************************
+ *  shm_pointcloud.h - Shared memory point cloud buffer
+ *
+ *  Created: Sun Oct 18 11:04:26 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _LIBS_PCL_UTILS_SHM_POINTCLOUD_H_
+#define _LIBS_PCL_UTILS_SHM_POINTCLOUD_H_
+
+#include <core/exception.h>
+#include <utils/ipc/shm.h>
+#include <utils/time/time.h>
+
+#include <list>
+#include <stdint.h>
+#include <string>
+
+// Magic token to identify Fawkes shared memory point clouds,
+// must fit into SharedMemory::MagicTokenSize including the terminator
+#define FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN "Fawkes PtCloud"
+
+/** Maximum length of point cloud IDs. */
+#define POINTCLOUD_ID_MAX_LENGTH 64
+/** Maximum length of point type names. */
+#define POINTCLOUD_TYPE_MAX_LENGTH 128
+/** Maximum length of coordinate frame IDs. */
+#define POINTCLOUD_FRAME_ID_MAX_LENGTH 64
+
+namespace fawkes {
+
+/** Shared memory header struct for point clouds. */
+typedef struct
+{
+	char     cloud_id[POINTCLOUD_ID_MAX_LENGTH];     /**< point cloud ID */
+	char     point_type[POINTCLOUD_TYPE_MAX_LENGTH]; /**< point type name */
+	uint32_t point_size;                             /**< size of a point in bytes */
+	uint32_t num_slots;                              /**< number of slots in the ring */
+	uint64_t capacity;                               /**< maximum number of points per slot */
+	uint64_t sequence; /**< sequence number of the latest complete slot, 0 if none */
+} SharedMemoryPointCloudBuffer_header_t;
+
+/** Shared memory header struct for a slot of a point cloud buffer. */
+typedef struct
+{
+	uint64_t sequence;                                /**< sequence number, 0 while written */
+	int64_t  time_sec;                                /**< capture time, seconds */
+	int64_t  time_usec;                               /**< capture time, microseconds */
+	uint32_t width;                                   /**< width of the point cloud */
+	uint32_t height;                                  /**< height of the point cloud */
+	uint64_t num_points;                              /**< number of valid points */
+	char     frame_id[POINTCLOUD_FRAME_ID_MAX_LENGTH]; /**< coordinate frame ID */
+} SharedMemoryPointCloudBuffer_slot_t;
+
+class SharedMemoryPointCloudBufferHeader : public SharedMemoryHeader
+{
+public:
+	SharedMemoryPointCloudBufferHeader();
+	SharedMemoryPointCloudBufferHeader(const char * cloud_id,
+	                                   const char * point_type,
+	                                   size_t       point_size,
+	                                   size_t       capacity,
+	                                   unsigned int num_slots);
+	SharedMemoryPointCloudBufferHeader(const SharedMemoryPointCloudBufferHeader *h);
+	virtual ~SharedMemoryPointCloudBufferHeader();
+
+	virtual SharedMemoryHeader *clone() const;
+	virtual bool                matches(void *memptr);
+	virtual size_t              size();
+	virtual bool                create();
+	virtual void                initialize(void *memptr);
+	virtual void                set(void *memptr);
+	virtual void                reset();
+	virtual size_t              data_size();
+	virtual bool                operator==(const SharedMemoryHeader &s) const;
+
+	const char *cloud_id() const;
+
+	SharedMemoryPointCloudBuffer_header_t *raw_header();
+
+private:
+	std::string  cloud_id_;
+	std::string  point_type_;
+	size_t       point_size_;
+	size_t       capacity_;
+	unsigned int num_slots_;
+
+	SharedMemoryPointCloudBuffer_header_t *header_;
+};
+
+class SharedMemoryPointCloudBuffer : public SharedMemory
+{
+public:
+	/** Point cloud in a slot of the buffer.
+	 * The points are not copied, they remain valid as long as the slot
+	 * has not been overwritten, check with is_valid().
+	 */
+	class Slot
+	{
+	public:
+		Slot();
+
+		uint64_t     sequence;   ///< sequence number of the point cloud
+		const void * data;       ///< points in shared memory
+		unsigned int width;      ///< width of the point cloud
+		unsigned int height;     ///< height of the point cloud
+		size_t       num_points; ///< number of points
+		std::string  frame_id;   ///< coordinate frame ID
+		Time         time;       ///< capture time
+	};
+
+	SharedMemoryPointCloudBuffer(const char * cloud_id,
+	                             const char * point_type,
+	                             size_t       point_size,
+	                             size_t       capacity,
+	                             unsigned int num_slots = 3);
+	SharedMemoryPointCloudBuffer(const char *cloud_id);
+	virtual ~SharedMemoryPointCloudBuffer();
+
+	const char * cloud_id() const;
+	const char * point_type() const;
+	size_t       point_size() const;
+	size_t       capacity() const;
+	unsigned int num_slots() const;
+
+	void *begin_write();
+	void  commit(unsigned int width,
+	             unsigned int height,
+	             size_t       num_points,
+	             const char * frame_id,
+	             const Time & time);
+	void  write(const void * points,
+	            unsigned int width,
+	            unsigned int height,
+	            size_t       num_points,
+	            const char * frame_id,
+	            const Time & time);
+
+	uint64_t sequence() const;
+	bool     latest(Slot &slot) const;
+	bool     is_valid(const Slot &slot) const;
+
+	template <typename PointT>
+	const PointT *points(const Slot &slot) const;
+
+	static std::list<std::string> list();
+	static bool                   exists(const char *cloud_id);
+	static void                   wipe(const char *cloud_id);
+
+private:
+	SharedMemoryPointCloudBuffer_slot_t *slot_header(unsigned int slot) const;
+	char *                               slot_data(unsigned int slot) const;
+
+	SharedMemoryPointCloudBufferHeader *   priv_header_;
+	SharedMemoryPointCloudBuffer_header_t *raw_header_;
+	size_t                                 slot_stride_;
+	std::string                            cloud_id_;
+};
+
+/** Get typed points of a slot.
+ * @param slot slot retrieved with latest()
+ * @return pointer to the points in shared memory
+ * @exception Exception thrown if the point size does not match
+ */
+template <typename PointT>
+const PointT *
+SharedMemoryPointCloudBuffer::points(const Slot &slot) const
+{
+	if (sizeof(PointT) != raw_header_->point_size) {
+		throw Exception("Point cloud %s has points of %u bytes, expected %zu",
+		                cloud_id_.c_str(),
+		                raw_header_->point_size,
+		                sizeof(PointT));
+	}
+	return static_cast<const PointT *>(slot.data);
+}
+
+} // end namespace fawkes
+
+#endif
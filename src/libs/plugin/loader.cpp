@@ -22,6 +22,7 @@
  */
 
 #include <plugin/loader.h>
+#include <utils/misc/string_split.h>
 #include <utils/system/dynamic_module/module.h>
 #include <utils/system/dynamic_module/module_manager.h>
 
@@ -340,6 +341,53 @@ PluginLoader::get_description(const char *plugin_name)
 #endif
 }
 
+/** Get plugin dependencies.
+ * The dependencies are declared in the plugin with PLUGIN_DEPENDS.
+ * @param plugin_name name of a loaded plugin
+ * @return names of the plugins the plugin depends on, empty if it does
+ * not declare any dependencies
+ * @throw PluginLoadException thrown if the plugin has not been loaded
+ */
+std::list<std::string>
+PluginLoader::get_dependencies(const char *plugin_name)
+{
+	std::map<std::string, Plugin *>::iterator p = d_->name_plugin_map.find(plugin_name);
+	if (p == d_->name_plugin_map.end()) {
+		throw PluginLoadException(plugin_name, "plugin has not been loaded");
+	}
+
+	std::list<std::string> rv;
+	Module *               module = d_->plugin_module_map[p->second];
+	if (module->has_symbol("plugin_depends")) {
+		PluginDependenciesFunc pdf = (PluginDependenciesFunc)module->get_symbol("plugin_depends");
+		std::vector<std::string> deps = str_split(pdf(), ',');
+		for (std::string &d : deps) {
+			d.erase(0, d.find_first_not_of(" \t"));
+			d.erase(d.find_last_not_of(" \t") + 1);
+			if (!d.empty())
+				rv.push_back(d);
+		}
+	}
+	return rv;
+}
+
+/** Check if a plugin declares its dependencies.
+ * A plugin declaring PLUGIN_DEPENDS, even with an empty list, does not
+ * rely on the order in which plugins are initialized.
+ * @param plugin_name name of a loaded plugin
+ * @return true if the plugin declares PLUGIN_DEPENDS, false otherwise
+ * @throw PluginLoadException thrown if the plugin has not been loaded
+ */
+bool
+PluginLoader::declares_dependencies(const char *plugin_name)
+{
+	std::map<std::string, Plugin *>::iterator p = d_->name_plugin_map.find(plugin_name);
+	if (p == d_->name_plugin_map.end()) {
+		throw PluginLoadException(plugin_name, "plugin has not been loaded");
+	}
+	return d_->plugin_module_map[p->second]->has_symbol("plugin_depends");
+}
+
 /** Check if a plugin is loaded.
  * @param plugin_name name of the plugin to chekc
  * @return true if the plugin is loaded, false otherwise
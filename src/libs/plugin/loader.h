@@ -27,6 +27,7 @@
 #include <core/exception.h>
 #include <core/plugin.h>
 
+#include <list>
 #include <string>
 
 namespace fawkes {
@@ -63,7 +64,9 @@ public:
 	Plugin *load(const char *plugin_name);
 	void    unload(Plugin *plugin);
 
-	std::string get_description(const char *plugin_name);
+	std::string            get_description(const char *plugin_name);
+	std::list<std::string> get_dependencies(const char *plugin_name);
+	bool                   declares_dependencies(const char *plugin_name);
 
 	bool is_loaded(const char *plugin_name);
 
@@ -27,20 +27,26 @@
 #include <core/threading/mutex_locker.h>
 #include <core/threading/thread_collector.h>
 #include <core/threading/thread_initializer.h>
+#include <core/threading/wait_condition.h>
 #include <logging/liblogger.h>
 #include <plugin/listener.h>
 #include <plugin/loader.h>
 #include <plugin/manager.h>
+#include <plugin/thread_aspect_info.h>
 #include <sys/types.h>
 #include <utils/misc/string_split.h>
 #include <utils/system/dynamic_module/module_manager.h>
 #include <utils/system/fam_thread.h>
+#include <utils/time/time.h>
 
 #include <algorithm>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <set>
+#include <thread>
+#include <vector>
 
 namespace fawkes {
 
@@ -61,6 +67,46 @@ public:
 private:
 	std::string name_;
 };
+
+// Initialization of a plugin when loading plugins concurrently
+class PluginInitTask
+{
+public:
+	PluginInitTask() : plugin(NULL), num_pending(0), done(false), failed(false)
+	{
+	}
+
+	std::string                     name;
+	Plugin *                        plugin;
+	std::set<size_t>                dependencies;
+	std::list<size_t>               dependents;
+	unsigned int                    num_pending;
+	bool                            done;
+	bool                            failed;
+	CannotInitializeThreadException error;
+	PluginManager::InitTiming       timing;
+};
+
+// true if task i depends on task j, directly or through other tasks
+static bool
+depends_on(const std::vector<PluginInitTask> &tasks, size_t i, size_t j)
+{
+	std::vector<bool> visited(tasks.size(), false);
+	std::list<size_t> open(1, i);
+	while (!open.empty()) {
+		size_t t = open.front();
+		open.pop_front();
+		for (size_t d : tasks[t].dependencies) {
+			if (d == j)
+				return true;
+			if (!visited[d]) {
+				visited[d] = true;
+				open.push_back(d);
+			}
+		}
+	}
+	return false;
+}
 /// @endcond INTERNALS
 
 /** @class PluginManager <plugin/manager.h>
@@ -68,6 +114,16 @@ private:
  * This class provides a manager for the plugins used in fawkes. It can
  * load and unload modules.
  *
+ * Plugins can be initialized concurrently on a number of worker threads
+ * given by the /fawkes/mainapp/plugin_init_threads config value, zero
+ * meaning one per CPU core. By default plugins are initialized one after
+ * another. A plugin is only initialized after the plugins it depends on,
+ * which it declares with PLUGIN_DEPENDS, and after plugins providing
+ * aspects that its threads require (if a ThreadAspectInfo is set). A
+ * plugin which does not declare PLUGIN_DEPENDS is initialized after all
+ * plugins preceding it in the list, unless one of them depends on it.
+ * The time it took to load and initialize each plugin is recorded.
+ *
  * @author Tim Niemueller
  */
 
@@ -96,6 +152,7 @@ PluginManager::PluginManager(ThreadCollector *   thread_collector,
 	next_plugin_id      = 1;
 	config_             = config;
 	meta_plugin_prefix_ = meta_plugin_prefix;
+	aspect_info_        = NULL;
 
 	if (init_cache) {
 		init_pinfo_cache();
@@ -156,6 +213,18 @@ PluginManager::set_module_flags(Module::ModuleFlags flags)
 	plugin_loader->get_module_manager()->set_open_flags(flags);
 }
 
+/** Set aspect information provider.
+ * If set, plugins providing aspects are initialized before the plugins
+ * whose threads require them, and initialization times are recorded per
+ * aspect.
+ * @param aspect_info aspect information provider, usually the aspect manager
+ */
+void
+PluginManager::set_thread_aspect_info(ThreadAspectInfo *aspect_info)
+{
+	aspect_info_ = aspect_info;
+}
+
 /** Initialize plugin info cache. */
 void
 PluginManager::init_pinfo_cache()
@@ -227,6 +296,43 @@ PluginManager::get_available_plugins()
 	return rv;
 }
 
+/** Get initialization times of loaded plugins.
+ * @return initialization timing of all loaded plugins in load order
+ */
+std::list<PluginManager::InitTiming>
+PluginManager::get_init_timings()
+{
+	MutexLocker lock(init_timings_.mutex());
+	return std::list<InitTiming>(init_timings_.begin(), init_timings_.end());
+}
+
+/** Record initialization timing of a plugin.
+ * @param plugin initialized plugin
+ * @param timing timing to record, aspect times are added
+ */
+void
+PluginManager::record_init_timing(Plugin *plugin, InitTiming &timing)
+{
+	if (aspect_info_) {
+		ThreadList &threads = plugin->threads();
+		for (ThreadList::iterator t = threads.begin(); t != threads.end(); ++t) {
+			std::map<std::string, long int> aspect_usec = aspect_info_->aspect_init_usec(*t);
+			for (const auto &a : aspect_usec) {
+				timing.aspect_usec[a.first] += a.second;
+			}
+		}
+	}
+
+	MutexLocker lock(init_timings_.mutex());
+	for (LockList<InitTiming>::iterator i = init_timings_.begin(); i != init_timings_.end(); ++i) {
+		if (i->plugin == timing.plugin) {
+			init_timings_.erase(i);
+			break;
+		}
+	}
+	init_timings_.push_back(timing);
+}
+
 /** Get list of loaded plugins.
  * @return list of names of real and meta plugins currently loaded
  */
@@ -329,12 +435,36 @@ PluginManager::load(const std::string &plugin_list)
 
 /** Load plugin.
  * The loading is interrupted if any of the plugins does not load properly.
- * The already loaded plugins are *not* unloaded, but kept.
+ * The already loaded plugins are *not* unloaded, but kept. When plugins
+ * are initialized concurrently, plugins which are initialized at the time
+ * of the failure are kept, too.
  * @param plugin_list string containing a comma-separated list of plugins
  * to load. The plugin list can contain meta plugins.
  */
 void
 PluginManager::load(const std::list<std::string> &plugin_list)
+{
+	unsigned int num_workers = 1;
+	try {
+		num_workers = config_->get_uint("/fawkes/mainapp/plugin_init_threads");
+		if (num_workers == 0) {
+			num_workers = std::max(1u, std::thread::hardware_concurrency());
+		}
+	} catch (Exception &e) {
+	} // ignored, use default
+
+	if (num_workers > 1) {
+		load_concurrently(plugin_list, num_workers);
+	} else {
+		load_sequentially(plugin_list);
+	}
+}
+
+/** Load and initialize plugins one after another.
+ * @param plugin_list list of plugins to load, may contain meta plugins
+ */
+void
+PluginManager::load_sequentially(const std::list<std::string> &plugin_list)
 {
 	for (std::list<std::string>::const_iterator i = plugin_list.begin(); i != plugin_list.end();
 	     ++i) {
@@ -374,7 +504,7 @@ PluginManager::load(const std::list<std::string> &plugin_list)
 					                    "Loading plugins %s for meta plugin %s",
 					                    str_join(pset.begin(), pset.end(), ",").c_str(),
 					                    i->c_str());
-					load(pset);
+					load_sequentially(pset);
 					LibLogger::log_debug("PluginManager", "Loaded meta plugin %s", i->c_str());
 					notify_loaded(i->c_str());
 				} catch (Exception &e) {
@@ -391,10 +521,19 @@ PluginManager::load(const std::list<std::string> &plugin_list)
 		    && (find_if(plugins.begin(), plugins.end(), plname_eq(*i)) == plugins.end())) {
 			try {
 				//printf("Going to load real plugin %s\n", i->c_str());
-				Plugin *plugin = plugin_loader->load(i->c_str());
+				InitTiming timing;
+				timing.plugin    = *i;
+				timing.wait_usec = 0;
+				Time start;
+				start.stamp_systime();
+				Plugin *plugin   = plugin_loader->load(i->c_str());
+				timing.load_usec = (Time().stamp_systime() - start).in_usec();
 				plugins.lock();
 				try {
+					start.stamp_systime();
 					thread_collector->add(plugin->threads());
+					timing.init_usec = (Time().stamp_systime() - start).in_usec();
+					record_init_timing(plugin, timing);
 					plugins.push_back(plugin);
 					plugin_ids[*i] = next_plugin_id++;
 					LibLogger::log_debug("PluginManager", "Loaded plugin %s", i->c_str());
@@ -418,6 +557,308 @@ PluginManager::load(const std::list<std::string> &plugin_list)
 	}
 }
 
+/** Resolve meta plugins in plugin list.
+ * Meta plugins are recorded as loaded, their children are resolved
+ * recursively.
+ * @param plugin_list list of plugins to load, may contain meta plugins
+ * @param real_plugins upon return contains the plugins to load which are
+ * not loaded, yet, in order of their first appearance
+ * @param meta_plugins upon return contains the newly recorded meta plugins,
+ * nested meta plugins before the meta plugins containing them
+ */
+void
+PluginManager::resolve_plugin_list(const std::list<std::string> &plugin_list,
+                                   std::list<std::string> &      real_plugins,
+                                   std::list<std::string> &      meta_plugins)
+{
+	for (const std::string &p : plugin_list) {
+		if (p.length() == 0 || meta_plugins_.find(p) != meta_plugins_.end())
+			continue;
+
+		std::string            meta_plugin = meta_plugin_prefix_ + p;
+		bool                   found_meta  = false;
+		std::list<std::string> pset;
+		try {
+			if (config_->is_list(meta_plugin.c_str())) {
+				std::vector<std::string> tmp = config_->get_strings(meta_plugin.c_str());
+				pset.insert(pset.end(), tmp.begin(), tmp.end());
+			} else
+				pset = parse_plugin_list(config_->get_string(meta_plugin.c_str()).c_str());
+			found_meta = true;
+		} catch (ConfigEntryNotFoundException &e) {
+			// no meta plugin defined by that name
+		}
+
+		if (found_meta) {
+			if (pset.size() == 0) {
+				throw Exception("Refusing to load an empty meta plugin");
+			}
+			// Setting has to happen here, so that a meta plugin will not cause an
+			// endless loop if it references itself!
+			meta_plugins_.lock();
+			meta_plugins_[p] = pset;
+			meta_plugins_.unlock();
+			LibLogger::log_info("PluginManager",
+			                    "Loading plugins %s for meta plugin %s",
+			                    str_join(pset.begin(), pset.end(), ",").c_str(),
+			                    p.c_str());
+			try {
+				resolve_plugin_list(pset, real_plugins, meta_plugins);
+			} catch (Exception &e) {
+				e.append("Could not initialize meta plugin %s, aborting loading.", p.c_str());
+				meta_plugins_.erase_locked(p);
+				throw;
+			}
+			meta_plugins.push_back(p);
+
+		} else if (find_if(plugins.begin(), plugins.end(), plname_eq(p)) == plugins.end()
+		           && std::find(real_plugins.begin(), real_plugins.end(), p) == real_plugins.end()) {
+			real_plugins.push_back(p);
+		}
+	}
+}
+
+/** Load plugins and initialize them concurrently.
+ * The modules are opened and the plugins created in order of the list.
+ * Then the plugins are initialized on a pool of worker threads, each
+ * plugin after all plugins it depends on. Plugins which do not declare
+ * their dependencies depend on the plugins preceding them in the list.
+ * @param plugin_list list of plugins to load, may contain meta plugins
+ * @param num_workers maximum number of plugins to initialize concurrently
+ */
+void
+PluginManager::load_concurrently(const std::list<std::string> &plugin_list,
+                                 unsigned int                  num_workers)
+{
+	std::list<std::string> names, new_meta_plugins;
+	try {
+		resolve_plugin_list(plugin_list, names, new_meta_plugins);
+	} catch (Exception &e) {
+		for (const std::string &m : new_meta_plugins) {
+			meta_plugins_.erase_locked(m);
+		}
+		throw;
+	}
+
+	std::vector<PluginInitTask>   tasks(names.size());
+	std::map<std::string, size_t> task_index;
+	try {
+		for (const std::string &n : names) {
+			size_t          i = task_index.size();
+			PluginInitTask &t = tasks[i];
+			task_index[n]     = i;
+			t.name            = n;
+			t.timing.plugin   = n;
+
+			Time start;
+			start.stamp_systime();
+			t.plugin           = plugin_loader->load(n.c_str());
+			t.timing.load_usec = (Time().stamp_systime() - start).in_usec();
+		}
+
+		std::map<std::string, size_t> aspect_providers;
+		if (aspect_info_) {
+			for (size_t i = 0; i < tasks.size(); ++i) {
+				ThreadList &threads = tasks[i].plugin->threads();
+				for (ThreadList::iterator t = threads.begin(); t != threads.end(); ++t) {
+					for (const std::string &a : aspect_info_->provided_aspects(*t)) {
+						aspect_providers.insert(std::make_pair(a, i));
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			PluginInitTask &t = tasks[i];
+			for (const std::string &d : plugin_loader->get_dependencies(t.name.c_str())) {
+				if (task_index.find(d) != task_index.end()) {
+					t.dependencies.insert(task_index[d]);
+				} else if (find_if(plugins.begin(), plugins.end(), plname_eq(d)) == plugins.end()) {
+					throw Exception("Plugin %s depends on plugin %s, which is not loaded",
+					                t.name.c_str(),
+					                d.c_str());
+				}
+			}
+			if (aspect_info_) {
+				ThreadList &threads = t.plugin->threads();
+				for (ThreadList::iterator th = threads.begin(); th != threads.end(); ++th) {
+					for (const std::string &a : aspect_info_->required_aspects(*th)) {
+						std::map<std::string, size_t>::iterator p = aspect_providers.find(a);
+						if (p != aspect_providers.end()) {
+							t.dependencies.insert(p->second);
+						}
+					}
+				}
+			}
+			t.dependencies.erase(i);
+		}
+
+		// plugins without declared dependencies may rely on the list order
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			if (plugin_loader->declares_dependencies(tasks[i].name.c_str()))
+				continue;
+			for (size_t j = 0; j < i; ++j) {
+				if (!depends_on(tasks, j, i))
+					tasks[i].dependencies.insert(j);
+			}
+		}
+
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			PluginInitTask &t = tasks[i];
+			t.num_pending     = t.dependencies.size();
+			for (size_t d : t.dependencies) {
+				tasks[d].dependents.push_back(i);
+			}
+		}
+
+		// all plugins must be reachable, otherwise there is a cycle
+		std::vector<unsigned int> num_pending(tasks.size());
+		std::list<size_t>         reachable;
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			num_pending[i] = tasks[i].num_pending;
+			if (num_pending[i] == 0)
+				reachable.push_back(i);
+		}
+		size_t num_reachable = 0;
+		for (std::list<size_t>::iterator i = reachable.begin(); i != reachable.end(); ++i) {
+			++num_reachable;
+			for (size_t d : tasks[*i].dependents) {
+				if (--num_pending[d] == 0)
+					reachable.push_back(d);
+			}
+		}
+		if (num_reachable < tasks.size()) {
+			std::list<std::string> cyclic;
+			for (size_t i = 0; i < tasks.size(); ++i) {
+				if (num_pending[i] > 0)
+					cyclic.push_back(tasks[i].name);
+			}
+			throw Exception("Cyclic dependencies among plugins %s",
+			                str_join(cyclic.begin(), cyclic.end(), ",").c_str());
+		}
+	} catch (Exception &e) {
+		for (PluginInitTask &t : tasks) {
+			if (t.plugin)
+				plugin_loader->unload(t.plugin);
+		}
+		for (const std::string &m : new_meta_plugins) {
+			meta_plugins_.erase_locked(m);
+		}
+		throw;
+	}
+
+	// Plugins which are ready are initialized in list order
+	Mutex            mutex;
+	WaitCondition    cond(&mutex);
+	std::set<size_t> ready;
+	unsigned int     running = 0;
+	bool             failed  = false;
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		if (tasks[i].num_pending == 0)
+			ready.insert(i);
+	}
+
+	Time init_start;
+	init_start.stamp_systime();
+	auto worker = [&]() {
+		MutexLocker lock(&mutex);
+		while (true) {
+			while (ready.empty() && running > 0 && !failed) {
+				cond.wait();
+			}
+			if (ready.empty() || failed)
+				break;
+
+			PluginInitTask &t = tasks[*ready.begin()];
+			ready.erase(ready.begin());
+			++running;
+			t.timing.wait_usec = (Time().stamp_systime() - init_start).in_usec();
+			lock.unlock();
+
+			Time start;
+			start.stamp_systime();
+			try {
+				thread_collector->add(t.plugin->threads());
+				t.done = true;
+			} catch (Exception &e) {
+				t.error.append(e);
+			} catch (std::exception &e) {
+				t.error.append("Caught std::exception: %s", e.what());
+			}
+			t.timing.init_usec = (Time().stamp_systime() - start).in_usec();
+
+			lock.relock();
+			--running;
+			if (t.done) {
+				for (size_t d : t.dependents) {
+					if (--tasks[d].num_pending == 0)
+						ready.insert(d);
+				}
+			} else {
+				t.failed = failed = true;
+			}
+			cond.wake_all();
+		}
+		cond.wake_all();
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < std::min<size_t>(num_workers, tasks.size()); ++i) {
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (std::thread &w : workers) {
+		w.join();
+	}
+
+	CannotInitializeThreadException error;
+	for (PluginInitTask &t : tasks) {
+		if (t.done) {
+			record_init_timing(t.plugin, t.timing);
+			plugins.lock();
+			plugins.push_back(t.plugin);
+			plugin_ids[t.name] = next_plugin_id++;
+			plugins.unlock();
+			LibLogger::log_debug("PluginManager",
+			                     "Loaded plugin %s (init %ld ms, waited %ld ms)",
+			                     t.name.c_str(),
+			                     t.timing.init_usec / 1000,
+			                     t.timing.wait_usec / 1000);
+			notify_loaded(t.name.c_str());
+		} else {
+			if (t.failed) {
+				error.append(t.error);
+				error.append("Plugin >>> %s <<< could not be initialized, unloading", t.name.c_str());
+			}
+			plugin_loader->unload(t.plugin);
+		}
+	}
+
+	for (const std::string &m : new_meta_plugins) {
+		bool                   complete = true;
+		meta_plugins_.lock();
+		std::list<std::string> children = meta_plugins_[m];
+		meta_plugins_.unlock();
+		for (const std::string &c : children) {
+			if (!is_loaded(c)) {
+				complete = false;
+				break;
+			}
+		}
+		if (complete) {
+			LibLogger::log_debug("PluginManager", "Loaded meta plugin %s", m.c_str());
+			notify_loaded(m.c_str());
+		} else {
+			error.append("Could not initialize meta plugin %s, aborting loading.", m.c_str());
+			meta_plugins_.erase_locked(m);
+		}
+	}
+
+	if (failed) {
+		throw error;
+	}
+}
+
 /** Unload plugin.
  * Note that this method does not allow to pass a list of plugins, but it will
  * only accept a single plugin at a time.
@@ -433,6 +874,15 @@ PluginManager::unload(const std::string &plugin_name)
 			plugin_loader->unload(*pit);
 			plugins.erase(pit);
 			plugin_ids.erase(plugin_name);
+			init_timings_.lock();
+			for (LockList<InitTiming>::iterator t = init_timings_.begin(); t != init_timings_.end();
+			     ++t) {
+				if (t->plugin == plugin_name) {
+					init_timings_.erase(t);
+					break;
+				}
+			}
+			init_timings_.unlock();
 			notify_unloaded(plugin_name.c_str());
 			// find all meta plugins that required this module, this can no longer
 			// be considered loaded
@@ -30,6 +30,8 @@
 #include <utils/system/dynamic_module/module.h>
 #include <utils/system/fam.h>
 
+#include <list>
+#include <map>
 #include <string>
 #include <utility>
 
@@ -43,10 +45,23 @@ class PluginListMessage;
 class Configuration;
 class FamThread;
 class PluginManagerListener;
+class ThreadAspectInfo;
 
 class PluginManager : public fawkes::ConfigurationChangeHandler, public FamListener
 {
 public:
+	/** Time spent loading and initializing a plugin. */
+	class InitTiming
+	{
+	public:
+		std::string plugin;    ///< plugin name
+		long int    load_usec; ///< time to open the module and create the plugin
+		long int    wait_usec; ///< time waiting for dependencies and a free worker
+		long int    init_usec; ///< time to initialize all threads, including aspects
+		/** Time to initialize each aspect, summed over all threads. */
+		std::map<std::string, long int> aspect_usec;
+	};
+
 	PluginManager(ThreadCollector *   thread_collector,
 	              Configuration *     config,
 	              const char *        meta_plugin_prefix,
@@ -55,6 +70,7 @@ public:
 	~PluginManager();
 
 	void set_module_flags(Module::ModuleFlags flags);
+	void set_thread_aspect_info(ThreadAspectInfo *aspect_info);
 	void init_pinfo_cache();
 
 	// for ConfigurationChangeHandler
@@ -77,6 +93,7 @@ public:
 
 	std::list<std::string>                         get_loaded_plugins();
 	std::list<std::pair<std::string, std::string>> get_available_plugins();
+	std::list<InitTiming>                          get_init_timings();
 
 	void add_listener(PluginManagerListener *listener);
 	void remove_listener(PluginManagerListener *listener);
@@ -91,6 +108,13 @@ private:
 
 	std::list<std::string> parse_plugin_list(const char *plugin_type_list);
 
+	void load_sequentially(const std::list<std::string> &plugin_list);
+	void load_concurrently(const std::list<std::string> &plugin_list, unsigned int num_workers);
+	void resolve_plugin_list(const std::list<std::string> &plugin_list,
+	                         std::list<std::string> &      real_plugins,
+	                         std::list<std::string> &      meta_plugins);
+	void record_init_timing(Plugin *plugin, InitTiming &timing);
+
 private:
 	ThreadCollector *thread_collector;
 	PluginLoader *   plugin_loader;
@@ -109,6 +133,9 @@ private:
 	LockList<std::pair<std::string, std::string>> pinfo_cache_;
 
 	LockList<PluginManagerListener *>           listeners_;
+
+	ThreadAspectInfo *   aspect_info_;
+	LockList<InitTiming> init_timings_;
 	LockList<PluginManagerListener *>::iterator lit_;
 
 	Configuration *config_;
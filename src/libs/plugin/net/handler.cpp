@@ -116,6 +116,25 @@ PluginNetworkHandler::list_loaded()
 	return m;
 }
 
+PluginListMessage *
+PluginNetworkHandler::list_timing()
+{
+	PluginListMessage *m = new PluginListMessage();
+
+	std::list<PluginManager::InitTiming> timings = manager_->get_init_timings();
+	for (const PluginManager::InitTiming &t : timings) {
+		std::string timing = std::to_string(t.load_usec) + " " + std::to_string(t.wait_usec) + " "
+		                     + std::to_string(t.init_usec);
+		for (const auto &a : t.aspect_usec) {
+			timing += " " + a.first + "=" + std::to_string(a.second);
+		}
+		m->append(t.plugin.c_str(), t.plugin.length());
+		m->append(timing.c_str(), timing.length());
+	}
+
+	return m;
+}
+
 void
 PluginNetworkHandler::send_load_failure(const char *plugin_name, unsigned int client_id)
 {
@@ -326,6 +345,15 @@ PluginNetworkHandler::loop()
 			}
 			break;
 
+		case MSG_PLUGIN_LIST_TIMING:
+			try {
+				PluginListMessage *plm = list_timing();
+				hub_->send(msg->clid(), FAWKES_CID_PLUGINMANAGER, MSG_PLUGIN_TIMING_LIST, plm);
+			} catch (Exception &e) {
+				hub_->send(msg->clid(), FAWKES_CID_PLUGINMANAGER, MSG_PLUGIN_TIMING_LIST_FAILED);
+			}
+			break;
+
 		case MSG_PLUGIN_SUBSCRIBE_WATCH:
 			subscribers_.lock();
 			subscribers_.push_back(msg->clid());
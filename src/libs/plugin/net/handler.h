@@ -68,6 +68,7 @@ public:
 private:
 	PluginListMessage *list_avail();
 	PluginListMessage *list_loaded();
+	PluginListMessage *list_timing();
 	void               send_load_failure(const char *plugin_name, unsigned int client_id);
 	void               send_load_success(const char *plugin_name, unsigned int client_id);
 	void               send_unload_failure(const char *plugin_name, unsigned int client_id);
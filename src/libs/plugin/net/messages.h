@@ -43,7 +43,10 @@ typedef enum {
 	MSG_PLUGIN_LOADED_LIST        = 11, /**< list of loaded plugins (plugin_list_msg_t) */
 	MSG_PLUGIN_LOADED_LIST_FAILED = 12, /**< listing loaded plugins failed */
 	MSG_PLUGIN_SUBSCRIBE_WATCH    = 13, /**< Subscribe for watching load/unload events */
-	MSG_PLUGIN_UNSUBSCRIBE_WATCH  = 14  /**< Unsubscribe from watching load/unload events */
+	MSG_PLUGIN_UNSUBSCRIBE_WATCH  = 14, /**< Unsubscribe from watching load/unload events */
+	MSG_PLUGIN_LIST_TIMING        = 15, /**< request initialization times of loaded plugins */
+	MSG_PLUGIN_TIMING_LIST        = 16, /**< initialization times (plugin_list_msg_t) */
+	MSG_PLUGIN_TIMING_LIST_FAILED = 17  /**< listing initialization times failed */
 } plugin_message_type_t;
 
 /** Maximum length of the plugin name field. */
@@ -94,7 +97,10 @@ typedef struct
 } plugin_unloaded_msg_t;
 
 /** Plugin list message.
- * Message type ID is MSG_PLUGIN_LIST.
+ * Message type ID is MSG_PLUGIN_AVAIL_LIST, MSG_PLUGIN_LOADED_LIST, or
+ * MSG_PLUGIN_TIMING_LIST. The timing list contains two entries per plugin,
+ * the plugin name and the times in microseconds formatted as
+ * "load wait init aspect=time ...".
  */
 typedef struct
 {
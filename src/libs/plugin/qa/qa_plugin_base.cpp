@@ -0,0 +1,40 @@
+
+/***************************************************************************
+ *  qa_plugin_base.cpp - QA plugin without dependencies
+ *
+ *  Created: Sun Oct 18 16:04:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "stub_plugin.h"
+
+using namespace fawkes;
+
+class QAPluginBase : public QAStubPlugin
+{
+public:
+	explicit QAPluginBase(Configuration *config) : QAStubPlugin(config, "qa_plugin_base")
+	{
+	}
+};
+
+PLUGIN_DESCRIPTION("QA plugin without dependencies")
+EXPORT_PLUGIN(QAPluginBase)
+
+/// @endcond
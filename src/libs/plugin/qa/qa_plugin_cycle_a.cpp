@@ -0,0 +1,41 @@
+
+/***************************************************************************
+ *  qa_plugin_cycle_a.cpp - QA plugin depending on qa_plugin_cycle_b
+ *
+ *  Created: Sun Oct 18 16:06:50 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "stub_plugin.h"
+
+using namespace fawkes;
+
+class QAPluginCycleA : public QAStubPlugin
+{
+public:
+	explicit QAPluginCycleA(Configuration *config) : QAStubPlugin(config, "qa_plugin_cycle_a")
+	{
+	}
+};
+
+PLUGIN_DESCRIPTION("QA plugin depending on qa_plugin_cycle_b")
+PLUGIN_DEPENDS("qa_plugin_cycle_b")
+EXPORT_PLUGIN(QAPluginCycleA)
+
+/// @endcond
@@ -0,0 +1,41 @@
+
+/***************************************************************************
+ *  qa_plugin_free.cpp - QA plugin declaring no dependencies
+ *
+ *  Created: Sun Oct 18 17:02:15 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "stub_plugin.h"
+
+using namespace fawkes;
+
+class QAPluginFree : public QAStubPlugin
+{
+public:
+	explicit QAPluginFree(Configuration *config) : QAStubPlugin(config, "qa_plugin_free")
+	{
+	}
+};
+
+PLUGIN_DESCRIPTION("QA plugin declaring an empty dependency list")
+PLUGIN_DEPENDS("")
+EXPORT_PLUGIN(QAPluginFree)
+
+/// @endcond
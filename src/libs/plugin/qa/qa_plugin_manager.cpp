@@ -0,0 +1,294 @@
+
+/***************************************************************************
+ *  qa_plugin_manager.cpp - QA for concurrent plugin loading
+ *
+ *  Created: Sun Oct 18 16:11:05 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <config/yaml.h>
+#include <core/exceptions/software.h>
+#include <core/threading/thread.h>
+#include <core/threading/thread_collector.h>
+#include <core/threading/thread_list.h>
+#include <plugin/listener.h>
+#include <plugin/manager.h>
+#include <utils/qa/qa_check.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/* Loads the stub plugins built alongside this QA with several plugin
+ * init threads and checks that the plugin manager rejects cyclic and
+ * missing dependencies, unwinds a load if a plugin fails to initialize,
+ * and reports a meta plugin as loaded once all of its plugins are. A
+ * plugin without declared dependencies must wait for the plugins listed
+ * before it.
+ */
+
+// relative includes are resolved against CONFDIR, the host file
+// include is therefore written with the absolute temporary path
+static const char *CONFIG_META = "%YAML 1.2\n"
+                                 "%TAG ! tag:fawkesrobotics.org,cfg/\n"
+                                 "---\n"
+                                 "include:\n"
+                                 "  - !host-specific ";
+
+// the meta plugin lists qa_plugin_dep first, it must still be
+// initialized after qa_plugin_base
+static const char *CONFIG = "\n"
+                            "---\n"
+                            "fawkes:\n"
+                            "  mainapp:\n"
+                            "    plugin_init_threads: 4\n"
+                            "  meta_plugins:\n"
+                            "    qa_meta: [qa_plugin_dep, qa_plugin_base]\n";
+
+// Records the threads added in order, fails the thread of a given plugin
+class QAThreadCollector : public ThreadCollector
+{
+public:
+	virtual void
+	add(ThreadList &tl)
+	{
+		for (ThreadList::iterator t = tl.begin(); t != tl.end(); ++t) {
+			add(*t);
+		}
+	}
+
+	virtual void
+	add(Thread *t)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			max_busy = std::max(max_busy, ++busy);
+		}
+		// keep the thread busy so that initializations can overlap
+		usleep(50000);
+		std::lock_guard<std::mutex> lock(mutex);
+		busy -= 1;
+		if (fail == t->name()) {
+			throw CannotInitializeThreadException("Thread %s failed on purpose", t->name());
+		}
+		added.push_back(t->name());
+	}
+
+	virtual void
+	remove(ThreadList &tl)
+	{
+		for (ThreadList::iterator t = tl.begin(); t != tl.end(); ++t) {
+			remove(*t);
+		}
+	}
+
+	virtual void
+	remove(Thread *t)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		added.remove(t->name());
+	}
+
+	virtual void
+	force_remove(ThreadList &tl)
+	{
+		remove(tl);
+	}
+
+	virtual void
+	force_remove(Thread *t)
+	{
+		remove(t);
+	}
+
+	bool
+	has(const std::string &name)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return std::find(added.begin(), added.end(), name) != added.end();
+	}
+
+	std::mutex             mutex;
+	std::list<std::string> added;
+	std::string            fail;
+	unsigned int           busy     = 0;
+	unsigned int           max_busy = 0;
+};
+
+class QAPluginListener : public PluginManagerListener
+{
+public:
+	virtual void
+	plugin_loaded(const char *plugin_name)
+	{
+		loaded.push_back(plugin_name);
+	}
+
+	virtual void
+	plugin_unloaded(const char *plugin_name)
+	{
+	}
+
+	std::list<std::string> loaded;
+};
+
+static bool
+load_throws(PluginManager &manager, const char *plugin_list)
+{
+	try {
+		manager.load(plugin_list);
+	} catch (Exception &e) {
+		return true;
+	}
+	return false;
+}
+
+static void
+unload_all(PluginManager &manager)
+{
+	std::list<std::string> loaded = manager.get_loaded_plugins();
+	// unload dependents before the plugins they depend on
+	loaded.sort();
+	loaded.reverse();
+	for (const std::string &p : loaded) {
+		if (!manager.is_meta_plugin(p))
+			manager.unload(p);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	char tmpdir[] = "/tmp/qa_plugin_manager_XXXXXX";
+	if (mkdtemp(tmpdir) == NULL) {
+		perror("Failed to create temporary directory");
+		return 1;
+	}
+	std::string config_file = std::string(tmpdir) + "/config.yaml";
+	std::string host_file   = std::string(tmpdir) + "/host.yaml";
+	FILE *      f           = fopen(config_file.c_str(), "w");
+	fputs(CONFIG_META, f);
+	fputs(host_file.c_str(), f);
+	fputs(CONFIG, f);
+	fclose(f);
+	f = fopen(host_file.c_str(), "w");
+	fputs("---\n", f);
+	fclose(f);
+
+	bool ok = true;
+	try {
+		YamlConfiguration config(tmpdir, tmpdir);
+		config.load("config.yaml");
+
+		QAThreadCollector collector;
+		QAPluginListener  listener;
+		PluginManager     manager(&collector,
+                              &config,
+                              "/fawkes/meta_plugins/",
+                              Module::MODULE_FLAGS_DEFAULT,
+                              /* init cache */ false);
+		manager.add_listener(&listener);
+
+		// cyclic dependencies are rejected before any plugin is initialized
+		ok &= qa::check(load_throws(manager, "qa_plugin_cycle_a,qa_plugin_cycle_b"),
+		                "cyclic dependencies accepted");
+		ok &= qa::check(manager.get_loaded_plugins().empty() && collector.added.empty(),
+		                "plugins loaded despite cyclic dependencies");
+
+		// a dependency must be loaded or loaded along
+		ok &= qa::check(load_throws(manager, "qa_plugin_dep"), "missing dependency accepted");
+		ok &= qa::check(manager.get_loaded_plugins().empty() && collector.added.empty(),
+		                "plugins loaded despite missing dependency");
+
+		// a failing plugin is unloaded, as is anything depending on it
+		collector.fail = "qa_plugin_base";
+		ok &= qa::check(load_throws(manager, "qa_meta"), "failed initialization not reported");
+		ok &= qa::check(!collector.has("qa_plugin_dep"), "dependent of failed plugin initialized");
+		ok &= qa::check(manager.get_loaded_plugins().empty(), "plugins kept after failure");
+		ok &= qa::check(!manager.is_loaded("qa_meta"), "incomplete meta plugin loaded");
+
+		// plugins initialized before the failure are kept
+		collector.fail = "qa_plugin_dep";
+		ok &= qa::check(load_throws(manager, "qa_meta"), "failed initialization not reported");
+		ok &= qa::check(manager.is_loaded("qa_plugin_base"), "initialized plugin unloaded");
+		ok &= qa::check(!manager.is_loaded("qa_plugin_dep"), "failed plugin loaded");
+		ok &= qa::check(!manager.is_loaded("qa_meta"), "incomplete meta plugin loaded");
+		unload_all(manager);
+		ok &= qa::check(collector.added.empty(), "threads left after unloading");
+
+		// meta plugin is complete once all of its plugins are initialized
+		collector.fail = "";
+		listener.loaded.clear();
+		try {
+			manager.load("qa_meta");
+		} catch (Exception &e) {
+			ok = qa::check(false, "loading meta plugin failed: %s", e.what_no_backtrace());
+		}
+		ok &= qa::check(manager.is_loaded("qa_plugin_base") && manager.is_loaded("qa_plugin_dep"),
+		                "plugins of meta plugin not loaded");
+		ok &= qa::check(manager.is_loaded("qa_meta"), "meta plugin not loaded");
+		ok &= qa::check(collector.added.size() == 2 && collector.added.front() == "qa_plugin_base",
+		                "dependency not initialized first");
+		ok &= qa::check(listener.loaded.size() == 3 && listener.loaded.back() == "qa_meta",
+		                "meta plugin not announced after its plugins");
+		unload_all(manager);
+
+		// list order is kept for plugins without declared dependencies
+		collector.max_busy = 0;
+		try {
+			manager.load("qa_plugin_free,qa_plugin_base");
+		} catch (Exception &e) {
+			ok = qa::check(false, "loading plugins failed: %s", e.what_no_backtrace());
+		}
+		ok &= qa::check(collector.added.size() == 2 && collector.added.front() == "qa_plugin_free",
+		                "list order not kept");
+		ok &= qa::check(collector.max_busy == 1, "plugin initialized before preceding plugin");
+		unload_all(manager);
+
+		// declared dependencies allow initializing plugins concurrently
+		collector.max_busy = 0;
+		try {
+			manager.load("qa_plugin_base,qa_plugin_free");
+		} catch (Exception &e) {
+			ok = qa::check(false, "loading plugins failed: %s", e.what_no_backtrace());
+		}
+		ok &= qa::check(collector.max_busy == 2, "independent plugins not initialized concurrently");
+		unload_all(manager);
+
+		manager.remove_listener(&listener);
+	} catch (Exception &e) {
+		ok = qa::check(false, "unexpected exception");
+		e.print_trace();
+	}
+
+	unlink(host_file.c_str());
+	unlink(config_file.c_str());
+	rmdir(tmpdir);
+
+	return qa::result(ok);
+}
+
+/// @endcond
@@ -0,0 +1,60 @@
+
+/***************************************************************************
+ *  stub_plugin.h - Stub plugin for plugin manager QA
+ *
+ *  Created: Sun Oct 18 16:02:41 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _LIBS_PLUGIN_QA_STUB_PLUGIN_H_
+#define _LIBS_PLUGIN_QA_STUB_PLUGIN_H_
+
+#include <core/plugin.h>
+#include <core/threading/thread.h>
+
+/// @cond QA
+
+/* Thread which does nothing, it is named after its plugin so that the
+ * QA thread collector can tell the plugins apart.
+ */
+class QAStubThread : public fawkes::Thread
+{
+public:
+	explicit QAStubThread(const char *plugin_name)
+	: fawkes::Thread(plugin_name, fawkes::Thread::OPMODE_WAITFORWAKEUP)
+	{
+	}
+
+	virtual void
+	loop()
+	{
+	}
+};
+
+/* Plugin with a single stub thread. */
+class QAStubPlugin : public fawkes::Plugin
+{
+public:
+	QAStubPlugin(fawkes::Configuration *config, const char *plugin_name) : fawkes::Plugin(config)
+	{
+		thread_list.push_back(new QAStubThread(plugin_name));
+	}
+};
+
+/// @endcond
+
+#endif
@@ -0,0 +1,59 @@
+
+/***************************************************************************
+ *  thread_aspect_info.cpp - Aspect information for plugin threads
+ *
+ *  Created: Sun Oct 18 15:40:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <plugin/thread_aspect_info.h>
+
+namespace fawkes {
+
+/** @class ThreadAspectInfo <plugin/thread_aspect_info.h>
+ * Aspect information for plugin threads.
+ * The plugin manager uses this interface, implemented by the aspect
+ * manager, to order the initialization of plugins by the aspects their
+ * threads require and provide, and to report how long the initialization
+ * of each aspect took.
+ * @author Tim Niemueller
+ *
+ * @fn virtual std::list<std::string> ThreadAspectInfo::required_aspects(Thread *thread)
+ * Get aspects of a thread.
+ * @param thread thread to query
+ * @return names of the aspects the thread has
+ *
+ * @fn virtual std::list<std::string> ThreadAspectInfo::provided_aspects(Thread *thread)
+ * Get aspects provided by a thread.
+ * @param thread thread to query
+ * @return names of the aspects the thread provides to other threads
+ * with the AspectProviderAspect
+ *
+ * @fn virtual std::map<std::string, long int> ThreadAspectInfo::aspect_init_usec(Thread *thread)
+ * Get aspect initialization times of a thread.
+ * @param thread initialized thread
+ * @return map from aspect name to the time it took to initialize the
+ * aspect for the thread in microseconds
+ */
+
+/** Virtual empty destructor. */
+ThreadAspectInfo::~ThreadAspectInfo()
+{
+}
+
+} // end namespace fawkes
@@ -0,0 +1,47 @@
+
+/***************************************************************************
+ *  thread_aspect_info.h - Aspect information for plugin threads
+ *
+ *  Created: Sun Oct 18 15:40:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _PLUGIN_THREAD_ASPECT_INFO_H_
+#define _PLUGIN_THREAD_ASPECT_INFO_H_
+
+#include <list>
+#include <map>
+#include <string>
+
+namespace fawkes {
+
+class Thread;
+
+class ThreadAspectInfo
+{
+public:
+	virtual ~ThreadAspectInfo();
+
+	virtual std::list<std::string>          required_aspects(Thread *thread)  = 0;
+	virtual std::list<std::string>          provided_aspects(Thread *thread)  = 0;
+	virtual std::map<std::string, long int> aspect_init_usec(Thread *thread) = 0;
+};
+
+} // end namespace fawkes
+
+#endif
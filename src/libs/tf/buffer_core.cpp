@@ -124,7 +124,7 @@ BufferCore::validate_frame_id(const char *function_name_arg, const std::string &
 /** Constructor
  * @param cache_time How long to keep a history of transforms in nanoseconds
  */
-BufferCore::BufferCore(float cache_time) : cache_time_(cache_time)
+BufferCore::BufferCore(float cache_time) : topology_generation_(0), cache_time_(cache_time)
 {
 	frameIDs_["NO_PARENT"] = 0;
 	frames_.push_back(TimeCacheInterfacePtr());
@@ -140,7 +140,8 @@ void
 BufferCore::clear()
 {
 	//old_tf_.clear();
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::unique_lock<std::shared_timed_mutex> lock(frame_mutex_);
+	++topology_generation_;
 	if (frames_.size() > 1) {
 		for (std::vector<TimeCacheInterfacePtr>::iterator cache_it = frames_.begin() + 1;
 		     cache_it != frames_.end();
@@ -214,15 +215,18 @@ BufferCore::set_transform(const StampedTransform &transform_in,
 		return false;
 
 	{
-		std::unique_lock<std::mutex> lock(frame_mutex_);
-		CompactFrameID        frame_number = lookup_or_insert_frame_number(stripped.child_frame_id);
-		TimeCacheInterfacePtr frame        = get_frame(frame_number);
+		std::unique_lock<std::shared_timed_mutex> lock(frame_mutex_);
+		CompactFrameID        frame_number  = lookup_or_insert_frame_number(stripped.child_frame_id);
+		CompactFrameID        parent_number = lookup_or_insert_frame_number(stripped.frame_id);
+		TimeCacheInterfacePtr frame         = get_frame(frame_number);
 		if (!frame)
 			frame = allocate_frame(frame_number, is_static);
 
-		if (frame->insert_data(TransformStorage(stripped,
-		                                        lookup_or_insert_frame_number(stripped.frame_id),
-		                                        frame_number))) {
+		// cached frame chains are invalid if the frame changes its parent
+		if (frame->get_latest_time_and_parent().second != parent_number)
+			++topology_generation_;
+
+		if (frame->insert_data(TransformStorage(stripped, parent_number, frame_number))) {
 			frame_authority_[frame_number] = authority;
 		} else {
 			printf("TF_OLD_DATA ignoring data from the past for frame %s "
@@ -265,6 +269,148 @@ enum WalkEnding {
 	FullPath,
 };
 
+/** Get resolved chain of frames between two frames.
+ * The chain is taken from the cache if it has been resolved before and the
+ * tree topology did not change since. Otherwise it is determined by walking
+ * the tree along the latest parent of each frame and added to the cache.
+ * Must be called with the frame mutex held.
+ * @param target_id frame number of target
+ * @param source_id frame number of source
+ * @return frame chain, NULL if the frames are not connected
+ */
+std::shared_ptr<const BufferCore::FrameChain>
+BufferCore::get_frame_chain(CompactFrameID target_id, CompactFrameID source_id) const
+{
+	uint64_t key   = ((uint64_t)target_id << 32) | source_id;
+	bool     stale = false;
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(chain_cache_mutex_);
+		M_FrameChainCache::const_iterator c = chain_cache_.find(key);
+		if (c != chain_cache_.end()) {
+			if (c->second->generation == topology_generation_)
+				return c->second;
+			stale = true;
+		}
+	}
+
+	// Walk the tree to its root from the source frame
+	std::vector<CompactFrameID> source_to_root;
+	CompactFrameID              frame = source_id;
+	while (frame != 0) {
+		if (source_to_root.size() > MAX_GRAPH_DEPTH)
+			return std::shared_ptr<const FrameChain>();
+		source_to_root.push_back(frame);
+		TimeCacheInterfacePtr cache = get_frame(frame);
+		if (!cache || frame == target_id)
+			break;
+		frame = cache->get_latest_time_and_parent().second;
+	}
+
+	// Now walk from the target frame until reaching a frame on the source path
+	std::shared_ptr<FrameChain> chain(new FrameChain());
+	chain->generation    = topology_generation_;
+	chain->common_parent = 0;
+	frame                = target_id;
+	while (frame != 0) {
+		std::vector<CompactFrameID>::iterator s =
+		  std::find(source_to_root.begin(), source_to_root.end(), frame);
+		if (s != source_to_root.end()) {
+			chain->common_parent = frame;
+			chain->source_chain.assign(source_to_root.begin(), s);
+			break;
+		}
+		if (chain->target_chain.size() > MAX_GRAPH_DEPTH)
+			break;
+		chain->target_chain.push_back(frame);
+		TimeCacheInterfacePtr cache = get_frame(frame);
+		if (!cache)
+			break;
+		frame = cache->get_latest_time_and_parent().second;
+	}
+	if (chain->common_parent == 0)
+		return std::shared_ptr<const FrameChain>();
+
+	std::unique_lock<std::shared_timed_mutex> lock(chain_cache_mutex_);
+	// a stale entry means the topology changed, all other entries are stale as well
+	if (stale)
+		chain_cache_.clear();
+	chain_cache_[key] = chain;
+	return chain;
+}
+
+/** Walk along a resolved frame chain.
+ * This accumulates the transforms along the given chain without searching
+ * the tree. The parent of each frame at the requested time is compared to
+ * the chain. If it differs, e.g. because the tree had a different shape at
+ * that time, or data is missing, the walk is aborted and the accumulator is
+ * left in an undefined state.
+ * @param f accumulator
+ * @param time timestamp
+ * @param target_id frame number of target
+ * @param source_id frame number of source
+ * @param chain resolved frame chain from source to target
+ * @return true if the walk succeeded, false to fall back to the full tree walk
+ */
+template <typename F>
+bool
+BufferCore::walk_frame_chain(F &               f,
+                             fawkes::Time      time,
+                             CompactFrameID    target_id,
+                             CompactFrameID    source_id,
+                             const FrameChain &chain) const
+{
+	const std::vector<CompactFrameID> &sc = chain.source_chain;
+	const std::vector<CompactFrameID> &tc = chain.target_chain;
+
+	//If getting the latest get the latest common time
+	if (time == fawkes::Time(0, 0)) {
+		fawkes::Time common_time = fawkes::TIME_MAX;
+		for (const std::vector<CompactFrameID> *c : {&sc, &tc}) {
+			for (size_t i = 0; i < c->size(); ++i) {
+				TimeCacheInterfacePtr cache = get_frame((*c)[i]);
+				if (!cache)
+					return false;
+				P_TimeAndFrameID latest = cache->get_latest_time_and_parent();
+				if (latest.second != ((i + 1 < c->size()) ? (*c)[i + 1] : chain.common_parent))
+					return false;
+				if (!latest.first.is_zero())
+					common_time = std::min(latest.first, common_time);
+			}
+		}
+		if (common_time != fawkes::TIME_MAX)
+			time = common_time;
+	}
+
+	for (size_t i = 0; i < sc.size(); ++i) {
+		TimeCacheInterfacePtr cache = get_frame(sc[i]);
+		if (!cache
+		    || f.gather(cache, time, NULL)
+		         != ((i + 1 < sc.size()) ? sc[i + 1] : chain.common_parent)) {
+			return false;
+		}
+		f.accum(true);
+	}
+
+	for (size_t i = 0; i < tc.size(); ++i) {
+		TimeCacheInterfacePtr cache = get_frame(tc[i]);
+		if (!cache
+		    || f.gather(cache, time, NULL)
+		         != ((i + 1 < tc.size()) ? tc[i + 1] : chain.common_parent)) {
+			return false;
+		}
+		f.accum(false);
+	}
+
+	if (chain.common_parent == target_id) {
+		f.finalize(TargetParentOfSource, time);
+	} else if (chain.common_parent == source_id) {
+		f.finalize(SourceParentOfTarget, time);
+	} else {
+		f.finalize(FullPath, time);
+	}
+	return true;
+}
+
 /** Traverse transform tree: walk from frame to top-parent of both.
  * @param f accumulator
  * @param time timestamp
@@ -312,6 +458,18 @@ BufferCore::walk_to_top_parent(F &                          f,
 		return NO_ERROR;
 	}
 
+	// Fast path, walk along the cached frame chain
+	if (!frame_chain) {
+		std::shared_ptr<const FrameChain> chain = get_frame_chain(target_id, source_id);
+		if (chain) {
+			F chain_f(f);
+			if (walk_frame_chain(chain_f, time, target_id, source_id, *chain)) {
+				f = chain_f;
+				return NO_ERROR;
+			}
+		}
+	}
+
 	//If getting the latest get the latest common time
 	if (time == fawkes::Time(0, 0)) {
 		int retval = get_latest_common_time(target_id, source_id, time, error_string);
@@ -556,7 +714,7 @@ BufferCore::lookup_transform(const std::string & target_frame,
                              const fawkes::Time &time,
                              StampedTransform &  transform) const
 {
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 
 	if (target_frame == source_frame) {
 		transform.setIdentity();
@@ -708,7 +866,7 @@ BufferCore::can_transform_internal(CompactFrameID      target_id,
                                    const fawkes::Time &time,
                                    std::string *       error_msg) const
 {
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 	return can_transform_no_lock(target_id, source_id, time, error_msg);
 }
 
@@ -734,7 +892,7 @@ BufferCore::can_transform(const std::string & target_frame,
 	if (warn_frame_id("canTransform argument source_frame", source_frame))
 		return false;
 
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 
 	CompactFrameID target_id = lookup_frame_number(target_frame);
 	CompactFrameID source_id = lookup_frame_number(source_frame);
@@ -863,7 +1021,7 @@ BufferCore::create_connectivity_error_string(CompactFrameID source_frame,
 std::string
 BufferCore::all_frames_as_string() const
 {
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 	return this->all_frames_as_string_no_lock();
 }
 
@@ -1091,8 +1249,8 @@ BufferCore::get_latest_common_time(CompactFrameID target_id,
 std::string
 BufferCore::all_frames_as_YAML(double current_time) const
 {
-	std::stringstream            mstream;
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::stringstream                         mstream;
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 
 	TransformStorage temp;
 
@@ -59,6 +59,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -171,8 +172,35 @@ protected:
    * first time. */
 	V_TimeCacheInterface frames_;
 
-	/** \brief A mutex to protect testing and allocating new frames on the above vector. */
-	mutable std::mutex frame_mutex_;
+	/** \brief A mutex to protect testing and allocating new frames on the above vector.
+   * Lookups hold a shared lock, adding frames and transforms an exclusive lock. */
+	mutable std::shared_timed_mutex frame_mutex_;
+
+	/** Resolved chain of frames between a source and target frame.
+   * The chain is determined from the latest parent of each frame and
+   * verified on use, when a transform is looked up at a time for which a
+   * frame had a different parent the full tree walk is performed instead. */
+	typedef struct
+	{
+		/// topology generation the chain has been created in
+		unsigned int generation;
+		/// frames from source frame up to, excluding, the common parent
+		std::vector<CompactFrameID> source_chain;
+		/// frames from target frame up to, excluding, the common parent
+		std::vector<CompactFrameID> target_chain;
+		/// common parent of source and target frame
+		CompactFrameID common_parent;
+	} FrameChain;
+	/// Map from (target, source) frame number pair to frame chain.
+	typedef std::unordered_map<uint64_t, std::shared_ptr<const FrameChain>> M_FrameChainCache;
+	/// Cache of resolved frame chains.
+	mutable M_FrameChainCache chain_cache_;
+	/// Mutex to protect the frame chain cache.
+	mutable std::shared_timed_mutex chain_cache_mutex_;
+	/** Generation of the tree topology, incremented whenever a frame is
+   * added or changes its parent. Modified only with frame_mutex_ held
+   * exclusively. */
+	unsigned int topology_generation_;
 
 	/** \brief A map from string frame ids to CompactFrameID */
 	typedef std::unordered_map<std::string, CompactFrameID> M_StringToCompactFrameID;
@@ -229,6 +257,16 @@ protected:
 	                       std::string *                error_string,
 	                       std::vector<CompactFrameID> *frame_chain) const;
 
+	std::shared_ptr<const FrameChain> get_frame_chain(CompactFrameID target_id,
+	                                                  CompactFrameID source_id) const;
+
+	template <typename F>
+	bool walk_frame_chain(F &               f,
+	                      fawkes::Time      time,
+	                      CompactFrameID    target_id,
+	                      CompactFrameID    source_id,
+	                      const FrameChain &chain) const;
+
 	bool can_transform_internal(CompactFrameID      target_id,
 	                            CompactFrameID      source_id,
 	                            const fawkes::Time &time,
@@ -0,0 +1,240 @@
+/***************************************************************************
+ *  qa_tf_timecache.cpp - tf time cache benchmark QA
+ *
+ *  Created: Sat Oct 17 19:04:21 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+// Do not include in api reference
+///@cond QA
+
+#include <tf/time_cache.h>
+#include <utils/qa/qa_check.h>
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+using namespace fawkes;
+using namespace fawkes::tf;
+
+/* Compares the ring buffer based TimeCache to the linked list based
+ * implementation it replaced. Transforms are inserted at a fixed rate with
+ * some jitter, occasionally out of order, then random lookups within the
+ * cached time window are performed. Results of both caches must match.
+ */
+
+// Linked list cache as used before, newest element first
+class ListTimeCache
+{
+public:
+	ListTimeCache(float max_storage_time) : max_storage_time_(max_storage_time)
+	{
+	}
+
+	bool
+	insert_data(const TransformStorage &new_data)
+	{
+		std::list<TransformStorage>::iterator storage_it = storage_.begin();
+		if (storage_it != storage_.end()) {
+			if (storage_it->stamp > new_data.stamp + max_storage_time_)
+				return false;
+		}
+		while (storage_it != storage_.end()) {
+			if (storage_it->stamp <= new_data.stamp)
+				break;
+			storage_it++;
+		}
+		storage_.insert(storage_it, new_data);
+
+		fawkes::Time latest_time = storage_.begin()->stamp;
+		while (!storage_.empty() && storage_.back().stamp + max_storage_time_ < latest_time) {
+			storage_.pop_back();
+		}
+		return true;
+	}
+
+	bool
+	get_data(fawkes::Time time, TransformStorage &data_out)
+	{
+		if (storage_.empty())
+			return false;
+		if (time.is_zero()) {
+			data_out = storage_.front();
+			return true;
+		}
+		if (++storage_.begin() == storage_.end()) {
+			if (storage_.front().stamp != time)
+				return false;
+			data_out = storage_.front();
+			return true;
+		}
+		fawkes::Time latest_time   = storage_.front().stamp;
+		fawkes::Time earliest_time = storage_.back().stamp;
+		if (time == latest_time) {
+			data_out = storage_.front();
+			return true;
+		} else if (time == earliest_time) {
+			data_out = storage_.back();
+			return true;
+		} else if (time > latest_time || time < earliest_time) {
+			return false;
+		}
+
+		std::list<TransformStorage>::iterator storage_it = storage_.begin();
+		while (storage_it != storage_.end()) {
+			if (storage_it->stamp <= time)
+				break;
+			storage_it++;
+		}
+		TransformStorage &one = *storage_it;
+		TransformStorage &two = *(--storage_it);
+		if (one.frame_id != two.frame_id || one.stamp == two.stamp) {
+			data_out = (one.frame_id != two.frame_id) ? one : two;
+			return true;
+		}
+		btScalar ratio =
+		  (time.in_sec() - one.stamp.in_sec()) / (two.stamp.in_sec() - one.stamp.in_sec());
+		data_out.translation.setInterpolate3(one.translation, two.translation, ratio);
+		data_out.rotation       = slerp(one.rotation, two.rotation, ratio);
+		data_out.stamp          = one.stamp;
+		data_out.frame_id       = one.frame_id;
+		data_out.child_frame_id = one.child_frame_id;
+		return true;
+	}
+
+	unsigned int
+	get_list_length() const
+	{
+		return storage_.size();
+	}
+
+private:
+	std::list<TransformStorage> storage_;
+	float                       max_storage_time_;
+};
+
+static std::vector<TransformStorage>
+generate_data(unsigned int num, unsigned int rate_hz)
+{
+	std::vector<TransformStorage> data(num);
+	long int                      period_usec = 1000000 / rate_hz;
+	for (unsigned int i = 0; i < num; ++i) {
+		long int usec = 1000000 + (long int)i * period_usec + (rand() % (period_usec / 4));
+
+		data[i].stamp          = fawkes::Time(usec / 1000000, usec % 1000000);
+		data[i].translation    = Vector3(i, 0, 0);
+		data[i].rotation       = Quaternion(0, 0, 0, 1);
+		data[i].frame_id       = 1;
+		data[i].child_frame_id = 2;
+	}
+	// every 16th transform arrives late, i.e. after its successor
+	for (unsigned int i = 16; i < num; i += 16) {
+		std::swap(data[i - 1], data[i]);
+	}
+	return data;
+}
+
+static std::vector<fawkes::Time>
+generate_queries(const std::vector<TransformStorage> &data,
+                 unsigned int                         num_queries,
+                 float                                window_sec)
+{
+	std::vector<fawkes::Time> queries(num_queries);
+	const fawkes::Time &      latest      = data.back().stamp;
+	long int                  window_usec = (long int)(window_sec * 1000000);
+	for (unsigned int i = 0; i < num_queries; ++i) {
+		queries[i] = latest - (double)(rand() % window_usec) / 1000000.;
+	}
+	return queries;
+}
+
+template <class Cache>
+static void
+bench(const char *                         name,
+      Cache &                              cache,
+      const std::vector<TransformStorage> &data,
+      const std::vector<fawkes::Time> &    queries,
+      std::vector<TransformStorage> &      results)
+{
+	fawkes::Time start;
+	for (const TransformStorage &d : data) {
+		cache.insert_data(d);
+	}
+	fawkes::Time inserted;
+	results.resize(queries.size());
+	unsigned int num_found = 0;
+	for (size_t i = 0; i < queries.size(); ++i) {
+		if (cache.get_data(queries[i], results[i]))
+			++num_found;
+	}
+	fawkes::Time end;
+
+	double insert_sec = inserted - &start;
+	double lookup_sec = end - &inserted;
+	printf("%-14s  length: %6u  insert: %8.1f ns/op  lookup: %8.1f ns/op  found: %u/%zu\n",
+	       name,
+	       cache.get_list_length(),
+	       insert_sec / data.size() * 1e9,
+	       lookup_sec / queries.size() * 1e9,
+	       num_found,
+	       queries.size());
+}
+
+int
+main(int argc, char **argv)
+{
+	float        cache_sec   = (argc > 1) ? atof(argv[1]) : 10.;
+	unsigned int rate_hz     = (argc > 2) ? atoi(argv[2]) : 100;
+	unsigned int num_inserts = (argc > 3) ? atoi(argv[3]) : 200000;
+	unsigned int num_queries = (argc > 4) ? atoi(argv[4]) : 200000;
+
+	srand(42);
+	std::vector<TransformStorage> data    = generate_data(num_inserts, rate_hz);
+	std::vector<fawkes::Time>     queries = generate_queries(data, num_queries, cache_sec * 0.9);
+
+	printf("Cache time %.1f sec, %u Hz, %u inserts, %u lookups\n",
+	       cache_sec,
+	       rate_hz,
+	       num_inserts,
+	       num_queries);
+
+	std::vector<TransformStorage> list_results, ring_results;
+	ListTimeCache                 list_cache(cache_sec);
+	TimeCache                     ring_cache(cache_sec);
+	bench("ListTimeCache", list_cache, data, queries, list_results);
+	bench("TimeCache", ring_cache, data, queries, ring_results);
+
+	unsigned int num_mismatch = 0;
+	for (size_t i = 0; i < queries.size(); ++i) {
+		if (list_results[i].stamp != ring_results[i].stamp
+		    || list_results[i].translation.x() != ring_results[i].translation.x()) {
+			++num_mismatch;
+		}
+	}
+	bool ok = qa::check(num_mismatch == 0
+	                      && list_cache.get_list_length() == ring_cache.get_list_length(),
+	                    "%u lookups differ between caches",
+	                    num_mismatch);
+
+	return qa::result(ok);
+}
+
+/// @endcond
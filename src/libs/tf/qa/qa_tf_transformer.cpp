@@ -25,11 +25,135 @@
 ///@cond QA
 
 #include <tf/transformer.h>
+#include <utils/qa/qa_check.h>
 
+#include <cmath>
 #include <cstdio>
+#include <vector>
 
 using namespace fawkes::tf;
 
+static bool
+check_close(const char *   what,
+            size_t         i,
+            const Vector3 &expected,
+            float          x,
+            float          y,
+            float          z,
+            double         eps)
+{
+	return fawkes::qa::check(std::fabs(expected.x() - x) <= eps
+	                           && std::fabs(expected.y() - y) <= eps
+	                           && std::fabs(expected.z() - z) <= eps,
+	                         "%s point %zu is (%f,%f,%f), expected (%f,%f,%f)",
+	                         what,
+	                         i,
+	                         x,
+	                         y,
+	                         z,
+	                         expected.x(),
+	                         expected.y(),
+	                         expected.z());
+}
+
+/* Compares the batch transformation functions to transforming each
+ * point or pose on its own. A static laser frame is mounted on the
+ * robot, which moves and turns in the odometry frame.
+ */
+static bool
+check_batch_transforms()
+{
+	Transformer  transformer;
+	fawkes::Time start;
+	fawkes::Time end = start + 0.1;
+
+	transformer.set_transform(StampedTransform(Transform(create_quaternion_from_yaw(0.3),
+	                                                     Vector3(0.2, 0.05, 0.4)),
+	                                           start,
+	                                           "base_link",
+	                                           "laser"),
+	                          "qa",
+	                          true);
+	transformer.set_transform(StampedTransform(Transform(create_quaternion_from_yaw(0.0),
+	                                                     Vector3(1.0, 2.0, 0.0)),
+	                                           start,
+	                                           "odom",
+	                                           "base_link"),
+	                          "qa");
+	transformer.set_transform(StampedTransform(Transform(create_quaternion_from_yaw(0.1),
+	                                                     Vector3(1.1, 2.05, 0.0)),
+	                                           end,
+	                                           "odom",
+	                                           "base_link"),
+	                          "qa");
+
+	// more points than an interpolation segment, not a multiple of it
+	const size_t       num_points = 721;
+	std::vector<float> x(num_points), y(num_points), z(num_points);
+	for (size_t i = 0; i < num_points; ++i) {
+		float angle  = -M_PI + 2 * M_PI * i / num_points;
+		float length = 0.5 + (i % 37) * 0.1;
+		x[i]         = length * cosf(angle);
+		y[i]         = length * sinf(angle);
+		z[i]         = (i % 5) * 0.01;
+	}
+	std::vector<float> xo(num_points), yo(num_points), zo(num_points);
+	bool               ok = true;
+
+	// static frame
+	transformer.transform_points(
+	  "base_link", "laser", start, num_points, &x[0], &y[0], &z[0], &xo[0], &yo[0], &zo[0]);
+	for (size_t i = 0; i < num_points; ++i) {
+		Stamped<Point> in(Point(x[i], y[i], z[i]), start, "laser"), out;
+		transformer.transform_point("base_link", in, out);
+		ok &= check_close("static", i, out, xo[i], yo[i], zo[i], 1e-4);
+	}
+
+	// interpolated over time range, in place; the transform from laser to
+	// odom is interpolated as a whole, the laser origin moves on the chord
+	// instead of the arc, i.e., by less than 0.21 m * 0.1^2 / 8 off
+	std::vector<float> xi(x), yi(y), zi(z);
+	transformer.transform_points(
+	  "odom", "laser", start, end, num_points, &xi[0], &yi[0], &zi[0], &xi[0], &yi[0], &zi[0]);
+	for (size_t i = 0; i < num_points; ++i) {
+		fawkes::Time   t = start + 0.1 * i / (num_points - 1);
+		Stamped<Point> in(Point(x[i], y[i], z[i]), t, "laser"), out;
+		transformer.transform_point("odom", in, out);
+		ok &= check_close("interpolated", i, out, xi[i], yi[i], zi[i], 1e-3);
+	}
+
+	// stamped points and poses with changing frames and times
+	std::vector<Stamped<Point>> points_in, points_out;
+	std::vector<Stamped<Pose>>  poses_in, poses_out;
+	for (size_t i = 0; i < 20; ++i) {
+		fawkes::Time t     = start + 0.01 * (i / 4);
+		const char * frame = (i % 8 < 4) ? "laser" : "base_link";
+		points_in.push_back(Stamped<Point>(Point(x[i], y[i], z[i]), t, frame));
+		poses_in.push_back(
+		  Stamped<Pose>(Pose(create_quaternion_from_yaw(0.1 * i), Point(x[i], y[i], z[i])), t, frame));
+	}
+	transformer.transform_points("odom", points_in, points_out);
+	transformer.transform_poses("odom", poses_in, poses_out);
+	for (size_t i = 0; i < points_in.size(); ++i) {
+		Stamped<Point> p;
+		transformer.transform_point("odom", points_in[i], p);
+		const Vector3 &po = points_out[i];
+		ok &= check_close("stamped", i, p, po.x(), po.y(), po.z(), 1e-6);
+		Stamped<Pose> q;
+		transformer.transform_pose("odom", poses_in[i], q);
+		const Vector3 &o = poses_out[i].getOrigin();
+		ok &= check_close("pose", i, q.getOrigin(), o.x(), o.y(), o.z(), 1e-6);
+		double angle = q.getRotation().angleShortestPath(poses_out[i].getRotation());
+		ok &= fawkes::qa::check(std::fabs(angle) <= 1e-6, "pose %zu rotation differs", i);
+		ok &= fawkes::qa::check(points_out[i].frame_id == "odom"
+		                          && poses_out[i].stamp == poses_in[i].stamp,
+		                        "stamped %zu has wrong frame or time",
+		                        i);
+	}
+
+	return ok;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -44,11 +168,11 @@ main(int argc, char **argv)
 
 	printf("Setting transform\n");
 	Transformer transformer;
-	transformer.set_transform(st);
+	transformer.set_transform(st, "qa");
 
 	printf("Looking up transform\n");
 	StampedTransform res;
-	transformer.lookupTransform("/robot", "/world", time, res);
+	transformer.lookup_transform("/robot", "/world", time, res);
 
 	Quaternion res_q(res.getRotation());
 	Vector3    res_v(res.getOrigin());
@@ -60,9 +184,9 @@ main(int argc, char **argv)
 	       res_v.x(),
 	       res_v.y(),
 	       res_v.z());
-	printf("Done\n");
 
-	return 0;
+	printf("Checking batch transforms\n");
+	return fawkes::qa::result(check_batch_transforms());
 }
 
 /// @endcond
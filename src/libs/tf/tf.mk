@@ -41,9 +41,9 @@ else
   endif
 endif
 
-ifeq ($(HAVE_BULLET)$(HAVE_CPP11),11)
+ifeq ($(HAVE_BULLET)$(HAVE_CPP14),11)
   HAVE_TF = 1
-  CFLAGS_TF  = -DHAVE_TF $(CFLAGS_BULLET) $(CFLAGS_CPP11) \
+  CFLAGS_TF  = -DHAVE_TF $(CFLAGS_BULLET) $(CFLAGS_CPP14) \
 	       -DBT_USE_DOUBLE_PRECISION -DBT_EULER_DEFAULT_ZYX
   LDFLAGS_TF = $(LDFLAGS_BULLET) -lm
 endif
@@ -143,15 +143,22 @@ TransformStorage::TransformStorage(const StampedTransform &data,
 
 /** @class TimeCache <tf/time_cache.h>
  * Time based transform cache.
- * A class to keep a sorted linked list in time. This builds and
- * maintains a list of timestamped data.  And provides lookup
- * functions to get data out as a function of time.
+ * A class to keep data sorted in time. This builds and maintains a list
+ * of timestamped data.  And provides lookup functions to get data out as
+ * a function of time.
+ *
+ * The data is stored in a ring buffer sorted by time, the oldest element
+ * first. Lookups use a binary search on the time stamps. The ring buffer
+ * has a capacity of a power of two and doubles its size when full, it is
+ * never shrunk. Once it has grown to the size required for the
+ * configured storage time, inserting data no longer allocates memory.
  */
 
 /** Constructor.
  * @param max_storage_time maximum time in seconds to cache, defaults to 10 seconds
  */
-TimeCache::TimeCache(float max_storage_time) : max_storage_time_(max_storage_time)
+TimeCache::TimeCache(float max_storage_time)
+: first_(0), length_(0), mask_(0), max_storage_time_(max_storage_time)
 {
 }
 
@@ -234,6 +241,43 @@ create_extrapolation_exception3(fawkes::Time t0, fawkes::Time t1, std::string *e
 	}
 }
 
+/** Find first element newer than the given time.
+ * @param time time to search for
+ * @return chronological index of the first element with a time stamp
+ * greater than @p time, length_ if there is no such element
+ */
+size_t
+TimeCache::upper_bound(const fawkes::Time &time) const
+{
+	size_t lo = 0, hi = length_;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (time < at(mid).stamp) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+/** Double the capacity of the ring buffer.
+ * Elements are re-ordered such that the oldest element is at the front.
+ */
+void
+TimeCache::grow()
+{
+	size_t capacity = storage_.empty() ? 16 : storage_.size() * 2;
+
+	std::vector<TransformStorage> new_storage(capacity);
+	for (size_t i = 0; i < length_; ++i) {
+		new_storage[i] = at(i);
+	}
+	storage_.swap(new_storage);
+	first_ = 0;
+	mask_  = capacity - 1;
+}
+
 /// A helper function for getData
 //Assumes storage is already locked for it
 uint8_t
@@ -243,60 +287,55 @@ TimeCache::find_closest(TransformStorage *&one,
                         std::string *      error_str)
 {
 	//No values stored
-	if (storage_.empty()) {
+	if (length_ == 0) {
 		if (error_str)
 			*error_str = "Transform cache storage is empty";
 		return 0;
 	}
 
+	TransformStorage &latest = at(length_ - 1);
+
 	//If time == 0 return the latest
 	if (target_time.is_zero()) {
-		one = &storage_.front();
+		one = &latest;
 		return 1;
 	}
 
 	// One value stored
-	if (++storage_.begin() == storage_.end()) {
-		TransformStorage &ts = *storage_.begin();
-		if (ts.stamp == target_time) {
-			one = &ts;
+	if (length_ == 1) {
+		if (latest.stamp == target_time) {
+			one = &latest;
 			return 1;
 		} else {
-			create_extrapolation_exception1(target_time, ts.stamp, error_str);
+			create_extrapolation_exception1(target_time, latest.stamp, error_str);
 			return 0;
 		}
 	}
 
-	fawkes::Time latest_time   = (*storage_.begin()).stamp;
-	fawkes::Time earliest_time = (*(storage_.rbegin())).stamp;
+	TransformStorage &earliest = at(0);
 
-	if (target_time == latest_time) {
-		one = &(*storage_.begin());
+	if (target_time == latest.stamp) {
+		one = &latest;
 		return 1;
-	} else if (target_time == earliest_time) {
-		one = &(*storage_.rbegin());
+	} else if (target_time == earliest.stamp) {
+		one = &earliest;
 		return 1;
-	} else if (target_time > latest_time) {
+	} else if (target_time > latest.stamp) {
 		// Catch cases that would require extrapolation
-		create_extrapolation_exception2(target_time, latest_time, error_str);
+		create_extrapolation_exception2(target_time, latest.stamp, error_str);
 		return 0;
-	} else if (target_time < earliest_time) {
-		create_extrapolation_exception3(target_time, earliest_time, error_str);
+	} else if (target_time < earliest.stamp) {
+		create_extrapolation_exception3(target_time, earliest.stamp, error_str);
 		return 0;
 	}
 
-	//At least 2 values stored
-	//Find the first value less than the target value
-	L_TransformStorage::iterator storage_it = storage_.begin();
-	while (storage_it != storage_.end()) {
-		if (storage_it->stamp <= target_time)
-			break;
-		storage_it++;
-	}
+	//At least 2 values stored, target strictly between earliest and latest.
+	//Find the last value less than or equal to the target value
+	size_t i = upper_bound(target_time) - 1;
 
 	//Finally the case were somewhere in the middle  Guarenteed no extrapolation :-)
-	one = &*(storage_it);   //Older
-	two = &*(--storage_it); //Newer
+	one = &at(i);     //Older
+	two = &at(i + 1); //Newer
 	return 2;
 }
 
@@ -331,12 +370,22 @@ TimeCache::clone(const fawkes::Time &look_back_until) const
 	TimeCache *copy = new TimeCache(max_storage_time_);
 	if (look_back_until.is_zero()) {
 		copy->storage_ = storage_;
+		copy->first_   = first_;
+		copy->length_  = length_;
+		copy->mask_    = mask_;
 	} else {
-		L_TransformStorage::const_iterator storage_it = storage_.begin();
-		for (storage_it = storage_.begin(); storage_it != storage_.end(); ++storage_it) {
-			if (storage_it->stamp <= look_back_until)
-				break;
-			copy->storage_.push_back(*storage_it);
+		size_t first = upper_bound(look_back_until);
+		size_t num   = length_ - first;
+		if (num > 0) {
+			size_t capacity = 16;
+			while (capacity < num)
+				capacity *= 2;
+			copy->storage_.resize(capacity);
+			copy->mask_ = capacity - 1;
+			for (size_t i = 0; i < num; ++i) {
+				copy->storage_[i] = at(first + i);
+			}
+			copy->length_ = num;
 		}
 	}
 	return std::shared_ptr<TimeCacheInterface>(copy);
@@ -381,20 +430,25 @@ TimeCache::get_parent(fawkes::Time time, std::string *error_str)
 bool
 TimeCache::insert_data(const TransformStorage &new_data)
 {
-	L_TransformStorage::iterator storage_it = storage_.begin();
-
-	if (storage_it != storage_.end()) {
-		if (storage_it->stamp > new_data.stamp + max_storage_time_) {
+	if (length_ > 0) {
+		if (at(length_ - 1).stamp > new_data.stamp + max_storage_time_) {
 			return false;
 		}
 	}
 
-	while (storage_it != storage_.end()) {
-		if (storage_it->stamp <= new_data.stamp)
-			break;
-		storage_it++;
+	if (length_ == storage_.size())
+		grow();
+
+	// common case: data arrives in order and is appended as the newest element,
+	// otherwise move the newer elements up by one to make room
+	size_t pos = (length_ == 0 || !(new_data.stamp < at(length_ - 1).stamp))
+	               ? length_
+	               : upper_bound(new_data.stamp);
+	for (size_t i = length_; i > pos; --i) {
+		at(i) = at(i - 1);
 	}
-	storage_.insert(storage_it, new_data);
+	at(pos) = new_data;
+	++length_;
 
 	prune_list();
 	return true;
@@ -403,62 +457,75 @@ TimeCache::insert_data(const TransformStorage &new_data)
 void
 TimeCache::clear_list()
 {
-	storage_.clear();
+	first_  = 0;
+	length_ = 0;
 }
 
 unsigned int
 TimeCache::get_list_length() const
 {
-	return storage_.size();
+	return length_;
 }
 
+/** Get storage list.
+ * The list is created on each call from the ring buffer, it is sorted
+ * with the newest element first. This is meant for debugging and logging,
+ * for lookups use get_data().
+ * @return reference to list of storage elements, valid until the next call
+ */
 const TimeCacheInterface::L_TransformStorage &
 TimeCache::get_storage() const
 {
-	return storage_;
+	storage_list_ = get_storage_copy();
+	return storage_list_;
 }
 
 TimeCacheInterface::L_TransformStorage
 TimeCache::get_storage_copy() const
 {
-	return storage_;
+	L_TransformStorage rv;
+	for (size_t i = length_; i > 0; --i) {
+		rv.push_back(at(i - 1));
+	}
+	return rv;
 }
 
 P_TimeAndFrameID
 TimeCache::get_latest_time_and_parent()
 {
-	if (storage_.empty()) {
+	if (length_ == 0) {
 		return std::make_pair(fawkes::Time(), 0);
 	}
 
-	const TransformStorage &ts = storage_.front();
+	const TransformStorage &ts = at(length_ - 1);
 	return std::make_pair(ts.stamp, ts.frame_id);
 }
 
 fawkes::Time
 TimeCache::get_latest_timestamp() const
 {
-	if (storage_.empty())
+	if (length_ == 0)
 		return fawkes::Time(0, 0); //empty list case
-	return storage_.front().stamp;
+	return at(length_ - 1).stamp;
 }
 
 fawkes::Time
 TimeCache::get_oldest_timestamp() const
 {
-	if (storage_.empty())
+	if (length_ == 0)
 		return fawkes::Time(0, 0); //empty list case
-	return storage_.back().stamp;
+	return at(0).stamp;
 }
 
 /** Prune storage list based on maximum cache lifetime. */
 void
 TimeCache::prune_list()
 {
-	fawkes::Time latest_time = storage_.begin()->stamp;
+	fawkes::Time latest_time = at(length_ - 1).stamp;
 
-	while (!storage_.empty() && storage_.back().stamp + max_storage_time_ < latest_time) {
-		storage_.pop_back();
+	while (length_ > 0 && at(0).stamp + max_storage_time_ < latest_time) {
+		first_ = (first_ + 1) & mask_;
+		--length_;
 	}
 }
 
@@ -58,6 +58,7 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <vector>
 
 namespace fawkes {
 namespace tf {
@@ -121,10 +122,38 @@ public:
 	virtual fawkes::Time get_oldest_timestamp() const;
 
 private:
-	L_TransformStorage storage_;
+	std::vector<TransformStorage> storage_;
+	size_t                        first_;
+	size_t                        length_;
+	size_t                        mask_;
+
+	mutable L_TransformStorage storage_list_;
 
 	float max_storage_time_;
 
+	/** Get element by chronological index.
+	 * @param i index, 0 is the oldest element, length_ - 1 the newest
+	 * @return element at the given index
+	 */
+	inline TransformStorage &
+	at(size_t i)
+	{
+		return storage_[(first_ + i) & mask_];
+	}
+
+	/** Get element by chronological index.
+	 * @param i index, 0 is the oldest element, length_ - 1 the newest
+	 * @return element at the given index
+	 */
+	inline const TransformStorage &
+	at(size_t i) const
+	{
+		return storage_[(first_ + i) & mask_];
+	}
+
+	inline size_t upper_bound(const fawkes::Time &time) const;
+	void          grow();
+
 	inline uint8_t find_closest(TransformStorage *&one,
 	                            TransformStorage *&two,
 	                            fawkes::Time       target_time,
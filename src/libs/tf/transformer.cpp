@@ -165,7 +165,7 @@ Transformer::unlock()
 bool
 Transformer::frame_exists(const std::string &frame_id_str) const
 {
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 
 	return (frameIDs_.count(frame_id_str) > 0);
 }
@@ -627,6 +627,309 @@ Transformer::transform_pose(const std::string &  target_frame,
 	stamped_out.frame_id = target_frame;
 }
 
+/// @cond INTERNAL
+/** Number of points for which the transform is linearly interpolated when
+ * transforming points with per-point time stamps. At the segment borders
+ * the transform is interpolated exactly. */
+static const size_t INTERPOLATION_SEGMENT_SIZE = 64;
+
+/** Get transform coefficients.
+ * @param t transform
+ * @param c upon return contains the rows of the rotation matrix, each
+ * followed by the translation along the respective axis (12 values)
+ */
+static inline void
+get_coefficients(const Transform &t, float *c)
+{
+	const Matrix3x3 &b = t.getBasis();
+	const Vector3 &  o = t.getOrigin();
+	for (int r = 0; r < 3; ++r) {
+		c[r * 4 + 0] = b[r].x();
+		c[r * 4 + 1] = b[r].y();
+		c[r * 4 + 2] = b[r].z();
+	}
+	c[3]  = o.x();
+	c[7]  = o.y();
+	c[11] = o.z();
+}
+
+/** Get coefficients of interpolated transform.
+ * @param t0 first transform
+ * @param t1 second transform
+ * @param ratio interpolation ratio, 0 for t0 and 1 for t1
+ * @param c upon return contains the coefficients, see get_coefficients()
+ */
+static inline void
+get_interpolated_coefficients(const Transform &t0, const Transform &t1, double ratio, float *c)
+{
+	Vector3 origin;
+	origin.setInterpolate3(t0.getOrigin(), t1.getOrigin(), ratio);
+	get_coefficients(Transform(slerp(t0.getRotation(), t1.getRotation(), ratio), origin), c);
+}
+
+/** Transform points with a fixed transform.
+ * Input and output arrays may be the same.
+ */
+static void
+transform_points_soa(const float *c,
+                     size_t       num_points,
+                     const float *x_in,
+                     const float *y_in,
+                     const float *z_in,
+                     float *      x_out,
+                     float *      y_out,
+                     float *      z_out)
+{
+	const float r00 = c[0], r01 = c[1], r02 = c[2], tx = c[3];
+	const float r10 = c[4], r11 = c[5], r12 = c[6], ty = c[7];
+	const float r20 = c[8], r21 = c[9], r22 = c[10], tz = c[11];
+
+	for (size_t i = 0; i < num_points; ++i) {
+		const float x = x_in[i], y = y_in[i], z = z_in[i];
+		x_out[i]      = r00 * x + r01 * y + r02 * z + tx;
+		y_out[i]      = r10 * x + r11 * y + r12 * z + ty;
+		z_out[i]      = r20 * x + r21 * y + r22 * z + tz;
+	}
+}
+
+/** Transform points blending linearly between two transforms.
+ * The first point is transformed with c0, the transform for point i
+ * is c0 + (c1 - c0) * i / width. Input and output arrays may be the same.
+ */
+static void
+transform_points_soa_blend(const float *c0,
+                           const float *c1,
+                           size_t       width,
+                           size_t       num_points,
+                           const float *x_in,
+                           const float *y_in,
+                           const float *z_in,
+                           float *      x_out,
+                           float *      y_out,
+                           float *      z_out)
+{
+	float d[12];
+	for (int k = 0; k < 12; ++k) {
+		d[k] = (width > 0) ? (c1[k] - c0[k]) / width : 0.f;
+	}
+
+	for (size_t i = 0; i < num_points; ++i) {
+		const float x = x_in[i], y = y_in[i], z = z_in[i];
+		const float a = (float)i;
+		x_out[i] = (c0[0] + d[0] * a) * x + (c0[1] + d[1] * a) * y + (c0[2] + d[2] * a) * z
+		           + (c0[3] + d[3] * a);
+		y_out[i] = (c0[4] + d[4] * a) * x + (c0[5] + d[5] * a) * y + (c0[6] + d[6] * a) * z
+		           + (c0[7] + d[7] * a);
+		z_out[i] = (c0[8] + d[8] * a) * x + (c0[9] + d[9] * a) * y + (c0[10] + d[10] * a) * z
+		           + (c0[11] + d[11] * a);
+	}
+}
+/// @endcond
+
+/** Transform an array of points into the target frame.
+ * The points are given as separate arrays per coordinate. A single
+ * transform is looked up and then applied to all points. The input and
+ * output arrays may be the same to transform in place.
+ * @param target_frame frame into which to transform
+ * @param source_frame frame in which the points are given
+ * @param time time for which to transform, set to (0,0) for the latest
+ * common time of the frames
+ * @param num_points number of points, i.e. of entries in each array
+ * @param x_in X coordinates of input points
+ * @param y_in Y coordinates of input points
+ * @param z_in Z coordinates of input points
+ * @param x_out upon return contains X coordinates of transformed points
+ * @param y_out upon return contains Y coordinates of transformed points
+ * @param z_out upon return contains Z coordinates of transformed points
+ * @param stamp_out if not NULL, upon return contains the time stamp of
+ * the transform that has been applied
+ * @exception ConnectivityException thrown if no connection between
+ * the source and target frame could be found in the tree.
+ * @exception ExtrapolationException returning a value would have
+ * required extrapolation beyond current limits.
+ * @exception LookupException at least one of the two given frames is
+ * unknown
+ */
+void
+Transformer::transform_points(const std::string & target_frame,
+                              const std::string & source_frame,
+                              const fawkes::Time &time,
+                              size_t              num_points,
+                              const float *       x_in,
+                              const float *       y_in,
+                              const float *       z_in,
+                              float *             x_out,
+                              float *             y_out,
+                              float *             z_out,
+                              fawkes::Time *      stamp_out) const
+{
+	StampedTransform transform;
+	lookup_transform(target_frame, source_frame, time, transform);
+
+	float c[12];
+	get_coefficients(transform, c);
+	transform_points_soa(c, num_points, x_in, y_in, z_in, x_out, y_out, z_out);
+
+	if (stamp_out)
+		*stamp_out = transform.stamp;
+}
+
+/** Transform an array of points recorded over a period of time.
+ * This is meant for sensors like laser scanners which record points one
+ * after another while the robot is moving. The points are assumed to be
+ * recorded at equidistant times, the first point at @p start_time and
+ * the last point at @p end_time. Only two transforms are looked up, for
+ * the start and end time. The transform for each point is interpolated
+ * between them. Since the transform between the two frames is interpolated
+ * as a whole, rather than each transform in the chain between them, a
+ * source frame at distance d from the axis of a rotation by angle a
+ * between start and end time deviates by up to d * a^2 / 8 from looking
+ * up each point's transform. The input and output arrays may be the same
+ * to transform in place.
+ * @param target_frame frame into which to transform
+ * @param source_frame frame in which the points are given
+ * @param start_time time when the first point was recorded
+ * @param end_time time when the last point was recorded
+ * @param num_points number of points, i.e. of entries in each array
+ * @param x_in X coordinates of input points
+ * @param y_in Y coordinates of input points
+ * @param z_in Z coordinates of input points
+ * @param x_out upon return contains X coordinates of transformed points
+ * @param y_out upon return contains Y coordinates of transformed points
+ * @param z_out upon return contains Z coordinates of transformed points
+ * @exception ConnectivityException thrown if no connection between
+ * the source and target frame could be found in the tree.
+ * @exception ExtrapolationException returning a value would have
+ * required extrapolation beyond current limits.
+ * @exception LookupException at least one of the two given frames is
+ * unknown
+ */
+void
+Transformer::transform_points(const std::string & target_frame,
+                              const std::string & source_frame,
+                              const fawkes::Time &start_time,
+                              const fawkes::Time &end_time,
+                              size_t              num_points,
+                              const float *       x_in,
+                              const float *       y_in,
+                              const float *       z_in,
+                              float *             x_out,
+                              float *             y_out,
+                              float *             z_out) const
+{
+	if (num_points == 0)
+		return;
+
+	StampedTransform start_transform, end_transform;
+	lookup_transform(target_frame, source_frame, start_time, start_transform);
+	lookup_transform(target_frame, source_frame, end_time, end_transform);
+
+	float  c0[12], c1[12];
+	size_t last  = num_points - 1;
+	size_t first = 0, end;
+	get_coefficients(start_transform, c0);
+	do {
+		end          = std::min(first + INTERPOLATION_SEGMENT_SIZE, last);
+		size_t width = end - first;
+		size_t num   = (end == last) ? width + 1 : width;
+
+		get_interpolated_coefficients(start_transform,
+		                              end_transform,
+		                              (last > 0) ? (double)end / last : 0.,
+		                              c1);
+		transform_points_soa_blend(c0,
+		                           c1,
+		                           width,
+		                           num,
+		                           &x_in[first],
+		                           &y_in[first],
+		                           &z_in[first],
+		                           &x_out[first],
+		                           &y_out[first],
+		                           &z_out[first]);
+		std::copy(c1, c1 + 12, c0);
+		first = end;
+	} while (end < last);
+}
+
+/** Transform stamped points into the target frame.
+ * This transforms multiple points given relative to the frame set in
+ * the respective stamped point into the target frame. For consecutive
+ * points with the same frame and time stamp the transform is looked up
+ * only once.
+ * @param target_frame frame into which to transform
+ * @param stamped_in stamped points, each defines source frame and time
+ * @param stamped_out stamped output points in target_frame, may be
+ * the same vector as @p stamped_in
+ * @exception ConnectivityException thrown if no connection between
+ * the source and target frame could be found in the tree.
+ * @exception ExtrapolationException returning a value would have
+ * required extrapolation beyond current limits.
+ * @exception LookupException at least one of the two given frames is
+ * unknown
+ */
+void
+Transformer::transform_points(const std::string &                target_frame,
+                              const std::vector<Stamped<Point>> &stamped_in,
+                              std::vector<Stamped<Point>> &      stamped_out) const
+{
+	stamped_out.resize(stamped_in.size());
+
+	StampedTransform transform;
+	std::string      frame_id;
+	fawkes::Time     stamp;
+	for (size_t i = 0; i < stamped_in.size(); ++i) {
+		if (i == 0 || stamped_in[i].frame_id != frame_id || stamped_in[i].stamp != stamp) {
+			frame_id = stamped_in[i].frame_id;
+			stamp    = stamped_in[i].stamp;
+			lookup_transform(target_frame, frame_id, stamp, transform);
+		}
+
+		stamped_out[i].set_data(transform * stamped_in[i]);
+		stamped_out[i].stamp    = transform.stamp;
+		stamped_out[i].frame_id = target_frame;
+	}
+}
+
+/** Transform stamped poses into the target frame.
+ * This transforms multiple poses given relative to the frame set in
+ * the respective stamped pose into the target frame. For consecutive
+ * poses with the same frame and time stamp the transform is looked up
+ * only once.
+ * @param target_frame frame into which to transform
+ * @param stamped_in stamped poses, each defines source frame and time
+ * @param stamped_out stamped output poses in target_frame, may be
+ * the same vector as @p stamped_in
+ * @exception ConnectivityException thrown if no connection between
+ * the source and target frame could be found in the tree.
+ * @exception ExtrapolationException returning a value would have
+ * required extrapolation beyond current limits.
+ * @exception LookupException at least one of the two given frames is
+ * unknown
+ */
+void
+Transformer::transform_poses(const std::string &               target_frame,
+                             const std::vector<Stamped<Pose>> &stamped_in,
+                             std::vector<Stamped<Pose>> &      stamped_out) const
+{
+	stamped_out.resize(stamped_in.size());
+
+	StampedTransform transform;
+	std::string      frame_id;
+	fawkes::Time     stamp;
+	for (size_t i = 0; i < stamped_in.size(); ++i) {
+		if (i == 0 || stamped_in[i].frame_id != frame_id || stamped_in[i].stamp != stamp) {
+			frame_id = stamped_in[i].frame_id;
+			stamp    = stamped_in[i].stamp;
+			lookup_transform(target_frame, frame_id, stamp, transform);
+		}
+
+		stamped_out[i].set_data(transform * stamped_in[i]);
+		stamped_out[i].stamp    = transform.stamp;
+		stamped_out[i].frame_id = target_frame;
+	}
+}
+
 /** Get DOT graph of all frames.
  * @param print_time true to add the time of the transform as graph label
  * @param time if not NULL will be assigned the time of the graph generation
@@ -635,7 +938,7 @@ Transformer::transform_pose(const std::string &  target_frame,
 std::string
 Transformer::all_frames_as_dot(bool print_time, fawkes::Time *time) const
 {
-	std::unique_lock<std::mutex> lock(frame_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(frame_mutex_);
 
 	fawkes::Time current_time;
 	if (time)
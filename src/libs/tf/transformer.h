@@ -147,6 +147,35 @@ public:
 	                    const std::string &  fixed_frame,
 	                    Stamped<Pose> &      stamped_out) const;
 
+	void transform_points(const std::string & target_frame,
+	                      const std::string & source_frame,
+	                      const fawkes::Time &time,
+	                      size_t              num_points,
+	                      const float *       x_in,
+	                      const float *       y_in,
+	                      const float *       z_in,
+	                      float *             x_out,
+	                      float *             y_out,
+	                      float *             z_out,
+	                      fawkes::Time *      stamp_out = NULL) const;
+	void transform_points(const std::string & target_frame,
+	                      const std::string & source_frame,
+	                      const fawkes::Time &start_time,
+	                      const fawkes::Time &end_time,
+	                      size_t              num_points,
+	                      const float *       x_in,
+	                      const float *       y_in,
+	                      const float *       z_in,
+	                      float *             x_out,
+	                      float *             y_out,
+	                      float *             z_out) const;
+	void transform_points(const std::string &                target_frame,
+	                      const std::vector<Stamped<Point>> &stamped_in,
+	                      std::vector<Stamped<Point>> &      stamped_out) const;
+	void transform_poses(const std::string &               target_frame,
+	                     const std::vector<Stamped<Pose>> &stamped_in,
+	                     std::vector<Stamped<Pose>> &      stamped_out) const;
+
 	std::string all_frames_as_dot(bool print_time, fawkes::Time *time = 0) const;
 
 private:
@@ -0,0 +1,213 @@
+/***************************************************************************
+ *  scan_projection.cpp - Project laser scans to Cartesian points
+ *
+ *  Created: Sun Oct 18 12:31:54 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <utils/math/scan_projection.h>
+
+#include <cmath>
+#include <limits>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+// The kernels take restrict pointers so that the compiler can vectorize
+// them without runtime alias checks.
+static void
+project_kernel(size_t                  n,
+               const float *__restrict ranges,
+               const float *__restrict cos_table,
+               const float *__restrict sin_table,
+               float *__restrict       x,
+               float *__restrict       y)
+{
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = ranges[i] * cos_table[i];
+		y[i] = ranges[i] * sin_table[i];
+	}
+}
+
+// Writes every beam and advances the output index only for valid ones,
+// this avoids a hard to predict branch per beam.
+template <bool STORE_BEAMS>
+static size_t
+project_valid_kernel(size_t                   n,
+                     const float *__restrict  ranges,
+                     const float *__restrict  cos_table,
+                     const float *__restrict  sin_table,
+                     float *__restrict        x,
+                     float *__restrict        y,
+                     unsigned int *__restrict beams,
+                     float                    min_range,
+                     float                    max_range)
+{
+	size_t num_valid = 0;
+	for (size_t i = 0; i < n; ++i) {
+		float r      = ranges[i];
+		x[num_valid] = r * cos_table[i];
+		y[num_valid] = r * sin_table[i];
+		if (STORE_BEAMS)
+			beams[num_valid] = i;
+		// NaN fails both comparisons and is dropped
+		num_valid += (r > min_range) & (r <= max_range);
+	}
+	return num_valid;
+}
+/// @endcond
+
+/** @class LaserScanProjection <utils/math/scan_projection.h>
+ * Project laser scans to Cartesian points.
+ * A laser scan is given as an array of ranges, one per beam, the beams
+ * sweep with a constant angle increment counter-clockwise. This class
+ * computes the sine and cosine of all beam angles once and then projects
+ * scans into the X-Y plane of the laser frame. The points are written to
+ * separate arrays for X and Y coordinates, i.e. in a structure-of-arrays
+ * layout, which allows the compiler to vectorize the projection. The same
+ * layout is used by tf::Transformer::transform_points(), hence the points
+ * can be passed on directly to transform them into another frame.
+ *
+ * For a scan recorded while the robot moves, project all beams with
+ * project(), such that the point index is the beam index, and pass
+ * the scan start and end time to tf::Transformer::transform_points() to
+ * interpolate the transform for each beam (de-skewing).
+ *
+ * An instance may be used concurrently from multiple threads.
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * The beams cover a full circle, starting at angle zero. This is the
+ * layout of the Laser360Interface, Laser720Interface, and
+ * Laser1080Interface.
+ * @param num_beams number of beams per scan
+ */
+LaserScanProjection::LaserScanProjection(unsigned int num_beams)
+: LaserScanProjection(num_beams, 0.f, num_beams > 0 ? (float)(2. * M_PI / num_beams) : 0.f)
+{
+}
+
+/** Constructor.
+ * @param num_beams number of beams per scan
+ * @param angle_min angle of the first beam in rad
+ * @param angle_increment angle between two consecutive beams in rad
+ */
+LaserScanProjection::LaserScanProjection(unsigned int num_beams,
+                                         float        angle_min,
+                                         float        angle_increment)
+: num_beams_(num_beams),
+  angle_min_(angle_min),
+  angle_increment_(angle_increment),
+  cos_(num_beams),
+  sin_(num_beams)
+{
+	for (unsigned int i = 0; i < num_beams; ++i) {
+		// compute in double precision to avoid accumulating rounding errors
+		double a = (double)angle_min + (double)i * angle_increment;
+		cos_[i]  = (float)cos(a);
+		sin_[i]  = (float)sin(a);
+	}
+}
+
+/** Get number of beams.
+ * @return number of beams per scan
+ */
+unsigned int
+LaserScanProjection::num_beams() const
+{
+	return num_beams_;
+}
+
+/** Get angle of first beam.
+ * @return angle of first beam in rad
+ */
+float
+LaserScanProjection::angle_min() const
+{
+	return angle_min_;
+}
+
+/** Get angle increment.
+ * @return angle between two consecutive beams in rad
+ */
+float
+LaserScanProjection::angle_increment() const
+{
+	return angle_increment_;
+}
+
+/** Get angle of a beam.
+ * @param beam index of beam
+ * @return angle of the beam in rad
+ */
+float
+LaserScanProjection::beam_angle(unsigned int beam) const
+{
+	return angle_min_ + beam * angle_increment_;
+}
+
+/** Project all beams of a scan.
+ * Point i is the projection of beam i. Invalid beams with a range of
+ * zero are projected to the origin.
+ * @param ranges array of num_beams() ranges
+ * @param x array of num_beams() floats to store X coordinates in
+ * @param y array of num_beams() floats to store Y coordinates in
+ */
+void
+LaserScanProjection::project(const float *ranges, float *x, float *y) const
+{
+	project_kernel(num_beams_, ranges, cos_.data(), sin_.data(), x, y);
+}
+
+/** Project valid beams of a scan.
+ * Only beams with a range larger than @p min_range and at most
+ * @p max_range are projected, the points are stored consecutively.
+ * @param ranges array of num_beams() ranges
+ * @param x array of num_beams() floats to store X coordinates in
+ * @param y array of num_beams() floats to store Y coordinates in
+ * @param beams if not NULL, array of num_beams() entries to store the
+ * beam index of each point in
+ * @param min_range beams with a range of at most this value are invalid,
+ * by default zero, which is used by Fawkes laser drivers to mark
+ * invalid beams
+ * @param max_range beams with a larger range are invalid, zero to accept
+ * arbitrarily long beams
+ * @return number of valid beams, i.e. number of points stored
+ */
+size_t
+LaserScanProjection::project_valid(const float * ranges,
+                                   float *       x,
+                                   float *       y,
+                                   unsigned int *beams,
+                                   float         min_range,
+                                   float         max_range) const
+{
+	if (max_range <= 0.f)
+		max_range = std::numeric_limits<float>::infinity();
+
+	if (beams) {
+		return project_valid_kernel<true>(
+		  num_beams_, ranges, cos_.data(), sin_.data(), x, y, beams, min_range, max_range);
+	} else {
+		return project_valid_kernel<false>(
+		  num_beams_, ranges, cos_.data(), sin_.data(), x, y, NULL, min_range, max_range);
+	}
+}
+
+} // end namespace fawkes
@@ -0,0 +1,60 @@
+/***************************************************************************
+ *  scan_projection.h - Project laser scans to Cartesian points
+ *
+ *  Created: Sun Oct 18 12:31:54 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _UTILS_MATH_SCAN_PROJECTION_H_
+#define _UTILS_MATH_SCAN_PROJECTION_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace fawkes {
+
+class LaserScanProjection
+{
+public:
+	LaserScanProjection(unsigned int num_beams);
+	LaserScanProjection(unsigned int num_beams, float angle_min, float angle_increment);
+
+	unsigned int num_beams() const;
+	float        angle_min() const;
+	float        angle_increment() const;
+	float        beam_angle(unsigned int beam) const;
+
+	void   project(const float *ranges, float *x, float *y) const;
+	size_t project_valid(const float * ranges,
+	                     float *       x,
+	                     float *       y,
+	                     unsigned int *beams     = NULL,
+	                     float         min_range = 0.f,
+	                     float         max_range = 0.f) const;
+
+private:
+	unsigned int       num_beams_;
+	float              angle_min_;
+	float              angle_increment_;
+	std::vector<float> cos_;
+	std::vector<float> sin_;
+};
+
+} // end namespace fawkes
+
+#endif
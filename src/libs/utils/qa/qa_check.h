@@ -0,0 +1,82 @@
+
+/***************************************************************************
+ *  qa_check.h - Common checks and timing for QA programs
+ *
+ *  Created: Sun Oct 18 17:02:14 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _UTILS_QA_QA_CHECK_H_
+#define _UTILS_QA_QA_CHECK_H_
+
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+/// @cond QA
+
+/* Helpers shared by the QA programs which verify their results
+ * themselves. A failed check prints a line starting with "BUG:", a QA
+ * program ends with "All checks passed" if no check failed.
+ */
+namespace fawkes {
+namespace qa {
+
+/* Monotonic time for measuring durations in nanoseconds. */
+inline long int
+now_nsec()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* Print a bug report if the condition does not hold.
+ * Returns the condition to be accumulated, e.g. ok &= check(...).
+ */
+inline bool check(bool cond, const char *format, ...)
+  __attribute__((__format__(printf, 2, 3)));
+
+inline bool
+check(bool cond, const char *format, ...)
+{
+	if (!cond) {
+		va_list va;
+		va_start(va, format);
+		printf("BUG: ");
+		vprintf(format, va);
+		printf("\n");
+		va_end(va);
+	}
+	return cond;
+}
+
+/* Print the overall result, returns the exit code of the QA program. */
+inline int
+result(bool ok)
+{
+	if (ok)
+		printf("All checks passed\n");
+	return ok ? 0 : 1;
+}
+
+} // end namespace qa
+} // end namespace fawkes
+
+/// @endcond
+
+#endif
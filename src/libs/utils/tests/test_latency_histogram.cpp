@@ -0,0 +1,108 @@
+/***************************************************************************
+ *  test_latency_histogram.cpp - Tests for LatencyHistogram
+ *
+ *  Created: Sat Oct 17 21:41:05 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include <utils/time/latency_histogram.h>
+
+#include <catch2/catch.hpp>
+#include <thread>
+#include <vector>
+
+using fawkes::LatencyHistogram;
+
+TEST_CASE("Empty histogram", "[latency_histogram]")
+{
+	LatencyHistogram h;
+	REQUIRE(h.count() == 0);
+	REQUIRE(h.min() == 0);
+	REQUIRE(h.max() == 0);
+	REQUIRE(h.mean() == 0.);
+	REQUIRE(h.percentile(50.) == 0);
+}
+
+TEST_CASE("Bucket bounds cover value range", "[latency_histogram]")
+{
+	for (unsigned int i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i) {
+		uint64_t lower = LatencyHistogram::bucket_lower_bound(i);
+		uint64_t upper = LatencyHistogram::bucket_upper_bound(i);
+		REQUIRE(LatencyHistogram::bucket_index(lower) == i);
+		REQUIRE(LatencyHistogram::bucket_index(upper) == i);
+		if (i > 0) {
+			REQUIRE(LatencyHistogram::bucket_upper_bound(i - 1) + 1 == lower);
+		}
+		// relative bucket width bounded by sub-bucket resolution
+		REQUIRE((upper - lower) * LatencyHistogram::SUB_BUCKET_COUNT <= lower);
+	}
+	REQUIRE(LatencyHistogram::bucket_upper_bound(LatencyHistogram::NUM_BUCKETS - 1)
+	        == LatencyHistogram::MAX_VALUE);
+}
+
+TEST_CASE("Statistics", "[latency_histogram]")
+{
+	LatencyHistogram h;
+	for (uint64_t v = 1; v <= 1000; ++v) {
+		h.record(v);
+	}
+	REQUIRE(h.count() == 1000);
+	REQUIRE(h.min() == 1);
+	REQUIRE(h.max() == 1000);
+	REQUIRE(h.mean() == Approx(500.5));
+	REQUIRE(h.percentile(50.) >= 500);
+	REQUIRE(h.percentile(50.) <= 500 + 500 / LatencyHistogram::SUB_BUCKET_COUNT);
+	REQUIRE(h.percentile(99.) >= 990);
+	REQUIRE(h.percentile(100.) == 1000);
+
+	LatencyHistogram copy(h);
+	h.reset();
+	REQUIRE(h.count() == 0);
+	REQUIRE(copy.count() == 1000);
+	REQUIRE(copy.max() == 1000);
+}
+
+TEST_CASE("Large values are clamped", "[latency_histogram]")
+{
+	LatencyHistogram h;
+	h.record(LatencyHistogram::MAX_VALUE * 2);
+	REQUIRE(h.max() == LatencyHistogram::MAX_VALUE);
+	REQUIRE(h.bucket_count(LatencyHistogram::NUM_BUCKETS - 1) == 1);
+}
+
+TEST_CASE("Concurrent recording", "[latency_histogram]")
+{
+	LatencyHistogram         h;
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < 4; ++t) {
+		threads.emplace_back([&h, t]() {
+			for (uint64_t v = 0; v < 10000; ++v) {
+				h.record(t * 10000 + v);
+			}
+		});
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+	REQUIRE(h.count() == 40000);
+	REQUIRE(h.min() == 0);
+	REQUIRE(h.max() == 39999);
+	uint64_t total = 0;
+	for (unsigned int i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i) {
+		total += h.bucket_count(i);
+	}
+	REQUIRE(total == 40000);
+}
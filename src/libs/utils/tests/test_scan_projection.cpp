@@ -0,0 +1,86 @@
+/***************************************************************************
+ *  test_scan_projection.cpp - Tests for LaserScanProjection
+ *
+ *  Created: Sun Oct 18 12:58:20 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include <utils/math/angle.h>
+#include <utils/math/scan_projection.h>
+
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using fawkes::LaserScanProjection;
+
+TEST_CASE("Full circle scans match sin/cos of beam angle", "[scan_projection]")
+{
+	unsigned int sizes[] = {360, 720, 1080, 541};
+	for (unsigned int n : sizes) {
+		LaserScanProjection proj(n);
+		REQUIRE(proj.num_beams() == n);
+
+		std::vector<float> ranges(n), x(n), y(n);
+		for (unsigned int i = 0; i < n; ++i)
+			ranges[i] = 1.f + (i % 17) * 0.25f;
+
+		proj.project(ranges.data(), x.data(), y.data());
+		for (unsigned int i = 0; i < n; ++i) {
+			float a = fawkes::deg2rad(i * 360.f / n);
+			REQUIRE(x[i] == Approx(ranges[i] * cosf(a)).margin(1e-5));
+			REQUIRE(y[i] == Approx(ranges[i] * sinf(a)).margin(1e-5));
+		}
+	}
+}
+
+TEST_CASE("Partial scans start at minimum angle", "[scan_projection]")
+{
+	LaserScanProjection proj(3, -M_PI / 2., M_PI / 2.);
+	REQUIRE(proj.beam_angle(2) == Approx(M_PI / 2.));
+
+	float ranges[] = {2.f, 3.f, 4.f};
+	float x[3], y[3];
+	proj.project(ranges, x, y);
+	REQUIRE(x[0] == Approx(0.).margin(1e-6));
+	REQUIRE(y[0] == Approx(-2.));
+	REQUIRE(x[1] == Approx(3.));
+	REQUIRE(y[1] == Approx(0.).margin(1e-6));
+	REQUIRE(x[2] == Approx(0.).margin(1e-6));
+	REQUIRE(y[2] == Approx(4.));
+}
+
+TEST_CASE("Invalid beams are skipped", "[scan_projection]")
+{
+	LaserScanProjection proj(4);
+	float               ranges[] = {0.f, 1.f, std::numeric_limits<float>::quiet_NaN(), 5.f};
+	float               x[4], y[4];
+	unsigned int        beams[4];
+
+	REQUIRE(proj.project_valid(ranges, x, y, beams) == 2);
+	REQUIRE(beams[0] == 1);
+	REQUIRE(beams[1] == 3);
+	REQUIRE(x[0] == Approx(0.).margin(1e-6));
+	REQUIRE(y[0] == Approx(1.));
+	REQUIRE(x[1] == Approx(0.).margin(1e-6));
+	REQUIRE(y[1] == Approx(-5.));
+
+	REQUIRE(proj.project_valid(ranges, x, y, NULL, 0.f, 4.f) == 1);
+	REQUIRE(y[0] == Approx(1.));
+	REQUIRE(proj.project_valid(ranges, x, y, NULL, 2.f) == 1);
+	REQUIRE(y[0] == Approx(-5.));
+}
@@ -0,0 +1,258 @@
+
+/***************************************************************************
+ *  latency_histogram.cpp - Lock-free histogram for latency measurements
+ *
+ *  Created: Sat Oct 17 21:03:18 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <utils/time/latency_histogram.h>
+
+#include <cmath>
+
+namespace fawkes {
+
+/** @class LatencyHistogram <utils/time/latency_histogram.h>
+ * Lock-free histogram for latency measurements.
+ * Values are sorted into log-linear buckets in the spirit of HDR histograms:
+ * values below SUB_BUCKET_COUNT have a bucket of their own, larger values
+ * share a power of two range split into SUB_BUCKET_COUNT linear
+ * sub-buckets. The relative error of a value derived from a bucket is
+ * therefore bounded by 1/SUB_BUCKET_COUNT over the whole value range.
+ *
+ * Recording a value takes a few relaxed atomic operations and never blocks,
+ * it may be done concurrently from any number of threads. Readers may see
+ * a recording only partially, e.g. the count already increased but not
+ * the bucket yet. This is acceptable for monitoring purposes.
+ *
+ * The histogram is unit agnostic, typically microseconds are recorded.
+ * @author Tim Niemueller
+ */
+
+const unsigned int LatencyHistogram::SUB_BUCKET_BITS;
+const unsigned int LatencyHistogram::SUB_BUCKET_COUNT;
+const uint64_t     LatencyHistogram::MAX_VALUE;
+const unsigned int LatencyHistogram::NUM_BUCKETS;
+
+/** Constructor. */
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+/** Copy constructor.
+ * Creates a snapshot of the given histogram.
+ * @param other histogram to copy
+ */
+LatencyHistogram::LatencyHistogram(const LatencyHistogram &other)
+{
+	*this = other;
+}
+
+/** Assignment operator.
+ * @param other histogram to copy
+ * @return reference to this instance
+ */
+LatencyHistogram &
+LatencyHistogram::operator=(const LatencyHistogram &other)
+{
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		buckets_[i].store(other.buckets_[i].load(std::memory_order_relaxed),
+		                  std::memory_order_relaxed);
+	}
+	count_.store(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	sum_.store(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	min_.store(other.min_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	max_.store(other.max_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	return *this;
+}
+
+/** Record a value.
+ * @param value value to record, values larger than MAX_VALUE are clamped
+ */
+void
+LatencyHistogram::record(uint64_t value)
+{
+	if (value > MAX_VALUE)
+		value = MAX_VALUE;
+
+	buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+	sum_.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t cur = min_.load(std::memory_order_relaxed);
+	while (value < cur && !min_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+	}
+	cur = max_.load(std::memory_order_relaxed);
+	while (value > cur && !max_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+	}
+}
+
+/** Reset histogram.
+ * Must not be called concurrently with record().
+ */
+void
+LatencyHistogram::reset()
+{
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		buckets_[i].store(0, std::memory_order_relaxed);
+	}
+	count_.store(0, std::memory_order_relaxed);
+	sum_.store(0, std::memory_order_relaxed);
+	min_.store(MAX_VALUE, std::memory_order_relaxed);
+	max_.store(0, std::memory_order_relaxed);
+}
+
+/** Get number of recorded values.
+ * @return number of recorded values
+ */
+uint64_t
+LatencyHistogram::count() const
+{
+	return count_.load(std::memory_order_relaxed);
+}
+
+/** Get sum of recorded values.
+ * @return sum of recorded values
+ */
+uint64_t
+LatencyHistogram::sum() const
+{
+	return sum_.load(std::memory_order_relaxed);
+}
+
+/** Get minimum recorded value.
+ * @return minimum recorded value, 0 if no value has been recorded
+ */
+uint64_t
+LatencyHistogram::min() const
+{
+	return (count() > 0) ? min_.load(std::memory_order_relaxed) : 0;
+}
+
+/** Get maximum recorded value.
+ * @return maximum recorded value, 0 if no value has been recorded
+ */
+uint64_t
+LatencyHistogram::max() const
+{
+	return max_.load(std::memory_order_relaxed);
+}
+
+/** Get mean of recorded values.
+ * @return mean of recorded values, 0 if no value has been recorded
+ */
+double
+LatencyHistogram::mean() const
+{
+	uint64_t c = count();
+	return (c > 0) ? (double)sum() / (double)c : 0.;
+}
+
+/** Get value at given percentile.
+ * The value returned is the upper bound of the bucket containing the
+ * percentile, but at most the maximum recorded value.
+ * @param percentile percentile in the range [0, 100]
+ * @return value at given percentile, 0 if no value has been recorded
+ */
+uint64_t
+LatencyHistogram::percentile(double percentile) const
+{
+	uint64_t total = 0;
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		total += buckets_[i].load(std::memory_order_relaxed);
+	}
+	if (total == 0)
+		return 0;
+
+	if (percentile < 0.)
+		percentile = 0.;
+	if (percentile > 100.)
+		percentile = 100.;
+	uint64_t target = (uint64_t)ceil(percentile / 100. * total);
+	if (target == 0)
+		target = 1;
+
+	uint64_t cumulative = 0;
+	for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		cumulative += buckets_[i].load(std::memory_order_relaxed);
+		if (cumulative >= target) {
+			uint64_t upper = bucket_upper_bound(i);
+			uint64_t m     = max();
+			return (upper < m) ? upper : m;
+		}
+	}
+	return max();
+}
+
+/** Get number of values in a bucket.
+ * @param bucket bucket index, must be less than NUM_BUCKETS
+ * @return number of values recorded in the bucket
+ */
+uint64_t
+LatencyHistogram::bucket_count(unsigned int bucket) const
+{
+	return buckets_[bucket].load(std::memory_order_relaxed);
+}
+
+/** Get bucket index for a value.
+ * @param value value to get bucket for, must not exceed MAX_VALUE
+ * @return index of bucket the value is recorded in
+ */
+unsigned int
+LatencyHistogram::bucket_index(uint64_t value)
+{
+	if (value < SUB_BUCKET_COUNT)
+		return value;
+
+	unsigned int msb   = 63 - __builtin_clzll(value);
+	unsigned int shift = msb - SUB_BUCKET_BITS;
+	unsigned int sub   = (value >> shift) & (SUB_BUCKET_COUNT - 1);
+	return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + sub;
+}
+
+/** Get smallest value of a bucket.
+ * @param bucket bucket index
+ * @return smallest value recorded in the given bucket
+ */
+uint64_t
+LatencyHistogram::bucket_lower_bound(unsigned int bucket)
+{
+	if (bucket < SUB_BUCKET_COUNT)
+		return bucket;
+
+	unsigned int shift = (bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+	unsigned int sub   = (bucket - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+	return (uint64_t)(SUB_BUCKET_COUNT + sub) << shift;
+}
+
+/** Get largest value of a bucket.
+ * @param bucket bucket index
+ * @return largest value recorded in the given bucket
+ */
+uint64_t
+LatencyHistogram::bucket_upper_bound(unsigned int bucket)
+{
+	if (bucket < SUB_BUCKET_COUNT)
+		return bucket;
+
+	unsigned int shift = (bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+	return bucket_lower_bound(bucket) + ((uint64_t)1 << shift) - 1;
+}
+
+} // end namespace fawkes
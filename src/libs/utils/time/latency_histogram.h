@@ -0,0 +1,74 @@
+
+/***************************************************************************
+ *  latency_histogram.h - Lock-free histogram for latency measurements
+ *
+ *  Created: Sat Oct 17 21:03:18 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _UTILS_TIME_LATENCY_HISTOGRAM_H_
+#define _UTILS_TIME_LATENCY_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace fawkes {
+
+class LatencyHistogram
+{
+public:
+	/** Number of bits for the linear sub-buckets of each power of two. */
+	static const unsigned int SUB_BUCKET_BITS = 4;
+	/** Number of linear sub-buckets per power of two. */
+	static const unsigned int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+	/** Maximum value that can be recorded, larger values are clamped. */
+	static const uint64_t MAX_VALUE = 0xFFFFFFFF;
+	/** Number of buckets. */
+	static const unsigned int NUM_BUCKETS = SUB_BUCKET_COUNT * (33 - SUB_BUCKET_BITS);
+
+	LatencyHistogram();
+	LatencyHistogram(const LatencyHistogram &other);
+	LatencyHistogram &operator=(const LatencyHistogram &other);
+
+	void record(uint64_t value);
+	void reset();
+
+	uint64_t count() const;
+	uint64_t sum() const;
+	uint64_t min() const;
+	uint64_t max() const;
+	double   mean() const;
+	uint64_t percentile(double percentile) const;
+
+	uint64_t bucket_count(unsigned int bucket) const;
+
+	static unsigned int bucket_index(uint64_t value);
+	static uint64_t     bucket_lower_bound(unsigned int bucket);
+	static uint64_t     bucket_upper_bound(unsigned int bucket);
+
+private:
+	std::atomic<uint64_t> buckets_[NUM_BUCKETS];
+	std::atomic<uint64_t> count_;
+	std::atomic<uint64_t> sum_;
+	std::atomic<uint64_t> min_;
+	std::atomic<uint64_t> max_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -351,13 +351,40 @@ AmclThread::init()
 	if (laser_model_type_ == ::amcl::LASER_MODEL_BEAM) {
 		laser_->SetModelBeam(z_hit_, z_short_, z_max_, z_rand_, sigma_hit_, lambda_short_, 0.0);
 	} else {
+		bool cfg_cspace_cache = false;
+		try {
+			cfg_cspace_cache = config->get_bool(AMCL_CFG_PREFIX "cspace_cache");
+		} catch (Exception &e) {
+		} // ignore, use default
+		std::string cspace_cache_file = cfg_map_file_ + ".cspace";
+
 		logger->log_info(name(),
 		                 "Initializing likelihood field model; "
 		                 "this can take some time on large maps...");
-		laser_->SetModelLikelihoodField(z_hit_, z_rand_, sigma_hit_, laser_likelihood_max_dist_);
+		if (laser_->SetModelLikelihoodField(z_hit_,
+		                                    z_rand_,
+		                                    sigma_hit_,
+		                                    laser_likelihood_max_dist_,
+		                                    cfg_cspace_cache ? cspace_cache_file.c_str() : NULL)) {
+			logger->log_info(name(), "Loaded distance field from %s", cspace_cache_file.c_str());
+		} else if (cfg_cspace_cache && map_save_cspace(map_, cspace_cache_file.c_str()) != 0) {
+			logger->log_warn(name(),
+			                 "Failed to write distance field cache %s",
+			                 cspace_cache_file.c_str());
+		}
 		logger->log_info(name(), "Done initializing likelihood field model.");
 	}
 
+	unsigned int cfg_laser_num_threads = 1;
+	try {
+		cfg_laser_num_threads = config->get_uint(AMCL_CFG_PREFIX "laser_num_threads");
+	} catch (Exception &e) {
+	} // ignore, use default
+	if (cfg_laser_num_threads > 1) {
+		logger->log_info(name(), "Evaluating laser model with %u threads", cfg_laser_num_threads);
+		laser_->SetNumThreads(cfg_laser_num_threads);
+	}
+
 	laser_if_ = blackboard->open_for_reading<Laser360Interface>(cfg_laser_ifname_.c_str());
 	pos3d_if_ = blackboard->open_for_writing<Position3DInterface>(cfg_pose_ifname_.c_str());
 	loc_if_   = blackboard->open_for_writing<LocalizationInterface>("AMCL");
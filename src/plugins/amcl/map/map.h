@@ -106,6 +106,16 @@ int map_load_occ(map_t *map, const char *filename, double scale, int negate);
 // Update the cspace distances
 void map_update_cspace(map_t *map, double max_occ_dist);
 
+// Compute a hash over the map geometry and occupancy states
+uint64_t map_hash(map_t *map);
+
+// Load the cspace distances from a cache file, fails if the file was
+// written for another map or max_occ_dist. Returns 0 on success.
+int map_load_cspace(map_t *map, double max_occ_dist, const char *filename);
+
+// Save the cspace distances to a cache file. Returns 0 on success.
+int map_save_cspace(map_t *map, const char *filename);
+
 /**************************************************************************
  * Range functions
  **************************************************************************/
@@ -0,0 +1,179 @@
+/***************************************************************************
+ *  map_cspace_cache.c: Cache for the map cspace distances
+ *
+ *  Created: Sun Oct 18 08:02:17 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "map.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @cond INTERNALS
+
+#define MAP_CSPACE_CACHE_MAGIC 0x414D4344 // AMCD
+#define MAP_CSPACE_CACHE_VERSION 1
+
+// The cache file consists of this header followed by the occ_dist
+// values of all cells in MAP_INDEX order. It is written in host byte
+// order, the magic fails to match on a host with different endianess.
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t map_hash;
+	double   max_occ_dist;
+	int32_t  size_x;
+	int32_t  size_y;
+} map_cspace_cache_header_t;
+
+static uint64_t
+fnv1a(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *d = (const unsigned char *)data;
+	size_t               i;
+	for (i = 0; i < size; ++i) {
+		hash ^= d[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/// @endcond
+
+// Compute a hash over the map geometry and occupancy states
+uint64_t
+map_hash(map_t *map)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	int      i, n;
+
+	hash = fnv1a(hash, &map->origin_x, sizeof(map->origin_x));
+	hash = fnv1a(hash, &map->origin_y, sizeof(map->origin_y));
+	hash = fnv1a(hash, &map->scale, sizeof(map->scale));
+	hash = fnv1a(hash, &map->size_x, sizeof(map->size_x));
+	hash = fnv1a(hash, &map->size_y, sizeof(map->size_y));
+
+	n = map->size_x * map->size_y;
+	for (i = 0; i < n; ++i) {
+		signed char occ = (signed char)map->cells[i].occ_state;
+		hash            = fnv1a(hash, &occ, 1);
+	}
+	return hash;
+}
+
+// Load the cspace distances from a cache file
+int
+map_load_cspace(map_t *map, double max_occ_dist, const char *filename)
+{
+	const map_cspace_cache_header_t *header;
+	const double *                   occ_dist;
+	struct stat                      s;
+	void *                           data;
+	size_t                           num_cells, i;
+	int                              fd;
+	int                              rv = -1;
+
+	fd = open(filename, O_RDONLY);
+	if (fd == -1)
+		return -1;
+
+	num_cells = (size_t)map->size_x * map->size_y;
+	if (fstat(fd, &s) != 0
+	    || (size_t)s.st_size != sizeof(map_cspace_cache_header_t) + num_cells * sizeof(double)) {
+		close(fd);
+		return -1;
+	}
+
+	data = mmap(NULL, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return -1;
+
+	header   = (const map_cspace_cache_header_t *)data;
+	occ_dist = (const double *)(header + 1);
+	if (header->magic == MAP_CSPACE_CACHE_MAGIC && header->version == MAP_CSPACE_CACHE_VERSION
+	    && header->max_occ_dist == max_occ_dist && header->size_x == map->size_x
+	    && header->size_y == map->size_y && header->map_hash == map_hash(map)) {
+		madvise(data, s.st_size, MADV_SEQUENTIAL);
+		for (i = 0; i < num_cells; ++i) {
+			map->cells[i].occ_dist = occ_dist[i];
+		}
+		map->max_occ_dist = max_occ_dist;
+		rv                = 0;
+	}
+
+	munmap(data, s.st_size);
+	return rv;
+}
+
+// Save the cspace distances to a cache file
+int
+map_save_cspace(map_t *map, const char *filename)
+{
+	map_cspace_cache_header_t header;
+	size_t                    num_cells, i, n;
+	double                    buffer[4096];
+	char *                    tmpfile;
+	FILE *                    f;
+	int                       ok;
+
+	// write to a temporary file first, a concurrently starting process
+	// must never see a partially written cache
+	tmpfile = malloc(strlen(filename) + 32);
+	sprintf(tmpfile, "%s.tmp.%i", filename, (int)getpid());
+	f = fopen(tmpfile, "wb");
+	if (!f) {
+		free(tmpfile);
+		return -1;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.magic        = MAP_CSPACE_CACHE_MAGIC;
+	header.version      = MAP_CSPACE_CACHE_VERSION;
+	header.map_hash     = map_hash(map);
+	header.max_occ_dist = map->max_occ_dist;
+	header.size_x       = map->size_x;
+	header.size_y       = map->size_y;
+	ok                  = (fwrite(&header, sizeof(header), 1, f) == 1);
+
+	num_cells = (size_t)map->size_x * map->size_y;
+	for (i = 0; ok && i < num_cells; i += n) {
+		size_t c;
+		n = num_cells - i;
+		if (n > sizeof(buffer) / sizeof(double))
+			n = sizeof(buffer) / sizeof(double);
+		for (c = 0; c < n; ++c) {
+			buffer[c] = map->cells[i + c].occ_dist;
+		}
+		ok = (fwrite(buffer, sizeof(double), n, f) == n);
+	}
+
+	ok = (fclose(f) == 0) && ok;
+	if (ok)
+		ok = (rename(tmpfile, filename) == 0);
+	if (!ok)
+		unlink(tmpfile);
+	free(tmpfile);
+
+	return ok ? 0 : -1;
+}
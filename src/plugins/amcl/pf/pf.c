@@ -275,28 +275,44 @@ void pf_update_sensor(pf_t *pf, pf_sensor_model_fn_t sensor_fn, void *sensor_dat
 // Resample the distribution
 void pf_update_resample(pf_t *pf)
 {
-  int i;
+  int i, j, m;
   double total;
   pf_sample_set_t *set_a, *set_b;
   pf_sample_t *sample_a, *sample_b;
 
-  //double r,c,U;
-  //int m;
-  //double count_inv;
-  double* c;
+  double r, c, U;
+  double count_inv, weight_sum;
+  int *idx;
+  int limit, limit_k;
 
   double w_diff;
 
   set_a = pf->sets + pf->current_set;
   set_b = pf->sets + (pf->current_set + 1) % 2;
 
-  // Build up cumulative probability table for resampling.
-  // TODO: Replace this with a more efficient procedure
-  // (e.g., http://www.network-theory.co.uk/docs/gslref/GeneralDiscreteDistributions.html)
-  c = (double*)malloc(sizeof(double)*(set_a->sample_count+1));
-  c[0] = 0.0;
-  for(i=0;i<set_a->sample_count;i++)
-    c[i+1] = c[i]+set_a->samples[i].weight;
+  // Low-variance resampler, taken from Probabilistic Robotics, p110.
+  // Select max_samples samples from set a in a single pass with a comb
+  // of equidistant pointers into the cumulative weights.
+  weight_sum = 0.0;
+  for (i = 0; i < set_a->sample_count; i++)
+    weight_sum += set_a->samples[i].weight;
+  idx = (int*)malloc(sizeof(int)*pf->max_samples);
+  count_inv = weight_sum/pf->max_samples;
+  r = drand48() * count_inv;
+  c = set_a->samples[0].weight;
+  i = 0;
+  for (m = 0; m < pf->max_samples; m++)
+  {
+    U = r + m * count_inv;
+    // Stop at the last sample if the weights sum up to slightly less
+    // than weight_sum due to rounding
+    while (U > c && i < set_a->sample_count - 1)
+    {
+      i++;
+      c += set_a->samples[i].weight;
+    }
+    idx[m] = i;
+  }
 
   // Create the kd tree for adaptive sampling
   pf_kdtree_clear(set_b->kdtree);
@@ -310,16 +326,12 @@ void pf_update_resample(pf_t *pf)
     w_diff = 0.0;
   //printf("w_diff: %9.6f\n", w_diff);
 
-  // Can't (easily) combine low-variance sampler with KLD adaptive
-  // sampling, so we'll take the more traditional route.
-  /*
-  // Low-variance resampler, taken from Probabilistic Robotics, p110
-  count_inv = 1.0/set_a->sample_count;
-  r = drand48() * count_inv;
-  c = set_a->samples[0].weight;
-  i = 0;
+  // KLD adaptive sampling usually stops before all selected samples have
+  // been used. They are taken in random order (a lazy Fisher-Yates
+  // shuffle), so that the used ones are an unbiased subset.
   m = 0;
-  */
+  limit_k = -1;
+  limit = pf->max_samples;
   while(set_b->sample_count < pf->max_samples)
   {
     sample_b = set_b->samples + set_b->sample_count++;
@@ -328,39 +340,12 @@ void pf_update_resample(pf_t *pf)
       sample_b->pose = (pf->random_pose_fn)(pf->random_pose_data);
     else
     {
-      // Can't (easily) combine low-variance sampler with KLD adaptive
-      // sampling, so we'll take the more traditional route.
-      /*
-      // Low-variance resampler, taken from Probabilistic Robotics, p110
-      U = r + m * count_inv;
-      while(U>c)
-      {
-        i++;
-        // Handle wrap-around by resetting counters and picking a new random
-        // number
-        if(i >= set_a->sample_count)
-        {
-          r = drand48() * count_inv;
-          c = set_a->samples[0].weight;
-          i = 0;
-          m = 0;
-          U = r + m * count_inv;
-          continue;
-        }
-        c += set_a->samples[i].weight;
-      }
-      m++;
-      */
-
-      // Naive discrete event sampler
-      double r;
-      r = drand48();
-      for(i=0;i<set_a->sample_count;i++)
-      {
-        if((c[i] <= r) && (r < c[i+1]))
-          break;
-      }
-      assert(i<set_a->sample_count);
+      j = m + (int) (drand48() * (pf->max_samples - m));
+      if (j >= pf->max_samples)
+        j = pf->max_samples - 1;
+      i = idx[j];
+      idx[j] = idx[m];
+      idx[m++] = i;
 
       sample_a = set_a->samples + i;
 
@@ -376,8 +361,14 @@ void pf_update_resample(pf_t *pf)
     // Add sample to histogram
     pf_kdtree_insert(set_b->kdtree, sample_b->pose, sample_b->weight);
 
-    // See if we have enough samples yet
-    if (set_b->sample_count > pf_resample_limit(pf, set_b->kdtree->leaf_count))
+    // See if we have enough samples yet, the limit only changes with the
+    // number of occupied bins
+    if (set_b->kdtree->leaf_count != limit_k)
+    {
+      limit_k = set_b->kdtree->leaf_count;
+      limit = pf_resample_limit(pf, limit_k);
+    }
+    if (set_b->sample_count > limit)
       break;
   }
   
@@ -400,7 +391,7 @@ void pf_update_resample(pf_t *pf)
   // Use the newly created sample set
   pf->current_set = (pf->current_set + 1) % 2;
 
-  free(c);
+  free(idx);
   return;
 }
 
@@ -445,10 +436,10 @@ void pf_cluster_stats(pf_t *pf, pf_sample_set_t *set)
   // Cluster the samples
   pf_kdtree_cluster(set->kdtree);
   
-  // Initialize cluster stats
+  // Initialize cluster stats, there cannot be more clusters than bins
   set->cluster_count = 0;
 
-  for (i = 0; i < set->cluster_max_count; i++)
+  for (i = 0; i < set->cluster_max_count && i < set->kdtree->leaf_count; i++)
   {
     cluster = set->clusters + i;
     cluster->count = 0;
@@ -41,37 +41,28 @@
 #include "pf_vector.h"
 #include "pf_kdtree.h"
 
+// The histogram used to be stored in a kd tree, which needed O(log n)
+// per insertion and lookup, or worse for degenerate trees, and deep
+// recursion for clustering. It is now a hash table over the bin keys
+// with linear probing, which keeps all operations O(1) on average. The
+// API and names are kept.
 
-// Compare keys to see if they are equal
-static int pf_kdtree_equal(pf_kdtree_t *self, int key_a[], int key_b[]);
+// Compute the key of the bin for the given pose
+static void pf_kdtree_key(pf_kdtree_t *self, pf_vector_t pose, int key[]);
 
-// Insert a node into the tree
-static pf_kdtree_node_t *pf_kdtree_insert_node(pf_kdtree_t *self, pf_kdtree_node_t *parent,
-                                               pf_kdtree_node_t *node, int key[], double value);
-
-// Recursive node search
-static pf_kdtree_node_t *pf_kdtree_find_node(pf_kdtree_t *self, pf_kdtree_node_t *node, int key[]);
-
-// Recursively label nodes in this cluster
-static void pf_kdtree_cluster_node(pf_kdtree_t *self, pf_kdtree_node_t *node, int depth);
-
-// Recursive node printing
-//static void pf_kdtree_print_node(pf_kdtree_t *self, pf_kdtree_node_t *node);
-
-
-#ifdef INCLUDE_RTKGUI
-
-// Recursively draw nodes
-static void pf_kdtree_draw_node(pf_kdtree_t *self, pf_kdtree_node_t *node, rtk_fig_t *fig);
-
-#endif
+// Find the node with the given key, NULL if there is none
+static pf_kdtree_node_t *pf_kdtree_find_node(pf_kdtree_t *self, int key[]);
 
+// Label nodes in the cluster of the given node
+static void pf_kdtree_cluster_node(pf_kdtree_t *self, pf_kdtree_node_t *node,
+                                   pf_kdtree_node_t **stack);
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Create a tree
 pf_kdtree_t *pf_kdtree_alloc(int max_size)
 {
+  int i;
   pf_kdtree_t *self;
 
   self = calloc(1, sizeof(pf_kdtree_t));
@@ -80,12 +71,18 @@ pf_kdtree_t *pf_kdtree_alloc(int max_size)
   self->size[1] = 0.50;
   self->size[2] = (10 * M_PI / 180);
 
-  self->root = NULL;
-
   self->node_count = 0;
   self->node_max_count = max_size;
   self->nodes = calloc(self->node_max_count, sizeof(pf_kdtree_node_t));
 
+  // Keep the load factor at or below 0.5
+  self->table_size = 1;
+  while (self->table_size < 2 * max_size)
+    self->table_size *= 2;
+  self->table = malloc(self->table_size * sizeof(int));
+  for (i = 0; i < self->table_size; i++)
+    self->table[i] = -1;
+
   self->leaf_count = 0;
 
   return self;
@@ -96,6 +93,7 @@ pf_kdtree_t *pf_kdtree_alloc(int max_size)
 // Destroy a tree
 void pf_kdtree_free(pf_kdtree_t *self)
 {
+  free(self->table);
   free(self->nodes);
   free(self);
   return;
@@ -106,7 +104,12 @@ void pf_kdtree_free(pf_kdtree_t *self)
 // Clear all entries from the tree
 void pf_kdtree_clear(pf_kdtree_t *self)
 {
-  self->root = NULL;
+  int i;
+
+  // Only reset the used slots, this is O(nodes) and not O(table size)
+  for (i = 0; i < self->node_count; i++)
+    self->table[self->nodes[i].slot] = -1;
+
   self->leaf_count = 0;
   self->node_count = 0;
 
@@ -115,37 +118,59 @@ void pf_kdtree_clear(pf_kdtree_t *self)
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// Insert a pose into the tree.
-void pf_kdtree_insert(pf_kdtree_t *self, pf_vector_t pose, double value)
+// Compute the key of the bin for the given pose
+void pf_kdtree_key(pf_kdtree_t *self, pf_vector_t pose, int key[])
 {
-  int key[3];
-
   key[0] = floor(pose.v[0] / self->size[0]);
   key[1] = floor(pose.v[1] / self->size[1]);
   key[2] = floor(pose.v[2] / self->size[2]);
+}
 
-  self->root = pf_kdtree_insert_node(self, NULL, self->root, key, value);
 
-  // Test code
-  /*
-  printf("find %d %d %d\n", key[0], key[1], key[2]);
-  assert(pf_kdtree_find_node(self, self->root, key) != NULL);
+////////////////////////////////////////////////////////////////////////////////
+// Compute the first hash table slot for a key
+static inline int pf_kdtree_hash(pf_kdtree_t *self, int key[])
+{
+  unsigned int h;
+  h = (unsigned int) key[0] * 73856093u;
+  h ^= (unsigned int) key[1] * 19349663u;
+  h ^= (unsigned int) key[2] * 83492791u;
+  h ^= h >> 15;
+  return h & (self->table_size - 1);
+}
 
-  pf_kdtree_print_node(self, self->root);
 
-  printf("\n");
+////////////////////////////////////////////////////////////////////////////////
+// Insert a pose into the tree.
+void pf_kdtree_insert(pf_kdtree_t *self, pf_vector_t pose, double value)
+{
+  int key[3];
+  int slot;
+  pf_kdtree_node_t *node;
 
-  for (i = 0; i < self->node_count; i++)
+  pf_kdtree_key(self, pose, key);
+
+  for (slot = pf_kdtree_hash(self, key); self->table[slot] >= 0;
+       slot = (slot + 1) & (self->table_size - 1))
   {
-    node = self->nodes + i;
-    if (node->leaf)
+    node = self->nodes + self->table[slot];
+    if (node->key[0] == key[0] && node->key[1] == key[1] && node->key[2] == key[2])
     {
-      printf("find %d %d %d\n", node->key[0], node->key[1], node->key[2]);
-      assert(pf_kdtree_find_node(self, self->root, node->key) == node);
+      node->value += value;
+      return;
     }
   }
-  printf("\n\n");
-  */
+
+  assert(self->node_count < self->node_max_count);
+  node = self->nodes + self->node_count;
+  node->key[0] = key[0];
+  node->key[1] = key[1];
+  node->key[2] = key[2];
+  node->value = value;
+  node->cluster = -1;
+  node->slot = slot;
+  self->table[slot] = self->node_count++;
+  self->leaf_count += 1;
 
   return;
 }
@@ -159,11 +184,9 @@ double pf_kdtree_get_prob(pf_kdtree_t *self, pf_vector_t pose)
   int key[3];
   pf_kdtree_node_t *node;
 
-  key[0] = floor(pose.v[0] / self->size[0]);
-  key[1] = floor(pose.v[1] / self->size[1]);
-  key[2] = floor(pose.v[2] / self->size[2]);
+  pf_kdtree_key(self, pose, key);
 
-  node = pf_kdtree_find_node(self, self->root, key);
+  node = pf_kdtree_find_node(self, key);
   if (node == NULL)
     return 0.0;
   return node->value;
@@ -177,11 +200,9 @@ int pf_kdtree_get_cluster(pf_kdtree_t *self, pf_vector_t pose)
   int key[3];
   pf_kdtree_node_t *node;
 
-  key[0] = floor(pose.v[0] / self->size[0]);
-  key[1] = floor(pose.v[1] / self->size[1]);
-  key[2] = floor(pose.v[2] / self->size[2]);
+  pf_kdtree_key(self, pose, key);
 
-  node = pf_kdtree_find_node(self, self->root, key);
+  node = pf_kdtree_find_node(self, key);
   if (node == NULL)
     return -1;
   return node->cluster;
@@ -189,209 +210,43 @@ int pf_kdtree_get_cluster(pf_kdtree_t *self, pf_vector_t pose)
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// Compare keys to see if they are equal
-int pf_kdtree_equal(pf_kdtree_t *self, int key_a[], int key_b[])
-{
-  //double a, b;
-
-  if (key_a[0] != key_b[0])
-    return 0;
-  if (key_a[1] != key_b[1])
-    return 0;
-
-  if (key_a[2] != key_b[2])
-    return 0;
-
-  /* TODO: make this work (pivot selection needs fixing, too)
-  // Normalize angles
-  a = key_a[2] * self->size[2];
-  a = atan2(sin(a), cos(a)) / self->size[2];
-  b = key_b[2] * self->size[2];
-  b = atan2(sin(b), cos(b)) / self->size[2];
-
- if ((int) a != (int) b)
-    return 0;
-  */
-
-  return 1;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////
-// Insert a node into the tree
-pf_kdtree_node_t *pf_kdtree_insert_node(pf_kdtree_t *self, pf_kdtree_node_t *parent,
-                                        pf_kdtree_node_t *node, int key[], double value)
+// Find the node with the given key
+pf_kdtree_node_t *pf_kdtree_find_node(pf_kdtree_t *self, int key[])
 {
-  int i;
-  int split, max_split;
-
-  // If the node doesnt exist yet...
-  if (node == NULL)
-  {
-    assert(self->node_count < self->node_max_count);
-    node = self->nodes + self->node_count++;
-    memset(node, 0, sizeof(pf_kdtree_node_t));
-
-    node->leaf = 1;
-
-    if (parent == NULL)
-      node->depth = 0;
-    else
-      node->depth = parent->depth + 1;
-
-    for (i = 0; i < 3; i++)
-      node->key[i] = key[i];
-
-    node->value = value;
-    self->leaf_count += 1;
-  }
-
-  // If the node exists, and it is a leaf node...
-  else if (node->leaf)
-  {
-    // If the keys are equal, increment the value
-    if (pf_kdtree_equal(self, key, node->key))
-    {
-      node->value += value;
-    }
-
-    // The keys are not equal, so split this node
-    else
-    {
-      // Find the dimension with the largest variance and do a mean
-      // split
-      max_split = 0;
-      node->pivot_dim = -1;
-      for (i = 0; i < 3; i++)
-      {
-        split = abs(key[i] - node->key[i]);
-        if (split > max_split)
-        {
-          max_split = split;
-          node->pivot_dim = i;
-        }
-      }
-      assert(node->pivot_dim >= 0);
-
-      node->pivot_value = (key[node->pivot_dim] + node->key[node->pivot_dim]) / 2.0;
-
-      if (key[node->pivot_dim] < node->pivot_value)
-      {
-        node->children[0] = pf_kdtree_insert_node(self, node, NULL, key, value);
-        node->children[1] = pf_kdtree_insert_node(self, node, NULL, node->key, node->value);
-      }
-      else
-      {
-        node->children[0] = pf_kdtree_insert_node(self, node, NULL, node->key, node->value);
-        node->children[1] = pf_kdtree_insert_node(self, node, NULL, key, value);
-      }
-
-      node->leaf = 0;
-      self->leaf_count -= 1;
-    }
-  }
-
-  // If the node exists, and it has children...
-  else
-  {
-    assert(node->children[0] != NULL);
-    assert(node->children[1] != NULL);
-
-    if (key[node->pivot_dim] < node->pivot_value)
-      pf_kdtree_insert_node(self, node, node->children[0], key, value);
-    else
-      pf_kdtree_insert_node(self, node, node->children[1], key, value);
-  }
-
-  return node;
-}
-
+  int slot;
+  pf_kdtree_node_t *node;
 
-////////////////////////////////////////////////////////////////////////////////
-// Recursive node search
-pf_kdtree_node_t *pf_kdtree_find_node(pf_kdtree_t *self, pf_kdtree_node_t *node, int key[])
-{
-  if (node->leaf)
+  for (slot = pf_kdtree_hash(self, key); self->table[slot] >= 0;
+       slot = (slot + 1) & (self->table_size - 1))
   {
-    //printf("find  : leaf %p %d %d %d\n", node, node->key[0], node->key[1], node->key[2]);
-
-    // If the keys are the same...
-    if (pf_kdtree_equal(self, key, node->key))
+    node = self->nodes + self->table[slot];
+    if (node->key[0] == key[0] && node->key[1] == key[1] && node->key[2] == key[2])
       return node;
-    else
-      return NULL;
-  }
-  else
-  {
-    //printf("find  : brch %p %d %f\n", node, node->pivot_dim, node->pivot_value);
-
-    assert(node->children[0] != NULL);
-    assert(node->children[1] != NULL);
-
-    // If the keys are different...
-    if (key[node->pivot_dim] < node->pivot_value)
-      return pf_kdtree_find_node(self, node->children[0], key);
-    else
-      return pf_kdtree_find_node(self, node->children[1], key);
   }
-
   return NULL;
 }
 
 
-////////////////////////////////////////////////////////////////////////////////
-// Recursive node printing
-/*
-void pf_kdtree_print_node(pf_kdtree_t *self, pf_kdtree_node_t *node)
-{
-  if (node->leaf)
-  {
-    printf("(%+02d %+02d %+02d)\n", node->key[0], node->key[1], node->key[2]);
-    printf("%*s", node->depth * 11, "");
-  }
-  else
-  {
-    printf("(%+02d %+02d %+02d) ", node->key[0], node->key[1], node->key[2]);
-    pf_kdtree_print_node(self, node->children[0]);
-    pf_kdtree_print_node(self, node->children[1]);
-  }
-  return;
-}
-*/
-
-
 ////////////////////////////////////////////////////////////////////////////////
 // Cluster the leaves in the tree
 void pf_kdtree_cluster(pf_kdtree_t *self)
 {
   int i;
-  int queue_count, cluster_count;
-  pf_kdtree_node_t **queue, *node;
+  int cluster_count;
+  pf_kdtree_node_t **stack, *node;
 
-  queue_count = 0;
-  queue = calloc(self->node_count, sizeof(queue[0]));
-
-  // Put all the leaves in a queue
   for (i = 0; i < self->node_count; i++)
-  {
-    node = self->nodes + i;
-    if (node->leaf)
-    {
-      node->cluster = -1;
-      assert(queue_count < self->node_count);
-      queue[queue_count++] = node;
+    self->nodes[i].cluster = -1;
 
-      // TESTING; remove
-      assert(node == pf_kdtree_find_node(self, self->root, node->key));
-    }
-  }
+  // Each node is pushed at most once, when it is labelled
+  stack = malloc(self->node_count * sizeof(stack[0]));
 
   cluster_count = 0;
 
   // Do connected components for each node
-  while (queue_count > 0)
+  for (i = self->node_count - 1; i >= 0; i--)
   {
-    node = queue[--queue_count];
+    node = self->nodes + i;
 
     // If this node has already been labelled, skip it
     if (node->cluster >= 0)
@@ -400,47 +255,58 @@ void pf_kdtree_cluster(pf_kdtree_t *self)
     // Assign a label to this cluster
     node->cluster = cluster_count++;
 
-    // Recursively label nodes in this cluster
-    pf_kdtree_cluster_node(self, node, 0);
+    // Label nodes in this cluster
+    pf_kdtree_cluster_node(self, node, stack);
   }
 
-  free(queue);
+  free(stack);
   return;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// Recursively label nodes in this cluster
-void pf_kdtree_cluster_node(pf_kdtree_t *self, pf_kdtree_node_t *node, int depth)
+// Label nodes in the cluster of the given node, iteratively to not
+// overflow the stack on large clusters
+void pf_kdtree_cluster_node(pf_kdtree_t *self, pf_kdtree_node_t *node,
+                            pf_kdtree_node_t **stack)
 {
   int i;
   int nkey[3];
+  int stack_count;
+  pf_kdtree_node_t *nnode;
 
-  for (i = 0; i < 3 * 3 * 3; i++)
-  {
-    nkey[0] = node->key[0] + (i / 9) - 1;
-    nkey[1] = node->key[1] + ((i % 9) / 3) - 1;
-    nkey[2] = node->key[2] + ((i % 9) % 3) - 1;
-
-    pf_kdtree_node_t *nnode = pf_kdtree_find_node(self, self->root, nkey);
-    if (nnode == NULL)
-      continue;
+  stack_count = 0;
+  stack[stack_count++] = node;
 
-    assert(nnode->leaf);
+  while (stack_count > 0)
+  {
+    node = stack[--stack_count];
 
-    // This node already has a label; skip it.  The label should be
-    // consistent, however.
-    if (nnode->cluster >= 0)
+    for (i = 0; i < 3 * 3 * 3; i++)
     {
-      assert(nnode->cluster == node->cluster);
-      continue;
-    }
+      nkey[0] = node->key[0] + (i / 9) - 1;
+      nkey[1] = node->key[1] + ((i % 9) / 3) - 1;
+      nkey[2] = node->key[2] + ((i % 9) % 3) - 1;
 
-    // Label this node and recurse
-    nnode->cluster = node->cluster;
+      nnode = pf_kdtree_find_node(self, nkey);
+      if (nnode == NULL)
+        continue;
 
-    pf_kdtree_cluster_node(self, nnode, depth + 1);
+      // This node already has a label; skip it.  The label should be
+      // consistent, however.
+      if (nnode->cluster >= 0)
+      {
+        assert(nnode->cluster == node->cluster);
+        continue;
+      }
+
+      // Label this node and expand it later
+      nnode->cluster = node->cluster;
+      assert(stack_count < self->node_count);
+      stack[stack_count++] = nnode;
+    }
   }
+
   return;
 }
 
@@ -452,18 +318,13 @@ void pf_kdtree_cluster_node(pf_kdtree_t *self, pf_kdtree_node_t *node, int depth
 // Draw the tree
 void pf_kdtree_draw(pf_kdtree_t *self, rtk_fig_t *fig)
 {
-  if (self->root != NULL)
-    pf_kdtree_draw_node(self, self->root, fig);
-  return;
-}
-
+  int i;
+  pf_kdtree_node_t *node;
 
-////////////////////////////////////////////////////////////////////////////////
-// Recursively draw nodes
-void pf_kdtree_draw_node(pf_kdtree_t *self, pf_kdtree_node_t *node, rtk_fig_t *fig)
-{
-  if (node->leaf)
+  for (i = 0; i < self->node_count; i++)
   {
+    node = self->nodes + i;
+
     double ox = (node->key[0] + 0.5) * self->size[0];
     double oy = (node->key[1] + 0.5) * self->size[1];
     char text[64];
@@ -476,13 +337,6 @@ void pf_kdtree_draw_node(pf_kdtree_t *self, pf_kdtree_node_t *node, rtk_fig_t *f
     snprintf(text, sizeof(text), "%d", node->cluster);
     rtk_fig_text(fig, ox, oy, 0.0, text);
   }
-  else
-  {
-    assert(node->children[0] != NULL);
-    assert(node->children[1] != NULL);
-    pf_kdtree_draw_node(self, node->children[0], fig);
-    pf_kdtree_draw_node(self, node->children[1], fig);
-  }
 
   return;
 }
@@ -42,16 +42,10 @@
 
 /// @cond EXTERNAL
 
-// Info for a node in the tree
+// Info for a node in the tree. Despite the name, the "tree" is a hash
+// table of histogram bins, the nodes are the bins (leaves).
 typedef struct pf_kdtree_node
 {
-	// Depth in the tree
-	int leaf, depth;
-
-	// Pivot dimension and value
-	int    pivot_dim;
-	double pivot_value;
-
 	// The key for this node
 	int key[3];
 
@@ -61,8 +55,8 @@ typedef struct pf_kdtree_node
 	// The cluster label (leaf nodes)
 	int cluster;
 
-	// Child nodes
-	struct pf_kdtree_node *children[2];
+	// Slot of this node in the hash table
+	int slot;
 
 } pf_kdtree_node_t;
 
@@ -72,8 +66,10 @@ typedef struct
 	// Cell size
 	double size[3];
 
-	// The root node of the tree
-	pf_kdtree_node_t *root;
+	// Open addressing hash table of node indices, -1 for empty slots,
+	// the number of slots is a power of two
+	int  table_size;
+	int *table;
 
 	// The number of nodes in the tree
 	int               node_count, node_max_count;
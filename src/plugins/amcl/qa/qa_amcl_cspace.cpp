@@ -0,0 +1,113 @@
+
+/***************************************************************************
+ *  qa_amcl_cspace.cpp - AMCL distance field cache QA
+ *
+ *  Created: Sun Oct 18 08:31:40 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../map/map.h"
+
+#include <utils/qa/qa_check.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/* Computes the distance field of a large synthetic map, saves it to a
+ * cache file and loads it again, comparing the loaded distances and the
+ * time it takes to compute and to load them. Verifies that the cache is
+ * rejected for another max_occ_dist or a modified map.
+ */
+
+// 100m x 100m warehouse with rows of shelves, 5cm resolution
+static map_t *
+synth_map()
+{
+	map_t *map    = map_alloc();
+	map->size_x   = 2000;
+	map->size_y   = 2000;
+	map->scale    = 0.05;
+	map->origin_x = 0.;
+	map->origin_y = 0.;
+	map->cells    = (map_cell_t *)malloc(sizeof(map_cell_t) * map->size_x * map->size_y);
+	for (int j = 0; j < map->size_y; ++j) {
+		for (int i = 0; i < map->size_x; ++i) {
+			bool occ = (i == 0 || j == 0 || i == map->size_x - 1 || j == map->size_y - 1);
+			occ |= (i % 100 < 20 && j > 100 && j < map->size_y - 100 && j % 400 != 0);
+			map->cells[MAP_INDEX(map, i, j)].occ_state = occ ? +1 : -1;
+		}
+	}
+	return map;
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *filename = "/tmp/qa_amcl_cspace.cspace";
+	bool        ok       = true;
+
+	map_t *map = synth_map();
+	int    n   = map->size_x * map->size_y;
+
+	long int start = qa::now_nsec();
+	map_update_cspace(map, 2.5);
+	printf("compute distance field: %8.3f msec\n", (qa::now_nsec() - start) / 1000000.);
+
+	start = qa::now_nsec();
+	if (!qa::check(map_save_cspace(map, filename) == 0, "failed to save cache")) {
+		return 1;
+	}
+	printf("save distance field:    %8.3f msec\n", (qa::now_nsec() - start) / 1000000.);
+
+	double *expected = (double *)malloc(sizeof(double) * n);
+	for (int i = 0; i < n; ++i) {
+		expected[i]            = map->cells[i].occ_dist;
+		map->cells[i].occ_dist = -1.;
+	}
+
+	start = qa::now_nsec();
+	ok &= qa::check(map_load_cspace(map, 2.5, filename) == 0, "failed to load cache");
+	printf("load distance field:    %8.3f msec\n", (qa::now_nsec() - start) / 1000000.);
+	for (int i = 0; i < n; ++i) {
+		if (!qa::check(map->cells[i].occ_dist == expected[i],
+		               "cell %i loaded %f, expected %f",
+		               i,
+		               map->cells[i].occ_dist,
+		               expected[i])) {
+			ok = false;
+			break;
+		}
+	}
+
+	ok &= qa::check(map_load_cspace(map, 2.0, filename) != 0,
+	                "cache accepted for other max_occ_dist");
+	map->cells[MAP_INDEX(map, 1000, 50)].occ_state = +1;
+	ok &= qa::check(map_load_cspace(map, 2.5, filename) != 0, "cache accepted for modified map");
+
+	free(expected);
+	map_free(map);
+	unlink(filename);
+
+	return qa::result(ok);
+}
+
+/// @endcond
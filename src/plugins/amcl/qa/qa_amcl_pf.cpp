@@ -0,0 +1,145 @@
+
+/***************************************************************************
+ *  qa_amcl_pf.cpp - AMCL particle filter update benchmark
+ *
+ *  Created: Sun Oct 18 09:05:12 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../pf/pf.h"
+
+#include <utils/qa/qa_check.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace fawkes;
+
+/* Runs global localization with an increasing maximum number of particles
+ * in a simulated 50m x 50m world with a synthetic sensor model that favors
+ * poses close to the true pose, and reports the time per resampling, per
+ * drawn sample, and the number of samples and clusters afterwards. The
+ * time per sample should stay about constant when increasing the number
+ * of particles. With enough particles to cover the world, the filter must
+ * converge to the true pose.
+ */
+
+static const double TRUE_X = 12.3, TRUE_Y = -7.4, TRUE_A = 0.7;
+
+static double
+noise(double stddev)
+{
+	return stddev * sqrt(-2. * log(1. - drand48())) * cos(2. * M_PI * drand48());
+}
+
+static pf_vector_t
+uniform_pose(void *data)
+{
+	pf_vector_t p;
+	p.v[0] = 50. * drand48() - 25.;
+	p.v[1] = 50. * drand48() - 25.;
+	p.v[2] = 2. * M_PI * drand48() - M_PI;
+	return p;
+}
+
+static void
+action_model(void *data, pf_sample_set_t *set)
+{
+	for (int i = 0; i < set->sample_count; ++i) {
+		set->samples[i].pose.v[0] += noise(0.05);
+		set->samples[i].pose.v[1] += noise(0.05);
+		set->samples[i].pose.v[2] += noise(0.02);
+	}
+}
+
+static double
+sensor_model(void *data, pf_sample_set_t *set)
+{
+	double total = 0.;
+	for (int i = 0; i < set->sample_count; ++i) {
+		pf_sample_t *s  = set->samples + i;
+		double       dx = s->pose.v[0] - TRUE_X, dy = s->pose.v[1] - TRUE_Y;
+		double       da = atan2(sin(s->pose.v[2] - TRUE_A), cos(s->pose.v[2] - TRUE_A));
+		double       d2 = dx * dx + dy * dy;
+		// broad attraction to find the true pose, peak to converge
+		s->weight *= 0.01 + exp(-d2 / 8. - da * da / 0.5) + 10. * exp(-d2 / 0.1 - da * da / 0.02);
+		total += s->weight;
+	}
+	return total;
+}
+
+int
+main(int argc, char **argv)
+{
+	int  num_samples[] = {1000, 5000, 20000, 50000};
+	bool ok            = true;
+
+	for (int n : num_samples) {
+		pf_t *pf = pf_alloc(100, n, 0.001, 0.1, uniform_pose, NULL);
+		srand48(4711);
+		pf_init_model(pf, uniform_pose, NULL);
+
+		long int     resample_nsec = 0;
+		long int     drawn         = 0;
+		unsigned int num_updates   = 30;
+		for (unsigned int u = 0; u < num_updates; ++u) {
+			pf_update_action(pf, action_model, NULL);
+			pf_update_sensor(pf, sensor_model, NULL);
+			long int start = qa::now_nsec();
+			pf_update_resample(pf);
+			resample_nsec += qa::now_nsec() - start;
+			drawn += pf->sets[pf->current_set].sample_count;
+		}
+
+		pf_sample_set_t *set = pf->sets + pf->current_set;
+		double           weight;
+		pf_vector_t      mean;
+		pf_matrix_t      cov;
+		int              best = 0;
+		double           best_weight = 0.;
+		for (int c = 0; pf_get_cluster_stats(pf, c, &weight, &mean, &cov); ++c) {
+			if (weight > best_weight) {
+				best        = c;
+				best_weight = weight;
+			}
+		}
+		pf_get_cluster_stats(pf, best, &weight, &mean, &cov);
+		printf("%6d particles: resample %8.3f msec (%6.1f nsec per sample), "
+		       "%5d samples, %4d clusters, best (%.2f, %.2f, %.2f)\n",
+		       n,
+		       resample_nsec / 1000000. / num_updates,
+		       (double)resample_nsec / drawn,
+		       set->sample_count,
+		       set->cluster_count,
+		       mean.v[0],
+		       mean.v[1],
+		       mean.v[2]);
+		if (n >= 20000) {
+			ok &= qa::check(fabs(mean.v[0] - TRUE_X) <= 0.5 && fabs(mean.v[1] - TRUE_Y) <= 0.5
+			                  && fabs(mean.v[2] - TRUE_A) <= 0.2,
+			                "filter did not converge to the true pose");
+		}
+		pf_free(pf);
+	}
+
+	return qa::result(ok);
+}
+
+/// @endcond
@@ -0,0 +1,276 @@
+
+/***************************************************************************
+ *  qa_amcl_sensor.cpp - AMCL laser sensor model benchmark
+ *
+ *  Created: Sun Oct 18 07:14:51 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../map/map.h"
+#include "../pf/pf.h"
+#include "../sensors/amcl_laser.h"
+
+#include <core/exception.h>
+#include <utils/qa/qa_check.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+using namespace fawkes;
+using namespace amcl;
+
+/* Replays a set of laser scans through pf_update_sensor for both laser
+ * models and with an increasing number of threads, reports the time per
+ * update, and verifies that the resulting particle weights are identical
+ * for any number of threads. The scan set is read from a file given with
+ * -r, otherwise scans are synthesized in a simulated room, optionally
+ * written to a file given with -w to replay them later.
+ *
+ * The scan set file contains one scan per line, consisting of the maximum
+ * range, the number of readings, and a range and bearing per reading.
+ */
+
+#define SEED 4711
+
+struct Scan
+{
+	double              range_max;
+	std::vector<double> ranges;
+	std::vector<double> bearings;
+};
+
+// 20m x 12m room with a few boxes, 5cm resolution
+static map_t *
+synth_map()
+{
+	map_t *map    = map_alloc();
+	map->size_x   = 400;
+	map->size_y   = 240;
+	map->scale    = 0.05;
+	map->origin_x = 0.;
+	map->origin_y = 0.;
+	map->cells    = (map_cell_t *)malloc(sizeof(map_cell_t) * map->size_x * map->size_y);
+	for (int j = 0; j < map->size_y; ++j) {
+		for (int i = 0; i < map->size_x; ++i) {
+			bool occ = (i == 0 || j == 0 || i == map->size_x - 1 || j == map->size_y - 1);
+			occ |= (i >= 80 && i < 100 && j >= 60 && j < 90);
+			occ |= (i >= 250 && i < 260 && j >= 20 && j < 200);
+			occ |= (i >= 300 && i < 340 && j >= 150 && j < 170);
+			map->cells[MAP_INDEX(map, i, j)].occ_state = occ ? +1 : -1;
+		}
+	}
+	return map;
+}
+
+static std::vector<Scan>
+synth_scans(map_t *map, unsigned int num_scans)
+{
+	std::vector<Scan> scans(num_scans);
+	for (unsigned int s = 0; s < num_scans; ++s) {
+		// robot driving on a circle through the room
+		double x = 3. * cos(s * 0.05), y = 2. * sin(s * 0.05), a = s * 0.05 + M_PI / 2.;
+		scans[s].range_max = 5.6;
+		for (unsigned int b = 0; b < 360; ++b) {
+			double bearing = b * M_PI / 180. - M_PI;
+			double r       = map_calc_range(map, x, y, a + bearing, 5.6);
+			if (r < 5.6)
+				r += 0.02 * (drand48() - 0.5);
+			scans[s].ranges.push_back(r);
+			scans[s].bearings.push_back(bearing);
+		}
+	}
+	return scans;
+}
+
+static std::vector<Scan>
+read_scans(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if (!f)
+		throw Exception(errno, "Failed to open scan set %s", filename);
+
+	std::vector<Scan> scans;
+	Scan              scan;
+	unsigned int      count;
+	while (fscanf(f, "%lf %u", &scan.range_max, &count) == 2) {
+		scan.ranges.resize(count);
+		scan.bearings.resize(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			if (fscanf(f, "%lf %lf", &scan.ranges[i], &scan.bearings[i]) != 2) {
+				fclose(f);
+				throw Exception("Scan %zu of %s is truncated", scans.size(), filename);
+			}
+		}
+		scans.push_back(scan);
+	}
+	fclose(f);
+	return scans;
+}
+
+static void
+write_scans(const char *filename, const std::vector<Scan> &scans)
+{
+	FILE *f = fopen(filename, "w");
+	if (!f)
+		throw Exception(errno, "Failed to open scan set %s", filename);
+	for (const Scan &scan : scans) {
+		fprintf(f, "%.17g %zu", scan.range_max, scan.ranges.size());
+		for (size_t i = 0; i < scan.ranges.size(); ++i) {
+			fprintf(f, " %.17g %.17g", scan.ranges[i], scan.bearings[i]);
+		}
+		fprintf(f, "\n");
+	}
+	fclose(f);
+}
+
+// Replay all scans, return the time per update in msec and all weights
+static double
+replay(AMCLLaser &               laser,
+       const std::vector<Scan> &scans,
+       int                      num_particles,
+       std::vector<double> &    weights)
+{
+	pf_t *pf = pf_alloc(num_particles, num_particles, 0.001, 0.1, NULL, NULL);
+
+	pf_vector_t mean = pf_vector_zero();
+	pf_matrix_t cov  = pf_matrix_zero();
+	mean.v[0]        = 3.;
+	mean.v[2]        = M_PI / 2.;
+	cov.m[0][0] = cov.m[1][1] = 0.5 * 0.5;
+	cov.m[2][2]               = 0.3 * 0.3;
+	pf_init(pf, &mean, &cov);
+
+	// pf_init() seeds its own generator, draw the same poses for each run
+	srand48(SEED);
+	pf_sample_set_t *set = pf->sets + pf->current_set;
+	for (int i = 0; i < set->sample_count; ++i) {
+		set->samples[i].pose.v[0] = mean.v[0] + (drand48() - 0.5);
+		set->samples[i].pose.v[1] = mean.v[1] + (drand48() - 0.5);
+		set->samples[i].pose.v[2] = mean.v[2] + 0.6 * (drand48() - 0.5);
+	}
+
+	AMCLLaserData ldata;
+	ldata.sensor = &laser;
+
+	weights.clear();
+	long int total_nsec = 0;
+	for (const Scan &scan : scans) {
+		ldata.range_count = scan.ranges.size();
+		ldata.range_max   = scan.range_max;
+		delete[] ldata.ranges;
+		ldata.ranges = new double[ldata.range_count][2];
+		for (int i = 0; i < ldata.range_count; ++i) {
+			ldata.ranges[i][0] = scan.ranges[i];
+			ldata.ranges[i][1] = scan.bearings[i];
+		}
+
+		long int start = qa::now_nsec();
+		laser.UpdateSensor(pf, &ldata);
+		total_nsec += qa::now_nsec() - start;
+
+		for (int i = 0; i < set->sample_count; ++i) {
+			weights.push_back(set->samples[i].weight);
+		}
+	}
+
+	pf_free(pf);
+	return total_nsec / 1000000. / scans.size();
+}
+
+static void
+print_usage(const char *progname)
+{
+	printf("Usage: %s [-r scanfile] [-w scanfile] [-n particles] [-t max_threads]\n", progname);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char * read_file     = NULL;
+	const char * write_file    = NULL;
+	int          num_particles = 5000;
+	unsigned int max_threads   = 4;
+
+	int c;
+	while ((c = getopt(argc, argv, "hr:w:n:t:")) != -1) {
+		switch (c) {
+		case 'r': read_file = optarg; break;
+		case 'w': write_file = optarg; break;
+		case 'n': num_particles = atoi(optarg); break;
+		case 't': max_threads = atoi(optarg); break;
+		default: print_usage(argv[0]); return c == 'h' ? 0 : 1;
+		}
+	}
+
+	bool ok = true;
+	try {
+		map_t *map = synth_map();
+
+		srand48(SEED);
+		std::vector<Scan> scans = read_file ? read_scans(read_file) : synth_scans(map, 50);
+		if (write_file)
+			write_scans(write_file, scans);
+		printf("Replaying %zu scans with %d particles\n", scans.size(), num_particles);
+
+		pf_vector_t laser_pose = pf_vector_zero();
+		laser_pose.v[0]        = 0.1;
+
+		for (int model = 0; model <= 1; ++model) {
+			AMCLLaser laser(60, map);
+			laser.SetLaserPose(laser_pose);
+			if (model == 0) {
+				laser.SetModelBeam(0.95, 0.05, 0.05, 0.05, 0.2, 0.1, 0.0);
+			} else {
+				laser.SetModelLikelihoodField(0.95, 0.05, 0.2, 2.5);
+			}
+
+			std::vector<double> serial_weights;
+			for (unsigned int t = 1; t <= max_threads; ++t) {
+				laser.SetNumThreads(t);
+				std::vector<double> weights;
+				double              msec = replay(laser, scans, num_particles, weights);
+				if (t == 1) {
+					serial_weights = weights;
+				} else {
+					ok &= qa::check(weights == serial_weights,
+					                "weights with %u threads differ from serial evaluation",
+					                t);
+				}
+				printf("%-16s %u thread(s): %8.3f msec per update\n",
+				       model == 0 ? "beam" : "likelihood field",
+				       t,
+				       msec);
+			}
+		}
+
+		map_free(map);
+	} catch (Exception &e) {
+		e.print_trace();
+		ok = false;
+	}
+
+	return qa::result(ok);
+}
+
+/// @endcond
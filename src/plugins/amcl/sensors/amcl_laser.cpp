@@ -66,9 +66,28 @@ AMCLLaser::AMCLLaser(size_t max_beams, map_t *map) : AMCLSensor()
 	this->lambda_short = .1;
 	this->chi_outlier  = 0.0;
 
+	this->pool = NULL;
+
 	return;
 }
 
+AMCLLaser::~AMCLLaser()
+{
+	delete this->pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Set number of threads to evaluate samples in parallel. The results do not
+// depend on the number of threads.
+void
+AMCLLaser::SetNumThreads(unsigned int num_threads)
+{
+	delete this->pool;
+	this->pool = NULL;
+	if (num_threads > 1)
+		this->pool = new AMCLWorkerPool(num_threads);
+}
+
 void
 AMCLLaser::SetModelBeam(double z_hit,
                         double z_short,
@@ -88,18 +107,23 @@ AMCLLaser::SetModelBeam(double z_hit,
 	this->chi_outlier  = chi_outlier;
 }
 
-void
-AMCLLaser::SetModelLikelihoodField(double z_hit,
-                                   double z_rand,
-                                   double sigma_hit,
-                                   double max_occ_dist)
+bool
+AMCLLaser::SetModelLikelihoodField(double      z_hit,
+                                   double      z_rand,
+                                   double      sigma_hit,
+                                   double      max_occ_dist,
+                                   const char *cspace_cache)
 {
 	this->model_type = LASER_MODEL_LIKELIHOOD_FIELD;
 	this->z_hit      = z_hit;
 	this->z_rand     = z_rand;
 	this->sigma_hit  = sigma_hit;
 
+	if (cspace_cache && map_load_cspace(this->map, max_occ_dist, cspace_cache) == 0)
+		return true;
+
 	map_update_cspace(this->map, max_occ_dist);
+	return false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -113,6 +137,8 @@ AMCLLaser::UpdateSensor(pf_t *pf, AMCLSensorData *data)
 	if (this->max_beams < 2)
 		return false;
 
+	PrepareBeams((AMCLLaserData *)data);
+
 	// Apply the laser sensor model
 	if (this->model_type == LASER_MODEL_BEAM)
 		pf_update_sensor(pf, (pf_sensor_model_fn_t)BeamModel, data);
@@ -124,16 +150,84 @@ AMCLLaser::UpdateSensor(pf_t *pf, AMCLSensorData *data)
 	return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Select the beams to use and precompute everything that does not depend
+// on the sample pose, once per scan instead of once per sample and beam
+void
+AMCLLaser::PrepareBeams(AMCLLaserData *data)
+{
+	this->beam_range.clear();
+	this->beam_bearing.clear();
+	this->beam_cos.clear();
+	this->beam_sin.clear();
+	this->beam_short.clear();
+	this->beam_const.clear();
+
+	int step = (data->range_count - 1) / (this->max_beams - 1);
+	if (step < 1)
+		step = 1;
+	for (int i = 0; i < data->range_count; i += step) {
+		double obs_range   = data->ranges[i][0];
+		double obs_bearing = data->ranges[i][1];
+
+		// The likelihood field model ignores max range readings
+		if (this->model_type == LASER_MODEL_LIKELIHOOD_FIELD && obs_range >= data->range_max)
+			continue;
+
+		this->beam_range.push_back(obs_range);
+		this->beam_bearing.push_back(obs_bearing);
+		this->beam_cos.push_back(cos(obs_bearing));
+		this->beam_sin.push_back(sin(obs_bearing));
+
+		// Beam model part 2: short reading from unexpected obstacle
+		this->beam_short.push_back(this->z_short * this->lambda_short
+		                           * exp(-this->lambda_short * obs_range));
+		// Beam model part 3 and 4: max-range and random measurements
+		if (obs_range == data->range_max)
+			this->beam_const.push_back(this->z_max * 1.0);
+		else if (obs_range < data->range_max)
+			this->beam_const.push_back(this->z_rand * 1.0 / data->range_max);
+		else
+			this->beam_const.push_back(0.0);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Evaluate all samples, on the pool if available
+double
+AMCLLaser::EvaluateSamples(AMCLLaserData *data, pf_sample_set_t *set, AMCLWorkerPool::chunk_fn_t fn)
+{
+	if (this->pool)
+		return this->pool->run(set, fn, data);
+	else
+		return AMCLWorkerPool::run_serial(set, fn, data);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Determine the probability for the given pose
 double
 AMCLLaser::BeamModel(AMCLLaserData *data, pf_sample_set_t *set)
 {
-	AMCLLaser *self         = static_cast<AMCLLaser *>(data->sensor);
-	double     total_weight = 0.0;
+	AMCLLaser *self = static_cast<AMCLLaser *>(data->sensor);
+	return self->EvaluateSamples(data, set, BeamModelChunk);
+}
+
+double
+AMCLLaser::BeamModelChunk(void *sensor_data, pf_sample_set_t *set, int first, int last)
+{
+	AMCLLaserData *data         = (AMCLLaserData *)sensor_data;
+	AMCLLaser *    self         = static_cast<AMCLLaser *>(data->sensor);
+	double         total_weight = 0.0;
+
+	const size_t  num_beams   = self->beam_range.size();
+	const double *range       = self->beam_range.data();
+	const double *bearing     = self->beam_bearing.data();
+	const double *short_term  = self->beam_short.data();
+	const double *const_term  = self->beam_const.data();
+	const double  z_hit_denom = 2 * self->sigma_hit * self->sigma_hit;
 
 	// Compute the sample weights
-	for (int j = 0; j < set->sample_count; j++) {
+	for (int j = first; j < last; j++) {
 		pf_sample_t *sample = set->samples + j;
 		pf_vector_t  pose{sample->pose};
 
@@ -142,31 +236,22 @@ AMCLLaser::BeamModel(AMCLLaserData *data, pf_sample_set_t *set)
 
 		double p = 1.0;
 
-		int step = (data->range_count - 1) / (self->max_beams - 1);
-		for (int i = 0; i < data->range_count; i += step) {
-			double obs_range   = data->ranges[i][0];
-			double obs_bearing = data->ranges[i][1];
-
+		for (size_t b = 0; b < num_beams; ++b) {
 			// Compute the range according to the map
 			double map_range =
-			  map_calc_range(self->map, pose.v[0], pose.v[1], pose.v[2] + obs_bearing, data->range_max);
-			double pz = 0.0;
+			  map_calc_range(self->map, pose.v[0], pose.v[1], pose.v[2] + bearing[b], data->range_max);
 
 			// Part 1: good, but noisy, hit
-			double z = obs_range - map_range;
-			pz += self->z_hit * exp(-(z * z) / (2 * self->sigma_hit * self->sigma_hit));
+			double z  = range[b] - map_range;
+			double pz = self->z_hit * exp(-(z * z) / z_hit_denom);
 
 			// Part 2: short reading from unexpected obstacle (e.g., a person)
 			if (z < 0)
-				pz += self->z_short * self->lambda_short * exp(-self->lambda_short * obs_range);
+				pz += short_term[b];
 
-			// Part 3: Failure to detect obstacle, reported as max-range
-			if (obs_range == data->range_max)
-				pz += self->z_max * 1.0;
-
-			// Part 4: Random measurements
-			if (obs_range < data->range_max)
-				pz += self->z_rand * 1.0 / data->range_max;
+			// Part 3 and 4: Failure to detect obstacle, reported as max-range,
+			// or random measurements
+			pz += const_term[b];
 
 			// TODO: outlier rejection for short readings
 
@@ -191,62 +276,61 @@ AMCLLaser::BeamModel(AMCLLaserData *data, pf_sample_set_t *set)
 double
 AMCLLaser::LikelihoodFieldModel(AMCLLaserData *data, pf_sample_set_t *set)
 {
-	AMCLLaser *  self;
-	int          i, j;
-	double       z, pz;
-	double       obs_range, obs_bearing;
-	double       total_weight;
-	pf_sample_t *sample;
-	pf_vector_t  pose;
-	pf_vector_t  hit;
+	AMCLLaser *self = static_cast<AMCLLaser *>(data->sensor);
+	return self->EvaluateSamples(data, set, LikelihoodFieldModelChunk);
+}
+
+double
+AMCLLaser::LikelihoodFieldModelChunk(void *sensor_data, pf_sample_set_t *set, int first, int last)
+{
+	AMCLLaserData *data         = (AMCLLaserData *)sensor_data;
+	AMCLLaser *    self         = static_cast<AMCLLaser *>(data->sensor);
+	map_t *        map          = self->map;
+	double         total_weight = 0.0;
 
-	self = (AMCLLaser *)data->sensor;
+	const size_t  num_beams = self->beam_range.size();
+	const double *range     = self->beam_range.data();
+	const double *beam_cos  = self->beam_cos.data();
+	const double *beam_sin  = self->beam_sin.data();
 
-	total_weight = 0.0;
+	// Pre-compute a couple of things
+	double z_hit_denom = 2 * self->sigma_hit * self->sigma_hit;
+	double z_rand_mult = 1.0 / data->range_max;
+
+	// map cell index of each beam's endpoint, -1 if off-map
+	std::vector<int> cells(num_beams);
 
 	// Compute the sample weights
-	for (j = 0; j < set->sample_count; j++) {
-		sample = set->samples + j;
-		pose   = sample->pose;
+	for (int j = first; j < last; j++) {
+		pf_sample_t *sample = set->samples + j;
+		pf_vector_t  pose   = sample->pose;
 
 		// Take account of the laser pose relative to the robot
 		pose = pf_vector_coord_add(self->laser_pose, pose);
 
 		double p = 1.0;
 
-		// Pre-compute a couple of things
-		double z_hit_denom = 2 * self->sigma_hit * self->sigma_hit;
-		double z_rand_mult = 1.0 / data->range_max;
-
-		int step = (data->range_count - 1) / (self->max_beams - 1);
-		for (i = 0; i < data->range_count; i += step) {
-			obs_range   = data->ranges[i][0];
-			obs_bearing = data->ranges[i][1];
-
-			// This model ignores max range readings
-			if (obs_range >= data->range_max)
-				continue;
-
-			pz = 0.0;
-
-			// Compute the endpoint of the beam
-			hit.v[0] = pose.v[0] + obs_range * cos(pose.v[2] + obs_bearing);
-			hit.v[1] = pose.v[1] + obs_range * sin(pose.v[2] + obs_bearing);
-
-			// Convert to map grid coords.
-			int mi, mj;
-			mi = MAP_GXWX(self->map, hit.v[0]);
-			mj = MAP_GYWY(self->map, hit.v[1]);
+		// Compute the endpoints of the beams and convert to map grid
+		// coords. The beam angle is the sum of pose and beam bearing, its
+		// sine and cosine follow from the precomputed ones of the bearing.
+		// There are no dependencies between beams, this loop vectorizes.
+		double ct = cos(pose.v[2]);
+		double st = sin(pose.v[2]);
+		for (size_t b = 0; b < num_beams; ++b) {
+			double hx = pose.v[0] + range[b] * (ct * beam_cos[b] - st * beam_sin[b]);
+			double hy = pose.v[1] + range[b] * (st * beam_cos[b] + ct * beam_sin[b]);
+			int    mi = MAP_GXWX(map, hx);
+			int    mj = MAP_GYWY(map, hy);
+			cells[b]  = MAP_VALID(map, mi, mj) ? MAP_INDEX(map, mi, mj) : -1;
+		}
 
+		for (size_t b = 0; b < num_beams; ++b) {
 			// Part 1: Get distance from the hit to closest obstacle.
 			// Off-map penalized as max distance
-			if (!MAP_VALID(self->map, mi, mj))
-				z = self->map->max_occ_dist;
-			else
-				z = self->map->cells[MAP_INDEX(self->map, mi, mj)].occ_dist;
+			double z = (cells[b] < 0) ? map->max_occ_dist : map->cells[cells[b]].occ_dist;
 			// Gaussian model
 			// NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
-			pz += self->z_hit * exp(-(z * z) / z_hit_denom);
+			double pz = self->z_hit * exp(-(z * z) / z_hit_denom);
 			// Part 2: random measurements
 			pz += self->z_rand * z_rand_mult;
 
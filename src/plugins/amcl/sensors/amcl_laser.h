@@ -37,6 +37,9 @@
 
 #include "../map/map.h"
 #include "amcl_sensor.h"
+#include "amcl_worker_pool.h"
+
+#include <vector>
 
 /// @cond EXTERNAL
 
@@ -74,6 +77,14 @@ class AMCLLaser : public AMCLSensor
 public:
 	AMCLLaser(size_t max_beams, map_t *map);
 
+	// Default destructor
+public:
+	virtual ~AMCLLaser();
+
+	// Evaluate samples with the given number of threads, 1 to disable
+public:
+	void SetNumThreads(unsigned int num_threads);
+
 public:
 	void SetModelBeam(double z_hit,
 	                  double z_short,
@@ -83,8 +94,17 @@ public:
 	                  double labda_short,
 	                  double chi_outlier);
 
+	// Set the likelihood field model. If cspace_cache is given, the distance
+	// field is loaded from that file if it matches the map and max_occ_dist,
+	// otherwise it is computed. Returns true if the distance field was loaded
+	// from the cache, false if it has been computed and the cache, if any,
+	// should be written with map_save_cspace().
 public:
-	void SetModelLikelihoodField(double z_hit, double z_rand, double sigma_hit, double max_occ_dist);
+	bool SetModelLikelihoodField(double      z_hit,
+	                             double      z_rand,
+	                             double      sigma_hit,
+	                             double      max_occ_dist,
+	                             const char *cspace_cache = NULL);
 
 	// Update the filter based on the sensor model.  Returns true if the
 	// filter has been updated.
@@ -106,6 +126,22 @@ private:
 private:
 	static double LikelihoodFieldModel(AMCLLaserData *data, pf_sample_set_t *set);
 
+	// Determine the probability for a range of samples
+private:
+	static double BeamModelChunk(void *data, pf_sample_set_t *set, int first, int last);
+
+private:
+	static double LikelihoodFieldModelChunk(void *data, pf_sample_set_t *set, int first, int last);
+
+	// Evaluate all samples, in parallel if a pool is set
+private:
+	double
+	EvaluateSamples(AMCLLaserData *data, pf_sample_set_t *set, AMCLWorkerPool::chunk_fn_t fn);
+
+	// Select beams of the current scan and precompute per-beam values
+private:
+	void PrepareBeams(AMCLLaserData *data);
+
 private:
 	laser_model_t model_type;
 
@@ -149,6 +185,20 @@ private:
 	// Threshold for outlier rejection (unused)
 private:
 	double chi_outlier;
+
+	// Threads to evaluate samples, NULL to evaluate serially
+private:
+	AMCLWorkerPool *pool;
+
+	// Selected beams of the current scan, structure of arrays
+private:
+	std::vector<double> beam_range;
+	std::vector<double> beam_bearing;
+	std::vector<double> beam_cos;
+	std::vector<double> beam_sin;
+	// Beam model: short reading term, max range and random term
+	std::vector<double> beam_short;
+	std::vector<double> beam_const;
 };
 
 } // namespace amcl
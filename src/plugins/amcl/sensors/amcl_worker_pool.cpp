@@ -0,0 +1,171 @@
+/***************************************************************************
+ *  amcl_worker_pool.cpp: Parallel evaluation of AMCL sample weights
+ *
+ *  Created: Sun Oct 18 06:20:14 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "amcl_worker_pool.h"
+
+#include <core/threading/barrier.h>
+#include <core/threading/thread.h>
+
+#include <algorithm>
+
+using namespace fawkes;
+
+namespace amcl {
+
+/// @cond INTERNALS
+class AMCLWorkerPool::Worker : public Thread
+{
+public:
+	Worker(AMCLWorkerPool *pool, unsigned int index)
+	: Thread("AMCLWorkerPool::Worker", Thread::OPMODE_WAITFORWAKEUP), pool_(pool)
+	{
+		set_name("AMCLWorkerPool::Worker(%u)", index);
+	}
+
+	virtual void
+	loop()
+	{
+		pool_->process();
+	}
+
+private:
+	AMCLWorkerPool *pool_;
+};
+/// @endcond
+
+/** @class AMCLWorkerPool "amcl_worker_pool.h"
+ * Pool of threads to update the weights of a sample set in parallel.
+ * The samples are split into chunks of CHUNK_SIZE samples, which the
+ * calling thread and the worker threads take from a shared counter until
+ * all chunks have been processed. The weight sums of the chunks are then
+ * added up in chunk order. Since the chunks do not depend on the number
+ * of threads and the weight of each sample is computed independently,
+ * the resulting weights and total are bit-identical for any number of
+ * threads, including run_serial().
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * @param num_threads number of threads to use, including the thread calling
+ * run(), hence num_threads - 1 worker threads are started
+ */
+AMCLWorkerPool::AMCLWorkerPool(unsigned int num_threads)
+{
+	num_threads = std::max(1u, num_threads);
+	barrier_    = new Barrier(num_threads);
+	set_        = NULL;
+	fn_         = NULL;
+	data_       = NULL;
+	num_chunks_ = 0;
+	next_chunk_ = 0;
+
+	for (unsigned int i = 1; i < num_threads; ++i) {
+		Worker *w = new Worker(this, i);
+		w->start();
+		workers_.push_back(w);
+	}
+}
+
+/** Destructor. */
+AMCLWorkerPool::~AMCLWorkerPool()
+{
+	for (Worker *w : workers_) {
+		w->cancel();
+		w->join();
+		delete w;
+	}
+	delete barrier_;
+}
+
+/** Get number of threads.
+ * @return number of threads used, including the calling thread
+ */
+unsigned int
+AMCLWorkerPool::num_threads() const
+{
+	return workers_.size() + 1;
+}
+
+/** Update the weights of all samples.
+ * Must be called from a single thread at a time. The calling thread
+ * participates in processing the chunks and returns once all have been
+ * processed.
+ * @param set sample set to update
+ * @param fn function to update a range of samples
+ * @param data data passed to fn
+ * @return total weight of all samples
+ */
+double
+AMCLWorkerPool::run(pf_sample_set_t *set, chunk_fn_t fn, void *data)
+{
+	set_        = set;
+	fn_         = fn;
+	data_       = data;
+	num_chunks_ = (set->sample_count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunk_weights_.resize(num_chunks_);
+	next_chunk_.store(0, std::memory_order_relaxed);
+
+	if (num_chunks_ > 1) {
+		for (Worker *w : workers_) {
+			w->wakeup(barrier_);
+		}
+		process();
+		barrier_->wait();
+	} else {
+		process();
+	}
+
+	double total = 0.;
+	for (int c = 0; c < num_chunks_; ++c) {
+		total += chunk_weights_[c];
+	}
+	return total;
+}
+
+/** Update the weights of all samples in the calling thread.
+ * Yields the same result as run() on a pool of any size.
+ * @param set sample set to update
+ * @param fn function to update a range of samples
+ * @param data data passed to fn
+ * @return total weight of all samples
+ */
+double
+AMCLWorkerPool::run_serial(pf_sample_set_t *set, chunk_fn_t fn, void *data)
+{
+	double total = 0.;
+	for (int first = 0; first < set->sample_count; first += CHUNK_SIZE) {
+		total += fn(data, set, first, std::min(first + CHUNK_SIZE, set->sample_count));
+	}
+	return total;
+}
+
+/** Process chunks until none is left. */
+void
+AMCLWorkerPool::process()
+{
+	int c;
+	while ((c = next_chunk_.fetch_add(1, std::memory_order_relaxed)) < num_chunks_) {
+		int first         = c * CHUNK_SIZE;
+		int last          = std::min(first + CHUNK_SIZE, set_->sample_count);
+		chunk_weights_[c] = fn_(data_, set_, first, last);
+	}
+}
+
+} // namespace amcl
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *  amcl_worker_pool.h: Parallel evaluation of AMCL sample weights
+ *
+ *  Created: Sun Oct 18 06:20:14 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef AMCL_WORKER_POOL_H
+#define AMCL_WORKER_POOL_H
+
+#include "../pf/pf.h"
+
+#include <atomic>
+#include <vector>
+
+namespace fawkes {
+class Barrier;
+}
+
+namespace amcl {
+
+class AMCLWorkerPool
+{
+public:
+	/** Function to update the weights of a range of samples.
+	 * @param data data passed to run()
+	 * @param set sample set
+	 * @param first index of first sample to update
+	 * @param last index after the last sample to update
+	 * @return sum of the updated weights of the samples in the range
+	 */
+	typedef double (*chunk_fn_t)(void *data, pf_sample_set_t *set, int first, int last);
+
+	/** Number of samples processed as one unit. */
+	static const int CHUNK_SIZE = 64;
+
+	AMCLWorkerPool(unsigned int num_threads);
+	~AMCLWorkerPool();
+
+	unsigned int num_threads() const;
+
+	double        run(pf_sample_set_t *set, chunk_fn_t fn, void *data);
+	static double run_serial(pf_sample_set_t *set, chunk_fn_t fn, void *data);
+
+private:
+	/// @cond INTERNALS
+	class Worker;
+	/// @endcond
+
+	void process();
+
+private:
+	std::vector<Worker *> workers_;
+	fawkes::Barrier *     barrier_;
+
+	pf_sample_set_t *   set_;
+	chunk_fn_t          fn_;
+	void *              data_;
+	int                 num_chunks_;
+	std::atomic<int>    next_chunk_;
+	std::vector<double> chunk_weights_;
+};
+
+} // namespace amcl
+
+#endif
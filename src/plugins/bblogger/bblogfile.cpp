@@ -22,13 +22,18 @@
 
 #include "bblogfile.h"
 
+#include "compression.h"
+
 #include <blackboard/internal/instance_factory.h>
 #include <core/exceptions/system.h>
 #include <utils/misc/strndup.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
+#include <vector>
 #ifdef __FreeBSD__
 #	include <sys/endian.h>
 #elif defined(__MACH__) && defined(__APPLE__)
@@ -40,6 +45,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <unistd.h>
 
@@ -48,6 +54,25 @@ using namespace fawkes;
 /** @class BBLogFile "bblogfile.h"
  * Class to easily access bblogger log files.
  * This class provides an easy way to interact with bblogger log files.
+ *
+ * The file is memory-mapped, reading an entry copies the data directly
+ * from the mapping into the interface, entry_data() provides access to
+ * the data without any copy. If the file grows while it is read, e.g. if
+ * it is watched while being written, the mapping is updated as needed.
+ *
+ * Files of version 2 have a time index at the end (see
+ * bblog_index_entry), which is used to find entries by their time offset
+ * with find_entry() and seek(). Files without an index, i.e. files of
+ * version 1 or files which were not properly closed, are searched by a
+ * binary search over the entry headers, which is correct but touches
+ * more of the file.
+ *
+ * Compressed files (version 3) consist of independently compressed blocks
+ * of entries (see bblog_block_header). On opening, the block headers are
+ * scanned to build a table of blocks, which is then used to find entries
+ * by their index or time offset. An entry is accessed by decompressing
+ * its block, the most recently decompressed block is kept such that
+ * reading entries sequentially decompresses each block only once.
  * @author Tim Niemueller
  */
 
@@ -71,7 +96,10 @@ BBLogFile::BBLogFile(const char *filename, fawkes::Interface *interface, bool do
 		interface_ = interface;
 		if ((strcmp(interface_->type(), interface_type_) != 0)
 		    || (strcmp(interface_->id(), interface_id_) != 0)) {
-			fclose(f_);
+			unmap();
+			close(fd_);
+			free(block_data_);
+			free(header_);
 			free(filename_);
 			free(scenario_);
 			std::string interface_type(interface_type_);
@@ -109,28 +137,46 @@ BBLogFile::BBLogFile(const char *filename, bool do_sanity_check)
 void
 BBLogFile::ctor(const char *filename, bool do_sanity_check)
 {
-	f_ = fopen(filename, "r");
-	if (!f_) {
+	fd_ = open(filename, O_RDONLY);
+	if (fd_ == -1) {
 		throw CouldNotOpenFileException(filename, errno);
 	}
 
-	filename_ = strdup(filename);
-	header_   = (bblog_file_header *)malloc(sizeof(bblog_file_header));
+	filename_          = strdup(filename);
+	header_            = (bblog_file_header *)malloc(sizeof(bblog_file_header));
+	scenario_          = NULL;
+	interface_type_    = NULL;
+	interface_id_      = NULL;
+	map_               = NULL;
+	map_size_          = 0;
+	data_end_          = 0;
+	pos_               = 0;
+	index_offset_      = 0;
+	num_index_entries_ = 0;
+	index_stride_      = 0;
+	blocks_end_        = 0;
+	num_block_entries_ = 0;
+	block_data_        = NULL;
+	block_data_size_   = 0;
+	cached_block_      = (size_t)-1;
 
 	try {
 		read_file_header();
+		entry_size_ = sizeof(bblog_entry_header) + header_->data_size;
+		update_mapping();
 		if (do_sanity_check)
 			sanity_check();
 	} catch (Exception &e) {
+		unmap();
+		free(block_data_);
+		free(header_);
 		free(filename_);
 		free(scenario_);
 		free(interface_type_);
 		free(interface_id_);
-		fclose(f_);
+		close(fd_);
 		throw;
 	}
-
-	ifdata_ = malloc(header_->data_size);
 }
 
 /** Destructor. */
@@ -141,36 +187,50 @@ BBLogFile::~BBLogFile()
 		instance_factory_.reset();
 	}
 
-	fclose(f_);
+	unmap();
+	close(fd_);
 
 	free(filename_);
 	free(scenario_);
 	free(interface_type_);
 	free(interface_id_);
 
+	free(block_data_);
 	free(header_);
-	free(ifdata_);
 }
 
 /** Read file header. */
 void
 BBLogFile::read_file_header()
 {
-	uint32_t magic;
-	uint32_t version;
-	if ((fread(&magic, sizeof(uint32_t), 1, f_) == 1)
-	    && (fread(&version, sizeof(uint32_t), 1, f_) == 1)) {
-		if ((ntohl(magic) == BBLOGGER_FILE_MAGIC) && (ntohl(version) == BBLOGGER_FILE_VERSION)) {
-			::rewind(f_);
-			if (fread(header_, sizeof(bblog_file_header), 1, f_) != 1) {
+	uint32_t magic_version[2];
+	if (pread(fd_, magic_version, sizeof(magic_version), 0) == sizeof(magic_version)) {
+		uint32_t magic   = ntohl(magic_version[0]);
+		uint32_t version = ntohl(magic_version[1]);
+		// version 1 files differ only in missing the index
+		if ((magic == BBLOGGER_FILE_MAGIC) && (version >= 1)
+		    && (version <= BBLOGGER_FILE_VERSION_COMPRESSED)) {
+			if (pread(fd_, header_, sizeof(bblog_file_header), 0) != sizeof(bblog_file_header)) {
 				throw FileReadException(filename_, errno, "Failed to read file header");
 			}
 		} else {
 			throw Exception("File magic/version %X/%u does not match (expected %X/%u)",
-			                ntohl(magic),
-			                ntohl(version),
-			                BBLOGGER_FILE_VERSION,
-			                BBLOGGER_FILE_MAGIC);
+			                magic,
+			                version,
+			                BBLOGGER_FILE_MAGIC,
+			                BBLOGGER_FILE_VERSION_COMPRESSED);
+		}
+		if ((version == BBLOGGER_FILE_VERSION_COMPRESSED)
+		    != (header_->compression != BBLOG_COMPRESSION_NONE)) {
+			throw Exception("File %s has version %u but compression %u",
+			                filename_,
+			                version,
+			                header_->compression);
+		}
+		if (!BBLogCompression::available(header_->compression)) {
+			throw Exception("File %s is compressed with %s, which is not available",
+			                filename_,
+			                BBLogCompression::name(header_->compression));
 		}
 	} else {
 		throw Exception(filename_, errno, "Failed to read magic/version from file");
@@ -183,6 +243,215 @@ BBLogFile::read_file_header()
 	start_time_.set_time(header_->start_time_sec, header_->start_time_usec);
 }
 
+/** Read index trailer.
+ * Determines whether the file has a valid index and where the entries end.
+ */
+void
+BBLogFile::read_index_trailer()
+{
+	index_offset_      = 0;
+	num_index_entries_ = 0;
+	index_stride_      = 0;
+	data_end_          = map_size_;
+
+	if ((file_version() != 2)
+	    || (map_size_ < sizeof(bblog_file_header) + sizeof(bblog_index_trailer))) {
+		return;
+	}
+
+	bblog_index_trailer trailer;
+	memcpy(&trailer, map_ + map_size_ - sizeof(bblog_index_trailer), sizeof(bblog_index_trailer));
+	if ((ntohl(trailer.index_magic) == BBLOGGER_INDEX_MAGIC) && (trailer.index_stride > 0)
+	    && (trailer.index_offset >= sizeof(bblog_file_header))
+	    && (trailer.index_offset + trailer.num_index_entries * sizeof(bblog_index_entry)
+	          + sizeof(bblog_index_trailer)
+	        == map_size_)) {
+		index_offset_      = trailer.index_offset;
+		num_index_entries_ = trailer.num_index_entries;
+		index_stride_      = trailer.index_stride;
+		data_end_          = index_offset_;
+	}
+}
+
+/** Update memory mapping to current file size.
+ * @return true if the mapping has been changed, false if the file size
+ * has not changed
+ */
+bool
+BBLogFile::update_mapping()
+{
+	size_t fsize = file_size();
+	if (map_ && (fsize == map_size_)) {
+		return false;
+	}
+	if (fsize < sizeof(bblog_file_header)) {
+		throw Exception("File %s is too short to be a log file", filename_);
+	}
+
+	unmap();
+	void *m = mmap(NULL, fsize, PROT_READ, MAP_SHARED, fd_, 0);
+	if (m == MAP_FAILED) {
+		throw Exception(errno, "Failed to mmap log file %s", filename_);
+	}
+	// the common case is replaying the log from start to end
+	madvise(m, fsize, MADV_SEQUENTIAL);
+	map_      = (char *)m;
+	map_size_ = fsize;
+
+	read_index_trailer();
+	if (compression() != BBLOG_COMPRESSION_NONE) {
+		scan_blocks();
+	}
+	return true;
+}
+
+/** Scan block headers of compressed file.
+ * Extends the block table by all complete blocks which have been added
+ * since the last scan, the end of the entries is set to the end of the
+ * last complete block.
+ */
+void
+BBLogFile::scan_blocks()
+{
+	if (blocks_end_ > map_size_) {
+		// file shrank, start from scratch
+		blocks_.clear();
+		num_block_entries_ = 0;
+		cached_block_      = (size_t)-1;
+	}
+	size_t offset = blocks_.empty() ? sizeof(bblog_file_header) : blocks_end_;
+
+	while (offset + sizeof(bblog_block_header) <= map_size_) {
+		bblog_block_header bhead;
+		memcpy(&bhead, map_ + offset, sizeof(bhead));
+		if ((bhead.num_entries == 0) || (bhead.compressed_size > map_size_ - offset - sizeof(bhead))) {
+			// incomplete block, still being written or truncated
+			break;
+		}
+		Block block;
+		block.offset      = offset;
+		block.first_entry = num_block_entries_;
+		block.num_entries = bhead.num_entries;
+		block.time_usec   = (uint64_t)bhead.rel_time_sec * 1000000 + bhead.rel_time_usec;
+		blocks_.push_back(block);
+		num_block_entries_ += bhead.num_entries;
+		offset += sizeof(bhead) + bhead.compressed_size;
+	}
+	blocks_end_ = offset;
+	data_end_   = offset;
+}
+
+/** Remove memory mapping. */
+void
+BBLogFile::unmap()
+{
+	if (map_) {
+		munmap(map_, map_size_);
+		map_      = NULL;
+		map_size_ = 0;
+	}
+}
+
+/** Get number of entries in the current mapping.
+ * @return number of complete entries
+ */
+size_t
+BBLogFile::mapped_entries() const
+{
+	if (compression() != BBLOG_COMPRESSION_NONE) {
+		return num_block_entries_;
+	}
+	return (data_end_ - sizeof(bblog_file_header)) / entry_size_;
+}
+
+/** Get entry.
+ * @param index index of entry, must be less than mapped_entries()
+ * @return pointer to entry header, immediately followed by the data,
+ * either in the mapping or in the current decompressed block
+ */
+const char *
+BBLogFile::entry(size_t index)
+{
+	if (compression() == BBLOG_COMPRESSION_NONE) {
+		return map_ + sizeof(bblog_file_header) + index * entry_size_;
+	}
+
+	size_t b = cached_block_;
+	if ((b >= blocks_.size()) || (index < blocks_[b].first_entry)
+	    || (index >= blocks_[b].first_entry + blocks_[b].num_entries)) {
+		// last block with a first entry not after index
+		b = std::upper_bound(blocks_.begin(),
+		                     blocks_.end(),
+		                     index,
+		                     [](size_t i, const Block &block) { return i < block.first_entry; })
+		    - blocks_.begin() - 1;
+		decode_block(b);
+	}
+	return block_data_ + (index - blocks_[b].first_entry) * entry_size_;
+}
+
+/** Decompress a block.
+ * @param block index of block to decompress into the block buffer
+ * @exception Exception thrown if the block cannot be decompressed
+ */
+void
+BBLogFile::decode_block(size_t block)
+{
+	const Block &b    = blocks_[block];
+	size_t       size = b.num_entries * entry_size_;
+	if (size > block_data_size_) {
+		char *d = (char *)realloc(block_data_, size);
+		if (!d) {
+			throw OutOfMemoryException("Cannot allocate %zu bytes for log block", size);
+		}
+		block_data_      = d;
+		block_data_size_ = size;
+	}
+
+	bblog_block_header bhead;
+	memcpy(&bhead, map_ + b.offset, sizeof(bhead));
+	cached_block_ = (size_t)-1;
+	try {
+		BBLogCompression::decompress(header_->compression,
+		                             map_ + b.offset + sizeof(bhead),
+		                             bhead.compressed_size,
+		                             block_data_,
+		                             size);
+	} catch (Exception &e) {
+		e.append("Failed to decompress block %zu at offset %zu of %s", block, b.offset, filename_);
+		throw;
+	}
+	BBLogCompression::delta_decode(block_data_,
+	                               b.num_entries,
+	                               entry_size_,
+	                               sizeof(bblog_entry_header));
+	cached_block_ = block;
+}
+
+/** Get time offset of an entry.
+ * @param index index of entry, must be less than mapped_entries()
+ * @return time offset in microseconds
+ */
+uint64_t
+BBLogFile::entry_time_usec(size_t index)
+{
+	bblog_entry_header ehead;
+	memcpy(&ehead, entry(index), sizeof(ehead));
+	return (uint64_t)ehead.rel_time_sec * 1000000 + ehead.rel_time_usec;
+}
+
+/** Get time offset of an index entry.
+ * @param index index of index entry, must be less than num_index_entries()
+ * @return time offset in microseconds
+ */
+uint64_t
+BBLogFile::index_time_usec(size_t index) const
+{
+	bblog_index_entry ientry;
+	memcpy(&ientry, map_ + index_offset_ + index * sizeof(bblog_index_entry), sizeof(ientry));
+	return (uint64_t)ientry.rel_time_sec * 1000000 + ientry.rel_time_usec;
+}
+
 /** Perform sanity checks.
  * This methods performs some sanity checks like:
  * - check if number of items is 0
@@ -199,24 +468,31 @@ BBLogFile::sanity_check()
 		throw e;
 	}
 
-	struct stat fs;
-	if (fstat(fileno(f_), &fs) != 0) {
-		Exception e(errno, "Failed to stat file %s", filename_);
-		e.set_type_id("bblogfile-stat-failed");
-		throw e;
-	}
-
-	long int expected_size = sizeof(bblog_file_header)
-	                         + (size_t)header_->num_data_items * header_->data_size
-	                         + (size_t)header_->num_data_items * sizeof(bblog_entry_header);
-	if (expected_size != fs.st_size) {
-		Exception e("Size of file %s does not match expectation "
-		            "(actual: %li, actual: %li)",
-		            filename_,
-		            expected_size,
-		            (long int)fs.st_size);
-		e.set_type_id("bblogfile-file-size-mismatch");
-		throw e;
+	if (compression() != BBLOG_COMPRESSION_NONE) {
+		if ((header_->num_data_items != num_block_entries_) || (blocks_end_ != map_size_)) {
+			Exception e("Blocks in file %s do not match expectation "
+			            "(expected: %u entries, actual: %zu entries, %zu extra bytes)",
+			            filename_,
+			            header_->num_data_items,
+			            num_block_entries_,
+			            map_size_ - blocks_end_);
+			e.set_type_id("bblogfile-file-size-mismatch");
+			throw e;
+		}
+	} else {
+		// entries end at the index, if there is one, or at the end of the file
+		long int expected_size = sizeof(bblog_file_header)
+		                         + (size_t)header_->num_data_items * header_->data_size
+		                         + (size_t)header_->num_data_items * sizeof(bblog_entry_header);
+		if (expected_size != (long int)data_end_) {
+			Exception e("Size of entries in file %s does not match expectation "
+			            "(expected: %li, actual: %li)",
+			            filename_,
+			            expected_size,
+			            (long int)data_end_);
+			e.set_type_id("bblogfile-file-size-mismatch");
+			throw e;
+		}
 	}
 
 #if BYTE_ORDER_ == LITTLE_ENDIAN_
@@ -237,13 +513,10 @@ BBLogFile::sanity_check()
 void
 BBLogFile::read_index(unsigned int index)
 {
-	long offset =
-	  sizeof(bblog_file_header) + (sizeof(bblog_entry_header) + header_->data_size) * index;
-
-	if (fseek(f_, offset, SEEK_SET) != 0) {
-		throw Exception(errno, "Cannot seek to index %u", index);
+	if ((index >= mapped_entries()) && (!update_mapping() || (index >= mapped_entries()))) {
+		throw Exception("Cannot seek to index %u", index);
 	}
-
+	pos_ = index;
 	read_next();
 }
 
@@ -253,26 +526,124 @@ BBLogFile::read_index(unsigned int index)
 void
 BBLogFile::rewind()
 {
-	if (fseek(f_, sizeof(bblog_file_header), SEEK_SET) != 0) {
-		throw Exception(errno, "Cannot reset file");
+	pos_ = 0;
+	entry_offset_.set_time(0, 0);
+}
+
+/** Find entry by time offset.
+ * Performs a binary search for the entry using the time index, if the file
+ * has one, the block table for compressed files, and the entry headers
+ * otherwise. For compressed files at most one block is decompressed.
+ * Time offsets of entries are
+ * assumed to be monotonically increasing, as written by the bblogger.
+ * @param offset time offset relative to the start time of the log
+ * @return index of the first entry with a time offset equal to or
+ * greater than the given offset, or the number of entries if there is no
+ * such entry
+ */
+size_t
+BBLogFile::find_entry(const fawkes::Time &offset)
+{
+	if (!has_index())
+		update_mapping();
+
+	if (offset.in_usec() <= 0)
+		return 0;
+	uint64_t offset_usec = offset.in_usec();
+
+	size_t lo = 0;
+	size_t hi = mapped_entries();
+
+	if (has_index()) {
+		// first index entry not before offset, narrows down to one stride
+		size_t ilo = 0, ihi = num_index_entries_;
+		while (ilo < ihi) {
+			size_t m = ilo + (ihi - ilo) / 2;
+			if (index_time_usec(m) < offset_usec) {
+				ilo = m + 1;
+			} else {
+				ihi = m;
+			}
+		}
+		if (ilo > 0)
+			lo = std::min(hi, (ilo - 1) * index_stride_);
+		if (ilo < num_index_entries_)
+			hi = std::min(hi, ilo * index_stride_);
+	} else if (!blocks_.empty()) {
+		// first block not before offset, the entry is in the block before or
+		// is the first entry of that block
+		size_t b = std::lower_bound(blocks_.begin(),
+		                            blocks_.end(),
+		                            offset_usec,
+		                            [](const Block &block, uint64_t t) { return block.time_usec < t; })
+		           - blocks_.begin();
+		if (b > 0)
+			lo = blocks_[b - 1].first_entry;
+		if (b < blocks_.size())
+			hi = blocks_[b].first_entry;
 	}
+
+	while (lo < hi) {
+		size_t m = lo + (hi - lo) / 2;
+		if (entry_time_usec(m) < offset_usec) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+/** Seek to time offset.
+ * Moves the file cursor immediately before the first entry with a time
+ * offset equal to or greater than the given offset.
+ * @param offset time offset relative to the start time of the log
+ * @see find_entry()
+ */
+void
+BBLogFile::seek(const fawkes::Time &offset)
+{
+	pos_ = find_entry(offset);
 	entry_offset_.set_time(0, 0);
 }
 
+/** Get data of an entry.
+ * This provides direct access to the entry data in the memory-mapped file
+ * without copying it, or in the decompressed block for compressed files.
+ * It does not change the file cursor.
+ * @param index index of entry, 0-based
+ * @param offset if not NULL, set to the time offset of the entry
+ * @return pointer to the data of the entry, valid until the next call to
+ * a method of this object that may update the mapping or decompress
+ * another block, e.g. has_next(), read_next(), or remaining_entries()
+ * @exception Exception thrown if the index is out of range
+ */
+const void *
+BBLogFile::entry_data(size_t index, fawkes::Time *offset)
+{
+	if ((index >= mapped_entries()) && (!update_mapping() || (index >= mapped_entries()))) {
+		throw Exception("Entry index %zu out of range", index);
+	}
+	const char *e = entry(index);
+	if (offset) {
+		bblog_entry_header ehead;
+		memcpy(&ehead, e, sizeof(ehead));
+		offset->set_time(ehead.rel_time_sec, ehead.rel_time_usec);
+	}
+	return e + sizeof(bblog_entry_header);
+}
+
 /** Check if another entry is available.
  * @return true if a consecutive read_next() will succeed, false otherwise
  */
 bool
 BBLogFile::has_next()
 {
-	// we always re-test to support continuous file watching
-	clearerr(f_);
-	if (getc(f_) == EOF) {
-		return false;
-	} else {
-		fseek(f_, -1, SEEK_CUR);
+	if (pos_ < mapped_entries()) {
 		return true;
 	}
+	// we always re-test to support continuous file watching
+	return update_mapping() && (pos_ < mapped_entries());
 }
 
 /** Read next entry.
@@ -282,15 +653,16 @@ BBLogFile::has_next()
 void
 BBLogFile::read_next()
 {
-	bblog_entry_header entryh;
-
-	if ((fread(&entryh, sizeof(bblog_entry_header), 1, f_) == 1)
-	    && (fread(ifdata_, header_->data_size, 1, f_) == 1)) {
-		entry_offset_.set_time(entryh.rel_time_sec, entryh.rel_time_usec);
-		interface_->set_from_chunk(ifdata_);
-	} else {
+	if (!has_next()) {
 		throw Exception("Cannot read interface data");
 	}
+
+	const char *       e = entry(pos_);
+	bblog_entry_header entryh;
+	memcpy(&entryh, e, sizeof(bblog_entry_header));
+	entry_offset_.set_time(entryh.rel_time_sec, entryh.rel_time_usec);
+	interface_->set_from_chunk((void *)(e + sizeof(bblog_entry_header)));
+	pos_ += 1;
 }
 
 /** Set number of entries.
@@ -302,13 +674,14 @@ void
 BBLogFile::set_num_entries(size_t num_entries)
 {
 #if _POSIX_MAPPED_FILES
-	void *h = mmap(NULL, sizeof(bblog_file_header), PROT_WRITE, MAP_SHARED, fileno(f_), 0);
+	void *h = mmap(NULL, sizeof(bblog_file_header), PROT_WRITE, MAP_SHARED, fd_, 0);
 	if (h == MAP_FAILED) {
 		throw Exception(errno, "Failed to mmap log, not updating number of data items");
 	} else {
 		bblog_file_header *header = (bblog_file_header *)h;
 		header->num_data_items    = num_entries;
 		munmap(h, sizeof(bblog_file_header));
+		header_->num_data_items = num_entries;
 	}
 #else
 	throw Exception("Cannot set number of entries, mmap not available.");
@@ -322,7 +695,8 @@ BBLogFile::set_num_entries(size_t num_entries)
 void
 BBLogFile::repair_file(const char *filename)
 {
-	BBLogFile file(filename, NULL, false);
+	// no interface instance required to repair
+	BBLogFile file(filename, false);
 	file.repair();
 }
 
@@ -333,11 +707,13 @@ BBLogFile::repair_file(const char *filename)
 void
 BBLogFile::repair()
 {
-	FILE *f = freopen(filename_, "r+", f_);
-	if (!f) {
+	int fd = open(filename_, O_RDWR);
+	if (fd == -1) {
 		throw Exception("Reopening file %s with new mode failed", filename_);
 	}
-	f_ = f;
+	unmap();
+	close(fd_);
+	fd_ = fd;
 
 	bool repair_done = false;
 
@@ -353,31 +729,30 @@ BBLogFile::repair()
 		throw Exception("File %s has incompatible endianess. Cannot repair.", filename_);
 	}
 
-	struct stat fs;
-	if (fstat(fileno(f_), &fs) != 0) {
-		throw Exception(errno, "Failed to stat file %s", filename_);
-	}
+	update_mapping();
 
-	size_t entry_size       = sizeof(bblog_entry_header) + header_->data_size;
-	size_t all_entries_size = fs.st_size - sizeof(bblog_file_header);
-	size_t num_entries      = all_entries_size / entry_size;
-	size_t extra_bytes      = all_entries_size % entry_size;
+	size_t num_entries, extra_bytes, valid_end;
+	if (compression() != BBLOG_COMPRESSION_NONE) {
+		// an incomplete last block cannot be decompressed
+		num_entries = num_block_entries_;
+		extra_bytes = map_size_ - blocks_end_;
+		valid_end   = blocks_end_;
+	} else {
+		size_t all_entries_size = data_end_ - sizeof(bblog_file_header);
+		num_entries             = all_entries_size / entry_size_;
+		extra_bytes             = all_entries_size % entry_size_;
+		valid_end               = data_end_ - extra_bytes;
+	}
 
 	if (extra_bytes != 0) {
 		success.append("FIXING: errorneous bytes at end of file, "
 		               "truncating by %zu b",
 		               extra_bytes);
-		if (ftruncate(fileno(f_), fs.st_size - extra_bytes) == -1) {
+		unmap();
+		if (ftruncate(fd_, valid_end) == -1) {
 			throw Exception(errno, "Failed to truncate file %s", filename_);
 		}
-		//all_entries_size -= extra_bytes;
-		extra_bytes = 0;
-		if (fstat(fileno(f_), &fs) != 0) {
-			throw Exception(errno,
-			                "Failed to update information of file %s "
-			                "after truncate",
-			                filename_);
-		}
+		update_mapping();
 		repair_done = true;
 	}
 	if (header_->num_data_items == 0) {
@@ -393,18 +768,69 @@ BBLogFile::repair()
 		set_num_entries(num_entries);
 		repair_done = true;
 	}
+	if ((file_version() == BBLOGGER_FILE_VERSION) && !has_index()) {
+		write_index(fd_);
+		success.append("FIXING: time index missing, added %zu index entries",
+		               num_index_entries_);
+		repair_done = true;
+	}
 
-	f = freopen(filename_, "r", f_);
-	if (!f) {
+	unmap();
+	fd = open(filename_, O_RDONLY);
+	if (fd == -1) {
 		throw Exception("Reopening file %s with read-only mode failed", filename_);
 	}
-	f_ = f;
+	close(fd_);
+	fd_ = fd;
+	update_mapping();
 
 	if (repair_done) {
 		throw success;
 	}
 }
 
+/** Append time index to file.
+ * Creates the index from the entry headers and appends it, together with
+ * the index trailer, to the end of the file.
+ * @param fd file descriptor opened for writing
+ */
+void
+BBLogFile::write_index(int fd)
+{
+	uint32_t stride = std::max((size_t)1, (size_t)BBLOG_INDEX_SPACING / entry_size_);
+	size_t   num    = mapped_entries();
+
+	std::vector<bblog_index_entry> index;
+	for (size_t e = 0; e < num; e += stride) {
+		bblog_entry_header ehead;
+		memcpy(&ehead, map_ + sizeof(bblog_file_header) + e * entry_size_, sizeof(ehead));
+		bblog_index_entry ientry;
+		ientry.offset        = sizeof(bblog_file_header) + e * entry_size_;
+		ientry.rel_time_sec  = ehead.rel_time_sec;
+		ientry.rel_time_usec = ehead.rel_time_usec;
+		index.push_back(ientry);
+	}
+
+	bblog_index_trailer trailer;
+	memset(&trailer, 0, sizeof(trailer));
+	trailer.index_offset      = sizeof(bblog_file_header) + num * entry_size_;
+	trailer.num_index_entries = index.size();
+	trailer.index_stride      = stride;
+	trailer.index_magic       = htonl(BBLOGGER_INDEX_MAGIC);
+
+	struct iovec iov[2];
+	iov[0].iov_base = index.data();
+	iov[0].iov_len  = index.size() * sizeof(bblog_index_entry);
+	iov[1].iov_base = &trailer;
+	iov[1].iov_len  = sizeof(trailer);
+
+	ssize_t expected = iov[0].iov_len + iov[1].iov_len;
+	if (pwritev(fd, iov, 2, trailer.index_offset) != expected) {
+		throw Exception(errno, "Failed to write index to %s", filename_);
+	}
+	update_mapping();
+}
+
 /** Print file meta info.
  * @param line_prefix a prefix printed before each line
  * @param outf file handle to print to
@@ -419,14 +845,32 @@ BBLogFile::print_info(const char *line_prefix, FILE *outf)
 	}
 
 	struct stat fs;
-	if (fstat(fileno(f_), &fs) != 0) {
+	if (fstat(fd_, &fs) != 0) {
 		throw Exception(errno, "Failed to get stat file");
 	}
 
+	char index_info[64];
+	if (compression() != BBLOG_COMPRESSION_NONE) {
+		snprintf(index_info,
+		         sizeof(index_info),
+		         "%zu %s compressed blocks",
+		         blocks_.size(),
+		         BBLogCompression::name(compression()));
+	} else if (has_index()) {
+		snprintf(index_info,
+		         sizeof(index_info),
+		         "%zu entries, one per %u data items",
+		         num_index_entries_,
+		         index_stride_);
+	} else {
+		snprintf(index_info, sizeof(index_info), "none");
+	}
+
 	fprintf(outf,
 	        "%sFile version: %-10u  Endianess: %s Endian\n"
 	        "%s# data items: %-10u  Data size: %u bytes\n"
 	        "%sHeader size:  %zu bytes   File size: %li bytes\n"
+	        "%sTime index:   %s\n"
 	        "%s\n"
 	        "%sScenario:   %s\n"
 	        "%sInterface:  %s::%s (%s)\n"
@@ -441,6 +885,8 @@ BBLogFile::print_info(const char *line_prefix, FILE *outf)
 	        sizeof(bblog_file_header),
 	        (long int)fs.st_size,
 	        line_prefix,
+	        index_info,
+	        line_prefix,
 	        line_prefix,
 	        scenario_,
 	        line_prefix,
@@ -605,16 +1051,74 @@ unsigned int
 BBLogFile::remaining_entries()
 {
 	// we make this so "complicated" to be able to use it from a FAM handler
-	size_t  entry_size = sizeof(bblog_entry_header) + header_->data_size;
-	long    curpos     = ftell(f_);
-	size_t  fsize      = file_size();
-	ssize_t sizediff   = fsize - curpos;
+	update_mapping();
+	size_t num = mapped_entries();
 
-	if (sizediff < 0) {
+	if (pos_ > num) {
 		throw Exception("File %s shrank while reading it", filename_);
 	}
 
-	return sizediff / entry_size;
+	return num - pos_;
+}
+
+/** Get number of entries.
+ * Other than num_data_items() this is determined from the actual file
+ * size and therefore also valid for files which are still being written.
+ * @return number of complete entries in the file
+ */
+size_t
+BBLogFile::num_entries()
+{
+	if (!has_index())
+		update_mapping();
+	return mapped_entries();
+}
+
+/** Check if file has a time index.
+ * @return true if the file has a valid time index, false otherwise
+ */
+bool
+BBLogFile::has_index() const
+{
+	return (index_stride_ > 0);
+}
+
+/** Get number of index entries.
+ * @return number of time index entries, 0 if the file has no index
+ */
+size_t
+BBLogFile::num_index_entries() const
+{
+	return num_index_entries_;
+}
+
+/** Get index stride.
+ * @return number of log entries per time index entry, 0 if the file has
+ * no index
+ */
+uint32_t
+BBLogFile::index_stride() const
+{
+	return index_stride_;
+}
+
+/** Get compression method.
+ * @return compression method of the file, one of BBLOG_COMPRESSION_*
+ */
+unsigned int
+BBLogFile::compression() const
+{
+	return header_->compression;
+}
+
+/** Get number of compressed blocks.
+ * @return number of complete blocks of a compressed file, 0 for
+ * uncompressed files
+ */
+size_t
+BBLogFile::num_blocks() const
+{
+	return blocks_.size();
 }
 
 /** Get file size.
@@ -624,7 +1128,7 @@ size_t
 BBLogFile::file_size() const
 {
 	struct stat fs;
-	if (fstat(fileno(f_), &fs) != 0) {
+	if (fstat(fd_, &fs) != 0) {
 		Exception e(errno, "Failed to stat file %s", filename_);
 		e.set_type_id("bblogfile-stat-failed");
 		throw e;
@@ -30,6 +30,7 @@
 
 #include <cstdio>
 #include <memory>
+#include <vector>
 
 namespace fawkes {
 class Interface;
@@ -49,7 +50,11 @@ public:
 	const fawkes::Time &entry_offset() const;
 	void                print_entry(FILE *outf = stdout);
 
-	void rewind();
+	void   rewind();
+	void   seek(const fawkes::Time &offset);
+	size_t find_entry(const fawkes::Time &offset);
+
+	const void *entry_data(size_t index, fawkes::Time *offset = NULL);
 
 	void set_num_entries(size_t num_entries);
 	void print_info(const char *line_prefix = "", FILE *outf = stdout);
@@ -66,8 +71,16 @@ public:
 	fawkes::Time & start_time();
 
 	size_t       file_size() const;
+	size_t       num_entries();
 	unsigned int remaining_entries();
 
+	bool     has_index() const;
+	size_t   num_index_entries() const;
+	uint32_t index_stride() const;
+
+	unsigned int compression() const;
+	size_t       num_blocks() const;
+
 	static void repair_file(const char *filename);
 
 	void               set_interface(fawkes::Interface *interface);
@@ -94,14 +107,48 @@ public:
 private: // methods
 	void ctor(const char *filename, bool do_sanity_check);
 	void read_file_header();
+	void read_index_trailer();
+	void scan_blocks();
+	bool update_mapping();
+	void unmap();
 	void sanity_check();
 	void repair();
+	void write_index(int fd);
+
+	size_t      mapped_entries() const;
+	const char *entry(size_t index);
+	void        decode_block(size_t block);
+	uint64_t    entry_time_usec(size_t index);
+	uint64_t    index_time_usec(size_t index) const;
 
 private: // members
-	FILE *             f_;
+	int                fd_;
 	bblog_file_header *header_;
-
-	void *ifdata_;
+	size_t             entry_size_;
+
+	char *   map_;
+	size_t   map_size_;
+	size_t   data_end_;
+	size_t   pos_;
+	size_t   index_offset_;
+	size_t   num_index_entries_;
+	uint32_t index_stride_;
+
+	/// @cond INTERNALS
+	struct Block
+	{
+		size_t   offset;
+		size_t   first_entry;
+		size_t   num_entries;
+		uint64_t time_usec;
+	};
+	/// @endcond
+	std::vector<Block> blocks_;
+	size_t             blocks_end_;
+	size_t             num_block_entries_;
+	char *             block_data_;
+	size_t             block_data_size_;
+	size_t             cached_block_;
 
 	char *filename_;
 	char *scenario_;
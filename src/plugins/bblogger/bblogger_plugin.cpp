@@ -22,6 +22,7 @@
 
 #include "bblogger_plugin.h"
 
+#include "compression.h"
 #include "log_thread.h"
 
 #include <sys/stat.h>
@@ -71,9 +72,13 @@ BlackBoardLoggerPlugin::BlackBoardLoggerPlugin(Configuration *config) : Plugin(c
 	std::string scenario_prefix = prefix + scenario + "/";
 	std::string ifaces_prefix   = scenario_prefix + "interfaces/";
 
-	std::string logdir    = LOGDIR;
-	bool        buffering = true;
-	bool        flushing  = false;
+	std::string  logdir            = LOGDIR;
+	bool         buffering         = true;
+	bool         flushing          = false;
+	unsigned int buffer_size       = 4 * 1024 * 1024;
+	unsigned int write_interval    = 100;
+	std::string  compression       = "none";
+	int          compression_level = 0;
 	try {
 		logdir = config->get_string((scenario_prefix + "logdir").c_str());
 	} catch (Exception &e) { /* ignored, use default set above */
@@ -86,6 +91,24 @@ BlackBoardLoggerPlugin::BlackBoardLoggerPlugin(Configuration *config) : Plugin(c
 		flushing = config->get_bool((scenario_prefix + "flushing").c_str());
 	} catch (Exception &e) { /* ignored, use default set above */
 	}
+	try {
+		buffer_size = config->get_uint((scenario_prefix + "buffer_size").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		write_interval = config->get_uint((scenario_prefix + "write_interval").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		compression = config->get_string((scenario_prefix + "compression").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	try {
+		compression_level = config->get_int((scenario_prefix + "compression_level").c_str());
+	} catch (Exception &e) { /* ignored, use default set above */
+	}
+	// throws if unknown or not available
+	unsigned int compression_method = BBLogCompression::parse(compression.c_str());
 
 	struct stat s;
 	int         err = stat(logdir.c_str(), &s);
@@ -116,8 +139,16 @@ BlackBoardLoggerPlugin::BlackBoardLoggerPlugin(Configuration *config) : Plugin(c
 		iface_name             = iface_name.substr(0, iface_name.find("/"));
 
 		//printf("Adding sync thread for peer %s\n", peer.c_str());
-		BBLoggerThread *log_thread = new BBLoggerThread(
-		  i->get_string().c_str(), logdir.c_str(), buffering, flushing, scenario.c_str(), &start);
+		BBLoggerThread *log_thread = new BBLoggerThread(i->get_string().c_str(),
+		                                                logdir.c_str(),
+		                                                buffering,
+		                                                flushing,
+		                                                scenario.c_str(),
+		                                                &start,
+		                                                buffer_size,
+		                                                write_interval,
+		                                                compression_method,
+		                                                compression_level);
 
 		std::string filename = log_thread->get_filename();
 		config->set_string((replay_cfg_prefix + iface_name + "/file").c_str(), filename);
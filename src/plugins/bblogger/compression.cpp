@@ -0,0 +1,280 @@
+
+/***************************************************************************
+ *  compression.cpp - BB Logger block compression
+ *
+ *  Created: Sun Oct 18 05:10:48 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "compression.h"
+
+#include "file.h"
+
+#include <core/exception.h>
+
+#include <cstdint>
+#include <cstring>
+#ifdef HAVE_LZ4
+#	include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD
+#	include <zstd.h>
+#endif
+
+using namespace fawkes;
+
+/// @cond INTERNALS
+/* XOR size bytes of src into dst, word-wise as far as possible. Entries
+ * are not aligned, memcpy compiles to unaligned loads and stores. */
+static inline void
+xor_bytes(char *dst, const char *src, size_t size)
+{
+	size_t b = 0;
+	for (; b + sizeof(uint64_t) <= size; b += sizeof(uint64_t)) {
+		uint64_t d, s;
+		memcpy(&d, dst + b, sizeof(d));
+		memcpy(&s, src + b, sizeof(s));
+		d ^= s;
+		memcpy(dst + b, &d, sizeof(d));
+	}
+	for (; b < size; ++b) {
+		dst[b] ^= src[b];
+	}
+}
+/// @endcond
+
+/** @class BBLogCompression "compression.h"
+ * Block compression for BlackBoard log files.
+ * Wraps the compression libraries which may be used for compressed log
+ * files. Each of them is optional and only available if the respective
+ * library was found at build time, available() tells whether a method
+ * can be used.
+ *
+ * Additionally provides the delta encoding applied to the entries of a
+ * block before compression. The data of each entry but the first is
+ * replaced by the XOR with the data of the previous entry. Interface data
+ * of successive updates usually differs in few bytes only, for instance
+ * a pose with unchanged covariance or a laser scan of a mostly static
+ * environment, hence the encoded data contains long runs of zeros which
+ * compress much better than the raw data.
+ * @author Tim Niemueller
+ */
+
+/** Check if compression method is available.
+ * @param compression compression method, one of BBLOG_COMPRESSION_*
+ * @return true if log files with the given compression can be written
+ * and read, false otherwise
+ */
+bool
+BBLogCompression::available(unsigned int compression)
+{
+	switch (compression) {
+	case BBLOG_COMPRESSION_NONE: return true;
+#ifdef HAVE_LZ4
+	case BBLOG_COMPRESSION_LZ4: return true;
+#endif
+#ifdef HAVE_ZSTD
+	case BBLOG_COMPRESSION_ZSTD: return true;
+#endif
+	default: return false;
+	}
+}
+
+/** Get name of compression method.
+ * @param compression compression method, one of BBLOG_COMPRESSION_*
+ * @return name of compression method
+ */
+const char *
+BBLogCompression::name(unsigned int compression)
+{
+	switch (compression) {
+	case BBLOG_COMPRESSION_NONE: return "none";
+	case BBLOG_COMPRESSION_LZ4: return "lz4";
+	case BBLOG_COMPRESSION_ZSTD: return "zstd";
+	default: return "unknown";
+	}
+}
+
+/** Parse compression method name.
+ * @param name name of compression method, one of none, lz4, or zstd
+ * @return compression method, one of BBLOG_COMPRESSION_*
+ * @exception Exception thrown if the name is unknown or the compression
+ * method is not available
+ */
+unsigned int
+BBLogCompression::parse(const char *name)
+{
+	unsigned int compression;
+	if (strcmp(name, "none") == 0) {
+		compression = BBLOG_COMPRESSION_NONE;
+	} else if (strcmp(name, "lz4") == 0) {
+		compression = BBLOG_COMPRESSION_LZ4;
+	} else if (strcmp(name, "zstd") == 0) {
+		compression = BBLOG_COMPRESSION_ZSTD;
+	} else {
+		throw Exception("Unknown log compression '%s'", name);
+	}
+	if (!available(compression)) {
+		throw Exception("Log compression '%s' not available (not built)", name);
+	}
+	return compression;
+}
+
+/** Get maximum size of compressed data.
+ * @param compression compression method, one of BBLOG_COMPRESSION_*
+ * @param size size of uncompressed data
+ * @return maximum size of the compressed data
+ */
+size_t
+BBLogCompression::compress_bound(unsigned int compression, size_t size)
+{
+	switch (compression) {
+#ifdef HAVE_LZ4
+	case BBLOG_COMPRESSION_LZ4: return LZ4_compressBound(size);
+#endif
+#ifdef HAVE_ZSTD
+	case BBLOG_COMPRESSION_ZSTD: return ZSTD_compressBound(size);
+#endif
+	default: return size;
+	}
+}
+
+/** Compress data.
+ * @param compression compression method, one of BBLOG_COMPRESSION_*
+ * @param level compression level, 0 for the library's default
+ * @param src data to compress
+ * @param src_size size of data to compress
+ * @param dst buffer for compressed data
+ * @param dst_capacity size of dst, shall be at least compress_bound()
+ * @return size of compressed data
+ * @exception Exception thrown if compression fails or the method is not
+ * available
+ */
+size_t
+BBLogCompression::compress(unsigned int compression,
+                           int          level,
+                           const void * src,
+                           size_t       src_size,
+                           void *       dst,
+                           size_t       dst_capacity)
+{
+	switch (compression) {
+#ifdef HAVE_LZ4
+	case BBLOG_COMPRESSION_LZ4: {
+		// for LZ4 the level is the acceleration, higher is faster
+		int rv = LZ4_compress_fast(
+		  (const char *)src, (char *)dst, src_size, dst_capacity, (level > 0) ? level : 1);
+		if (rv <= 0) {
+			throw Exception("LZ4 compression of %zu bytes failed", src_size);
+		}
+		return rv;
+	}
+#endif
+#ifdef HAVE_ZSTD
+	case BBLOG_COMPRESSION_ZSTD: {
+		size_t rv = ZSTD_compress(dst, dst_capacity, src, src_size, (level > 0) ? level : 1);
+		if (ZSTD_isError(rv)) {
+			throw Exception("zstd compression failed: %s", ZSTD_getErrorName(rv));
+		}
+		return rv;
+	}
+#endif
+	default: throw Exception("Log compression '%s' not available", name(compression));
+	}
+}
+
+/** Decompress data.
+ * @param compression compression method, one of BBLOG_COMPRESSION_*
+ * @param src compressed data
+ * @param src_size size of compressed data
+ * @param dst buffer for uncompressed data
+ * @param dst_size expected size of uncompressed data
+ * @exception Exception thrown if the data is corrupt, does not decompress
+ * to exactly dst_size bytes, or the method is not available
+ */
+void
+BBLogCompression::decompress(unsigned int compression,
+                             const void * src,
+                             size_t       src_size,
+                             void *       dst,
+                             size_t       dst_size)
+{
+	switch (compression) {
+#ifdef HAVE_LZ4
+	case BBLOG_COMPRESSION_LZ4: {
+		int rv = LZ4_decompress_safe((const char *)src, (char *)dst, src_size, dst_size);
+		if (rv < 0 || (size_t)rv != dst_size) {
+			throw Exception("LZ4 decompression failed (%i of %zu bytes)", rv, dst_size);
+		}
+		return;
+	}
+#endif
+#ifdef HAVE_ZSTD
+	case BBLOG_COMPRESSION_ZSTD: {
+		size_t rv = ZSTD_decompress(dst, dst_size, src, src_size);
+		if (ZSTD_isError(rv)) {
+			throw Exception("zstd decompression failed: %s", ZSTD_getErrorName(rv));
+		} else if (rv != dst_size) {
+			throw Exception("zstd decompression failed (%zu of %zu bytes)", rv, dst_size);
+		}
+		return;
+	}
+#endif
+	default: throw Exception("Log compression '%s' not available", name(compression));
+	}
+}
+
+/** Delta encode entries in place.
+ * Replaces the bytes starting at offset of every entry but the first by
+ * the XOR with the respective bytes of the previous entry.
+ * @param entries consecutive entries
+ * @param num_entries number of entries
+ * @param entry_size size of a single entry
+ * @param offset offset in each entry of the bytes to encode, typically
+ * the size of the entry header, the header itself is stored as is
+ */
+void
+BBLogCompression::delta_encode(char * entries,
+                               size_t num_entries,
+                               size_t entry_size,
+                               size_t offset)
+{
+	// backwards, each entry must be encoded against its original predecessor
+	for (size_t i = num_entries; i > 1; --i) {
+		char *cur = entries + (i - 1) * entry_size;
+		xor_bytes(cur + offset, cur + offset - entry_size, entry_size - offset);
+	}
+}
+
+/** Delta decode entries in place.
+ * Reverses delta_encode().
+ * @param entries consecutive entries
+ * @param num_entries number of entries
+ * @param entry_size size of a single entry
+ * @param offset offset in each entry of the encoded bytes
+ */
+void
+BBLogCompression::delta_decode(char * entries,
+                               size_t num_entries,
+                               size_t entry_size,
+                               size_t offset)
+{
+	for (size_t i = 1; i < num_entries; ++i) {
+		char *cur = entries + i * entry_size;
+		xor_bytes(cur + offset, cur + offset - entry_size, entry_size - offset);
+	}
+}
@@ -0,0 +1,51 @@
+/***************************************************************************
+ *  compression.h - BB Logger block compression
+ *
+ *  Created: Sun Oct 18 05:10:48 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_BBLOGGER_COMPRESSION_H_
+#define _PLUGINS_BBLOGGER_COMPRESSION_H_
+
+#include <cstddef>
+
+class BBLogCompression
+{
+public:
+	static bool         available(unsigned int compression);
+	static const char * name(unsigned int compression);
+	static unsigned int parse(const char *name);
+
+	static size_t compress_bound(unsigned int compression, size_t size);
+	static size_t compress(unsigned int compression,
+	                       int          level,
+	                       const void * src,
+	                       size_t       src_size,
+	                       void *       dst,
+	                       size_t       dst_capacity);
+	static void   decompress(unsigned int compression,
+	                         const void * src,
+	                         size_t       src_size,
+	                         void *       dst,
+	                         size_t       dst_size);
+
+	static void delta_encode(char *entries, size_t num_entries, size_t entry_size, size_t offset);
+	static void delta_decode(char *entries, size_t num_entries, size_t entry_size, size_t offset);
+};
+
+#endif
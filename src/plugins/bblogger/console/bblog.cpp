@@ -21,10 +21,14 @@
  */
 
 #include "../bblogfile.h"
+#include "../compression.h"
+#include "../log_writer.h"
 
 #include <arpa/inet.h>
 #include <blackboard/internal/instance_factory.h>
 #include <blackboard/remote.h>
+#include <core/exceptions/system.h>
+#include <core/threading/thread.h>
 #include <interfaces/SwitchInterface.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -38,7 +42,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <unistd.h>
+#include <vector>
 
 using namespace fawkes;
 
@@ -47,6 +53,8 @@ print_usage(const char *program_name)
 {
 	printf("Usage: %s [-h] [-r host:port] <COMMAND> <logfile>\n"
 	       "       %s print <logfile> <index> [index ...]\n"
+	       "       %s seek <logfile> <offset>\n"
+	       "       %s scan <logfile> [logfile ...]\n"
 	       "       %s convert <infile> <outfile> <format>\n"
 	       "\n"
 	       " -h  Print this usage information\n"
@@ -55,15 +63,25 @@ print_usage(const char *program_name)
 	       " info      Print meta information of log file\n"
 	       " print     Print specific data index\n"
 	       "           <index> [index ...] is a list of indices to print\n"
+	       " seek      Print first entry at or after time offset\n"
+	       "           <offset> time offset from start of log in seconds\n"
+	       " scan      Check entries of one or more log files in parallel\n"
 	       " replay    Replay log file in real-time to console\n"
-	       " repair    Repair file, i.e. properly set number of entries\n"
+	       " repair    Repair file, i.e. properly set number of entries and\n"
+	       "           restore the time index\n"
 	       " enable    Enable logging on a remotely running bblogger\n"
 	       " disable   Disable logging on a remotely running bblogger\n"
 	       " convert   Convert logfile to different format\n"
 	       "           <infile>  input log file\n"
 	       "           <outfile> converted output file\n"
 	       "           <format>  format to convert to, currently supported:\n"
-	       "             - csv  Comma-separated values\n",
+	       "             - csv    Comma-separated values\n"
+	       "             - bblog  Current log file version, e.g. to add the\n"
+	       "                      time index to logs of older versions\n"
+	       "             - bblog-lz4, bblog-zstd\n"
+	       "                      Compressed log file, if available\n",
+	       program_name,
+	       program_name,
 	       program_name,
 	       program_name,
 	       program_name);
@@ -122,6 +140,26 @@ print_indexes(std::string &filename, std::vector<unsigned int> &indexes)
 	return 0;
 }
 
+int
+print_offset(std::string &filename, double offset)
+{
+	try {
+		BBLogFile bf(filename.c_str());
+		bf.seek(Time(offset));
+		if (!bf.has_next()) {
+			printf("No entry at or after offset %f\n", offset);
+			return -1;
+		}
+		bf.read_next();
+		bf.print_entry();
+		return 0;
+	} catch (Exception &e) {
+		printf("Failed to print entry, exception follows\n");
+		e.print_trace();
+		return -1;
+	}
+}
+
 int
 replay_file(std::string &filename)
 {
@@ -252,6 +290,91 @@ set_enabled(const char *hostname, unsigned short int port, bool enabled)
 	return rv;
 }
 
+class BBLogScanThread : public Thread
+{
+public:
+	BBLogScanThread(const char *filename)
+	: Thread("BBLogScanThread", Thread::OPMODE_CONTINUOUS), filename_(filename)
+	{
+		num_entries   = 0;
+		num_backwards = 0;
+		duration      = 0.;
+		max_gap       = 0.;
+		failed        = false;
+	}
+
+	virtual void
+	loop()
+	{
+		try {
+			// no interface required, entries are only accessed in place
+			BBLogFile bf(filename_, false);
+			num_entries = bf.num_entries();
+			Time last_offset((long)0), offset;
+			for (size_t i = 0; i < num_entries; ++i) {
+				bf.entry_data(i, &offset);
+				double gap = offset - &last_offset;
+				if (gap < 0.) {
+					++num_backwards;
+				} else if ((i > 0) && (gap > max_gap)) {
+					max_gap = gap;
+				}
+				last_offset = offset;
+			}
+			duration = last_offset.in_sec();
+		} catch (Exception &e) {
+			failed = true;
+			error  = e.what_no_backtrace();
+		}
+		exit();
+	}
+
+	size_t      num_entries;
+	size_t      num_backwards;
+	double      duration;
+	double      max_gap;
+	bool        failed;
+	std::string error;
+
+private:
+	const char *filename_;
+};
+
+int
+scan_files(std::vector<const char *> &filenames)
+{
+	std::vector<BBLogScanThread *> threads;
+	for (const char *f : filenames) {
+		threads.push_back(new BBLogScanThread(f));
+	}
+	for (auto t : threads) {
+		t->start();
+	}
+
+	int rv = 0;
+	for (size_t i = 0; i < threads.size(); ++i) {
+		BBLogScanThread *t = threads[i];
+		t->join();
+		if (t->failed) {
+			printf("%s: FAILED, %s\n", filenames[i], t->error.c_str());
+			rv = -1;
+		} else {
+			printf("%s: %zu entries over %.3f sec (%.1f Hz), max gap %.3f sec%s\n",
+			       filenames[i],
+			       t->num_entries,
+			       t->duration,
+			       (t->duration > 0.) ? t->num_entries / t->duration : 0.,
+			       t->max_gap,
+			       (t->num_backwards > 0) ? ", TIME GOES BACKWARDS" : "");
+			if (t->num_backwards > 0)
+				rv = -1;
+		}
+		delete t;
+	}
+
+	return rv;
+}
+
 /// @endcond
 
 void
@@ -279,9 +402,73 @@ convert_file_csv(BBLogFile &bf, FILE *outf)
 	}
 }
 
+void
+convert_file_bblog(BBLogFile &bf, const char *outfile, unsigned int compression)
+{
+	int fd = open(outfile, O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if (fd == -1) {
+		throw CouldNotOpenFileException(outfile, errno);
+	}
+
+	try {
+		size_t   num_entries = bf.num_entries();
+		uint32_t version     = BBLOGGER_FILE_VERSION;
+		if (compression != BBLOG_COMPRESSION_NONE) {
+			version = BBLOGGER_FILE_VERSION_COMPRESSED;
+		}
+		bblog_file_header header;
+		memset(&header, 0, sizeof(header));
+		header.file_magic     = htonl(BBLOGGER_FILE_MAGIC);
+		header.file_version   = htonl(version);
+		header.endianess      = bf.is_big_endian() ? BBLOG_BIG_ENDIAN : BBLOG_LITTLE_ENDIAN;
+		header.compression    = compression;
+		header.num_data_items = num_entries;
+		strncpy(header.scenario, bf.scenario(), BBLOG_SCENARIO_SIZE - 1);
+		strncpy(header.interface_type, bf.interface_type(), BBLOG_INTERFACE_TYPE_SIZE - 1);
+		strncpy(header.interface_id, bf.interface_id(), BBLOG_INTERFACE_ID_SIZE - 1);
+		memcpy(header.interface_hash, bf.interface_hash(), BBLOG_INTERFACE_HASH_SIZE);
+		header.data_size       = bf.data_size();
+		header.start_time_sec  = bf.start_time().get_sec();
+		header.start_time_usec = bf.start_time().get_usec();
+		if (write(fd, &header, sizeof(header)) != sizeof(header)) {
+			throw FileWriteException(outfile, errno, "Failed to write header");
+		}
+
+		BBLogWriter writer(outfile, fd, bf.data_size(), 4 * 1024 * 1024, 0, compression);
+		Time        offset;
+		for (size_t i = 0; i < num_entries; ++i) {
+			const void *data = bf.entry_data(i, &offset);
+			while (!writer.append(offset, data)) {
+				writer.write_pending();
+			}
+		}
+		writer.finish();
+	} catch (Exception &e) {
+		close(fd);
+		throw;
+	}
+	close(fd);
+}
+
 int
 convert_file(std::string &infile, std::string &outfile, std::string &format)
 {
+	if (format == "bblog" || format.compare(0, 6, "bblog-") == 0) {
+		try {
+			unsigned int compression = BBLOG_COMPRESSION_NONE;
+			if (format != "bblog") {
+				compression = BBLogCompression::parse(format.substr(6).c_str());
+			}
+			BBLogFile bf(infile.c_str(), true);
+			convert_file_bblog(bf, outfile.c_str(), compression);
+			return 0;
+		} catch (Exception &e) {
+			printf("Failed to convert log file: %s\n", e.what());
+			e.print_trace();
+			return 4;
+		}
+	}
+
 	if (format != "csv") {
 		printf("Unsupported output format '%s'\n", format.c_str());
 		return 8;
@@ -365,6 +552,19 @@ main(int argc, char **argv)
 
 		return print_indexes(file, indexes);
 
+	} else if (command == "seek") {
+		if (argp.num_items() != 3) {
+			printf("Invalid number of arguments\n");
+			print_usage(argv[0]);
+			exit(7);
+		}
+		return print_offset(file, atof(argp.items()[2]));
+
+	} else if (command == "scan") {
+		std::vector<const char *> files = argp.items();
+		files.erase(files.begin());
+		return scan_files(files);
+
 	} else if (command == "replay") {
 		return replay_file(file);
 
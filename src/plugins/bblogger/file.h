@@ -28,18 +28,29 @@
 #include <stdint.h>
 
 #define BBLOGGER_FILE_MAGIC 0xffbbffbb
-#define BBLOGGER_FILE_VERSION 1
+#define BBLOGGER_FILE_VERSION 2
+#define BBLOGGER_FILE_VERSION_COMPRESSED 3
+#define BBLOGGER_INDEX_MAGIC 0xffbb1dec
 
 #pragma pack(push, 4)
 
 #define BBLOG_BIG_ENDIAN 1
 #define BBLOG_LITTLE_ENDIAN 0
 
+#define BBLOG_COMPRESSION_NONE 0
+#define BBLOG_COMPRESSION_LZ4 1
+#define BBLOG_COMPRESSION_ZSTD 2
+
 #define BBLOG_INTERFACE_TYPE_SIZE INTERFACE_TYPE_SIZE_
 #define BBLOG_INTERFACE_ID_SIZE INTERFACE_ID_SIZE_
 #define BBLOG_INTERFACE_HASH_SIZE INTERFACE_HASH_SIZE_
 #define BBLOG_SCENARIO_SIZE 32
 
+/** Approximate number of bytes of log entries between two index entries. */
+#define BBLOG_INDEX_SPACING 65536
+/** Approximate number of bytes of uncompressed log entries per block. */
+#define BBLOG_BLOCK_SIZE 262144
+
 /** BBLogger file header definition.
  * To identify log files created for different interfaces but belonging to a
  * single run files must be
@@ -48,6 +59,8 @@
  * The file_version is stored in network byte order. Anything beyond this is
  * stored in the native system format, read the endianess field to check whether
  * you must do data conversion.
+ * Compressed files have the file version BBLOGGER_FILE_VERSION_COMPRESSED,
+ * such that older readers reject them, and the compression field set.
  */
 typedef struct
 {
@@ -56,7 +69,8 @@ typedef struct
 	uint32_t      file_version;                  /**< File version, set to BBLOGGER_FILE_VERSION on
 				 * write and verify on read (big endian) */
 	uint32_t      endianess : 1;                 /**< Endianess, 0 little endian, 1 big endian */
-	uint32_t      reserved : 31;                 /**< Reserved for future use */
+	uint32_t      compression : 4;               /**< Compression, one of BBLOG_COMPRESSION_* */
+	uint32_t      reserved : 27;                 /**< Reserved for future use */
 	uint32_t      num_data_items;                /**< Number of data items in file, if set to zero
 				 * reader must scan the file for this number */
 	char          scenario[BBLOG_SCENARIO_SIZE]; /**< Scenario as defined in
@@ -78,6 +92,56 @@ typedef struct
 	uint32_t rel_time_usec; /**< time since start time, microseconds */
 } bblog_entry_header;
 
+/** BBLogger compressed block header.
+ * In compressed files entries are grouped into blocks, each of which is
+ * compressed on its own. A block consists of this header followed by the
+ * compressed_size bytes of compressed data. Uncompressed, the data is a
+ * sequence of num_entries entries, each an entry header followed by the
+ * interface data. The data of any but the first entry of a block is stored
+ * XOR'ed with the data of the previous entry, successive updates of an
+ * interface tend to differ in few bytes only which makes the data
+ * compress considerably better. Compressed files do not have a time
+ * index, the block headers serve the same purpose.
+ */
+typedef struct
+{
+	uint32_t num_entries;     /**< number of entries in block */
+	uint32_t compressed_size; /**< size of compressed data following the header */
+	uint32_t rel_time_sec;    /**< time of first entry since start time, seconds */
+	uint32_t rel_time_usec;   /**< time of first entry since start time, microseconds */
+} bblog_block_header;
+
+/** BBLogger time index entry.
+ * Since file version 2 a time index is appended after the last entry once
+ * logging has finished. It contains one index entry for every
+ * index_stride log entries, i.e. index entry k refers to log entry
+ * k * index_stride. It allows to find entries by time offset with a
+ * binary search without touching the whole file.
+ */
+typedef struct
+{
+	uint64_t offset;        /**< file offset of the entry header */
+	uint32_t rel_time_sec;  /**< time since start time, seconds */
+	uint32_t rel_time_usec; /**< time since start time, microseconds */
+} bblog_index_entry;
+
+/** BBLogger index trailer.
+ * The trailer is the very last part of a version 2 file that has an index.
+ * If it is missing, e.g. because the logger did not terminate properly, the
+ * file can be read just like a version 1 file and the index can be restored
+ * by repairing the file. The index_magic is stored in network byte order,
+ * anything else in the format indicated by the file header.
+ */
+typedef struct
+{
+	uint64_t index_offset;      /**< file offset of the first index entry */
+	uint32_t num_index_entries; /**< number of index entries */
+	uint32_t index_stride;      /**< number of log entries per index entry */
+	uint32_t reserved;          /**< Reserved for future use */
+	uint32_t index_magic;       /**< Magic value to identify the trailer,
+				     * must be BBLOGGER_INDEX_MAGIC (big endian) */
+} bblog_index_trailer;
+
 #pragma pack(pop)
 
 #endif
@@ -23,9 +23,12 @@
 #include "log_thread.h"
 
 #include "file.h"
+#include "log_writer.h"
 
 #include <blackboard/blackboard.h>
 #include <core/exceptions/system.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
 #include <interfaces/SwitchInterface.h>
 #include <logging/logger.h>
 
@@ -43,8 +46,10 @@
 #	include <endian.h>
 #endif
 #include <arpa/inet.h>
+#include <inttypes.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 using namespace fawkes;
 
@@ -59,9 +64,13 @@ using namespace fawkes;
  * thus the writing operation can slow down the overall system, but memory
  * requirements are low. This is useful if a lot of data is written or if the
  * storage device is slow. If the mode is enabled, during the event the BB data
- * will be copied into another memory segment and the thread will be woken up.
- * Once the thread is running it stores all of the BB data segments bufferd
- * up to then.
+ * will be copied into a preallocated ring buffer (see BBLogWriter). The
+ * thread writes out all entries buffered up to then in a single batch once
+ * a batch of a quarter of the buffer is pending, or at the latest after the
+ * write interval. If the buffer is full, entries are dropped and reported.
+ * Optionally the log can be written compressed (see BBLogWriter). In that
+ * case entries are compressed in blocks, flushing then means to write a
+ * (possibly small) block after every batch.
  * The interface listener listens for events for a particular interface and
  * then writes the changes to the file.
  * @author Tim Niemueller
@@ -74,30 +83,43 @@ using namespace fawkes;
  * @param flushing true to flush after each written chunk
  * @param scenario ID of the log scenario
  * @param start_time time to use as start time for the log
+ * @param buffer_size size of the buffer for entries in bytes if buffering
+ * @param write_interval_msec maximum time in milliseconds entries are kept
+ * in the buffer before they are written if buffering
+ * @param compression compression method, one of BBLOG_COMPRESSION_*
+ * @param compression_level compression level, 0 for the default
  */
 BBLoggerThread::BBLoggerThread(const char *  iface_uid,
                                const char *  logdir,
                                bool          buffering,
                                bool          flushing,
                                const char *  scenario,
-                               fawkes::Time *start_time)
-: Thread("BBLoggerThread", Thread::OPMODE_WAITFORWAKEUP),
+                               fawkes::Time *start_time,
+                               size_t        buffer_size,
+                               unsigned int  write_interval_msec,
+                               unsigned int  compression,
+                               int           compression_level)
+: Thread("BBLoggerThread", buffering ? Thread::OPMODE_CONTINUOUS : Thread::OPMODE_WAITFORWAKEUP),
   BlackBoardInterfaceListener("BBLoggerThread(%s)", iface_uid)
 {
-	set_coalesce_wakeups(true);
 	set_name("BBLoggerThread(%s)", iface_uid);
 
-	buffering_   = buffering;
-	flushing_    = flushing;
-	uid_         = strdup(iface_uid);
-	logdir_      = strdup(logdir);
-	scenario_    = strdup(scenario);
-	start_       = new Time(start_time);
-	filename_    = NULL;
-	queue_mutex_ = new Mutex();
-	data_size_   = 0;
-	is_master_   = false;
-	enabled_     = true;
+	buffering_           = buffering;
+	flushing_            = flushing;
+	uid_                 = strdup(iface_uid);
+	logdir_              = strdup(logdir);
+	scenario_            = strdup(scenario);
+	start_               = new Time(start_time);
+	filename_            = NULL;
+	write_mutex_         = new Mutex();
+	data_size_           = 0;
+	is_master_           = false;
+	enabled_             = true;
+	buffer_size_         = buffer_size;
+	write_interval_msec_ = write_interval_msec;
+	compression_         = compression;
+	compression_level_   = compression_level;
+	writer_              = NULL;
 
 	now_ = NULL;
 
@@ -123,50 +145,47 @@ BBLoggerThread::~BBLoggerThread()
 	free(logdir_);
 	free(scenario_);
 	free(filename_);
-	delete queue_mutex_;
+	delete write_mutex_;
 	delete start_;
 }
 
 void
 BBLoggerThread::init()
 {
-	queues_[0].clear();
-	queues_[1].clear();
-	act_queue_ = 0;
-
-	queue_mutex_ = new Mutex();
-	data_size_   = 0;
-
-	now_            = NULL;
-	num_data_items_ = 0;
-	session_start_  = 0;
+	data_size_        = 0;
+	now_              = NULL;
+	session_start_    = 0;
+	dropped_reported_ = 0;
 
 	// use open because fopen does not provide O_CREAT | O_EXCL
 	// open read/write because of usage of mmap
-	mode_t m  = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
-	int    fd = open(filename_, O_RDWR | O_CREAT | O_EXCL, m);
-	if (!fd) {
-		throw CouldNotOpenFileException(filename_, errno, "Failed to open log 1");
-	} else {
-		f_data_ = fdopen(fd, "w+");
-		if (!f_data_) {
-			throw CouldNotOpenFileException(filename_, errno, "Failed to open log 2");
-		}
+	mode_t m = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+	fd_      = open(filename_, O_RDWR | O_CREAT | O_EXCL, m);
+	if (fd_ == -1) {
+		throw CouldNotOpenFileException(filename_, errno, "Failed to open log");
 	}
 
 	try {
 		iface_     = blackboard->open_for_reading(type_.c_str(), id_.c_str());
 		data_size_ = iface_->datasize();
 	} catch (Exception &e) {
-		fclose(f_data_);
+		close(fd_);
 		throw;
 	}
 
 	try {
 		write_header();
-	} catch (FileWriteException &e) {
+		// in non-buffering mode the buffer only holds the entry being written
+		writer_ = new BBLogWriter(filename_,
+		                          fd_,
+		                          data_size_,
+		                          buffering_ ? buffer_size_ : 0,
+		                          flushing_ ? 0 : buffer_size_ / 4,
+		                          compression_,
+		                          compression_level_);
+	} catch (Exception &e) {
 		blackboard->close(iface_);
-		fclose(f_data_);
+		close(fd_);
 		throw;
 	}
 
@@ -179,7 +198,9 @@ BBLoggerThread::init()
 			switch_if_->write();
 			bbil_add_message_interface(switch_if_);
 		} catch (Exception &e) {
-			fclose(f_data_);
+			blackboard->close(iface_);
+			delete writer_;
+			close(fd_);
 			throw;
 		}
 	}
@@ -200,15 +221,22 @@ BBLoggerThread::finalize()
 	if (is_master_) {
 		blackboard->close(switch_if_);
 	}
-	update_header();
-	fclose(f_data_);
-	for (unsigned int q = 0; q < 2; ++q) {
-		while (!queues_[q].empty()) {
-			void *t = queues_[q].front();
-			free(t);
-			queues_[q].pop();
-		}
+	blackboard->close(iface_);
+	try {
+		writer_->finish();
+	} catch (Exception &e) {
+		logger->log_error(name(), "Failed to write remaining entries and index");
+		logger->log_error(name(), e);
+	}
+	if (writer_->num_dropped() > 0) {
+		logger->log_warn(name(),
+		                 "Dropped %" PRIu64 " entries in total, buffer was full",
+		                 writer_->num_dropped());
 	}
+	update_header();
+	close(fd_);
+	delete writer_;
+	writer_ = NULL;
 	delete now_;
 	now_ = NULL;
 }
@@ -231,13 +259,13 @@ BBLoggerThread::set_enabled(bool enabled)
 {
 	if (enabled && !enabled_) {
 		logger->log_info(name(), "Logging enabled");
-		session_start_ = num_data_items_;
+		session_start_ = writer_->num_written() + writer_->num_pending();
 	} else if (!enabled && enabled_) {
 		logger->log_info(name(),
-		                 "Logging disabled (wrote %u entries), flushing",
-		                 (num_data_items_ - session_start_));
+		                 "Logging disabled (wrote %" PRIu64 " entries), flushing",
+		                 writer_->num_written() + writer_->num_pending() - session_start_);
 		update_header();
-		fflush(f_data_);
+		writer_->wakeup();
 	}
 
 	enabled_ = enabled;
@@ -262,13 +290,18 @@ BBLoggerThread::write_header()
 	bblog_file_header header;
 	memset(&header, 0, sizeof(header));
 	header.file_magic   = htonl(BBLOGGER_FILE_MAGIC);
-	header.file_version = htonl(BBLOGGER_FILE_VERSION);
+	if (compression_ != BBLOG_COMPRESSION_NONE) {
+		header.file_version = htonl(BBLOGGER_FILE_VERSION_COMPRESSED);
+		header.compression  = compression_;
+	} else {
+		header.file_version = htonl(BBLOGGER_FILE_VERSION);
+	}
 #if BYTE_ORDER_ == BIG_ENDIAN_
 	header.endianess = BBLOG_BIG_ENDIAN;
 #else
 	header.endianess = BBLOG_LITTLE_ENDIAN;
 #endif
-	header.num_data_items = num_data_items_;
+	header.num_data_items = 0;
 	strncpy(header.scenario, (const char *)scenario_, BBLOG_SCENARIO_SIZE - 1);
 	strncpy(header.interface_type, iface_->type(), BBLOG_INTERFACE_TYPE_SIZE - 1);
 	strncpy(header.interface_id, iface_->id(), BBLOG_INTERFACE_ID_SIZE - 1);
@@ -278,10 +311,9 @@ BBLoggerThread::write_header()
 	start_->get_timestamp(start_time_sec, start_time_usec);
 	header.start_time_sec  = start_time_sec;
 	header.start_time_usec = start_time_usec;
-	if (fwrite(&header, sizeof(header), 1, f_data_) != 1) {
-		throw FileWriteException(filename_, "Failed to write header");
+	if (write(fd_, &header, sizeof(header)) != sizeof(header)) {
+		throw FileWriteException(filename_, errno, "Failed to write header");
 	}
-	fflush(f_data_);
 }
 
 /** Updates the num_data_items field in the header. */
@@ -290,7 +322,7 @@ BBLoggerThread::update_header()
 {
 	// write updated num_data_items field
 #if _POSIX_MAPPED_FILES
-	void *h = mmap(NULL, sizeof(bblog_file_header), PROT_WRITE, MAP_SHARED, fileno(f_data_), 0);
+	void *h = mmap(NULL, sizeof(bblog_file_header), PROT_WRITE, MAP_SHARED, fd_, 0);
 	if (h == MAP_FAILED) {
 		logger->log_warn(name(),
 		                 "Failed to mmap log (%s), "
@@ -298,7 +330,7 @@ BBLoggerThread::update_header()
 		                 strerror(errno));
 	} else {
 		bblog_file_header *header = (bblog_file_header *)h;
-		header->num_data_items    = num_data_items_;
+		header->num_data_items    = writer_->num_written();
 		munmap(h, sizeof(bblog_file_header));
 	}
 #else
@@ -309,39 +341,49 @@ BBLoggerThread::update_header()
 }
 
 void
-BBLoggerThread::write_chunk(const void *chunk)
+BBLoggerThread::append_chunk(const void *chunk)
 {
-	bblog_entry_header ehead;
+	MutexLocker lock(write_mutex_);
 	now_->stamp();
 	Time d = *now_ - *start_;
-	long rel_time_sec, rel_time_usec;
-	d.get_timestamp(rel_time_sec, rel_time_usec);
-	ehead.rel_time_sec  = rel_time_sec;
-	ehead.rel_time_usec = rel_time_usec;
-	if ((fwrite(&ehead, sizeof(ehead), 1, f_data_) == 1)
-	    && (fwrite(chunk, data_size_, 1, f_data_) == 1)) {
-		if (flushing_)
-			fflush(f_data_);
-		num_data_items_ += 1;
-	} else {
-		logger->log_warn(name(), "Failed to write chunk");
+	writer_->append(d, chunk);
+	if (!buffering_) {
+		if (flushing_) {
+			writer_->flush();
+		} else {
+			writer_->write_pending();
+		}
 	}
 }
 
 void
 BBLoggerThread::loop()
 {
-	unsigned int write_queue = act_queue_;
-	queue_mutex_->lock();
-	act_queue_ = 1 - act_queue_;
-	queue_mutex_->unlock();
-	LockQueue<void *> &queue = queues_[write_queue];
-	//logger->log_debug(name(), "Writing %zu entries", queue.size());
-	while (!queue.empty()) {
-		void *c = queue.front();
-		write_chunk(c);
-		free(c);
-		queue.pop();
+	writer_->wait(write_interval_msec_);
+
+	// a cancellation in the middle of writing would make us write the
+	// entries again on finalize
+	CancelState old_state;
+	set_cancel_state(CANCEL_DISABLED, &old_state);
+	try {
+		if (flushing_) {
+			writer_->flush();
+		} else {
+			writer_->write_pending();
+		}
+	} catch (Exception &e) {
+		logger->log_warn(name(), "Failed to write entries");
+		logger->log_warn(name(), e);
+	}
+	set_cancel_state(old_state);
+
+	uint64_t dropped = writer_->num_dropped();
+	if (dropped != dropped_reported_) {
+		logger->log_warn(name(),
+		                 "Dropped %" PRIu64 " entries, buffer of %zu entries full",
+		                 dropped - dropped_reported_,
+		                 writer_->num_slots());
+		dropped_reported_ = dropped;
 	}
 }
 
@@ -382,19 +424,7 @@ BBLoggerThread::bb_interface_data_refreshed(Interface *interface) throw()
 
 	try {
 		iface_->read();
-
-		if (buffering_) {
-			void *c = malloc(iface_->datasize());
-			memcpy(c, iface_->datachunk(), iface_->datasize());
-			queue_mutex_->lock();
-			queues_[act_queue_].push_locked(c);
-			queue_mutex_->unlock();
-			wakeup();
-		} else {
-			queue_mutex_->lock();
-			write_chunk(iface_->datachunk());
-			queue_mutex_->unlock();
-		}
+		append_chunk(iface_->datachunk());
 
 	} catch (Exception &e) {
 		logger->log_error(name(), "Exception when data changed");
@@ -405,15 +435,15 @@ BBLoggerThread::bb_interface_data_refreshed(Interface *interface) throw()
 void
 BBLoggerThread::bb_interface_writer_added(Interface *interface, Uuid instance_serial) throw()
 {
-	session_start_ = num_data_items_;
+	session_start_ = writer_->num_written() + writer_->num_pending();
 }
 
 void
 BBLoggerThread::bb_interface_writer_removed(Interface *interface, Uuid instance_serial) throw()
 {
 	logger->log_info(name(),
-	                 "Writer removed (wrote %u entries), flushing",
-	                 (num_data_items_ - session_start_));
+	                 "Writer removed (wrote %" PRIu64 " entries), flushing",
+	                 writer_->num_written() + writer_->num_pending() - session_start_);
 	update_header();
-	fflush(f_data_);
+	writer_->wakeup();
 }
@@ -23,6 +23,8 @@
 #ifndef _PLUGINS_BBLOGGER_LOG_THREAD_H_
 #define _PLUGINS_BBLOGGER_LOG_THREAD_H_
 
+#include "file.h"
+
 #include <aspect/blackboard.h>
 #include <aspect/clock.h>
 #include <aspect/configurable.h>
@@ -30,10 +32,9 @@
 #include <blackboard/interface_listener.h>
 #include <core/threading/thread.h>
 #include <core/threading/thread_list.h>
-#include <core/utils/lock_queue.h>
 #include <utils/uuid.h>
 
-#include <cstdio>
+#include <cstdint>
 
 namespace fawkes {
 class BlackBoard;
@@ -43,6 +44,8 @@ class Time;
 class SwitchInterface;
 } // namespace fawkes
 
+class BBLogWriter;
+
 class BBLoggerThread : public fawkes::Thread,
                        public fawkes::LoggingAspect,
                        public fawkes::ConfigurableAspect,
@@ -56,7 +59,11 @@ public:
 	               bool          buffering,
 	               bool          flushing,
 	               const char *  scenario,
-	               fawkes::Time *start_time);
+	               fawkes::Time *start_time,
+	               size_t        buffer_size         = 4 * 1024 * 1024,
+	               unsigned int  write_interval_msec = 100,
+	               unsigned int  compression         = BBLOG_COMPRESSION_NONE,
+	               int           compression_level   = 0);
 	virtual ~BBLoggerThread();
 
 	const char *get_filename() const;
@@ -86,13 +93,12 @@ protected:
 private:
 	void write_header();
 	void update_header();
-	void write_chunk(const void *chunk);
+	void append_chunk(const void *chunk);
 
 private:
 	fawkes::Interface *iface_;
 
-	unsigned int num_data_items_;
-	unsigned int session_start_;
+	uint64_t session_start_;
 
 	bool        enabled_;
 	bool        buffering_;
@@ -104,7 +110,14 @@ private:
 	char *      uid_;
 	std::string type_;
 	std::string id_;
-	FILE *      f_data_;
+	int         fd_;
+
+	size_t       buffer_size_;
+	unsigned int write_interval_msec_;
+	unsigned int compression_;
+	int          compression_level_;
+	BBLogWriter *writer_;
+	uint64_t     dropped_reported_;
 
 	fawkes::Time *start_;
 	fawkes::Time *now_;
@@ -113,9 +126,7 @@ private:
 	fawkes::ThreadList       threads_;
 	fawkes::SwitchInterface *switch_if_;
 
-	fawkes::Mutex *           queue_mutex_;
-	unsigned int              act_queue_;
-	fawkes::LockQueue<void *> queues_[2];
+	fawkes::Mutex *write_mutex_;
 };
 
 #endif
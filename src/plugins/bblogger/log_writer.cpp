@@ -0,0 +1,494 @@
+
+/***************************************************************************
+ *  log_writer.cpp - BB Logger batching file writer
+ *
+ *  Created: Sun Oct 18 02:10:27 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "log_writer.h"
+
+#include "compression.h"
+#include "file.h"
+
+#include <core/exceptions/system.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+#include <utils/time/time.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/// @cond INTERNALS
+// Alignment of the entry buffer, one memory page
+#define BUFFER_ALIGNMENT 4096
+// Minimum number of entry slots, regardless of the buffer size
+#define MIN_SLOTS 16
+// Number of bytes after which the kernel is asked to start writeback
+#define WRITEBACK_SIZE (8 * 1024 * 1024)
+/// @endcond
+
+using namespace fawkes;
+
+/** @class BBLogWriter "log_writer.h"
+ * Batching writer for BlackBoard log entries.
+ * Entries are stored in a preallocated, page-aligned ring buffer of fixed
+ * size slots, each holding the entry header immediately followed by the
+ * data chunk, i.e. exactly the on-disk representation of the entry. This
+ * avoids any allocation when an entry is appended and allows to write out
+ * all pending entries with a single writev() call of at most two segments.
+ *
+ * Appending may be done from any thread. Writing must only ever happen
+ * from a single thread, typically the logger thread which waits for a
+ * batch of entries to be ready using wait(). If the ring buffer is full
+ * entries are dropped and counted, rather than blocking the writer of the
+ * logged interface.
+ *
+ * For every index_stride() entries written a time index entry is recorded,
+ * the index is appended to the file with finish() once all entries have
+ * been written.
+ *
+ * If a compression method is given, written entries are collected into
+ * blocks of about BBLOG_BLOCK_SIZE bytes, which are delta encoded and
+ * compressed as a whole and written with a block header. Compressed files
+ * do not have a time index. The last, partial block is only written on
+ * flush() or finish(), hence entries written remain in memory until the
+ * block is full.
+ *
+ * On Linux the kernel is asked to start writeback of written data at
+ * regular intervals. This avoids large amounts of dirty pages which cause
+ * long stalls once the kernel decides to write them all at once.
+ * @author Tim Niemueller
+ */
+
+/** Constructor.
+ * The writer writes to the current position of the file descriptor, the
+ * file header must have been written before.
+ * @param filename name of the log file, used for error messages
+ * @param fd file descriptor to write to, must stay open for the lifetime
+ * of the writer and is not closed on destruction
+ * @param data_size size of the interface data chunk
+ * @param buffer_size size of the ring buffer in bytes, the number of slots
+ * is derived from this and the entry size
+ * @param batch_size number of bytes pending after which a thread in
+ * wait() is woken up, 0 to wake up on every entry
+ * @param compression compression method, one of BBLOG_COMPRESSION_*,
+ * the file header must have been written with the appropriate file
+ * version and compression field
+ * @param compression_level compression level, 0 for the default
+ * @exception Exception thrown if the compression method is not available
+ */
+BBLogWriter::BBLogWriter(const char * filename,
+                         int          fd,
+                         size_t       data_size,
+                         size_t       buffer_size,
+                         size_t       batch_size,
+                         unsigned int compression,
+                         int          compression_level)
+: fd_(fd), data_size_(data_size), compression_(compression), compression_level_(compression_level)
+{
+	if (!BBLogCompression::available(compression)) {
+		throw Exception("Log compression '%s' not available", BBLogCompression::name(compression));
+	}
+
+	entry_size_  = sizeof(bblog_entry_header) + data_size;
+	num_slots_   = std::max((size_t)MIN_SLOTS, buffer_size / entry_size_);
+	batch_slots_ = std::min(num_slots_ / 2, std::max((size_t)1, batch_size / entry_size_));
+
+	void *buf = NULL;
+	if (posix_memalign(&buf, BUFFER_ALIGNMENT, num_slots_ * entry_size_) != 0) {
+		throw OutOfMemoryException("Cannot allocate log buffer of %zu bytes",
+		                           num_slots_ * entry_size_);
+	}
+	buffer_       = (char *)buf;
+	filename_     = strdup(filename);
+	index_stride_ = index_stride(entry_size_);
+
+	block_slots_   = std::max((size_t)1, (size_t)BBLOG_BLOCK_SIZE / entry_size_);
+	block_entries_ = 0;
+	block_         = NULL;
+	cblock_size_   = 0;
+	cblock_        = NULL;
+	if (compression_ != BBLOG_COMPRESSION_NONE) {
+		cblock_size_ = BBLogCompression::compress_bound(compression_, block_slots_ * entry_size_);
+		block_       = (char *)malloc(block_slots_ * entry_size_);
+		cblock_      = (char *)malloc(cblock_size_);
+		if (!block_ || !cblock_) {
+			free(block_);
+			free(cblock_);
+			free(buffer_);
+			free(filename_);
+			throw OutOfMemoryException("Cannot allocate compression buffers");
+		}
+	}
+
+	append_mutex_ = new Mutex();
+	wait_mutex_   = new Mutex();
+	waitcond_     = new WaitCondition(wait_mutex_);
+
+	head_           = 0;
+	tail_           = 0;
+	wakeup_pending_ = false;
+	dropped_        = 0;
+	bytes_written_  = 0;
+
+	off_t offset      = lseek(fd_, 0, SEEK_CUR);
+	start_offset_     = (offset > 0) ? offset : 0;
+	writeback_offset_ = start_offset_;
+}
+
+/** Destructor.
+ * Entries not yet written are discarded, call finish() before.
+ */
+BBLogWriter::~BBLogWriter()
+{
+	free(cblock_);
+	free(block_);
+	delete waitcond_;
+	delete wait_mutex_;
+	delete append_mutex_;
+	free(buffer_);
+	free(filename_);
+}
+
+/** Append an entry.
+ * @param rel_time time relative to the log start time
+ * @param data interface data chunk, must be of the data size given to
+ * the constructor
+ * @return true if the entry has been appended, false if it was dropped
+ * because the buffer is full
+ */
+bool
+BBLogWriter::append(const Time &rel_time, const void *data)
+{
+	append_mutex_->lock();
+	uint64_t head = head_.load(std::memory_order_relaxed);
+	uint64_t tail = tail_.load(std::memory_order_acquire);
+	if (head - tail >= num_slots_) {
+		append_mutex_->unlock();
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+		if (!wakeup_pending_.exchange(true)) {
+			wakeup();
+		}
+		return false;
+	}
+
+	char *              slot  = buffer_ + (head % num_slots_) * entry_size_;
+	bblog_entry_header *ehead = (bblog_entry_header *)slot;
+	ehead->rel_time_sec       = rel_time.get_sec();
+	ehead->rel_time_usec      = rel_time.get_usec();
+	memcpy(slot + sizeof(bblog_entry_header), data, data_size_);
+	head_.store(head + 1, std::memory_order_release);
+	append_mutex_->unlock();
+
+	if (head + 1 - tail >= batch_slots_ && !wakeup_pending_.exchange(true)) {
+		wakeup();
+	}
+	return true;
+}
+
+/** Wait for a batch of entries.
+ * Waits until at least the configured batch size is pending, wakeup() is
+ * called, or the timeout expires.
+ * @param timeout_msec timeout in milliseconds, 0 to wait without timeout
+ * @return true if a full batch is pending, false otherwise
+ */
+bool
+BBLogWriter::wait(unsigned int timeout_msec)
+{
+	wait_mutex_->lock();
+	if (num_pending() < batch_slots_ && !wakeup_pending_) {
+		if (timeout_msec > 0) {
+			waitcond_->reltimed_wait(timeout_msec / 1000, (timeout_msec % 1000) * 1000000);
+		} else {
+			waitcond_->wait();
+		}
+	}
+	wakeup_pending_ = false;
+	wait_mutex_->unlock();
+	return num_pending() >= batch_slots_;
+}
+
+/** Wake up a thread waiting in wait(). */
+void
+BBLogWriter::wakeup()
+{
+	MutexLocker lock(wait_mutex_);
+	waitcond_->wake_all();
+}
+
+/** Write all pending entries.
+ * Must only be called from a single thread at a time.
+ * @return number of entries written
+ * @exception FileWriteException thrown if writing fails
+ */
+size_t
+BBLogWriter::write_pending()
+{
+	uint64_t tail = tail_.load(std::memory_order_relaxed);
+	uint64_t head = head_.load(std::memory_order_acquire);
+	size_t   num  = head - tail;
+	if (num == 0)
+		return 0;
+
+	if (compression_ != BBLOG_COMPRESSION_NONE) {
+		for (uint64_t e = tail; e < head; ++e) {
+			memcpy(block_ + block_entries_ * entry_size_,
+			       buffer_ + (e % num_slots_) * entry_size_,
+			       entry_size_);
+			if (++block_entries_ == block_slots_) {
+				write_block();
+			}
+		}
+		tail_.store(head, std::memory_order_release);
+		start_writeback();
+		return num;
+	}
+
+	size_t first = tail % num_slots_;
+	size_t n1    = std::min(num, num_slots_ - first);
+
+	struct iovec iov[2];
+	iov[0].iov_base = buffer_ + first * entry_size_;
+	iov[0].iov_len  = n1 * entry_size_;
+	iov[1].iov_base = buffer_;
+	iov[1].iov_len  = (num - n1) * entry_size_;
+
+	write_iov(iov, (num > n1) ? 2 : 1);
+
+	for (uint64_t e = ((tail + index_stride_ - 1) / index_stride_) * index_stride_; e < head;
+	     e += index_stride_) {
+		const bblog_entry_header *ehead =
+		  (const bblog_entry_header *)(buffer_ + (e % num_slots_) * entry_size_);
+		bblog_index_entry ientry;
+		ientry.offset        = start_offset_ + e * entry_size_;
+		ientry.rel_time_sec  = ehead->rel_time_sec;
+		ientry.rel_time_usec = ehead->rel_time_usec;
+		index_.push_back(ientry);
+	}
+
+	tail_.store(head, std::memory_order_release);
+	bytes_written_.fetch_add(num * entry_size_, std::memory_order_relaxed);
+	start_writeback();
+	return num;
+}
+
+/** Write all pending entries and the current block.
+ * For compressed files this writes the current block even if it is not
+ * full, to make sure all entries are on disk. Note that many small
+ * blocks compress considerably worse. For uncompressed files this is
+ * the same as write_pending().
+ * @exception FileWriteException thrown if writing fails
+ */
+void
+BBLogWriter::flush()
+{
+	write_pending();
+	write_block();
+}
+
+/** Finish writing.
+ * Writes all pending entries, the last block of compressed files, and the
+ * time index and index trailer of uncompressed files. This must be called
+ * only once, no entries may be appended afterwards.
+ * @exception FileWriteException thrown if writing fails
+ */
+void
+BBLogWriter::finish()
+{
+	flush();
+	if (compression_ == BBLOG_COMPRESSION_NONE) {
+		write_index();
+	}
+}
+
+/** Write vector of buffers completely.
+ * @param iov buffers to write, modified to account for partial writes
+ * @param iovcnt number of buffers
+ * @exception FileWriteException thrown if writing fails
+ */
+void
+BBLogWriter::write_iov(struct iovec *iov, int iovcnt)
+{
+	while (iovcnt > 0) {
+		ssize_t written = ::writev(fd_, iov, iovcnt);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			throw FileWriteException(filename_, errno, "Failed to write log entries");
+		}
+		while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+			written -= iov->iov_len;
+			++iov;
+			--iovcnt;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+}
+
+/** Compress and write current block.
+ * @exception FileWriteException thrown if writing fails
+ */
+void
+BBLogWriter::write_block()
+{
+	if (block_entries_ == 0)
+		return;
+
+	const bblog_entry_header *ehead = (const bblog_entry_header *)block_;
+	bblog_block_header        bhead;
+	bhead.num_entries   = block_entries_;
+	bhead.rel_time_sec  = ehead->rel_time_sec;
+	bhead.rel_time_usec = ehead->rel_time_usec;
+
+	BBLogCompression::delta_encode(block_, block_entries_, entry_size_, sizeof(bblog_entry_header));
+	bhead.compressed_size = BBLogCompression::compress(
+	  compression_, compression_level_, block_, block_entries_ * entry_size_, cblock_, cblock_size_);
+	block_entries_ = 0;
+
+	struct iovec iov[2];
+	iov[0].iov_base = &bhead;
+	iov[0].iov_len  = sizeof(bhead);
+	iov[1].iov_base = cblock_;
+	iov[1].iov_len  = bhead.compressed_size;
+	write_iov(iov, 2);
+	bytes_written_.fetch_add(sizeof(bhead) + bhead.compressed_size, std::memory_order_relaxed);
+}
+
+/** Write time index.
+ * Appends the time index and the index trailer after the last entry.
+ * @exception FileWriteException thrown if writing fails
+ */
+void
+BBLogWriter::write_index()
+{
+	bblog_index_trailer trailer;
+	memset(&trailer, 0, sizeof(trailer));
+	trailer.index_offset      = start_offset_ + bytes_written_.load(std::memory_order_relaxed);
+	trailer.num_index_entries = index_.size();
+	trailer.index_stride      = index_stride_;
+	trailer.index_magic       = htonl(BBLOGGER_INDEX_MAGIC);
+
+	struct iovec iov[2];
+	iov[0].iov_base = index_.data();
+	iov[0].iov_len  = index_.size() * sizeof(bblog_index_entry);
+	iov[1].iov_base = &trailer;
+	iov[1].iov_len  = sizeof(trailer);
+
+	ssize_t expected = iov[0].iov_len + iov[1].iov_len;
+	if (pwritev(fd_, iov, 2, trailer.index_offset) != expected) {
+		throw FileWriteException(filename_, errno, "Failed to write index");
+	}
+}
+
+/** Ask the kernel to start writeback of written data. */
+void
+BBLogWriter::start_writeback()
+{
+#ifdef __linux__
+	uint64_t end = start_offset_ + bytes_written_.load(std::memory_order_relaxed);
+	if (end - writeback_offset_ >= WRITEBACK_SIZE) {
+		// only a hint, failures such as on file systems not supporting it are ignored
+		sync_file_range(fd_, writeback_offset_, end - writeback_offset_, SYNC_FILE_RANGE_WRITE);
+		writeback_offset_ = end;
+	}
+#endif
+}
+
+/** Get size of a single entry.
+ * @return size of entry header and data chunk in bytes
+ */
+size_t
+BBLogWriter::entry_size() const
+{
+	return entry_size_;
+}
+
+/** Get number of entry slots in the buffer.
+ * @return number of entries that can be pending at most
+ */
+size_t
+BBLogWriter::num_slots() const
+{
+	return num_slots_;
+}
+
+/** Get number of pending entries.
+ * @return number of entries appended but not yet written
+ */
+size_t
+BBLogWriter::num_pending() const
+{
+	return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+}
+
+/** Get number of written entries.
+ * @return number of entries written to the file, for compressed files
+ * this includes the entries of the current block not yet written
+ */
+uint64_t
+BBLogWriter::num_written() const
+{
+	return tail_.load(std::memory_order_acquire);
+}
+
+/** Get number of dropped entries.
+ * @return number of entries dropped because the buffer was full
+ */
+uint64_t
+BBLogWriter::num_dropped() const
+{
+	return dropped_.load(std::memory_order_relaxed);
+}
+
+/** Get index stride.
+ * @param entry_size size of entry header and data chunk in bytes
+ * @return number of entries for which one index entry is written
+ */
+uint32_t
+BBLogWriter::index_stride(size_t entry_size)
+{
+	return std::max((size_t)1, (size_t)BBLOG_INDEX_SPACING / entry_size);
+}
+
+/** Get number of bytes written.
+ * @return number of bytes written to the file
+ */
+uint64_t
+BBLogWriter::bytes_written() const
+{
+	return bytes_written_.load(std::memory_order_relaxed);
+}
+
+/** Get compression method.
+ * @return compression method, one of BBLOG_COMPRESSION_*
+ */
+unsigned int
+BBLogWriter::compression() const
+{
+	return compression_;
+}
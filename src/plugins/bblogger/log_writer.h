@@ -0,0 +1,110 @@
+/***************************************************************************
+ *  log_writer.h - BB Logger batching file writer
+ *
+ *  Created: Sun Oct 18 02:10:27 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_BBLOGGER_LOG_WRITER_H_
+#define _PLUGINS_BBLOGGER_LOG_WRITER_H_
+
+#include "file.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct iovec;
+
+namespace fawkes {
+class Mutex;
+class WaitCondition;
+class Time;
+} // namespace fawkes
+
+class BBLogWriter
+{
+public:
+	BBLogWriter(const char * filename,
+	            int          fd,
+	            size_t       data_size,
+	            size_t       buffer_size,
+	            size_t       batch_size,
+	            unsigned int compression       = BBLOG_COMPRESSION_NONE,
+	            int          compression_level = 0);
+	~BBLogWriter();
+
+	bool append(const fawkes::Time &rel_time, const void *data);
+
+	bool   wait(unsigned int timeout_msec);
+	void   wakeup();
+	size_t write_pending();
+	void   flush();
+	void   finish();
+
+	size_t       entry_size() const;
+	size_t       num_slots() const;
+	size_t       num_pending() const;
+	uint64_t     num_written() const;
+	uint64_t     num_dropped() const;
+	uint64_t     bytes_written() const;
+	unsigned int compression() const;
+
+	static uint32_t index_stride(size_t entry_size);
+
+private:
+	void write_iov(struct iovec *iov, int iovcnt);
+	void write_block();
+	void write_index();
+	void start_writeback();
+
+private:
+	char * filename_;
+	int    fd_;
+	size_t data_size_;
+	size_t entry_size_;
+	size_t num_slots_;
+	size_t batch_slots_;
+	char * buffer_;
+
+	uint32_t                       index_stride_;
+	std::vector<bblog_index_entry> index_;
+
+	unsigned int compression_;
+	int          compression_level_;
+	size_t       block_slots_;
+	size_t       block_entries_;
+	char *       block_;
+	size_t       cblock_size_;
+	char *       cblock_;
+
+	fawkes::Mutex *append_mutex_;
+	fawkes::Mutex *wait_mutex_;
+
+	fawkes::WaitCondition *waitcond_;
+
+	std::atomic<uint64_t> head_;
+	std::atomic<uint64_t> tail_;
+	std::atomic<bool>     wakeup_pending_;
+	std::atomic<uint64_t> dropped_;
+	std::atomic<uint64_t> bytes_written_;
+	uint64_t              start_offset_;
+	uint64_t              writeback_offset_;
+};
+
+#endif
@@ -0,0 +1,251 @@
+
+/***************************************************************************
+ *  qa_bblog_compress.cpp - BB Logger compression benchmark
+ *
+ *  Created: Sun Oct 18 05:48:02 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../bblogfile.h"
+#include "../compression.h"
+#include "../file.h"
+
+#include <core/exception.h>
+#include <utils/qa/qa_check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace fawkes;
+
+/* Compresses the entries of log files given on the command line, or of
+ * synthesized Laser360Interface and Position3DInterface logs if none are
+ * given, in blocks as the bblogger does, and reports the compression
+ * ratio and the compression and decompression throughput for each
+ * available compression method, with and without delta encoding. The
+ * throughput is given in MB/s of uncompressed data.
+ */
+
+static double
+noise(double stddev)
+{
+	// sum of uniform samples, good enough as Gaussian noise here
+	double s = 0.;
+	for (unsigned int i = 0; i < 4; ++i) {
+		s += random() / (double)RAND_MAX - 0.5;
+	}
+	return s * stddev * sqrt(3.);
+}
+
+static void
+set_time(char *entry, size_t i, unsigned int hz)
+{
+	bblog_entry_header *ehead = (bblog_entry_header *)entry;
+	long int            usec  = i * 1000000L / hz + random() % 500;
+	ehead->rel_time_sec       = usec / 1000000;
+	ehead->rel_time_usec      = usec % 1000000;
+}
+
+// Laser360Interface: 360 distances, frame, clockwise flag
+static std::vector<char>
+synth_laser(size_t num_entries, size_t &entry_size)
+{
+	const size_t data_size = 360 * sizeof(float) + 32 + 4;
+	entry_size             = sizeof(bblog_entry_header) + data_size;
+
+	std::vector<char> entries(num_entries * entry_size, 0);
+	for (size_t i = 0; i < num_entries; ++i) {
+		char * e         = &entries[i * entry_size];
+		float *distances = (float *)(e + sizeof(bblog_entry_header));
+		set_time(e, i, 10);
+		// robot slowly moving in a 10m x 6m room
+		double x = 3. + 4. * sin(i * 0.001), y = 1. + 0.5 * cos(i * 0.0013);
+		for (unsigned int a = 0; a < 360; ++a) {
+			double angle = a * M_PI / 180.;
+			double dx = cos(angle), dy = sin(angle);
+			double d  = 1000.;
+			if (dx > 0)
+				d = std::min(d, (5. - x) / dx);
+			if (dx < 0)
+				d = std::min(d, (-5. - x) / dx);
+			if (dy > 0)
+				d = std::min(d, (3. - y) / dy);
+			if (dy < 0)
+				d = std::min(d, (-3. - y) / dy);
+			// some readings are invalid, e.g. due to reflections
+			distances[a] = (random() % 100 == 0) ? 0.f : (float)(d + noise(0.01));
+		}
+		strcpy(e + sizeof(bblog_entry_header) + 360 * sizeof(float), "/base_laser");
+	}
+	return entries;
+}
+
+// Position3DInterface: frame, visibility history, rotation, translation, covariance
+static std::vector<char>
+synth_pose(size_t num_entries, size_t &entry_size)
+{
+	const size_t data_size = 32 + 4 + 4 + 4 * 8 + 3 * 8 + 36 * 8;
+	entry_size             = sizeof(bblog_entry_header) + data_size;
+
+	std::vector<char> entries(num_entries * entry_size, 0);
+	for (size_t i = 0; i < num_entries; ++i) {
+		char *e = &entries[i * entry_size];
+		char *d = e + sizeof(bblog_entry_header);
+		set_time(e, i, 30);
+		strcpy(d, "/map");
+		*(int32_t *)(d + 32) = i;
+		double *rotation     = (double *)(d + 40);
+		double *translation  = rotation + 4;
+		double *covariance   = translation + 3;
+		double  yaw          = 0.0005 * i + noise(0.001);
+		rotation[0] = rotation[1] = 0.;
+		rotation[2]               = sin(yaw / 2.);
+		rotation[3]               = cos(yaw / 2.);
+		translation[0]            = 3. * sin(i * 0.0003) + noise(0.002);
+		translation[1]            = 2. * cos(i * 0.0004) + noise(0.002);
+		translation[2]            = 0.;
+		// covariance mostly constant, updated on every 10th entry
+		for (unsigned int c = 0; c < 6; ++c) {
+			covariance[c * 7] = 0.01 + 0.001 * ((i / 10) % 7);
+		}
+	}
+	return entries;
+}
+
+static std::vector<char>
+read_log(const char *filename, size_t &entry_size)
+{
+	BBLogFile bf(filename, false);
+	entry_size = sizeof(bblog_entry_header) + bf.data_size();
+
+	size_t            num = bf.num_entries();
+	std::vector<char> entries(num * entry_size);
+	for (size_t i = 0; i < num; ++i) {
+		Time                t;
+		const void *        data  = bf.entry_data(i, &t);
+		char *              e     = &entries[i * entry_size];
+		bblog_entry_header *ehead = (bblog_entry_header *)e;
+		ehead->rel_time_sec       = t.get_sec();
+		ehead->rel_time_usec      = t.get_usec();
+		memcpy(e + sizeof(bblog_entry_header), data, bf.data_size());
+	}
+	return entries;
+}
+
+static void
+benchmark(const char *name, const std::vector<char> &entries, size_t entry_size)
+{
+	size_t num_entries = entries.size() / entry_size;
+	size_t per_block   = std::max((size_t)1, (size_t)BBLOG_BLOCK_SIZE / entry_size);
+	printf("%s: %zu entries of %zu bytes, %.1f MB\n",
+	       name,
+	       num_entries,
+	       entry_size,
+	       entries.size() / 1048576.);
+
+	std::vector<char> block(per_block * entry_size);
+	for (unsigned int c = BBLOG_COMPRESSION_LZ4; c <= BBLOG_COMPRESSION_ZSTD; ++c) {
+		if (!BBLogCompression::available(c)) {
+			printf("  %-5s not available\n", BBLogCompression::name(c));
+			continue;
+		}
+		std::vector<char> compressed(
+		  BBLogCompression::compress_bound(c, per_block * entry_size) * (num_entries / per_block + 1));
+
+		for (int delta = 0; delta <= 1; ++delta) {
+			std::vector<size_t> sizes;
+			size_t              total = 0;
+			long int            start = qa::now_nsec();
+			for (size_t first = 0; first < num_entries; first += per_block) {
+				size_t n = std::min(per_block, num_entries - first);
+				memcpy(block.data(), &entries[first * entry_size], n * entry_size);
+				if (delta)
+					BBLogCompression::delta_encode(block.data(), n, entry_size, sizeof(bblog_entry_header));
+				size_t s = BBLogCompression::compress(c,
+				                                      0,
+				                                      block.data(),
+				                                      n * entry_size,
+				                                      &compressed[total],
+				                                      compressed.size() - total);
+				sizes.push_back(s);
+				total += s;
+			}
+			long int compress_nsec = qa::now_nsec() - start;
+
+			size_t offset = 0;
+			start         = qa::now_nsec();
+			for (size_t first = 0, b = 0; first < num_entries; first += per_block, ++b) {
+				size_t n = std::min(per_block, num_entries - first);
+				BBLogCompression::decompress(
+				  c, &compressed[offset], sizes[b], block.data(), n * entry_size);
+				if (delta)
+					BBLogCompression::delta_decode(block.data(), n, entry_size, sizeof(bblog_entry_header));
+				if (!qa::check(memcmp(block.data(), &entries[first * entry_size], n * entry_size) == 0,
+				               "block %zu does not match after decompression",
+				               b)) {
+					exit(1);
+				}
+				offset += sizes[b];
+			}
+			long int decompress_nsec = qa::now_nsec() - start;
+
+			double mbytes = entries.size() / 1048576.;
+			printf("  %-5s %-8s ratio %6.2f  compress %8.1f MB/s  decompress %8.1f MB/s\n",
+			       BBLogCompression::name(c),
+			       delta ? "delta" : "no delta",
+			       (double)entries.size() / total,
+			       mbytes / (compress_nsec / 1000000000.),
+			       mbytes / (decompress_nsec / 1000000000.));
+		}
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	try {
+		size_t entry_size;
+		if (argc > 1) {
+			for (int i = 1; i < argc; ++i) {
+				std::vector<char> entries = read_log(argv[i], entry_size);
+				benchmark(argv[i], entries, entry_size);
+			}
+		} else {
+			size_t num_entries = 20000;
+			{
+				std::vector<char> entries = synth_laser(num_entries, entry_size);
+				benchmark("Laser360 (synthetic)", entries, entry_size);
+			}
+			{
+				std::vector<char> entries = synth_pose(num_entries, entry_size);
+				benchmark("Position3D (synthetic)", entries, entry_size);
+			}
+		}
+	} catch (Exception &e) {
+		e.print_trace();
+		return 1;
+	}
+	return 0;
+}
+
+/// @endcond
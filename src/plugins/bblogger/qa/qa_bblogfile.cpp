@@ -0,0 +1,270 @@
+
+/***************************************************************************
+ *  qa_bblogfile.cpp - BB Logger file format QA
+ *
+ *  Created: Sun Oct 18 04:12:36 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../bblogfile.h"
+#include "../compression.h"
+#include "../file.h"
+#include "../log_writer.h"
+
+#include <core/exception.h>
+#include <utils/qa/qa_check.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/* Writes a log file with the given version and verifies reading, finding
+ * entries by time offset with and without index against a linear scan,
+ * restoring a missing index by repairing, and the time it takes to find
+ * entries in a large log. The same is done for compressed logs with each
+ * available compression method, including repairing a log with a
+ * truncated last block.
+ */
+
+#define DATA_SIZE 1464
+
+static Time
+entry_time(size_t i)
+{
+	// 25 Hz with jitter and multiple entries with the same time
+	long usec = (i / 2) * 40000 + (i % 7) * 10;
+	return Time(usec / 1000000, usec % 1000000);
+}
+
+static void
+write_log(const char * filename,
+          unsigned int version,
+          size_t       num_entries,
+          bool         finish,
+          unsigned int compression = BBLOG_COMPRESSION_NONE)
+{
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		perror("open");
+		exit(2);
+	}
+
+	bblog_file_header header;
+	memset(&header, 0, sizeof(header));
+	header.file_magic     = htonl(BBLOGGER_FILE_MAGIC);
+	header.file_version   = htonl(version);
+	header.endianess      = (htonl(1) == 1) ? BBLOG_BIG_ENDIAN : BBLOG_LITTLE_ENDIAN;
+	header.compression    = compression;
+	header.num_data_items = num_entries;
+	strcpy(header.scenario, "qa");
+	strcpy(header.interface_type, "Laser360Interface");
+	strcpy(header.interface_id, "Laser");
+	header.data_size = DATA_SIZE;
+	if (write(fd, &header, sizeof(header)) != sizeof(header)) {
+		perror("write");
+		exit(2);
+	}
+
+	BBLogWriter writer(filename, fd, DATA_SIZE, 1024 * 1024, 0, compression);
+	char        data[DATA_SIZE];
+	for (size_t i = 0; i < num_entries; ++i) {
+		memset(data, i & 0xFF, DATA_SIZE);
+		while (!writer.append(entry_time(i), data)) {
+			writer.write_pending();
+		}
+	}
+	if (finish) {
+		writer.finish();
+	} else {
+		writer.write_pending();
+	}
+	close(fd);
+}
+
+static size_t
+linear_find(BBLogFile &bf, const Time &offset)
+{
+	Time t;
+	for (size_t i = 0; i < bf.num_entries(); ++i) {
+		bf.entry_data(i, &t);
+		if (t >= offset)
+			return i;
+	}
+	return bf.num_entries();
+}
+
+static bool
+check_log(const char *filename, size_t num_entries, bool expect_index)
+{
+	BBLogFile bf(filename, true);
+	if (!qa::check(bf.num_entries() == num_entries && bf.has_index() == expect_index,
+	               "%zu entries, index %i (expected %zu/%i)",
+	               bf.num_entries(),
+	               bf.has_index(),
+	               num_entries,
+	               expect_index)) {
+		return false;
+	}
+
+	for (size_t i = 0; i < num_entries; i += 97) {
+		Time                 t;
+		const unsigned char *d = (const unsigned char *)bf.entry_data(i, &t);
+		if (!qa::check(t == entry_time(i) && d[0] == (i & 0xFF) && d[DATA_SIZE - 1] == (i & 0xFF),
+		               "entry %zu does not match",
+		               i)) {
+			return false;
+		}
+	}
+
+	long step = std::max(3331L, (long)num_entries * 20000 / 500);
+	for (long usec = -1000; usec < (long)num_entries * 20000 + 100000; usec += step) {
+		Time   offset(usec / 1000000, usec % 1000000);
+		size_t found    = bf.find_entry(offset);
+		size_t expected = linear_find(bf, offset);
+		if (!qa::check(found == expected,
+		               "offset %f found %zu, expected %zu",
+		               offset.in_sec(),
+		               found,
+		               expected)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *filename = "/tmp/qa_bblogfile.log";
+	size_t      num_entries[] = {1, 43, 44, 45, 1000, 12345};
+	bool        ok            = true;
+
+	try {
+		for (size_t n : num_entries) {
+			write_log(filename, 1, n, false);
+			ok &= check_log(filename, n, false);
+			write_log(filename, BBLOGGER_FILE_VERSION, n, true);
+			ok &= check_log(filename, n, true);
+
+			// simulate a logger that did not terminate properly
+			write_log(filename, BBLOGGER_FILE_VERSION, n, false);
+			ok &= check_log(filename, n, false);
+			try {
+				BBLogFile::repair_file(filename);
+				ok = qa::check(false, "nothing repaired for %zu entries", n);
+			} catch (Exception &e) {
+				if (strcmp(e.type_id(), "repair-success") != 0)
+					throw;
+			}
+			ok &= check_log(filename, n, true);
+		}
+
+		for (unsigned int c = BBLOG_COMPRESSION_LZ4; c <= BBLOG_COMPRESSION_ZSTD; ++c) {
+			if (!BBLogCompression::available(c)) {
+				printf("Compression %s not available, skipping\n", BBLogCompression::name(c));
+				continue;
+			}
+			size_t per_block = BBLOG_BLOCK_SIZE / (sizeof(bblog_entry_header) + DATA_SIZE);
+			for (size_t n : num_entries) {
+				write_log(filename, BBLOGGER_FILE_VERSION_COMPRESSED, n, true, c);
+				ok &= check_log(filename, n, false);
+				if (n <= per_block)
+					continue;
+
+				// simulate a crash while writing the last block
+				struct stat s;
+				if (stat(filename, &s) != 0 || truncate(filename, s.st_size - 10) != 0) {
+					perror("truncate");
+					exit(2);
+				}
+				try {
+					BBLogFile::repair_file(filename);
+					ok = qa::check(false, "nothing repaired for %zu compressed entries", n);
+				} catch (Exception &e) {
+					if (strcmp(e.type_id(), "repair-success") != 0)
+						throw;
+				}
+				ok &= check_log(filename, (n - 1) / per_block * per_block, false);
+			}
+		}
+
+		// search timing on a larger log
+		size_t n = 200000;
+		write_log(filename, 1, n, false);
+		{
+			BBLogFile bf(filename, true);
+			long int  start = qa::now_nsec();
+			for (unsigned int i = 0; i < 1000; ++i) {
+				bf.find_entry(entry_time(random() % n));
+			}
+			printf("find without index: %8.3f usec\n", (qa::now_nsec() - start) / 1000. / 1000);
+		}
+		write_log(filename, BBLOGGER_FILE_VERSION, n, true);
+		{
+			BBLogFile bf(filename, true);
+			long int  start = qa::now_nsec();
+			for (unsigned int i = 0; i < 1000; ++i) {
+				bf.find_entry(entry_time(random() % n));
+			}
+			printf("find with index:    %8.3f usec\n", (qa::now_nsec() - start) / 1000. / 1000);
+
+			start    = qa::now_nsec();
+			Time     t;
+			uint64_t sum = 0;
+			for (size_t i = 0; i < bf.num_entries(); ++i) {
+				sum += *(const unsigned char *)bf.entry_data(i, &t);
+			}
+			long int d = qa::now_nsec() - start;
+			printf("scan %zu entries:  %8.3f msec (%.0f MB/s, checksum %lu)\n",
+			       bf.num_entries(),
+			       d / 1000000.,
+			       bf.file_size() / 1048576. / (d / 1000000000.),
+			       (unsigned long int)sum);
+		}
+		for (unsigned int c = BBLOG_COMPRESSION_LZ4; c <= BBLOG_COMPRESSION_ZSTD; ++c) {
+			if (!BBLogCompression::available(c))
+				continue;
+			write_log(filename, BBLOGGER_FILE_VERSION_COMPRESSED, n, true, c);
+			BBLogFile bf(filename, true);
+			long int  start = qa::now_nsec();
+			for (unsigned int i = 0; i < 1000; ++i) {
+				bf.find_entry(entry_time(random() % n));
+			}
+			printf("find with %-4s:     %8.3f usec (%zu blocks)\n",
+			       BBLogCompression::name(c),
+			       (qa::now_nsec() - start) / 1000. / 1000,
+			       bf.num_blocks());
+		}
+	} catch (Exception &e) {
+		e.print_trace();
+		ok = false;
+	}
+
+	unlink(filename);
+	return qa::result(ok);
+}
+
+/// @endcond
@@ -0,0 +1,237 @@
+
+/***************************************************************************
+ *  qa_bblogger_write.cpp - BB Logger write throughput QA
+ *
+ *  Created: Sun Oct 18 02:58:14 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../file.h"
+#include "../log_writer.h"
+
+#include <core/threading/mutex.h>
+#include <core/threading/thread.h>
+#include <core/utils/lock_queue.h>
+#include <utils/qa/qa_check.h>
+#include <utils/time/time.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace fawkes;
+
+/* Writes N entries of the given data size as fast as possible and reports
+ * the sustained throughput, including a final fdatasync, and the time the
+ * producer spends per entry. The latter is the overhead added to the
+ * BlackBoard data changed event of the logged interface. "queue" is the
+ * previous scheme of a malloc'ed copy per entry which is queued and written
+ * with two fwrite calls, "batched" uses the BBLogWriter ring buffer.
+ * If the ring buffer is full the producer backs off, this time is not
+ * accounted as producer overhead.
+ */
+
+class QueueWriterThread : public Thread
+{
+public:
+	QueueWriterThread(FILE *f, size_t data_size)
+	: Thread("QueueWriterThread", Thread::OPMODE_CONTINUOUS), f_(f), data_size_(data_size)
+	{
+		written = 0;
+	}
+
+	virtual void
+	loop()
+	{
+		queue.lock();
+		while (!queue.empty()) {
+			void *c = queue.front();
+			queue.pop();
+			queue.unlock();
+			bblog_entry_header ehead;
+			ehead.rel_time_sec  = 0;
+			ehead.rel_time_usec = 0;
+			fwrite(&ehead, sizeof(ehead), 1, f_);
+			fwrite(c, data_size_, 1, f_);
+			free(c);
+			written += 1;
+			queue.lock();
+		}
+		queue.unlock();
+		usleep(100);
+	}
+
+	LockQueue<void *>     queue;
+	std::atomic<uint64_t> written;
+
+private:
+	FILE * f_;
+	size_t data_size_;
+};
+
+class BatchWriterThread : public Thread
+{
+public:
+	BatchWriterThread(BBLogWriter *writer)
+	: Thread("BatchWriterThread", Thread::OPMODE_CONTINUOUS), writer_(writer)
+	{
+	}
+
+	virtual void
+	loop()
+	{
+		writer_->wait(100);
+		writer_->write_pending();
+	}
+
+private:
+	BBLogWriter *writer_;
+};
+
+static void
+print_result(const char *what,
+             size_t      data_size,
+             uint64_t    num_entries,
+             long int    producer_nsec,
+             long int    total_nsec)
+{
+	double mbytes = (double)num_entries * (sizeof(bblog_entry_header) + data_size) / 1048576.;
+	printf("%-8s size: %6zu  entries: %8lu  %8.1f MB/s  producer: %8.3f usec/entry\n",
+	       what,
+	       data_size,
+	       (unsigned long int)num_entries,
+	       mbytes / (total_nsec / 1000000000.),
+	       producer_nsec / 1000. / num_entries);
+}
+
+static void
+run_queue(const char *filename, size_t data_size, uint64_t num_entries, const char *data)
+{
+	FILE *f = fopen(filename, "w");
+	if (!f) {
+		perror("fopen");
+		exit(2);
+	}
+
+	QueueWriterThread writer(f, data_size);
+	writer.start();
+
+	long int start         = qa::now_nsec();
+	long int producer_nsec = 0;
+	for (uint64_t i = 0; i < num_entries; ++i) {
+		long int p = qa::now_nsec();
+		void *   c = malloc(data_size);
+		memcpy(c, data, data_size);
+		writer.queue.push_locked(c);
+		producer_nsec += qa::now_nsec() - p;
+	}
+	while (writer.written < num_entries) {
+		usleep(1000);
+	}
+	writer.cancel();
+	writer.join();
+	fflush(f);
+	fdatasync(fileno(f));
+	long int total_nsec = qa::now_nsec() - start;
+	fclose(f);
+
+	print_result("queue", data_size, num_entries, producer_nsec, total_nsec);
+}
+
+static void
+run_batched(const char *filename,
+            size_t      data_size,
+            uint64_t    num_entries,
+            const char *data,
+            size_t      buffer_size)
+{
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		perror("open");
+		exit(2);
+	}
+
+	BBLogWriter       writer(filename, fd, data_size, buffer_size, buffer_size / 4);
+	BatchWriterThread writer_thread(&writer);
+	writer_thread.start();
+
+	Time     rel_time((long int)0, (long int)0);
+	long int start         = qa::now_nsec();
+	long int producer_nsec = 0;
+	uint64_t num_full      = 0;
+	for (uint64_t i = 0; i < num_entries; ++i) {
+		long int p = qa::now_nsec();
+		while (!writer.append(rel_time, data)) {
+			producer_nsec -= qa::now_nsec() - p;
+			++num_full;
+			usleep(100);
+			p = qa::now_nsec();
+		}
+		producer_nsec += qa::now_nsec() - p;
+	}
+	while (writer.num_written() < num_entries) {
+		writer.wakeup();
+		usleep(1000);
+	}
+	writer_thread.cancel();
+	writer_thread.join();
+	fdatasync(fd);
+	long int total_nsec = qa::now_nsec() - start;
+	off_t    file_size  = lseek(fd, 0, SEEK_END);
+	close(fd);
+	if (!qa::check((uint64_t)file_size == num_entries * writer.entry_size(),
+	               "file has %ld bytes, expected %lu",
+	               (long int)file_size,
+	               (unsigned long int)(num_entries * writer.entry_size()))) {
+		exit(1);
+	}
+
+	print_result("batched", data_size, num_entries, producer_nsec, total_nsec);
+	printf("         buffer: %zu entries, full: %lu times\n",
+	       writer.num_slots(),
+	       (unsigned long int)num_full);
+}
+
+int
+main(int argc, char **argv)
+{
+	uint64_t    num_entries = (argc > 1) ? atoi(argv[1]) : 100000;
+	size_t      buffer_size = (argc > 2) ? atoi(argv[2]) : 4 * 1024 * 1024;
+	const char *filename    = (argc > 3) ? argv[3] : "/tmp/qa_bblogger_write.log";
+
+	// typical sizes: pose, Laser360Interface, Laser1080Interface
+	size_t data_sizes[] = {128, 1464, 4372};
+	for (size_t data_size : data_sizes) {
+		char *data = (char *)malloc(data_size);
+		for (size_t i = 0; i < data_size; ++i) {
+			data[i] = random() & 0xFF;
+		}
+		run_queue(filename, data_size, num_entries, data);
+		run_batched(filename, data_size, num_entries, data, buffer_size);
+		free(data);
+	}
+
+	unlink(filename);
+	return 0;
+}
+
+/// @endcond
@@ -0,0 +1,285 @@
+
+/***************************************************************************
+ *  qa_colli_astar.cpp - Colli incremental search benchmark
+ *
+ *  Created: Sun Oct 18 10:12:37 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../search/astar.h"
+#include "../utils/occupancygrid/occupancygrid.h"
+
+#include <config/memory.h>
+#include <core/exception.h>
+#include <logging/console.h>
+#include <utils/math/types.h>
+#include <utils/qa/qa_check.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+using namespace fawkes;
+
+/* Replays a sequence of colli occupancy grids and plans a path from the
+ * robot to the target in each of them, once with a planner that is kept
+ * over the whole sequence and replans incrementally, and once with a new
+ * planner for every grid. Reports the time per plan for both and verifies
+ * that both paths are valid and have the same cost. The sequence is read
+ * from a file given with -r, otherwise grids are synthesized with people
+ * walking around a robot standing in a room, optionally written to a file
+ * given with -w to replay them later.
+ *
+ * The grid file contains one grid per line, consisting of the width and
+ * height, the robot and target cell, and the costs of all cells in rows
+ * of increasing x.
+ */
+
+struct Frame
+{
+	int              width, height;
+	point_t          robot, target;
+	std::vector<int> costs;
+};
+
+static colli_cell_cost_t costs = {1000, 4, 3, 2, 1};
+
+static void
+stamp(Frame &f, double cx, double cy, double radius)
+{
+	for (int x = std::max(0, (int)(cx - radius - 4)); x < std::min(f.width, (int)(cx + radius + 5));
+	     ++x) {
+		for (int y = std::max(0, (int)(cy - radius - 4));
+		     y < std::min(f.height, (int)(cy + radius + 5));
+		     ++y) {
+			double       d    = hypot(x - cx, y - cy) - radius;
+			unsigned int cost = (d <= 0) ? costs.occ
+			                    : (d <= 1) ? costs.near
+			                    : (d <= 2) ? costs.mid : costs.far;
+			int &        cell = f.costs[x * f.height + y];
+			if (d <= 3 && cell < (int)cost)
+				cell = cost;
+		}
+	}
+}
+
+// 7.5m x 7.5m grid with 5cm cells around a robot in a room with people
+static std::vector<Frame>
+synth_frames(unsigned int num_frames)
+{
+	std::vector<Frame> frames(num_frames);
+	for (unsigned int i = 0; i < num_frames; ++i) {
+		Frame &f = frames[i];
+		f.width = f.height = 150;
+		f.robot            = point_t(75, 75);
+		f.target           = point_t(130 + (int)(8 * sin(i * 0.02)), 30 + (int)(10 * cos(i * 0.03)));
+		f.costs.assign(f.width * f.height, costs.free);
+		for (int x = 0; x < f.width; ++x) {
+			stamp(f, x, 5, 2);
+			stamp(f, x, 145, 2);
+		}
+		for (int y = 40; y < 120; ++y)
+			stamp(f, 105, y, 2);
+		stamp(f, 40, 40, 8);
+		// people walking back and forth
+		for (unsigned int p = 0; p < 4; ++p) {
+			double phase = i * 0.03 + p * 1.7;
+			stamp(f, 20 + 30 * p + 10 * sin(phase), 75 + 50 * sin(phase * 0.7), 4);
+		}
+	}
+	return frames;
+}
+
+static std::vector<Frame>
+read_frames(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if (!f)
+		throw Exception(errno, "Failed to open grid file %s", filename);
+
+	std::vector<Frame> frames;
+	Frame              fr;
+	while (fscanf(f,
+	              "%d %d %d %d %d %d",
+	              &fr.width,
+	              &fr.height,
+	              &fr.robot.x,
+	              &fr.robot.y,
+	              &fr.target.x,
+	              &fr.target.y)
+	       == 6) {
+		fr.costs.resize(fr.width * fr.height);
+		for (int &c : fr.costs) {
+			if (fscanf(f, "%d", &c) != 1) {
+				fclose(f);
+				throw Exception("Grid %zu of %s is truncated", frames.size(), filename);
+			}
+		}
+		frames.push_back(fr);
+	}
+	fclose(f);
+	return frames;
+}
+
+static void
+write_frames(const char *filename, const std::vector<Frame> &frames)
+{
+	FILE *f = fopen(filename, "w");
+	if (!f)
+		throw Exception(errno, "Failed to open grid file %s", filename);
+	for (const Frame &fr : frames) {
+		fprintf(f,
+		        "%d %d %d %d %d %d",
+		        fr.width,
+		        fr.height,
+		        fr.robot.x,
+		        fr.robot.y,
+		        fr.target.x,
+		        fr.target.y);
+		for (int c : fr.costs)
+			fprintf(f, " %d", c);
+		fprintf(f, "\n");
+	}
+	fclose(f);
+}
+
+// cost of a path, -1 if it is not a valid path from robot to target
+static long int
+path_cost(const Frame &f, const std::vector<point_t> &path)
+{
+	if (path.empty() || path.front().x != f.robot.x || path.front().y != f.robot.y
+	    || path.back().x != f.target.x || path.back().y != f.target.y)
+		return -1;
+	long int cost = 0;
+	for (size_t i = 1; i < path.size(); ++i) {
+		if (abs(path[i].x - path[i - 1].x) + abs(path[i].y - path[i - 1].y) != 1)
+			return -1;
+		int c = f.costs[path[i].x * f.height + path[i].y];
+		if (c == (int)costs.occ)
+			return -1;
+		cost += c;
+	}
+	return cost;
+}
+
+static void
+print_usage(const char *progname)
+{
+	printf("Usage: %s [-r gridfile] [-w gridfile] [-n frames]\n", progname);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char * read_file  = NULL;
+	const char * write_file = NULL;
+	unsigned int num_frames = 400;
+
+	int c;
+	while ((c = getopt(argc, argv, "hr:w:n:")) != -1) {
+		switch (c) {
+		case 'r': read_file = optarg; break;
+		case 'w': write_file = optarg; break;
+		case 'n': num_frames = atoi(optarg); break;
+		default: print_usage(argv[0]); return c == 'h' ? 0 : 1;
+		}
+	}
+
+	bool ok = true;
+	try {
+		std::vector<Frame> frames = read_file ? read_frames(read_file) : synth_frames(num_frames);
+		if (write_file)
+			write_frames(write_file, frames);
+		if (frames.empty())
+			throw Exception("No grids to replay");
+		printf("Replaying %zu grids\n", frames.size());
+
+		ConsoleLogger       logger(Logger::LL_WARN);
+		MemoryConfiguration config;
+		config.set_int("/plugins/colli/search/a_star/max_states", 15000);
+
+		OccupancyGrid grid(frames[0].width, frames[0].height);
+		AStarColli    incremental(&grid, costs, &logger, &config);
+
+		std::vector<double> incr_msec, full_msec;
+		unsigned int        num_no_path = 0;
+		for (size_t i = 0; i < frames.size(); ++i) {
+			const Frame &f = frames[i];
+			if (grid.get_width() != f.width)
+				grid.set_width(f.width);
+			if (grid.get_height() != f.height)
+				grid.set_height(f.height);
+			for (int x = 0; x < f.width; ++x) {
+				for (int y = 0; y < f.height; ++y) {
+					grid.occupancy_probs_[x][y] = f.costs[x * f.height + y];
+				}
+			}
+
+			std::vector<point_t> incr_path, full_path;
+			long int             start = qa::now_nsec();
+			incremental.solve(f.robot, f.target, incr_path);
+			incr_msec.push_back((qa::now_nsec() - start) / 1000000.);
+
+			AStarColli full(&grid, costs, &logger, &config);
+			start = qa::now_nsec();
+			full.solve(f.robot, f.target, full_path);
+			full_msec.push_back((qa::now_nsec() - start) / 1000000.);
+
+			long int incr_cost = path_cost(f, incr_path), full_cost = path_cost(f, full_path);
+			if (full_path.empty()) {
+				++num_no_path;
+				ok &= qa::check(incr_path.empty(), "grid %zu has a path only when replanning", i);
+			} else {
+				ok &= qa::check(incr_cost >= 0 && full_cost >= 0, "grid %zu has an invalid path", i)
+				      && qa::check(incr_cost == full_cost,
+				                   "grid %zu path cost %ld, expected %ld",
+				                   i,
+				                   incr_cost,
+				                   full_cost);
+			}
+		}
+
+		for (int m = 0; m <= 1; ++m) {
+			std::vector<double> &msec = m == 0 ? full_msec : incr_msec;
+			double               sum  = 0.;
+			for (double t : msec)
+				sum += t;
+			std::sort(msec.begin(), msec.end());
+			printf("%-12s avg %7.3f msec, median %7.3f msec, 95%% %7.3f msec, max %7.3f msec\n",
+			       m == 0 ? "from scratch" : "incremental",
+			       sum / msec.size(),
+			       msec[msec.size() / 2],
+			       msec[msec.size() * 95 / 100],
+			       msec.back());
+		}
+		if (num_no_path > 0)
+			printf("%u grids without path to the target\n", num_no_path);
+	} catch (Exception &e) {
+		e.print_trace();
+		ok = false;
+	}
+
+	return qa::result(ok);
+}
+
+/// @endcond
@@ -0,0 +1,231 @@
+
+/***************************************************************************
+ *  qa_colli_obstacle_stamps.cpp - QA for incremental obstacle stamps
+ *
+ *  Created: Sat Oct 17 12:26:40 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../search/obstacle_map.h"
+#include "../search/obstacle_stamps.h"
+#include "../utils/occupancygrid/occupancygrid.h"
+
+#include <utils/qa/qa_check.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+using namespace fawkes;
+
+/* Replays a sequence of obstacles as the laser occupancy grid stamps them
+ * into colli's grid, a room with walls and people walking around a robot
+ * that stands still, drives, changes the cell size, the obstacle mask
+ * and the grid size. After every cycle the incrementally updated grid is
+ * compared cell for cell against a grid computed from scratch, i.e. all
+ * cells free and every obstacle painted with the maximum cost. Readings
+ * drop out at random, the seed can be given with -s.
+ */
+
+static colli_cell_cost_t costs = {1000, 4, 3, 2, 1};
+
+struct Obstacle
+{
+	int                     x, y;
+	const std::vector<int> *mask;
+};
+
+// what the robot sees in a cycle, positions are in m
+struct Cycle
+{
+	int    grid_size;   // grid width and height in cells
+	int    cell_size;   // cell width and height in cm
+	double robot_x;     // robot position in the room
+	double robot_y;     //
+	float  inc;         // obstacle increasement in m
+	bool   rectangle;   // rectangular instead of elliptic obstacles
+	bool   mixed;       // every other obstacle with the previous mask
+	bool   no_readings; // e.g. the transform was not available
+};
+
+static Cycle
+script(unsigned int i)
+{
+	Cycle c;
+	c.grid_size   = 150;
+	c.cell_size   = 5;
+	c.robot_x     = 0.;
+	c.robot_y     = 0.;
+	c.inc         = 0.f;
+	c.rectangle   = false;
+	c.mixed       = false;
+	c.no_readings = false;
+
+	if (i >= 60 && i < 120) {
+		// driving, positions shift by a few cells
+		c.robot_x = (i - 60) * 0.04;
+		c.robot_y = (i - 60) * 0.01;
+	} else if (i >= 120 && i < 160) {
+		c.cell_size = (i < 140) ? 10 : 7;
+	} else if (i >= 160 && i < 200) {
+		// speed dependent increasement, the mask changes now and then
+		c.inc   = 0.05f * ((i / 4) % 4);
+		c.mixed = (i % 7 == 0);
+	} else if (i >= 200 && i < 230) {
+		c.rectangle = true;
+		c.inc       = (i < 215) ? 0.f : 0.1f;
+	} else if (i >= 230 && i < 260) {
+		c.grid_size = (i < 245) ? 100 : 120;
+	} else if (i == 260 || i == 261 || i == 270) {
+		c.no_readings = true;
+	}
+	return c;
+}
+
+// walls of a 6m x 5m room, a pillar and people walking, positions in m
+static std::vector<std::pair<double, double>>
+readings(unsigned int i, unsigned int *seed)
+{
+	std::vector<std::pair<double, double>> r;
+	for (double x = -3.; x <= 3.; x += 0.05) {
+		r.push_back(std::make_pair(x, -2.5));
+		r.push_back(std::make_pair(x, 2.5));
+	}
+	for (double y = -2.5; y <= 2.5; y += 0.05) {
+		r.push_back(std::make_pair(-3., y));
+		r.push_back(std::make_pair(3., y));
+	}
+	r.push_back(std::make_pair(1.2, 0.8));
+	for (unsigned int p = 0; p < 4; ++p) {
+		double phase = i * 0.05 + p * 1.7;
+		r.push_back(std::make_pair(-2. + p + 0.6 * sin(phase), 1.8 * sin(phase * 0.7)));
+	}
+
+	// drop a few readings at random
+	std::vector<std::pair<double, double>> kept;
+	for (const std::pair<double, double> &p : r) {
+		if (rand_r(seed) % 20 != 0)
+			kept.push_back(p);
+	}
+	return kept;
+}
+
+static void
+paint(OccupancyGrid &grid, const Obstacle &o)
+{
+	const std::vector<int> &mask = *o.mask;
+	for (unsigned int i = 0; i < mask.size(); i += 3) {
+		int x = o.x + mask[i];
+		int y = o.y + mask[i + 1];
+		if (x > 0 && x < grid.get_height() && y > 0 && y < grid.get_width()
+		    && grid.occupancy_probs_[x][y] < mask[i + 2]) {
+			grid.occupancy_probs_[x][y] = mask[i + 2];
+		}
+	}
+}
+
+static void
+print_usage(const char *progname)
+{
+	printf("Usage: %s [-s seed]\n", progname);
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int seed = 42;
+
+	int c;
+	while ((c = getopt(argc, argv, "hs:")) != -1) {
+		switch (c) {
+		case 's': seed = atoi(optarg); break;
+		default: print_usage(argv[0]); return (c == 'h') ? 0 : 1;
+		}
+	}
+
+	ColliObstacleMap    ellipses(costs, false);
+	ColliObstacleMap    rectangles(costs, true);
+	OccupancyGrid       grid(150, 150);
+	OccupancyGrid       expected(150, 150);
+	ColliObstacleStamps stamps(&grid, costs.free);
+
+	const std::vector<int> *prev_mask = NULL;
+	std::vector<Obstacle>   obstacles;
+
+	bool ok = true;
+	for (unsigned int i = 0; i < 300 && ok; ++i) {
+		Cycle cycle = script(i);
+
+		if (grid.get_width() != cycle.grid_size) {
+			grid.set_width(cycle.grid_size);
+			grid.set_height(cycle.grid_size);
+			expected.set_width(cycle.grid_size);
+			expected.set_height(cycle.grid_size);
+		}
+		grid.set_cell_width(cycle.cell_size);
+		grid.set_cell_height(cycle.cell_size);
+
+		// mask for a 40cm x 38cm robot, as LaserOccupancyGrid selects it
+		float width  = std::max(4.f, ((0.4f + cycle.inc) * 100.f) / cycle.cell_size);
+		float height = std::max(4.f, ((0.38f + cycle.inc) * 100.f) / cycle.cell_size);
+
+		ColliObstacleMap &      map  = cycle.rectangle ? rectangles : ellipses;
+		const std::vector<int> &mask = map.get_obstacle(width, height, true);
+
+		obstacles.clear();
+		std::vector<std::pair<double, double>> r = readings(i, &seed);
+		if (!cycle.no_readings) {
+			int mid = cycle.grid_size / 2;
+			for (size_t p = 0; p < r.size(); ++p) {
+				Obstacle o;
+				o.x    = mid + (int)((r[p].first - cycle.robot_x) * 100. / cycle.cell_size);
+				o.y    = mid + (int)((r[p].second - cycle.robot_y) * 100. / cycle.cell_size);
+				o.mask = (cycle.mixed && prev_mask && p % 2) ? prev_mask : &mask;
+				stamps.set_mask(*o.mask);
+				stamps.add(o.x, o.y);
+				obstacles.push_back(o);
+			}
+		}
+		stamps.update();
+		prev_mask = &mask;
+
+		expected.fill(costs.free);
+		for (const Obstacle &o : obstacles)
+			paint(expected, o);
+
+		for (int x = 0; x < cycle.grid_size && ok; ++x) {
+			for (int y = 0; y < cycle.grid_size && ok; ++y) {
+				ok &= qa::check(grid.occupancy_probs_[x][y] == expected.occupancy_probs_[x][y],
+				                "cycle %u: cell (%d, %d) is %.0f, expected %.0f",
+				                i,
+				                x,
+				                y,
+				                grid.occupancy_probs_[x][y],
+				                expected.occupancy_probs_[x][y]);
+			}
+		}
+	}
+
+	return qa::result(ok);
+}
+
+/// @endcond
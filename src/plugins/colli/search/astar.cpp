@@ -22,20 +22,36 @@
 
 #include "astar.h"
 
-#include "../search/og_laser.h"
+#include "../utils/occupancygrid/occupancygrid.h"
 
 #include <config/config.h>
 #include <logging/logger.h>
 #include <utils/math/types.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
 using namespace std;
 
 namespace fawkes {
 
-/** @class AStar <plugins/colli/search/astar.h>
+/// @cond INTERNALS
+// cost of unreachable cells, small enough to add heuristic and key modifier
+static const int ASTAR_INF = INT_MAX / 4;
+/// @endcond
+
+/** @class AStarColli <plugins/colli/search/astar.h>
  * This is a high efficient implementation. Therefore this code
  * does not always look very nice here. So be patient and try to
  * understand what I was trying to implement here.
+ *
+ * The path is searched with D* Lite. The search is rooted at the robot
+ * and kept between calls to solve(). Only cells whose cost changed since
+ * the previous call and cells affected by a moved target are expanded
+ * again, so small changes to the grid only require short replans. If the
+ * robot cell changes, the grid is resized, or too many cells changed, the
+ * search starts from scratch.
  */
 
 /** Constructor.
@@ -45,11 +61,15 @@ namespace fawkes {
  *  After that several states are initialized. This is done for speed purposes
  *   again, cause only here new is called in this code..
  *  Afterwards the Openlist, closedlist and states for A* are initialized.
- * @param occGrid is a pointer to an LaserOccupancyGrid to search through.
+ * @param occGrid is a pointer to an OccupancyGrid to search through.
+ * @param cell_costs costs of the cells in the grid
  * @param logger The fawkes logger
  * @param config The fawkes configuration
  */
-AStarColli::AStarColli(LaserOccupancyGrid *occGrid, Logger *logger, Configuration *config)
+AStarColli::AStarColli(OccupancyGrid *          occGrid,
+                       const colli_cell_cost_t &cell_costs,
+                       Logger *                 logger,
+                       Configuration *          config)
 : logger_(logger)
 {
 	logger_->log_debug("AStar", "(Constructor): Initializing AStar");
@@ -60,10 +80,10 @@ AStarColli::AStarColli(LaserOccupancyGrid *occGrid, Logger *logger, Configuratio
 	width_    = occ_grid_->get_width() - 1;
 	height_   = occ_grid_->get_height() - 1;
 
-	cell_costs_ = occ_grid_->get_cell_costs();
+	cell_costs_ = cell_costs;
 
 	astar_state_count_ = 0;
-	astar_states_.reserve(max_states_);
+	astar_states_.resize(max_states_);
 
 	for (int i = 0; i < max_states_; i++) {
 		AStarState *state = new AStarState();
@@ -73,7 +93,12 @@ AStarColli::AStarColli(LaserOccupancyGrid *occGrid, Logger *logger, Configuratio
 	while (open_list_.size() > 0)
 		open_list_.pop();
 
-	closed_list_.clear();
+	closed_generation_ = 0;
+
+	num_cells_ = 0;
+	root_      = -1;
+	query_     = -1;
+	km_        = 0;
 
 	logger_->log_debug("AStar", "(Constructor): Initializing AStar done");
 }
@@ -91,9 +116,9 @@ AStarColli::~AStarColli()
 
 /** solve.
  *  solve is the externally called method to solve the assignment by A*.
- *  It generates an initial state, and sets its values accordingly.
- *  This state is put on the openlist, and then  the search is called, after which
- *  the solution sequence is generated by the pointers in all states.
+ *  It updates the costs of changed cells, moves the target of the search
+ *  and continues the search until the path to the target is known, after
+ *  which the solution sequence is generated from the path costs.
  * @param robo_pos The position of the robot in the grid
  * @param target_pos The position of the target in the grid
  * @param solution a vector that will be filled with the found path
@@ -101,221 +126,315 @@ AStarColli::~AStarColli()
 void
 AStarColli::solve(const point_t &robo_pos, const point_t &target_pos, vector<point_t> &solution)
 {
-	// initialize counter, vectors/lists/queues
-	astar_state_count_ = 0;
-	while (open_list_.size() > 0)
-		open_list_.pop();
-	closed_list_.clear();
 	solution.clear();
 
-	// setting start coordinates
-	robo_pos_.x_     = robo_pos.x;
-	robo_pos_.y_     = robo_pos.y;
-	target_state_.x_ = target_pos.x;
-	target_state_.y_ = target_pos.y;
+	bool resized = update_cell_costs();
 
-	// generating initialstate
-	AStarState *initial_state  = astar_states_[++astar_state_count_];
-	initial_state->x_          = robo_pos_.x_;
-	initial_state->y_          = robo_pos_.y_;
-	initial_state->father_     = 0;
-	initial_state->past_cost_  = 0;
-	initial_state->total_cost_ = heuristic(initial_state);
+	if ((robo_pos.x < 0) || (robo_pos.x > (int)width_) || (robo_pos.y < 0)
+	    || (robo_pos.y > (int)height_) || (target_pos.x < 0) || (target_pos.x > (int)width_)
+	    || (target_pos.y < 0) || (target_pos.y > (int)height_)) {
+		return;
+	}
 
-	// performing search
-	open_list_.push(initial_state);
-	get_solution_sequence(search(), solution);
+	int root   = robo_pos.x * (height_ + 1) + robo_pos.y;
+	int target = target_pos.x * (height_ + 1) + target_pos.y;
+
+	if (resized || (root != root_) || ((int)changed_.size() > num_cells_ / 8)
+	    || (km_ > ASTAR_INF - (int)(width_ + height_ + 2))) {
+		query_ = target;
+		reset_search(root);
+	} else {
+		// the key modifier keeps the open list valid for the moved target
+		if (target != query_) {
+			int q = query_;
+			query_ = target;
+			km_ += heuristic(q);
+		}
+		for (unsigned int i = 0; i < changed_.size(); ++i)
+			update_vertex(changed_[i]);
+	}
+
+	compute_shortest_path();
+	get_solution_sequence(solution);
 }
 
 /* =========================================== */
 /* *************** PRIVATE PART ************** */
 /* =========================================== */
 
-/** search.
- *  This is the magic A* algorithm.
- *  Its really easy, you can find it like this everywhere.
+/** update_cell_costs.
+ *  Reads the cost of all cells from the grid and remembers the cells
+ *    whose cost changed since the last call.
+ *  Returns true, if the grid has been resized and the search must be reset.
  */
-AStarState *
-AStarColli::search()
+bool
+AStarColli::update_cell_costs()
 {
-	AStarState *best = 0;
-
-	// while the openlist not is empty
-	while (open_list_.size() > 0) {
-		// get best state
-		if (open_list_.size() > 0) {
-			best = open_list_.top();
-			open_list_.pop();
-		} else
-			return 0;
-
-		// check if its a goal.
-		if (is_goal(best))
-			return best;
-		else if (astar_state_count_ > max_states_ - 6) {
-			logger_->log_warn("AStar", "**** Warning: Out of states! Increasing A* MaxStates!");
-
-			for (int i = 0; i < max_states_; i++)
-				delete astar_states_[i];
-
-			max_states_ += (int)(max_states_ / 3.0);
-
-			astar_states_.clear();
-			astar_states_.resize(max_states_);
-			for (int i = 0; i < max_states_; i++) {
-				best             = new AStarState();
-				astar_states_[i] = best;
+	width_    = occ_grid_->get_width() - 1;
+	height_   = occ_grid_->get_height() - 1;
+	int cells = (width_ + 1) * (height_ + 1);
+
+	bool resized = (cells != num_cells_);
+	if (resized) {
+		num_cells_ = cells;
+		cell_cost_.assign(num_cells_, -1);
+		g_.resize(num_cells_);
+		rhs_.resize(num_cells_);
+		key1_.resize(num_cells_);
+		key2_.resize(num_cells_);
+		heap_index_.resize(num_cells_);
+		heap_.reserve(num_cells_);
+		changed_.reserve(num_cells_);
+	}
+
+	changed_.clear();
+	for (unsigned int x = 0; x <= width_; ++x) {
+		const vector<Probability> &column = occ_grid_->occupancy_probs_[x];
+		int *                      costs  = &cell_cost_[x * (height_ + 1)];
+		for (unsigned int y = 0; y <= height_; ++y) {
+			int cost = (column[y] == cell_costs_.occ) ? -1 : (int)column[y];
+			if (cost != costs[y]) {
+				costs[y] = cost;
+				changed_.push_back(x * (height_ + 1) + y);
 			}
-			logger_->log_warn("AStar", "**** Increasing done!");
-			return 0;
 		}
-
-		// generate all its children
-		generate_children(best);
 	}
 
-	return 0;
+	return resized;
 }
 
-/** calculate_key.
- *  This method produces one unique key for a state for
- *    putting this on the closed list.
- *    It has to be really fast, so the function is not so readable.
- *    What it does is the following: x * 2^14 + y. This is unique,
- *    because first it does a bit shift for 14 bits, and adds (or)
- *    afterwards a number that is smaller tham 14 bits!
+/** reset_search.
+ *  This method forgets about all previous searches and starts a new
+ *    search at the given robot cell.
  */
-int
-AStarColli::calculate_key(int x, int y)
+void
+AStarColli::reset_search(int root)
 {
-	return (x << 15) | y; // This line is a crime! But fast ;-)
+	std::fill(g_.begin(), g_.end(), ASTAR_INF);
+	std::fill(rhs_.begin(), rhs_.end(), ASTAR_INF);
+	std::fill(heap_index_.begin(), heap_index_.end(), -1);
+	heap_.clear();
+
+	root_       = root;
+	km_         = 0;
+	rhs_[root_] = 0;
+	heap_insert(root_, heuristic(root_), 0);
 }
 
-/** generate_children.
- *  This method generates all children for a given state.
- *   This is done with a little range checking and rule checking.
- *   Afterwards these children are put on the openlist.
+/** compute_shortest_path.
+ *  This is the magic D* Lite algorithm. Cells are expanded in the order
+ *    of their keys until the target is locally consistent and no cell on
+ *    the open list can lead to a cheaper path.
  */
 void
-AStarColli::generate_children(AStarState *father)
+AStarColli::compute_shortest_path()
 {
-	AStarState *child;
-	int         key;
-
-	float prob;
-
-	if (father->y_ > 0) {
-		prob = occ_grid_->get_prob(father->x_, father->y_ - 1);
-		if (prob != cell_costs_.occ) {
-			child     = astar_states_[++astar_state_count_];
-			child->x_ = father->x_;
-			child->y_ = father->y_ - 1;
-			key       = calculate_key(child->x_, child->y_);
-			if (closed_list_.find(key) == closed_list_.end()) {
-				child->father_     = father;
-				child->past_cost_  = father->past_cost_ + (int)prob;
-				child->total_cost_ = child->past_cost_ + heuristic(child);
-				open_list_.push(child);
-				closed_list_[key] = key;
-
-			} else
-				--astar_state_count_;
+	int H = height_ + 1;
+
+	while (!heap_.empty()) {
+		int u  = heap_[0];
+		int mq = min(g_[query_], rhs_[query_]);
+		if (!key_less(key1_[u], key2_[u], mq + km_, mq) && (rhs_[query_] == g_[query_]))
+			break;
+
+		int m     = min(g_[u], rhs_[u]);
+		int k1new = m + heuristic(u) + km_;
+		if (key_less(key1_[u], key2_[u], k1new, m)) {
+			// the target moved since u was put on the open list
+			heap_remove(u);
+			heap_insert(u, k1new, m);
+			continue;
 		}
-	}
 
-	if (father->y_ < (signed int)height_) {
-		prob = occ_grid_->get_prob(father->x_, father->y_ + 1);
-		if (prob != cell_costs_.occ) {
-			child     = astar_states_[++astar_state_count_];
-			child->x_ = father->x_;
-			child->y_ = father->y_ + 1;
-			key       = calculate_key(child->x_, child->y_);
-			if (closed_list_.find(key) == closed_list_.end()) {
-				child->father_     = father;
-				child->past_cost_  = father->past_cost_ + (int)prob;
-				child->total_cost_ = child->past_cost_ + heuristic(child);
-				open_list_.push(child);
-				closed_list_[key] = key;
-
-			} else
-				--astar_state_count_;
+		heap_remove(u);
+		if (g_[u] > rhs_[u]) {
+			g_[u] = rhs_[u];
+		} else {
+			g_[u] = ASTAR_INF;
+			update_vertex(u);
 		}
+
+		int y = u % H;
+		if (y > 0)
+			update_vertex(u - 1);
+		if (y < (int)height_)
+			update_vertex(u + 1);
+		if (u >= H)
+			update_vertex(u - H);
+		if (u < num_cells_ - H)
+			update_vertex(u + H);
 	}
+}
 
-	if (father->x_ > 0) {
-		prob = occ_grid_->get_prob(father->x_ - 1, father->y_);
-		if (prob != cell_costs_.occ) {
-			child     = astar_states_[++astar_state_count_];
-			child->x_ = father->x_ - 1;
-			child->y_ = father->y_;
-			key       = calculate_key(child->x_, child->y_);
-			if (closed_list_.find(key) == closed_list_.end()) {
-				child->father_     = father;
-				child->past_cost_  = father->past_cost_ + (int)prob;
-				child->total_cost_ = child->past_cost_ + heuristic(child);
-				open_list_.push(child);
-				closed_list_[key] = key;
-
-			} else
-				--astar_state_count_;
+/** update_vertex.
+ *  This method recomputes the best path cost of a cell from its
+ *    neighbours and puts it on the openlist if it is inconsistent.
+ *    The cost of a path to a cell is the sum of the costs of all
+ *    cells entered on the way, the robot cell is free.
+ */
+void
+AStarColli::update_vertex(int cell)
+{
+	if (cell != root_) {
+		int best = ASTAR_INF;
+		if (cell_cost_[cell] >= 0) {
+			int H = height_ + 1;
+			int y = cell % H;
+			if ((y > 0) && (g_[cell - 1] < best))
+				best = g_[cell - 1];
+			if ((y < (int)height_) && (g_[cell + 1] < best))
+				best = g_[cell + 1];
+			if ((cell >= H) && (g_[cell - H] < best))
+				best = g_[cell - H];
+			if ((cell < num_cells_ - H) && (g_[cell + H] < best))
+				best = g_[cell + H];
+			if (best < ASTAR_INF)
+				best += cell_cost_[cell];
 		}
+		rhs_[cell] = best;
 	}
 
-	if (father->x_ < (signed int)width_) {
-		prob = occ_grid_->get_prob(father->x_ + 1, father->y_);
-		if (prob != cell_costs_.occ) {
-			child     = astar_states_[++astar_state_count_];
-			child->x_ = father->x_ + 1;
-			child->y_ = father->y_;
-			key       = calculate_key(child->x_, child->y_);
-			if (closed_list_.find(key) == closed_list_.end()) {
-				child->father_     = father;
-				child->past_cost_  = father->past_cost_ + (int)prob;
-				child->total_cost_ = child->past_cost_ + heuristic(child);
-				open_list_.push(child);
-				closed_list_[key] = key;
-
-			} else
-				--astar_state_count_;
-		}
+	if (heap_index_[cell] >= 0)
+		heap_remove(cell);
+	if (g_[cell] != rhs_[cell]) {
+		int m = min(g_[cell], rhs_[cell]);
+		heap_insert(cell, m + heuristic(cell) + km_, m);
 	}
 }
 
 /** heuristic.
  *  This method calculates the heuristic value for a given
- *    state. This is done by the manhatten distance here,
+ *    cell. This is done by the manhatten distance to the target here,
  *    because we are calculating on a grid...
  */
 int
-AStarColli::heuristic(AStarState *state)
+AStarColli::heuristic(int cell) const
 {
-	//  return (int)( abs( state->x_ - target_state_.x_ ));
-	return (int)(abs(state->x_ - target_state_.x_) + abs(state->y_ - target_state_.y_));
+	int H = height_ + 1;
+	return abs(cell / H - query_ / H) + abs(cell % H - query_ % H);
 }
 
-/** is_goal.
- *  This method checks, if a state is a goal state.
+/** key_less.
+ *  Lexicographical comparison of two open list keys.
  */
 bool
-AStarColli::is_goal(AStarState *state)
+AStarColli::key_less(int k1a, int k2a, int k1b, int k2b) const
+{
+	return (k1a < k1b) || ((k1a == k1b) && (k2a < k2b));
+}
+
+/** heap_insert.
+ *  Put a cell on the openlist with the given key.
+ */
+void
+AStarColli::heap_insert(int cell, int k1, int k2)
+{
+	key1_[cell]       = k1;
+	key2_[cell]       = k2;
+	heap_index_[cell] = heap_.size();
+	heap_.push_back(cell);
+	heap_up(heap_.size() - 1);
+}
+
+/** heap_remove.
+ *  Remove a cell from the openlist.
+ */
+void
+AStarColli::heap_remove(int cell)
+{
+	int pos           = heap_index_[cell];
+	int last          = heap_.back();
+	heap_index_[cell] = -1;
+	heap_.pop_back();
+	if (last != cell) {
+		heap_[pos]        = last;
+		heap_index_[last] = pos;
+		heap_up(pos);
+		heap_down(heap_index_[last]);
+	}
+}
+
+/** heap_up.
+ *  Move an openlist entry towards the top until the heap is restored.
+ */
+void
+AStarColli::heap_up(int pos)
+{
+	int cell = heap_[pos];
+	while (pos > 0) {
+		int parent = (pos - 1) / 2;
+		int p      = heap_[parent];
+		if (!key_less(key1_[cell], key2_[cell], key1_[p], key2_[p]))
+			break;
+		heap_[pos]     = p;
+		heap_index_[p] = pos;
+		pos            = parent;
+	}
+	heap_[pos]        = cell;
+	heap_index_[cell] = pos;
+}
+
+/** heap_down.
+ *  Move an openlist entry towards the bottom until the heap is restored.
+ */
+void
+AStarColli::heap_down(int pos)
 {
-	return ((target_state_.x_ == state->x_) && (target_state_.y_ == state->y_));
+	int cell = heap_[pos];
+	int size = heap_.size();
+	while (2 * pos + 1 < size) {
+		int child = 2 * pos + 1;
+		if ((child + 1 < size)
+		    && key_less(key1_[heap_[child + 1]],
+		                key2_[heap_[child + 1]],
+		                key1_[heap_[child]],
+		                key2_[heap_[child]]))
+			++child;
+		int c = heap_[child];
+		if (!key_less(key1_[c], key2_[c], key1_[cell], key2_[cell]))
+			break;
+		heap_[pos]     = c;
+		heap_index_[c] = pos;
+		pos            = child;
+	}
+	heap_[pos]        = cell;
+	heap_index_[cell] = pos;
 }
 
 /** get_solution_sequence.
- *  This one enqueues the way of a node back to its root through the
- *    tree into the solution/plan vector.
+ *  This one follows the cheapest neighbours from the target back to the
+ *    robot and enqueues the way into the solution/plan vector.
  */
 void
-AStarColli::get_solution_sequence(AStarState *node, vector<point_t> &solution)
+AStarColli::get_solution_sequence(vector<point_t> &solution)
 {
-	AStarState *state = node;
-	while (state != 0) {
-		solution.insert(solution.begin(), point_t(state->x_, state->y_));
-		state = state->father_;
+	if (g_[query_] >= ASTAR_INF)
+		return;
+
+	int H    = height_ + 1;
+	int cell = query_;
+	solution.push_back(point_t(cell / H, cell % H));
+	while ((cell != root_) && ((int)solution.size() <= num_cells_)) {
+		int y    = cell % H;
+		int next = -1;
+		int best = g_[cell];
+		if ((y > 0) && (g_[cell - 1] < best))
+			best = g_[next = cell - 1];
+		if ((y < (int)height_) && (g_[cell + 1] < best))
+			best = g_[next = cell + 1];
+		if ((cell >= H) && (g_[cell - H] < best))
+			best = g_[next = cell - H];
+		if ((cell < num_cells_ - H) && (g_[cell + H] < best))
+			best = g_[next = cell + H];
+		if (next < 0) {
+			logger_->log_warn("AStar", "Path to target is inconsistent, no solution");
+			solution.clear();
+			return;
+		}
+		cell = next;
+		solution.push_back(point_t(cell / H, cell % H));
 	}
-	//logger_->log_debug("AStar", "(get_solution_sequence): Solutionsize=%u  , Used states=%i",
-	//                   solution.size(), astar_state_count_);
+	std::reverse(solution.begin(), solution.end());
 }
 
 /* =========================================================================== */
@@ -337,7 +456,19 @@ AStarColli::remove_target_from_obstacle(int target_x, int target_y, int step_x,
 	while (open_list_.size() > 0)
 		open_list_.pop();
 
-	closed_list_.clear();
+	width_  = occ_grid_->get_width() - 1;
+	height_ = occ_grid_->get_height() - 1;
+	closed_list_.resize((width_ + 1) * (height_ + 1), 0);
+	if (++closed_generation_ == 0) {
+		std::fill(closed_list_.begin(), closed_list_.end(), 0);
+		closed_generation_ = 1;
+	}
+	if ((target_x < 0) || (target_x > (int)width_) || (target_y < 0)
+	    || (target_y > (int)height_)) {
+		logger_->log_debug("AStar", "Target point outside of the grid");
+		return point_t(target_x, target_y);
+	}
+
 	astar_state_count_ = 0;
 	// starting fill algorithm by putting first state in openlist
 	AStarState *initial_state  = astar_states_[++astar_state_count_];
@@ -352,10 +483,10 @@ AStarColli::remove_target_from_obstacle(int target_x, int target_y, int step_x,
 	while (!(open_list_.empty()) && (astar_state_count_ < max_states_ - 6)) {
 		father = open_list_.top();
 		open_list_.pop();
-		int key = calculate_key(father->x_, father->y_);
+		int key = father->x_ * (height_ + 1) + father->y_;
 
-		if (closed_list_.find(key) == closed_list_.end()) {
-			closed_list_[key] = key;
+		if (closed_list_[key] != closed_generation_) {
+			closed_list_[key] = closed_generation_;
 			// generiere zwei kinder. wenn besetzt, pack sie an das ende
 			//   der openlist mit kosten + 1, sonst return den Knoten
 			if ((father->x_ > 1) && (father->x_ < (signed)width_ - 2)) {
@@ -363,10 +494,10 @@ AStarColli::remove_target_from_obstacle(int target_x, int target_y, int step_x,
 				child->x_          = father->x_ + step_x;
 				child->y_          = father->y_;
 				child->total_cost_ = father->total_cost_ + 1;
-				key                = calculate_key(child->x_, child->y_);
+				key                = child->x_ * (height_ + 1) + child->y_;
 				if (occ_grid_->get_prob(child->x_, child->y_) == cell_costs_.near)
 					return point_t(child->x_, child->y_);
-				else if (closed_list_.find(key) == closed_list_.end())
+				else if (closed_list_[key] != closed_generation_)
 					open_list_.push(child);
 			}
 
@@ -375,10 +506,10 @@ AStarColli::remove_target_from_obstacle(int target_x, int target_y, int step_x,
 				child->x_          = father->x_;
 				child->y_          = father->y_ + step_y;
 				child->total_cost_ = father->total_cost_ + 1;
-				key                = calculate_key(child->x_, child->y_);
+				key                = child->x_ * (height_ + 1) + child->y_;
 				if (occ_grid_->get_prob(child->x_, child->y_) == cell_costs_.near)
 					return point_t(child->x_, child->y_);
-				else if (closed_list_.find(key) == closed_list_.end())
+				else if (closed_list_[key] != closed_generation_)
 					open_list_.push(child);
 			}
 		}
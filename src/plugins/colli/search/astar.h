@@ -26,13 +26,12 @@
 #include "../common/types.h"
 #include "astar_state.h"
 
-#include <map>
 #include <queue>
 #include <vector>
 
 namespace fawkes {
 
-class LaserOccupancyGrid;
+class OccupancyGrid;
 class Logger;
 class Configuration;
 
@@ -45,7 +44,10 @@ typedef struct point_struct point_t;
 class AStarColli
 {
 public:
-	AStarColli(LaserOccupancyGrid *occGrid, Logger *logger, Configuration *config);
+	AStarColli(OccupancyGrid *          occGrid,
+	           const colli_cell_cost_t &cell_costs,
+	           Logger *                 logger,
+	           Configuration *          config);
 	~AStarColli();
 
 	/* =========================================== */
@@ -54,7 +56,7 @@ public:
 	/** solves the given assignment.
    *  This starts the search for a path through the occupance grid to the
    *    target point.
-   *  Performing astar search over the occupancy grid and returning the solution.
+   *  Performing an incremental search over the occupancy grid and returning the solution.
    */
 	void solve(const point_t &robo_pos, const point_t &target_pos, std::vector<point_t> &solution);
 
@@ -68,17 +70,13 @@ private:
 	fawkes::Logger *logger_;
 
 	// this is the local reference to the occupancy grid.
-	LaserOccupancyGrid *occ_grid_;
-	unsigned int        width_;
-	unsigned int        height_;
+	OccupancyGrid *occ_grid_;
+	unsigned int   width_;
+	unsigned int   height_;
 
 	// Costs for the cells in grid
 	colli_cell_cost_t cell_costs_;
 
-	// this is the local robot position and target point.
-	AStarState robo_pos_;
-	AStarState target_state_;
-
 	// This is a state vector...
 	// It is for speed purposes. So I do not have to do a new each time
 	//   I have to malloc a new one each time.
@@ -88,7 +86,7 @@ private:
 	int max_states_;
 	int astar_state_count_;
 
-	// this is AStars openlist
+	// this is the openlist for remove_target_from_obstacle
 	struct cmp
 	{
 		bool
@@ -100,30 +98,56 @@ private:
 
 	std::priority_queue<AStarState *, std::vector<AStarState *>, cmp> open_list_;
 
-	// this is AStars closedList
-	std::map<int, int> closed_list_;
+	// this is the closed list for remove_target_from_obstacle, a cell is
+	// closed if its entry equals closed_generation_
+	std::vector<unsigned int> closed_list_;
+	unsigned int              closed_generation_;
+
+	/* D* Lite search state. The search is rooted at the robot and
+	 * maintained across calls to solve(), all arrays are indexed by cell. */
+	int              num_cells_;   // number of cells the arrays have been sized for
+	int              root_;        // cell of the robot, root of the search
+	int              query_;       // cell of the target
+	int              km_;          // key modifier, accumulated target movement
+	std::vector<int> cell_cost_;   // cost to enter a cell, -1 if occupied
+	std::vector<int> g_;           // cost of the path from the robot
+	std::vector<int> rhs_;         // one-step lookahead of g_
+	std::vector<int> key1_;        // primary key while on the open list
+	std::vector<int> key2_;        // secondary key while on the open list
+	std::vector<int> heap_;        // open list, binary heap of cells
+	std::vector<int> heap_index_;  // position of a cell in heap_, -1 if not on the open list
+	std::vector<int> changed_;     // cells with changed costs, reused
 
 	/* =========================================== */
 	/* ************ PRIVATE METHODS ************** */
 	/* =========================================== */
 
-	// search with AStar through the OccGrid
-	AStarState *search();
+	// Reset the search to the given robot cell
+	void reset_search(int root);
+
+	// Read the cell costs from the grid, return true if the grid was resized
+	bool update_cell_costs();
+
+	// Expand cells until the path to the target is known
+	void compute_shortest_path();
 
-	// Calculate a unique key for a given coordinate
-	int calculate_key(int x, int y);
+	// Recompute rhs and the open list entry of a cell
+	void update_vertex(int cell);
 
-	// Check if the state is a goal
-	bool is_goal(AStarState *state);
+	// Heuristic from the target to a cell
+	int heuristic(int cell) const;
 
-	// Calculate heuristic for a given state
-	int heuristic(AStarState *state);
+	// Compare keys of open list entries
+	bool key_less(int k1a, int k2a, int k1b, int k2b) const;
 
-	// Generate all children for a given State
-	void generate_children(AStarState *father);
+	// Open list operations
+	void heap_insert(int cell, int k1, int k2);
+	void heap_remove(int cell);
+	void heap_up(int pos);
+	void heap_down(int pos);
 
-	// Generates a solution sequence for a given state
-	void get_solution_sequence(AStarState *node, std::vector<point_t> &solution);
+	// Generates a solution sequence from the robot to the target
+	void get_solution_sequence(std::vector<point_t> &solution);
 };
 
 } // namespace fawkes
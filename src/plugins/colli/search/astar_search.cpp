@@ -48,7 +48,7 @@ Search::Search(LaserOccupancyGrid *occ_grid, Logger *logger, Configuration *conf
 	logger_->log_debug("search", "(Constructor): Entering");
 	std::string cfg_prefix            = "/plugins/colli/search/";
 	cfg_search_line_allowed_cost_max_ = config->get_int((cfg_prefix + "line/cost_max").c_str());
-	astar_.reset(new AStarColli(occ_grid, logger, config));
+	astar_.reset(new AStarColli(occ_grid, occ_grid->get_cell_costs(), logger, config));
 	logger_->log_debug("search", "(Constructor): Exiting");
 }
 
@@ -46,8 +46,8 @@ public:
 	/** Return the occupied cells with their values
    * @return vector containing the occupied cells (alternating x and y coordinates)
    */
-	inline const std::vector<int>
-	get_obstacle()
+	inline const std::vector<int> &
+	get_obstacle() const
 	{
 		return occupied_cells_;
 	}
@@ -0,0 +1,220 @@
+
+/***************************************************************************
+ *  obstacle_stamps.cpp - Obstacles stamped into colli's occupancy grid
+ *
+ *  Created: Sat Oct 17 11:42:18 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "obstacle_stamps.h"
+
+#include "../utils/occupancygrid/occupancygrid.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iterator>
+
+namespace fawkes {
+
+/** @class ColliObstacleStamps <plugins/colli/search/obstacle_stamps.h>
+ * Obstacles stamped into an occupancy grid.
+ * The obstacles of a cycle are collected as stamps, i.e. a grid position
+ * and an obstacle mask from ColliObstacleMap. On update() only the cells
+ * of stamps that changed since the last cycle are updated, the grid is
+ * not cleared. Cells keep the maximum cost of all stamps covering them,
+ * all other cells are free.
+ */
+
+/** Constructor.
+ * @param grid occupancy grid to stamp the obstacles into
+ * @param free_cost cost of cells not covered by any obstacle
+ */
+ColliObstacleStamps::ColliObstacleStamps(OccupancyGrid *grid, unsigned int free_cost)
+: grid_(grid),
+  free_cost_(free_cost),
+  mask_(NULL),
+  mask_radius_(0),
+  next_radius_(0),
+  initialized_(false),
+  painted_width_(0),
+  painted_height_(0)
+{
+}
+
+/** Set the obstacle mask for the following stamps.
+ * All obstacles have the same shape within a cycle, the mask is
+ * therefore set once per cycle instead of with every stamp.
+ * @param mask obstacle cells, the reference must remain valid
+ * until the stamps have been removed again
+ */
+void
+ColliObstacleStamps::set_mask(const std::vector<int> &mask)
+{
+	if (&mask != mask_) {
+		mask_        = &mask;
+		mask_radius_ = 0;
+		for (unsigned int i = 0; i < mask.size(); i += 3) {
+			mask_radius_ = std::max(mask_radius_, abs(mask[i]));
+			mask_radius_ = std::max(mask_radius_, abs(mask[i + 1]));
+		}
+	}
+}
+
+/** Add an obstacle for this cycle with the current mask.
+ * @param x x coordinate of obstacle center in grid
+ * @param y y coordinate of obstacle center in grid
+ */
+void
+ColliObstacleStamps::add(int x, int y)
+{
+	Stamp stamp;
+	stamp.x      = x;
+	stamp.y      = y;
+	stamp.radius = mask_radius_;
+	stamp.mask   = mask_;
+	next_stamps_.push_back(stamp);
+	next_radius_ = std::max(next_radius_, mask_radius_);
+}
+
+/** Paint an obstacle into the grid.
+ * Cells keep the maximum cost of all obstacles covering them.
+ * @param stamp obstacle to paint
+ */
+void
+ColliObstacleStamps::paint_stamp(const Stamp &stamp)
+{
+	const std::vector<int> &mask   = *stamp.mask;
+	const int               width  = grid_->get_width();
+	const int               height = grid_->get_height();
+
+	// i = x offset, i+1 = y offset, i+2 is cost
+	if (stamp.x - stamp.radius > 0 && stamp.x + stamp.radius < height && stamp.y - stamp.radius > 0
+	    && stamp.y + stamp.radius < width) {
+		for (unsigned int i = 0; i < mask.size(); i += 3) {
+			Probability &cell = grid_->occupancy_probs_[stamp.x + mask[i]][stamp.y + mask[i + 1]];
+			if (cell < mask[i + 2])
+				cell = mask[i + 2];
+		}
+	} else {
+		for (unsigned int i = 0; i < mask.size(); i += 3) {
+			int posX = stamp.x + mask[i];
+			int posY = stamp.y + mask[i + 1];
+			if ((posX > 0) && (posX < height) && (posY > 0) && (posY < width)
+			    && (grid_->occupancy_probs_[posX][posY] < mask[i + 2])) {
+				grid_->occupancy_probs_[posX][posY] = mask[i + 2];
+			}
+		}
+	}
+}
+
+/** Reset the cells of an obstacle to free.
+ * @param stamp obstacle to clear
+ */
+void
+ColliObstacleStamps::clear_stamp(const Stamp &stamp)
+{
+	const std::vector<int> &mask   = *stamp.mask;
+	const int               width  = grid_->get_width();
+	const int               height = grid_->get_height();
+	for (unsigned int i = 0; i < mask.size(); i += 3) {
+		int posX = stamp.x + mask[i];
+		int posY = stamp.y + mask[i + 1];
+		if ((posX > 0) && (posX < height) && (posY > 0) && (posY < width)) {
+			grid_->occupancy_probs_[posX][posY] = free_cost_;
+		}
+	}
+}
+
+/** Update the grid from the obstacles added in this cycle.
+ * Obstacles that are in the grid already are not touched. The cells of
+ * obstacles that vanished are set free, and obstacles that overlap them
+ * are painted again, as are the new obstacles. Therefore the cost does
+ * not depend on the size of the grid, but only on the number of changed
+ * obstacles and the size of the mask. If most obstacles changed, e.g.
+ * when the robot moved, all cells of the previous obstacles are cleared
+ * instead. The next cycle starts without any obstacles.
+ */
+void
+ColliObstacleStamps::update()
+{
+	std::sort(next_stamps_.begin(), next_stamps_.end());
+	next_stamps_.erase(std::unique(next_stamps_.begin(), next_stamps_.end()), next_stamps_.end());
+
+	const int width  = grid_->get_width();
+	const int height = grid_->get_height();
+
+	if (!initialized_ || painted_width_ != width || painted_height_ != height) {
+		// first cycle or the grid has been resized and reset
+		for (int y = 0; y < width; ++y)
+			for (int x = 0; x < height; ++x)
+				grid_->occupancy_probs_[x][y] = free_cost_;
+		for (const Stamp &s : next_stamps_)
+			paint_stamp(s);
+		initialized_    = true;
+		painted_width_  = width;
+		painted_height_ = height;
+	} else {
+		changed_stamps_.clear();
+		std::set_difference(stamps_.begin(),
+		                    stamps_.end(),
+		                    next_stamps_.begin(),
+		                    next_stamps_.end(),
+		                    std::back_inserter(changed_stamps_));
+
+		if (changed_stamps_.size() > next_stamps_.size() / 2) {
+			for (const Stamp &s : stamps_)
+				clear_stamp(s);
+			for (const Stamp &s : next_stamps_)
+				paint_stamp(s);
+		} else {
+			for (const Stamp &s : changed_stamps_)
+				clear_stamp(s);
+
+			// repaint remaining obstacles overlapping a cleared one,
+			// candidates are found by a binary search on the sorted y coordinate
+			for (const Stamp &r : changed_stamps_) {
+				Stamp probe;
+				probe.x    = INT_MIN;
+				probe.y    = r.y - r.radius - next_radius_;
+				probe.mask = NULL;
+				std::vector<Stamp>::const_iterator s =
+				  std::lower_bound(next_stamps_.begin(), next_stamps_.end(), probe);
+				for (; s != next_stamps_.end() && s->y - next_radius_ <= r.y + r.radius; ++s) {
+					if (abs(s->x - r.x) <= s->radius + r.radius && abs(s->y - r.y) <= s->radius + r.radius)
+						paint_stamp(*s);
+				}
+			}
+
+			// paint new obstacles
+			changed_stamps_.clear();
+			std::set_difference(next_stamps_.begin(),
+			                    next_stamps_.end(),
+			                    stamps_.begin(),
+			                    stamps_.end(),
+			                    std::back_inserter(changed_stamps_));
+			for (const Stamp &s : changed_stamps_)
+				paint_stamp(s);
+		}
+	}
+
+	stamps_.swap(next_stamps_);
+	next_stamps_.clear();
+	next_radius_ = 0;
+}
+
+} // namespace fawkes
@@ -0,0 +1,91 @@
+
+/***************************************************************************
+ *  obstacle_stamps.h - Obstacles stamped into colli's occupancy grid
+ *
+ *  Created: Sat Oct 17 11:42:18 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_COLLI_SEARCH_OBSTACLE_STAMPS_H_
+#define _PLUGINS_COLLI_SEARCH_OBSTACLE_STAMPS_H_
+
+#include <vector>
+
+namespace fawkes {
+
+class OccupancyGrid;
+
+class ColliObstacleStamps
+{
+public:
+	ColliObstacleStamps(OccupancyGrid *grid, unsigned int free_cost);
+
+	void set_mask(const std::vector<int> &mask);
+	void add(int x, int y);
+	void update();
+
+private:
+	/** Obstacle stamped into the grid. */
+	class Stamp
+	{
+	public:
+		int                     x;      /**< x coordinate of obstacle center in grid */
+		int                     y;      /**< y coordinate of obstacle center in grid */
+		int                     radius; /**< max extent of the mask from the center */
+		const std::vector<int> *mask;   /**< obstacle cells, see ColliFastObstacle */
+
+		/** Order stamps by position and mask.
+		 * @param o other stamp
+		 * @return true if this stamp is ordered before o
+		 */
+		bool
+		operator<(const Stamp &o) const
+		{
+			return (y != o.y) ? y < o.y : (x != o.x) ? x < o.x : mask < o.mask;
+		}
+		/** Check for equality.
+		 * @param o other stamp
+		 * @return true if both stamps paint the same cells
+		 */
+		bool
+		operator==(const Stamp &o) const
+		{
+			return x == o.x && y == o.y && mask == o.mask;
+		}
+	};
+
+	void paint_stamp(const Stamp &stamp);
+	void clear_stamp(const Stamp &stamp);
+
+	OccupancyGrid *grid_;
+	unsigned int   free_cost_;
+
+	const std::vector<int> *mask_;        /**< obstacle cells of this cycle */
+	int                     mask_radius_; /**< max extent of mask_ */
+	int                     next_radius_; /**< max extent of next_stamps_ */
+
+	std::vector<Stamp> stamps_;         /**< obstacles currently in the grid, sorted */
+	std::vector<Stamp> next_stamps_;    /**< obstacles collected in this cycle */
+	std::vector<Stamp> changed_stamps_; /**< removed or added obstacles, reused */
+	bool               initialized_;    /**< true once all cells have been set free */
+	int                painted_width_;  /**< grid width when stamps_ were painted */
+	int                painted_height_; /**< grid height when stamps_ were painted */
+};
+
+} // namespace fawkes
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "../utils/rob/roboshape_colli.h"
 #include "obstacle_map.h"
+#include "obstacle_stamps.h"
 
 #include <config/config.h>
 #include <interfaces/Laser360Interface.h>
@@ -33,6 +34,7 @@
 #include <utils/math/coord.h>
 #include <utils/time/clock.h>
 
+#include <algorithm>
 #include <cmath>
 
 namespace fawkes {
@@ -136,11 +138,13 @@ LaserOccupancyGrid::LaserOccupancyGrid(Laser360Interface *laser,
 
 	robo_shape_.reset(new RoboShapeColli((cfg_prefix + "roboshape/").c_str(), logger, config));
 	old_readings_.clear();
+	transformed_readings_.reserve(if_laser_->maxlenof_distances() * if_buffer_size_);
 	init_grid();
 
 	logger->log_debug("LaserOccupancyGrid", "Generating obstacle map");
 	bool obstacle_shape = robo_shape_->is_angular_robot() && !cfg_force_elipse_obstacle_;
 	obstacle_map_.reset(new ColliObstacleMap(cell_costs_, obstacle_shape));
+	obstacle_stamps_.reset(new ColliObstacleStamps(this, cell_costs_.free));
 	logger->log_debug("LaserOccupancyGrid", "Generating obstacle map done");
 
 	laser_pos_ = point_t(0, 0);
@@ -164,6 +168,7 @@ LaserOccupancyGrid::LaserOccupancyGrid(Laser360Interface *laser,
 LaserOccupancyGrid::~LaserOccupancyGrid()
 {
 	robo_shape_.reset();
+	obstacle_stamps_.reset();
 	obstacle_map_.reset();
 }
 
@@ -285,8 +290,6 @@ void
 LaserOccupancyGrid::validate_old_laser_points(cart_coord_2d_t pos_robot,
                                               cart_coord_2d_t pos_new_laser_point)
 {
-	std::vector<LaserPoint> old_readings_tmp;
-
 	// vectors from robot to new and old laser-points
 	cart_coord_2d_t v_new(pos_new_laser_point.x - pos_robot.x, pos_new_laser_point.y - pos_robot.y);
 	cart_coord_2d_t v_old;
@@ -300,6 +303,8 @@ LaserOccupancyGrid::validate_old_laser_points(cart_coord_2d_t pos_robot,
 
 	static const float deg_unit = M_PI / 180.f; // 1 degree
 
+	// compact the readings to keep in place, this is called for every new reading
+	size_t num_kept = 0;
 	for (std::vector<LaserPoint>::iterator it = old_readings_.begin(); it != old_readings_.end();
 	     ++it) {
 		v_old.x = (*it).coord.x - pos_robot.x;
@@ -312,7 +317,7 @@ LaserOccupancyGrid::validate_old_laser_points(cart_coord_2d_t pos_robot,
 		if (d_new <= d_old + obstacle_distance_) {
 			// in case both points belonged to the same laser-beam, p_old
 			// would be in shadow of p_new => keep p_old anyway
-			old_readings_tmp.push_back(*it);
+			old_readings_[num_kept++] = *it;
 			continue;
 		}
 
@@ -320,23 +325,18 @@ LaserOccupancyGrid::validate_old_laser_points(cart_coord_2d_t pos_robot,
 		angle = acos((v_old.x * v_new.x + v_old.y * v_new.y) / (d_new * d_old));
 		if (std::isnan(angle) || angle > deg_unit) {
 			// p_old is not the range of this laser-beam. Keep it.
-			old_readings_tmp.push_back(*it);
+			old_readings_[num_kept++] = *it;
 
 			/* No "else" here. It would mean that p_old is in the range of the
        * same laser beam. And we already know that
        * "d_new > d_old + obstacle_distance_" => this laser beam can see
        * through p_old => discard p_old. In other words, do not add to
-       * old_readings_tmp.
+       * the kept readings.
        */
 		}
 	}
 
-	old_readings_.clear();
-	old_readings_.reserve(old_readings_tmp.size());
-
-	for (unsigned int i = 0; i < old_readings_tmp.size(); ++i) {
-		old_readings_.push_back(old_readings_tmp[i]);
-	}
+	old_readings_.resize(num_kept);
 }
 
 float
@@ -389,10 +389,8 @@ LaserOccupancyGrid::update_occ_grid(int midX, int midY, float inc, float vx, flo
 	laser_pos_.x = midX;
 	laser_pos_.y = midY;
 
-	for (int y = 0; y < width_; ++y)
-		for (int x = 0; x < height_; ++x)
-			occupancy_probs_[x][y] = cell_costs_.free;
-
+	// The grid is not cleared here, the obstacles are collected as stamps
+	// and only the cells of stamps that changed are updated afterwards.
 	update_laser();
 
 	tf::StampedTransform transform;
@@ -405,11 +403,15 @@ LaserOccupancyGrid::update_occ_grid(int midX, int midY, float inc, float vx, flo
 		                   "Unable to transform %s to %s. Can't put obstacles into the grid",
 		                   reference_frame_.c_str(),
 		                   laser_frame_.c_str());
+		// leave an empty grid, as if all cells had been cleared
+		obstacle_stamps_->update();
 		return 0.;
 	}
 
+	select_obstacle_mask(inc);
 	integrate_old_readings(midX, midY, inc, vel, transform);
 	integrate_new_readings(midX, midY, inc, vel, transform);
+	obstacle_stamps_->update();
 
 	return next_obstacle;
 }
@@ -418,30 +420,28 @@ LaserOccupancyGrid::update_occ_grid(int midX, int midY, float inc, float vx, flo
  * Transforms all given points with the given transform
  * @param laserPoints vector of LaserPoint, that contains the points to transform
  * @param transform stamped transform, the transform to transform with
- * @return the transformed laserPoints
+ * @param transformed upon return contains the transformed laserPoints. The
+ * vector is only resized, pass the same vector on each call to avoid
+ * allocations.
  */
-std::vector<LaserOccupancyGrid::LaserPoint> *
-LaserOccupancyGrid::transform_laser_points(std::vector<LaserOccupancyGrid::LaserPoint> &laserPoints,
-                                           tf::StampedTransform &                       transform)
+void
+LaserOccupancyGrid::transform_laser_points(
+  const std::vector<LaserOccupancyGrid::LaserPoint> &laserPoints,
+  tf::StampedTransform &                             transform,
+  std::vector<LaserOccupancyGrid::LaserPoint> &      transformed)
 {
-	int                                          count_points = laserPoints.size();
-	std::vector<LaserOccupancyGrid::LaserPoint> *laserPointsTransformed =
-	  new std::vector<LaserOccupancyGrid::LaserPoint>();
-	laserPointsTransformed->reserve(count_points);
+	size_t count_points = laserPoints.size();
+	transformed.resize(count_points);
 
 	tf::Point p;
 
-	for (int i = 0; i < count_points; ++i) {
+	for (size_t i = 0; i < count_points; ++i) {
 		p.setValue(laserPoints[i].coord.x, laserPoints[i].coord.y, 0.);
 		p = transform * p;
 
-		LaserOccupancyGrid::LaserPoint point;
-		point.coord     = cart_coord_2d_struct(p.getX(), p.getY());
-		point.timestamp = laserPoints[i].timestamp;
-		laserPointsTransformed->push_back(point);
+		transformed[i].coord     = cart_coord_2d_struct(p.getX(), p.getY());
+		transformed[i].timestamp = laserPoints[i].timestamp;
 	}
-
-	return laserPointsTransformed;
 }
 
 /** Get the laser's position in the grid
@@ -480,21 +480,20 @@ LaserOccupancyGrid::integrate_old_readings(int                   midX,
                                            float                 vel,
                                            tf::StampedTransform &transform)
 {
-	std::vector<LaserOccupancyGrid::LaserPoint> old_readings;
-	old_readings.reserve(old_readings_.size());
-	std::vector<LaserOccupancyGrid::LaserPoint> *pointsTransformed =
-	  transform_laser_points(old_readings_, transform);
+	transform_laser_points(old_readings_, transform, transformed_readings_);
+	const std::vector<LaserOccupancyGrid::LaserPoint> &pointsTransformed = transformed_readings_;
 
-	float newpos_x, newpos_y;
+	float  newpos_x, newpos_y;
+	size_t num_kept = 0;
 
 	Clock *clock   = Clock::instance();
 	Time   history = Time(clock) - Time(double(std::max(min_history_length_, max_history_length_)));
 
 	// update all old readings
-	for (unsigned int i = 0; i < pointsTransformed->size(); ++i) {
-		if ((*pointsTransformed)[i].timestamp.in_sec() >= history.in_sec()) {
-			newpos_x = (*pointsTransformed)[i].coord.x;
-			newpos_y = (*pointsTransformed)[i].coord.y;
+	for (unsigned int i = 0; i < pointsTransformed.size(); ++i) {
+		if (pointsTransformed[i].timestamp.in_sec() >= history.in_sec()) {
+			newpos_x = pointsTransformed[i].coord.x;
+			newpos_y = pointsTransformed[i].coord.y;
 
 			//newpos_x =  old_readings_[i].coord.x + xref;
 			//newpos_y =  old_readings_[i].coord.y + yref;
@@ -519,28 +518,15 @@ LaserOccupancyGrid::integrate_old_readings(int                   midX,
 			int posX = midX + (int)((newpos_x * 100.f) / ((float)cell_height_));
 			int posY = midY + (int)((newpos_y * 100.f) / ((float)cell_width_));
 			if (posX > 4 && posX < height_ - 5 && posY > 4 && posY < width_ - 5) {
-				old_readings.push_back(old_readings_[i]);
-
-				// 25 cm's in my opinion, that are here: 0.25*100/cell_width_
-				//int size = (int)(((0.25f+inc)*100.f)/(float)cell_width_);
-				float width  = robo_shape_->get_complete_width_y();
-				width        = std::max(4.f, ((width + inc) * 100.f) / cell_width_);
-				float height = robo_shape_->get_complete_width_x();
-				height       = std::max(4.f, ((height + inc) * 100.f) / cell_height_);
-				integrate_obstacle(posX, posY, width, height);
+				// keep the reading, num_kept <= i, compacting in place is safe
+				old_readings_[num_kept++] = old_readings_[i];
+				integrate_obstacle(posX, posY);
 			}
 			//}
 		}
 	}
 
-	old_readings_.clear();
-	old_readings_.reserve(old_readings.size());
-
-	// integrate the new calculated old readings
-	for (unsigned int i = 0; i < old_readings.size(); i++)
-		old_readings_.push_back(old_readings[i]);
-
-	delete pointsTransformed;
+	old_readings_.resize(num_kept);
 }
 
 void
@@ -550,11 +536,10 @@ LaserOccupancyGrid::integrate_new_readings(int                   midX,
                                            float                 vel,
                                            tf::StampedTransform &transform)
 {
-	std::vector<LaserOccupancyGrid::LaserPoint> *pointsTransformed =
-	  transform_laser_points(new_readings_, transform);
+	transform_laser_points(new_readings_, transform, transformed_readings_);
+	const std::vector<LaserOccupancyGrid::LaserPoint> &pointsTransformed = transformed_readings_;
 
-	int numberOfReadings = pointsTransformed->size();
-	//TODO resize, reserve??
+	int numberOfReadings = pointsTransformed.size();
 
 	int             posX, posY;
 	cart_coord_2d_t point;
@@ -562,7 +547,7 @@ LaserOccupancyGrid::integrate_new_readings(int                   midX,
 	float           oldp_y = 1000.f;
 
 	for (int i = 0; i < numberOfReadings; i++) {
-		point = (*pointsTransformed)[i].coord;
+		point = pointsTransformed[i].coord;
 
 		if (sqrt(sqr(point.x) + sqr(point.y)) >= min_laser_length_
 		    && distance(point.x, point.y, oldp_x, oldp_y) >= obstacle_distance_) {
@@ -572,41 +557,41 @@ LaserOccupancyGrid::integrate_new_readings(int                   midX,
 			posY   = midY + (int)((point.y * 100.f) / ((float)cell_width_));
 
 			if (!(posX <= 5 || posX >= height_ - 6 || posY <= 5 || posY >= width_ - 6)) {
-				float width = robo_shape_->get_complete_width_y();
-				width       = std::max(4.f, ((width + inc) * 100.f) / cell_width_);
-
-				float height = robo_shape_->get_complete_width_x();
-				height       = std::max(4.f, ((height + inc) * 100.f) / cell_height_);
-
-				integrate_obstacle(posX, posY, width, height);
+				integrate_obstacle(posX, posY);
 
 				old_readings_.push_back(new_readings_[i]);
 			}
 		}
 	}
-	delete pointsTransformed;
 }
 
+/** Select the obstacle mask for this cycle.
+ * All obstacles have the same shape within a cycle, look it up once
+ * instead of for every reading.
+ * @param inc is the current constant to increase the obstacles.
+ */
 void
-LaserOccupancyGrid::integrate_obstacle(int x, int y, int width, int height)
+LaserOccupancyGrid::select_obstacle_mask(float inc)
 {
-	std::vector<int> fast_obstacle = obstacle_map_->get_obstacle(width, height, cfg_obstacle_inc_);
-
-	// i = x offset, i+1 = y offset, i+2 is cost
-	for (unsigned int i = 0; i < fast_obstacle.size(); i += 3) {
-		/* On the laser-points, we draw obstacles based on base_link. The obstacle has the robot-shape,
-     * which means that we need to rotate the shape 180° around base_link and move that rotation-
-     * point onto the laser-point on the grid. That's the same as adding the center_to_base_offset
-     * to the calculated position of the obstacle-center ("x + fast_obstacle[i]" and "y" respectively).
-     */
-		int posX = x + fast_obstacle[i] + offset_base_.x;
-		int posY = y + fast_obstacle[i + 1] + offset_base_.y;
-
-		if ((posX > 0) && (posX < height_) && (posY > 0) && (posY < width_)
-		    && (occupancy_probs_[posX][posY] < fast_obstacle[i + 2])) {
-			occupancy_probs_[posX][posY] = fast_obstacle[i + 2];
-		}
-	}
+	// 25 cm's in my opinion, that are here: 0.25*100/cell_width_
+	//int size = (int)(((0.25f+inc)*100.f)/(float)cell_width_);
+	float width  = robo_shape_->get_complete_width_y();
+	width        = std::max(4.f, ((width + inc) * 100.f) / cell_width_);
+	float height = robo_shape_->get_complete_width_x();
+	height       = std::max(4.f, ((height + inc) * 100.f) / cell_height_);
+
+	obstacle_stamps_->set_mask(obstacle_map_->get_obstacle(width, height, cfg_obstacle_inc_));
+}
+
+void
+LaserOccupancyGrid::integrate_obstacle(int x, int y)
+{
+	/* On the laser-points, we draw obstacles based on base_link. The obstacle has the robot-shape,
+   * which means that we need to rotate the shape 180° around base_link and move that rotation-
+   * point onto the laser-point on the grid. That's the same as adding the center_to_base_offset
+   * to the calculated position of the obstacle-center ("x + fast_obstacle[i]" and "y" respectively).
+   */
+	obstacle_stamps_->add(x + offset_base_.x, y + offset_base_.y);
 }
 
 } // namespace fawkes
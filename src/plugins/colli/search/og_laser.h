@@ -33,12 +33,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace fawkes {
 
 class Laser360Interface;
 class RoboShapeColli;
 class ColliObstacleMap;
+class ColliObstacleStamps;
 
 class Logger;
 class Configuration;
@@ -98,8 +100,9 @@ private:
 
 	void validate_old_laser_points(cart_coord_2d_t pos_robot, cart_coord_2d_t pos_new_laser_point);
 
-	std::vector<LaserPoint> *transform_laser_points(std::vector<LaserPoint> &laser_points,
-	                                                tf::StampedTransform &   transform);
+	void transform_laser_points(const std::vector<LaserPoint> &laser_points,
+	                            tf::StampedTransform &         transform,
+	                            std::vector<LaserPoint> &      transformed);
 
 	/** Integrate historical readings to the current occgrid. */
 	void integrate_old_readings(int                   mid_x,
@@ -115,26 +118,29 @@ private:
 	                            float                 vel,
 	                            tf::StampedTransform &transform);
 
-	/** Integrate a single obstacle
+	/** Select the obstacle mask for the current cycle. */
+	void select_obstacle_mask(float inc);
+
+	/** Integrate a single obstacle with the current mask
    * @param x x coordinate of obstacle center
    * @param y y coordinate of obstacle center
-   * @param width total width of obstacle
-   * @param height total height of obstacle
    */
-	void integrate_obstacle(int x, int y, int width, int height);
+	void integrate_obstacle(int x, int y);
 
 	tf::Transformer *tf_listener_;
 	std::string      reference_frame_;
 	std::string      laser_frame_;
 	bool             cfg_write_spam_debug_;
 
-	Logger *                          logger_;
-	Laser360Interface *               if_laser_;
-	std::shared_ptr<RoboShapeColli>   robo_shape_;   /**< my roboshape */
-	std::shared_ptr<ColliObstacleMap> obstacle_map_; /**< fast obstacle map */
+	Logger *                             logger_;
+	Laser360Interface *                  if_laser_;
+	std::shared_ptr<RoboShapeColli>      robo_shape_;      /**< my roboshape */
+	std::shared_ptr<ColliObstacleMap>    obstacle_map_;    /**< fast obstacle map */
+	std::shared_ptr<ColliObstacleStamps> obstacle_stamps_; /**< obstacles in the grid */
 
 	std::vector<LaserPoint> new_readings_;
-	std::vector<LaserPoint> old_readings_; /**< readings history */
+	std::vector<LaserPoint> old_readings_;         /**< readings history */
+	std::vector<LaserPoint> transformed_readings_; /**< transformed readings, reused */
 
 	point_t laser_pos_; /**< the laser's position in the grid */
 
@@ -502,7 +502,16 @@ LaserFilterThread::create_filter(std::string                             filter_
 		const float       only_from_z = config->get_float((prefix + "only_from_z").c_str());
 		const float       only_to_z   = config->get_float((prefix + "only_to_z").c_str());
 		const std::string frame       = config->get_string((prefix + "target_frame").c_str());
+		std::string       deskew_fixed_frame;
+		float             deskew_scan_duration = 0.f;
+		try {
+			deskew_fixed_frame   = config->get_string((prefix + "deskew/fixed_frame").c_str());
+			deskew_scan_duration = config->get_float((prefix + "deskew/scan_duration").c_str());
+		} catch (Exception &e) {
+			deskew_fixed_frame = "";
+		} // ignored, do not de-skew
 		return new LaserProjectionDataFilter(filter_name,
+		                                     logger,
 		                                     tf_listener,
 		                                     frame,
 		                                     not_from_x,
@@ -512,7 +521,9 @@ LaserFilterThread::create_filter(std::string                             filter_
 		                                     only_from_z,
 		                                     only_to_z,
 		                                     in_data_size,
-		                                     inbufs);
+		                                     inbufs,
+		                                     deskew_fixed_frame,
+		                                     deskew_scan_duration);
 #else
 		throw Exception("Projection filter unavailable, tf missing");
 #endif
@@ -23,9 +23,11 @@
 #include "projection.h"
 
 #include <core/exception.h>
+#include <logging/logger.h>
 #include <sys/types.h>
 #include <utils/math/angle.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -38,11 +40,21 @@ using namespace fawkes;
  * of another (virtual) laser. Additionally some sanity filtering in all
  * three axes is applied after the transformation, but before the
  * projection.
+ *
+ * Optionally, the scan can be de-skewed. A laser scanner takes some time
+ * for a sweep, while the robot moves the beams are recorded from
+ * different poses. If a fixed frame and the duration of a scan are given,
+ * the transform is interpolated over the sweep, assuming the scan's time
+ * stamp is the time of the first beam. Each beam is first transformed
+ * into the fixed frame for the time it was recorded and then into the
+ * target frame for the time of the scan. If the transforms required for
+ * de-skewing are not available, the scan is projected without de-skewing.
  * @author Tim Niemueller, Christoph Schwering
  */
 
 /** Constructor.
  * @param filter_name name of this filter
+ * @param logger logger for informational output
  * @param tf transformer to get transform from
  * @param target_frame target coordinate fram to project into
  * @param not_from_x lower X boundary of ignored rectangle
@@ -53,8 +65,12 @@ using namespace fawkes;
  * @param only_to_z maximum Z value for accepted points
  * @param in_data_size number of entries input value arrays
  * @param in vector of input arrays
+ * @param deskew_fixed_frame fixed frame, e.g. odometry frame, to de-skew
+ * scans in, empty to not de-skew scans
+ * @param deskew_scan_duration time in seconds for a single scan
  */
 LaserProjectionDataFilter::LaserProjectionDataFilter(const std::string &filter_name,
+                                                     fawkes::Logger *   logger,
                                                      tf::Transformer *  tf,
                                                      std::string        target_frame,
                                                      float              not_from_x,
@@ -64,8 +80,11 @@ LaserProjectionDataFilter::LaserProjectionDataFilter(const std::string &filter_n
                                                      float              only_from_z,
                                                      float              only_to_z,
                                                      unsigned int       in_data_size,
-                                                     std::vector<LaserDataFilter::Buffer *> &in)
+                                                     std::vector<LaserDataFilter::Buffer *> &in,
+                                                     std::string        deskew_fixed_frame,
+                                                     float              deskew_scan_duration)
 : LaserDataFilter(filter_name, in_data_size, in, in.size()),
+  logger_(logger),
   tf_(tf),
   target_frame_(target_frame),
   not_from_x_(not_from_x),
@@ -73,19 +92,17 @@ LaserProjectionDataFilter::LaserProjectionDataFilter(const std::string &filter_n
   not_from_y_(not_from_y),
   not_to_y_(not_to_y),
   only_from_z_(only_from_z),
-  only_to_z_(only_to_z)
+  only_to_z_(only_to_z),
+  deskew_fixed_frame_(deskew_fixed_frame),
+  deskew_scan_duration_(deskew_scan_duration),
+  deskew_skipped_(false),
+  projection_(in_data_size)
 {
-	// Generate lookup tables for sin and cos
-	for (unsigned int i = 0; i < 360; ++i) {
-		sin_angles360[i] = sinf(deg2rad(i));
-		cos_angles360[i] = cosf(deg2rad(i));
-	}
-	for (unsigned int i = 0; i < 720; ++i) {
-		sin_angles720[i] = sinf(deg2rad((float)i / 2.));
-		cos_angles720[i] = cosf(deg2rad((float)i / 2.));
-	}
-
 	index_factor_ = out_data_size / 360.;
+
+	points_x_.resize(in_data_size);
+	points_y_.resize(in_data_size);
+	points_z_.resize(in_data_size, 0.f);
 }
 
 LaserProjectionDataFilter::~LaserProjectionDataFilter()
@@ -135,45 +152,75 @@ LaserProjectionDataFilter::filter()
 		float *outbuf = out[a]->values;
 		memset(outbuf, 0, sizeof(float) * out_data_size);
 
-		tf::StampedTransform t;
-		tf::Point            p;
-
-		tf_->lookup_transform(target_frame_, in[a]->frame, fawkes::Time(0, 0), t);
-
-		if (in_data_size == 360) {
-			for (unsigned int i = 0; i < 360; ++i) {
-				if (inbuf[i] == 0.)
-					continue;
-				p.setValue((btScalar)inbuf[i] * cos_angles360[i],
-				           (btScalar)inbuf[i] * sin_angles360[i],
-				           0.);
-				p = t * p;
-
-				set_output(outbuf, p);
-			}
-		} else if (in_data_size == 720) {
-			for (unsigned int i = 0; i < 720; ++i) {
-				if (inbuf[i] == 0.)
-					continue;
-
-				p.setValue((btScalar)inbuf[i] * cos_angles720[i],
-				           (btScalar)inbuf[i] * sin_angles720[i],
-				           0.);
-				p = t * p;
-
-				set_output(outbuf, p);
+		float *      px         = points_x_.data();
+		float *      py         = points_y_.data();
+		float *      pz         = points_z_.data();
+		unsigned int num_points = 0;
+
+		bool deskewed = false;
+		if (!deskew_fixed_frame_.empty() && deskew_scan_duration_ > 0.f) {
+			try {
+				// project all beams, the index of a point determines its time
+				projection_.project(inbuf, px, py);
+				std::fill(pz, pz + in_data_size, 0.f);
+				fawkes::Time end_time = *in[a]->timestamp + (double)deskew_scan_duration_;
+				tf_->transform_points(deskew_fixed_frame_,
+				                      in[a]->frame,
+				                      *in[a]->timestamp,
+				                      end_time,
+				                      in_data_size,
+				                      px,
+				                      py,
+				                      pz,
+				                      px,
+				                      py,
+				                      pz);
+				tf_->transform_points(target_frame_,
+				                      deskew_fixed_frame_,
+				                      *in[a]->timestamp,
+				                      in_data_size,
+				                      px,
+				                      py,
+				                      pz,
+				                      px,
+				                      py,
+				                      pz);
+				for (unsigned int i = 0; i < in_data_size; ++i) {
+					if (inbuf[i] == 0.)
+						continue;
+					px[num_points] = px[i];
+					py[num_points] = py[i];
+					pz[num_points] = pz[i];
+					++num_points;
+				}
+				deskewed = true;
+				if (deskew_skipped_) {
+					logger_->log_info(filter_name.c_str(), "De-skewing scans again");
+					deskew_skipped_ = false;
+				}
+			} catch (Exception &e) {
+				if (!deskew_skipped_) {
+					logger_->log_warn(filter_name.c_str(),
+					                  "Cannot de-skew scan, projecting without de-skewing, "
+					                  "exception follows");
+					logger_->log_warn(filter_name.c_str(), e);
+					deskew_skipped_ = true;
+				}
+				num_points = 0;
 			}
-		} else {
-			for (unsigned int i = 0; i < in_data_size; ++i) {
-				if (inbuf[i] == 0.)
-					continue;
+		}
 
-				float a = deg2rad((float)i / ((float)in_data_size / 360.f));
-				p.setValue((btScalar)inbuf[i] * cos(a), (btScalar)inbuf[i] * sin(a), 0.);
-				p = t * p;
+		if (!deskewed) {
+			// collect valid points and transform all of them at once
+			num_points = projection_.project_valid(inbuf, px, py);
+			std::fill(pz, pz + num_points, 0.f);
+			tf_->transform_points(
+			  target_frame_, in[a]->frame, fawkes::Time(0, 0), num_points, px, py, pz, px, py, pz);
+		}
 
-				set_output(outbuf, p);
-			}
+		for (unsigned int i = 0; i < num_points; ++i) {
+			tf::Point p(px[i], py[i], pz[i]);
+			set_output(outbuf, p);
 		}
 	}
 }
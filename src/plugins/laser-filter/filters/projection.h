@@ -30,8 +30,10 @@
 #endif
 
 #include <tf/transformer.h>
+#include <utils/math/scan_projection.h>
 
 #include <string>
+#include <vector>
 
 namespace fawkes {
 class Configuration;
@@ -42,6 +44,7 @@ class LaserProjectionDataFilter : public LaserDataFilter
 {
 public:
 	LaserProjectionDataFilter(const std::string &                     filter_name,
+	                          fawkes::Logger *                        logger,
 	                          fawkes::tf::Transformer *               tf,
 	                          std::string                             target_frame,
 	                          float                                   not_from_x,
@@ -51,7 +54,9 @@ public:
 	                          float                                   only_from_z,
 	                          float                                   only_to_z,
 	                          unsigned int                            in_data_size,
-	                          std::vector<LaserDataFilter::Buffer *> &in);
+	                          std::vector<LaserDataFilter::Buffer *> &in,
+	                          std::string                             deskew_fixed_frame = "",
+	                          float                                   deskew_scan_duration = 0.f);
 	~LaserProjectionDataFilter();
 
 	void filter();
@@ -60,18 +65,23 @@ private:
 	inline void set_output(float *outbuf, fawkes::tf::Point &p);
 
 private:
+	fawkes::Logger *         logger_;
 	fawkes::tf::Transformer *tf_;
 	const std::string        target_frame_;
 	const float              not_from_x_, not_to_x_;
 	const float              not_from_y_, not_to_y_;
 	const float              only_from_z_, only_to_z_;
+	const std::string        deskew_fixed_frame_;
+	const float              deskew_scan_duration_;
+	bool                     deskew_skipped_;
 
-	float sin_angles360[360];
-	float cos_angles360[360];
-	float sin_angles720[720];
-	float cos_angles720[720];
+	fawkes::LaserScanProjection projection_;
 
 	float index_factor_;
+
+	std::vector<float> points_x_;
+	std::vector<float> points_y_;
+	std::vector<float> points_z_;
 };
 
 #endif
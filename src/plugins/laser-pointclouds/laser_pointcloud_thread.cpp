@@ -26,7 +26,8 @@
 #include <interfaces/Laser360Interface.h>
 #include <interfaces/Laser720Interface.h>
 #include <pcl_utils/utils.h>
-#include <utils/math/angle.h>
+
+#include <algorithm>
 
 using namespace fawkes;
 
@@ -35,6 +36,13 @@ using namespace fawkes;
  * This threads connects to Fawkes and ROS to read and write transforms.
  * Transforms received on one end are republished to the other side. To
  * Fawkes new frames are published during the sensor hook.
+ *
+ * Optionally, scans are de-skewed. While the robot moves, the beams of a
+ * scan are recorded from different poses. If a fixed frame and the
+ * duration of a scan are configured, each beam is transformed into the
+ * fixed frame for the time it was recorded, and back into the laser frame
+ * for the time of the scan, which is assumed to be the time of the first
+ * beam.
  * @author Tim Niemueller
  */
 
@@ -42,7 +50,11 @@ using namespace fawkes;
 LaserPointCloudThread::LaserPointCloudThread()
 : Thread("LaserPointCloudThread", Thread::OPMODE_WAITFORWAKEUP),
   BlockedTimingAspect(BlockedTimingAspect::WAKEUP_HOOK_SENSOR_PREPARE),
-  BlackBoardInterfaceListener("LaserPointCloudThread")
+  TransformAspect(TransformAspect::ONLY_LISTENER),
+  BlackBoardInterfaceListener("LaserPointCloudThread"),
+  projection360_(360),
+  projection720_(720),
+  projection1080_(1080)
 {
 }
 
@@ -54,6 +66,21 @@ LaserPointCloudThread::~LaserPointCloudThread()
 void
 LaserPointCloudThread::init()
 {
+	cfg_deskew_fixed_frame_   = "";
+	cfg_deskew_scan_duration_ = 0.f;
+	deskew_skipped_           = false;
+	try {
+		cfg_deskew_fixed_frame_ = config->get_string("/plugins/laser-pointclouds/deskew/fixed_frame");
+		cfg_deskew_scan_duration_ =
+		  config->get_float("/plugins/laser-pointclouds/deskew/scan_duration");
+	} catch (Exception &e) {
+		cfg_deskew_fixed_frame_ = "";
+	} // ignored, do not de-skew
+
+	points_x_.resize(1080);
+	points_y_.resize(1080);
+	points_z_.resize(1080);
+
 	std::list<Laser360Interface *> l360ifs =
 	  blackboard->open_multiple_for_reading<Laser360Interface>("*");
 
@@ -125,20 +152,6 @@ LaserPointCloudThread::init()
 	bbio_add_observed_create("Laser720Interface", "*");
 	bbio_add_observed_create("Laser1080Interface", "*");
 	blackboard->register_observer(this);
-
-	// Generate lookup tables for sin and cos
-	for (unsigned int i = 0; i < 360; ++i) {
-		sin_angles360[i] = sinf(deg2rad(i));
-		cos_angles360[i] = cosf(deg2rad(i));
-	}
-	for (unsigned int i = 0; i < 720; ++i) {
-		sin_angles720[i] = sinf(deg2rad((float)i / 2.));
-		cos_angles720[i] = cosf(deg2rad((float)i / 2.));
-	}
-	for (unsigned int i = 0; i < 1080; ++i) {
-		sin_angles1080[i] = sinf(deg2rad((float)i / 3.));
-		cos_angles1080[i] = cosf(deg2rad((float)i / 3.));
-	}
 }
 
 void
@@ -166,29 +179,39 @@ LaserPointCloudThread::loop()
 		if (!m->interface->refreshed()) {
 			continue;
 		}
+
+		const LaserScanProjection *projection;
+		float *                    distances;
 		if (m->size == 360) {
 			m->cloud->header.frame_id = m->interface_typed.as360->frame();
-			float *distances          = m->interface_typed.as360->distances();
-			for (unsigned int i = 0; i < 360; ++i) {
-				m->cloud->points[i].x = distances[i] * cos_angles360[i];
-				m->cloud->points[i].y = distances[i] * sin_angles360[i];
-			}
-
+			distances                 = m->interface_typed.as360->distances();
+			projection                = &projection360_;
 		} else if (m->size == 720) {
 			m->cloud->header.frame_id = m->interface_typed.as720->frame();
-			float *distances          = m->interface_typed.as720->distances();
-			for (unsigned int i = 0; i < 720; ++i) {
-				m->cloud->points[i].x = distances[i] * cos_angles720[i];
-				m->cloud->points[i].y = distances[i] * sin_angles720[i];
-			}
-
-		} else if (m->size == 1080) {
+			distances                 = m->interface_typed.as720->distances();
+			projection                = &projection720_;
+		} else {
 			m->cloud->header.frame_id = m->interface_typed.as1080->frame();
-			float *distances          = m->interface_typed.as1080->distances();
-			for (unsigned int i = 0; i < 1080; ++i) {
-				m->cloud->points[i].x = distances[i] * cos_angles1080[i];
-				m->cloud->points[i].y = distances[i] * sin_angles1080[i];
-			}
+			distances                 = m->interface_typed.as1080->distances();
+			projection                = &projection1080_;
+		}
+
+		float *px = points_x_.data();
+		float *py = points_y_.data();
+		float *pz = points_z_.data();
+		projection->project(distances, px, py);
+		std::fill(pz, pz + m->size, 0.f);
+		if (!cfg_deskew_fixed_frame_.empty() && cfg_deskew_scan_duration_ > 0.f
+		    && !deskew(m->cloud->header.frame_id.c_str(), m->interface->timestamp(), m->size)) {
+			// keep the skewed scan, e.g. while odometry is not available, yet
+			projection->project(distances, px, py);
+			std::fill(pz, pz + m->size, 0.f);
+		}
+
+		for (unsigned int i = 0; i < m->size; ++i) {
+			m->cloud->points[i].x = px[i];
+			m->cloud->points[i].y = py[i];
+			m->cloud->points[i].z = pz[i];
 		}
 
 		pcl_utils::set_time(m->cloud, *(m->interface->timestamp()));
@@ -352,6 +375,44 @@ LaserPointCloudThread::conditional_close(Interface *interface) throw()
 	}
 }
 
+/** De-skew projected scan.
+ * Transforms the projected points of a scan into the fixed frame for the
+ * time each beam was recorded, and then back into the laser frame for
+ * the time of the scan.
+ * @param frame laser frame
+ * @param time time of the scan, i.e. of its first beam
+ * @param num_points number of projected points, i.e. beams of the scan
+ * @return true if the points have been de-skewed, false if the transforms
+ * are not available, the points are then partially transformed
+ */
+bool
+LaserPointCloudThread::deskew(const char *frame, const Time *time, unsigned int num_points)
+{
+	float *px = points_x_.data();
+	float *py = points_y_.data();
+	float *pz = points_z_.data();
+
+	try {
+		Time end_time = *time + (double)cfg_deskew_scan_duration_;
+		tf_listener->transform_points(
+		  cfg_deskew_fixed_frame_, frame, *time, end_time, num_points, px, py, pz, px, py, pz);
+		tf_listener->transform_points(
+		  frame, cfg_deskew_fixed_frame_, *time, num_points, px, py, pz, px, py, pz);
+		if (deskew_skipped_) {
+			logger->log_info(name(), "De-skewing scans again");
+			deskew_skipped_ = false;
+		}
+		return true;
+	} catch (Exception &e) {
+		if (!deskew_skipped_) {
+			logger->log_warn(name(), "Cannot de-skew scan, keeping skewed scan, exception follows");
+			logger->log_warn(name(), e);
+			deskew_skipped_ = true;
+		}
+		return false;
+	}
+}
+
 std::string
 LaserPointCloudThread::interface_to_pcl_name(const char *interface_id)
 {
@@ -25,14 +25,19 @@
 // must be first for reliable ROS detection
 #include <aspect/blackboard.h>
 #include <aspect/blocked_timing.h>
+#include <aspect/configurable.h>
 #include <aspect/logging.h>
 #include <aspect/pointcloud.h>
+#include <aspect/tf.h>
 #include <blackboard/interface_listener.h>
 #include <blackboard/interface_observer.h>
 #include <core/threading/thread.h>
 #include <core/utils/lock_list.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <utils/math/scan_projection.h>
+
+#include <vector>
 
 namespace fawkes {
 class Interface;
@@ -43,9 +48,11 @@ class Laser1080Interface;
 
 class LaserPointCloudThread : public fawkes::Thread,
                               public fawkes::LoggingAspect,
+                              public fawkes::ConfigurableAspect,
                               public fawkes::BlackBoardAspect,
                               public fawkes::BlockedTimingAspect,
                               public fawkes::PointCloudAspect,
+                              public fawkes::TransformAspect,
                               public fawkes::BlackBoardInterfaceObserver,
                               public fawkes::BlackBoardInterfaceListener
 {
@@ -69,6 +76,7 @@ public:
 private:
 	void        conditional_close(fawkes::Interface *interface) throw();
 	std::string interface_to_pcl_name(const char *interface_id);
+	bool        deskew(const char *frame, const fawkes::Time *time, unsigned int num_points);
 
 	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
 protected:
@@ -97,12 +105,17 @@ private:
 
 	fawkes::LockList<InterfaceCloudMapping> mappings_;
 
-	float sin_angles360[360];
-	float cos_angles360[360];
-	float sin_angles720[720];
-	float cos_angles720[720];
-	float sin_angles1080[1080];
-	float cos_angles1080[1080];
+	fawkes::LaserScanProjection projection360_;
+	fawkes::LaserScanProjection projection720_;
+	fawkes::LaserScanProjection projection1080_;
+
+	std::vector<float> points_x_;
+	std::vector<float> points_y_;
+	std::vector<float> points_z_;
+
+	std::string cfg_deskew_fixed_frame_;
+	float       cfg_deskew_scan_duration_;
+	bool        deskew_skipped_;
 };
 
 #endif
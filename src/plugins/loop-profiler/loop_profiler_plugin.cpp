@@ -0,0 +1,46 @@
+
+/***************************************************************************
+ *  loop_profiler_plugin.cpp - Publish main loop latency statistics
+ *
+ *  Created: Sat Oct 17 22:14:02 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "loop_profiler_thread.h"
+
+#include <core/plugin.h>
+
+using namespace fawkes;
+
+/** Loop profiler plugin.
+ * Publishes main loop latency statistics to the blackboard.
+ * @author Tim Niemueller
+ */
+class LoopProfilerPlugin : public fawkes::Plugin
+{
+public:
+	/** Constructor.
+   * @param config Fawkes configuration
+   */
+	explicit LoopProfilerPlugin(Configuration *config) : Plugin(config)
+	{
+		thread_list.push_back(new LoopProfilerThread());
+	}
+};
+
+PLUGIN_DESCRIPTION("Publish main loop latency statistics")
+EXPORT_PLUGIN(LoopProfilerPlugin)
@@ -0,0 +1,139 @@
+
+/***************************************************************************
+ *  loop_profiler_thread.cpp - Publish main loop latency statistics
+ *
+ *  Created: Sat Oct 17 22:14:02 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "loop_profiler_thread.h"
+
+#include <interfaces/LoopTimingInterface.h>
+#include <utils/time/time.h>
+
+#include <set>
+
+using namespace fawkes;
+
+/** @class LoopProfilerThread "loop_profiler_thread.h"
+ * Publish main loop latency statistics.
+ * Periodically copies the latency histograms of the BlockedTimingProfiler
+ * to one LoopTimingInterface per hook and, if enabled, per thread.
+ * Interfaces of threads which have been removed are closed.
+ * @author Tim Niemueller
+ */
+
+/** Constructor. */
+LoopProfilerThread::LoopProfilerThread()
+: Thread("LoopProfilerThread", Thread::OPMODE_WAITFORWAKEUP),
+  BlockedTimingAspect(BlockedTimingAspect::WAKEUP_HOOK_POST_LOOP)
+{
+}
+
+/** Destructor. */
+LoopProfilerThread::~LoopProfilerThread()
+{
+}
+
+void
+LoopProfilerThread::init()
+{
+	cfg_interval_   = config->get_float_or_default("/loop-profiler/interval", 1.0);
+	cfg_per_thread_ = config->get_bool_or_default("/loop-profiler/per_thread", true);
+
+	last_update_ = new Time(clock);
+}
+
+void
+LoopProfilerThread::finalize()
+{
+	for (auto &i : hook_ifs_) {
+		blackboard->close(i.second);
+	}
+	hook_ifs_.clear();
+	for (auto &i : thread_ifs_) {
+		blackboard->close(i.second);
+	}
+	thread_ifs_.clear();
+	delete last_update_;
+}
+
+void
+LoopProfilerThread::loop()
+{
+	Time now(clock);
+	if ((now - last_update_) < cfg_interval_)
+		return;
+	*last_update_ = now;
+
+	BlockedTimingProfiler *profiler = BlockedTimingProfiler::instance();
+	publish("Hook ", profiler->hook_latencies(), hook_ifs_);
+	if (cfg_per_thread_) {
+		publish("Thread ", profiler->thread_latencies(), thread_ifs_);
+	}
+}
+
+void
+LoopProfilerThread::publish(const std::string &                            id_prefix,
+                            const std::list<BlockedTimingProfiler::Entry> &entries,
+                            InterfaceMap &                                 ifs)
+{
+	std::set<std::string> seen;
+
+	for (const BlockedTimingProfiler::Entry &e : entries) {
+		std::string id = (id_prefix + e.name).substr(0, INTERFACE_ID_SIZE_);
+		seen.insert(id);
+
+		LoopTimingInterface *  iface;
+		InterfaceMap::iterator i = ifs.find(id);
+		if (i == ifs.end()) {
+			try {
+				iface = blackboard->open_for_writing<LoopTimingInterface>(id.c_str());
+			} catch (Exception &ex) {
+				logger->log_warn(name(),
+				                 "Failed to open interface '%s', exception follows",
+				                 id.c_str());
+				logger->log_warn(name(), ex);
+				continue;
+			}
+			ifs[id] = iface;
+		} else {
+			iface = i->second;
+		}
+
+		const LatencyHistogram &h = e.histogram;
+		iface->set_name(e.name.c_str());
+		iface->set_hook(BlockedTimingAspect::blocked_timing_hook_to_string(e.hook));
+		iface->set_count(h.count());
+		iface->set_mean(h.mean());
+		iface->set_min(h.min());
+		iface->set_p50(h.percentile(50.));
+		iface->set_p90(h.percentile(90.));
+		iface->set_p99(h.percentile(99.));
+		iface->set_max(h.max());
+		iface->write();
+	}
+
+	for (InterfaceMap::iterator i = ifs.begin(); i != ifs.end();) {
+		if (seen.find(i->first) == seen.end()) {
+			blackboard->close(i->second);
+			i = ifs.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
@@ -0,0 +1,82 @@
+
+/***************************************************************************
+ *  loop_profiler_thread.h - Publish main loop latency statistics
+ *
+ *  Created: Sat Oct 17 22:14:02 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_LOOP_PROFILER_LOOP_PROFILER_THREAD_H_
+#define _PLUGINS_LOOP_PROFILER_LOOP_PROFILER_THREAD_H_
+
+#include <aspect/blackboard.h>
+#include <aspect/blocked_timing.h>
+#include <aspect/blocked_timing/profiler.h>
+#include <aspect/clock.h>
+#include <aspect/configurable.h>
+#include <aspect/logging.h>
+#include <core/threading/thread.h>
+
+#include <list>
+#include <map>
+#include <string>
+
+namespace fawkes {
+class LoopTimingInterface;
+class Time;
+} // namespace fawkes
+
+class LoopProfilerThread : public fawkes::Thread,
+                           public fawkes::BlockedTimingAspect,
+                           public fawkes::LoggingAspect,
+                           public fawkes::ClockAspect,
+                           public fawkes::ConfigurableAspect,
+                           public fawkes::BlackBoardAspect
+{
+public:
+	LoopProfilerThread();
+	virtual ~LoopProfilerThread();
+
+	virtual void init();
+	virtual void loop();
+	virtual void finalize();
+
+	/** Stub to see name in backtrace for easier debugging. @see Thread::run() */
+protected:
+	virtual void
+	run()
+	{
+		Thread::run();
+	}
+
+private:
+	typedef std::map<std::string, fawkes::LoopTimingInterface *> InterfaceMap;
+
+	void publish(const std::string &                                    id_prefix,
+	             const std::list<fawkes::BlockedTimingProfiler::Entry> &entries,
+	             InterfaceMap &                                         ifs);
+
+private:
+	float         cfg_interval_;
+	bool          cfg_per_thread_;
+	fawkes::Time *last_update_;
+
+	InterfaceMap hook_ifs_;
+	InterfaceMap thread_ifs_;
+};
+
+#endif
@@ -0,0 +1,45 @@
+
+/***************************************************************************
+ *  loop-profiler-rest-api-plugin.cpp - Main loop profiler REST API
+ *
+ *  Created: Sat Oct 17 22:41:17 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "loop-profiler-rest-api.h"
+
+#include <core/plugin.h>
+
+using namespace fawkes;
+
+/** Main loop profiler REST API plugin.
+ * @author Tim Niemueller
+ */
+class LoopProfilerRestApiPlugin : public fawkes::Plugin
+{
+public:
+	/** Constructor.
+   * @param config Fawkes configuration
+   */
+	explicit LoopProfilerRestApiPlugin(Configuration *config) : Plugin(config)
+	{
+		thread_list.push_back(new LoopProfilerRestApi());
+	}
+};
+
+PLUGIN_DESCRIPTION("Main loop profiler REST API")
+EXPORT_PLUGIN(LoopProfilerRestApiPlugin)
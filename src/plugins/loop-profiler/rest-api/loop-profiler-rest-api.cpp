@@ -0,0 +1,139 @@
+
+/***************************************************************************
+ *  loop-profiler-rest-api.cpp - Main loop profiler REST API
+ *
+ *  Created: Sat Oct 17 22:41:17 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "loop-profiler-rest-api.h"
+
+#include <webview/rest_api_manager.h>
+
+using namespace fawkes;
+
+/** @class LoopProfilerRestApi "loop-profiler-rest-api.h"
+ * REST API backend for the main loop profiler.
+ * Provides the latency statistics recorded by the BlockedTimingProfiler.
+ * The data is read directly from the profiler, therefore the loop-profiler
+ * plugin need not be loaded.
+ * @author Tim Niemueller
+ */
+
+/** Constructor. */
+LoopProfilerRestApi::LoopProfilerRestApi()
+: Thread("LoopProfilerRestApi", Thread::OPMODE_WAITFORWAKEUP)
+{
+}
+
+/** Destructor. */
+LoopProfilerRestApi::~LoopProfilerRestApi()
+{
+}
+
+void
+LoopProfilerRestApi::init()
+{
+	rest_api_ = new WebviewRestApi("loop-profiler", logger);
+	rest_api_->add_handler<WebviewRestArray<LoopTiming>>(
+	  WebRequest::METHOD_GET, "/hooks", std::bind(&LoopProfilerRestApi::cb_list_hooks, this));
+	rest_api_->add_handler<WebviewRestArray<LoopTiming>>(
+	  WebRequest::METHOD_GET, "/threads", std::bind(&LoopProfilerRestApi::cb_list_threads, this));
+	rest_api_->add_handler<LoopTiming>(WebRequest::METHOD_GET,
+	                                   "/threads/{name}",
+	                                   std::bind(&LoopProfilerRestApi::cb_get_thread,
+	                                             this,
+	                                             std::placeholders::_1));
+	webview_rest_api_manager->register_api(rest_api_);
+}
+
+void
+LoopProfilerRestApi::finalize()
+{
+	webview_rest_api_manager->unregister_api(rest_api_);
+	delete rest_api_;
+}
+
+void
+LoopProfilerRestApi::loop()
+{
+}
+
+LoopTiming
+LoopProfilerRestApi::gen_loop_timing(const BlockedTimingProfiler::Entry &entry, bool histogram)
+{
+	const LatencyHistogram &h = entry.histogram;
+
+	LoopTiming t;
+	t.set_kind("LoopTiming");
+	t.set_apiVersion(LoopTiming::api_version());
+	t.set_name(entry.name);
+	t.set_hook(BlockedTimingAspect::blocked_timing_hook_to_string(entry.hook));
+	t.set_count(h.count());
+	t.set_mean(h.mean());
+	t.set_min(h.min());
+	t.set_p50(h.percentile(50.));
+	t.set_p90(h.percentile(90.));
+	t.set_p99(h.percentile(99.));
+	t.set_max(h.max());
+
+	if (histogram) {
+		for (unsigned int i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i) {
+			uint64_t count = h.bucket_count(i);
+			if (count == 0)
+				continue;
+			LatencyBucket b;
+			b.set_lower(LatencyHistogram::bucket_lower_bound(i));
+			b.set_upper(LatencyHistogram::bucket_upper_bound(i));
+			b.set_count(count);
+			t.addto_histogram(std::move(b));
+		}
+	}
+
+	return t;
+}
+
+WebviewRestArray<LoopTiming>
+LoopProfilerRestApi::cb_list_hooks()
+{
+	WebviewRestArray<LoopTiming> rv;
+	for (const auto &e : BlockedTimingProfiler::instance()->hook_latencies()) {
+		rv.push_back(gen_loop_timing(e, false));
+	}
+	return rv;
+}
+
+WebviewRestArray<LoopTiming>
+LoopProfilerRestApi::cb_list_threads()
+{
+	WebviewRestArray<LoopTiming> rv;
+	for (const auto &e : BlockedTimingProfiler::instance()->thread_latencies()) {
+		rv.push_back(gen_loop_timing(e, false));
+	}
+	return rv;
+}
+
+LoopTiming
+LoopProfilerRestApi::cb_get_thread(WebviewRestParams &params)
+{
+	const std::string &name = params.path_arg("name");
+	for (const auto &e : BlockedTimingProfiler::instance()->thread_latencies()) {
+		if (e.name == name) {
+			return gen_loop_timing(e, true);
+		}
+	}
+	throw WebviewRestException(WebReply::HTTP_NOT_FOUND, "Thread '%s' not found", name.c_str());
+}
@@ -0,0 +1,56 @@
+
+/***************************************************************************
+ *  loop-profiler-rest-api.h - Main loop profiler REST API
+ *
+ *  Created: Sat Oct 17 22:41:17 2026
+ *  Copyright  2026  Tim Niemueller [www.niemueller.de]
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#pragma once
+
+#include "model/LatencyBucket.h"
+#include "model/LoopTiming.h"
+
+#include <aspect/blocked_timing/profiler.h>
+#include <aspect/logging.h>
+#include <aspect/webview.h>
+#include <core/threading/thread.h>
+#include <webview/rest_api.h>
+#include <webview/rest_array.h>
+
+class LoopProfilerRestApi : public fawkes::Thread,
+                            public fawkes::LoggingAspect,
+                            public fawkes::WebviewAspect
+{
+public:
+	LoopProfilerRestApi();
+	~LoopProfilerRestApi();
+
+	virtual void init();
+	virtual void loop();
+	virtual void finalize();
+
+private:
+	WebviewRestArray<LoopTiming> cb_list_hooks();
+	WebviewRestArray<LoopTiming> cb_list_threads();
+	LoopTiming                   cb_get_thread(fawkes::WebviewRestParams &params);
+
+	static LoopTiming gen_loop_timing(const fawkes::BlockedTimingProfiler::Entry &entry,
+	                                  bool                                        histogram);
+
+private:
+	fawkes::WebviewRestApi *rest_api_;
+};
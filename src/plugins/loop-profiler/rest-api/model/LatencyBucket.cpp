@@ -0,0 +1,135 @@
+
+/****************************************************************************
+ *  LatencyBucket
+ *  (auto-generated, do not modify directly)
+ *
+ *  Main loop profiler REST API.
+ *  Latency statistics of the main loop hooks and of the threads
+ *  with the BlockedTimingAspect.
+ *
+ *  API Contact: Tim Niemueller <niemueller@kbsg.rwth-aachen.de>
+ *  API Version: v1beta1
+ *  API License: Apache 2.0
+ ****************************************************************************/
+
+#include "LatencyBucket.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <sstream>
+
+LatencyBucket::LatencyBucket()
+{
+}
+
+LatencyBucket::LatencyBucket(const std::string &json)
+{
+	from_json(json);
+}
+
+LatencyBucket::LatencyBucket(const rapidjson::Value &v)
+{
+	from_json_value(v);
+}
+
+LatencyBucket::~LatencyBucket()
+{
+}
+
+std::string
+LatencyBucket::to_json(bool pretty) const
+{
+	rapidjson::Document d;
+
+	to_json_value(d, d);
+
+	rapidjson::StringBuffer buffer;
+	if (pretty) {
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+		d.Accept(writer);
+	} else {
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		d.Accept(writer);
+	}
+
+	return buffer.GetString();
+}
+
+void
+LatencyBucket::to_json_value(rapidjson::Document &d, rapidjson::Value &v) const
+{
+	rapidjson::Document::AllocatorType &allocator = d.GetAllocator();
+	v.SetObject();
+	// Avoid unused variable warnings
+	(void)allocator;
+
+	if (lower_) {
+		rapidjson::Value v_lower;
+		v_lower.SetInt64(*lower_);
+		v.AddMember("lower", v_lower, allocator);
+	}
+	if (upper_) {
+		rapidjson::Value v_upper;
+		v_upper.SetInt64(*upper_);
+		v.AddMember("upper", v_upper, allocator);
+	}
+	if (count_) {
+		rapidjson::Value v_count;
+		v_count.SetInt64(*count_);
+		v.AddMember("count", v_count, allocator);
+	}
+}
+
+void
+LatencyBucket::from_json(const std::string &json)
+{
+	rapidjson::Document d;
+	d.Parse(json);
+
+	from_json_value(d);
+}
+
+void
+LatencyBucket::from_json_value(const rapidjson::Value &d)
+{
+	if (d.HasMember("lower") && d["lower"].IsInt64()) {
+		lower_ = d["lower"].GetInt64();
+	}
+	if (d.HasMember("upper") && d["upper"].IsInt64()) {
+		upper_ = d["upper"].GetInt64();
+	}
+	if (d.HasMember("count") && d["count"].IsInt64()) {
+		count_ = d["count"].GetInt64();
+	}
+}
+
+void
+LatencyBucket::validate(bool subcall) const
+{
+	std::vector<std::string> missing;
+	if (!lower_) {
+		missing.push_back("lower");
+	}
+	if (!upper_) {
+		missing.push_back("upper");
+	}
+	if (!count_) {
+		missing.push_back("count");
+	}
+
+	if (!missing.empty()) {
+		if (subcall) {
+			throw missing;
+		} else {
+			std::string s =
+			  std::accumulate(std::next(missing.begin()),
+			                  missing.end(),
+			                  missing.front(),
+			                  [](std::string &s, const std::string &n) { return s + ", " + n; });
+			throw std::runtime_error("LatencyBucket is missing " + s);
+		}
+	}
+}
\ No newline at end of file
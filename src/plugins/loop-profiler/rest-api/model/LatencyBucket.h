@@ -0,0 +1,145 @@
+
+/****************************************************************************
+ *  LoopProfiler -- Schema LatencyBucket
+ *  (auto-generated, do not modify directly)
+ *
+ *  Main loop profiler REST API.
+ *  Latency statistics of the main loop hooks and of the threads
+ *  with the BlockedTimingAspect.
+ *
+ *  API Contact: Tim Niemueller <niemueller@kbsg.rwth-aachen.de>
+ *  API Version: v1beta1
+ *  API License: Apache 2.0
+ ****************************************************************************/
+
+#pragma once
+
+#define RAPIDJSON_HAS_STDSTRING 1
+
+#include <rapidjson/fwd.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/** LatencyBucket representation for JSON transfer. */
+class LatencyBucket
+{
+public:
+	/** Constructor. */
+	LatencyBucket();
+	/** Constructor from JSON.
+	 * @param json JSON string to initialize from
+	 */
+	LatencyBucket(const std::string &json);
+	/** Constructor from JSON.
+	 * @param v RapidJSON value object to initialize from.
+	 */
+	LatencyBucket(const rapidjson::Value &v);
+
+	/** Destructor. */
+	virtual ~LatencyBucket();
+
+	/** Get version of implemented API.
+	 * @return string representation of version
+	 */
+	static std::string
+	api_version()
+	{
+		return "v1beta1";
+	}
+
+	/** Render object to JSON.
+	 * @param pretty true to enable pretty printing (readable spacing)
+	 * @return JSON string
+	 */
+	virtual std::string to_json(bool pretty = false) const;
+	/** Render object to JSON.
+	 * @param d RapidJSON document to retrieve allocator from
+	 * @param v RapidJSON value to add data to
+	 */
+	virtual void to_json_value(rapidjson::Document &d, rapidjson::Value &v) const;
+	/** Retrieve data from JSON string.
+	 * @param json JSON representation suitable for this object.
+	 * Will allow partial assignment and not validate automaticaly.
+	 * @see validate()
+	 */
+	virtual void from_json(const std::string &json);
+	/** Retrieve data from JSON string.
+	 * @param v RapidJSON value suitable for this object.
+	 * Will allow partial assignment and not validate automaticaly.
+	 * @see validate()
+	 */
+	virtual void from_json_value(const rapidjson::Value &v);
+
+	/** Validate if all required fields have been set.
+	 * @param subcall true if this is called from another class, e.g.,
+	 * a sub-class or array holder. Will modify the kind of exception thrown.
+	 * @exception std::vector<std::string> thrown if required information is
+	 * missing and @p subcall is set to true. Contains a list of missing fields.
+	 * @exception std::runtime_error informative message describing the missing
+	 * fields
+	 */
+	virtual void validate(bool subcall = false) const;
+
+	// Schema: LatencyBucket
+public:
+	/** Lower bound of bucket in microseconds.
+   * @return lower value
+   */
+	std::optional<int64_t>
+	lower() const
+	{
+		return lower_;
+	}
+
+	/** Set lower value.
+	 * @param lower new value
+	 */
+	void
+	set_lower(const int64_t &lower)
+	{
+		lower_ = lower;
+	}
+	/** Upper bound of bucket in microseconds.
+   * @return upper value
+   */
+	std::optional<int64_t>
+	upper() const
+	{
+		return upper_;
+	}
+
+	/** Set upper value.
+	 * @param upper new value
+	 */
+	void
+	set_upper(const int64_t &upper)
+	{
+		upper_ = upper;
+	}
+	/** Number of values in bucket.
+   * @return count value
+   */
+	std::optional<int64_t>
+	count() const
+	{
+		return count_;
+	}
+
+	/** Set count value.
+	 * @param count new value
+	 */
+	void
+	set_count(const int64_t &count)
+	{
+		count_ = count;
+	}
+
+private:
+	std::optional<int64_t> lower_;
+	std::optional<int64_t> upper_;
+	std::optional<int64_t> count_;
+};
\ No newline at end of file
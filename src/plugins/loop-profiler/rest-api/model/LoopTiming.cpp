@@ -0,0 +1,224 @@
+
+/****************************************************************************
+ *  LoopTiming
+ *  (auto-generated, do not modify directly)
+ *
+ *  Main loop profiler REST API.
+ *  Latency statistics of the main loop hooks and of the threads
+ *  with the BlockedTimingAspect.
+ *
+ *  API Contact: Tim Niemueller <niemueller@kbsg.rwth-aachen.de>
+ *  API Version: v1beta1
+ *  API License: Apache 2.0
+ ****************************************************************************/
+
+#include "LoopTiming.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <sstream>
+
+LoopTiming::LoopTiming()
+{
+}
+
+LoopTiming::LoopTiming(const std::string &json)
+{
+	from_json(json);
+}
+
+LoopTiming::LoopTiming(const rapidjson::Value &v)
+{
+	from_json_value(v);
+}
+
+LoopTiming::~LoopTiming()
+{
+}
+
+std::string
+LoopTiming::to_json(bool pretty) const
+{
+	rapidjson::Document d;
+
+	to_json_value(d, d);
+
+	rapidjson::StringBuffer buffer;
+	if (pretty) {
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+		d.Accept(writer);
+	} else {
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		d.Accept(writer);
+	}
+
+	return buffer.GetString();
+}
+
+void
+LoopTiming::to_json_value(rapidjson::Document &d, rapidjson::Value &v) const
+{
+	rapidjson::Document::AllocatorType &allocator = d.GetAllocator();
+	v.SetObject();
+	// Avoid unused variable warnings
+	(void)allocator;
+
+	if (kind_) {
+		rapidjson::Value v_kind;
+		v_kind.SetString(*kind_, allocator);
+		v.AddMember("kind", v_kind, allocator);
+	}
+	if (apiVersion_) {
+		rapidjson::Value v_apiVersion;
+		v_apiVersion.SetString(*apiVersion_, allocator);
+		v.AddMember("apiVersion", v_apiVersion, allocator);
+	}
+	if (name_) {
+		rapidjson::Value v_name;
+		v_name.SetString(*name_, allocator);
+		v.AddMember("name", v_name, allocator);
+	}
+	if (hook_) {
+		rapidjson::Value v_hook;
+		v_hook.SetString(*hook_, allocator);
+		v.AddMember("hook", v_hook, allocator);
+	}
+	if (count_) {
+		rapidjson::Value v_count;
+		v_count.SetInt64(*count_);
+		v.AddMember("count", v_count, allocator);
+	}
+	if (mean_) {
+		rapidjson::Value v_mean;
+		v_mean.SetFloat(*mean_);
+		v.AddMember("mean", v_mean, allocator);
+	}
+	if (min_) {
+		rapidjson::Value v_min;
+		v_min.SetInt64(*min_);
+		v.AddMember("min", v_min, allocator);
+	}
+	if (p50_) {
+		rapidjson::Value v_p50;
+		v_p50.SetInt64(*p50_);
+		v.AddMember("p50", v_p50, allocator);
+	}
+	if (p90_) {
+		rapidjson::Value v_p90;
+		v_p90.SetInt64(*p90_);
+		v.AddMember("p90", v_p90, allocator);
+	}
+	if (p99_) {
+		rapidjson::Value v_p99;
+		v_p99.SetInt64(*p99_);
+		v.AddMember("p99", v_p99, allocator);
+	}
+	if (max_) {
+		rapidjson::Value v_max;
+		v_max.SetInt64(*max_);
+		v.AddMember("max", v_max, allocator);
+	}
+	rapidjson::Value v_histogram(rapidjson::kArrayType);
+	v_histogram.Reserve(histogram_.size(), allocator);
+	for (const auto &e : histogram_) {
+		rapidjson::Value v(rapidjson::kObjectType);
+		e->to_json_value(d, v);
+		v_histogram.PushBack(v, allocator);
+	}
+	v.AddMember("histogram", v_histogram, allocator);
+}
+
+void
+LoopTiming::from_json(const std::string &json)
+{
+	rapidjson::Document d;
+	d.Parse(json);
+
+	from_json_value(d);
+}
+
+void
+LoopTiming::from_json_value(const rapidjson::Value &d)
+{
+	if (d.HasMember("kind") && d["kind"].IsString()) {
+		kind_ = d["kind"].GetString();
+	}
+	if (d.HasMember("apiVersion") && d["apiVersion"].IsString()) {
+		apiVersion_ = d["apiVersion"].GetString();
+	}
+	if (d.HasMember("name") && d["name"].IsString()) {
+		name_ = d["name"].GetString();
+	}
+	if (d.HasMember("hook") && d["hook"].IsString()) {
+		hook_ = d["hook"].GetString();
+	}
+	if (d.HasMember("count") && d["count"].IsInt64()) {
+		count_ = d["count"].GetInt64();
+	}
+	if (d.HasMember("mean") && d["mean"].IsFloat()) {
+		mean_ = d["mean"].GetFloat();
+	}
+	if (d.HasMember("min") && d["min"].IsInt64()) {
+		min_ = d["min"].GetInt64();
+	}
+	if (d.HasMember("p50") && d["p50"].IsInt64()) {
+		p50_ = d["p50"].GetInt64();
+	}
+	if (d.HasMember("p90") && d["p90"].IsInt64()) {
+		p90_ = d["p90"].GetInt64();
+	}
+	if (d.HasMember("p99") && d["p99"].IsInt64()) {
+		p99_ = d["p99"].GetInt64();
+	}
+	if (d.HasMember("max") && d["max"].IsInt64()) {
+		max_ = d["max"].GetInt64();
+	}
+	if (d.HasMember("histogram") && d["histogram"].IsArray()) {
+		const rapidjson::Value &a = d["histogram"];
+		histogram_                = std::vector<std::shared_ptr<LatencyBucket>>{};
+
+		histogram_.reserve(a.Size());
+		for (auto &v : a.GetArray()) {
+			std::shared_ptr<LatencyBucket> nv{new LatencyBucket()};
+			nv->from_json_value(v);
+			histogram_.push_back(std::move(nv));
+		}
+	}
+}
+
+void
+LoopTiming::validate(bool subcall) const
+{
+	std::vector<std::string> missing;
+	if (!kind_) {
+		missing.push_back("kind");
+	}
+	if (!apiVersion_) {
+		missing.push_back("apiVersion");
+	}
+	if (!name_) {
+		missing.push_back("name");
+	}
+	if (!hook_) {
+		missing.push_back("hook");
+	}
+	if (!count_) {
+		missing.push_back("count");
+	}
+
+	if (!missing.empty()) {
+		if (subcall) {
+			throw missing;
+		} else {
+			std::string s =
+			  std::accumulate(std::next(missing.begin()),
+			                  missing.end(),
+			                  missing.front(),
+			                  [](std::string &s, const std::string &n) { return s + ", " + n; });
+			throw std::runtime_error("LoopTiming is missing " + s);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,334 @@
+
+/****************************************************************************
+ *  LoopProfiler -- Schema LoopTiming
+ *  (auto-generated, do not modify directly)
+ *
+ *  Main loop profiler REST API.
+ *  Latency statistics of the main loop hooks and of the threads
+ *  with the BlockedTimingAspect.
+ *
+ *  API Contact: Tim Niemueller <niemueller@kbsg.rwth-aachen.de>
+ *  API Version: v1beta1
+ *  API License: Apache 2.0
+ ****************************************************************************/
+
+#pragma once
+
+#define RAPIDJSON_HAS_STDSTRING 1
+#include "LatencyBucket.h"
+
+#include <rapidjson/fwd.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/** LoopTiming representation for JSON transfer. */
+class LoopTiming
+{
+public:
+	/** Constructor. */
+	LoopTiming();
+	/** Constructor from JSON.
+	 * @param json JSON string to initialize from
+	 */
+	LoopTiming(const std::string &json);
+	/** Constructor from JSON.
+	 * @param v RapidJSON value object to initialize from.
+	 */
+	LoopTiming(const rapidjson::Value &v);
+
+	/** Destructor. */
+	virtual ~LoopTiming();
+
+	/** Get version of implemented API.
+	 * @return string representation of version
+	 */
+	static std::string
+	api_version()
+	{
+		return "v1beta1";
+	}
+
+	/** Render object to JSON.
+	 * @param pretty true to enable pretty printing (readable spacing)
+	 * @return JSON string
+	 */
+	virtual std::string to_json(bool pretty = false) const;
+	/** Render object to JSON.
+	 * @param d RapidJSON document to retrieve allocator from
+	 * @param v RapidJSON value to add data to
+	 */
+	virtual void to_json_value(rapidjson::Document &d, rapidjson::Value &v) const;
+	/** Retrieve data from JSON string.
+	 * @param json JSON representation suitable for this object.
+	 * Will allow partial assignment and not validate automaticaly.
+	 * @see validate()
+	 */
+	virtual void from_json(const std::string &json);
+	/** Retrieve data from JSON string.
+	 * @param v RapidJSON value suitable for this object.
+	 * Will allow partial assignment and not validate automaticaly.
+	 * @see validate()
+	 */
+	virtual void from_json_value(const rapidjson::Value &v);
+
+	/** Validate if all required fields have been set.
+	 * @param subcall true if this is called from another class, e.g.,
+	 * a sub-class or array holder. Will modify the kind of exception thrown.
+	 * @exception std::vector<std::string> thrown if required information is
+	 * missing and @p subcall is set to true. Contains a list of missing fields.
+	 * @exception std::runtime_error informative message describing the missing
+	 * fields
+	 */
+	virtual void validate(bool subcall = false) const;
+
+	// Schema: LoopTiming
+public:
+	/** Get kind value.
+   * @return kind value
+   */
+	std::optional<std::string>
+	kind() const
+	{
+		return kind_;
+	}
+
+	/** Set kind value.
+	 * @param kind new value
+	 */
+	void
+	set_kind(const std::string &kind)
+	{
+		kind_ = kind;
+	}
+	/** Get apiVersion value.
+   * @return apiVersion value
+   */
+	std::optional<std::string>
+	apiVersion() const
+	{
+		return apiVersion_;
+	}
+
+	/** Set apiVersion value.
+	 * @param apiVersion new value
+	 */
+	void
+	set_apiVersion(const std::string &apiVersion)
+	{
+		apiVersion_ = apiVersion;
+	}
+	/** Name of the hook or thread.
+   * @return name value
+   */
+	std::optional<std::string>
+	name() const
+	{
+		return name_;
+	}
+
+	/** Set name value.
+	 * @param name new value
+	 */
+	void
+	set_name(const std::string &name)
+	{
+		name_ = name;
+	}
+	/** Wakeup hook of the thread, or the hook itself.
+   * @return hook value
+   */
+	std::optional<std::string>
+	hook() const
+	{
+		return hook_;
+	}
+
+	/** Set hook value.
+	 * @param hook new value
+	 */
+	void
+	set_hook(const std::string &hook)
+	{
+		hook_ = hook;
+	}
+	/** Number of recorded loops.
+   * @return count value
+   */
+	std::optional<int64_t>
+	count() const
+	{
+		return count_;
+	}
+
+	/** Set count value.
+	 * @param count new value
+	 */
+	void
+	set_count(const int64_t &count)
+	{
+		count_ = count;
+	}
+	/** Mean latency in microseconds.
+   * @return mean value
+   */
+	std::optional<float>
+	mean() const
+	{
+		return mean_;
+	}
+
+	/** Set mean value.
+	 * @param mean new value
+	 */
+	void
+	set_mean(const float &mean)
+	{
+		mean_ = mean;
+	}
+	/** Minimum latency in microseconds.
+   * @return min value
+   */
+	std::optional<int64_t>
+	min() const
+	{
+		return min_;
+	}
+
+	/** Set min value.
+	 * @param min new value
+	 */
+	void
+	set_min(const int64_t &min)
+	{
+		min_ = min;
+	}
+	/** Median latency in microseconds.
+   * @return p50 value
+   */
+	std::optional<int64_t>
+	p50() const
+	{
+		return p50_;
+	}
+
+	/** Set p50 value.
+	 * @param p50 new value
+	 */
+	void
+	set_p50(const int64_t &p50)
+	{
+		p50_ = p50;
+	}
+	/** 90th percentile latency in microseconds.
+   * @return p90 value
+   */
+	std::optional<int64_t>
+	p90() const
+	{
+		return p90_;
+	}
+
+	/** Set p90 value.
+	 * @param p90 new value
+	 */
+	void
+	set_p90(const int64_t &p90)
+	{
+		p90_ = p90;
+	}
+	/** 99th percentile latency in microseconds.
+   * @return p99 value
+   */
+	std::optional<int64_t>
+	p99() const
+	{
+		return p99_;
+	}
+
+	/** Set p99 value.
+	 * @param p99 new value
+	 */
+	void
+	set_p99(const int64_t &p99)
+	{
+		p99_ = p99;
+	}
+	/** Maximum latency in microseconds.
+   * @return max value
+   */
+	std::optional<int64_t>
+	max() const
+	{
+		return max_;
+	}
+
+	/** Set max value.
+	 * @param max new value
+	 */
+	void
+	set_max(const int64_t &max)
+	{
+		max_ = max;
+	}
+	/** Non-empty buckets of the latency histogram.
+   * @return histogram value
+   */
+	std::vector<std::shared_ptr<LatencyBucket>>
+	histogram() const
+	{
+		return histogram_;
+	}
+
+	/** Set histogram value.
+	 * @param histogram new value
+	 */
+	void
+	set_histogram(const std::vector<std::shared_ptr<LatencyBucket>> &histogram)
+	{
+		histogram_ = histogram;
+	}
+	/** Add element to histogram array.
+	 * @param histogram new value
+	 */
+	void
+	addto_histogram(const std::shared_ptr<LatencyBucket> &&histogram)
+	{
+		histogram_.push_back(std::move(histogram));
+	}
+
+	/** Add element to histogram array.
+	 * The move-semantics version (std::move) should be preferred.
+	 * @param histogram new value
+	 */
+	void
+	addto_histogram(const std::shared_ptr<LatencyBucket> &histogram)
+	{
+		histogram_.push_back(histogram);
+	}
+	/** Add element to histogram array.
+	 * @param histogram new value
+	 */
+	void
+	addto_histogram(const LatencyBucket &&histogram)
+	{
+		histogram_.push_back(std::make_shared<LatencyBucket>(std::move(histogram)));
+	}
+
+private:
+	std::optional<std::string>                  kind_;
+	std::optional<std::string>                  apiVersion_;
+	std::optional<std::string>                  name_;
+	std::optional<std::string>                  hook_;
+	std::optional<int64_t>                      count_;
+	std::optional<float>                        mean_;
+	std::optional<int64_t>                      min_;
+	std::optional<int64_t>                      p50_;
+	std::optional<int64_t>                      p90_;
+	std::optional<int64_t>                      p99_;
+	std::optional<int64_t>                      max_;
+	std::vector<std::shared_ptr<LatencyBucket>> histogram_;
+};
\ No newline at end of file
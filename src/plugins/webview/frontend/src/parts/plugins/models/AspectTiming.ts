@@ -0,0 +1,24 @@
+/****************************************************************************
+ *  Plugin -- Schema AspectTiming
+ *  (auto-generated, do not modify directly)
+ *
+ *  Fawkes Plugin REST API.
+ *  List, load, and unload plugins.
+ *
+ *  API Contact: Tim Niemueller <niemueller@kbsg.rwth-aachen.de>
+ *  API Version: v1beta1
+ *  API License: Apache 2.0
+ ****************************************************************************/
+
+
+
+/** AspectTiming representation for JSON transfer. */
+export interface AspectTiming {
+  name: string;
+  init_usec: number;
+}
+
+export namespace AspectTiming {
+  export const API_VERSION = 'v1beta1';
+
+}
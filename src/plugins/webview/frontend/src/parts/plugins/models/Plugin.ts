@@ -10,6 +10,7 @@
  *  API License: Apache 2.0
  ****************************************************************************/
 
+import { AspectTiming } from './AspectTiming';
 
 
 /** Plugin representation for JSON transfer. */
@@ -21,6 +22,10 @@ export interface Plugin {
   is_meta: boolean;
   meta_children?: Array<string>;
   is_loaded: boolean;
+  load_usec?: number;
+  wait_usec?: number;
+  init_usec?: number;
+  aspect_timings?: Array<AspectTiming>;
 }
 
 export namespace Plugin {
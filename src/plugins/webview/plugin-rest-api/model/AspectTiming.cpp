@@ -0,0 +1,124 @@
+
+/****************************************************************************
+ *  AspectTiming
+ *  (auto-generated, do not modify directly)
+ *
+ *  Fawkes Plugin REST API.
+ *  List, load, and unload plugins.
+ *
+ *  API Contact: Tim Niemueller <niemueller@kbsg.rwth-aachen.de>
+ *  API Version: v1beta1
+ *  API License: Apache 2.0
+ ****************************************************************************/
+
+#include "AspectTiming.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <sstream>
+
+AspectTiming::AspectTiming()
+{
+}
+
+AspectTiming::AspectTiming(const std::string &json)
+{
+	from_json(json);
+}
+
+AspectTiming::AspectTiming(const rapidjson::Value &v)
+{
+	from_json_value(v);
+}
+
+AspectTiming::~AspectTiming()
+{
+}
+
+std::string
+AspectTiming::to_json(bool pretty) const
+{
+	rapidjson::Document d;
+
+	to_json_value(d, d);
+
+	rapidjson::StringBuffer buffer;
+	if (pretty) {
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+		d.Accept(writer);
+	} else {
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		d.Accept(writer);
+	}
+
+	return buffer.GetString();
+}
+
+void
+AspectTiming::to_json_value(rapidjson::Document &d, rapidjson::Value &v) const
+{
+	rapidjson::Document::AllocatorType &allocator = d.GetAllocator();
+	v.SetObject();
+	// Avoid unused variable warnings
+	(void)allocator;
+
+	if (name_) {
+		rapidjson::Value v_name;
+		v_name.SetString(*name_, allocator);
+		v.AddMember("name", v_name, allocator);
+	}
+	if (init_usec_) {
+		rapidjson::Value v_init_usec;
+		v_init_usec.SetInt64(*init_usec_);
+		v.AddMember("init_usec", v_init_usec, allocator);
+	}
+}
+
+void
+AspectTiming::from_json(const std::string &json)
+{
+	rapidjson::Document d;
+	d.Parse(json);
+
+	from_json_value(d);
+}
+
+void
+AspectTiming::from_json_value(const rapidjson::Value &d)
+{
+	if (d.HasMember("name") && d["name"].IsString()) {
+		name_ = d["name"].GetString();
+	}
+	if (d.HasMember("init_usec") && d["init_usec"].IsInt64()) {
+		init_usec_ = d["init_usec"].GetInt64();
+	}
+}
+
+void
+AspectTiming::validate(bool subcall) const
+{
+	std::vector<std::string> missing;
+	if (!name_)
+		missing.push_back("name");
+	if (!init_usec_)
+		missing.push_back("init_usec");
+
+	if (!missing.empty()) {
+		if (subcall) {
+			throw missing;
+		} else {
+			std::ostringstream s;
+			s << "AspectTiming is missing field" << ((missing.size() > 0) ? "s" : "") << ": ";
+			for (std::vector<std::string>::size_type i = 0; i < missing.size(); ++i) {
+				s << missing[i];
+				if (i < (missing.size() - 1)) {
+					s << ", ";
+				}
+			}
+			throw std::runtime_error(s.str());
+		}
+	}
+}
\ No newline at end of file
@@ -103,6 +103,29 @@ Plugin::to_json_value(rapidjson::Document &d, rapidjson::Value &v) const
 		v_is_loaded.SetBool(*is_loaded_);
 		v.AddMember("is_loaded", v_is_loaded, allocator);
 	}
+	if (load_usec_) {
+		rapidjson::Value v_load_usec;
+		v_load_usec.SetInt64(*load_usec_);
+		v.AddMember("load_usec", v_load_usec, allocator);
+	}
+	if (wait_usec_) {
+		rapidjson::Value v_wait_usec;
+		v_wait_usec.SetInt64(*wait_usec_);
+		v.AddMember("wait_usec", v_wait_usec, allocator);
+	}
+	if (init_usec_) {
+		rapidjson::Value v_init_usec;
+		v_init_usec.SetInt64(*init_usec_);
+		v.AddMember("init_usec", v_init_usec, allocator);
+	}
+	rapidjson::Value v_aspect_timings(rapidjson::kArrayType);
+	v_aspect_timings.Reserve(aspect_timings_.size(), allocator);
+	for (const auto &e : aspect_timings_) {
+		rapidjson::Value v(rapidjson::kObjectType);
+		e->to_json_value(d, v);
+		v_aspect_timings.PushBack(v, allocator);
+	}
+	v.AddMember("aspect_timings", v_aspect_timings, allocator);
 }
 
 void
@@ -144,6 +167,26 @@ Plugin::from_json_value(const rapidjson::Value &d)
 	if (d.HasMember("is_loaded") && d["is_loaded"].IsBool()) {
 		is_loaded_ = d["is_loaded"].GetBool();
 	}
+	if (d.HasMember("load_usec") && d["load_usec"].IsInt64()) {
+		load_usec_ = d["load_usec"].GetInt64();
+	}
+	if (d.HasMember("wait_usec") && d["wait_usec"].IsInt64()) {
+		wait_usec_ = d["wait_usec"].GetInt64();
+	}
+	if (d.HasMember("init_usec") && d["init_usec"].IsInt64()) {
+		init_usec_ = d["init_usec"].GetInt64();
+	}
+	if (d.HasMember("aspect_timings") && d["aspect_timings"].IsArray()) {
+		const rapidjson::Value &a = d["aspect_timings"];
+		aspect_timings_           = std::vector<std::shared_ptr<AspectTiming>>{};
+		;
+		aspect_timings_.reserve(a.Size());
+		for (auto &v : a.GetArray()) {
+			std::shared_ptr<AspectTiming> nv{new AspectTiming()};
+			nv->from_json_value(v);
+			aspect_timings_.push_back(std::move(nv));
+		}
+	}
 }
 
 void
@@ -14,6 +14,8 @@
 #pragma once
 
 #define RAPIDJSON_HAS_STDSTRING 1
+#include "AspectTiming.h"
+
 #include <rapidjson/fwd.h>
 
 #include <cstdint>
@@ -222,13 +224,111 @@ public:
 	{
 		is_loaded_ = is_loaded;
 	}
+	/** Get load_usec value.
+   * @return load_usec value
+   */
+	std::optional<int64_t>
+	load_usec() const
+	{
+		return load_usec_;
+	}
+
+	/** Set load_usec value.
+	 * @param load_usec new value
+	 */
+	void
+	set_load_usec(const int64_t &load_usec)
+	{
+		load_usec_ = load_usec;
+	}
+	/** Get wait_usec value.
+   * @return wait_usec value
+   */
+	std::optional<int64_t>
+	wait_usec() const
+	{
+		return wait_usec_;
+	}
+
+	/** Set wait_usec value.
+	 * @param wait_usec new value
+	 */
+	void
+	set_wait_usec(const int64_t &wait_usec)
+	{
+		wait_usec_ = wait_usec;
+	}
+	/** Get init_usec value.
+   * @return init_usec value
+   */
+	std::optional<int64_t>
+	init_usec() const
+	{
+		return init_usec_;
+	}
+
+	/** Set init_usec value.
+	 * @param init_usec new value
+	 */
+	void
+	set_init_usec(const int64_t &init_usec)
+	{
+		init_usec_ = init_usec;
+	}
+	/** Get aspect_timings value.
+   * @return aspect_timings value
+   */
+	std::vector<std::shared_ptr<AspectTiming>>
+	aspect_timings() const
+	{
+		return aspect_timings_;
+	}
+
+	/** Set aspect_timings value.
+	 * @param aspect_timings new value
+	 */
+	void
+	set_aspect_timings(const std::vector<std::shared_ptr<AspectTiming>> &aspect_timings)
+	{
+		aspect_timings_ = aspect_timings;
+	}
+	/** Add element to aspect_timings array.
+	 * @param aspect_timings new value
+	 */
+	void
+	addto_aspect_timings(const std::shared_ptr<AspectTiming> &&aspect_timings)
+	{
+		aspect_timings_.push_back(std::move(aspect_timings));
+	}
+
+	/** Add element to aspect_timings array.
+	 * The move-semantics version (std::move) should be preferred.
+	 * @param aspect_timings new value
+	 */
+	void
+	addto_aspect_timings(const std::shared_ptr<AspectTiming> &aspect_timings)
+	{
+		aspect_timings_.push_back(aspect_timings);
+	}
+	/** Add element to aspect_timings array.
+	 * @param aspect_timings new value
+	 */
+	void
+	addto_aspect_timings(const AspectTiming &&aspect_timings)
+	{
+		aspect_timings_.push_back(std::make_shared<AspectTiming>(std::move(aspect_timings)));
+	}
 
 private:
-	std::optional<std::string> kind_;
-	std::optional<std::string> apiVersion_;
-	std::optional<std::string> name_;
-	std::optional<std::string> description_;
-	std::optional<bool>        is_meta_;
-	std::vector<std::string>   meta_children_;
-	std::optional<bool>        is_loaded_;
+	std::optional<std::string>                 kind_;
+	std::optional<std::string>                 apiVersion_;
+	std::optional<std::string>                 name_;
+	std::optional<std::string>                 description_;
+	std::optional<bool>                        is_meta_;
+	std::vector<std::string>                   meta_children_;
+	std::optional<bool>                        is_loaded_;
+	std::optional<int64_t>                     load_usec_;
+	std::optional<int64_t>                     wait_usec_;
+	std::optional<int64_t>                     init_usec_;
+	std::vector<std::shared_ptr<AspectTiming>> aspect_timings_;
 };
\ No newline at end of file
@@ -23,6 +23,7 @@
 
 #include "model/Plugin.h"
 
+#include <plugin/manager.h>
 #include <webview/rest_api_manager.h>
 
 using namespace fawkes;
@@ -73,6 +74,11 @@ PluginRestApi::cb_list_plugins()
 {
 	WebviewRestArray<::Plugin> rv;
 
+	std::map<std::string, PluginManager::InitTiming> timings;
+	for (auto &t : plugin_manager->get_init_timings()) {
+		timings[t.plugin] = t;
+	}
+
 	auto available_plugins = plugin_manager->get_available_plugins();
 	for (const auto &i : available_plugins) {
 		const std::string &name        = i.first;
@@ -92,6 +98,18 @@ PluginRestApi::cb_list_plugins()
 			p.set_meta_children(std::move(v));
 		}
 		p.set_is_loaded(is_loaded);
+		auto t = timings.find(name);
+		if (t != timings.end()) {
+			p.set_load_usec(t->second.load_usec);
+			p.set_wait_usec(t->second.wait_usec);
+			p.set_init_usec(t->second.init_usec);
+			for (const auto &a : t->second.aspect_usec) {
+				AspectTiming at;
+				at.set_name(a.first);
+				at.set_init_usec(a.second);
+				p.addto_aspect_timings(std::move(at));
+			}
+		}
 		rv.push_back(std::move(p));
 	}
 
@@ -66,7 +66,7 @@ main(int argc, char **argv)
 
 	printf("Memory Size: %s%8u%s %sB%s  BlackBoard version: %s%u%s\n"
 	       "Free Memory: %s%8u%s %sB%s  Alloc. memory: %s%8u%s %sB%s  Overhang: %s%8u%s %sB%s\n"
-	       "Free Chunks: %s%8u%s    Alloc. chunks: %s%8u%s\n",
+	       "Free Chunks: %s%8u%s    Alloc. chunks: %s%8u%s    Fragmentation: %s%5.1f%s %%\n",
 	       cdarkgray.c_str(),
 	       memmgr->memory_size(),
 	       cnormal.c_str(),
@@ -95,6 +95,9 @@ main(int argc, char **argv)
 	       cnormal.c_str(),
 	       cdarkgray.c_str(),
 	       memmgr->num_allocated_chunks(),
+	       cnormal.c_str(),
+	       cdarkgray.c_str(),
+	       memmgr->fragmentation() * 100.,
 	       cnormal.c_str());
 
 	if (!memmgr->try_lock()) {
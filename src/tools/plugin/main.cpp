@@ -36,7 +36,7 @@ using namespace fawkes;
 int
 main(int argc, char **argv)
 {
-	ArgumentParser argp(argc, argv, "hl:u:R:waLr:");
+	ArgumentParser argp(argc, argv, "hl:u:R:waLtr:");
 
 	if (argp.has_arg("h")) {
 		PluginTool::print_usage(argp.program_name());
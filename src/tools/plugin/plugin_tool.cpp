@@ -41,6 +41,7 @@ using namespace fawkes;
  * - -l plugin_name load plugin named plugin_name
  * - -u plugin_name unload plugin named plugin_name
  * - -w watch for changes
+ * - -t list initialization times of loaded plugins
  * @param c FawkesNetworkClient with established connection
  */
 PluginTool::PluginTool(ArgumentParser *argp, FawkesNetworkClient *c)
@@ -62,6 +63,8 @@ PluginTool::PluginTool(ArgumentParser *argp, FawkesNetworkClient *c)
 		opmode = M_WATCH;
 	} else if (argp->has_arg("a")) {
 		opmode = M_LIST_AVAIL;
+	} else if (argp->has_arg("t")) {
+		opmode = M_LIST_TIMING;
 	} else {
 		opmode = M_LIST_LOADED;
 	}
@@ -97,13 +100,14 @@ PluginTool::~PluginTool()
 void
 PluginTool::print_usage(const char *program_name)
 {
-	printf("Usage: %s [-l plugin|-u plugin|-R plugin|-w|-a|-L] [-r host[:port]]\n"
+	printf("Usage: %s [-l plugin|-u plugin|-R plugin|-w|-a|-L|-t] [-r host[:port]]\n"
 	       "  -l plugin      Load plugin with given name\n"
 	       "  -u plugin      Unload plugin with given name\n"
 	       "  -R plugin      Reload plugin with given name\n"
 	       "  -w             Watch all load/unload operations\n"
 	       "  -a             List available plugins\n"
-	       "  -L             List loaded plugins (default)\n\n"
+	       "  -L             List loaded plugins (default)\n"
+	       "  -t             List initialization times of loaded plugins\n\n"
 	       "  -r host[:port] Remote host (and optionally port) to connect to\n\n"
 	       "  If called without any option list currently loaded plugins\n\n",
 	       program_name);
@@ -228,6 +232,20 @@ PluginTool::list_loaded()
 	}
 }
 
+/** Execute list initialization times operation. */
+void
+PluginTool::list_timing()
+{
+	printf("Request the initialization times of all loaded plugins\n");
+	FawkesNetworkMessage *msg =
+	  new FawkesNetworkMessage(FAWKES_CID_PLUGINMANAGER, MSG_PLUGIN_LIST_TIMING);
+	c->enqueue(msg);
+
+	while (!quit) {
+		c->wait(FAWKES_CID_PLUGINMANAGER);
+	}
+}
+
 /** Watch for plugin manager events. */
 void
 PluginTool::watch()
@@ -354,10 +372,53 @@ PluginTool::inbound_received(FawkesNetworkMessage *msg, unsigned int id) throw()
 		}
 		quit = true;
 		delete plm;
+	} else if (msg->msgid() == MSG_PLUGIN_TIMING_LIST) {
+		PluginListMessage *plm = msg->msgc<PluginListMessage>();
+		if (plm->has_next()) {
+			printf("Plugin initialization times in ms:\n");
+			printf("  %-30s %9s %9s %9s\n", "Plugin/Aspect", "load", "wait", "init");
+			while (plm->has_next()) {
+				char *plugin_name = plm->next();
+				char *timing      = NULL;
+				if (plm->has_next()) {
+					timing = plm->next();
+				} else {
+					throw Exception("Invalid timing list received");
+				}
+				long int load_usec = 0, wait_usec = 0, init_usec = 0;
+				int      n         = 0;
+				sscanf(timing, "%ld %ld %ld%n", &load_usec, &wait_usec, &init_usec, &n);
+				printf("  %-30s %9.1f %9.1f %9.1f\n",
+				       plugin_name,
+				       load_usec / 1000.,
+				       wait_usec / 1000.,
+				       init_usec / 1000.);
+				// remaining space-separated aspect=usec pairs
+				char *saveptr;
+				char *aspect = strtok_r(timing + n, " ", &saveptr);
+				while (aspect) {
+					char *eq = strchr(aspect, '=');
+					if (eq) {
+						*eq = 0;
+						printf("    %-28s %29.1f\n", aspect, atol(eq + 1) / 1000.);
+					}
+					aspect = strtok_r(NULL, " ", &saveptr);
+				}
+				free(plugin_name);
+				free(timing);
+			}
+		} else {
+			printf("No plugins loaded\n");
+		}
+		quit = true;
+		delete plm;
 	} else if (msg->msgid() == MSG_PLUGIN_AVAIL_LIST_FAILED) {
 		printf("Obtaining list of available plugins failed\n");
 	} else if (msg->msgid() == MSG_PLUGIN_LOADED_LIST_FAILED) {
 		printf("Obtaining list of loaded plugins failed\n");
+	} else if (msg->msgid() == MSG_PLUGIN_TIMING_LIST_FAILED) {
+		printf("Obtaining initialization times of plugins failed\n");
+		quit = true;
 	}
 }
 
@@ -395,6 +456,8 @@ PluginTool::run()
 
 	case M_LIST_LOADED: list_loaded(); break;
 
+	case M_LIST_TIMING: list_timing(); break;
+
 	case M_WATCH: watch(); break;
 
 	default: print_usage(program_name_);
@@ -56,6 +56,7 @@ private:
 	void list_loaded();
 	void watch();
 	void list_avail();
+	void list_timing();
 
 	virtual void deregistered(unsigned int id) throw();
 	virtual void inbound_received(fawkes::FawkesNetworkMessage *msg, unsigned int id) throw();
@@ -66,6 +67,7 @@ private:
 	typedef enum {
 		M_LIST_LOADED,
 		M_LIST_AVAIL,
+		M_LIST_TIMING,
 		M_LOAD,
 		M_UNLOAD,
 		M_RELOAD,